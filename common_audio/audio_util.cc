@@ -14,6 +14,31 @@
 
 namespace webrtc {
 
+void ScaleAndRoundToInt16(const float* src, int size, int16_t* dest) {
+  for (int i = 0; i < size; ++i)
+    dest[i] = ScaleAndRoundToInt16(src[i]);
+}
+
+void ScaleToFloat(const int16_t* src, int size, float* dest) {
+  for (int i = 0; i < size; ++i)
+    dest[i] = ScaleToFloat(src[i]);
+}
+
+void ScaleToFloatS16(const float* src, int size, float* dest) {
+  for (int i = 0; i < size; ++i)
+    dest[i] = ScaleToFloatS16(src[i]);
+}
+
+void ScaleFloatS16ToFloat(const float* src, int size, float* dest) {
+  for (int i = 0; i < size; ++i)
+    dest[i] = ScaleFloatS16ToFloat(src[i]);
+}
+
+void RoundFloatS16ToInt16(const float* src, int size, int16_t* dest) {
+  for (int i = 0; i < size; ++i)
+    dest[i] = RoundFloatS16ToInt16(src[i]);
+}
+
 void Deinterleave(const int16_t* interleaved, int samples_per_channel,
                   int num_channels, int16_t** deinterleaved) {
   for (int i = 0; i < num_channels; i++) {
@@ -20,6 +20,55 @@ void ExpectArraysEq(const int16_t* ref, const int16_t* test, int length) {
   }
 }
 
+TEST(AudioUtilTest, ScaleAndRoundToInt16) {
+  const int kSize = 7;
+  const float kInput[kSize] = {
+      0.f, 0.4f / 32767.f, 0.6f / 32767.f, -0.5f / 32768.f, 1.f, -1.f, 1.1f};
+  const int16_t kReference[kSize] = {0, 0, 1, -1, 32767, -32768, 32767};
+  int16_t output[kSize];
+  ScaleAndRoundToInt16(kInput, kSize, output);
+  ExpectArraysEq(kReference, output, kSize);
+}
+
+TEST(AudioUtilTest, Int16SurvivesFloatRoundTrip) {
+  for (int i = -32768; i <= 32767; ++i) {
+    const int16_t value = static_cast<int16_t>(i);
+    const float scaled = ScaleToFloat(value);
+    EXPECT_LE(-1.f, scaled);
+    EXPECT_GE(1.f, scaled);
+    EXPECT_EQ(value, ScaleAndRoundToInt16(scaled));
+  }
+}
+
+TEST(AudioUtilTest, RoundFloatS16ToInt16) {
+  const int kSize = 8;
+  const float kInput[kSize] = {
+      0.f, 0.4f, 0.6f, -0.4f, -0.6f, 32766.6f, 40000.f, -40000.f};
+  const int16_t kReference[kSize] = {0, 0, 1, 0, -1, 32767, 32767, -32768};
+  int16_t output[kSize];
+  RoundFloatS16ToInt16(kInput, kSize, output);
+  ExpectArraysEq(kReference, output, kSize);
+}
+
+TEST(AudioUtilTest, FloatS16MatchesScaleAndRoundToInt16) {
+  const int kSize = 7;
+  const float kInput[kSize] = {
+      0.f, 0.4f / 32767.f, 0.6f / 32767.f, -0.5f / 32768.f, 1.f, -1.f, 0.3f};
+  float float_s16[kSize];
+  ScaleToFloatS16(kInput, kSize, float_s16);
+  int16_t output[kSize];
+  int16_t reference[kSize];
+  RoundFloatS16ToInt16(float_s16, kSize, output);
+  ScaleAndRoundToInt16(kInput, kSize, reference);
+  ExpectArraysEq(reference, output, kSize);
+
+  float round_trip[kSize];
+  ScaleFloatS16ToFloat(float_s16, kSize, round_trip);
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_FLOAT_EQ(kInput[i], round_trip[i]);
+  }
+}
+
 TEST(AudioUtilTest, InterleavingStereo) {
   const int16_t kInterleaved[] = {2, 3, 4, 9, 8, 27, 16, 81};
   const int kSamplesPerChannel = 4;
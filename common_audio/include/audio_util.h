@@ -15,6 +15,54 @@
 
 namespace webrtc {
 
+// Converts a float in the [-1, 1] range to int16, rounding to the nearest
+// value and saturating outside the range.
+static inline int16_t ScaleAndRoundToInt16(float v) {
+  if (v > 0)
+    return v >= 1 ? 32767 : static_cast<int16_t>(v * 32767 + 0.5f);
+  return v <= -1 ? -32768 : static_cast<int16_t>(-(-v * 32768 + 0.5f));
+}
+
+// Converts an int16 to a float in the [-1, 1] range. The inverse of
+// ScaleAndRoundToInt16(), so int16 values survive a round trip.
+static inline float ScaleToFloat(int16_t v) {
+  static const float kMaxInt16Inverse = 1.f / 32767;
+  static const float kMinInt16Inverse = 1.f / 32768;
+  return v * ((v > 0) ? kMaxInt16Inverse : kMinInt16Inverse);
+}
+
+// The audio processing float path keeps its samples in the int16 range, but
+// without rounding them, so the processing sees the same levels as with int16
+// audio.
+
+// Converts a float in the [-1, 1] range to the int16 range, as
+// ScaleAndRoundToInt16() without the rounding.
+static inline float ScaleToFloatS16(float v) {
+  return v * ((v > 0) ? 32767.f : 32768.f);
+}
+
+// The inverse of ScaleToFloatS16().
+static inline float ScaleFloatS16ToFloat(float v) {
+  static const float kMaxInt16Inverse = 1.f / 32767;
+  static const float kMinInt16Inverse = 1.f / 32768;
+  return v * ((v > 0) ? kMaxInt16Inverse : kMinInt16Inverse);
+}
+
+// Converts a float in the int16 range to int16, rounding to the nearest value
+// and saturating outside the range.
+static inline int16_t RoundFloatS16ToInt16(float v) {
+  if (v > 0)
+    return v >= 32766.5f ? 32767 : static_cast<int16_t>(v + 0.5f);
+  return v <= -32767.5f ? -32768 : static_cast<int16_t>(v - 0.5f);
+}
+
+// Converts |size| samples with the functions above.
+void ScaleAndRoundToInt16(const float* src, int size, int16_t* dest);
+void ScaleToFloat(const int16_t* src, int size, float* dest);
+void ScaleToFloatS16(const float* src, int size, float* dest);
+void ScaleFloatS16ToFloat(const float* src, int size, float* dest);
+void RoundFloatS16ToInt16(const float* src, int size, int16_t* dest);
+
 // Deinterleave audio from |interleaved| to the channel buffers pointed to
 // by |deinterleaved|. There must be sufficient space allocated in the
 // |deinterleaved| buffers (|num_channel| buffers with |samples_per_channel|
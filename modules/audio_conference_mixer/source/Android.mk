@@ -19,6 +19,7 @@ LOCAL_CPP_EXTENSION := .cc
 LOCAL_SRC_FILES := \
     audio_frame_manipulator.cc \
     level_indicator.cc \
+    mix_accumulator.cc \
     audio_conference_mixer_impl.cc \
     time_scheduler.cc
 
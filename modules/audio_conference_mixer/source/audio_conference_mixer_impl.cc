@@ -8,46 +8,76 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <string.h>
+
+#include <algorithm>
+
 #include "webrtc/modules/audio_conference_mixer/interface/audio_conference_mixer_defines.h"
 #include "webrtc/modules/audio_conference_mixer/source/audio_conference_mixer_impl.h"
 #include "webrtc/modules/audio_conference_mixer/source/audio_frame_manipulator.h"
+#include "webrtc/modules/audio_conference_mixer/source/mix_accumulator.h"
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
-#include "webrtc/modules/utility/interface/audio_frame_operations.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
-#include "webrtc/system_wrappers/interface/map_wrapper.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 
 namespace webrtc {
 namespace {
 
-// Mix |frame| into |mixed_frame|, with saturation protection and upmixing.
-// These effects are applied to |frame| itself prior to mixing. Assumes that
-// |mixed_frame| always has at least as many channels as |frame|. Supports
-// stereo at most.
-//
-// TODO(andrew): consider not modifying |frame| here.
-void MixFrames(AudioFrame* mixed_frame, AudioFrame* frame) {
-  assert(mixed_frame->num_channels_ >= frame->num_channels_);
-  // Divide by two to avoid saturation in the mixing.
-  *frame >>= 1;
-  if (mixed_frame->num_channels_ > frame->num_channels_) {
+// Mix |frame| into |mixed_frame|, whose samples are summed in |accumulator|,
+// with upmixing. The sum is written to |mixed_frame| once all frames have been
+// mixed; the properties of |mixed_frame| are updated here the way
+// AudioFrame::operator+=() does. Assumes that |mixed_frame| always has at
+// least as many channels as |frame|. Supports stereo at most.
+void MixFrames(AudioFrame* mixed_frame, const AudioFrame& frame,
+               int32_t* accumulator) {
+  assert(mixed_frame->num_channels_ >= frame.num_channels_);
+  const int length =
+      frame.samples_per_channel_ * mixed_frame->num_channels_;
+  if (mixed_frame->samples_per_channel_ == 0) {
+    // This is the first frame of the mix.
+    mixed_frame->samples_per_channel_ = frame.samples_per_channel_;
+    memset(accumulator, 0, length * sizeof(accumulator[0]));
+  } else if (mixed_frame->samples_per_channel_ !=
+             frame.samples_per_channel_) {
+    return;
+  }
+
+  if (mixed_frame->vad_activity_ == AudioFrame::kVadActive ||
+      frame.vad_activity_ == AudioFrame::kVadActive) {
+    mixed_frame->vad_activity_ = AudioFrame::kVadActive;
+  } else if (mixed_frame->vad_activity_ == AudioFrame::kVadUnknown ||
+             frame.vad_activity_ == AudioFrame::kVadUnknown) {
+    mixed_frame->vad_activity_ = AudioFrame::kVadUnknown;
+  }
+  if (mixed_frame->speech_type_ != frame.speech_type_) {
+    mixed_frame->speech_type_ = AudioFrame::kUndefined;
+  }
+
+  if (mixed_frame->num_channels_ > frame.num_channels_) {
     // We only support mono-to-stereo.
     assert(mixed_frame->num_channels_ == 2 &&
-           frame->num_channels_ == 1);
-    AudioFrameOperations::MonoToStereo(frame);
+           frame.num_channels_ == 1);
+    AccumulateMonoToStereo(frame.data_, frame.samples_per_channel_,
+                           accumulator);
+  } else {
+    AccumulateSamples(frame.data_, length, accumulator);
   }
-
-  *mixed_frame += *frame;
 }
 
 // Return the max number of channels from a |list| composed of AudioFrames.
-int MaxNumChannels(const ListWrapper& list) {
-  ListItem* item = list.First();
+int MaxNumChannels(const std::vector<AudioFrame*>& list) {
   int max_num_channels = 1;
-  while (item) {
-    AudioFrame* frame = static_cast<AudioFrame*>(item->GetItem());
-    max_num_channels = std::max(max_num_channels, frame->num_channels_);
-    item = list.Next(item);
+  for (size_t i = 0; i < list.size(); ++i) {
+    max_num_channels = std::max(max_num_channels, list[i]->num_channels_);
+  }
+  return max_num_channels;
+}
+
+int MaxNumChannels(const std::vector<ParticipantFrame>& list) {
+  int max_num_channels = 1;
+  for (size_t i = 0; i < list.size(); ++i) {
+    max_num_channels = std::max(max_num_channels,
+                                list[i].audioFrame->num_channels_);
   }
   return max_num_channels;
 }
@@ -125,6 +155,11 @@ AudioConferenceMixerImpl::AudioConferenceMixerImpl(int id)
       _scratchMixedParticipants(),
       _scratchVadPositiveParticipantsAmount(0),
       _scratchVadPositiveParticipants(),
+      _scratchMixList(),
+      _scratchRampOutList(),
+      _scratchAdditionalFramesList(),
+      _scratchPassiveWasMixedList(),
+      _scratchPassiveWasNotMixedList(),
       _crit(NULL),
       _cbCrit(NULL),
       _id(id),
@@ -237,10 +272,10 @@ int32_t AudioConferenceMixerImpl::Process()
         _timeScheduler.UpdateScheduler();
     }
 
-    ListWrapper mixList;
-    ListWrapper rampOutList;
-    ListWrapper additionalFramesList;
-    MapWrapper mixedParticipantsMap;
+    // Only touched by Process(), which is never called concurrently.
+    ParticipantFrameList& mixList = _scratchMixList;
+    AudioFrameList& rampOutList = _scratchRampOutList;
+    AudioFrameList& additionalFramesList = _scratchAdditionalFramesList;
     {
         CriticalSectionScoped cs(_cbCrit.get());
 
@@ -297,19 +332,13 @@ int32_t AudioConferenceMixerImpl::Process()
             }
         }
 
-        UpdateToMix(mixList, rampOutList, mixedParticipantsMap,
-                    remainingParticipantsAllowedToMix);
+        UpdateToMix(mixList, rampOutList, remainingParticipantsAllowedToMix);
 
         GetAdditionalAudio(additionalFramesList);
-        UpdateMixedStatus(mixedParticipantsMap);
-        _scratchParticipantsToMixAmount = mixedParticipantsMap.Size();
+        UpdateMixedStatus(mixList);
+        _scratchParticipantsToMixAmount = mixList.size();
     }
 
-    // Clear mixedParticipantsMap to avoid memory leak warning.
-    // Please note that the mixedParticipantsMap doesn't own any dynamically
-    // allocated memory.
-    while(mixedParticipantsMap.Erase(mixedParticipantsMap.First()) == 0) {}
-
     // Get an AudioFrame for mixing from the memory pool.
     AudioFrame* mixedAudio = NULL;
     if(_audioFramePool->PopMemory(mixedAudio) == -1)
@@ -355,6 +384,7 @@ int32_t AudioConferenceMixerImpl::Process()
         }
         else
         {
+            SaturateMixedAudio(*mixedAudio);
             // Only call the limiter if we have something to mix.
             if(!LimitMixedAudio(*mixedAudio))
                 retval = -1;
@@ -716,34 +746,32 @@ int32_t AudioConferenceMixerImpl::GetLowestMixingFrequencyFromList(
 }
 
 void AudioConferenceMixerImpl::UpdateToMix(
-    ListWrapper& mixList,
-    ListWrapper& rampOutList,
-    MapWrapper& mixParticipantList,
+    ParticipantFrameList& mixList,
+    AudioFrameList& rampOutList,
     uint32_t& maxAudioFrameCounter)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
-                 "UpdateToMix(mixList,rampOutList,mixParticipantList,%d)",
+                 "UpdateToMix(mixList,rampOutList,%d)",
                  maxAudioFrameCounter);
-    const uint32_t mixListStartSize = mixList.GetSize();
-    ListWrapper activeList; // Elements are AudioFrames
-    // Struct needed by the passive lists to keep track of which AudioFrame
-    // belongs to which MixerParticipant.
-    struct ParticipantFramePair
-    {
-        MixerParticipant* participant;
-        AudioFrame* audioFrame;
-    };
-    ListWrapper passiveWasNotMixedList; // Elements are MixerParticipant
-    ListWrapper passiveWasMixedList;    // Elements are MixerParticipant
+    const size_t mixListStartSize = mixList.size();
+    // The active participants are appended to mixList directly. There are
+    // never more than maxAudioFrameCounter of them, the ones with the highest
+    // energy so far.
+    size_t numActive = 0;
+    ParticipantFrameList& passiveWasMixedList = _scratchPassiveWasMixedList;
+    ParticipantFrameList& passiveWasNotMixedList =
+        _scratchPassiveWasNotMixedList;
+    passiveWasMixedList.clear();
+    passiveWasNotMixedList.clear();
     ListItem* item = _participantList.First();
     while(item)
     {
         // Stop keeping track of passive participants if there are already
         // enough participants available (they wont be mixed anyway).
         bool mustAddToPassiveList = (maxAudioFrameCounter >
-                                    (activeList.GetSize() +
-                                     passiveWasMixedList.GetSize() +
-                                     passiveWasNotMixedList.GetSize()));
+                                    (numActive +
+                                     passiveWasMixedList.size() +
+                                     passiveWasNotMixedList.size()));
 
         MixerParticipant* participant = static_cast<MixerParticipant*>(
             item->GetItem());
@@ -777,6 +805,10 @@ void AudioConferenceMixerImpl::UpdateToMix(
                          "invalid VAD state from participant");
         }
 
+        ParticipantFrame participantFrame;
+        participantFrame.participant = participant;
+        participantFrame.audioFrame = audioFrame;
+        participantFrame.wasMixed = wasMixed;
         if(audioFrame->vad_activity_ == AudioFrame::kVadActive)
         {
             if(!wasMixed)
@@ -784,163 +816,87 @@ void AudioConferenceMixerImpl::UpdateToMix(
                 RampIn(*audioFrame);
             }
 
-            if(activeList.GetSize() >= maxAudioFrameCounter)
+            if(numActive >= maxAudioFrameCounter)
             {
                 // There are already more active participants than should be
-                // mixed. Only keep the ones with the highest energy.
-                ListItem* replaceItem = NULL;
+                // mixed. Only keep the ones with the highest energy. Either
+                // the new frame or the one with the lowest energy in the mix
+                // is dropped.
                 CalculateEnergy(*audioFrame);
-                uint32_t lowestEnergy = audioFrame->energy_;
-
-                ListItem* activeItem = activeList.First();
-                while(activeItem)
+                ParticipantFrame* lowest = &participantFrame;
+                for(size_t i = mixListStartSize;
+                    i < mixListStartSize + numActive; i++)
                 {
-                    AudioFrame* replaceFrame = static_cast<AudioFrame*>(
-                        activeItem->GetItem());
-                    CalculateEnergy(*replaceFrame);
-                    if(replaceFrame->energy_ < lowestEnergy)
+                    CalculateEnergy(*mixList[i].audioFrame);
+                    if(mixList[i].audioFrame->energy_ <
+                       lowest->audioFrame->energy_)
                     {
-                        replaceItem = activeItem;
-                        lowestEnergy = replaceFrame->energy_;
+                        lowest = &mixList[i];
                     }
-                    activeItem = activeList.Next(activeItem);
                 }
-                if(replaceItem != NULL)
+                ParticipantFrame dropped = *lowest;
+                *lowest = participantFrame;
+                if(dropped.wasMixed)
                 {
-                    AudioFrame* replaceFrame = static_cast<AudioFrame*>(
-                        replaceItem->GetItem());
-
-                    bool replaceWasMixed = false;
-                    MapItem* replaceParticipant = mixParticipantList.Find(
-                        replaceFrame->id_);
-                    // When a frame is pushed to |activeList| it is also pushed
-                    // to mixParticipantList with the frame's id. This means
-                    // that the Find call above should never fail.
-                    if(replaceParticipant == NULL)
-                    {
-                        assert(false);
-                    } else {
-                        static_cast<MixerParticipant*>(
-                            replaceParticipant->GetItem())->_mixHistory->
-                            WasMixed(replaceWasMixed);
-
-                        mixParticipantList.Erase(replaceFrame->id_);
-                        activeList.Erase(replaceItem);
-
-                        activeList.PushFront(static_cast<void*>(audioFrame));
-                        mixParticipantList.Insert(
-                            audioFrame->id_,
-                            static_cast<void*>(participant));
-                        assert(mixParticipantList.Size() <=
-                               kMaximumAmountOfMixedParticipants);
-
-                        if(replaceWasMixed)
-                        {
-                            RampOut(*replaceFrame);
-                            rampOutList.PushBack(
-                                static_cast<void*>(replaceFrame));
-                            assert(rampOutList.GetSize() <=
-                                   kMaximumAmountOfMixedParticipants);
-                        } else {
-                            _audioFramePool->PushMemory(replaceFrame);
-                        }
-                    }
+                    RampOut(*dropped.audioFrame);
+                    rampOutList.push_back(dropped.audioFrame);
+                    assert(rampOutList.size() <=
+                           kMaximumAmountOfMixedParticipants);
                 } else {
-                    if(wasMixed)
-                    {
-                        RampOut(*audioFrame);
-                        rampOutList.PushBack(static_cast<void*>(audioFrame));
-                        assert(rampOutList.GetSize() <=
-                               kMaximumAmountOfMixedParticipants);
-                    } else {
-                        _audioFramePool->PushMemory(audioFrame);
-                    }
+                    _audioFramePool->PushMemory(dropped.audioFrame);
                 }
             } else {
-                activeList.PushFront(static_cast<void*>(audioFrame));
-                mixParticipantList.Insert(audioFrame->id_,
-                                          static_cast<void*>(participant));
-                assert(mixParticipantList.Size() <=
-                       kMaximumAmountOfMixedParticipants);
+                mixList.push_back(participantFrame);
+                numActive++;
             }
         } else {
             if(wasMixed)
             {
-                ParticipantFramePair* pair = new ParticipantFramePair;
-                pair->audioFrame  = audioFrame;
-                pair->participant = participant;
-                passiveWasMixedList.PushBack(static_cast<void*>(pair));
+                passiveWasMixedList.push_back(participantFrame);
             } else if(mustAddToPassiveList) {
                 RampIn(*audioFrame);
-                ParticipantFramePair* pair = new ParticipantFramePair;
-                pair->audioFrame  = audioFrame;
-                pair->participant = participant;
-                passiveWasNotMixedList.PushBack(static_cast<void*>(pair));
+                passiveWasNotMixedList.push_back(participantFrame);
             } else {
                 _audioFramePool->PushMemory(audioFrame);
             }
         }
         item = _participantList.Next(item);
     }
-    assert(activeList.GetSize() <= maxAudioFrameCounter);
-    // At this point it is known which participants should be mixed. Transfer
-    // this information to this functions output parameters.
-    while(!activeList.Empty())
-    {
-        ListItem* mixItem = activeList.First();
-        mixList.PushBack(mixItem->GetItem());
-        activeList.Erase(mixItem);
-    }
+    assert(numActive <= maxAudioFrameCounter);
     // Always mix a constant number of AudioFrames. If there aren't enough
     // active participants mix passive ones. Starting with those that was mixed
     // last iteration.
-    while(!passiveWasMixedList.Empty())
+    for(size_t i = 0; i < passiveWasMixedList.size(); i++)
     {
-        ListItem* mixItem = passiveWasMixedList.First();
-        ParticipantFramePair* pair = static_cast<ParticipantFramePair*>(
-            mixItem->GetItem());
-        if(mixList.GetSize() <  maxAudioFrameCounter + mixListStartSize)
+        if(mixList.size() <  maxAudioFrameCounter + mixListStartSize)
         {
-            mixList.PushBack(pair->audioFrame);
-            mixParticipantList.Insert(pair->audioFrame->id_,
-                                      static_cast<void*>(pair->participant));
-            assert(mixParticipantList.Size() <=
-                   kMaximumAmountOfMixedParticipants);
+            mixList.push_back(passiveWasMixedList[i]);
         }
         else
         {
-            _audioFramePool->PushMemory(pair->audioFrame);
+            _audioFramePool->PushMemory(passiveWasMixedList[i].audioFrame);
         }
-        delete pair;
-        passiveWasMixedList.Erase(mixItem);
     }
     // And finally the ones that have not been mixed for a while.
-    while(!passiveWasNotMixedList.Empty())
+    for(size_t i = 0; i < passiveWasNotMixedList.size(); i++)
     {
-        ListItem* mixItem = passiveWasNotMixedList.First();
-        ParticipantFramePair* pair = static_cast<ParticipantFramePair*>(
-            mixItem->GetItem());
-        if(mixList.GetSize() <  maxAudioFrameCounter + mixListStartSize)
+        if(mixList.size() <  maxAudioFrameCounter + mixListStartSize)
         {
-            mixList.PushBack(pair->audioFrame);
-            mixParticipantList.Insert(pair->audioFrame->id_,
-                                      static_cast<void*>(pair->participant));
-            assert(mixParticipantList.Size() <=
-                   kMaximumAmountOfMixedParticipants);
+            mixList.push_back(passiveWasNotMixedList[i]);
         }
         else
         {
-            _audioFramePool->PushMemory(pair->audioFrame);
+            _audioFramePool->PushMemory(passiveWasNotMixedList[i].audioFrame);
         }
-        delete pair;
-        passiveWasNotMixedList.Erase(mixItem);
     }
-    assert(maxAudioFrameCounter + mixListStartSize >= mixList.GetSize());
-    maxAudioFrameCounter += mixListStartSize - mixList.GetSize();
+    assert(mixList.size() - mixListStartSize <=
+           kMaximumAmountOfMixedParticipants);
+    assert(maxAudioFrameCounter + mixListStartSize >= mixList.size());
+    maxAudioFrameCounter += mixListStartSize - mixList.size();
 }
 
 void AudioConferenceMixerImpl::GetAdditionalAudio(
-    ListWrapper& additionalFramesList)
+    AudioFrameList& additionalFramesList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "GetAdditionalAudio(additionalFramesList)");
@@ -977,66 +933,67 @@ void AudioConferenceMixerImpl::GetAdditionalAudio(
             item = nextItem;
             continue;
         }
-        additionalFramesList.PushBack(static_cast<void*>(audioFrame));
+        additionalFramesList.push_back(audioFrame);
         item = nextItem;
     }
 }
 
 void AudioConferenceMixerImpl::UpdateMixedStatus(
-    MapWrapper& mixedParticipantsMap)
+    const ParticipantFrameList& mixList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
-                 "UpdateMixedStatus(mixedParticipantsMap)");
-    assert(mixedParticipantsMap.Size() <= kMaximumAmountOfMixedParticipants);
+                 "UpdateMixedStatus(mixList)");
+    assert(mixList.size() <= kMaximumAmountOfMixedParticipants);
 
-    // Loop through all participants. If they are in the mix map they
-    // were mixed.
+    // Loop through all participants. Only the ones in the mix list were
+    // mixed.
     ListItem* participantItem = _participantList.First();
     while(participantItem != NULL)
     {
-        bool isMixed = false;
         MixerParticipant* participant =
             static_cast<MixerParticipant*>(participantItem->GetItem());
-
-        MapItem* mixedItem = mixedParticipantsMap.First();
-        while(mixedItem)
-        {
-            if(participant == mixedItem->GetItem())
-            {
-                isMixed = true;
-                break;
-            }
-            mixedItem = mixedParticipantsMap.Next(mixedItem);
-        }
-        participant->_mixHistory->SetIsMixed(isMixed);
+        participant->_mixHistory->SetIsMixed(false);
         participantItem = _participantList.Next(participantItem);
     }
+    for(size_t i = 0; i < mixList.size(); i++)
+    {
+        mixList[i].participant->_mixHistory->SetIsMixed(true);
+    }
 }
 
-void AudioConferenceMixerImpl::ClearAudioFrameList(ListWrapper& audioFrameList)
+void AudioConferenceMixerImpl::ClearAudioFrameList(
+    AudioFrameList& audioFrameList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "ClearAudioFrameList(audioFrameList)");
-    ListItem* item = audioFrameList.First();
-    while(item)
+    for(size_t i = 0; i < audioFrameList.size(); i++)
+    {
+        _audioFramePool->PushMemory(audioFrameList[i]);
+    }
+    audioFrameList.clear();
+}
+
+void AudioConferenceMixerImpl::ClearAudioFrameList(
+    ParticipantFrameList& audioFrameList)
+{
+    WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
+                 "ClearAudioFrameList(audioFrameList)");
+    for(size_t i = 0; i < audioFrameList.size(); i++)
     {
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
-        _audioFramePool->PushMemory(audioFrame);
-        audioFrameList.Erase(item);
-        item = audioFrameList.First();
+        _audioFramePool->PushMemory(audioFrameList[i].audioFrame);
     }
+    audioFrameList.clear();
 }
 
 void AudioConferenceMixerImpl::UpdateVADPositiveParticipants(
-    ListWrapper& mixList)
+    const ParticipantFrameList& mixList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "UpdateVADPositiveParticipants(mixList)");
 
-    ListItem* item = mixList.First();
-    while(item != NULL)
+    for(size_t i = 0; i < mixList.size(); i++)
     {
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
+        AudioFrame* audioFrame = mixList[i].audioFrame;
         CalculateEnergy(*audioFrame);
         if(audioFrame->vad_activity_ == AudioFrame::kVadActive)
         {
@@ -1048,7 +1005,6 @@ void AudioConferenceMixerImpl::UpdateVADPositiveParticipants(
                 _scratchVadPositiveParticipantsAmount].level = 0;
             _scratchVadPositiveParticipantsAmount++;
         }
-        item = mixList.Next(item);
     }
 }
 
@@ -1110,13 +1066,11 @@ bool AudioConferenceMixerImpl::RemoveParticipantFromList(
 
 int32_t AudioConferenceMixerImpl::MixFromList(
     AudioFrame& mixedAudio,
-    const ListWrapper& audioFrameList)
+    const ParticipantFrameList& audioFrameList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "MixFromList(mixedAudio, audioFrameList)");
-    uint32_t position = 0;
-    ListItem* item = audioFrameList.First();
-    if(item == NULL)
+    if(audioFrameList.empty())
     {
         return 0;
     }
@@ -1124,14 +1078,15 @@ int32_t AudioConferenceMixerImpl::MixFromList(
     if(_numMixedParticipants == 1)
     {
         // No mixing required here; skip the saturation protection.
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
+        AudioFrame* audioFrame = audioFrameList.front().audioFrame;
         mixedAudio.CopyFrom(*audioFrame);
-        SetParticipantStatistics(&_scratchMixedParticipants[position],
+        SetParticipantStatistics(&_scratchMixedParticipants[0],
                                  *audioFrame);
         return 0;
     }
 
-    while(item != NULL)
+    uint32_t position = 0;
+    for(size_t i = 0; i < audioFrameList.size(); i++)
     {
         if(position >= kMaximumAmountOfMixedParticipants)
         {
@@ -1145,14 +1100,13 @@ int32_t AudioConferenceMixerImpl::MixFromList(
             assert(false);
             position = 0;
         }
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
-        MixFrames(&mixedAudio, audioFrame);
+        AudioFrame* audioFrame = audioFrameList[i].audioFrame;
+        MixFrames(&mixedAudio, *audioFrame, _mixBuffer);
 
         SetParticipantStatistics(&_scratchMixedParticipants[position],
                                  *audioFrame);
 
         position++;
-        item = audioFrameList.Next(item);
     }
 
     return 0;
@@ -1161,31 +1115,42 @@ int32_t AudioConferenceMixerImpl::MixFromList(
 // TODO(andrew): consolidate this function with MixFromList.
 int32_t AudioConferenceMixerImpl::MixAnonomouslyFromList(
     AudioFrame& mixedAudio,
-    const ListWrapper& audioFrameList)
+    const AudioFrameList& audioFrameList)
 {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "MixAnonomouslyFromList(mixedAudio, audioFrameList)");
-    ListItem* item = audioFrameList.First();
-    if(item == NULL)
+    if(audioFrameList.empty())
         return 0;
 
     if(_numMixedParticipants == 1)
     {
         // No mixing required here; skip the saturation protection.
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
-        mixedAudio.CopyFrom(*audioFrame);
+        mixedAudio.CopyFrom(*audioFrameList.front());
         return 0;
     }
 
-    while(item != NULL)
+    for(size_t i = 0; i < audioFrameList.size(); i++)
     {
-        AudioFrame* audioFrame = static_cast<AudioFrame*>(item->GetItem());
-        MixFrames(&mixedAudio, audioFrame);
-        item = audioFrameList.Next(item);
+        MixFrames(&mixedAudio, *audioFrameList[i], _mixBuffer);
     }
     return 0;
 }
 
+void AudioConferenceMixerImpl::SaturateMixedAudio(AudioFrame& mixedAudio)
+{
+    if(_numMixedParticipants == 1)
+    {
+        // The frame was copied rather than mixed.
+        return;
+    }
+
+    // Divide by two to avoid saturation in the mixing. LimitMixedAudio()
+    // restores the level.
+    SaturateSamples(_mixBuffer,
+                    mixedAudio.samples_per_channel_ * mixedAudio.num_channels_,
+                    1, mixedAudio.data_);
+}
+
 bool AudioConferenceMixerImpl::LimitMixedAudio(AudioFrame& mixedAudio)
 {
     if(_numMixedParticipants == 1)
@@ -11,6 +11,8 @@
 #ifndef WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_AUDIO_CONFERENCE_MIXER_IMPL_H_
 #define WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_AUDIO_CONFERENCE_MIXER_IMPL_H_
 
+#include <vector>
+
 #include "webrtc/engine_configurations.h"
 #include "webrtc/modules/audio_conference_mixer/interface/audio_conference_mixer.h"
 #include "webrtc/modules/audio_conference_mixer/source/level_indicator.h"
@@ -24,6 +26,14 @@ namespace webrtc {
 class AudioProcessing;
 class CriticalSectionWrapper;
 
+// A MixerParticipant and its AudioFrame for the current mix iteration.
+struct ParticipantFrame
+{
+    MixerParticipant* participant;
+    AudioFrame* audioFrame;
+    bool wasMixed;
+};
+
 // Cheshire cat implementation of MixerParticipant's non virtual functions.
 class MixHistory
 {
@@ -83,6 +93,9 @@ public:
 private:
     enum{DEFAULT_AUDIO_FRAME_POOLSIZE = 50};
 
+    typedef std::vector<ParticipantFrame> ParticipantFrameList;
+    typedef std::vector<AudioFrame*> AudioFrameList;
+
     // Set/get mix frequency
     int32_t SetOutputFrequency(const Frequency frequency);
     Frequency OutputFrequency() const;
@@ -91,16 +104,17 @@ private:
     // has changed.
     bool SetNumLimiterChannels(int numChannels);
 
-    // Fills mixList with the AudioFrames pointers that should be used when
-    // mixing. Fills mixParticipantList with ParticipantStatistics for the
-    // participants who's AudioFrames are inside mixList.
+    // Fills mixList with the AudioFrames that should be used when mixing,
+    // together with the MixerParticipants they belong to. The active
+    // participants with the highest energy are selected in a single pass over
+    // the participants.
     // maxAudioFrameCounter both input and output specifies how many more
     // AudioFrames that are allowed to be mixed.
     // rampOutList contain AudioFrames corresponding to an audio stream that
     // used to be mixed but shouldn't be mixed any longer. These AudioFrames
     // should be ramped out over this AudioFrame to avoid audio discontinuities.
-    void UpdateToMix(ListWrapper& mixList, ListWrapper& rampOutList,
-                     MapWrapper& mixParticipantList,
+    void UpdateToMix(ParticipantFrameList& mixList,
+                     AudioFrameList& rampOutList,
                      uint32_t& maxAudioFrameCounter);
 
     // Return the lowest mixing frequency that can be used without having to
@@ -109,19 +123,19 @@ private:
     int32_t GetLowestMixingFrequencyFromList(ListWrapper& mixList);
 
     // Return the AudioFrames that should be mixed anonymously.
-    void GetAdditionalAudio(ListWrapper& additionalFramesList);
+    void GetAdditionalAudio(AudioFrameList& additionalFramesList);
 
-    // Update the MixHistory of all MixerParticipants. mixedParticipantsList
-    // should contain a map of MixerParticipants that have been mixed.
-    void UpdateMixedStatus(MapWrapper& mixedParticipantsList);
+    // Update the MixHistory of all MixerParticipants. mixList should contain
+    // the MixerParticipants that have been mixed.
+    void UpdateMixedStatus(const ParticipantFrameList& mixList);
 
     // Clears audioFrameList and reclaims all memory associated with it.
-    void ClearAudioFrameList(ListWrapper& audioFrameList);
+    void ClearAudioFrameList(AudioFrameList& audioFrameList);
+    void ClearAudioFrameList(ParticipantFrameList& audioFrameList);
 
-    // Update the list of MixerParticipants who have a positive VAD. mixList
-    // should be a list of AudioFrames
+    // Update the list of MixerParticipants who have a positive VAD.
     void UpdateVADPositiveParticipants(
-        ListWrapper& mixList);
+        const ParticipantFrameList& mixList);
 
     // This function returns true if it finds the MixerParticipant in the
     // specified list of MixerParticipants.
@@ -138,15 +152,21 @@ private:
         MixerParticipant& removeParticipant,
         ListWrapper& participantList);
 
-    // Mix the AudioFrames stored in audioFrameList into mixedAudio.
+    // Mix the AudioFrames stored in audioFrameList into mixedAudio. The
+    // samples are summed in _mixBuffer and written to mixedAudio by
+    // SaturateMixedAudio().
     int32_t MixFromList(
         AudioFrame& mixedAudio,
-        const ListWrapper& audioFrameList);
+        const ParticipantFrameList& audioFrameList);
     // Mix the AudioFrames stored in audioFrameList into mixedAudio. No
     // record will be kept of this mix (e.g. the corresponding MixerParticipants
     // will not be marked as IsMixed()
     int32_t MixAnonomouslyFromList(AudioFrame& mixedAudio,
-                                   const ListWrapper& audioFrameList);
+                                   const AudioFrameList& audioFrameList);
+
+    // Writes the mix in _mixBuffer to mixedAudio, halved to leave headroom
+    // for the limiter.
+    void SaturateMixedAudio(AudioFrame& mixedAudio);
 
     bool LimitMixedAudio(AudioFrame& mixedAudio);
 
@@ -159,6 +179,15 @@ private:
     uint32_t         _scratchVadPositiveParticipantsAmount;
     ParticipantStatistics  _scratchVadPositiveParticipants[
         kMaximumAmountOfMixedParticipants];
+    // The frames of the current mix iteration. The lists keep their capacity
+    // between iterations.
+    ParticipantFrameList _scratchMixList;
+    AudioFrameList _scratchRampOutList;
+    AudioFrameList _scratchAdditionalFramesList;
+    ParticipantFrameList _scratchPassiveWasMixedList;
+    ParticipantFrameList _scratchPassiveWasNotMixedList;
+    // Sum of the mixed frames, which doesn't overflow before 65536 frames.
+    int32_t _mixBuffer[AudioFrame::kMaxDataSizeSamples];
 
     scoped_ptr<CriticalSectionWrapper> _crit;
     scoped_ptr<CriticalSectionWrapper> _cbCrit;
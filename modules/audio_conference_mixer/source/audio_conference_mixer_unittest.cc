@@ -0,0 +1,253 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/audio_conference_mixer/interface/audio_conference_mixer.h"
+#include "webrtc/modules/audio_conference_mixer/interface/audio_conference_mixer_defines.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kSampleRateHz = 16000;
+const int kSamplesPerChannel = kSampleRateHz / 100;
+
+// Delivers a constant signal of |amplitude|, which is also its energy order.
+class FakeParticipant : public MixerParticipant {
+ public:
+  FakeParticipant(int id, int16_t amplitude,
+                  AudioFrame::VADActivity vad_activity)
+      : id_(id),
+        amplitude_(amplitude),
+        vad_activity_(vad_activity) {}
+  virtual ~FakeParticipant() {}
+
+  virtual int32_t GetAudioFrame(const int32_t id, AudioFrame& audio_frame) {
+    int16_t samples[kSamplesPerChannel];
+    for (int i = 0; i < kSamplesPerChannel; ++i) {
+      samples[i] = (i & 1) ? amplitude_ : -amplitude_;
+    }
+    audio_frame.UpdateFrame(id_, 0, samples, kSamplesPerChannel,
+                            kSampleRateHz, AudioFrame::kNormalSpeech,
+                            vad_activity_, 1);
+    return 0;
+  }
+
+  virtual int32_t NeededFrequency(const int32_t id) {
+    return kSampleRateHz;
+  }
+
+  void set_amplitude(int16_t amplitude) { amplitude_ = amplitude; }
+  void set_vad_activity(AudioFrame::VADActivity vad_activity) {
+    vad_activity_ = vad_activity;
+  }
+
+  bool IsMixed() const {
+    bool mixed = false;
+    MixerParticipant::IsMixed(mixed);
+    return mixed;
+  }
+
+ private:
+  const int id_;
+  int16_t amplitude_;
+  AudioFrame::VADActivity vad_activity_;
+};
+
+class OutputReceiver : public AudioMixerOutputReceiver {
+ public:
+  OutputReceiver() : num_mixed_frames_(0), peak_(0) {}
+  virtual ~OutputReceiver() {}
+
+  virtual void NewMixedAudio(const int32_t id,
+                             const AudioFrame& general_audio_frame,
+                             const AudioFrame** unique_audio_frames,
+                             const uint32_t size) {
+    ++num_mixed_frames_;
+    samples_per_channel_ = general_audio_frame.samples_per_channel_;
+    peak_ = 0;
+    for (int i = 0; i < general_audio_frame.samples_per_channel_; ++i) {
+      peak_ = std::max(peak_, abs(general_audio_frame.data_[i]));
+    }
+  }
+
+  int num_mixed_frames_;
+  int samples_per_channel_;
+  int peak_;
+};
+
+}  // namespace
+
+class AudioConferenceMixerTest : public ::testing::Test {
+ protected:
+  AudioConferenceMixerTest()
+      : mixer_(AudioConferenceMixer::Create(0)) {}
+
+  virtual void SetUp() {
+    ASSERT_TRUE(mixer_.get() != NULL);
+    ASSERT_EQ(0, mixer_->RegisterMixedStreamCallback(receiver_));
+  }
+
+  virtual void TearDown() {
+    for (size_t i = 0; i < participants_.size(); ++i) {
+      EXPECT_EQ(0, mixer_->SetMixabilityStatus(*participants_[i], false));
+      delete participants_[i];
+    }
+    EXPECT_EQ(0, mixer_->UnRegisterMixedStreamCallback());
+  }
+
+  FakeParticipant* AddParticipant(int16_t amplitude,
+                                  AudioFrame::VADActivity vad_activity) {
+    FakeParticipant* participant = new FakeParticipant(
+        static_cast<int>(participants_.size()), amplitude, vad_activity);
+    participants_.push_back(participant);
+    EXPECT_EQ(0, mixer_->SetMixabilityStatus(*participant, true));
+    return participant;
+  }
+
+  int NumMixed() const {
+    int num_mixed = 0;
+    for (size_t i = 0; i < participants_.size(); ++i) {
+      num_mixed += participants_[i]->IsMixed() ? 1 : 0;
+    }
+    return num_mixed;
+  }
+
+  scoped_ptr<AudioConferenceMixer> mixer_;
+  OutputReceiver receiver_;
+  std::vector<FakeParticipant*> participants_;
+};
+
+TEST_F(AudioConferenceMixerTest, MixesSilenceWithoutParticipants) {
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_EQ(1, receiver_.num_mixed_frames_);
+  EXPECT_EQ(AudioConferenceMixer::kNbInHz / 100,
+            receiver_.samples_per_channel_);
+  EXPECT_EQ(0, receiver_.peak_);
+}
+
+TEST_F(AudioConferenceMixerTest, SingleParticipantIsCopied) {
+  AddParticipant(1000, AudioFrame::kVadActive);
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_EQ(1, receiver_.num_mixed_frames_);
+  EXPECT_EQ(kSamplesPerChannel, receiver_.samples_per_channel_);
+  EXPECT_EQ(1000, receiver_.peak_);
+  EXPECT_TRUE(participants_[0]->IsMixed());
+}
+
+TEST_F(AudioConferenceMixerTest, MixesLoudestActiveParticipants) {
+  const int kNumParticipants = 20;
+  // Amplitudes in a scrambled order, with the loudest ones at 11, 14 and 17.
+  for (int i = 0; i < kNumParticipants; ++i) {
+    AddParticipant(static_cast<int16_t>(100 + (i * 7) % kNumParticipants),
+                   AudioFrame::kVadActive);
+  }
+  participants_[3]->set_vad_activity(AudioFrame::kVadPassive);
+  participants_[3]->set_amplitude(10000);
+
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_EQ(AudioConferenceMixer::kMaximumAmountOfMixedParticipants,
+            NumMixed());
+  for (int i = 0; i < kNumParticipants; ++i) {
+    EXPECT_EQ(i == 11 || i == 14 || i == 17, participants_[i]->IsMixed())
+        << "participant " << i;
+  }
+  EXPECT_GT(receiver_.peak_, 0);
+
+  // A new loud talker replaces the quietest of the mixed participants.
+  participants_[0]->set_amplitude(1000);
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_EQ(AudioConferenceMixer::kMaximumAmountOfMixedParticipants,
+            NumMixed());
+  EXPECT_TRUE(participants_[0]->IsMixed());
+  EXPECT_FALSE(participants_[11]->IsMixed());
+  EXPECT_TRUE(participants_[14]->IsMixed());
+  EXPECT_TRUE(participants_[17]->IsMixed());
+}
+
+TEST_F(AudioConferenceMixerTest, FillsUpWithPassiveParticipants) {
+  AddParticipant(100, AudioFrame::kVadPassive);
+  AddParticipant(100, AudioFrame::kVadActive);
+  AddParticipant(100, AudioFrame::kVadPassive);
+  AddParticipant(100, AudioFrame::kVadPassive);
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_TRUE(participants_[0]->IsMixed());
+  EXPECT_TRUE(participants_[1]->IsMixed());
+  EXPECT_TRUE(participants_[2]->IsMixed());
+  EXPECT_FALSE(participants_[3]->IsMixed());
+
+  // Active participants come first, then the passive ones which were mixed
+  // before, in the order they were added.
+  participants_[1]->set_vad_activity(AudioFrame::kVadPassive);
+  participants_[3]->set_vad_activity(AudioFrame::kVadActive);
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_TRUE(participants_[0]->IsMixed());
+  EXPECT_TRUE(participants_[1]->IsMixed());
+  EXPECT_FALSE(participants_[2]->IsMixed());
+  EXPECT_TRUE(participants_[3]->IsMixed());
+}
+
+TEST_F(AudioConferenceMixerTest, AnonymousParticipantIsAlwaysMixed) {
+  for (int i = 0; i < 5; ++i) {
+    AddParticipant(static_cast<int16_t>(1000 + i), AudioFrame::kVadActive);
+  }
+  FakeParticipant* anonymous = AddParticipant(1, AudioFrame::kVadPassive);
+  EXPECT_EQ(0, mixer_->SetAnonymousMixabilityStatus(*anonymous, true));
+  EXPECT_EQ(0, mixer_->Process());
+  // Anonymous participants don't count toward the mixed participants and
+  // aren't marked as mixed.
+  EXPECT_EQ(AudioConferenceMixer::kMaximumAmountOfMixedParticipants,
+            NumMixed());
+  EXPECT_FALSE(anonymous->IsMixed());
+  EXPECT_EQ(1, receiver_.num_mixed_frames_);
+}
+
+TEST_F(AudioConferenceMixerTest, HalvesTheSumOfTheMixedFrames) {
+  // The frames are summed before the sum is halved for the limiter, so the
+  // low bits of the frames aren't lost. Halving each frame before adding it
+  // would have mixed silence.
+  AddParticipant(1, AudioFrame::kVadActive);
+  AddParticipant(1, AudioFrame::kVadActive);
+  EXPECT_EQ(0, mixer_->Process());
+  EXPECT_EQ(2, receiver_.peak_);
+}
+
+// Measures the cost of a 10 ms mix iteration in conferences of growing size,
+// where every participant is talking.
+TEST_F(AudioConferenceMixerTest, DISABLED_ProcessBenchmark) {
+  const int kNumParticipants[] = { 1, 3, 10, 30, 100, 300 };
+  const int kIterations = 1000;
+  int num_added = 0;
+  for (size_t i = 0; i < sizeof(kNumParticipants) / sizeof(kNumParticipants[0]);
+       ++i) {
+    for (; num_added < kNumParticipants[i]; ++num_added) {
+      AddParticipant(static_cast<int16_t>(100 + (num_added * 37) % 1000),
+                     AudioFrame::kVadActive);
+    }
+    TickTime start = TickTime::Now();
+    for (int j = 0; j < kIterations; ++j) {
+      ASSERT_EQ(0, mixer_->Process());
+    }
+    const double total_time_us =
+        static_cast<double>((TickTime::Now() - start).Microseconds());
+    printf("Process() with %d participants took %.2fus per 10 ms tick.\n",
+           kNumParticipants[i], total_time_us / kIterations);
+  }
+}
+
+}  // namespace webrtc
@@ -13,8 +13,9 @@
 
 #include <assert.h>
 
+#include <vector>
+
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
-#include "webrtc/system_wrappers/interface/list_wrapper.h"
 #include "webrtc/typedefs.h"
 
 namespace webrtc {
@@ -40,7 +41,9 @@ private:
 
     bool _terminate;
 
-    ListWrapper _memoryPool;
+    // Unused memory. Stored in a vector, which keeps its capacity, so that
+    // popping and pushing memory doesn't allocate.
+    std::vector<MemoryType*> _memoryPool;
 
     uint32_t _initialPoolSize;
     uint32_t _createdMemory;
@@ -76,20 +79,19 @@ int32_t MemoryPoolImpl<MemoryType>::PopMemory(MemoryType*& memory)
         memory = NULL;
         return -1;
     }
-    ListItem* item = _memoryPool.First();
-    if(item == NULL)
+    if(_memoryPool.empty())
     {
         // _memoryPool empty create new memory.
         CreateMemory(_initialPoolSize);
-        item = _memoryPool.First();
-        if(item == NULL)
+        if(_memoryPool.empty())
         {
             memory = NULL;
             return -1;
         }
     }
-    memory = static_cast<MemoryType*>(item->GetItem());
-    _memoryPool.Erase(item);
+    // The most recently returned memory is the most likely to be cached.
+    memory = _memoryPool.back();
+    _memoryPool.pop_back();
     _outstandingMemory++;
     return 0;
 }
@@ -103,7 +105,7 @@ int32_t MemoryPoolImpl<MemoryType>::PushMemory(MemoryType*& memory)
     }
     CriticalSectionScoped cs(_crit);
     _outstandingMemory--;
-    if(_memoryPool.GetSize() > (_initialPoolSize << 1))
+    if(_memoryPool.size() > (_initialPoolSize << 1))
     {
         // Reclaim memory if less than half of the pool is unused.
         _createdMemory--;
@@ -111,7 +113,7 @@ int32_t MemoryPoolImpl<MemoryType>::PushMemory(MemoryType*& memory)
         memory = NULL;
         return 0;
     }
-    _memoryPool.PushBack(static_cast<void*>(memory));
+    _memoryPool.push_back(memory);
     memory = NULL;
     return 0;
 }
@@ -127,21 +129,19 @@ template<class MemoryType>
 int32_t MemoryPoolImpl<MemoryType>::Terminate()
 {
     CriticalSectionScoped cs(_crit);
-    assert(_createdMemory == _outstandingMemory + _memoryPool.GetSize());
+    assert(_createdMemory == _outstandingMemory + _memoryPool.size());
 
     _terminate = true;
     // Reclaim all memory.
     while(_createdMemory > 0)
     {
-        ListItem* item = _memoryPool.First();
-        if(item == NULL)
+        if(_memoryPool.empty())
         {
             // There is memory that hasn't been returned yet.
             return -1;
         }
-        MemoryType* memory = static_cast<MemoryType*>(item->GetItem());
-        delete memory;
-        _memoryPool.Erase(item);
+        delete _memoryPool.back();
+        _memoryPool.pop_back();
         _createdMemory--;
     }
     return 0;
@@ -158,7 +158,7 @@ int32_t MemoryPoolImpl<MemoryType>::CreateMemory(
         {
             return -1;
         }
-        _memoryPool.PushBack(static_cast<void*>(memory));
+        _memoryPool.push_back(memory);
         _createdMemory++;
     }
     return 0;
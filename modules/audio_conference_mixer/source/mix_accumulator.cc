@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_conference_mixer/source/mix_accumulator.h"
+
+#include <stddef.h>
+
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/system_wrappers/interface/once.h"
+
+namespace webrtc {
+
+namespace {
+
+typedef void (*AccumulateSamplesFunction)(const int16_t*, int, int32_t*);
+typedef void (*SaturateSamplesFunction)(const int32_t*, int, int, int16_t*);
+
+AccumulateSamplesFunction accumulate_samples = NULL;
+SaturateSamplesFunction saturate_samples = NULL;
+
+void InitFunctions() {
+#if defined(WEBRTC_MIX_ACCUMULATOR_SSE2)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    saturate_samples = &SaturateSamples_SSE2;
+    accumulate_samples = &AccumulateSamples_SSE2;
+    return;
+  }
+#endif
+  saturate_samples = &SaturateSamples_C;
+  accumulate_samples = &AccumulateSamples_C;
+}
+
+// Calls InitFunctions() once, whichever thread mixes first.
+void InitFunctionsOnce() {
+  static WebRtc_OnceState once_state = WEBRTC_ONCE_INIT;
+  WebRtc_Once(&once_state, &InitFunctions);
+}
+
+}  // namespace
+
+void AccumulateSamples_C(const int16_t* source, int length,
+                         int32_t* accumulator) {
+  for (int i = 0; i < length; ++i) {
+    accumulator[i] += source[i];
+  }
+}
+
+void SaturateSamples_C(const int32_t* accumulator, int length, int shift,
+                       int16_t* destination) {
+  for (int i = 0; i < length; ++i) {
+    const int32_t sample = accumulator[i] >> shift;
+    if (sample > 32767) {
+      destination[i] = 32767;
+    } else if (sample < -32768) {
+      destination[i] = -32768;
+    } else {
+      destination[i] = static_cast<int16_t>(sample);
+    }
+  }
+}
+
+void AccumulateSamples(const int16_t* source, int length,
+                       int32_t* accumulator) {
+  InitFunctionsOnce();
+  accumulate_samples(source, length, accumulator);
+}
+
+void AccumulateMonoToStereo(const int16_t* source, int samples_per_channel,
+                            int32_t* accumulator) {
+  for (int i = 0; i < samples_per_channel; ++i) {
+    accumulator[2 * i] += source[i];
+    accumulator[2 * i + 1] += source[i];
+  }
+}
+
+void SaturateSamples(const int32_t* accumulator, int length, int shift,
+                     int16_t* destination) {
+  InitFunctionsOnce();
+  saturate_samples(accumulator, length, shift, destination);
+}
+
+}  // namespace webrtc
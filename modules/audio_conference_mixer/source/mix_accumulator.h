@@ -0,0 +1,52 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_MIX_ACCUMULATOR_H_
+#define WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_MIX_ACCUMULATOR_H_
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// The mixer sums its frames into a 32 bit accumulator, which can't overflow
+// for any realistic number of frames, and saturates once when writing the
+// mixed frame.
+
+// Adds the |length| samples of |source| to |accumulator|.
+void AccumulateSamples(const int16_t* source, int length,
+                       int32_t* accumulator);
+
+// Adds each of the |samples_per_channel| samples of the mono |source| to both
+// channels of the interleaved stereo |accumulator|.
+void AccumulateMonoToStereo(const int16_t* source, int samples_per_channel,
+                            int32_t* accumulator);
+
+// Writes the |length| samples of |accumulator|, arithmetically shifted right
+// by |shift| bits and saturated to 16 bits, to |destination|.
+void SaturateSamples(const int32_t* accumulator, int length, int shift,
+                     int16_t* destination);
+
+// The individual implementations, exposed for testing and benchmarking. The
+// SSE2 versions are built in a separate target with its own compiler flags,
+// which defines WEBRTC_MIX_ACCUMULATOR_SSE2 for the dependent code.
+void AccumulateSamples_C(const int16_t* source, int length,
+                         int32_t* accumulator);
+void SaturateSamples_C(const int32_t* accumulator, int length, int shift,
+                       int16_t* destination);
+#if defined(WEBRTC_MIX_ACCUMULATOR_SSE2)
+void AccumulateSamples_SSE2(const int16_t* source, int length,
+                            int32_t* accumulator);
+void SaturateSamples_SSE2(const int32_t* accumulator, int length, int shift,
+                          int16_t* destination);
+#endif
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_MIX_ACCUMULATOR_H_
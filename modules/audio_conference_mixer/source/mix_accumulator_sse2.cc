@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_conference_mixer/source/mix_accumulator.h"
+
+#include <emmintrin.h>
+
+namespace webrtc {
+
+void AccumulateSamples_SSE2(const int16_t* source, int length,
+                            int32_t* accumulator) {
+  int i = 0;
+  for (; i + 8 <= length; i += 8) {
+    const __m128i samples =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i]));
+    // Sign extend to 32 bits by placing each sample in the upper half of a
+    // 32 bit lane and shifting it back down.
+    const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples),
+                                       16);
+    const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples),
+                                        16);
+    __m128i* sum = reinterpret_cast<__m128i*>(&accumulator[i]);
+    _mm_storeu_si128(sum, _mm_add_epi32(_mm_loadu_si128(sum), low));
+    _mm_storeu_si128(sum + 1, _mm_add_epi32(_mm_loadu_si128(sum + 1), high));
+  }
+  for (; i < length; ++i) {
+    accumulator[i] += source[i];
+  }
+}
+
+void SaturateSamples_SSE2(const int32_t* accumulator, int length, int shift,
+                          int16_t* destination) {
+  const __m128i count = _mm_cvtsi32_si128(shift);
+  int i = 0;
+  for (; i + 8 <= length; i += 8) {
+    const __m128i* sum = reinterpret_cast<const __m128i*>(&accumulator[i]);
+    const __m128i low = _mm_sra_epi32(_mm_loadu_si128(sum), count);
+    const __m128i high = _mm_sra_epi32(_mm_loadu_si128(sum + 1), count);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&destination[i]),
+                     _mm_packs_epi32(low, high));
+  }
+  for (; i < length; ++i) {
+    const int32_t sample = accumulator[i] >> shift;
+    if (sample > 32767) {
+      destination[i] = 32767;
+    } else if (sample < -32768) {
+      destination[i] = -32768;
+    } else {
+      destination[i] = static_cast<int16_t>(sample);
+    }
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,134 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/audio_conference_mixer/source/mix_accumulator.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+
+namespace webrtc {
+
+namespace {
+
+typedef void (*AccumulateSamplesFunction)(const int16_t*, int, int32_t*);
+typedef void (*SaturateSamplesFunction)(const int32_t*, int, int, int16_t*);
+
+const int kMaxLength = 960;
+
+// Lengths around the vector width, including the empty buffer.
+const int kTestLengths[] = { 0, 1, 7, 8, 9, 15, 16, 17, 160, 321, 960 };
+
+int16_t RandomSample() {
+  return static_cast<int16_t>(rand() - RAND_MAX / 2);
+}
+
+void VerifyAccumulateSamples(AccumulateSamplesFunction accumulate_samples) {
+  int16_t source[kMaxLength + 1];
+  int32_t accumulator[kMaxLength + 1];
+  int32_t expected[kMaxLength + 1];
+  for (size_t l = 0; l < sizeof(kTestLengths) / sizeof(kTestLengths[0]); ++l) {
+    const int length = kTestLengths[l];
+    for (int i = 0; i <= kMaxLength; ++i) {
+      source[i] = RandomSample();
+      accumulator[i] = rand() - RAND_MAX / 2;
+      expected[i] = accumulator[i];
+    }
+    for (int i = 0; i < length; ++i) {
+      expected[i] += source[i];
+    }
+    accumulate_samples(source, length, accumulator);
+    for (int i = 0; i <= kMaxLength; ++i) {
+      ASSERT_EQ(expected[i], accumulator[i]) << "length " << length
+                                             << ", sample " << i;
+    }
+  }
+}
+
+void VerifySaturateSamples(SaturateSamplesFunction saturate_samples) {
+  int32_t accumulator[kMaxLength];
+  int16_t destination[kMaxLength + 1];
+  for (size_t l = 0; l < sizeof(kTestLengths) / sizeof(kTestLengths[0]); ++l) {
+    const int length = kTestLengths[l];
+    for (int shift = 0; shift < 3; ++shift) {
+      for (int i = 0; i < length; ++i) {
+        // Sums of up to eight frames, which saturate now and then.
+        accumulator[i] = 0;
+        for (int j = rand() % 8; j >= 0; --j) {
+          accumulator[i] += RandomSample();
+        }
+      }
+      destination[length] = 4711;
+      saturate_samples(accumulator, length, shift, destination);
+      for (int i = 0; i < length; ++i) {
+        int32_t expected = accumulator[i] >> shift;
+        expected = std::min(std::max(expected, -32768), 32767);
+        ASSERT_EQ(expected, destination[i]) << "length " << length
+                                            << ", sample " << i;
+      }
+      EXPECT_EQ(4711, destination[length]);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(MixAccumulatorTest, AccumulateSamples) {
+  VerifyAccumulateSamples(&AccumulateSamples_C);
+  VerifyAccumulateSamples(&AccumulateSamples);
+#if defined(WEBRTC_MIX_ACCUMULATOR_SSE2)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    VerifyAccumulateSamples(&AccumulateSamples_SSE2);
+  }
+#endif
+}
+
+TEST(MixAccumulatorTest, SaturateSamples) {
+  VerifySaturateSamples(&SaturateSamples_C);
+  VerifySaturateSamples(&SaturateSamples);
+#if defined(WEBRTC_MIX_ACCUMULATOR_SSE2)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    VerifySaturateSamples(&SaturateSamples_SSE2);
+  }
+#endif
+}
+
+TEST(MixAccumulatorTest, MixesWithOneRoundingAndSaturation) {
+  // The mixer sums the frames in full precision, then halves and saturates
+  // the sum once.
+  const int16_t kFrames[][4] = { { 1, 32767, -3, 32767 },
+                                 { 1, 32767, -3, 32767 },
+                                 { 1, 32767, 1, 32767 },
+                                 { 0, -32768, 0, 32767 } };
+  int32_t accumulator[4] = { 0, 0, 0, 0 };
+  for (int i = 0; i < 4; ++i) {
+    AccumulateSamples(kFrames[i], 4, accumulator);
+  }
+  int16_t mixed[4];
+  SaturateSamples(accumulator, 4, 1, mixed);
+  const int16_t kExpected[] = { 1, 32766, -3, 32767 };
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(kExpected[i], mixed[i]) << "sample " << i;
+  }
+}
+
+TEST(MixAccumulatorTest, AccumulateMonoToStereo) {
+  const int16_t kMono[] = { 1, -2, 32767, -32768 };
+  int32_t accumulator[8] = { 10, 20, 30, 40, 50, 60, 70, 80 };
+  AccumulateMonoToStereo(kMono, 4, accumulator);
+  const int32_t kExpected[] = { 11, 21, 28, 38, 32817, 32827, -32698, -32688 };
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(kExpected[i], accumulator[i]);
+  }
+}
+
+}  // namespace webrtc
@@ -28,6 +28,7 @@ LOCAL_SRC_FILES := \
     noise_suppression_impl.cc \
     splitting_filter.cc \
     processing_component.cc \
+    render_queue.cc \
     voice_detection_impl.cc
 
 # Flags passed to both C and C++ files.
@@ -118,7 +118,7 @@ extern int webrtc_aec_instance_count;
 // "Private" function prototypes.
 static void ProcessBlock(AecCore* aec);
 
-static void NonLinearProcessing(AecCore* aec, short *output, short *outputH);
+static void NonLinearProcessing(AecCore* aec, float* output, float* outputH);
 
 static void GetHighbandGain(const float *lambda, float *nlpGainHband);
 
@@ -165,7 +165,7 @@ int WebRtcAec_CreateAec(AecCore** aecInst)
     }
 
     aec->nearFrBuf = WebRtc_CreateBuffer(FRAME_LEN + PART_LEN,
-                                         sizeof(int16_t));
+                                         sizeof(float));
     if (!aec->nearFrBuf) {
         WebRtcAec_FreeAec(aec);
         aec = NULL;
@@ -173,7 +173,7 @@ int WebRtcAec_CreateAec(AecCore** aecInst)
     }
 
     aec->outFrBuf = WebRtc_CreateBuffer(FRAME_LEN + PART_LEN,
-                                        sizeof(int16_t));
+                                        sizeof(float));
     if (!aec->outFrBuf) {
         WebRtcAec_FreeAec(aec);
         aec = NULL;
@@ -181,7 +181,7 @@ int WebRtcAec_CreateAec(AecCore** aecInst)
     }
 
     aec->nearFrBufH = WebRtc_CreateBuffer(FRAME_LEN + PART_LEN,
-                                          sizeof(int16_t));
+                                          sizeof(float));
     if (!aec->nearFrBufH) {
         WebRtcAec_FreeAec(aec);
         aec = NULL;
@@ -189,7 +189,7 @@ int WebRtcAec_CreateAec(AecCore** aecInst)
     }
 
     aec->outFrBufH = WebRtc_CreateBuffer(FRAME_LEN + PART_LEN,
-                                         sizeof(int16_t));
+                                         sizeof(float));
     if (!aec->outFrBufH) {
         WebRtcAec_FreeAec(aec);
         aec = NULL;
@@ -415,10 +415,62 @@ static void OverdriveAndSuppress(AecCore* aec, float hNl[PART_LEN1],
   }
 }
 
+static void SubbandCoherence(AecCore* aec,
+                             float efw[2][PART_LEN1],
+                             float dfw[2][PART_LEN1],
+                             float xfw[2][PART_LEN1],
+                             float* cohde,
+                             float* cohxd,
+                             float* sdSum,
+                             float* seSum) {
+  // Power estimate smoothing coefficients
+  const float gCoh[2][2] = {{0.9f, 0.1f}, {0.93f, 0.07f}};
+  const float *ptrGCoh = gCoh[aec->mult - 1];
+  int i;
+
+  // Smoothed PSD
+  for (i = 0; i < PART_LEN1; i++) {
+    aec->sd[i] = ptrGCoh[0] * aec->sd[i] + ptrGCoh[1] *
+        (dfw[0][i] * dfw[0][i] + dfw[1][i] * dfw[1][i]);
+    aec->se[i] = ptrGCoh[0] * aec->se[i] + ptrGCoh[1] *
+        (efw[0][i] * efw[0][i] + efw[1][i] * efw[1][i]);
+    // We threshold here to protect against the ill-effects of a zero farend.
+    // The threshold is not arbitrarily chosen, but balances protection and
+    // adverse interaction with the algorithm's tuning.
+    // TODO: investigate further why this is so sensitive.
+    aec->sx[i] = ptrGCoh[0] * aec->sx[i] + ptrGCoh[1] *
+        WEBRTC_SPL_MAX(xfw[0][i] * xfw[0][i] + xfw[1][i] * xfw[1][i], 15);
+
+    aec->sde[i][0] = ptrGCoh[0] * aec->sde[i][0] + ptrGCoh[1] *
+        (dfw[0][i] * efw[0][i] + dfw[1][i] * efw[1][i]);
+    aec->sde[i][1] = ptrGCoh[0] * aec->sde[i][1] + ptrGCoh[1] *
+        (dfw[0][i] * efw[1][i] - dfw[1][i] * efw[0][i]);
+
+    aec->sxd[i][0] = ptrGCoh[0] * aec->sxd[i][0] + ptrGCoh[1] *
+        (dfw[0][i] * xfw[0][i] + dfw[1][i] * xfw[1][i]);
+    aec->sxd[i][1] = ptrGCoh[0] * aec->sxd[i][1] + ptrGCoh[1] *
+        (dfw[0][i] * xfw[1][i] - dfw[1][i] * xfw[0][i]);
+
+    *sdSum += aec->sd[i];
+    *seSum += aec->se[i];
+  }
+
+  // Subband coherence
+  for (i = 0; i < PART_LEN1; i++) {
+    cohde[i] = (aec->sde[i][0] * aec->sde[i][0] +
+                aec->sde[i][1] * aec->sde[i][1]) /
+        (aec->sd[i] * aec->se[i] + 1e-10f);
+    cohxd[i] = (aec->sxd[i][0] * aec->sxd[i][0] +
+                aec->sxd[i][1] * aec->sxd[i][1]) /
+        (aec->sx[i] * aec->sd[i] + 1e-10f);
+  }
+}
+
 WebRtcAec_FilterFar_t WebRtcAec_FilterFar;
 WebRtcAec_ScaleErrorSignal_t WebRtcAec_ScaleErrorSignal;
 WebRtcAec_FilterAdaptation_t WebRtcAec_FilterAdaptation;
 WebRtcAec_OverdriveAndSuppress_t WebRtcAec_OverdriveAndSuppress;
+WebRtcAec_SubbandCoherence_t WebRtcAec_SubbandCoherence;
 
 int WebRtcAec_InitAec(AecCore* aec, int sampFreq)
 {
@@ -556,11 +608,17 @@ int WebRtcAec_InitAec(AecCore* aec, int sampFreq)
     WebRtcAec_ScaleErrorSignal = ScaleErrorSignal;
     WebRtcAec_FilterAdaptation = FilterAdaptation;
     WebRtcAec_OverdriveAndSuppress = OverdriveAndSuppress;
+    WebRtcAec_SubbandCoherence = SubbandCoherence;
 
 #if defined(WEBRTC_ARCH_X86_FAMILY)
     if (WebRtc_GetCPUInfo(kSSE2)) {
       WebRtcAec_InitAec_SSE2();
     }
+#if defined(WEBRTC_AUDIOPROC_AVX)
+    if (WebRtc_GetCPUInfo(kAVX)) {
+      WebRtcAec_InitAec_AVX();
+    }
+#endif
 #endif
 
     aec_rdft_init();
@@ -598,11 +656,11 @@ int WebRtcAec_MoveFarReadPtr(AecCore* aec, int elements) {
 }
 
 void WebRtcAec_ProcessFrame(AecCore* aec,
-                            const short* nearend,
-                            const short* nearendH,
+                            const float* nearend,
+                            const float* nearendH,
                             int knownDelay,
-                            int16_t* out,
-                            int16_t* outH) {
+                            float* out,
+                            float* outH) {
     int out_elements = 0;
 
     // For each frame the process is as follows:
@@ -803,10 +861,10 @@ static void ProcessBlock(AecCore* aec) {
     const float ramp = 1.0002f;
     const float gInitNoise[2] = {0.999f, 0.001f};
 
-    int16_t nearend[PART_LEN];
-    int16_t* nearend_ptr = NULL;
-    int16_t output[PART_LEN];
-    int16_t outputH[PART_LEN];
+    float nearend[PART_LEN];
+    float* nearend_ptr = NULL;
+    float output[PART_LEN];
+    float outputH[PART_LEN];
 
     float* xf_ptr = NULL;
 
@@ -817,27 +875,28 @@ static void ProcessBlock(AecCore* aec) {
                         (void**) &nearend_ptr,
                         nearend,
                         PART_LEN);
-      for (i = 0; i < PART_LEN; i++) {
-          dH[i] = (float) (nearend_ptr[i]);
-      }
+      memcpy(dH, nearend_ptr, sizeof(float) * PART_LEN);
       memcpy(aec->dBufH + PART_LEN, dH, sizeof(float) * PART_LEN);
     }
     WebRtc_ReadBuffer(aec->nearFrBuf, (void**) &nearend_ptr, nearend, PART_LEN);
 
     // ---------- Ooura fft ----------
     // Concatenate old and new nearend blocks.
-    for (i = 0; i < PART_LEN; i++) {
-        d[i] = (float) (nearend_ptr[i]);
-    }
+    memcpy(d, nearend_ptr, sizeof(float) * PART_LEN);
     memcpy(aec->dBuf + PART_LEN, d, sizeof(float) * PART_LEN);
 
 #ifdef WEBRTC_AEC_DEBUG_DUMP
     {
         int16_t farend[PART_LEN];
         int16_t* farend_ptr = NULL;
+        int16_t nearendInt16[PART_LEN];
         WebRtc_ReadBuffer(aec->far_time_buf, (void**) &farend_ptr, farend, 1);
+        for (i = 0; i < PART_LEN; i++) {
+            nearendInt16[i] = (int16_t)WEBRTC_SPL_SAT(WEBRTC_SPL_WORD16_MAX,
+                nearend_ptr[i], WEBRTC_SPL_WORD16_MIN);
+        }
         (void)fwrite(farend_ptr, sizeof(int16_t), PART_LEN, aec->farFile);
-        (void)fwrite(nearend_ptr, sizeof(int16_t), PART_LEN, aec->nearFile);
+        (void)fwrite(nearendInt16, sizeof(int16_t), PART_LEN, aec->nearFile);
     }
 #endif
 
@@ -990,18 +1049,20 @@ static void ProcessBlock(AecCore* aec) {
 #ifdef WEBRTC_AEC_DEBUG_DUMP
     {
         int16_t eInt16[PART_LEN];
+        int16_t outputInt16[PART_LEN];
         for (i = 0; i < PART_LEN; i++) {
             eInt16[i] = (int16_t)WEBRTC_SPL_SAT(WEBRTC_SPL_WORD16_MAX, e[i],
                 WEBRTC_SPL_WORD16_MIN);
+            outputInt16[i] = (int16_t)output[i];
         }
 
         (void)fwrite(eInt16, sizeof(int16_t), PART_LEN, aec->outLinearFile);
-        (void)fwrite(output, sizeof(int16_t), PART_LEN, aec->outFile);
+        (void)fwrite(outputInt16, sizeof(int16_t), PART_LEN, aec->outFile);
     }
 #endif
 }
 
-static void NonLinearProcessing(AecCore* aec, short *output, short *outputH)
+static void NonLinearProcessing(AecCore* aec, float* output, float* outputH)
 {
     float efw[2][PART_LEN1], dfw[2][PART_LEN1], xfw[2][PART_LEN1];
     complex_t comfortNoiseHband[PART_LEN1];
@@ -1023,10 +1084,6 @@ static void NonLinearProcessing(AecCore* aec, short *output, short *outputH)
     // Near and error power sums
     float sdSum = 0, seSum = 0;
 
-    // Power estimate smoothing coefficients
-    const float gCoh[2][2] = {{0.9f, 0.1f}, {0.93f, 0.07f}};
-    const float *ptrGCoh = gCoh[aec->mult - 1];
-
     // Filter energy
     float wfEnMax = 0, wfEn = 0;
     const int delayEstInterval = 10 * aec->mult;
@@ -1107,32 +1164,9 @@ static void NonLinearProcessing(AecCore* aec, short *output, short *outputH)
         efw[1][i] = fft[2 * i + 1];
     }
 
-    // Smoothed PSD
-    for (i = 0; i < PART_LEN1; i++) {
-        aec->sd[i] = ptrGCoh[0] * aec->sd[i] + ptrGCoh[1] *
-            (dfw[0][i] * dfw[0][i] + dfw[1][i] * dfw[1][i]);
-        aec->se[i] = ptrGCoh[0] * aec->se[i] + ptrGCoh[1] *
-            (efw[0][i] * efw[0][i] + efw[1][i] * efw[1][i]);
-        // We threshold here to protect against the ill-effects of a zero farend.
-        // The threshold is not arbitrarily chosen, but balances protection and
-        // adverse interaction with the algorithm's tuning.
-        // TODO: investigate further why this is so sensitive.
-        aec->sx[i] = ptrGCoh[0] * aec->sx[i] + ptrGCoh[1] *
-            WEBRTC_SPL_MAX(xfw[0][i] * xfw[0][i] + xfw[1][i] * xfw[1][i], 15);
-
-        aec->sde[i][0] = ptrGCoh[0] * aec->sde[i][0] + ptrGCoh[1] *
-            (dfw[0][i] * efw[0][i] + dfw[1][i] * efw[1][i]);
-        aec->sde[i][1] = ptrGCoh[0] * aec->sde[i][1] + ptrGCoh[1] *
-            (dfw[0][i] * efw[1][i] - dfw[1][i] * efw[0][i]);
-
-        aec->sxd[i][0] = ptrGCoh[0] * aec->sxd[i][0] + ptrGCoh[1] *
-            (dfw[0][i] * xfw[0][i] + dfw[1][i] * xfw[1][i]);
-        aec->sxd[i][1] = ptrGCoh[0] * aec->sxd[i][1] + ptrGCoh[1] *
-            (dfw[0][i] * xfw[1][i] - dfw[1][i] * xfw[0][i]);
-
-        sdSum += aec->sd[i];
-        seSum += aec->se[i];
-    }
+    // Smoothed PSD and subband coherence.
+    WebRtcAec_SubbandCoherence(aec, efw, dfw, xfw, cohde, cohxd, &sdSum,
+                               &seSum);
 
     // Divergent filter safeguard.
     if (aec->divergeState == 0) {
@@ -1155,14 +1189,6 @@ static void NonLinearProcessing(AecCore* aec, short *output, short *outputH)
         memset(aec->wfBuf, 0, sizeof(aec->wfBuf));
     }
 
-    // Subband coherence
-    for (i = 0; i < PART_LEN1; i++) {
-        cohde[i] = (aec->sde[i][0] * aec->sde[i][0] + aec->sde[i][1] * aec->sde[i][1]) /
-            (aec->sd[i] * aec->se[i] + 1e-10f);
-        cohxd[i] = (aec->sxd[i][0] * aec->sxd[i][0] + aec->sxd[i][1] * aec->sxd[i][1]) /
-            (aec->sx[i] * aec->sd[i] + 1e-10f);
-    }
-
     hNlXdAvg = 0;
     for (i = minPrefBand; i < prefBandSize + minPrefBand; i++) {
         hNlXdAvg += cohxd[i];
@@ -1287,7 +1313,7 @@ static void NonLinearProcessing(AecCore* aec, short *output, short *outputH)
         fft[i] = fft[i]*sqrtHanning[i] + aec->outBuf[i];
 
         // Saturation protection
-        output[i] = (short)WEBRTC_SPL_SAT(WEBRTC_SPL_WORD16_MAX, fft[i],
+        output[i] = WEBRTC_SPL_SAT(WEBRTC_SPL_WORD16_MAX, fft[i],
             WEBRTC_SPL_WORD16_MIN);
 
         fft[PART_LEN + i] *= scale; // fft scaling
@@ -1326,7 +1352,7 @@ static void NonLinearProcessing(AecCore* aec, short *output, short *outputH)
             }
 
             // Saturation protection
-            outputH[i] = (short)WEBRTC_SPL_SAT(WEBRTC_SPL_WORD16_MAX, dtmp,
+            outputH[i] = WEBRTC_SPL_SAT(WEBRTC_SPL_WORD16_MAX, dtmp,
                 WEBRTC_SPL_WORD16_MIN);
          }
     }
@@ -59,14 +59,19 @@ int WebRtcAec_CreateAec(AecCore** aec);
 int WebRtcAec_FreeAec(AecCore* aec);
 int WebRtcAec_InitAec(AecCore* aec, int sampFreq);
 void WebRtcAec_InitAec_SSE2(void);
+// Replaces the SSE2 functions with bit exact versions using AVX. Only to be
+// called on CPUs supporting AVX.
+void WebRtcAec_InitAec_AVX(void);
 
 void WebRtcAec_BufferFarendPartition(AecCore* aec, const float* farend);
+// Processes a frame of samples in the int16 range. The output is saturated to
+// the int16 range, but not rounded.
 void WebRtcAec_ProcessFrame(AecCore* aec,
-                            const short* nearend,
-                            const short* nearendH,
+                            const float* nearend,
+                            const float* nearendH,
                             int knownDelay,
-                            int16_t* out,
-                            int16_t* outH);
+                            float* out,
+                            float* outH);
 
 // A helper function to call WebRtc_MoveReadPtr() for all far-end buffers.
 // Returns the number of elements moved, and adjusts |system_delay| by the
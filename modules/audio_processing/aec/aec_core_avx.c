@@ -0,0 +1,493 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The core AEC algorithm, AVX version of speed-critical functions. They do
+ * the same operations in the same order as the SSE2 versions, and
+ * SubbandCoherence as the C version, so the output is bit exact with them.
+ * AVX has no 256 bit integer instructions, so the few integer operations are
+ * done on 128 bit halves.
+ */
+
+#include "webrtc/modules/audio_processing/aec/aec_core.h"
+
+#include <immintrin.h>
+#include <math.h>
+#include <string.h>  // memset
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+#include "webrtc/modules/audio_processing/aec/aec_core_internal.h"
+#include "webrtc/modules/audio_processing/aec/aec_rdft.h"
+
+__inline static float MulRe(float aRe, float aIm, float bRe, float bIm)
+{
+  return aRe * bRe - aIm * bIm;
+}
+
+__inline static float MulIm(float aRe, float aIm, float bRe, float bIm)
+{
+  return aRe * bIm + aIm * bRe;
+}
+
+// Splits the eight complex values in |lo| and |hi| into their real parts
+// |re| and imaginary parts |im|.
+static __inline void Deinterleave(__m256 lo, __m256 hi,
+                                  __m256* re, __m256* im) {
+  const __m256 t0 = _mm256_permute2f128_ps(lo, hi, 0x20);
+  const __m256 t1 = _mm256_permute2f128_ps(lo, hi, 0x31);
+  *re = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0));
+  *im = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+// The inverse of Deinterleave().
+static __inline void Interleave(__m256 re, __m256 im,
+                                __m256* lo, __m256* hi) {
+  const __m256 t0 = _mm256_unpacklo_ps(re, im);
+  const __m256 t1 = _mm256_unpackhi_ps(re, im);
+  *lo = _mm256_permute2f128_ps(t0, t1, 0x20);
+  *hi = _mm256_permute2f128_ps(t0, t1, 0x31);
+}
+
+static void FilterFarAVX(AecCore* aec, float yf[2][PART_LEN1])
+{
+  int i;
+  for (i = 0; i < NR_PART; i++) {
+    int j;
+    int xPos = (i + aec->xfBufBlockPos) * PART_LEN1;
+    int pos = i * PART_LEN1;
+    // Check for wrap
+    if (i + aec->xfBufBlockPos >= NR_PART) {
+      xPos -= NR_PART*(PART_LEN1);
+    }
+
+    // vectorized code (eight at once)
+    for (j = 0; j + 7 < PART_LEN1; j += 8) {
+      const __m256 xfBuf_re = _mm256_loadu_ps(&aec->xfBuf[0][xPos + j]);
+      const __m256 xfBuf_im = _mm256_loadu_ps(&aec->xfBuf[1][xPos + j]);
+      const __m256 wfBuf_re = _mm256_loadu_ps(&aec->wfBuf[0][pos + j]);
+      const __m256 wfBuf_im = _mm256_loadu_ps(&aec->wfBuf[1][pos + j]);
+      const __m256 yf_re = _mm256_loadu_ps(&yf[0][j]);
+      const __m256 yf_im = _mm256_loadu_ps(&yf[1][j]);
+      // yf_re += xfBuf_re * wfBuf_re - xfBuf_im * wfBuf_im
+      // yf_im += xfBuf_re * wfBuf_im + xfBuf_im * wfBuf_re
+      const __m256 e = _mm256_sub_ps(_mm256_mul_ps(xfBuf_re, wfBuf_re),
+                                     _mm256_mul_ps(xfBuf_im, wfBuf_im));
+      const __m256 f = _mm256_add_ps(_mm256_mul_ps(xfBuf_re, wfBuf_im),
+                                     _mm256_mul_ps(xfBuf_im, wfBuf_re));
+      const __m256 g = _mm256_add_ps(yf_re, e);
+      const __m256 h = _mm256_add_ps(yf_im, f);
+      _mm256_storeu_ps(&yf[0][j], g);
+      _mm256_storeu_ps(&yf[1][j], h);
+    }
+    // scalar code for the remaining items.
+    for (; j < PART_LEN1; j++) {
+      yf[0][j] += MulRe(aec->xfBuf[0][xPos + j], aec->xfBuf[1][xPos + j],
+                        aec->wfBuf[0][ pos + j], aec->wfBuf[1][ pos + j]);
+      yf[1][j] += MulIm(aec->xfBuf[0][xPos + j], aec->xfBuf[1][xPos + j],
+                        aec->wfBuf[0][ pos + j], aec->wfBuf[1][ pos + j]);
+    }
+  }
+}
+
+static void ScaleErrorSignalAVX(AecCore* aec, float ef[2][PART_LEN1])
+{
+  const __m256 k1e_10f = _mm256_set1_ps(1e-10f);
+  const __m256 kThresh = _mm256_set1_ps(aec->errThresh);
+  const __m256 kMu = _mm256_set1_ps(aec->mu);
+
+  int i;
+  // vectorized code (eight at once)
+  for (i = 0; i + 7 < PART_LEN1; i += 8) {
+    const __m256 xPowPlus = _mm256_add_ps(_mm256_loadu_ps(&aec->xPow[i]),
+                                          k1e_10f);
+    __m256 ef_re = _mm256_div_ps(_mm256_loadu_ps(&ef[0][i]), xPowPlus);
+    __m256 ef_im = _mm256_div_ps(_mm256_loadu_ps(&ef[1][i]), xPowPlus);
+    const __m256 absEf = _mm256_sqrt_ps(
+        _mm256_add_ps(_mm256_mul_ps(ef_re, ef_re),
+                      _mm256_mul_ps(ef_im, ef_im)));
+    const __m256 bigger = _mm256_cmp_ps(absEf, kThresh, _CMP_GT_OQ);
+    // Limit the error to the threshold where it is bigger.
+    const __m256 absEfInv = _mm256_div_ps(kThresh,
+                                          _mm256_add_ps(absEf, k1e_10f));
+    ef_re = _mm256_blendv_ps(ef_re, _mm256_mul_ps(ef_re, absEfInv), bigger);
+    ef_im = _mm256_blendv_ps(ef_im, _mm256_mul_ps(ef_im, absEfInv), bigger);
+    // Stepsize factor
+    _mm256_storeu_ps(&ef[0][i], _mm256_mul_ps(ef_re, kMu));
+    _mm256_storeu_ps(&ef[1][i], _mm256_mul_ps(ef_im, kMu));
+  }
+  // scalar code for the remaining items.
+  for (; i < (PART_LEN1); i++) {
+    float absEf;
+    ef[0][i] /= (aec->xPow[i] + 1e-10f);
+    ef[1][i] /= (aec->xPow[i] + 1e-10f);
+    absEf = sqrtf(ef[0][i] * ef[0][i] + ef[1][i] * ef[1][i]);
+
+    if (absEf > aec->errThresh) {
+      absEf = aec->errThresh / (absEf + 1e-10f);
+      ef[0][i] *= absEf;
+      ef[1][i] *= absEf;
+    }
+
+    // Stepsize factor
+    ef[0][i] *= aec->mu;
+    ef[1][i] *= aec->mu;
+  }
+}
+
+static void FilterAdaptationAVX(AecCore* aec, float *fft, float ef[2][PART_LEN1]) {
+  int i, j;
+  for (i = 0; i < NR_PART; i++) {
+    int xPos = (i + aec->xfBufBlockPos)*(PART_LEN1);
+    int pos = i * PART_LEN1;
+    // Check for wrap
+    if (i + aec->xfBufBlockPos >= NR_PART) {
+      xPos -= NR_PART * PART_LEN1;
+    }
+
+    // Process the whole array...
+    for (j = 0; j < PART_LEN; j += 8) {
+      // Load xfBuf and ef.
+      const __m256 xfBuf_re = _mm256_loadu_ps(&aec->xfBuf[0][xPos + j]);
+      const __m256 xfBuf_im = _mm256_loadu_ps(&aec->xfBuf[1][xPos + j]);
+      const __m256 ef_re = _mm256_loadu_ps(&ef[0][j]);
+      const __m256 ef_im = _mm256_loadu_ps(&ef[1][j]);
+      // Calculate the product of conjugate(xfBuf) by ef.
+      //   re(conjugate(a) * b) = aRe * bRe + aIm * bIm
+      //   im(conjugate(a) * b)=  aRe * bIm - aIm * bRe
+      const __m256 e = _mm256_add_ps(_mm256_mul_ps(xfBuf_re, ef_re),
+                                     _mm256_mul_ps(xfBuf_im, ef_im));
+      const __m256 f = _mm256_sub_ps(_mm256_mul_ps(xfBuf_re, ef_im),
+                                     _mm256_mul_ps(xfBuf_im, ef_re));
+      // Interleave real and imaginary parts and store.
+      __m256 g, h;
+      Interleave(e, f, &g, &h);
+      _mm256_storeu_ps(&fft[2 * j + 0], g);
+      _mm256_storeu_ps(&fft[2 * j + 8], h);
+    }
+    // ... and fixup the first imaginary entry.
+    fft[1] = MulRe(aec->xfBuf[0][xPos + PART_LEN],
+                   -aec->xfBuf[1][xPos + PART_LEN],
+                   ef[0][PART_LEN], ef[1][PART_LEN]);
+
+    aec_rdft_inverse_128(fft);
+    memset(fft + PART_LEN, 0, sizeof(float)*PART_LEN);
+
+    // fft scaling
+    {
+      const __m256 scale_ps = _mm256_set1_ps(2.0f / PART_LEN2);
+      for (j = 0; j < PART_LEN; j += 8) {
+        _mm256_storeu_ps(&fft[j],
+                         _mm256_mul_ps(_mm256_loadu_ps(&fft[j]), scale_ps));
+      }
+    }
+    aec_rdft_forward_128(fft);
+
+    {
+      float wt1 = aec->wfBuf[1][pos];
+      aec->wfBuf[0][pos + PART_LEN] += fft[1];
+      for (j = 0; j < PART_LEN; j += 8) {
+        const __m256 wtBuf_re = _mm256_loadu_ps(&aec->wfBuf[0][pos + j]);
+        const __m256 wtBuf_im = _mm256_loadu_ps(&aec->wfBuf[1][pos + j]);
+        __m256 fft_re, fft_im;
+        Deinterleave(_mm256_loadu_ps(&fft[2 * j + 0]),
+                     _mm256_loadu_ps(&fft[2 * j + 8]), &fft_re, &fft_im);
+        _mm256_storeu_ps(&aec->wfBuf[0][pos + j],
+                         _mm256_add_ps(wtBuf_re, fft_re));
+        _mm256_storeu_ps(&aec->wfBuf[1][pos + j],
+                         _mm256_add_ps(wtBuf_im, fft_im));
+      }
+      aec->wfBuf[1][pos] = wt1;
+    }
+  }
+}
+
+// Applies |op| to the 32 bit integers in each 128 bit half of |a|.
+#define HALVES_EPI32(op, a, b) \
+  _mm256_insertf128_si256(_mm256_castsi128_si256( \
+      op(_mm256_castsi256_si128(a), b)), \
+      op(_mm256_extractf128_si256(a, 1), b), 1)
+
+// The AVX version of mm_pow_ps() in aec_core_sse2.c, using the same
+// polynomial approximations evaluated in the same order.
+static __m256 mm256_pow_ps(__m256 a, __m256 b)
+{
+  // a^b = exp2(b * log2(a))
+  __m256 log2_a, b_log2_a, a_exp_b;
+
+  // Calculate log2(x), x = a, as log2(y) + n with x = y * 2^n and y in the
+  // [1.0, 2.0) range.
+  {
+    // Compute n by shifting the exponent into the top of the mantissa of a
+    // float with eight as its exponent.
+    const __m256i float_exponent_mask = _mm256_set1_epi32(0x7F800000);
+    const __m256 eight_biased_exponent =
+        _mm256_castsi256_ps(_mm256_set1_epi32(0x43800000));
+    const __m256 implicit_leading_one =
+        _mm256_castsi256_ps(_mm256_set1_epi32(0x43BF8000));
+    const int shift_exponent_into_top_mantissa = 8;
+    const __m256 two_n = _mm256_and_ps(
+        a, _mm256_castsi256_ps(float_exponent_mask));
+    const __m256 n_1 = _mm256_castsi256_ps(HALVES_EPI32(
+        _mm_srli_epi32, _mm256_castps_si256(two_n),
+        shift_exponent_into_top_mantissa));
+    const __m256 n_0 = _mm256_or_ps(n_1, eight_biased_exponent);
+    const __m256 n = _mm256_sub_ps(n_0, implicit_leading_one);
+
+    // Compute y.
+    const __m256 mantissa_mask =
+        _mm256_castsi256_ps(_mm256_set1_epi32(0x007FFFFF));
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 y = _mm256_or_ps(_mm256_and_ps(a, mantissa_mask), one);
+
+    // Approximate log2(y) ~= (y - 1) * pol5(y).
+    //    pol5(y) = C5 * y^5 + C4 * y^4 + C3 * y^3 + C2 * y^2 + C1 * y + C0
+    __m256 pol5_y = _mm256_mul_ps(y, _mm256_set1_ps(-3.4436006e-2f));
+    pol5_y = _mm256_add_ps(pol5_y, _mm256_set1_ps(3.1821337e-1f));
+    pol5_y = _mm256_add_ps(_mm256_mul_ps(pol5_y, y),
+                           _mm256_set1_ps(-1.2315303f));
+    pol5_y = _mm256_add_ps(_mm256_mul_ps(pol5_y, y),
+                           _mm256_set1_ps(2.5988452f));
+    pol5_y = _mm256_add_ps(_mm256_mul_ps(pol5_y, y),
+                           _mm256_set1_ps(-3.3241990f));
+    pol5_y = _mm256_add_ps(_mm256_mul_ps(pol5_y, y),
+                           _mm256_set1_ps(3.1157899f));
+
+    // Combine parts.
+    log2_a = _mm256_add_ps(n, _mm256_mul_ps(_mm256_sub_ps(y, one), pol5_y));
+  }
+
+  // b * log2(a)
+  b_log2_a = _mm256_mul_ps(b, log2_a);
+
+  // Calculate exp2(x), x = b * log2(a), as 2^n * 2^y with n the value of
+  // x - 0.5 rounded and y in the [0.5, 1.5) range.
+  {
+    // To avoid over/underflow, we reduce the range of input to ]-127, 129].
+    const __m256 x_max = _mm256_max_ps(
+        _mm256_min_ps(b_log2_a, _mm256_set1_ps(129.f)),
+        _mm256_set1_ps(-126.99999f));
+    // Compute n.
+    const __m256i x_minus_half_floor = _mm256_cvtps_epi32(
+        _mm256_sub_ps(x_max, _mm256_set1_ps(0.5f)));
+    // Compute 2^n.
+    const __m256i two_n_exponent = HALVES_EPI32(
+        _mm_add_epi32, x_minus_half_floor, _mm_set1_epi32(127));
+    const __m256 two_n = _mm256_castsi256_ps(HALVES_EPI32(
+        _mm_slli_epi32, two_n_exponent, 23));
+    // Compute y.
+    const __m256 y = _mm256_sub_ps(x_max,
+                                   _mm256_cvtepi32_ps(x_minus_half_floor));
+    // Approximate 2^y ~= C2 * y^2 + C1 * y + C0.
+    __m256 exp2_y = _mm256_mul_ps(y, _mm256_set1_ps(3.3718944e-1f));
+    exp2_y = _mm256_add_ps(exp2_y, _mm256_set1_ps(6.5763628e-1f));
+    exp2_y = _mm256_add_ps(_mm256_mul_ps(exp2_y, y),
+                           _mm256_set1_ps(1.0017247f));
+
+    // Combine parts.
+    a_exp_b = _mm256_mul_ps(exp2_y, two_n);
+  }
+  return a_exp_b;
+}
+
+#undef HALVES_EPI32
+
+extern const float WebRtcAec_weightCurve[65];
+extern const float WebRtcAec_overDriveCurve[65];
+
+static void OverdriveAndSuppressAVX(AecCore* aec, float hNl[PART_LEN1],
+                                    const float hNlFb,
+                                    float efw[2][PART_LEN1]) {
+  int i;
+  const __m256 vec_hNlFb = _mm256_set1_ps(hNlFb);
+  const __m256 vec_one = _mm256_set1_ps(1.0f);
+  const __m256 vec_minus_one = _mm256_set1_ps(-1.0f);
+  const __m256 vec_overDriveSm = _mm256_set1_ps(aec->overDriveSm);
+  // vectorized code (eight at once)
+  for (i = 0; i + 7 < PART_LEN1; i += 8) {
+    // Weight subbands
+    __m256 vec_hNl = _mm256_loadu_ps(&hNl[i]);
+    const __m256 vec_weightCurve = _mm256_loadu_ps(&WebRtcAec_weightCurve[i]);
+    const __m256 bigger = _mm256_cmp_ps(vec_hNl, vec_hNlFb, _CMP_GT_OQ);
+    const __m256 vec_weighted = _mm256_add_ps(
+        _mm256_mul_ps(vec_weightCurve, vec_hNlFb),
+        _mm256_mul_ps(_mm256_sub_ps(vec_one, vec_weightCurve), vec_hNl));
+    vec_hNl = _mm256_blendv_ps(vec_hNl, vec_weighted, bigger);
+
+    vec_hNl = mm256_pow_ps(vec_hNl, _mm256_mul_ps(
+        vec_overDriveSm, _mm256_loadu_ps(&WebRtcAec_overDriveCurve[i])));
+    _mm256_storeu_ps(&hNl[i], vec_hNl);
+
+    // Suppress error signal
+    {
+      const __m256 vec_efw_re = _mm256_mul_ps(_mm256_loadu_ps(&efw[0][i]),
+                                              vec_hNl);
+      // Ooura fft returns incorrect sign on imaginary component. It matters
+      // here because we are making an additive change with comfort noise.
+      const __m256 vec_efw_im = _mm256_mul_ps(
+          _mm256_mul_ps(_mm256_loadu_ps(&efw[1][i]), vec_hNl),
+          vec_minus_one);
+      _mm256_storeu_ps(&efw[0][i], vec_efw_re);
+      _mm256_storeu_ps(&efw[1][i], vec_efw_im);
+    }
+  }
+  // scalar code for the remaining items.
+  for (; i < PART_LEN1; i++) {
+    // Weight subbands
+    if (hNl[i] > hNlFb) {
+      hNl[i] = WebRtcAec_weightCurve[i] * hNlFb +
+          (1 - WebRtcAec_weightCurve[i]) * hNl[i];
+    }
+    hNl[i] = powf(hNl[i], aec->overDriveSm * WebRtcAec_overDriveCurve[i]);
+
+    // Suppress error signal
+    efw[0][i] *= hNl[i];
+    efw[1][i] *= hNl[i];
+
+    // Ooura fft returns incorrect sign on imaginary component. It matters
+    // here because we are making an additive change with comfort noise.
+    efw[1][i] *= -1;
+  }
+}
+
+static void SubbandCoherenceAVX(AecCore* aec,
+                                float efw[2][PART_LEN1],
+                                float dfw[2][PART_LEN1],
+                                float xfw[2][PART_LEN1],
+                                float* cohde,
+                                float* cohxd,
+                                float* sdSum,
+                                float* seSum) {
+  // Power estimate smoothing coefficients
+  const float gCoh[2][2] = {{0.9f, 0.1f}, {0.93f, 0.07f}};
+  const float *ptrGCoh = gCoh[aec->mult - 1];
+  const __m256 vec_gCoh0 = _mm256_set1_ps(ptrGCoh[0]);
+  const __m256 vec_gCoh1 = _mm256_set1_ps(ptrGCoh[1]);
+  const __m256 vec_15 = _mm256_set1_ps(15.0f);
+  const __m256 k1e_10f = _mm256_set1_ps(1e-10f);
+  int i, j;
+
+  // vectorized code (eight at once)
+  for (i = 0; i + 7 < PART_LEN1; i += 8) {
+    const __m256 vec_dfw0 = _mm256_loadu_ps(&dfw[0][i]);
+    const __m256 vec_dfw1 = _mm256_loadu_ps(&dfw[1][i]);
+    const __m256 vec_efw0 = _mm256_loadu_ps(&efw[0][i]);
+    const __m256 vec_efw1 = _mm256_loadu_ps(&efw[1][i]);
+    const __m256 vec_xfw0 = _mm256_loadu_ps(&xfw[0][i]);
+    const __m256 vec_xfw1 = _mm256_loadu_ps(&xfw[1][i]);
+    // Smoothed PSD, with the far end thresholded as in the C version.
+    const __m256 vec_sd = _mm256_add_ps(
+        _mm256_mul_ps(vec_gCoh0, _mm256_loadu_ps(&aec->sd[i])),
+        _mm256_mul_ps(vec_gCoh1,
+                      _mm256_add_ps(_mm256_mul_ps(vec_dfw0, vec_dfw0),
+                                    _mm256_mul_ps(vec_dfw1, vec_dfw1))));
+    const __m256 vec_se = _mm256_add_ps(
+        _mm256_mul_ps(vec_gCoh0, _mm256_loadu_ps(&aec->se[i])),
+        _mm256_mul_ps(vec_gCoh1,
+                      _mm256_add_ps(_mm256_mul_ps(vec_efw0, vec_efw0),
+                                    _mm256_mul_ps(vec_efw1, vec_efw1))));
+    const __m256 vec_sx = _mm256_add_ps(
+        _mm256_mul_ps(vec_gCoh0, _mm256_loadu_ps(&aec->sx[i])),
+        _mm256_mul_ps(vec_gCoh1, _mm256_max_ps(
+            _mm256_add_ps(_mm256_mul_ps(vec_xfw0, vec_xfw0),
+                          _mm256_mul_ps(vec_xfw1, vec_xfw1)),
+            vec_15)));
+    __m256 vec_sde_re, vec_sde_im, vec_sxd_re, vec_sxd_im;
+    __m256 vec_sde_lo, vec_sde_hi, vec_sxd_lo, vec_sxd_hi;
+    Deinterleave(_mm256_loadu_ps(&aec->sde[i][0]),
+                 _mm256_loadu_ps(&aec->sde[i + 4][0]),
+                 &vec_sde_re, &vec_sde_im);
+    Deinterleave(_mm256_loadu_ps(&aec->sxd[i][0]),
+                 _mm256_loadu_ps(&aec->sxd[i + 4][0]),
+                 &vec_sxd_re, &vec_sxd_im);
+    vec_sde_re = _mm256_add_ps(
+        _mm256_mul_ps(vec_gCoh0, vec_sde_re),
+        _mm256_mul_ps(vec_gCoh1,
+                      _mm256_add_ps(_mm256_mul_ps(vec_dfw0, vec_efw0),
+                                    _mm256_mul_ps(vec_dfw1, vec_efw1))));
+    vec_sde_im = _mm256_add_ps(
+        _mm256_mul_ps(vec_gCoh0, vec_sde_im),
+        _mm256_mul_ps(vec_gCoh1,
+                      _mm256_sub_ps(_mm256_mul_ps(vec_dfw0, vec_efw1),
+                                    _mm256_mul_ps(vec_dfw1, vec_efw0))));
+    vec_sxd_re = _mm256_add_ps(
+        _mm256_mul_ps(vec_gCoh0, vec_sxd_re),
+        _mm256_mul_ps(vec_gCoh1,
+                      _mm256_add_ps(_mm256_mul_ps(vec_dfw0, vec_xfw0),
+                                    _mm256_mul_ps(vec_dfw1, vec_xfw1))));
+    vec_sxd_im = _mm256_add_ps(
+        _mm256_mul_ps(vec_gCoh0, vec_sxd_im),
+        _mm256_mul_ps(vec_gCoh1,
+                      _mm256_sub_ps(_mm256_mul_ps(vec_dfw0, vec_xfw1),
+                                    _mm256_mul_ps(vec_dfw1, vec_xfw0))));
+
+    _mm256_storeu_ps(&aec->sd[i], vec_sd);
+    _mm256_storeu_ps(&aec->se[i], vec_se);
+    _mm256_storeu_ps(&aec->sx[i], vec_sx);
+    Interleave(vec_sde_re, vec_sde_im, &vec_sde_lo, &vec_sde_hi);
+    Interleave(vec_sxd_re, vec_sxd_im, &vec_sxd_lo, &vec_sxd_hi);
+    _mm256_storeu_ps(&aec->sde[i][0], vec_sde_lo);
+    _mm256_storeu_ps(&aec->sde[i + 4][0], vec_sde_hi);
+    _mm256_storeu_ps(&aec->sxd[i][0], vec_sxd_lo);
+    _mm256_storeu_ps(&aec->sxd[i + 4][0], vec_sxd_hi);
+    // Sum in order, as the C version does.
+    for (j = i; j < i + 8; j++) {
+      *sdSum += aec->sd[j];
+      *seSum += aec->se[j];
+    }
+
+    // Subband coherence
+    _mm256_storeu_ps(&cohde[i], _mm256_div_ps(
+        _mm256_add_ps(_mm256_mul_ps(vec_sde_re, vec_sde_re),
+                      _mm256_mul_ps(vec_sde_im, vec_sde_im)),
+        _mm256_add_ps(_mm256_mul_ps(vec_sd, vec_se), k1e_10f)));
+    _mm256_storeu_ps(&cohxd[i], _mm256_div_ps(
+        _mm256_add_ps(_mm256_mul_ps(vec_sxd_re, vec_sxd_re),
+                      _mm256_mul_ps(vec_sxd_im, vec_sxd_im)),
+        _mm256_add_ps(_mm256_mul_ps(vec_sx, vec_sd), k1e_10f)));
+  }
+
+  // scalar code for the remaining items.
+  for (; i < PART_LEN1; i++) {
+    aec->sd[i] = ptrGCoh[0] * aec->sd[i] + ptrGCoh[1] *
+        (dfw[0][i] * dfw[0][i] + dfw[1][i] * dfw[1][i]);
+    aec->se[i] = ptrGCoh[0] * aec->se[i] + ptrGCoh[1] *
+        (efw[0][i] * efw[0][i] + efw[1][i] * efw[1][i]);
+    aec->sx[i] = ptrGCoh[0] * aec->sx[i] + ptrGCoh[1] *
+        WEBRTC_SPL_MAX(xfw[0][i] * xfw[0][i] + xfw[1][i] * xfw[1][i], 15);
+
+    aec->sde[i][0] = ptrGCoh[0] * aec->sde[i][0] + ptrGCoh[1] *
+        (dfw[0][i] * efw[0][i] + dfw[1][i] * efw[1][i]);
+    aec->sde[i][1] = ptrGCoh[0] * aec->sde[i][1] + ptrGCoh[1] *
+        (dfw[0][i] * efw[1][i] - dfw[1][i] * efw[0][i]);
+
+    aec->sxd[i][0] = ptrGCoh[0] * aec->sxd[i][0] + ptrGCoh[1] *
+        (dfw[0][i] * xfw[0][i] + dfw[1][i] * xfw[1][i]);
+    aec->sxd[i][1] = ptrGCoh[0] * aec->sxd[i][1] + ptrGCoh[1] *
+        (dfw[0][i] * xfw[1][i] - dfw[1][i] * xfw[0][i]);
+
+    *sdSum += aec->sd[i];
+    *seSum += aec->se[i];
+
+    cohde[i] = (aec->sde[i][0] * aec->sde[i][0] +
+                aec->sde[i][1] * aec->sde[i][1]) /
+        (aec->sd[i] * aec->se[i] + 1e-10f);
+    cohxd[i] = (aec->sxd[i][0] * aec->sxd[i][0] +
+                aec->sxd[i][1] * aec->sxd[i][1]) /
+        (aec->sx[i] * aec->sd[i] + 1e-10f);
+  }
+}
+
+void WebRtcAec_InitAec_AVX(void) {
+  WebRtcAec_FilterFar = FilterFarAVX;
+  WebRtcAec_ScaleErrorSignal = ScaleErrorSignalAVX;
+  WebRtcAec_FilterAdaptation = FilterAdaptationAVX;
+  WebRtcAec_OverdriveAndSuppress = OverdriveAndSuppressAVX;
+  WebRtcAec_SubbandCoherence = SubbandCoherenceAVX;
+}
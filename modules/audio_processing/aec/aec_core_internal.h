@@ -130,5 +130,14 @@ typedef void (*WebRtcAec_OverdriveAndSuppress_t)
     (AecCore* aec, float hNl[PART_LEN1], const float hNlFb,
         float efw[2][PART_LEN1]);
 extern WebRtcAec_OverdriveAndSuppress_t WebRtcAec_OverdriveAndSuppress;
+// Updates the smoothed power spectra of the near end |dfw|, the error |efw|
+// and the far end |xfw|, and computes the near end-error and far end-near end
+// coherence in each subband. The smoothed near end and error powers are
+// added to |sdSum| and |seSum|.
+typedef void (*WebRtcAec_SubbandCoherence_t)
+    (AecCore* aec, float efw[2][PART_LEN1], float dfw[2][PART_LEN1],
+        float xfw[2][PART_LEN1], float* cohde, float* cohxd, float* sdSum,
+        float* seSum);
+extern WebRtcAec_SubbandCoherence_t WebRtcAec_SubbandCoherence;
 
 #endif  // WEBRTC_MODULES_AUDIO_PROCESSING_AEC_AEC_CORE_INTERNAL_H_
@@ -0,0 +1,190 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+extern "C" {
+#include "webrtc/modules/audio_processing/aec/aec_core.h"
+#include "webrtc/modules/audio_processing/aec/aec_core_internal.h"
+#include "webrtc/modules/audio_processing/aec/aec_rdft.h"
+}
+#include "webrtc/modules/audio_processing/test/cpu_features_test_helper.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+
+namespace webrtc {
+namespace {
+
+const int kSampleRates[] = { 8000, 16000, 32000 };
+const int kNumTrials = 20;
+
+void ExpectEqual(const float* expected, const float* actual, int length) {
+  for (int i = 0; i < length; ++i) {
+    EXPECT_EQ(expected[i], actual[i]) << "at " << i;
+  }
+}
+
+class AecCoreTest : public ::testing::Test {
+ protected:
+  AecCoreTest() : expected_(NULL), actual_(NULL), selector_(NULL) {}
+
+  virtual void SetUp() {
+    ASSERT_EQ(0, WebRtcAec_CreateAec(&expected_));
+    ASSERT_EQ(0, WebRtcAec_CreateAec(&actual_));
+    ASSERT_EQ(0, WebRtcAec_CreateAec(&selector_));
+  }
+
+  virtual void TearDown() {
+    EXPECT_EQ(0, WebRtcAec_FreeAec(expected_));
+    EXPECT_EQ(0, WebRtcAec_FreeAec(actual_));
+    EXPECT_EQ(0, WebRtcAec_FreeAec(selector_));
+  }
+
+  // Selects the functions for a CPU with the features reported by
+  // |cpu_info|, like WebRtcAec_InitAec() does.
+  void SelectFunctions(WebRtc_CPUInfo cpu_info) {
+    ScopedCPUInfo scoped_cpu_info(cpu_info);
+    EXPECT_EQ(0, WebRtcAec_InitAec(selector_, 16000));
+  }
+
+  // Initializes |aec| at |sample_rate| and fills the state the functions
+  // work on with random values, the same for the same |seed|.
+  void Randomize(AecCore* aec, int sample_rate, unsigned int seed) {
+    ASSERT_EQ(0, WebRtcAec_InitAec(aec, sample_rate));
+    srand(seed);
+    aec->xfBufBlockPos = rand() % NR_PART;
+    aec->overDriveSm = RandomFloat(1.0f, 20.0f);
+    FillRandom(aec->xPow, PART_LEN1, 0.0f, 1e6f);
+    FillRandom(aec->xfBuf[0], 2 * NR_PART * PART_LEN1, -1e3f, 1e3f);
+    FillRandom(aec->wfBuf[0], 2 * NR_PART * PART_LEN1, -1.0f, 1.0f);
+    FillRandom(aec->sd, PART_LEN1, 0.0f, 1e6f);
+    FillRandom(aec->se, PART_LEN1, 0.0f, 1e6f);
+    FillRandom(aec->sx, PART_LEN1, 15.0f, 1e6f);
+    FillRandom(aec->sde[0], 2 * PART_LEN1, -1e5f, 1e5f);
+    FillRandom(aec->sxd[0], 2 * PART_LEN1, -1e5f, 1e5f);
+  }
+
+  void ExpectCoresEqual() {
+    ExpectEqual(expected_->wfBuf[0], actual_->wfBuf[0],
+               2 * NR_PART * PART_LEN1);
+    ExpectEqual(expected_->sd, actual_->sd, PART_LEN1);
+    ExpectEqual(expected_->se, actual_->se, PART_LEN1);
+    ExpectEqual(expected_->sx, actual_->sx, PART_LEN1);
+    ExpectEqual(expected_->sde[0], actual_->sde[0], 2 * PART_LEN1);
+    ExpectEqual(expected_->sxd[0], actual_->sxd[0], 2 * PART_LEN1);
+  }
+
+  AecCore* expected_;
+  AecCore* actual_;
+  AecCore* selector_;
+};
+
+TEST_F(AecCoreTest, AvxFunctionsMatchSse2) {
+  if (!WebRtc_GetCPUInfo(kAVX)) {
+    printf("Skipping test, the CPU does not support AVX.\n");
+    return;
+  }
+  for (size_t r = 0; r < sizeof(kSampleRates) / sizeof(*kSampleRates); ++r) {
+    for (int trial = 0; trial < kNumTrials; ++trial) {
+      SCOPED_TRACE(testing::Message() << "sample rate " << kSampleRates[r]
+                                      << ", trial " << trial);
+      const unsigned int seed = 1000 * r + trial;
+      float expected_f[2][PART_LEN1];
+      float actual_f[2][PART_LEN1];
+      float expected_g[2][PART_LEN1];
+      float actual_g[2][PART_LEN1];
+      float expected_h[2][PART_LEN1];
+      float actual_h[2][PART_LEN1];
+      float expected_fft[PART_LEN2];
+      float actual_fft[PART_LEN2];
+      float expected_coh[2][PART_LEN1];
+      float actual_coh[2][PART_LEN1];
+      float expected_hNl[PART_LEN1];
+      float actual_hNl[PART_LEN1];
+      float expected_sums[2] = { 0, 0 };
+      float actual_sums[2] = { 0, 0 };
+      const float hNlFb = RandomFloat(0.0f, 1.0f);
+      Randomize(expected_, kSampleRates[r], seed);
+      Randomize(actual_, kSampleRates[r], seed);
+      srand(seed);
+      FillRandom(expected_f[0], 2 * PART_LEN1, -1e3f, 1e3f);
+      FillRandom(expected_g[0], 2 * PART_LEN1, -1e3f, 1e3f);
+      FillRandom(expected_h[0], 2 * PART_LEN1, -1e3f, 1e3f);
+      FillRandom(expected_hNl, PART_LEN1, 0.0f, 1.0f);
+      memcpy(actual_f, expected_f, sizeof(actual_f));
+      memcpy(actual_g, expected_g, sizeof(actual_g));
+      memcpy(actual_h, expected_h, sizeof(actual_h));
+      memcpy(actual_hNl, expected_hNl, sizeof(actual_hNl));
+
+      // Runs the selected functions as NonLinearProcessing() and
+      // EchoSubtraction() do, on |expected_| with the SSE2 versions and on
+      // |actual_| with the AVX versions, which must be bit exact with them.
+      SelectFunctions(GetCPUInfoSse2Only);
+      WebRtcAec_SubbandCoherence(expected_, expected_f, expected_g,
+                                 expected_h, expected_coh[0],
+                                 expected_coh[1], &expected_sums[0],
+                                 &expected_sums[1]);
+      WebRtcAec_FilterFar(expected_, expected_h);
+      WebRtcAec_ScaleErrorSignal(expected_, expected_g);
+      WebRtcAec_FilterAdaptation(expected_, expected_fft, expected_g);
+      WebRtcAec_OverdriveAndSuppress(expected_, expected_hNl, hNlFb,
+                                     expected_f);
+
+      SelectFunctions(WebRtc_GetCPUInfo);
+      WebRtcAec_SubbandCoherence(actual_, actual_f, actual_g, actual_h,
+                                 actual_coh[0], actual_coh[1],
+                                 &actual_sums[0], &actual_sums[1]);
+      ExpectEqual(expected_coh[0], actual_coh[0], PART_LEN1);
+      ExpectEqual(expected_coh[1], actual_coh[1], PART_LEN1);
+      ExpectEqual(expected_sums, actual_sums, 2);
+      WebRtcAec_FilterFar(actual_, actual_h);
+      ExpectEqual(expected_h[0], actual_h[0], 2 * PART_LEN1);
+      WebRtcAec_ScaleErrorSignal(actual_, actual_g);
+      ExpectEqual(expected_g[0], actual_g[0], 2 * PART_LEN1);
+      WebRtcAec_FilterAdaptation(actual_, actual_fft, actual_g);
+      WebRtcAec_OverdriveAndSuppress(actual_, actual_hNl, hNlFb, actual_f);
+      ExpectEqual(expected_hNl, actual_hNl, PART_LEN1);
+      ExpectEqual(expected_f[0], actual_f[0], 2 * PART_LEN1);
+      ExpectCoresEqual();
+    }
+  }
+}
+
+TEST_F(AecCoreTest, AvxRdftMatchesSse2) {
+  if (!WebRtc_GetCPUInfo(kAVX)) {
+    printf("Skipping test, the CPU does not support AVX.\n");
+    return;
+  }
+  srand(42);
+  for (int trial = 0; trial < kNumTrials; ++trial) {
+    SCOPED_TRACE(testing::Message() << "trial " << trial);
+    float expected[PART_LEN2];
+    float actual[PART_LEN2];
+    FillRandom(expected, PART_LEN2, -1e4f, 1e4f);
+    memcpy(actual, expected, sizeof(actual));
+
+    SelectFunctions(GetCPUInfoSse2Only);
+    aec_rdft_forward_128(expected);
+    SelectFunctions(WebRtc_GetCPUInfo);
+    aec_rdft_forward_128(actual);
+    ExpectEqual(expected, actual, PART_LEN2);
+
+    SelectFunctions(GetCPUInfoSse2Only);
+    aec_rdft_inverse_128(expected);
+    SelectFunctions(WebRtc_GetCPUInfo);
+    aec_rdft_inverse_128(actual);
+    ExpectEqual(expected, actual, PART_LEN2);
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -650,6 +650,11 @@ void aec_rdft_init(void) {
   if (WebRtc_GetCPUInfo(kSSE2)) {
     aec_rdft_init_sse2();
   }
+#if defined(WEBRTC_AUDIOPROC_AVX)
+  if (WebRtc_GetCPUInfo(kAVX)) {
+    aec_rdft_init_avx();
+  }
+#endif
 #endif
   // init library constants.
   makewt_32();
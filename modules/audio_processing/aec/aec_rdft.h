@@ -27,12 +27,12 @@ static __inline __m128i _mm_castps_si128(__m128 a) { return *(__m128i*)&a; }
 # define ALIGN16_END __attribute__((aligned(16)))
 #endif
 
-// constants shared by all paths (C, SSE2).
+// constants shared by all paths (C, SSE2, AVX).
 extern float rdft_w[64];
 // constants used by the C path.
 extern float rdft_wk3ri_first[32];
 extern float rdft_wk3ri_second[32];
-// constants used by SSE2 but initialized in C path.
+// constants used by SSE2 and AVX but initialized in C path.
 extern float rdft_wk1r[32];
 extern float rdft_wk2r[32];
 extern float rdft_wk3r[32];
@@ -51,6 +51,7 @@ extern rft_sub_128_t cftmdl_128;
 // entry points
 void aec_rdft_init(void);
 void aec_rdft_init_sse2(void);
+void aec_rdft_init_avx(void);
 void aec_rdft_forward_128(float *a);
 void aec_rdft_inverse_128(float *a);
 
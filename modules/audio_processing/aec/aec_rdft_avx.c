@@ -0,0 +1,242 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * AVX versions of the rdft butterflies. They do the same operations in the
+ * same order as the SSE2 versions, so the output is bit exact with them.
+ * cftmdl_128() only works on pairs of elements spread over the whole array
+ * and is left to the SSE2 version.
+ */
+
+#include "webrtc/modules/audio_processing/aec/aec_rdft.h"
+
+#include <immintrin.h>
+
+// Reverses the order of the eight elements of |a|.
+static __inline __m256 Reverse(__m256 a) {
+  const __m256 lanes_reversed = _mm256_permute_ps(a, _MM_SHUFFLE(0, 1, 2, 3));
+  return _mm256_permute2f128_ps(lanes_reversed, lanes_reversed, 0x01);
+}
+
+// Splits the eight complex values in |lo| and |hi| into their real parts
+// |re| and imaginary parts |im|.
+static __inline void Deinterleave(__m256 lo, __m256 hi,
+                                  __m256* re, __m256* im) {
+  const __m256 t0 = _mm256_permute2f128_ps(lo, hi, 0x20);
+  const __m256 t1 = _mm256_permute2f128_ps(lo, hi, 0x31);
+  *re = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0));
+  *im = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+// The inverse of Deinterleave().
+static __inline void Interleave(__m256 re, __m256 im,
+                                __m256* lo, __m256* hi) {
+  const __m256 t0 = _mm256_unpacklo_ps(re, im);
+  const __m256 t1 = _mm256_unpackhi_ps(re, im);
+  *lo = _mm256_permute2f128_ps(t0, t1, 0x20);
+  *hi = _mm256_permute2f128_ps(t0, t1, 0x31);
+}
+
+static void cft1st_128_AVX(float *a) {
+  const __m256 mm_swap_sign = _mm256_setr_ps(-1.f, 1.f, -1.f, 1.f,
+                                             -1.f, 1.f, -1.f, 1.f);
+  int j, k2;
+
+  // Each iteration does two iterations of the SSE2 version, |j| in the lower
+  // 128 bit lane and |j| + 16 in the upper one. The twiddle factors of the
+  // two are next to each other.
+  for (k2 = 0, j = 0; j < 128; j += 32, k2 += 8) {
+    const __m256 a00 = _mm256_loadu_ps(&a[j +  0]);
+    const __m256 a08 = _mm256_loadu_ps(&a[j +  8]);
+    const __m256 a16 = _mm256_loadu_ps(&a[j + 16]);
+    const __m256 a24 = _mm256_loadu_ps(&a[j + 24]);
+    const __m256 a00v = _mm256_permute2f128_ps(a00, a16, 0x20);
+    const __m256 a04v = _mm256_permute2f128_ps(a00, a16, 0x31);
+    const __m256 a08v = _mm256_permute2f128_ps(a08, a24, 0x20);
+    const __m256 a12v = _mm256_permute2f128_ps(a08, a24, 0x31);
+    const __m256 a01v = _mm256_shuffle_ps(a00v, a08v, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 a23v = _mm256_shuffle_ps(a00v, a08v, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 a45v = _mm256_shuffle_ps(a04v, a12v, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 a67v = _mm256_shuffle_ps(a04v, a12v, _MM_SHUFFLE(3, 2, 3, 2));
+
+    const __m256 wk1rv = _mm256_loadu_ps(&rdft_wk1r[k2]);
+    const __m256 wk1iv = _mm256_loadu_ps(&rdft_wk1i[k2]);
+    const __m256 wk2rv = _mm256_loadu_ps(&rdft_wk2r[k2]);
+    const __m256 wk2iv = _mm256_loadu_ps(&rdft_wk2i[k2]);
+    const __m256 wk3rv = _mm256_loadu_ps(&rdft_wk3r[k2]);
+    const __m256 wk3iv = _mm256_loadu_ps(&rdft_wk3i[k2]);
+    const __m256 x0v = _mm256_add_ps(a01v, a23v);
+    const __m256 x1v = _mm256_sub_ps(a01v, a23v);
+    const __m256 x2v = _mm256_add_ps(a45v, a67v);
+    const __m256 x3v = _mm256_sub_ps(a45v, a67v);
+    const __m256 x3w = _mm256_permute_ps(x3v, _MM_SHUFFLE(2, 3, 0, 1));
+    const __m256 x3s = _mm256_mul_ps(mm_swap_sign, x3w);
+
+    const __m256 y0v = _mm256_add_ps(x0v, x2v);
+    const __m256 y2v = _mm256_sub_ps(x0v, x2v);
+    const __m256 y1v = _mm256_add_ps(x1v, x3s);
+    const __m256 y3v = _mm256_sub_ps(x1v, x3s);
+    const __m256 b01v = y0v;
+    const __m256 b45v = _mm256_add_ps(_mm256_mul_ps(wk2rv, y2v),
+        _mm256_mul_ps(wk2iv, _mm256_permute_ps(y2v, _MM_SHUFFLE(2, 3, 0, 1))));
+    const __m256 b23v = _mm256_add_ps(_mm256_mul_ps(wk1rv, y1v),
+        _mm256_mul_ps(wk1iv, _mm256_permute_ps(y1v, _MM_SHUFFLE(2, 3, 0, 1))));
+    const __m256 b67v = _mm256_add_ps(_mm256_mul_ps(wk3rv, y3v),
+        _mm256_mul_ps(wk3iv, _mm256_permute_ps(y3v, _MM_SHUFFLE(2, 3, 0, 1))));
+
+    const __m256 b00v = _mm256_shuffle_ps(b01v, b23v, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 b04v = _mm256_shuffle_ps(b45v, b67v, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 b08v = _mm256_shuffle_ps(b01v, b23v, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 b12v = _mm256_shuffle_ps(b45v, b67v, _MM_SHUFFLE(3, 2, 3, 2));
+    _mm256_storeu_ps(&a[j +  0], _mm256_permute2f128_ps(b00v, b04v, 0x20));
+    _mm256_storeu_ps(&a[j +  8], _mm256_permute2f128_ps(b08v, b12v, 0x20));
+    _mm256_storeu_ps(&a[j + 16], _mm256_permute2f128_ps(b00v, b04v, 0x31));
+    _mm256_storeu_ps(&a[j + 24], _mm256_permute2f128_ps(b08v, b12v, 0x31));
+  }
+}
+
+static void rftfsub_128_AVX(float *a) {
+  const float *c = rdft_w + 32;
+  const __m256 mm_half = _mm256_set1_ps(0.5f);
+  int j1, j2, k1, k2;
+  float wkr, wki, xr, xi, yr, yi;
+
+  // Vectorized code (eight at once). The elements from the end of the array
+  // are reversed so that they line up with their counterparts at the start.
+  for (j1 = 1, j2 = 2; j2 + 15 < 64; j1 += 8, j2 += 16) {
+    // Load 'wk'.
+    const __m256 wkr_ = Reverse(_mm256_sub_ps(mm_half,
+                                              _mm256_loadu_ps(&c[25 - j1])));
+    const __m256 wki_ = _mm256_loadu_ps(&c[j1]);
+    // Load and shuffle 'a'.
+    __m256 a_j2_p0, a_j2_p1, a_k2_p0, a_k2_p1;
+    __m256 a_j2_0n, a_j2_8n, a_k2_0n, a_k2_8n;
+    Deinterleave(_mm256_loadu_ps(&a[j2 + 0]), _mm256_loadu_ps(&a[j2 + 8]),
+                 &a_j2_p0, &a_j2_p1);
+    Deinterleave(_mm256_loadu_ps(&a[114 - j2]), _mm256_loadu_ps(&a[122 - j2]),
+                 &a_k2_p0, &a_k2_p1);
+    a_k2_p0 = Reverse(a_k2_p0);
+    a_k2_p1 = Reverse(a_k2_p1);
+    {
+      // Calculate 'x'.
+      const __m256 xr_ = _mm256_sub_ps(a_j2_p0, a_k2_p0);
+      const __m256 xi_ = _mm256_add_ps(a_j2_p1, a_k2_p1);
+      // Calculate product into 'y'.
+      //    yr = wkr * xr - wki * xi;
+      //    yi = wkr * xi + wki * xr;
+      const __m256 yr_ = _mm256_sub_ps(_mm256_mul_ps(wkr_, xr_),
+                                       _mm256_mul_ps(wki_, xi_));
+      const __m256 yi_ = _mm256_add_ps(_mm256_mul_ps(wkr_, xi_),
+                                       _mm256_mul_ps(wki_, xr_));
+      // Update 'a'.
+      //    a[j2 + 0] -= yr;
+      //    a[j2 + 1] -= yi;
+      //    a[k2 + 0] += yr;
+      //    a[k2 + 1] -= yi;
+      Interleave(_mm256_sub_ps(a_j2_p0, yr_), _mm256_sub_ps(a_j2_p1, yi_),
+                 &a_j2_0n, &a_j2_8n);
+      Interleave(Reverse(_mm256_add_ps(a_k2_p0, yr_)),
+                 Reverse(_mm256_sub_ps(a_k2_p1, yi_)),
+                 &a_k2_0n, &a_k2_8n);
+    }
+    _mm256_storeu_ps(&a[j2 + 0], a_j2_0n);
+    _mm256_storeu_ps(&a[j2 + 8], a_j2_8n);
+    _mm256_storeu_ps(&a[114 - j2], a_k2_0n);
+    _mm256_storeu_ps(&a[122 - j2], a_k2_8n);
+  }
+  // Scalar code for the remaining items.
+  for (; j2 < 64; j1 += 1, j2 += 2) {
+    k2 = 128 - j2;
+    k1 =  32 - j1;
+    wkr = 0.5f - c[k1];
+    wki = c[j1];
+    xr = a[j2 + 0] - a[k2 + 0];
+    xi = a[j2 + 1] + a[k2 + 1];
+    yr = wkr * xr - wki * xi;
+    yi = wkr * xi + wki * xr;
+    a[j2 + 0] -= yr;
+    a[j2 + 1] -= yi;
+    a[k2 + 0] += yr;
+    a[k2 + 1] -= yi;
+  }
+}
+
+static void rftbsub_128_AVX(float *a) {
+  const float *c = rdft_w + 32;
+  const __m256 mm_half = _mm256_set1_ps(0.5f);
+  int j1, j2, k1, k2;
+  float wkr, wki, xr, xi, yr, yi;
+
+  a[1] = -a[1];
+  // Vectorized code (eight at once), laid out as in rftfsub_128_AVX().
+  for (j1 = 1, j2 = 2; j2 + 15 < 64; j1 += 8, j2 += 16) {
+    // Load 'wk'.
+    const __m256 wkr_ = Reverse(_mm256_sub_ps(mm_half,
+                                              _mm256_loadu_ps(&c[25 - j1])));
+    const __m256 wki_ = _mm256_loadu_ps(&c[j1]);
+    // Load and shuffle 'a'.
+    __m256 a_j2_p0, a_j2_p1, a_k2_p0, a_k2_p1;
+    __m256 a_j2_0n, a_j2_8n, a_k2_0n, a_k2_8n;
+    Deinterleave(_mm256_loadu_ps(&a[j2 + 0]), _mm256_loadu_ps(&a[j2 + 8]),
+                 &a_j2_p0, &a_j2_p1);
+    Deinterleave(_mm256_loadu_ps(&a[114 - j2]), _mm256_loadu_ps(&a[122 - j2]),
+                 &a_k2_p0, &a_k2_p1);
+    a_k2_p0 = Reverse(a_k2_p0);
+    a_k2_p1 = Reverse(a_k2_p1);
+    {
+      // Calculate 'x'.
+      const __m256 xr_ = _mm256_sub_ps(a_j2_p0, a_k2_p0);
+      const __m256 xi_ = _mm256_add_ps(a_j2_p1, a_k2_p1);
+      // Calculate product into 'y'.
+      //    yr = wkr * xr + wki * xi;
+      //    yi = wkr * xi - wki * xr;
+      const __m256 yr_ = _mm256_add_ps(_mm256_mul_ps(wkr_, xr_),
+                                       _mm256_mul_ps(wki_, xi_));
+      const __m256 yi_ = _mm256_sub_ps(_mm256_mul_ps(wkr_, xi_),
+                                       _mm256_mul_ps(wki_, xr_));
+      // Update 'a'.
+      //    a[j2 + 0] = a[j2 + 0] - yr;
+      //    a[j2 + 1] = yi - a[j2 + 1];
+      //    a[k2 + 0] = yr + a[k2 + 0];
+      //    a[k2 + 1] = yi - a[k2 + 1];
+      Interleave(_mm256_sub_ps(a_j2_p0, yr_), _mm256_sub_ps(yi_, a_j2_p1),
+                 &a_j2_0n, &a_j2_8n);
+      Interleave(Reverse(_mm256_add_ps(a_k2_p0, yr_)),
+                 Reverse(_mm256_sub_ps(yi_, a_k2_p1)),
+                 &a_k2_0n, &a_k2_8n);
+    }
+    _mm256_storeu_ps(&a[j2 + 0], a_j2_0n);
+    _mm256_storeu_ps(&a[j2 + 8], a_j2_8n);
+    _mm256_storeu_ps(&a[114 - j2], a_k2_0n);
+    _mm256_storeu_ps(&a[122 - j2], a_k2_8n);
+  }
+  // Scalar code for the remaining items.
+  for (; j2 < 64; j1 += 1, j2 += 2) {
+    k2 = 128 - j2;
+    k1 =  32 - j1;
+    wkr = 0.5f - c[k1];
+    wki = c[j1];
+    xr = a[j2 + 0] - a[k2 + 0];
+    xi = a[j2 + 1] + a[k2 + 1];
+    yr = wkr * xr + wki * xi;
+    yi = wkr * xi - wki * xr;
+    a[j2 + 0] = a[j2 + 0] - yr;
+    a[j2 + 1] = yi - a[j2 + 1];
+    a[k2 + 0] = yr + a[k2 + 0];
+    a[k2 + 1] = yi - a[k2 + 1];
+  }
+  a[65] = -a[65];
+}
+
+void aec_rdft_init_avx(void) {
+  cft1st_128 = cft1st_128_AVX;
+  rftfsub_128 = rftfsub_128_AVX;
+  rftbsub_128 = rftbsub_128_AVX;
+}
@@ -24,7 +24,7 @@
 enum { kEstimateLengthFrames = 400 };
 
 typedef struct {
-    short buffer[kResamplerBufferSize];
+    float buffer[kResamplerBufferSize];
     float position;
 
     int deviceSampleRateHz;
@@ -72,15 +72,15 @@ int WebRtcAec_FreeResampler(void *resampInst)
 }
 
 void WebRtcAec_ResampleLinear(void *resampInst,
-                              const short *inspeech,
+                              const float *inspeech,
                               int size,
                               float skew,
-                              short *outspeech,
+                              float *outspeech,
                               int *size_out)
 {
     resampler_t *obj = (resampler_t*) resampInst;
 
-    short *y;
+    float *y;
     float be, tnew, interp;
     int tn, mm;
 
@@ -93,7 +93,7 @@ void WebRtcAec_ResampleLinear(void *resampInst,
     // Add new frame data in lookahead
     memcpy(&obj->buffer[FRAME_LEN + kResamplingDelay],
            inspeech,
-           size * sizeof(short));
+           size * sizeof(float));
 
     // Sample rate ratio
     be = 1 + skew;
@@ -117,7 +117,7 @@ void WebRtcAec_ResampleLinear(void *resampInst,
             interp = -32768;
         }
 
-        outspeech[mm] = (short) interp;
+        outspeech[mm] = interp;
         mm++;
 
         tnew = be * mm + obj->position;
@@ -130,7 +130,7 @@ void WebRtcAec_ResampleLinear(void *resampInst,
     // Shift buffer
     memmove(obj->buffer,
             &obj->buffer[size],
-            (kResamplerBufferSize - size) * sizeof(short));
+            (kResamplerBufferSize - size) * sizeof(float));
 }
 
 int WebRtcAec_GetSkew(void *resampInst, int rawSkew, float *skewEst)
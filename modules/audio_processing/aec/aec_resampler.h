@@ -24,12 +24,13 @@ int WebRtcAec_FreeResampler(void *resampInst);
 // Estimates skew from raw measurement.
 int WebRtcAec_GetSkew(void *resampInst, int rawSkew, float *skewEst);
 
-// Resamples input using linear interpolation.
+// Resamples input in the int16 range using linear interpolation. The output
+// is saturated to the int16 range, but not rounded.
 void WebRtcAec_ResampleLinear(void *resampInst,
-                              const short *inspeech,
+                              const float *inspeech,
                               int size,
                               float skew,
-                              short *outspeech,
+                              float *outspeech,
                               int *size_out);
 
 #endif  // WEBRTC_MODULES_AUDIO_PROCESSING_AEC_AEC_RESAMPLER_H_
@@ -225,20 +225,10 @@ int32_t WebRtcAec_Init(void *aecInst, int32_t sampFreq, int32_t scSampFreq)
     return 0;
 }
 
-// only buffer L band for farend
-int32_t WebRtcAec_BufferFarend(void *aecInst, const int16_t *farend,
-                               int16_t nrOfSamples)
+// Checks the parameters common to the int16 and float far-end interfaces.
+static int CheckFarendParameters(aecpc_t* aecpc, const void* farend,
+                                 int16_t nrOfSamples)
 {
-    aecpc_t *aecpc = aecInst;
-    int32_t retVal = 0;
-    int newNrOfSamples = (int) nrOfSamples;
-    short newFarend[MAX_RESAMP_LEN];
-    const int16_t* farend_ptr = farend;
-    float tmp_farend[MAX_RESAMP_LEN];
-    const float* farend_float = tmp_farend;
-    float skew;
-    int i = 0;
-
     if (aecpc == NULL) {
         return -1;
     }
@@ -259,27 +249,53 @@ int32_t WebRtcAec_BufferFarend(void *aecInst, const int16_t *farend,
         return -1;
     }
 
+    return 0;
+}
+
+// Buffers far-end samples in the int16 range. The int16 interface truncates
+// the resampled far-end to int16, as it always has, when
+// |truncateResampled| is set.
+static void BufferFarend(aecpc_t* aecpc, const float* farend,
+                         int16_t nrOfSamples, int truncateResampled)
+{
+    int newNrOfSamples = (int) nrOfSamples;
+    float newFarend[MAX_RESAMP_LEN];
+    const float* farend_ptr = farend;
+    float tmp_farend[MAX_RESAMP_LEN];
+    const float* farend_float = tmp_farend;
+    float skew;
+    int i = 0;
+#ifdef WEBRTC_AEC_DEBUG_DUMP
+    int16_t farend_s16[MAX_RESAMP_LEN];
+    int16_t* farend_s16_ptr = NULL;
+#endif
+
     skew = aecpc->skew;
 
     if (aecpc->skewMode == kAecTrue && aecpc->resample == kAecTrue) {
         // Resample and get a new number of samples
         WebRtcAec_ResampleLinear(aecpc->resampler, farend, nrOfSamples, skew,
                                  newFarend, &newNrOfSamples);
-        farend_ptr = (const int16_t*) newFarend;
+        if (truncateResampled) {
+            for (i = 0; i < newNrOfSamples; i++) {
+                newFarend[i] = (float) (int16_t) newFarend[i];
+            }
+        }
+        farend_ptr = newFarend;
     }
 
     WebRtcAec_SetSystemDelay(aecpc->aec, WebRtcAec_system_delay(aecpc->aec) +
                              newNrOfSamples);
 
 #ifdef WEBRTC_AEC_DEBUG_DUMP
-    WebRtc_WriteBuffer(aecpc->far_pre_buf_s16, farend_ptr,
-                       (size_t) newNrOfSamples);
-#endif
-    // Cast to float and write the time-domain data to |far_pre_buf|.
     for (i = 0; i < newNrOfSamples; i++) {
-      tmp_farend[i] = (float) farend_ptr[i];
+      farend_s16[i] = (int16_t) farend_ptr[i];
     }
-    WebRtc_WriteBuffer(aecpc->far_pre_buf, farend_float,
+    WebRtc_WriteBuffer(aecpc->far_pre_buf_s16, farend_s16,
+                       (size_t) newNrOfSamples);
+#endif
+    // Write the time-domain data to |far_pre_buf|.
+    WebRtc_WriteBuffer(aecpc->far_pre_buf, farend_ptr,
                        (size_t) newNrOfSamples);
 
     // Transform to frequency domain if we have enough data.
@@ -293,31 +309,54 @@ int32_t WebRtcAec_BufferFarend(void *aecInst, const int16_t *farend,
       // Rewind |far_pre_buf| PART_LEN samples for overlap before continuing.
       WebRtc_MoveReadPtr(aecpc->far_pre_buf, -PART_LEN);
 #ifdef WEBRTC_AEC_DEBUG_DUMP
-      WebRtc_ReadBuffer(aecpc->far_pre_buf_s16, (void**) &farend_ptr, newFarend,
-                        PART_LEN2);
+      WebRtc_ReadBuffer(aecpc->far_pre_buf_s16, (void**) &farend_s16_ptr,
+                        farend_s16, PART_LEN2);
       WebRtc_WriteBuffer(WebRtcAec_far_time_buf(aecpc->aec),
-                         &farend_ptr[PART_LEN], 1);
+                         &farend_s16_ptr[PART_LEN], 1);
       WebRtc_MoveReadPtr(aecpc->far_pre_buf_s16, -PART_LEN);
 #endif
     }
+}
 
-    return retVal;
+// only buffer L band for farend
+int32_t WebRtcAec_BufferFarend(void *aecInst, const int16_t *farend,
+                               int16_t nrOfSamples)
+{
+    aecpc_t *aecpc = aecInst;
+    float farend_float[2 * FRAME_LEN];
+    int i = 0;
+
+    if (CheckFarendParameters(aecpc, farend, nrOfSamples) != 0) {
+        return -1;
+    }
+
+    for (i = 0; i < nrOfSamples; i++) {
+        farend_float[i] = (float) farend[i];
+    }
+    BufferFarend(aecpc, farend_float, nrOfSamples, 1);
+
+    return 0;
 }
 
-int32_t WebRtcAec_Process(void *aecInst, const int16_t *nearend,
-                          const int16_t *nearendH, int16_t *out, int16_t *outH,
-                          int16_t nrOfSamples, int16_t msInSndCardBuf,
-                          int32_t skew)
+int32_t WebRtcAec_BufferFarendFloat(void* aecInst, const float* farend,
+                                    int16_t nrOfSamples)
 {
     aecpc_t *aecpc = aecInst;
-    int32_t retVal = 0;
-    short i;
-    short nBlocks10ms;
-    short nFrames;
-    // Limit resampling to doubling/halving of signal
-    const float minSkewEst = -0.5f;
-    const float maxSkewEst = 1.0f;
 
+    if (CheckFarendParameters(aecpc, farend, nrOfSamples) != 0) {
+        return -1;
+    }
+
+    BufferFarend(aecpc, farend, nrOfSamples, 0);
+
+    return 0;
+}
+
+// Checks the parameters common to the int16 and float process interfaces.
+static int CheckProcessParameters(aecpc_t* aecpc, const void* nearend,
+                                  const void* nearendH, const void* out,
+                                  int16_t nrOfSamples)
+{
     if (aecpc == NULL) {
         return -1;
     }
@@ -349,6 +388,24 @@ int32_t WebRtcAec_Process(void *aecInst, const int16_t *nearend,
        return -1;
     }
 
+    return 0;
+}
+
+// Processes near-end samples in the int16 range. The output is saturated to
+// the int16 range, but not rounded.
+static int32_t ProcessNearend(aecpc_t* aecpc, const float* nearend,
+                              const float* nearendH, float* out, float* outH,
+                              int16_t nrOfSamples, int16_t msInSndCardBuf,
+                              int32_t skew)
+{
+    int32_t retVal = 0;
+    short i;
+    short nBlocks10ms;
+    short nFrames;
+    // Limit resampling to doubling/halving of signal
+    const float minSkewEst = -0.5f;
+    const float maxSkewEst = 1.0f;
+
     if (msInSndCardBuf < 0) {
         msInSndCardBuf = 0;
         aecpc->lastError = AEC_BAD_PARAMETER_WARNING;
@@ -402,7 +459,10 @@ int32_t WebRtcAec_Process(void *aecInst, const int16_t *nearend,
     if (aecpc->ECstartup) {
         if (nearend != out) {
             // Only needed if they don't already point to the same place.
-            memcpy(out, nearend, sizeof(short) * nrOfSamples);
+            memcpy(out, nearend, sizeof(float) * nrOfSamples);
+        }
+        if (aecpc->sampFreq == 32000 && nearendH != outH) {
+            memcpy(outH, nearendH, sizeof(float) * nrOfSamples);
         }
 
         // The AEC is in the start up mode
@@ -507,6 +567,65 @@ int32_t WebRtcAec_Process(void *aecInst, const int16_t *nearend,
     return retVal;
 }
 
+int32_t WebRtcAec_Process(void *aecInst, const int16_t *nearend,
+                          const int16_t *nearendH, int16_t *out, int16_t *outH,
+                          int16_t nrOfSamples, int16_t msInSndCardBuf,
+                          int32_t skew)
+{
+    aecpc_t *aecpc = aecInst;
+    int32_t retVal = 0;
+    float nearendFloat[2 * FRAME_LEN];
+    float nearendHFloat[2 * FRAME_LEN];
+    float outFloat[2 * FRAME_LEN];
+    float outHFloat[2 * FRAME_LEN];
+    int i = 0;
+
+    if (CheckProcessParameters(aecpc, nearend, nearendH, out,
+                               nrOfSamples) != 0) {
+        return -1;
+    }
+
+    for (i = 0; i < nrOfSamples; i++) {
+        nearendFloat[i] = (float) nearend[i];
+    }
+    if (aecpc->sampFreq == 32000) {
+        for (i = 0; i < nrOfSamples; i++) {
+            nearendHFloat[i] = (float) nearendH[i];
+        }
+    }
+
+    retVal = ProcessNearend(aecpc, nearendFloat, nearendHFloat, outFloat,
+                            outHFloat, nrOfSamples, msInSndCardBuf, skew);
+
+    // The output is already saturated.
+    for (i = 0; i < nrOfSamples; i++) {
+        out[i] = (int16_t) outFloat[i];
+    }
+    if (aecpc->sampFreq == 32000) {
+        for (i = 0; i < nrOfSamples; i++) {
+            outH[i] = (int16_t) outHFloat[i];
+        }
+    }
+
+    return retVal;
+}
+
+int32_t WebRtcAec_ProcessFloat(void* aecInst, const float* nearend,
+                               const float* nearendH, float* out, float* outH,
+                               int16_t nrOfSamples, int16_t msInSndCardBuf,
+                               int32_t skew)
+{
+    aecpc_t *aecpc = aecInst;
+
+    if (CheckProcessParameters(aecpc, nearend, nearendH, out,
+                               nrOfSamples) != 0) {
+        return -1;
+    }
+
+    return ProcessNearend(aecpc, nearend, nearendH, out, outH, nrOfSamples,
+                          msInSndCardBuf, skew);
+}
+
 int WebRtcAec_set_config(void* handle, AecConfig config) {
   aecpc_t* self = (aecpc_t*)handle;
 
@@ -23,6 +23,11 @@ LOCAL_SRC_FILES := \
     echo_control_mobile.c \
     aecm_core.c
 
+ifeq ($(TARGET_ARCH),x86)
+LOCAL_SRC_FILES += \
+    aecm_core_sse2.c
+endif
+
 # Flags passed to both C and C++ files.
 LOCAL_CFLAGS := $(MY_WEBRTC_COMMON_DEFS)
 
@@ -28,11 +28,9 @@ FILE *testfile;
 #endif
 
 // Square root of Hanning window in Q14.
-#if defined(WEBRTC_DETECT_ARM_NEON) || defined(WEBRTC_ARCH_ARM_NEON)
-// Table is defined in an ARM assembly file.
-extern const ALIGN8_BEG int16_t WebRtcAecm_kSqrtHanning[] ALIGN8_END;
-#else
-static const ALIGN8_BEG int16_t WebRtcAecm_kSqrtHanning[] ALIGN8_END = {
+#if !(defined(WEBRTC_DETECT_ARM_NEON) || defined(WEBRTC_ARCH_ARM_NEON))
+// On ARM Neon platforms the table is defined with the Neon functions.
+const ALIGN8_BEG int16_t WebRtcAecm_kSqrtHanning[] ALIGN8_END = {
   0, 399, 798, 1196, 1594, 1990, 2386, 2780, 3172,
   3562, 3951, 4337, 4720, 5101, 5478, 5853, 6224,
   6591, 6954, 7313, 7668, 8019, 8364, 8705, 9040,
@@ -670,6 +668,19 @@ int WebRtcAecm_InitCore(AecmCore_t * const aecm, int samplingFreq)
     WebRtcAecm_InitNeon();
 #endif
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if (WebRtc_GetCPUInfo(kSSE2))
+    {
+        WebRtcAecm_InitSse2();
+    }
+#if defined(WEBRTC_AUDIOPROC_AVX2)
+    if (WebRtc_GetCPUInfo(kAVX2))
+    {
+        WebRtcAecm_InitAvx2();
+    }
+#endif
+#endif
+
     return 0;
 }
 
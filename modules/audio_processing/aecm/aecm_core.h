@@ -339,4 +339,16 @@ void WebRtcAecm_StoreAdaptiveChannelNeon(AecmCore_t* aecm,
 void WebRtcAecm_ResetAdaptiveChannelNeon(AecmCore_t* aecm);
 #endif
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Point the above function pointers to the x86 versions, which are defined in
+// file aecm_core_sse2.c and file aecm_core_avx2.c. The AVX2 initialization
+// only replaces some of the functions, and is done after the SSE2
+// initialization.
+void WebRtcAecm_InitSse2(void);
+void WebRtcAecm_InitAvx2(void);
+#endif
+
+// Square root of Hanning window in Q14, shared by the optimized versions.
+extern const ALIGN8_BEG int16_t WebRtcAecm_kSqrtHanning[] ALIGN8_END;
+
 #endif
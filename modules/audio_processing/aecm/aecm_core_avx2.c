@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The core AECM, AVX2 version of the functions working on the echo channel.
+ * The windowing around the FFTs is left to the SSE2 version, since the FFTs
+ * dominate there. All functions are bit exact with the generic C versions in
+ * aecm_core.c.
+ */
+
+#include "webrtc/modules/audio_processing/aecm/aecm_core.h"
+
+#include <immintrin.h>
+#include <string.h>
+
+// Multiplies the signed 16 bit elements of |a| with the unsigned 16 bit
+// elements of |b|, like WEBRTC_SPL_MUL_16_U16() does. |lo| gets the products
+// of the lower eight elements, and |hi| of the upper eight.
+static __inline void MulSignedUnsigned(__m256i a,
+                                       __m256i b,
+                                       __m256i* lo,
+                                       __m256i* hi) {
+  const __m256i prod_lo = _mm256_mullo_epi16(a, b);
+  // The unsigned high half is off by |b| for each negative element of |a|.
+  const __m256i prod_hi = _mm256_sub_epi16(_mm256_mulhi_epu16(a, b),
+      _mm256_and_si256(_mm256_srai_epi16(a, 15), b));
+  // The unpacking is done within each 128 bit lane, so swap the middle
+  // quarters back into element order.
+  const __m256i unpack_lo = _mm256_unpacklo_epi16(prod_lo, prod_hi);
+  const __m256i unpack_hi = _mm256_unpackhi_epi16(prod_lo, prod_hi);
+  *lo = _mm256_permute2x128_si256(unpack_lo, unpack_hi, 0x20);
+  *hi = _mm256_permute2x128_si256(unpack_lo, unpack_hi, 0x31);
+}
+
+// Returns the sum of the eight 32 bit elements of |a|.
+static __inline uint32_t HorizontalSum(__m256i a) {
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(a),
+                              _mm256_extracti128_si256(a, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (uint32_t)_mm_cvtsi128_si32(sum);
+}
+
+static void CalcLinearEnergiesAvx2(AecmCore_t* aecm,
+                                   const uint16_t* far_spectrum,
+                                   int32_t* echo_est,
+                                   uint32_t* far_energy,
+                                   uint32_t* echo_energy_adapt,
+                                   uint32_t* echo_energy_stored) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i far_sum = _mm256_setzero_si256();
+  __m256i adapt_sum = _mm256_setzero_si256();
+  __m256i stored_sum = _mm256_setzero_si256();
+  int i;
+
+  // Get energy for the delayed far end signal and estimated
+  // echo using both stored and adapted channels. Only the echo estimate
+  // needs its elements in order, the sums don't.
+  for (i = 0; i < PART_LEN; i += 16) {
+    const __m256i far = _mm256_loadu_si256((const __m256i*)&far_spectrum[i]);
+    const __m256i stored =
+        _mm256_loadu_si256((const __m256i*)&aecm->channelStored[i]);
+    const __m256i adapt =
+        _mm256_loadu_si256((const __m256i*)&aecm->channelAdapt16[i]);
+    const __m256i adapt_lo = _mm256_mullo_epi16(adapt, far);
+    const __m256i adapt_hi = _mm256_mulhi_epu16(adapt, far);
+    __m256i echo_lo, echo_hi;
+
+    MulSignedUnsigned(stored, far, &echo_lo, &echo_hi);
+    _mm256_storeu_si256((__m256i*)&echo_est[i], echo_lo);
+    _mm256_storeu_si256((__m256i*)&echo_est[i + 8], echo_hi);
+    stored_sum = _mm256_add_epi32(stored_sum,
+                                  _mm256_add_epi32(echo_lo, echo_hi));
+
+    far_sum = _mm256_add_epi32(far_sum,
+        _mm256_add_epi32(_mm256_unpacklo_epi16(far, zero),
+                         _mm256_unpackhi_epi16(far, zero)));
+    adapt_sum = _mm256_add_epi32(adapt_sum,
+        _mm256_add_epi32(_mm256_unpacklo_epi16(adapt_lo, adapt_hi),
+                         _mm256_unpackhi_epi16(adapt_lo, adapt_hi)));
+  }
+  echo_est[i] = WEBRTC_SPL_MUL_16_U16(aecm->channelStored[i],
+                                      far_spectrum[i]);
+
+  *far_energy += HorizontalSum(far_sum) + far_spectrum[i];
+  *echo_energy_adapt += HorizontalSum(adapt_sum) +
+      WEBRTC_SPL_UMUL_16_16(aecm->channelAdapt16[i], far_spectrum[i]);
+  *echo_energy_stored += HorizontalSum(stored_sum) + (uint32_t)echo_est[i];
+}
+
+static void StoreAdaptiveChannelAvx2(AecmCore_t* aecm,
+                                     const uint16_t* far_spectrum,
+                                     int32_t* echo_est) {
+  int i;
+
+  // During startup we store the channel every block.
+  memcpy(aecm->channelStored, aecm->channelAdapt16,
+         sizeof(int16_t) * PART_LEN1);
+  // Recalculate echo estimate
+  for (i = 0; i < PART_LEN; i += 16) {
+    __m256i echo_lo, echo_hi;
+    MulSignedUnsigned(
+        _mm256_loadu_si256((const __m256i*)&aecm->channelStored[i]),
+        _mm256_loadu_si256((const __m256i*)&far_spectrum[i]),
+        &echo_lo, &echo_hi);
+    _mm256_storeu_si256((__m256i*)&echo_est[i], echo_lo);
+    _mm256_storeu_si256((__m256i*)&echo_est[i + 8], echo_hi);
+  }
+  echo_est[i] = WEBRTC_SPL_MUL_16_U16(aecm->channelStored[i],
+                                      far_spectrum[i]);
+}
+
+static void ResetAdaptiveChannelAvx2(AecmCore_t* aecm) {
+  int i;
+
+  // The stored channel has a significantly lower MSE than the adaptive one for
+  // two consecutive calculations. Reset the adaptive channel.
+  memcpy(aecm->channelAdapt16, aecm->channelStored,
+         sizeof(int16_t) * PART_LEN1);
+  // Restore the W32 channel.
+  for (i = 0; i < PART_LEN; i += 16) {
+    const __m256i stored =
+        _mm256_loadu_si256((const __m256i*)&aecm->channelStored[i]);
+    _mm256_storeu_si256((__m256i*)&aecm->channelAdapt32[i],
+        _mm256_slli_epi32(_mm256_cvtepi16_epi32(
+            _mm256_castsi256_si128(stored)), 16));
+    _mm256_storeu_si256((__m256i*)&aecm->channelAdapt32[i + 8],
+        _mm256_slli_epi32(_mm256_cvtepi16_epi32(
+            _mm256_extracti128_si256(stored, 1)), 16));
+  }
+  aecm->channelAdapt32[i] =
+      WEBRTC_SPL_LSHIFT_W32((int32_t)aecm->channelStored[i], 16);
+}
+
+void WebRtcAecm_InitAvx2(void) {
+  WebRtcAecm_CalcLinearEnergies = CalcLinearEnergiesAvx2;
+  WebRtcAecm_StoreAdaptiveChannel = StoreAdaptiveChannelAvx2;
+  WebRtcAecm_ResetAdaptiveChannel = ResetAdaptiveChannelAvx2;
+}
@@ -0,0 +1,308 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The core AECM, SSE2 version of speed-critical functions.
+ * All functions are bit exact with the generic C versions in aecm_core.c.
+ */
+
+#include "webrtc/modules/audio_processing/aecm/aecm_core.h"
+
+#include <emmintrin.h>
+#include <string.h>
+
+#include "webrtc/common_audio/signal_processing/include/real_fft.h"
+
+// Square root of Hanning window in Q14, in reversed order.
+static const ALIGN8_BEG int16_t kSqrtHanningReversed[] ALIGN8_END = {
+  16384, 16373, 16354, 16325, 16286, 16237, 16179, 16111,
+  16034, 15947, 15851, 15746, 15631, 15506, 15373, 15231,
+  15079, 14918, 14749, 14571, 14384, 14189, 13985, 13773,
+  13553, 13325, 13089, 12845, 12594, 12335, 12068, 11795,
+  11514, 11227, 10933, 10633, 10326, 10013, 9695,  9370,
+  9040,  8705,  8364,  8019, 7668,  7313,  6954,  6591,
+  6224,  5853,  5478,  5101, 4720,  4337,  3951,  3562,
+  3172,  2780,  2386,  1990, 1594,  1196,  798,   399
+};
+
+// Multiplies the 16 bit elements of |a| and |b| into 32 bit products, adds
+// |round| and shifts them down arithmetically by 14. |lo| gets the results of
+// the lower four elements, and |hi| of the upper four.
+static __inline void MulShift14(__m128i a,
+                                __m128i b,
+                                __m128i round,
+                                __m128i* lo,
+                                __m128i* hi) {
+  const __m128i prod_lo = _mm_mullo_epi16(a, b);
+  const __m128i prod_hi = _mm_mulhi_epi16(a, b);
+  *lo = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(prod_lo, prod_hi),
+                                     round), 14);
+  *hi = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(prod_lo, prod_hi),
+                                     round), 14);
+}
+
+// Multiplies the signed 16 bit elements of |a| with the unsigned 16 bit
+// elements of |b|, like WEBRTC_SPL_MUL_16_U16() does.
+static __inline void MulSignedUnsigned(__m128i a,
+                                       __m128i b,
+                                       __m128i* lo,
+                                       __m128i* hi) {
+  const __m128i prod_lo = _mm_mullo_epi16(a, b);
+  // The unsigned high half is off by |b| for each negative element of |a|.
+  const __m128i prod_hi = _mm_sub_epi16(_mm_mulhi_epu16(a, b),
+      _mm_and_si128(_mm_srai_epi16(a, 15), b));
+  *lo = _mm_unpacklo_epi16(prod_lo, prod_hi);
+  *hi = _mm_unpackhi_epi16(prod_lo, prod_hi);
+}
+
+// Sign extends the low 16 bits of each 32 bit element.
+static __inline __m128i ExtendLow16(__m128i a) {
+  return _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+}
+
+// Shifts the 32 bit elements of |a| like WEBRTC_SPL_SHIFT_W32() does.
+static __inline __m128i ShiftW32(__m128i a, int shift) {
+  if (shift >= 0) {
+    return _mm_sll_epi32(a, _mm_cvtsi32_si128(shift));
+  }
+  return _mm_sra_epi32(a, _mm_cvtsi32_si128(-shift));
+}
+
+// Returns the sum of the four 32 bit elements of |a|.
+static __inline uint32_t HorizontalSum(__m128i a) {
+  a = _mm_add_epi32(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+  a = _mm_add_epi32(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (uint32_t)_mm_cvtsi128_si32(a);
+}
+
+static void WindowAndFFTSse2(AecmCore_t* aecm,
+                             int16_t* fft,
+                             const int16_t* time_signal,
+                             complex16_t* freq_signal,
+                             int time_signal_scaling) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i scaling = _mm_cvtsi32_si128(time_signal_scaling);
+  // Negates the imaginary parts of the complex samples.
+  const __m128i conjugate = _mm_set_epi16(-1, 1, -1, 1, -1, 1, -1, 1);
+  int16_t* freq = (int16_t*)freq_signal;
+  int i;
+
+  // Window the time domain signal and insert it into the real parts of the
+  // transformation array |fft|, with zeros in the imaginary parts.
+  for (i = 0; i < PART_LEN; i += 8) {
+    __m128i lo, hi, windowed;
+    __m128i signal = _mm_loadu_si128((const __m128i*)&time_signal[i]);
+    __m128i window = _mm_loadu_si128(
+        (const __m128i*)&WebRtcAecm_kSqrtHanning[i]);
+    // The shift truncates to 16 bits, like the C version does.
+    MulShift14(_mm_sll_epi16(signal, scaling), window, zero, &lo, &hi);
+    windowed = _mm_packs_epi32(ExtendLow16(lo), ExtendLow16(hi));
+    _mm_storeu_si128((__m128i*)&fft[2 * i],
+                     _mm_unpacklo_epi16(windowed, zero));
+    _mm_storeu_si128((__m128i*)&fft[2 * i + 8],
+                     _mm_unpackhi_epi16(windowed, zero));
+
+    signal = _mm_loadu_si128((const __m128i*)&time_signal[PART_LEN + i]);
+    window = _mm_loadu_si128((const __m128i*)&kSqrtHanningReversed[i]);
+    MulShift14(_mm_sll_epi16(signal, scaling), window, zero, &lo, &hi);
+    windowed = _mm_packs_epi32(ExtendLow16(lo), ExtendLow16(hi));
+    _mm_storeu_si128((__m128i*)&fft[PART_LEN2 + 2 * i],
+                     _mm_unpacklo_epi16(windowed, zero));
+    _mm_storeu_si128((__m128i*)&fft[PART_LEN2 + 2 * i + 8],
+                     _mm_unpackhi_epi16(windowed, zero));
+  }
+
+  // Do forward FFT, then take only the first PART_LEN complex samples,
+  // and change signs of the imaginary parts.
+  WebRtcSpl_RealForwardFFT(aecm->real_fft, fft, freq);
+  for (i = 0; i < PART_LEN2; i += 8) {
+    __m128i* p = (__m128i*)&freq[i];
+    _mm_storeu_si128(p, _mm_mullo_epi16(_mm_loadu_si128(p), conjugate));
+  }
+}
+
+static void InverseFFTAndWindowSse2(AecmCore_t* aecm,
+                                    int16_t* fft,
+                                    complex16_t* efw,
+                                    int16_t* output,
+                                    const int16_t* nearendClean) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi32(8192);
+  const __m128i conjugate = _mm_set_epi16(-1, 1, -1, 1, -1, 1, -1, 1);
+  const __m128i imag_mask = _mm_set1_epi32((int32_t)0xFFFF0000);
+  int16_t* time = (int16_t*)efw;
+  int i, j, shift;
+
+  // Synthesis. Four complex samples at a time go conjugated to the lower
+  // half of |fft|, and mirrored to the upper half.
+  for (i = 1; i + 3 < PART_LEN; i += 4) {
+    const __m128i spectrum = _mm_loadu_si128((const __m128i*)&efw[i]);
+    _mm_storeu_si128((__m128i*)&fft[2 * i],
+                     _mm_mullo_epi16(spectrum, conjugate));
+    _mm_storeu_si128((__m128i*)&fft[PART_LEN4 - 2 * (i + 3)],
+                     _mm_shuffle_epi32(spectrum, _MM_SHUFFLE(0, 1, 2, 3)));
+  }
+  for (; i < PART_LEN; i++) {
+    j = i << 1;
+    fft[j] = efw[i].real;
+    fft[PART_LEN4 - j] = efw[i].real;
+    fft[j + 1] = -efw[i].imag;
+    fft[PART_LEN4 - (j - 1)] = efw[i].imag;
+  }
+  fft[0] = efw[0].real;
+  fft[1] = -efw[0].imag;
+
+  fft[PART_LEN2] = efw[PART_LEN].real;
+  fft[PART_LEN2 + 1] = -efw[PART_LEN].imag;
+
+  // Inverse FFT. Then take only the real values, and keep outCFFT
+  // to scale the samples in the next block.
+  shift = WebRtcSpl_RealInverseFFT(aecm->real_fft, fft, time) -
+      aecm->dfaCleanQDomain;
+  for (i = 0; i < PART_LEN; i += 8) {
+    __m128i lo, hi, windowed;
+    const __m128i samples_lo = _mm_loadu_si128((const __m128i*)&time[2 * i]);
+    const __m128i samples_hi =
+        _mm_loadu_si128((const __m128i*)&time[2 * i + 8]);
+    const __m128i out_buf = _mm_loadu_si128((const __m128i*)&aecm->outBuf[i]);
+    __m128i real = _mm_packs_epi32(ExtendLow16(samples_lo),
+                                   ExtendLow16(samples_hi));
+
+    MulShift14(real, _mm_loadu_si128(
+        (const __m128i*)&WebRtcAecm_kSqrtHanning[i]), round, &lo, &hi);
+    lo = _mm_add_epi32(ShiftW32(ExtendLow16(lo), shift),
+                       _mm_srai_epi32(_mm_unpacklo_epi16(out_buf, out_buf), 16));
+    hi = _mm_add_epi32(ShiftW32(ExtendLow16(hi), shift),
+                       _mm_srai_epi32(_mm_unpackhi_epi16(out_buf, out_buf), 16));
+    windowed = _mm_packs_epi32(lo, hi);
+    _mm_storeu_si128((__m128i*)&output[i], windowed);
+    // Write the real parts back to |efw|, keeping the imaginary parts.
+    _mm_storeu_si128((__m128i*)&time[2 * i],
+                     _mm_or_si128(_mm_and_si128(samples_lo, imag_mask),
+                                  _mm_unpacklo_epi16(windowed, zero)));
+    _mm_storeu_si128((__m128i*)&time[2 * i + 8],
+                     _mm_or_si128(_mm_and_si128(samples_hi, imag_mask),
+                                  _mm_unpackhi_epi16(windowed, zero)));
+
+    real = _mm_packs_epi32(
+        ExtendLow16(_mm_loadu_si128((const __m128i*)&time[PART_LEN2 + 2 * i])),
+        ExtendLow16(_mm_loadu_si128(
+            (const __m128i*)&time[PART_LEN2 + 2 * i + 8])));
+    MulShift14(real, _mm_loadu_si128((const __m128i*)&kSqrtHanningReversed[i]),
+               zero, &lo, &hi);
+    _mm_storeu_si128((__m128i*)&aecm->outBuf[i],
+                     _mm_packs_epi32(ShiftW32(lo, shift), ShiftW32(hi, shift)));
+  }
+
+  // Copy the current block to the old position (aecm->outBuf is shifted elsewhere)
+  memcpy(aecm->xBuf, aecm->xBuf + PART_LEN, sizeof(int16_t) * PART_LEN);
+  memcpy(aecm->dBufNoisy, aecm->dBufNoisy + PART_LEN,
+         sizeof(int16_t) * PART_LEN);
+  if (nearendClean != NULL) {
+    memcpy(aecm->dBufClean, aecm->dBufClean + PART_LEN,
+           sizeof(int16_t) * PART_LEN);
+  }
+}
+
+static void CalcLinearEnergiesSse2(AecmCore_t* aecm,
+                                   const uint16_t* far_spectrum,
+                                   int32_t* echo_est,
+                                   uint32_t* far_energy,
+                                   uint32_t* echo_energy_adapt,
+                                   uint32_t* echo_energy_stored) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i far_sum = _mm_setzero_si128();
+  __m128i adapt_sum = _mm_setzero_si128();
+  __m128i stored_sum = _mm_setzero_si128();
+  int i;
+
+  // Get energy for the delayed far end signal and estimated
+  // echo using both stored and adapted channels.
+  for (i = 0; i < PART_LEN; i += 8) {
+    const __m128i far = _mm_loadu_si128((const __m128i*)&far_spectrum[i]);
+    const __m128i stored =
+        _mm_loadu_si128((const __m128i*)&aecm->channelStored[i]);
+    const __m128i adapt =
+        _mm_loadu_si128((const __m128i*)&aecm->channelAdapt16[i]);
+    const __m128i adapt_lo = _mm_mullo_epi16(adapt, far);
+    const __m128i adapt_hi = _mm_mulhi_epu16(adapt, far);
+    __m128i echo_lo, echo_hi;
+
+    MulSignedUnsigned(stored, far, &echo_lo, &echo_hi);
+    _mm_storeu_si128((__m128i*)&echo_est[i], echo_lo);
+    _mm_storeu_si128((__m128i*)&echo_est[i + 4], echo_hi);
+    stored_sum = _mm_add_epi32(stored_sum, _mm_add_epi32(echo_lo, echo_hi));
+
+    far_sum = _mm_add_epi32(far_sum,
+                            _mm_add_epi32(_mm_unpacklo_epi16(far, zero),
+                                          _mm_unpackhi_epi16(far, zero)));
+    adapt_sum = _mm_add_epi32(adapt_sum,
+        _mm_add_epi32(_mm_unpacklo_epi16(adapt_lo, adapt_hi),
+                      _mm_unpackhi_epi16(adapt_lo, adapt_hi)));
+  }
+  echo_est[i] = WEBRTC_SPL_MUL_16_U16(aecm->channelStored[i],
+                                      far_spectrum[i]);
+
+  *far_energy += HorizontalSum(far_sum) + far_spectrum[i];
+  *echo_energy_adapt += HorizontalSum(adapt_sum) +
+      WEBRTC_SPL_UMUL_16_16(aecm->channelAdapt16[i], far_spectrum[i]);
+  *echo_energy_stored += HorizontalSum(stored_sum) + (uint32_t)echo_est[i];
+}
+
+static void StoreAdaptiveChannelSse2(AecmCore_t* aecm,
+                                     const uint16_t* far_spectrum,
+                                     int32_t* echo_est) {
+  int i;
+
+  // During startup we store the channel every block.
+  memcpy(aecm->channelStored, aecm->channelAdapt16,
+         sizeof(int16_t) * PART_LEN1);
+  // Recalculate echo estimate
+  for (i = 0; i < PART_LEN; i += 8) {
+    __m128i echo_lo, echo_hi;
+    MulSignedUnsigned(
+        _mm_loadu_si128((const __m128i*)&aecm->channelStored[i]),
+        _mm_loadu_si128((const __m128i*)&far_spectrum[i]),
+        &echo_lo, &echo_hi);
+    _mm_storeu_si128((__m128i*)&echo_est[i], echo_lo);
+    _mm_storeu_si128((__m128i*)&echo_est[i + 4], echo_hi);
+  }
+  echo_est[i] = WEBRTC_SPL_MUL_16_U16(aecm->channelStored[i],
+                                      far_spectrum[i]);
+}
+
+static void ResetAdaptiveChannelSse2(AecmCore_t* aecm) {
+  const __m128i zero = _mm_setzero_si128();
+  int i;
+
+  // The stored channel has a significantly lower MSE than the adaptive one for
+  // two consecutive calculations. Reset the adaptive channel.
+  memcpy(aecm->channelAdapt16, aecm->channelStored,
+         sizeof(int16_t) * PART_LEN1);
+  // Restore the W32 channel. Interleaving with zeros below shifts up by 16.
+  for (i = 0; i < PART_LEN; i += 8) {
+    const __m128i stored =
+        _mm_loadu_si128((const __m128i*)&aecm->channelStored[i]);
+    _mm_storeu_si128((__m128i*)&aecm->channelAdapt32[i],
+                     _mm_unpacklo_epi16(zero, stored));
+    _mm_storeu_si128((__m128i*)&aecm->channelAdapt32[i + 4],
+                     _mm_unpackhi_epi16(zero, stored));
+  }
+  aecm->channelAdapt32[i] =
+      WEBRTC_SPL_LSHIFT_W32((int32_t)aecm->channelStored[i], 16);
+}
+
+void WebRtcAecm_InitSse2(void) {
+  WebRtcAecm_WindowAndFFT = WindowAndFFTSse2;
+  WebRtcAecm_InverseFFTAndWindow = InverseFFTAndWindowSse2;
+  WebRtcAecm_CalcLinearEnergies = CalcLinearEnergiesSse2;
+  WebRtcAecm_StoreAdaptiveChannel = StoreAdaptiveChannelSse2;
+  WebRtcAecm_ResetAdaptiveChannel = ResetAdaptiveChannelSse2;
+}
@@ -0,0 +1,288 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+extern "C" {
+#include "webrtc/modules/audio_processing/aecm/aecm_core.h"
+}
+#include "webrtc/modules/audio_processing/aecm/include/echo_control_mobile.h"
+#include "webrtc/modules/audio_processing/test/cpu_features_test_helper.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+
+namespace webrtc {
+namespace {
+
+const int kSampleRates[] = { 8000, 16000 };
+const int kNumTrials = 50;
+
+// The functions WebRtcAecm_InitCore() selects.
+struct AecmFunctions {
+  WindowAndFFT window_and_fft;
+  InverseFFTAndWindow inverse_fft_and_window;
+  CalcLinearEnergies calc_linear_energies;
+  StoreAdaptiveChannel store_adaptive_channel;
+  ResetAdaptiveChannel reset_adaptive_channel;
+};
+
+// A buffer with the 32 byte alignment the AECM gives its FFT buffers.
+template <typename T, int N>
+class AlignedBuffer {
+ public:
+  T* get() {
+    return reinterpret_cast<T*>(
+        (reinterpret_cast<uintptr_t>(buffer_) + 31) & ~31);
+  }
+
+ private:
+  char buffer_[N * sizeof(T) + 32];
+};
+
+class AecmCoreTest : public ::testing::Test {
+ protected:
+  AecmCoreTest() : expected_(NULL), actual_(NULL) {}
+
+  virtual void SetUp() {
+    srand(42);
+    // Selects the FFT functions, which WebRtcAecm_Create() would do.
+    WebRtcSpl_Init();
+    ASSERT_EQ(0, WebRtcAecm_CreateCore(&expected_));
+    ASSERT_EQ(0, WebRtcAecm_CreateCore(&actual_));
+    c_ = SelectFunctions(WebRtc_GetCPUInfoNoASM);
+  }
+
+  virtual void TearDown() {
+    EXPECT_EQ(0, WebRtcAecm_FreeCore(expected_));
+    EXPECT_EQ(0, WebRtcAecm_FreeCore(actual_));
+  }
+
+  // Initializes |expected_| as if the CPU had the features reported by
+  // |cpu_info|, and returns the functions selected for it.
+  AecmFunctions SelectFunctions(WebRtc_CPUInfo cpu_info) {
+    ScopedCPUInfo scoped_cpu_info(cpu_info);
+    EXPECT_EQ(0, WebRtcAecm_InitCore(expected_, 16000));
+    AecmFunctions functions;
+    functions.window_and_fft = WebRtcAecm_WindowAndFFT;
+    functions.inverse_fft_and_window = WebRtcAecm_InverseFFTAndWindow;
+    functions.calc_linear_energies = WebRtcAecm_CalcLinearEnergies;
+    functions.store_adaptive_channel = WebRtcAecm_StoreAdaptiveChannel;
+    functions.reset_adaptive_channel = WebRtcAecm_ResetAdaptiveChannel;
+    return functions;
+  }
+
+  // Sets up |expected_| and |actual_| with the same random channel and
+  // buffer state.
+  void RandomizeCores() {
+    ASSERT_EQ(0, WebRtcAecm_InitCore(expected_, 16000));
+    ASSERT_EQ(0, WebRtcAecm_InitCore(actual_, 16000));
+    expected_->dfaCleanQDomain = static_cast<int16_t>(RandomInRange(0, 15));
+    FillRandom(expected_->channelStored, PART_LEN1);
+    FillRandom(expected_->channelAdapt16, PART_LEN1);
+    FillRandom(reinterpret_cast<int16_t*>(expected_->channelAdapt32),
+               2 * PART_LEN1);
+    FillRandom(expected_->xBuf, PART_LEN2);
+    FillRandom(expected_->dBufClean, PART_LEN2);
+    FillRandom(expected_->dBufNoisy, PART_LEN2);
+    FillRandom(expected_->outBuf, PART_LEN);
+
+    actual_->dfaCleanQDomain = expected_->dfaCleanQDomain;
+    memcpy(actual_->channelStored, expected_->channelStored,
+           sizeof(int16_t) * PART_LEN1);
+    memcpy(actual_->channelAdapt16, expected_->channelAdapt16,
+           sizeof(int16_t) * PART_LEN1);
+    memcpy(actual_->channelAdapt32, expected_->channelAdapt32,
+           sizeof(int32_t) * PART_LEN1);
+    memcpy(actual_->xBuf, expected_->xBuf, sizeof(int16_t) * PART_LEN2);
+    memcpy(actual_->dBufClean, expected_->dBufClean,
+           sizeof(int16_t) * PART_LEN2);
+    memcpy(actual_->dBufNoisy, expected_->dBufNoisy,
+           sizeof(int16_t) * PART_LEN2);
+    memcpy(actual_->outBuf, expected_->outBuf, sizeof(int16_t) * PART_LEN);
+  }
+
+  // Returns true if the parts of the cores the functions write are equal.
+  bool CoresEqual() const {
+    return memcmp(expected_->channelStored, actual_->channelStored,
+                  sizeof(int16_t) * PART_LEN1) == 0 &&
+        memcmp(expected_->channelAdapt16, actual_->channelAdapt16,
+               sizeof(int16_t) * PART_LEN1) == 0 &&
+        memcmp(expected_->channelAdapt32, actual_->channelAdapt32,
+               sizeof(int32_t) * PART_LEN1) == 0 &&
+        memcmp(expected_->xBuf, actual_->xBuf,
+               sizeof(int16_t) * PART_LEN2) == 0 &&
+        memcmp(expected_->dBufClean, actual_->dBufClean,
+               sizeof(int16_t) * PART_LEN2) == 0 &&
+        memcmp(expected_->dBufNoisy, actual_->dBufNoisy,
+               sizeof(int16_t) * PART_LEN2) == 0 &&
+        memcmp(expected_->outBuf, actual_->outBuf,
+               sizeof(int16_t) * PART_LEN) == 0;
+  }
+
+  // Runs each function of |optimized| and of the C versions on the same
+  // random input, and expects identical results.
+  void VerifyBitExact(const AecmFunctions& optimized) {
+    for (int trial = 0; trial < kNumTrials; ++trial) {
+      SCOPED_TRACE(testing::Message() << "trial " << trial);
+      RandomizeCores();
+
+      // The FFT buffers are PART_LEN4 long, with some slack for the loops.
+      AlignedBuffer<int16_t, PART_LEN4 + 2> expected_fft;
+      AlignedBuffer<int16_t, PART_LEN4 + 2> actual_fft;
+      AlignedBuffer<complex16_t, PART_LEN2> expected_freq;
+      AlignedBuffer<complex16_t, PART_LEN2> actual_freq;
+      int16_t time_signal[PART_LEN2];
+      FillRandom(time_signal, PART_LEN2);
+      memset(expected_fft.get(), 0, sizeof(int16_t) * (PART_LEN4 + 2));
+      memset(actual_fft.get(), 0, sizeof(int16_t) * (PART_LEN4 + 2));
+      const int scaling = RandomInRange(0, 6);
+      c_.window_and_fft(expected_, expected_fft.get(), time_signal,
+                        expected_freq.get(), scaling);
+      optimized.window_and_fft(actual_, actual_fft.get(), time_signal,
+                               actual_freq.get(), scaling);
+      EXPECT_EQ(0, memcmp(expected_freq.get(), actual_freq.get(),
+                          sizeof(complex16_t) * PART_LEN2));
+
+      int16_t expected_output[PART_LEN];
+      int16_t actual_output[PART_LEN];
+      FillRandom(reinterpret_cast<int16_t*>(expected_freq.get()), PART_LEN4);
+      memcpy(actual_freq.get(), expected_freq.get(),
+             sizeof(complex16_t) * PART_LEN2);
+      const int16_t* nearend_clean = trial % 2 == 0 ? time_signal : NULL;
+      c_.inverse_fft_and_window(expected_, expected_fft.get(),
+                                expected_freq.get(), expected_output,
+                                nearend_clean);
+      optimized.inverse_fft_and_window(actual_, actual_fft.get(),
+                                       actual_freq.get(), actual_output,
+                                       nearend_clean);
+      EXPECT_TRUE(CoresEqual());
+      EXPECT_EQ(0, memcmp(expected_freq.get(), actual_freq.get(),
+                          sizeof(complex16_t) * PART_LEN2));
+      EXPECT_EQ(0, memcmp(expected_output, actual_output,
+                          sizeof(expected_output)));
+
+      uint16_t far_spectrum[PART_LEN1];
+      int32_t expected_echo[PART_LEN1];
+      int32_t actual_echo[PART_LEN1];
+      uint32_t expected_energies[3];
+      uint32_t actual_energies[3];
+      FillRandom(reinterpret_cast<int16_t*>(far_spectrum), PART_LEN1);
+      FillRandom(reinterpret_cast<int16_t*>(expected_energies), 6);
+      memcpy(actual_energies, expected_energies, sizeof(actual_energies));
+      c_.calc_linear_energies(expected_, far_spectrum, expected_echo,
+                              &expected_energies[0], &expected_energies[1],
+                              &expected_energies[2]);
+      optimized.calc_linear_energies(actual_, far_spectrum, actual_echo,
+                                     &actual_energies[0], &actual_energies[1],
+                                     &actual_energies[2]);
+      EXPECT_EQ(0, memcmp(expected_echo, actual_echo, sizeof(actual_echo)));
+      EXPECT_EQ(0, memcmp(expected_energies, actual_energies,
+                          sizeof(actual_energies)));
+
+      c_.store_adaptive_channel(expected_, far_spectrum, expected_echo);
+      optimized.store_adaptive_channel(actual_, far_spectrum, actual_echo);
+      EXPECT_TRUE(CoresEqual());
+      EXPECT_EQ(0, memcmp(expected_echo, actual_echo, sizeof(actual_echo)));
+
+      FillRandom(expected_->channelStored, PART_LEN1);
+      memcpy(actual_->channelStored, expected_->channelStored,
+             sizeof(int16_t) * PART_LEN1);
+      c_.reset_adaptive_channel(expected_);
+      optimized.reset_adaptive_channel(actual_);
+      EXPECT_TRUE(CoresEqual());
+    }
+  }
+
+  // Runs echo control on a noisy far end signal and its echo, with the
+  // functions selected for |cpu_info|, and returns the output.
+  std::vector<int16_t> Cancel(WebRtc_CPUInfo cpu_info,
+                              int sample_rate_hz,
+                              bool use_clean_nearend) {
+    const int kNumFrames = 500;
+    const int kEchoDelay = 40;
+    const int samples_per_frame = sample_rate_hz / 100;
+    void* handle = NULL;
+    EXPECT_EQ(0, WebRtcAecm_Create(&handle));
+    {
+      ScopedCPUInfo scoped_cpu_info(cpu_info);
+      EXPECT_EQ(0, WebRtcAecm_Init(handle, sample_rate_hz));
+    }
+    srand(17);
+    std::vector<int16_t> far(kEchoDelay, 0);
+    std::vector<int16_t> output;
+    for (int n = 0; n < kNumFrames; ++n) {
+      int16_t near[160];
+      int16_t out[160];
+      const int offset = static_cast<int>(far.size()) - kEchoDelay;
+      for (int i = 0; i < samples_per_frame; ++i) {
+        // Speech-like bursts of noise on the far end every other second.
+        far.push_back(static_cast<int16_t>(
+            (n / 100) % 2 == 0 ? RandomInRange(-8000, 8000) : 0));
+      }
+      for (int i = 0; i < samples_per_frame; ++i) {
+        near[i] = static_cast<int16_t>(far[offset + i] / 2 +
+                                       RandomInRange(-300, 300));
+      }
+      EXPECT_EQ(0, WebRtcAecm_BufferFarend(
+          handle, &far[far.size() - samples_per_frame], samples_per_frame));
+      EXPECT_EQ(0, WebRtcAecm_Process(handle, near,
+                                      use_clean_nearend ? near : NULL, out,
+                                      samples_per_frame, 0));
+      output.insert(output.end(), out, out + samples_per_frame);
+    }
+    EXPECT_EQ(0, WebRtcAecm_Free(handle));
+    return output;
+  }
+
+  void VerifyProcessingBitExact(WebRtc_CPUInfo cpu_info) {
+    for (size_t r = 0; r < sizeof(kSampleRates) / sizeof(*kSampleRates);
+         ++r) {
+      for (int clean = 0; clean < 2; ++clean) {
+        SCOPED_TRACE(testing::Message() << "sample rate " << kSampleRates[r]
+                                        << ", clean nearend " << clean);
+        EXPECT_TRUE(Cancel(WebRtc_GetCPUInfoNoASM, kSampleRates[r],
+                           clean != 0) ==
+                    Cancel(cpu_info, kSampleRates[r], clean != 0));
+      }
+    }
+  }
+
+  AecmCore_t* expected_;
+  AecmCore_t* actual_;
+  AecmFunctions c_;
+};
+
+TEST_F(AecmCoreTest, Sse2FunctionsAreBitExact) {
+  if (!WebRtc_GetCPUInfo(kSSE2)) {
+    printf("Skipping test, the CPU does not support SSE2.\n");
+    return;
+  }
+  const AecmFunctions sse2 = SelectFunctions(GetCPUInfoSse2Only);
+  EXPECT_NE(c_.window_and_fft, sse2.window_and_fft);
+  VerifyBitExact(sse2);
+  VerifyProcessingBitExact(GetCPUInfoSse2Only);
+}
+
+TEST_F(AecmCoreTest, Avx2FunctionsAreBitExact) {
+  if (!WebRtc_GetCPUInfo(kAVX2)) {
+    printf("Skipping test, the CPU does not support AVX2.\n");
+    return;
+  }
+  const AecmFunctions avx2 = SelectFunctions(WebRtc_GetCPUInfo);
+  VerifyBitExact(avx2);
+  VerifyProcessingBitExact(WebRtc_GetCPUInfo);
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -10,7 +10,9 @@
 
 #include "webrtc/modules/audio_processing/audio_buffer.h"
 
+#include "webrtc/common_audio/include/audio_util.h"
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+#include "webrtc/modules/audio_processing/splitting_filter.h"
 
 namespace webrtc {
 namespace {
@@ -31,6 +33,14 @@ void StereoToMono(const int16_t* left, const int16_t* right,
     out[i] = WebRtcSpl_SatW32ToW16(data32);
   }
 }
+
+void StereoToMono(const float* left, const float* right, float* out,
+                  int samples_per_channel) {
+  assert(left != NULL && right != NULL && out != NULL);
+  for (int i = 0; i < samples_per_channel; i++) {
+    out[i] = (left[i] + right[i]) / 2;
+  }
+}
 }  // namespace
 
 struct AudioChannel {
@@ -41,23 +51,43 @@ struct AudioChannel {
   int16_t data[kSamplesPer32kHzChannel];
 };
 
+struct FloatAudioChannel {
+  FloatAudioChannel() {
+    memset(data, 0, sizeof(data));
+  }
+
+  float data[kSamplesPer32kHzChannel];
+};
+
 struct SplitAudioChannel {
   SplitAudioChannel() {
     memset(low_pass_data, 0, sizeof(low_pass_data));
     memset(high_pass_data, 0, sizeof(high_pass_data));
+    memset(low_pass_data_f, 0, sizeof(low_pass_data_f));
+    memset(high_pass_data_f, 0, sizeof(high_pass_data_f));
     memset(analysis_filter_state1, 0, sizeof(analysis_filter_state1));
     memset(analysis_filter_state2, 0, sizeof(analysis_filter_state2));
     memset(synthesis_filter_state1, 0, sizeof(synthesis_filter_state1));
     memset(synthesis_filter_state2, 0, sizeof(synthesis_filter_state2));
+    memset(analysis_filter_state1_f, 0, sizeof(analysis_filter_state1_f));
+    memset(analysis_filter_state2_f, 0, sizeof(analysis_filter_state2_f));
+    memset(synthesis_filter_state1_f, 0, sizeof(synthesis_filter_state1_f));
+    memset(synthesis_filter_state2_f, 0, sizeof(synthesis_filter_state2_f));
   }
 
   int16_t low_pass_data[kSamplesPer16kHzChannel];
   int16_t high_pass_data[kSamplesPer16kHzChannel];
+  float low_pass_data_f[kSamplesPer16kHzChannel];
+  float high_pass_data_f[kSamplesPer16kHzChannel];
 
   int32_t analysis_filter_state1[6];
   int32_t analysis_filter_state2[6];
   int32_t synthesis_filter_state1[6];
   int32_t synthesis_filter_state2[6];
+  float analysis_filter_state1_f[kSplittingFilterStateLength];
+  float analysis_filter_state2_f[kSplittingFilterStateLength];
+  float synthesis_filter_state1_f[kSplittingFilterStateLength];
+  float synthesis_filter_state2_f[kSplittingFilterStateLength];
 };
 
 // TODO(andrew): check range of input parameters?
@@ -73,15 +103,25 @@ AudioBuffer::AudioBuffer(int max_num_channels,
     reference_copied_(false),
     activity_(AudioFrame::kVadUnknown),
     is_muted_(false),
+    is_float_(false),
+    int16_valid_(true),
+    float_valid_(false),
+    split_int16_valid_(true),
+    split_float_valid_(false),
     data_(NULL),
     channels_(NULL),
+    float_channels_(NULL),
     split_channels_(NULL),
     mixed_channels_(NULL),
+    float_mixed_channels_(NULL),
     mixed_low_pass_channels_(NULL),
     low_pass_reference_channels_(NULL) {
+  // Mono frames are processed in place, but float data needs a buffer.
+  channels_.reset(new AudioChannel[max_num_channels_]);
+  float_channels_.reset(new FloatAudioChannel[max_num_channels_]);
   if (max_num_channels_ > 1) {
-    channels_.reset(new AudioChannel[max_num_channels_]);
     mixed_channels_.reset(new AudioChannel[max_num_channels_]);
+    float_mixed_channels_.reset(new FloatAudioChannel[max_num_channels_]);
     mixed_low_pass_channels_.reset(new AudioChannel[max_num_channels_]);
   }
   low_pass_reference_channels_.reset(new AudioChannel[max_num_channels_]);
@@ -94,8 +134,10 @@ AudioBuffer::AudioBuffer(int max_num_channels,
 
 AudioBuffer::~AudioBuffer() {}
 
-int16_t* AudioBuffer::data(int channel) const {
+int16_t* AudioBuffer::data(int channel) {
   assert(channel >= 0 && channel < num_channels_);
+  RefreshInt16();
+  WroteInt16();
   if (data_ != NULL) {
     return data_;
   }
@@ -103,21 +145,55 @@ int16_t* AudioBuffer::data(int channel) const {
   return channels_[channel].data;
 }
 
-int16_t* AudioBuffer::low_pass_split_data(int channel) const {
+const int16_t* AudioBuffer::data(int channel) const {
+  assert(channel >= 0 && channel < num_channels_);
+  RefreshInt16();
+  if (data_ != NULL) {
+    return data_;
+  }
+
+  return channels_[channel].data;
+}
+
+int16_t* AudioBuffer::low_pass_split_data(int channel) {
   assert(channel >= 0 && channel < num_channels_);
   if (split_channels_.get() == NULL) {
     return data(channel);
   }
 
+  RefreshSplitInt16();
+  WroteSplitInt16();
   return split_channels_[channel].low_pass_data;
 }
 
-int16_t* AudioBuffer::high_pass_split_data(int channel) const {
+const int16_t* AudioBuffer::low_pass_split_data(int channel) const {
+  assert(channel >= 0 && channel < num_channels_);
+  if (split_channels_.get() == NULL) {
+    return data(channel);
+  }
+
+  RefreshSplitInt16();
+  return split_channels_[channel].low_pass_data;
+}
+
+int16_t* AudioBuffer::high_pass_split_data(int channel) {
+  assert(channel >= 0 && channel < num_channels_);
+  if (split_channels_.get() == NULL) {
+    return NULL;
+  }
+
+  RefreshSplitInt16();
+  WroteSplitInt16();
+  return split_channels_[channel].high_pass_data;
+}
+
+const int16_t* AudioBuffer::high_pass_split_data(int channel) const {
   assert(channel >= 0 && channel < num_channels_);
   if (split_channels_.get() == NULL) {
     return NULL;
   }
 
+  RefreshSplitInt16();
   return split_channels_[channel].high_pass_data;
 }
 
@@ -142,6 +218,67 @@ int16_t* AudioBuffer::low_pass_reference(int channel) const {
   return low_pass_reference_channels_[channel].data;
 }
 
+float* AudioBuffer::data_f(int channel) {
+  assert(channel >= 0 && channel < num_channels_);
+  RefreshFloat();
+  WroteFloat();
+  return float_channels_[channel].data;
+}
+
+const float* AudioBuffer::data_f(int channel) const {
+  assert(channel >= 0 && channel < num_channels_);
+  RefreshFloat();
+  return float_channels_[channel].data;
+}
+
+float* AudioBuffer::low_pass_split_data_f(int channel) {
+  assert(channel >= 0 && channel < num_channels_);
+  if (split_channels_.get() == NULL) {
+    return data_f(channel);
+  }
+
+  RefreshSplitFloat();
+  WroteSplitFloat();
+  return split_channels_[channel].low_pass_data_f;
+}
+
+const float* AudioBuffer::low_pass_split_data_f(int channel) const {
+  assert(channel >= 0 && channel < num_channels_);
+  if (split_channels_.get() == NULL) {
+    return data_f(channel);
+  }
+
+  RefreshSplitFloat();
+  return split_channels_[channel].low_pass_data_f;
+}
+
+float* AudioBuffer::high_pass_split_data_f(int channel) {
+  assert(channel >= 0 && channel < num_channels_);
+  if (split_channels_.get() == NULL) {
+    return NULL;
+  }
+
+  RefreshSplitFloat();
+  WroteSplitFloat();
+  return split_channels_[channel].high_pass_data_f;
+}
+
+const float* AudioBuffer::high_pass_split_data_f(int channel) const {
+  assert(channel >= 0 && channel < num_channels_);
+  if (split_channels_.get() == NULL) {
+    return NULL;
+  }
+
+  RefreshSplitFloat();
+  return split_channels_[channel].high_pass_data_f;
+}
+
+const float* AudioBuffer::mixed_data_f(int channel) const {
+  assert(channel >= 0 && channel < num_mixed_channels_);
+
+  return float_mixed_channels_[channel].data;
+}
+
 int32_t* AudioBuffer::analysis_filter_state1(int channel) const {
   assert(channel >= 0 && channel < num_channels_);
   return split_channels_[channel].analysis_filter_state1;
@@ -162,6 +299,26 @@ int32_t* AudioBuffer::synthesis_filter_state2(int channel) const {
   return split_channels_[channel].synthesis_filter_state2;
 }
 
+float* AudioBuffer::analysis_filter_state1_f(int channel) const {
+  assert(channel >= 0 && channel < num_channels_);
+  return split_channels_[channel].analysis_filter_state1_f;
+}
+
+float* AudioBuffer::analysis_filter_state2_f(int channel) const {
+  assert(channel >= 0 && channel < num_channels_);
+  return split_channels_[channel].analysis_filter_state2_f;
+}
+
+float* AudioBuffer::synthesis_filter_state1_f(int channel) const {
+  assert(channel >= 0 && channel < num_channels_);
+  return split_channels_[channel].synthesis_filter_state1_f;
+}
+
+float* AudioBuffer::synthesis_filter_state2_f(int channel) const {
+  assert(channel >= 0 && channel < num_channels_);
+  return split_channels_[channel].synthesis_filter_state2_f;
+}
+
 void AudioBuffer::set_activity(AudioFrame::VADActivity activity) {
   activity_ = activity;
 }
@@ -174,6 +331,10 @@ bool AudioBuffer::is_muted() const {
   return is_muted_;
 }
 
+bool AudioBuffer::is_float() const {
+  return is_float_;
+}
+
 int AudioBuffer::num_channels() const {
   return num_channels_;
 }
@@ -186,18 +347,111 @@ int AudioBuffer::samples_per_split_channel() const {
   return samples_per_split_channel_;
 }
 
+void AudioBuffer::InitForNewData(int num_channels, bool is_float) {
+  num_channels_ = num_channels;
+  data_ = NULL;
+  data_was_mixed_ = false;
+  num_mixed_channels_ = 0;
+  num_mixed_low_pass_channels_ = 0;
+  reference_copied_ = false;
+  activity_ = AudioFrame::kVadUnknown;
+  is_muted_ = false;
+  is_float_ = is_float;
+  int16_valid_ = !is_float;
+  float_valid_ = is_float;
+  split_int16_valid_ = !is_float;
+  split_float_valid_ = is_float;
+}
+
+void AudioBuffer::RefreshInt16() const {
+  if (int16_valid_) {
+    return;
+  }
+
+  assert(float_valid_);
+  for (int i = 0; i < num_channels_; i++) {
+    int16_t* channel = data_ != NULL ? data_ : channels_[i].data;
+    RoundFloatS16ToInt16(float_channels_[i].data, samples_per_channel_,
+                         channel);
+  }
+  int16_valid_ = true;
+}
+
+void AudioBuffer::RefreshFloat() const {
+  if (float_valid_) {
+    return;
+  }
+
+  assert(int16_valid_);
+  for (int i = 0; i < num_channels_; i++) {
+    const int16_t* channel = data_ != NULL ? data_ : channels_[i].data;
+    float* channel_f = float_channels_[i].data;
+    for (int j = 0; j < samples_per_channel_; j++) {
+      channel_f[j] = channel[j];
+    }
+  }
+  float_valid_ = true;
+}
+
+void AudioBuffer::RefreshSplitInt16() const {
+  if (split_int16_valid_) {
+    return;
+  }
+
+  assert(split_float_valid_);
+  for (int i = 0; i < num_channels_; i++) {
+    SplitAudioChannel& channel = split_channels_[i];
+    RoundFloatS16ToInt16(channel.low_pass_data_f, samples_per_split_channel_,
+                         channel.low_pass_data);
+    RoundFloatS16ToInt16(channel.high_pass_data_f, samples_per_split_channel_,
+                         channel.high_pass_data);
+  }
+  split_int16_valid_ = true;
+}
+
+void AudioBuffer::RefreshSplitFloat() const {
+  if (split_float_valid_) {
+    return;
+  }
+
+  assert(split_int16_valid_);
+  for (int i = 0; i < num_channels_; i++) {
+    SplitAudioChannel& channel = split_channels_[i];
+    for (int j = 0; j < samples_per_split_channel_; j++) {
+      channel.low_pass_data_f[j] = channel.low_pass_data[j];
+      channel.high_pass_data_f[j] = channel.high_pass_data[j];
+    }
+  }
+  split_float_valid_ = true;
+}
+
+void AudioBuffer::WroteInt16() {
+  int16_valid_ = true;
+  float_valid_ = false;
+}
+
+void AudioBuffer::WroteFloat() {
+  float_valid_ = true;
+  int16_valid_ = false;
+}
+
+void AudioBuffer::WroteSplitInt16() {
+  split_int16_valid_ = true;
+  split_float_valid_ = false;
+}
+
+void AudioBuffer::WroteSplitFloat() {
+  split_float_valid_ = true;
+  split_int16_valid_ = false;
+}
+
 // TODO(andrew): Do deinterleaving and mixing in one step?
 void AudioBuffer::DeinterleaveFrom(AudioFrame* frame) {
   assert(frame->num_channels_ <= max_num_channels_);
   assert(frame->samples_per_channel_ ==  samples_per_channel_);
 
-  num_channels_ = frame->num_channels_;
-  data_was_mixed_ = false;
-  num_mixed_channels_ = 0;
-  num_mixed_low_pass_channels_ = 0;
-  reference_copied_ = false;
+  InitForNewData(frame->num_channels_, false);
   activity_ = frame->vad_activity_;
-  is_muted_ = false;
   if (frame->energy_ == 0) {
     is_muted_ = true;
   }
@@ -228,6 +482,7 @@ void AudioBuffer::InterleaveTo(AudioFrame* frame, bool data_changed) const {
     return;
   }
 
+  RefreshInt16();
   if (num_channels_ == 1) {
     if (data_was_mixed_) {
       memcpy(frame->data_,
@@ -252,6 +507,29 @@ void AudioBuffer::InterleaveTo(AudioFrame* frame, bool data_changed) const {
   }
 }
 
+void AudioBuffer::CopyFrom(const float* const* src, int samples_per_channel,
+                           int num_channels) {
+  assert(num_channels <= max_num_channels_);
+  assert(samples_per_channel == samples_per_channel_);
+
+  InitForNewData(num_channels, true);
+  for (int i = 0; i < num_channels_; ++i) {
+    ScaleToFloatS16(src[i], samples_per_channel_, float_channels_[i].data);
+  }
+}
+
+void AudioBuffer::CopyTo(int samples_per_channel, int num_channels,
+                         float* const* dest) const {
+  assert(num_channels == num_channels_);
+  assert(samples_per_channel == samples_per_channel_);
+
+  RefreshFloat();
+  for (int i = 0; i < num_channels_; ++i) {
+    ScaleFloatS16ToFloat(float_channels_[i].data, samples_per_channel_,
+                         dest[i]);
+  }
+}
+
 // TODO(andrew): would be good to support the no-mix case with pointer
 // assignment.
 // TODO(andrew): handle mixing to multiple channels?
@@ -260,10 +538,21 @@ void AudioBuffer::Mix(int num_mixed_channels) {
   assert(num_channels_ == 2);
   assert(num_mixed_channels == 1);
 
-  StereoToMono(channels_[0].data,
-               channels_[1].data,
-               channels_[0].data,
-               samples_per_channel_);
+  if (is_float_) {
+    RefreshFloat();
+    StereoToMono(float_channels_[0].data,
+                 float_channels_[1].data,
+                 float_channels_[0].data,
+                 samples_per_channel_);
+    WroteFloat();
+  } else {
+    RefreshInt16();
+    StereoToMono(channels_[0].data,
+                 channels_[1].data,
+                 channels_[0].data,
+                 samples_per_channel_);
+    WroteInt16();
+  }
 
   num_channels_ = num_mixed_channels;
   data_was_mixed_ = true;
@@ -274,10 +563,19 @@ void AudioBuffer::CopyAndMix(int num_mixed_channels) {
   assert(num_channels_ == 2);
   assert(num_mixed_channels == 1);
 
-  StereoToMono(channels_[0].data,
-               channels_[1].data,
-               mixed_channels_[0].data,
-               samples_per_channel_);
+  if (is_float_) {
+    RefreshFloat();
+    StereoToMono(float_channels_[0].data,
+                 float_channels_[1].data,
+                 float_mixed_channels_[0].data,
+                 samples_per_channel_);
+  } else {
+    RefreshInt16();
+    StereoToMono(channels_[0].data,
+                 channels_[1].data,
+                 mixed_channels_[0].data,
+                 samples_per_channel_);
+  }
 
   num_mixed_channels_ = num_mixed_channels;
 }
@@ -287,8 +585,9 @@ void AudioBuffer::CopyAndMixLowPass(int num_mixed_channels) {
   assert(num_channels_ == 2);
   assert(num_mixed_channels == 1);
 
-  StereoToMono(low_pass_split_data(0),
-               low_pass_split_data(1),
+  const AudioBuffer* const_this = this;
+  StereoToMono(const_this->low_pass_split_data(0),
+               const_this->low_pass_split_data(1),
                mixed_low_pass_channels_[0].data,
                samples_per_split_channel_);
 
@@ -297,9 +596,10 @@ void AudioBuffer::CopyAndMixLowPass(int num_mixed_channels) {
 
 void AudioBuffer::CopyLowPassToReference() {
   reference_copied_ = true;
+  const AudioBuffer* const_this = this;
   for (int i = 0; i < num_channels_; i++) {
     memcpy(low_pass_reference_channels_[i].data,
-           low_pass_split_data(i),
+           const_this->low_pass_split_data(i),
            sizeof(int16_t) * samples_per_split_channel_);
   }
 }
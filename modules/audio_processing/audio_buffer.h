@@ -18,8 +18,15 @@
 namespace webrtc {
 
 struct AudioChannel;
+struct FloatAudioChannel;
 struct SplitAudioChannel;
 
+// Holds the capture or render audio of one 10 ms frame, as int16 or as float
+// in the int16 range. Frames copied in as float stay float through the float
+// components, and are only converted to int16 for the components that need
+// it. Each accessor converts the data on first use after the other
+// representation was written. The non-const accessors invalidate the other
+// representation, so the const ones should be used when only reading.
 class AudioBuffer {
  public:
   AudioBuffer(int max_num_channels, int samples_per_channel);
@@ -29,17 +36,37 @@ class AudioBuffer {
   int samples_per_channel() const;
   int samples_per_split_channel() const;
 
-  int16_t* data(int channel) const;
-  int16_t* low_pass_split_data(int channel) const;
-  int16_t* high_pass_split_data(int channel) const;
+  // Whether the frame was copied in as float. Components with a float
+  // implementation then use the float data, and the int16 data otherwise, so
+  // that the int16 path is unchanged.
+  bool is_float() const;
+
+  int16_t* data(int channel);
+  const int16_t* data(int channel) const;
+  int16_t* low_pass_split_data(int channel);
+  const int16_t* low_pass_split_data(int channel) const;
+  int16_t* high_pass_split_data(int channel);
+  const int16_t* high_pass_split_data(int channel) const;
   int16_t* mixed_data(int channel) const;
   int16_t* mixed_low_pass_data(int channel) const;
   int16_t* low_pass_reference(int channel) const;
 
+  float* data_f(int channel);
+  const float* data_f(int channel) const;
+  float* low_pass_split_data_f(int channel);
+  const float* low_pass_split_data_f(int channel) const;
+  float* high_pass_split_data_f(int channel);
+  const float* high_pass_split_data_f(int channel) const;
+  const float* mixed_data_f(int channel) const;
+
   int32_t* analysis_filter_state1(int channel) const;
   int32_t* analysis_filter_state2(int channel) const;
   int32_t* synthesis_filter_state1(int channel) const;
   int32_t* synthesis_filter_state2(int channel) const;
+  float* analysis_filter_state1_f(int channel) const;
+  float* analysis_filter_state2_f(int channel) const;
+  float* synthesis_filter_state1_f(int channel) const;
+  float* synthesis_filter_state2_f(int channel) const;
 
   void set_activity(AudioFrame::VADActivity activity);
   AudioFrame::VADActivity activity() const;
@@ -51,12 +78,33 @@ class AudioBuffer {
   // If |data_changed| is false, only the non-audio data members will be copied
   // to |frame|.
   void InterleaveTo(AudioFrame* frame, bool data_changed) const;
+  // Use for float deinterleaved data in the [-1, 1] range. The samples are
+  // scaled to the int16 range on the way in and back on the way out.
+  void CopyFrom(const float* const* src, int samples_per_channel,
+                int num_channels);
+  void CopyTo(int samples_per_channel, int num_channels,
+              float* const* dest) const;
   void Mix(int num_mixed_channels);
+  // Mixes to mixed_data(), or to mixed_data_f() for float frames.
   void CopyAndMix(int num_mixed_channels);
   void CopyAndMixLowPass(int num_mixed_channels);
   void CopyLowPassToReference();
 
  private:
+  // Prepares for new data, discarding the state of the previous frame.
+  void InitForNewData(int num_channels, bool is_float);
+  // Bring the int16 or the float version of the full band or split band data
+  // up to date.
+  void RefreshInt16() const;
+  void RefreshFloat() const;
+  void RefreshSplitInt16() const;
+  void RefreshSplitFloat() const;
+  // Mark the data as written through an int16 or a float accessor.
+  void WroteInt16();
+  void WroteFloat();
+  void WroteSplitInt16();
+  void WroteSplitFloat();
+
   const int max_num_channels_;
   int num_channels_;
   int num_mixed_channels_;
@@ -68,11 +116,21 @@ class AudioBuffer {
   bool reference_copied_;
   AudioFrame::VADActivity activity_;
   bool is_muted_;
+  bool is_float_;
+
+  // Which representations of the full band and the split band data are up to
+  // date. The split band data is the full band data below 32 kHz.
+  mutable bool int16_valid_;
+  mutable bool float_valid_;
+  mutable bool split_int16_valid_;
+  mutable bool split_float_valid_;
 
   int16_t* data_;
   scoped_array<AudioChannel> channels_;
+  scoped_array<FloatAudioChannel> float_channels_;
   scoped_array<SplitAudioChannel> split_channels_;
   scoped_array<AudioChannel> mixed_channels_;
+  scoped_array<FloatAudioChannel> float_mixed_channels_;
   // TODO(andrew): improve this, we don't need the full 32 kHz space here.
   scoped_array<AudioChannel> mixed_low_pass_channels_;
   scoped_array<AudioChannel> low_pass_reference_channels_;
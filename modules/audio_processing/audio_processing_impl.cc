@@ -11,6 +11,7 @@
 #include "webrtc/modules/audio_processing/audio_processing_impl.h"
 
 #include <assert.h>
+#include <string.h>
 
 #include "webrtc/modules/audio_processing/audio_buffer.h"
 #include "webrtc/modules/audio_processing/echo_cancellation_impl.h"
@@ -20,6 +21,7 @@
 #include "webrtc/modules/audio_processing/level_estimator_impl.h"
 #include "webrtc/modules/audio_processing/noise_suppression_impl.h"
 #include "webrtc/modules/audio_processing/processing_component.h"
+#include "webrtc/modules/audio_processing/render_queue.h"
 #include "webrtc/modules/audio_processing/splitting_filter.h"
 #include "webrtc/modules/audio_processing/voice_detection_impl.h"
 #include "webrtc/modules/interface/module_common_types.h"
@@ -37,6 +39,13 @@
 #endif  // WEBRTC_AUDIOPROC_DEBUG_DUMP
 
 namespace webrtc {
+namespace {
+
+// One second of far-end audio.
+const int kMaxQueuedRenderFrames = 100;
+
+}  // namespace
+
 AudioProcessing* AudioProcessing::Create(int id) {
   AudioProcessingImpl* apm = new AudioProcessingImpl(id);
   if (apm->Initialize() != kNoError) {
@@ -60,12 +69,16 @@ AudioProcessingImpl::AudioProcessingImpl(int id)
       level_estimator_(NULL),
       noise_suppression_(NULL),
       voice_detection_(NULL),
-      crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      crit_render_(CriticalSectionWrapper::CreateCriticalSection()),
+      crit_capture_(CriticalSectionWrapper::CreateCriticalSection()),
       render_audio_(NULL),
       capture_audio_(NULL),
+      render_queue_(new RenderQueue(kMaxQueuedRenderFrames)),
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
+      crit_debug_(CriticalSectionWrapper::CreateCriticalSection()),
       debug_file_(FileWrapper::Create()),
       event_msg_(new audioproc::Event()),
+      render_event_msg_(new audioproc::Event()),
 #endif
       sample_rate_hz_(kSampleRate16kHz),
       split_sample_rate_hz_(kSampleRate16kHz),
@@ -100,7 +113,8 @@ AudioProcessingImpl::AudioProcessingImpl(int id)
 
 AudioProcessingImpl::~AudioProcessingImpl() {
   {
-    CriticalSectionScoped crit_scoped(crit_);
+    CriticalSectionScoped crit_render_scoped(crit_render_);
+    CriticalSectionScoped crit_capture_scoped(crit_capture_);
     while (!component_list_.empty()) {
       ProcessingComponent* component = component_list_.front();
       component->Destroy();
@@ -125,12 +139,18 @@ AudioProcessingImpl::~AudioProcessingImpl() {
     }
   }
 
-  delete crit_;
-  crit_ = NULL;
+  delete crit_capture_;
+  crit_capture_ = NULL;
+  delete crit_render_;
+  crit_render_ = NULL;
+#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
+  delete crit_debug_;
+  crit_debug_ = NULL;
+#endif
 }
 
 CriticalSectionWrapper* AudioProcessingImpl::crit() const {
-  return crit_;
+  return crit_capture_;
 }
 
 int AudioProcessingImpl::split_sample_rate_hz() const {
@@ -138,7 +158,8 @@ int AudioProcessingImpl::split_sample_rate_hz() const {
 }
 
 int AudioProcessingImpl::Initialize() {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_render_scoped(crit_render_);
+  CriticalSectionScoped crit_capture_scoped(crit_capture_);
   return InitializeLocked();
 }
 
@@ -157,6 +178,8 @@ int AudioProcessingImpl::InitializeLocked() {
                                   samples_per_channel_);
   capture_audio_ = new AudioBuffer(num_input_channels_,
                                    samples_per_channel_);
+  // Queued frames have the old format.
+  render_queue_->Clear();
 
   was_stream_delay_set_ = false;
 
@@ -182,7 +205,8 @@ int AudioProcessingImpl::InitializeLocked() {
 }
 
 int AudioProcessingImpl::set_sample_rate_hz(int rate) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_render_scoped(crit_render_);
+  CriticalSectionScoped crit_capture_scoped(crit_capture_);
   if (rate == sample_rate_hz_) {
     return kNoError;
   }
@@ -209,12 +233,13 @@ int AudioProcessingImpl::set_sample_rate_hz(int rate) {
 }
 
 int AudioProcessingImpl::sample_rate_hz() const {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   return sample_rate_hz_;
 }
 
 int AudioProcessingImpl::set_num_reverse_channels(int channels) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_render_scoped(crit_render_);
+  CriticalSectionScoped crit_capture_scoped(crit_capture_);
   if (channels == num_reverse_channels_) {
     return kNoError;
   }
@@ -235,7 +260,8 @@ int AudioProcessingImpl::num_reverse_channels() const {
 int AudioProcessingImpl::set_num_channels(
     int input_channels,
     int output_channels) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_render_scoped(crit_render_);
+  CriticalSectionScoped crit_capture_scoped(crit_capture_);
   if (input_channels == num_input_channels_ &&
       output_channels == num_output_channels_) {
     return kNoError;
@@ -264,7 +290,7 @@ int AudioProcessingImpl::num_output_channels() const {
 }
 
 int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   int err = kNoError;
 
   if (frame == NULL) {
@@ -298,23 +324,110 @@ int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
 #endif
 
   capture_audio_->DeinterleaveFrom(frame);
+  if (num_output_channels_ < num_input_channels_) {
+    frame->num_channels_ = num_output_channels_;
+  }
+
+  err = ProcessStreamLocked();
+  if (err != kNoError) {
+    return err;
+  }
+
+  capture_audio_->InterleaveTo(frame, interleave_needed(is_data_processed()));
+
+#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
+  if (debug_file_->Open()) {
+    audioproc::Stream* msg = event_msg_->mutable_stream();
+    const size_t data_size = sizeof(int16_t) *
+                             frame->samples_per_channel_ *
+                             frame->num_channels_;
+    msg->set_output_data(frame->data_, data_size);
+    err = WriteMessageToDebugFile(event_msg_.get());
+    if (err != kNoError) {
+      return err;
+    }
+  }
+#endif
+
+  was_stream_delay_set_ = false;
+  return kNoError;
+}
+
+int AudioProcessingImpl::ProcessStream(const float* const* src,
+                                       int samples_per_channel,
+                                       int sample_rate_hz,
+                                       float* const* dest) {
+  CriticalSectionScoped crit_scoped(crit_capture_);
+  int err = kNoError;
+
+  if (src == NULL || dest == NULL) {
+    return kNullPointerError;
+  }
+
+  if (sample_rate_hz != sample_rate_hz_) {
+    return kBadSampleRateError;
+  }
+
+  if (samples_per_channel != samples_per_channel_) {
+    return kBadDataLengthError;
+  }
+
+  capture_audio_->CopyFrom(src, samples_per_channel, num_input_channels_);
+
+#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
+  if (debug_file_->Open()) {
+    event_msg_->set_type(audioproc::Event::STREAM);
+    audioproc::Stream* msg = event_msg_->mutable_stream();
+    InterleaveForDump(*capture_audio_, msg->mutable_input_data());
+    msg->set_delay(stream_delay_ms_);
+    msg->set_drift(echo_cancellation_->stream_drift_samples());
+    msg->set_level(gain_control_->stream_analog_level());
+  }
+#endif
+
+  err = ProcessStreamLocked();
+  if (err != kNoError) {
+    return err;
+  }
+
+  if (interleave_needed(is_data_processed())) {
+    capture_audio_->CopyTo(samples_per_channel, num_output_channels_, dest);
+  } else if (src != dest) {
+    // Pass the input through untouched rather than through int16.
+    for (int i = 0; i < num_output_channels_; ++i) {
+      memcpy(dest[i], src[i], sizeof(float) * samples_per_channel);
+    }
+  }
+
+#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
+  if (debug_file_->Open()) {
+    audioproc::Stream* msg = event_msg_->mutable_stream();
+    InterleaveForDump(*capture_audio_, msg->mutable_output_data());
+    err = WriteMessageToDebugFile(event_msg_.get());
+    if (err != kNoError) {
+      return err;
+    }
+  }
+#endif
+
+  was_stream_delay_set_ = false;
+  return kNoError;
+}
+
+int AudioProcessingImpl::ProcessStreamLocked() {
+  // A render error doesn't drop the capture frame. It is reported once the
+  // frame is processed, unless the capture processing fails too.
+  const int render_err = EmptyRenderQueue();
+  int err = kNoError;
 
   // TODO(ajm): experiment with mixing and AEC placement.
   if (num_output_channels_ < num_input_channels_) {
     capture_audio_->Mix(num_output_channels_);
-    frame->num_channels_ = num_output_channels_;
   }
 
   bool data_processed = is_data_processed();
   if (analysis_needed(data_processed)) {
-    for (int i = 0; i < num_output_channels_; i++) {
-      // Split into a low and high band.
-      SplittingFilterAnalysis(capture_audio_->data(i),
-                              capture_audio_->low_pass_split_data(i),
-                              capture_audio_->high_pass_split_data(i),
-                              capture_audio_->analysis_filter_state1(i),
-                              capture_audio_->analysis_filter_state2(i));
-    }
+    SplitIntoBands(capture_audio_);
   }
 
   err = high_pass_filter_->ProcessCaptureAudio(capture_audio_);
@@ -358,14 +471,7 @@ int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
   }
 
   if (synthesis_needed(data_processed)) {
-    for (int i = 0; i < num_output_channels_; i++) {
-      // Recombine low and high bands.
-      SplittingFilterSynthesis(capture_audio_->low_pass_split_data(i),
-                               capture_audio_->high_pass_split_data(i),
-                               capture_audio_->data(i),
-                               capture_audio_->synthesis_filter_state1(i),
-                               capture_audio_->synthesis_filter_state2(i));
-    }
+    MergeBands(capture_audio_);
   }
 
   // The level estimator operates on the recombined data.
@@ -374,29 +480,11 @@ int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
     return err;
   }
 
-  capture_audio_->InterleaveTo(frame, interleave_needed(data_processed));
-
-#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
-    audioproc::Stream* msg = event_msg_->mutable_stream();
-    const size_t data_size = sizeof(int16_t) *
-                             frame->samples_per_channel_ *
-                             frame->num_channels_;
-    msg->set_output_data(frame->data_, data_size);
-    err = WriteMessageToDebugFile();
-    if (err != kNoError) {
-      return err;
-    }
-  }
-#endif
-
-  was_stream_delay_set_ = false;
-  return kNoError;
+  return render_err;
 }
 
 int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
-  CriticalSectionScoped crit_scoped(crit_);
-  int err = kNoError;
+  CriticalSectionScoped crit_scoped(crit_render_);
 
   if (frame == NULL) {
     return kNullPointerError;
@@ -416,13 +504,14 @@ int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
   if (debug_file_->Open()) {
-    event_msg_->set_type(audioproc::Event::REVERSE_STREAM);
-    audioproc::ReverseStream* msg = event_msg_->mutable_reverse_stream();
+    render_event_msg_->set_type(audioproc::Event::REVERSE_STREAM);
+    audioproc::ReverseStream* msg =
+        render_event_msg_->mutable_reverse_stream();
     const size_t data_size = sizeof(int16_t) *
                              frame->samples_per_channel_ *
                              frame->num_channels_;
     msg->set_data(frame->data_, data_size);
-    err = WriteMessageToDebugFile();
+    int err = WriteMessageToDebugFile(render_event_msg_.get());
     if (err != kNoError) {
       return err;
     }
@@ -430,36 +519,153 @@ int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
 #endif
 
   render_audio_->DeinterleaveFrom(frame);
+  return AnalyzeReverseStreamLocked();
+}
+
+int AudioProcessingImpl::AnalyzeReverseStream(const float* const* data,
+                                              int samples_per_channel,
+                                              int sample_rate_hz) {
+  CriticalSectionScoped crit_scoped(crit_render_);
 
+  if (data == NULL) {
+    return kNullPointerError;
+  }
+
+  if (sample_rate_hz != sample_rate_hz_) {
+    return kBadSampleRateError;
+  }
+
+  if (samples_per_channel != samples_per_channel_) {
+    return kBadDataLengthError;
+  }
+
+  render_audio_->CopyFrom(data, samples_per_channel, num_reverse_channels_);
+
+#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
+  if (debug_file_->Open()) {
+    render_event_msg_->set_type(audioproc::Event::REVERSE_STREAM);
+    audioproc::ReverseStream* msg =
+        render_event_msg_->mutable_reverse_stream();
+    InterleaveForDump(*render_audio_, msg->mutable_data());
+    int err = WriteMessageToDebugFile(render_event_msg_.get());
+    if (err != kNoError) {
+      return err;
+    }
+  }
+#endif
+
+  return AnalyzeReverseStreamLocked();
+}
+
+int AudioProcessingImpl::AnalyzeReverseStreamLocked() {
   // TODO(ajm): turn the splitting filter into a component?
   if (sample_rate_hz_ == kSampleRate32kHz) {
-    for (int i = 0; i < num_reverse_channels_; i++) {
-      // Split into low and high band.
-      SplittingFilterAnalysis(render_audio_->data(i),
-                              render_audio_->low_pass_split_data(i),
-                              render_audio_->high_pass_split_data(i),
-                              render_audio_->analysis_filter_state1(i),
-                              render_audio_->analysis_filter_state2(i));
+    SplitIntoBands(render_audio_);
+  }
+
+  return QueueRenderAudio();
+}
+
+void AudioProcessingImpl::SplitIntoBands(AudioBuffer* audio) {
+  const AudioBuffer* const_audio = audio;
+  for (int i = 0; i < audio->num_channels(); i++) {
+    // Split into a low and high band.
+    if (audio->is_float()) {
+      SplittingFilterAnalysis(const_audio->data_f(i),
+                              audio->low_pass_split_data_f(i),
+                              audio->high_pass_split_data_f(i),
+                              audio->analysis_filter_state1_f(i),
+                              audio->analysis_filter_state2_f(i));
+    } else {
+      SplittingFilterAnalysis(const_audio->data(i),
+                              audio->low_pass_split_data(i),
+                              audio->high_pass_split_data(i),
+                              audio->analysis_filter_state1(i),
+                              audio->analysis_filter_state2(i));
     }
   }
+}
 
-  // TODO(ajm): warnings possible from components?
-  err = echo_cancellation_->ProcessRenderAudio(render_audio_);
-  if (err != kNoError) {
-    return err;
+void AudioProcessingImpl::MergeBands(AudioBuffer* audio) {
+  const AudioBuffer* const_audio = audio;
+  for (int i = 0; i < audio->num_channels(); i++) {
+    // Recombine low and high bands.
+    if (audio->is_float()) {
+      SplittingFilterSynthesis(const_audio->low_pass_split_data_f(i),
+                               const_audio->high_pass_split_data_f(i),
+                               audio->data_f(i),
+                               audio->synthesis_filter_state1_f(i),
+                               audio->synthesis_filter_state2_f(i));
+    } else {
+      SplittingFilterSynthesis(const_audio->low_pass_split_data(i),
+                               const_audio->high_pass_split_data(i),
+                               audio->data(i),
+                               audio->synthesis_filter_state1(i),
+                               audio->synthesis_filter_state2(i));
+    }
   }
+}
 
-  err = echo_control_mobile_->ProcessRenderAudio(render_audio_);
-  if (err != kNoError) {
-    return err;
+int AudioProcessingImpl::QueueRenderAudio() {
+  int err = kNoError;
+  RenderFrame* frame = render_queue_->back();
+  if (frame == NULL) {
+    // The capture side has fallen behind. Hand the queued frames to the
+    // components from this thread rather than dropping far-end audio. The
+    // queue is empty afterwards, even if a component failed.
+    CriticalSectionScoped crit_scoped(crit_capture_);
+    err = EmptyRenderQueue();
+    frame = render_queue_->back();
+    assert(frame != NULL);
+  }
+
+  const int num_channels = render_audio_->num_channels();
+  const int samples_per_split_channel =
+      render_audio_->samples_per_split_channel();
+  assert(num_channels <= RenderFrame::kMaxChannels);
+  assert(samples_per_split_channel <= RenderFrame::kMaxSamplesPerSplitChannel);
+  frame->num_channels = num_channels;
+  frame->samples_per_split_channel = samples_per_split_channel;
+  frame->is_float = render_audio_->is_float();
+  const AudioBuffer* render_audio = render_audio_;
+  for (int i = 0; i < num_channels; i++) {
+    if (frame->is_float) {
+      memcpy(frame->low_pass_f[i], render_audio->low_pass_split_data_f(i),
+             sizeof(float) * samples_per_split_channel);
+    }
+    memcpy(frame->low_pass[i], render_audio->low_pass_split_data(i),
+           sizeof(int16_t) * samples_per_split_channel);
   }
+  if (num_channels > 1) {
+    render_audio_->CopyAndMixLowPass(1);
+    memcpy(frame->mixed_low_pass, render_audio_->mixed_low_pass_data(0),
+           sizeof(int16_t) * samples_per_split_channel);
+  }
+  render_queue_->PushBack();
 
-  err = gain_control_->ProcessRenderAudio(render_audio_);
-  if (err != kNoError) {
-    return err;
+  return err;
+}
+
+int AudioProcessingImpl::EmptyRenderQueue() {
+  int first_err = kNoError;
+  const RenderFrame* frame = render_queue_->front();
+  while (frame != NULL) {
+    // TODO(ajm): warnings possible from components?
+    int err = echo_cancellation_->ProcessRenderAudio(*frame);
+    if (err == kNoError) {
+      err = echo_control_mobile_->ProcessRenderAudio(*frame);
+    }
+    if (err == kNoError) {
+      err = gain_control_->ProcessRenderAudio(*frame);
+    }
+    render_queue_->PopFront();
+    if (first_err == kNoError) {
+      first_err = err;
+    }
+    frame = render_queue_->front();
   }
 
-  return err;  // TODO(ajm): this is for returning warnings; necessary?
+  return first_err;
 }
 
 int AudioProcessingImpl::set_stream_delay_ms(int delay) {
@@ -491,7 +697,7 @@ bool AudioProcessingImpl::was_stream_delay_set() const {
 }
 
 void AudioProcessingImpl::set_delay_offset_ms(int offset) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   delay_offset_ms_ = offset;
 }
 
@@ -501,7 +707,8 @@ int AudioProcessingImpl::delay_offset_ms() const {
 
 int AudioProcessingImpl::StartDebugRecording(
     const char filename[AudioProcessing::kMaxFilenameSize]) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_render_scoped(crit_render_);
+  CriticalSectionScoped crit_capture_scoped(crit_capture_);
   assert(kMaxFilenameSize == FileWrapper::kMaxFileNameSize);
 
   if (filename == NULL) {
@@ -532,7 +739,8 @@ int AudioProcessingImpl::StartDebugRecording(
 }
 
 int AudioProcessingImpl::StopDebugRecording() {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_render_scoped(crit_render_);
+  CriticalSectionScoped crit_capture_scoped(crit_capture_);
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
   // We just return if recording hasn't started.
@@ -576,7 +784,7 @@ VoiceDetection* AudioProcessingImpl::voice_detection() const {
 }
 
 int32_t AudioProcessingImpl::ChangeUniqueId(const int32_t id) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(crit_capture_);
   id_ = id;
 
   return kNoError;
@@ -628,8 +836,9 @@ bool AudioProcessingImpl::analysis_needed(bool is_data_processed) const {
 }
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-int AudioProcessingImpl::WriteMessageToDebugFile() {
-  int32_t size = event_msg_->ByteSize();
+int AudioProcessingImpl::WriteMessageToDebugFile(audioproc::Event* event) {
+  CriticalSectionScoped crit_scoped(crit_debug_);
+  int32_t size = event->ByteSize();
   if (size <= 0) {
     return kUnspecifiedError;
   }
@@ -638,7 +847,7 @@ int AudioProcessingImpl::WriteMessageToDebugFile() {
   //            pretty safe in assuming little-endian.
 #endif
 
-  if (!event_msg_->SerializeToString(&event_str_)) {
+  if (!event->SerializeToString(&event_str_)) {
     return kUnspecifiedError;
   }
 
@@ -650,11 +859,25 @@ int AudioProcessingImpl::WriteMessageToDebugFile() {
     return kFileError;
   }
 
-  event_msg_->Clear();
+  event->Clear();
 
   return 0;
 }
 
+void AudioProcessingImpl::InterleaveForDump(const AudioBuffer& audio,
+                                            std::string* data) {
+  const int num_channels = audio.num_channels();
+  const int samples_per_channel = audio.samples_per_channel();
+  data->resize(sizeof(int16_t) * num_channels * samples_per_channel);
+  int16_t* interleaved = reinterpret_cast<int16_t*>(&(*data)[0]);
+  for (int i = 0; i < num_channels; i++) {
+    const int16_t* channel = audio.data(i);
+    for (int j = 0; j < samples_per_channel; j++) {
+      interleaved[j * num_channels + i] = channel[j];
+    }
+  }
+}
+
 int AudioProcessingImpl::WriteInitMessage() {
   event_msg_->set_type(audioproc::Event::INIT);
   audioproc::Init* msg = event_msg_->mutable_init();
@@ -664,7 +887,7 @@ int AudioProcessingImpl::WriteInitMessage() {
   msg->set_num_output_channels(num_output_channels_);
   msg->set_num_reverse_channels(num_reverse_channels_);
 
-  int err = WriteMessageToDebugFile();
+  int err = WriteMessageToDebugFile(event_msg_.get());
   if (err != kNoError) {
     return err;
   }
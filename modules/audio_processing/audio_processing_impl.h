@@ -17,6 +17,7 @@
 #include <string>
 
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/test/testsupport/gtest_prod_util.h"
 
 namespace webrtc {
 class AudioBuffer;
@@ -29,6 +30,7 @@ class HighPassFilterImpl;
 class LevelEstimatorImpl;
 class NoiseSuppressionImpl;
 class ProcessingComponent;
+class RenderQueue;
 class VoiceDetectionImpl;
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
@@ -50,6 +52,8 @@ class AudioProcessingImpl : public AudioProcessing {
   explicit AudioProcessingImpl(int id);
   virtual ~AudioProcessingImpl();
 
+  // Guards the capture path and the component settings. The render path
+  // only takes it when the render queue is full.
   CriticalSectionWrapper* crit() const;
 
   int split_sample_rate_hz() const;
@@ -66,7 +70,14 @@ class AudioProcessingImpl : public AudioProcessing {
   virtual int set_num_reverse_channels(int channels);
   virtual int num_reverse_channels() const;
   virtual int ProcessStream(AudioFrame* frame);
+  virtual int ProcessStream(const float* const* src,
+                            int samples_per_channel,
+                            int sample_rate_hz,
+                            float* const* dest);
   virtual int AnalyzeReverseStream(AudioFrame* frame);
+  virtual int AnalyzeReverseStream(const float* const* data,
+                                   int samples_per_channel,
+                                   int sample_rate_hz);
   virtual int set_stream_delay_ms(int delay);
   virtual int stream_delay_ms() const;
   virtual void set_delay_offset_ms(int offset);
@@ -85,6 +96,23 @@ class AudioProcessingImpl : public AudioProcessing {
   virtual int32_t ChangeUniqueId(const int32_t id);
 
  private:
+  // This test needs to queue a render frame the components reject.
+  FRIEND_TEST_ALL_PREFIXES(AudioProcessingImplTest,
+                           RenderErrorIsReportedAfterCaptureProcessing);
+
+  // Run the components on the data in |capture_audio_| and |render_audio_|.
+  // Must be called with |crit_capture_| and |crit_render_| held respectively.
+  int ProcessStreamLocked();
+  int AnalyzeReverseStreamLocked();
+  // Split |audio| into a low and high band, and recombine them, in the
+  // representation of the frame.
+  void SplitIntoBands(AudioBuffer* audio);
+  void MergeBands(AudioBuffer* audio);
+  // Queues the split band data of |render_audio_| for the capture thread.
+  int QueueRenderAudio();
+  // Passes all queued render frames to the components and returns the first
+  // error. Must be called with |crit_capture_| held.
+  int EmptyRenderQueue();
   bool is_data_processed() const;
   bool interleave_needed(bool is_data_processed) const;
   bool synthesis_needed(bool is_data_processed) const;
@@ -101,16 +129,27 @@ class AudioProcessingImpl : public AudioProcessing {
   VoiceDetectionImpl* voice_detection_;
 
   std::list<ProcessingComponent*> component_list_;
-  CriticalSectionWrapper* crit_;
+  // Settings that affect both streams, such as the sample rate and channel
+  // counts, are only changed with both locks held, in that order. Either lock
+  // is then enough to read them.
+  CriticalSectionWrapper* crit_render_;
+  CriticalSectionWrapper* crit_capture_;
   AudioBuffer* render_audio_;
   AudioBuffer* capture_audio_;
+  scoped_ptr<RenderQueue> render_queue_;
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
   // TODO(andrew): make this more graceful. Ideally we would split this stuff
   // out into a separate class with an "enabled" and "disabled" implementation.
-  int WriteMessageToDebugFile();
+  int WriteMessageToDebugFile(audioproc::Event* event);
   int WriteInitMessage();
+  // Interleaves the int16 data of |audio| into |data|, so that float streams
+  // are recorded in the same format as AudioFrames.
+  static void InterleaveForDump(const AudioBuffer& audio, std::string* data);
+  // Serializes the file writes of the two streams.
+  CriticalSectionWrapper* crit_debug_;
   scoped_ptr<FileWrapper> debug_file_;
   scoped_ptr<audioproc::Event> event_msg_; // Protobuf message.
+  scoped_ptr<audioproc::Event> render_event_msg_;
   std::string event_str_; // Memory for protobuf serialization.
 #endif
 
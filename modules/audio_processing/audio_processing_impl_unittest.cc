@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/audio_processing_impl.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/audio_processing/render_queue.h"
+#include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+
+namespace webrtc {
+namespace {
+
+const int kSampleRateHz = 16000;
+const int kSamplesPerChannel = kSampleRateHz / 100;
+
+void SetFrame(int16_t value, AudioFrame* frame) {
+  frame->sample_rate_hz_ = kSampleRateHz;
+  frame->num_channels_ = 1;
+  frame->samples_per_channel_ = kSamplesPerChannel;
+  for (int i = 0; i < kSamplesPerChannel; ++i) {
+    frame->data_[i] = (i & 1) ? value : -value;
+  }
+}
+
+}  // namespace
+
+TEST(AudioProcessingImplTest, RenderErrorIsReportedAfterCaptureProcessing) {
+  scoped_ptr<AudioProcessingImpl> apm(new AudioProcessingImpl(0));
+  ASSERT_EQ(apm->kNoError, apm->Initialize());
+  ASSERT_EQ(apm->kNoError, apm->set_sample_rate_hz(kSampleRateHz));
+  ASSERT_EQ(apm->kNoError, apm->echo_cancellation()->Enable(true));
+  ASSERT_EQ(apm->kNoError, apm->level_estimator()->Enable(true));
+
+  AudioFrame frame;
+  SetFrame(1000, &frame);
+  EXPECT_EQ(apm->kNoError, apm->AnalyzeReverseStream(&frame));
+  // Queue a frame with a length the AEC rejects.
+  RenderFrame* bad_frame = apm->render_queue_->back();
+  ASSERT_TRUE(bad_frame != NULL);
+  bad_frame->num_channels = 1;
+  bad_frame->is_float = false;
+  bad_frame->samples_per_split_channel = kSamplesPerChannel / 2 + 1;
+  apm->render_queue_->PushBack();
+  EXPECT_EQ(apm->kNoError, apm->AnalyzeReverseStream(&frame));
+
+  // The capture frame is processed, then the render error is reported.
+  EXPECT_EQ(apm->kNoError, apm->set_stream_delay_ms(0));
+  EXPECT_EQ(apm->kBadParameterError, apm->ProcessStream(&frame));
+  // The level estimator reports 127 if it hasn't processed any audio.
+  EXPECT_GT(127, apm->level_estimator()->RMS());
+
+  // The whole queue was emptied, including the frame after the bad one.
+  EXPECT_TRUE(apm->render_queue_->front() == NULL);
+  EXPECT_EQ(apm->kNoError, apm->AnalyzeReverseStream(&frame));
+  EXPECT_EQ(apm->kNoError, apm->set_stream_delay_ms(0));
+  EXPECT_EQ(apm->kNoError, apm->ProcessStream(&frame));
+}
+
+}  // namespace webrtc
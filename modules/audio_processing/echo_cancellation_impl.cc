@@ -15,6 +15,7 @@
 
 #include "webrtc/modules/audio_processing/audio_buffer.h"
 #include "webrtc/modules/audio_processing/audio_processing_impl.h"
+#include "webrtc/modules/audio_processing/render_queue.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 
 #include "webrtc/modules/audio_processing/aec/include/echo_cancellation.h"
@@ -68,25 +69,31 @@ EchoCancellationImpl::EchoCancellationImpl(const AudioProcessingImpl* apm)
 
 EchoCancellationImpl::~EchoCancellationImpl() {}
 
-int EchoCancellationImpl::ProcessRenderAudio(const AudioBuffer* audio) {
+int EchoCancellationImpl::ProcessRenderAudio(const RenderFrame& frame) {
   if (!is_component_enabled()) {
     return apm_->kNoError;
   }
 
-  assert(audio->samples_per_split_channel() <= 160);
-  assert(audio->num_channels() == apm_->num_reverse_channels());
+  assert(frame.num_channels == apm_->num_reverse_channels());
 
   int err = apm_->kNoError;
 
   // The ordering convention must be followed to pass to the correct AEC.
   size_t handle_index = 0;
   for (int i = 0; i < apm_->num_output_channels(); i++) {
-    for (int j = 0; j < audio->num_channels(); j++) {
+    for (int j = 0; j < frame.num_channels; j++) {
       Handle* my_handle = static_cast<Handle*>(handle(handle_index));
-      err = WebRtcAec_BufferFarend(
-          my_handle,
-          audio->low_pass_split_data(j),
-          static_cast<int16_t>(audio->samples_per_split_channel()));
+      if (frame.is_float) {
+        err = WebRtcAec_BufferFarendFloat(
+            my_handle,
+            frame.low_pass_f[j],
+            static_cast<int16_t>(frame.samples_per_split_channel));
+      } else {
+        err = WebRtcAec_BufferFarend(
+            my_handle,
+            frame.low_pass[j],
+            static_cast<int16_t>(frame.samples_per_split_channel));
+      }
 
       if (err != apm_->kNoError) {
         return GetHandleError(my_handle);  // TODO(ajm): warning possible?
@@ -123,15 +130,27 @@ int EchoCancellationImpl::ProcessCaptureAudio(AudioBuffer* audio) {
   for (int i = 0; i < audio->num_channels(); i++) {
     for (int j = 0; j < apm_->num_reverse_channels(); j++) {
       Handle* my_handle = handle(handle_index);
-      err = WebRtcAec_Process(
-          my_handle,
-          audio->low_pass_split_data(i),
-          audio->high_pass_split_data(i),
-          audio->low_pass_split_data(i),
-          audio->high_pass_split_data(i),
-          static_cast<int16_t>(audio->samples_per_split_channel()),
-          apm_->stream_delay_ms(),
-          stream_drift_samples_);
+      if (audio->is_float()) {
+        err = WebRtcAec_ProcessFloat(
+            my_handle,
+            audio->low_pass_split_data_f(i),
+            audio->high_pass_split_data_f(i),
+            audio->low_pass_split_data_f(i),
+            audio->high_pass_split_data_f(i),
+            static_cast<int16_t>(audio->samples_per_split_channel()),
+            apm_->stream_delay_ms(),
+            stream_drift_samples_);
+      } else {
+        err = WebRtcAec_Process(
+            my_handle,
+            audio->low_pass_split_data(i),
+            audio->high_pass_split_data(i),
+            audio->low_pass_split_data(i),
+            audio->high_pass_split_data(i),
+            static_cast<int16_t>(audio->samples_per_split_channel()),
+            apm_->stream_delay_ms(),
+            stream_drift_samples_);
+      }
 
       if (err != apm_->kNoError) {
         err = GetHandleError(my_handle);
@@ -17,6 +17,7 @@
 namespace webrtc {
 class AudioProcessingImpl;
 class AudioBuffer;
+struct RenderFrame;
 
 class EchoCancellationImpl : public EchoCancellation,
                              public ProcessingComponent {
@@ -24,7 +25,7 @@ class EchoCancellationImpl : public EchoCancellation,
   explicit EchoCancellationImpl(const AudioProcessingImpl* apm);
   virtual ~EchoCancellationImpl();
 
-  int ProcessRenderAudio(const AudioBuffer* audio);
+  int ProcessRenderAudio(const RenderFrame& frame);
   int ProcessCaptureAudio(AudioBuffer* audio);
 
   // EchoCancellation implementation.
@@ -16,6 +16,7 @@
 #include "webrtc/modules/audio_processing/aecm/include/echo_control_mobile.h"
 #include "webrtc/modules/audio_processing/audio_buffer.h"
 #include "webrtc/modules/audio_processing/audio_processing_impl.h"
+#include "webrtc/modules/audio_processing/render_queue.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/logging.h"
 
@@ -77,25 +78,24 @@ EchoControlMobileImpl::~EchoControlMobileImpl() {
     }
 }
 
-int EchoControlMobileImpl::ProcessRenderAudio(const AudioBuffer* audio) {
+int EchoControlMobileImpl::ProcessRenderAudio(const RenderFrame& frame) {
   if (!is_component_enabled()) {
     return apm_->kNoError;
   }
 
-  assert(audio->samples_per_split_channel() <= 160);
-  assert(audio->num_channels() == apm_->num_reverse_channels());
+  assert(frame.num_channels == apm_->num_reverse_channels());
 
   int err = apm_->kNoError;
 
   // The ordering convention must be followed to pass to the correct AECM.
   size_t handle_index = 0;
   for (int i = 0; i < apm_->num_output_channels(); i++) {
-    for (int j = 0; j < audio->num_channels(); j++) {
+    for (int j = 0; j < frame.num_channels; j++) {
       Handle* my_handle = static_cast<Handle*>(handle(handle_index));
       err = WebRtcAecm_BufferFarend(
           my_handle,
-          audio->low_pass_split_data(j),
-          static_cast<int16_t>(audio->samples_per_split_channel()));
+          frame.low_pass[j],
+          static_cast<int16_t>(frame.samples_per_split_channel));
 
       if (err != apm_->kNoError) {
         return GetHandleError(my_handle);  // TODO(ajm): warning possible?
@@ -17,6 +17,7 @@
 namespace webrtc {
 class AudioProcessingImpl;
 class AudioBuffer;
+struct RenderFrame;
 
 class EchoControlMobileImpl : public EchoControlMobile,
                               public ProcessingComponent {
@@ -24,7 +25,7 @@ class EchoControlMobileImpl : public EchoControlMobile,
   explicit EchoControlMobileImpl(const AudioProcessingImpl* apm);
   virtual ~EchoControlMobileImpl();
 
-  int ProcessRenderAudio(const AudioBuffer* audio);
+  int ProcessRenderAudio(const RenderFrame& frame);
   int ProcessCaptureAudio(AudioBuffer* audio);
 
   // EchoControlMobile implementation.
@@ -17,6 +17,7 @@
 
 #include "webrtc/modules/audio_processing/audio_buffer.h"
 #include "webrtc/modules/audio_processing/audio_processing_impl.h"
+#include "webrtc/modules/audio_processing/render_queue.h"
 
 namespace webrtc {
 
@@ -52,25 +53,17 @@ GainControlImpl::GainControlImpl(const AudioProcessingImpl* apm)
 
 GainControlImpl::~GainControlImpl() {}
 
-int GainControlImpl::ProcessRenderAudio(AudioBuffer* audio) {
+int GainControlImpl::ProcessRenderAudio(const RenderFrame& frame) {
   if (!is_component_enabled()) {
     return apm_->kNoError;
   }
 
-  assert(audio->samples_per_split_channel() <= 160);
-
-  int16_t* mixed_data = audio->low_pass_split_data(0);
-  if (audio->num_channels() > 1) {
-    audio->CopyAndMixLowPass(1);
-    mixed_data = audio->mixed_low_pass_data(0);
-  }
-
   for (int i = 0; i < num_handles(); i++) {
     Handle* my_handle = static_cast<Handle*>(handle(i));
     int err = WebRtcAgc_AddFarend(
         my_handle,
-        mixed_data,
-        static_cast<int16_t>(audio->samples_per_split_channel()));
+        frame.mixed_low_pass_data(),
+        static_cast<int16_t>(frame.samples_per_split_channel));
 
     if (err != apm_->kNoError) {
       return GetHandleError(my_handle);
@@ -19,6 +19,7 @@
 namespace webrtc {
 class AudioProcessingImpl;
 class AudioBuffer;
+struct RenderFrame;
 
 class GainControlImpl : public GainControl,
                         public ProcessingComponent {
@@ -26,7 +27,7 @@ class GainControlImpl : public GainControl,
   explicit GainControlImpl(const AudioProcessingImpl* apm);
   virtual ~GainControlImpl();
 
-  int ProcessRenderAudio(AudioBuffer* audio);
+  int ProcessRenderAudio(const RenderFrame& frame);
   int AnalyzeCaptureAudio(AudioBuffer* audio);
   int ProcessCaptureAudio(AudioBuffer* audio);
 
@@ -58,6 +58,10 @@ class VoiceDetection;
 //   2. Parameter getters are never called concurrently with the corresponding
 //      setter.
 //
+// ProcessStream() and AnalyzeReverseStream() may be called concurrently from
+// the capture and render threads without blocking each other. Parameter
+// setters take effect between two calls to ProcessStream().
+//
 // APM accepts only 16-bit linear PCM audio data in frames of 10 ms. Multiple
 // channels should be interleaved.
 //
@@ -161,6 +165,17 @@ class AudioProcessing : public Module {
   // to APM.
   virtual int ProcessStream(AudioFrame* frame) = 0;
 
+  // Accepts deinterleaved float audio in the range [-1, 1]. Each element of
+  // |src| points to a channel buffer of |samples_per_channel| samples, with
+  // num_input_channels() channels. The output is written to the
+  // num_output_channels() buffers of |dest|, which may be |src|.
+  // |samples_per_channel| and |sample_rate_hz| must correspond to settings
+  // supplied to APM.
+  virtual int ProcessStream(const float* const* src,
+                            int samples_per_channel,
+                            int sample_rate_hz,
+                            float* const* dest) = 0;
+
   // Analyzes a 10 ms |frame| of the reverse direction audio stream. The frame
   // will not be modified. On the client-side, this is the far-end (or to be
   // rendered) audio.
@@ -174,9 +189,18 @@ class AudioProcessing : public Module {
   // The |sample_rate_hz_|, |num_channels_|, and |samples_per_channel_|
   // members of |frame| must be valid.
   //
+  // The analysis is queued and applied at the start of the next
+  // ProcessStream(), which reports any errors from the components.
+  //
   // TODO(ajm): add const to input; requires an implementation fix.
   virtual int AnalyzeReverseStream(AudioFrame* frame) = 0;
 
+  // Accepts deinterleaved float audio in the range [-1, 1], with
+  // num_reverse_channels() channels. See ProcessStream() for the layout.
+  virtual int AnalyzeReverseStream(const float* const* data,
+                                   int samples_per_channel,
+                                   int sample_rate_hz) = 0;
+
   // This must be called if and only if echo processing is enabled.
   //
   // Sets the |delay| in ms between AnalyzeReverseStream() receiving a far-end
@@ -197,8 +197,14 @@ class MockAudioProcessing : public AudioProcessing {
       int());
   MOCK_METHOD1(ProcessStream,
       int(AudioFrame* frame));
+  MOCK_METHOD4(ProcessStream,
+      int(const float* const* src, int samples_per_channel,
+          int sample_rate_hz, float* const* dest));
   MOCK_METHOD1(AnalyzeReverseStream,
       int(AudioFrame* frame));
+  MOCK_METHOD3(AnalyzeReverseStream,
+      int(const float* const* data, int samples_per_channel,
+          int sample_rate_hz));
   MOCK_METHOD1(set_stream_delay_ms,
       int(int delay));
   MOCK_CONST_METHOD0(stream_delay_ms,
@@ -37,7 +37,15 @@ class Level {
     sample_count_ = 0;
   }
 
-  void Process(int16_t* data, int length) {
+  void Process(const int16_t* data, int length) {
+    assert(data != NULL);
+    assert(length > 0);
+    sum_square_ += SumSquare(data, length);
+    sample_count_ += length;
+  }
+
+  // For float samples in the int16 range.
+  void Process(const float* data, int length) {
     assert(data != NULL);
     assert(length > 0);
     sum_square_ += SumSquare(data, length);
@@ -70,7 +78,8 @@ class Level {
   }
 
  private:
-  static double SumSquare(int16_t* data, int length) {
+  template <typename T>
+  static double SumSquare(const T* data, int length) {
     double sum_square = 0.0;
     for (int i = 0; i < length; ++i) {
       double data_d = static_cast<double>(data[i]);
@@ -101,13 +110,19 @@ int LevelEstimatorImpl::ProcessStream(AudioBuffer* audio) {
     return apm_->kNoError;
   }
 
-  int16_t* mixed_data = audio->data(0);
-  if (audio->num_channels() > 1) {
+  const AudioBuffer* const_audio = audio;
+  const bool mixed = audio->num_channels() > 1;
+  if (mixed) {
     audio->CopyAndMix(1);
-    mixed_data = audio->mixed_data(0);
   }
 
-  level->Process(mixed_data, audio->samples_per_channel());
+  if (audio->is_float()) {
+    level->Process(mixed ? audio->mixed_data_f(0) : const_audio->data_f(0),
+                   audio->samples_per_channel());
+  } else {
+    level->Process(mixed ? audio->mixed_data(0) : const_audio->data(0),
+                   audio->samples_per_channel());
+  }
 
   return apm_->kNoError;
 }
@@ -22,6 +22,11 @@ LOCAL_SRC_FILES := \
     noise_suppression_x.c \
     nsx_core.c
 
+ifeq ($(TARGET_ARCH),x86)
+LOCAL_SRC_FILES += \
+    nsx_core_sse2.c
+endif
+
 # Files for floating point.
 # noise_suppression.c ns_core.c
 
@@ -104,6 +104,16 @@ int WebRtcNs_Process(NsHandle* NS_inst,
                      short* outframe,
                      short* outframe_H);
 
+/*
+ * As WebRtcNs_Process(), for float samples in the int16 range. The output is
+ * saturated to the int16 range, but not rounded.
+ */
+int WebRtcNs_ProcessFloat(NsHandle* NS_inst,
+                          const float* spframe,
+                          const float* spframe_H,
+                          float* outframe,
+                          float* outframe_H);
+
 /* Returns the internally used prior speech probability of the current frame.
  * There is a frequency bin based one as well, with which this should not be
  * confused.
@@ -45,6 +45,50 @@ int WebRtcNs_set_policy(NsHandle* NS_inst, int mode) {
 
 int WebRtcNs_Process(NsHandle* NS_inst, short* spframe, short* spframe_H,
                      short* outframe, short* outframe_H) {
+  NSinst_t* inst = (NSinst_t*) NS_inst;
+  float frame[BLOCKL_MAX];
+  float frame_H[BLOCKL_MAX];
+  int flagHB = 0;
+  int i;
+
+  if (inst->initFlag != 1) {
+    return -1;
+  }
+  if (inst->fs == 32000) {
+    if (spframe_H == NULL) {
+      return -1;
+    }
+    flagHB = 1;
+  }
+
+  for (i = 0; i < inst->blockLen10ms; i++) {
+    frame[i] = (float) spframe[i];
+  }
+  if (flagHB == 1) {
+    for (i = 0; i < inst->blockLen10ms; i++) {
+      frame_H[i] = (float) spframe_H[i];
+    }
+  }
+
+  if (WebRtcNs_ProcessCore(inst, frame, frame_H, frame, frame_H) != 0) {
+    return -1;
+  }
+
+  // The output is already saturated.
+  for (i = 0; i < inst->blockLen10ms; i++) {
+    outframe[i] = (short) frame[i];
+  }
+  if (flagHB == 1) {
+    for (i = 0; i < inst->blockLen10ms; i++) {
+      outframe_H[i] = (short) frame_H[i];
+    }
+  }
+  return 0;
+}
+
+int WebRtcNs_ProcessFloat(NsHandle* NS_inst, const float* spframe,
+                          const float* spframe_H, float* outframe,
+                          float* outframe_H) {
   return WebRtcNs_ProcessCore(
       (NSinst_t*) NS_inst, spframe, spframe_H, outframe, outframe_H);
 }
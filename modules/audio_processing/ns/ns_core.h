@@ -149,7 +149,8 @@ int WebRtcNs_set_policy_core(NSinst_t* inst, int mode);
 /****************************************************************************
  * WebRtcNs_ProcessCore
  *
- * Do noise suppression.
+ * Do noise suppression on samples in the int16 range. The output is saturated
+ * to the int16 range, but not rounded.
  *
  * Input:
  *      - inst          : Instance that should be initialized
@@ -167,10 +168,10 @@ int WebRtcNs_set_policy_core(NSinst_t* inst, int mode);
 
 
 int WebRtcNs_ProcessCore(NSinst_t* inst,
-                         short* inFrameLow,
-                         short* inFrameHigh,
-                         short* outFrameLow,
-                         short* outFrameHigh);
+                         const float* inFrameLow,
+                         const float* inFrameHigh,
+                         float* outFrameLow,
+                         float* outFrameHigh);
 
 
 #ifdef __cplusplus
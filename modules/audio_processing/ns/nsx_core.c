@@ -20,17 +20,13 @@
 #include "webrtc/modules/audio_processing/ns/nsx_core.h"
 #include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 
-#if (defined WEBRTC_DETECT_ARM_NEON || defined WEBRTC_ARCH_ARM_NEON)
-/* Tables are defined in ARM assembly files. */
-extern const int16_t WebRtcNsx_kLogTable[9];
-extern const int16_t WebRtcNsx_kCounterDiv[201];
-extern const int16_t WebRtcNsx_kLogTableFrac[256];
-#else
-static const int16_t WebRtcNsx_kLogTable[9] = {
+#if !(defined WEBRTC_DETECT_ARM_NEON || defined WEBRTC_ARCH_ARM_NEON)
+/* On ARM Neon platforms the tables are defined in the ARM assembly files. */
+const int16_t WebRtcNsx_kLogTable[9] = {
   0, 177, 355, 532, 710, 887, 1065, 1242, 1420
 };
 
-static const int16_t WebRtcNsx_kCounterDiv[201] = {
+const int16_t WebRtcNsx_kCounterDiv[201] = {
   32767, 16384, 10923, 8192, 6554, 5461, 4681, 4096, 3641, 3277, 2979, 2731,
   2521, 2341, 2185, 2048, 1928, 1820, 1725, 1638, 1560, 1489, 1425, 1365, 1311,
   1260, 1214, 1170, 1130, 1092, 1057, 1024, 993, 964, 936, 910, 886, 862, 840,
@@ -47,7 +43,7 @@ static const int16_t WebRtcNsx_kCounterDiv[201] = {
   172, 172, 171, 170, 169, 168, 167, 166, 165, 165, 164, 163
 };
 
-static const int16_t WebRtcNsx_kLogTableFrac[256] = {
+const int16_t WebRtcNsx_kLogTableFrac[256] = {
   0,   1,   3,   4,   6,   7,   9,  10,  11,  13,  14,  16,  17,  18,  20,  21,
   22,  24,  25,  26,  28,  29,  30,  32,  33,  34,  36,  37,  38,  40,  41,  42,
   44,  45,  46,  47,  49,  50,  51,  52,  54,  55,  56,  57,  59,  60,  61,  62,
@@ -66,7 +62,7 @@ static const int16_t WebRtcNsx_kLogTableFrac[256] = {
   237, 238, 238, 239, 240, 241, 241, 242, 243, 244, 244, 245, 246, 247, 247,
   248, 249, 249, 250, 251, 252, 252, 253, 254, 255, 255
 };
-#endif  // WEBRTC_DETECT_ARM_NEON || WEBRTC_ARCH_ARM_NEON
+#endif  // !(WEBRTC_DETECT_ARM_NEON || WEBRTC_ARCH_ARM_NEON)
 
 // Skip first frequency bins during estimation. (0 <= value < 64)
 static const int kStartBand = 5;
@@ -457,7 +453,7 @@ static void WebRtcNsx_InitNeon(void) {
 #endif
 
 // Update the noise estimation information.
-static void UpdateNoiseEstimate(NsxInst_t* inst, int offset) {
+void WebRtcNsx_UpdateNoiseEstimate(NsxInst_t* inst, int offset) {
   int32_t tmp32no1 = 0;
   int32_t tmp32no2 = 0;
   int16_t tmp16 = 0;
@@ -593,7 +589,7 @@ static void NoiseEstimationC(NsxInst_t* inst,
     if (counter >= END_STARTUP_LONG) {
       inst->noiseEstCounter[s] = 0;
       if (inst->blockIndex >= END_STARTUP_LONG) {
-        UpdateNoiseEstimate(inst, offset);
+        WebRtcNsx_UpdateNoiseEstimate(inst, offset);
       }
     }
     inst->noiseEstCounter[s]++;
@@ -602,7 +598,7 @@ static void NoiseEstimationC(NsxInst_t* inst,
 
   // Sequentially update the noise during startup
   if (inst->blockIndex < END_STARTUP_LONG) {
-    UpdateNoiseEstimate(inst, offset);
+    WebRtcNsx_UpdateNoiseEstimate(inst, offset);
   }
 
   for (i = 0; i < inst->magnLen; i++) {
@@ -913,6 +909,17 @@ int32_t WebRtcNsx_InitCore(NsxInst_t* inst, uint32_t fs) {
     WebRtcNsx_InitNeon();
 #endif
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    WebRtcNsx_InitSse2();
+  }
+#if defined(WEBRTC_AUDIOPROC_AVX2)
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    WebRtcNsx_InitAvx2();
+  }
+#endif
+#endif
+
   inst->initFlag = 1;
 
   return 0;
@@ -235,6 +235,24 @@ void WebRtcNsx_DenormalizeNeon(NsxInst_t* inst, int16_t* in, int factor);
 void WebRtcNsx_PrepareSpectrumNeon(NsxInst_t* inst, int16_t* freq_buff);
 #endif
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Point the above function pointers to the x86 versions, which are defined in
+// file nsx_core_sse2.c and file nsx_core_avx2.c. The AVX2 initialization only
+// replaces some of the functions, and is done after the SSE2 initialization.
+void WebRtcNsx_InitSse2(void);
+void WebRtcNsx_InitAvx2(void);
+#endif
+
+// Tables and helpers defined for the generic C code, which the optimized
+// versions share.
+extern const int16_t WebRtcNsx_kLogTable[9];
+extern const int16_t WebRtcNsx_kCounterDiv[201];
+extern const int16_t WebRtcNsx_kLogTableFrac[256];
+
+// Updates the noise estimate in |inst->noiseEstQuantile| from the log
+// quantiles of the simultaneous estimate starting at |offset|.
+void WebRtcNsx_UpdateNoiseEstimate(NsxInst_t* inst, int offset);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,254 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The fixed point noise suppression, AVX2 version of the functions working
+ * on whole blocks. The noise estimation is left to the SSE2 version, since
+ * its table lookups limit the gain from wider vectors. All functions are bit
+ * exact with the generic C versions in nsx_core.c.
+ */
+
+#include "webrtc/modules/audio_processing/ns/nsx_core.h"
+
+#include <immintrin.h>
+
+// Multiplies the 16 bit elements of |a| and |b| into 32 bit products, adds
+// |round| and shifts them down arithmetically by |shift|. Within each 128 bit
+// lane, |lo| gets the results of the lower four elements, and |hi| of the
+// upper four.
+static __inline void MulShift32(__m256i a,
+                                __m256i b,
+                                __m256i round,
+                                __m128i shift,
+                                __m256i* lo,
+                                __m256i* hi) {
+  const __m256i prod_lo = _mm256_mullo_epi16(a, b);
+  const __m256i prod_hi = _mm256_mulhi_epi16(a, b);
+  *lo = _mm256_sra_epi32(_mm256_add_epi32(
+      _mm256_unpacklo_epi16(prod_lo, prod_hi), round), shift);
+  *hi = _mm256_sra_epi32(_mm256_add_epi32(
+      _mm256_unpackhi_epi16(prod_lo, prod_hi), round), shift);
+}
+
+// Packs 32 bit elements into 16 bits keeping the low bits, like a C cast to
+// int16_t does. The packing is done within each 128 bit lane, which restores
+// the element order split by MulShift32().
+static __inline __m256i PackTruncate(__m256i lo, __m256i hi) {
+  lo = _mm256_srai_epi32(_mm256_slli_epi32(lo, 16), 16);
+  hi = _mm256_srai_epi32(_mm256_slli_epi32(hi, 16), 16);
+  return _mm256_packs_epi32(lo, hi);
+}
+
+// Filter the data in the frequency domain, and create spectrum.
+static void PrepareSpectrumAvx2(NsxInst_t* inst, int16_t* freq_buf) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m128i shift_14 = _mm_cvtsi32_si128(14);
+  const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  int i = 0, j = 0;
+  int16_t tmp16 = 0;
+
+  // inst->real[i] = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(inst->real[i],
+  //     (int16_t)(inst->noiseSupFilter[i]), 14); // Q(normData-stages)
+  // and the same for inst->imag[i].
+  for (i = 0; i + 16 <= inst->magnLen; i += 16) {
+    const __m256i filter =
+        _mm256_loadu_si256((__m256i*)&inst->noiseSupFilter[i]);
+    __m256i lo, hi;
+    MulShift32(_mm256_loadu_si256((__m256i*)&inst->real[i]), filter, zero,
+               shift_14, &lo, &hi);
+    _mm256_storeu_si256((__m256i*)&inst->real[i], PackTruncate(lo, hi));
+    MulShift32(_mm256_loadu_si256((__m256i*)&inst->imag[i]), filter, zero,
+               shift_14, &lo, &hi);
+    _mm256_storeu_si256((__m256i*)&inst->imag[i], PackTruncate(lo, hi));
+  }
+  for (; i < inst->magnLen; i++) {
+    inst->real[i] = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(inst->real[i],
+        (int16_t)(inst->noiseSupFilter[i]), 14); // Q(normData-stages)
+    inst->imag[i] = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(inst->imag[i],
+        (int16_t)(inst->noiseSupFilter[i]), 14); // Q(normData-stages)
+  }
+
+  freq_buf[0] = inst->real[0];
+  freq_buf[1] = -inst->imag[0];
+  // Eight bins at a time. The conjugated bins are written from the end of
+  // the buffer, so their (real, imag) pairs are stored in reverse order.
+  for (i = 1, j = 2; i + 8 <= inst->anaLen2; i += 8, j += 16) {
+    const __m128i real = _mm_loadu_si128((__m128i*)&inst->real[i]);
+    const __m128i imag = _mm_loadu_si128((__m128i*)&inst->imag[i]);
+    const __m128i conj = _mm_sub_epi16(_mm_setzero_si128(), imag);
+    const __m256i spectrum = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_unpacklo_epi16(real, conj)),
+        _mm_unpackhi_epi16(real, conj), 1);
+    const __m256i pairs = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_unpacklo_epi16(real, imag)),
+        _mm_unpackhi_epi16(real, imag), 1);
+    tmp16 = (inst->anaLen << 1) - j;
+    _mm256_storeu_si256((__m256i*)&freq_buf[j], spectrum);
+    _mm256_storeu_si256((__m256i*)&freq_buf[tmp16 - 14],
+                        _mm256_permutevar8x32_epi32(pairs, reverse));
+  }
+  for (; i < inst->anaLen2; i += 1, j += 2) {
+    tmp16 = (inst->anaLen << 1) - j;
+    freq_buf[j] = inst->real[i];
+    freq_buf[j + 1] = -inst->imag[i];
+    freq_buf[tmp16] = inst->real[i];
+    freq_buf[tmp16 + 1] = inst->imag[i];
+  }
+  freq_buf[inst->anaLen] = inst->real[inst->anaLen2];
+  freq_buf[inst->anaLen + 1] = -inst->imag[inst->anaLen2];
+}
+
+// Denormalize the input buffer.
+static void DenormalizeAvx2(NsxInst_t* inst, int16_t* in, int factor) {
+  const int shift = factor - inst->normData;
+  const __m128i count = _mm_cvtsi32_si128(shift >= 0 ? shift : -shift);
+  int i = 0, j = 0;
+  int32_t tmp32 = 0;
+  for (i = 0, j = 0; i + 16 <= inst->anaLen; i += 16, j += 32) {
+    // Sign extend the real parts, which are the even elements of |in|.
+    __m256i lo = _mm256_loadu_si256((__m256i*)&in[j]);
+    __m256i hi = _mm256_loadu_si256((__m256i*)&in[j + 16]);
+    lo = _mm256_srai_epi32(_mm256_slli_epi32(lo, 16), 16);
+    hi = _mm256_srai_epi32(_mm256_slli_epi32(hi, 16), 16);
+    if (shift >= 0) {
+      lo = _mm256_sll_epi32(lo, count);
+      hi = _mm256_sll_epi32(hi, count);
+    } else {
+      lo = _mm256_sra_epi32(lo, count);
+      hi = _mm256_sra_epi32(hi, count);
+    }
+    // inst->real[i] = WebRtcSpl_SatW32ToW16(tmp32); // Q0
+    // The packing interleaves the 128 bit lanes of |lo| and |hi|, which the
+    // permutation puts back in order.
+    _mm256_storeu_si256((__m256i*)&inst->real[i], _mm256_permute4x64_epi64(
+        _mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0)));
+  }
+  for (; i < inst->anaLen; i += 1, j += 2) {
+    tmp32 = WEBRTC_SPL_SHIFT_W32((int32_t)in[j], shift);
+    inst->real[i] = WebRtcSpl_SatW32ToW16(tmp32); // Q0
+  }
+}
+
+// For the noise supression process, synthesis, read out fully processed
+// segment, and update synthesis buffer.
+static void SynthesisUpdateAvx2(NsxInst_t* inst,
+                                int16_t* out_frame,
+                                int16_t gain_factor) {
+  const __m256i gain = _mm256_set1_epi16(gain_factor);
+  const __m256i round_13 = _mm256_set1_epi32(1 << 12);
+  const __m256i round_14 = _mm256_set1_epi32(1 << 13);
+  const __m128i shift_13 = _mm_cvtsi32_si128(13);
+  const __m128i shift_14 = _mm_cvtsi32_si128(14);
+  int i = 0;
+  int16_t tmp16a = 0;
+  int16_t tmp16b = 0;
+  int32_t tmp32 = 0;
+
+  // synthesis
+  for (i = 0; i + 16 <= inst->anaLen; i += 16) {
+    __m256i lo, hi, tmp16;
+    // tmp16a = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(
+    //              inst->window[i], inst->real[i], 14); // Q0, window in Q14
+    MulShift32(_mm256_loadu_si256((__m256i*)&inst->window[i]),
+               _mm256_loadu_si256((__m256i*)&inst->real[i]),
+               round_14, shift_14, &lo, &hi);
+    tmp16 = PackTruncate(lo, hi);
+    // tmp32 = WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(tmp16a, gain_factor, 13);
+    // tmp16b = WebRtcSpl_SatW32ToW16(tmp32); // Q0
+    MulShift32(tmp16, gain, round_13, shift_13, &lo, &hi);
+    tmp16 = _mm256_packs_epi32(lo, hi);
+    _mm256_storeu_si256((__m256i*)&inst->synthesisBuffer[i],
+        _mm256_adds_epi16(
+            _mm256_loadu_si256((__m256i*)&inst->synthesisBuffer[i]), tmp16));
+  }
+  for (; i < inst->anaLen; i++) {
+    tmp16a = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(
+                 inst->window[i], inst->real[i], 14); // Q0, window in Q14
+    tmp32 = WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(tmp16a, gain_factor, 13); // Q0
+    // Down shift with rounding
+    tmp16b = WebRtcSpl_SatW32ToW16(tmp32); // Q0
+    inst->synthesisBuffer[i] = WEBRTC_SPL_ADD_SAT_W16(inst->synthesisBuffer[i],
+                                                      tmp16b); // Q0
+  }
+
+  // read out fully processed segment
+  WEBRTC_SPL_MEMCPY_W16(out_frame, inst->synthesisBuffer, inst->blockLen10ms);
+
+  // update synthesis buffer
+  WEBRTC_SPL_MEMCPY_W16(inst->synthesisBuffer,
+                        inst->synthesisBuffer + inst->blockLen10ms,
+                        inst->anaLen - inst->blockLen10ms);
+  WebRtcSpl_ZerosArrayW16(inst->synthesisBuffer
+      + inst->anaLen - inst->blockLen10ms, inst->blockLen10ms);
+}
+
+// Update analysis buffer for lower band, and window data before FFT.
+static void AnalysisUpdateAvx2(NsxInst_t* inst,
+                               int16_t* out,
+                               int16_t* new_speech) {
+  const __m256i round_14 = _mm256_set1_epi32(1 << 13);
+  const __m128i shift_14 = _mm_cvtsi32_si128(14);
+  int i = 0;
+
+  // For lower band update analysis buffer.
+  WEBRTC_SPL_MEMCPY_W16(inst->analysisBuffer,
+                        inst->analysisBuffer + inst->blockLen10ms,
+                        inst->anaLen - inst->blockLen10ms);
+  WEBRTC_SPL_MEMCPY_W16(inst->analysisBuffer
+      + inst->anaLen - inst->blockLen10ms, new_speech, inst->blockLen10ms);
+
+  // Window data before FFT.
+  for (i = 0; i + 16 <= inst->anaLen; i += 16) {
+    __m256i lo, hi;
+    MulShift32(_mm256_loadu_si256((__m256i*)&inst->window[i]),
+               _mm256_loadu_si256((__m256i*)&inst->analysisBuffer[i]),
+               round_14, shift_14, &lo, &hi);
+    _mm256_storeu_si256((__m256i*)&out[i], PackTruncate(lo, hi));
+  }
+  for (; i < inst->anaLen; i++) {
+    out[i] = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(
+               inst->window[i], inst->analysisBuffer[i], 14); // Q0
+  }
+}
+
+// Create a complex number buffer (out[]) as the intput (in[]) interleaved with
+// zeros, and normalize it.
+static void CreateComplexBufferAvx2(NsxInst_t* inst,
+                                    int16_t* in,
+                                    int16_t* out) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m128i count = _mm_cvtsi32_si128(inst->normData);
+  int i = 0, j = 0;
+  for (i = 0, j = 0; i + 16 <= inst->anaLen; i += 16, j += 32) {
+    // out[j] = WEBRTC_SPL_LSHIFT_W16(in[i], inst->normData); // Q(normData)
+    // out[j + 1] = 0; // Insert zeros in imaginary part
+    const __m256i real =
+        _mm256_sll_epi16(_mm256_loadu_si256((__m256i*)&in[i]), count);
+    const __m256i lo = _mm256_unpacklo_epi16(real, zero);
+    const __m256i hi = _mm256_unpackhi_epi16(real, zero);
+    // The unpacking works within 128 bit lanes; reorder the lanes.
+    _mm256_storeu_si256((__m256i*)&out[j],
+                        _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i*)&out[j + 16],
+                        _mm256_permute2x128_si256(lo, hi, 0x31));
+  }
+  for (; i < inst->anaLen; i += 1, j += 2) {
+    out[j] = WEBRTC_SPL_LSHIFT_W16(in[i], inst->normData); // Q(normData)
+    out[j + 1] = 0; // Insert zeros in imaginary part
+  }
+}
+
+void WebRtcNsx_InitAvx2(void) {
+  WebRtcNsx_PrepareSpectrum = PrepareSpectrumAvx2;
+  WebRtcNsx_SynthesisUpdate = SynthesisUpdateAvx2;
+  WebRtcNsx_AnalysisUpdate = AnalysisUpdateAvx2;
+  WebRtcNsx_Denormalize = DenormalizeAvx2;
+  WebRtcNsx_CreateComplexBuffer = CreateComplexBufferAvx2;
+}
@@ -0,0 +1,467 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The fixed point noise suppression, SSE2 version of speed-critical functions.
+ * All functions are bit exact with the generic C versions in nsx_core.c.
+ */
+
+#include "webrtc/modules/audio_processing/ns/nsx_core.h"
+
+#include <assert.h>
+#include <emmintrin.h>
+
+// Multiplies the 16 bit elements of |a| and |b| into 32 bit products, adds
+// |round| and shifts them down arithmetically by |shift|. |lo| gets the
+// results of the lower four elements, and |hi| of the upper four.
+static __inline void MulShift32(__m128i a,
+                                __m128i b,
+                                __m128i round,
+                                __m128i shift,
+                                __m128i* lo,
+                                __m128i* hi) {
+  const __m128i prod_lo = _mm_mullo_epi16(a, b);
+  const __m128i prod_hi = _mm_mulhi_epi16(a, b);
+  *lo = _mm_sra_epi32(_mm_add_epi32(_mm_unpacklo_epi16(prod_lo, prod_hi),
+                                    round), shift);
+  *hi = _mm_sra_epi32(_mm_add_epi32(_mm_unpackhi_epi16(prod_lo, prod_hi),
+                                    round), shift);
+}
+
+// Packs 32 bit elements into 16 bits keeping the low bits, like a C cast to
+// int16_t does.
+static __inline __m128i PackTruncate(__m128i lo, __m128i hi) {
+  lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+  hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+  return _mm_packs_epi32(lo, hi);
+}
+
+// Returns the elements of |a| where |mask| is set, and of |b| elsewhere.
+static __inline __m128i Select(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Updates the log quantile and density estimates of one frequency bin, for
+// the bins left over by the vectorized loop in NoiseEstimationSse2().
+static void UpdateQuantile(NsxInst_t* inst,
+                           int16_t lmagn,
+                           int16_t logval,
+                           int16_t countDiv,
+                           int16_t countProd,
+                           int i) {
+  const int16_t width_factor = 21845;
+  int16_t delta, tmp16, tmp16no1, tmp16no2;
+
+  // compute delta
+  if (inst->noiseEstDensity[i] > 512) {
+    // Get the value for delta by shifting intead of dividing.
+    int factor = WebRtcSpl_NormW16(inst->noiseEstDensity[i]);
+    delta = (int16_t)(FACTOR_Q16 >> (14 - factor));
+  } else {
+    delta = FACTOR_Q7;
+    if (inst->blockIndex < END_STARTUP_LONG) {
+      // Smaller step size during startup. This prevents from using
+      // unrealistic values causing overflow.
+      delta = FACTOR_Q7_STARTUP;
+    }
+  }
+
+  // update log quantile estimate
+  tmp16 = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(delta, countDiv, 14);
+  if (lmagn > inst->noiseEstLogQuantile[i]) {
+    // +=QUANTILE*delta/(inst->counter[s]+1) QUANTILE=0.25, =1 in Q2
+    // CounterDiv=1/(inst->counter[s]+1) in Q15
+    tmp16 += 2;
+    tmp16no1 = WEBRTC_SPL_RSHIFT_W16(tmp16, 2);
+    inst->noiseEstLogQuantile[i] += tmp16no1;
+  } else {
+    tmp16 += 1;
+    tmp16no1 = WEBRTC_SPL_RSHIFT_W16(tmp16, 1);
+    // *(1-QUANTILE), in Q2 QUANTILE=0.25, 1-0.25=0.75=3 in Q2
+    tmp16no2 = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(tmp16no1, 3, 1);
+    inst->noiseEstLogQuantile[i] -= tmp16no2;
+    if (inst->noiseEstLogQuantile[i] < logval) {
+      // This is the smallest fixed point representation we can
+      // have, hence we limit the output.
+      inst->noiseEstLogQuantile[i] = logval;
+    }
+  }
+
+  // update density estimate
+  if (WEBRTC_SPL_ABS_W16(lmagn - inst->noiseEstLogQuantile[i]) < WIDTH_Q8) {
+    tmp16no1 = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(
+                 inst->noiseEstDensity[i], countProd, 15);
+    tmp16no2 = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(
+                 width_factor, countDiv, 15);
+    inst->noiseEstDensity[i] = tmp16no1 + tmp16no2;
+  }
+}
+
+// Noise Estimation
+static void NoiseEstimationSse2(NsxInst_t* inst,
+                                uint16_t* magn,
+                                uint32_t* noise,
+                                int16_t* q_noise) {
+  int16_t lmagn[HALF_ANAL_BLOCKL], counter, countDiv;
+  int16_t countProd, zeros, frac;
+  int16_t log2, tabind, logval;
+  const int16_t log2_const = 22713; // Q15
+  const int16_t width_factor = 21845;
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i no_round = _mm_setzero_si128();
+  const __m128i shift_1 = _mm_cvtsi32_si128(1);
+  const __m128i shift_14 = _mm_cvtsi32_si128(14);
+  const __m128i shift_15 = _mm_cvtsi32_si128(15);
+  const __m128i round_15 = _mm_set1_epi32(1 << 14);
+  const __m128i three = _mm_set1_epi16(3);
+  const __m128i width_q8 = _mm_set1_epi16(WIDTH_Q8);
+  __m128i logval_8;
+  __m128i startup_delta;
+
+  int i, s, offset;
+
+  tabind = inst->stages - inst->normData;
+  assert(tabind < 9);
+  assert(tabind > -9);
+  if (tabind < 0) {
+    logval = -WebRtcNsx_kLogTable[-tabind];
+  } else {
+    logval = WebRtcNsx_kLogTable[tabind];
+  }
+  logval_8 = _mm_set1_epi16(logval);
+
+  // lmagn(i)=log(magn(i))=log(2)*log2(magn(i))
+  // magn is in Q(-stages), and the real lmagn values are:
+  // real_lmagn(i)=log(magn(i)*2^stages)=log(magn(i))+log(2^stages)
+  // lmagn in Q8
+  for (i = 0; i < inst->magnLen; i++) {
+    if (magn[i]) {
+      zeros = WebRtcSpl_NormU32((uint32_t)magn[i]);
+      frac = (int16_t)((((uint32_t)magn[i] << zeros)
+                              & 0x7FFFFFFF) >> 23);
+      // log2(magn(i))
+      assert(frac < 256);
+      log2 = (int16_t)(((31 - zeros) << 8)
+                             + WebRtcNsx_kLogTableFrac[frac]);
+      // log2(magn(i))*log(2)
+      lmagn[i] = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(log2, log2_const, 15);
+      // + log(2^stages)
+      lmagn[i] += logval;
+    } else {
+      lmagn[i] = logval;//0;
+    }
+  }
+
+  // Smaller step size during startup. This prevents from using unrealistic
+  // values causing overflow.
+  startup_delta = _mm_set1_epi16(inst->blockIndex < END_STARTUP_LONG ?
+                                 FACTOR_Q7_STARTUP : FACTOR_Q7);
+
+  // loop over simultaneous estimates
+  for (s = 0; s < SIMULT; s++) {
+    __m128i count_div;
+    __m128i count_prod;
+    __m128i width_term;
+
+    offset = s * inst->magnLen;
+
+    // Get counter values from state
+    counter = inst->noiseEstCounter[s];
+    assert(counter < 201);
+    countDiv = WebRtcNsx_kCounterDiv[counter];
+    countProd = (int16_t)WEBRTC_SPL_MUL_16_16(counter, countDiv);
+    count_div = _mm_set1_epi16(countDiv);
+    count_prod = _mm_set1_epi16(countProd);
+    width_term = _mm_set1_epi16((int16_t)WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(
+        width_factor, countDiv, 15));
+
+    // quant_est(...), eight frequency bins at a time.
+    for (i = 0; i + 8 <= inst->magnLen; i += 8) {
+      int16_t* quantile_ptr = &inst->noiseEstLogQuantile[offset + i];
+      int16_t* density_ptr = &inst->noiseEstDensity[offset + i];
+      const __m128i lmagn_8 = _mm_loadu_si128((__m128i*)&lmagn[i]);
+      const __m128i quantile = _mm_loadu_si128((__m128i*)quantile_ptr);
+      const __m128i density = _mm_loadu_si128((__m128i*)density_ptr);
+      __m128i delta, tmp16, up, down, new_quantile, new_density, diff;
+      __m128i lo, hi;
+
+      // compute delta
+      // For densities above 512, WebRtcSpl_NormW16() is k in
+      // [2^(14 - k), 2^(15 - k)), which selects FACTOR_Q16 >> (14 - k).
+      delta = Select(_mm_cmpgt_epi16(density, _mm_set1_epi16(512)),
+                     _mm_set1_epi16(FACTOR_Q16 >> 9), startup_delta);
+      delta = Select(_mm_cmpgt_epi16(density, _mm_set1_epi16(1023)),
+                     _mm_set1_epi16(FACTOR_Q16 >> 10), delta);
+      delta = Select(_mm_cmpgt_epi16(density, _mm_set1_epi16(2047)),
+                     _mm_set1_epi16(FACTOR_Q16 >> 11), delta);
+      delta = Select(_mm_cmpgt_epi16(density, _mm_set1_epi16(4095)),
+                     _mm_set1_epi16(FACTOR_Q16 >> 12), delta);
+      delta = Select(_mm_cmpgt_epi16(density, _mm_set1_epi16(8191)),
+                     _mm_set1_epi16(FACTOR_Q16 >> 13), delta);
+      delta = Select(_mm_cmpgt_epi16(density, _mm_set1_epi16(16383)),
+                     _mm_set1_epi16(FACTOR_Q16 >> 14), delta);
+
+      // update log quantile estimate
+      // tmp16 = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(delta, countDiv, 14);
+      MulShift32(delta, count_div, no_round, shift_14, &lo, &hi);
+      tmp16 = PackTruncate(lo, hi);
+
+      // Where lmagn[i] is above the quantile:
+      // quantile += (tmp16 + 2) >> 2;
+      up = _mm_add_epi16(quantile, _mm_srai_epi16(
+          _mm_add_epi16(tmp16, _mm_set1_epi16(2)), 2));
+
+      // Elsewhere:
+      // quantile -= ((tmp16 + 1) >> 1) * 3 >> 1, limited below by logval.
+      tmp16 = _mm_srai_epi16(_mm_add_epi16(tmp16, _mm_set1_epi16(1)), 1);
+      MulShift32(tmp16, three, no_round, shift_1, &lo, &hi);
+      down = _mm_max_epi16(_mm_sub_epi16(quantile, PackTruncate(lo, hi)),
+                           logval_8);
+
+      new_quantile = Select(_mm_cmpgt_epi16(lmagn_8, quantile), up, down);
+      _mm_storeu_si128((__m128i*)quantile_ptr, new_quantile);
+
+      // update density estimate
+      // The saturating subtractions keep the absolute difference at or above
+      // WIDTH_Q8 whenever the exact one is.
+      diff = _mm_subs_epi16(lmagn_8, new_quantile);
+      diff = _mm_max_epi16(diff, _mm_subs_epi16(zero, diff));
+      MulShift32(density, count_prod, round_15, shift_15, &lo, &hi);
+      new_density = _mm_add_epi16(PackTruncate(lo, hi), width_term);
+      _mm_storeu_si128((__m128i*)density_ptr,
+                       Select(_mm_cmpgt_epi16(width_q8, diff), new_density,
+                              density));
+    }
+    for (; i < inst->magnLen; i++) {
+      UpdateQuantile(inst, lmagn[i], logval, countDiv, countProd, offset + i);
+    }
+
+    if (counter >= END_STARTUP_LONG) {
+      inst->noiseEstCounter[s] = 0;
+      if (inst->blockIndex >= END_STARTUP_LONG) {
+        WebRtcNsx_UpdateNoiseEstimate(inst, offset);
+      }
+    }
+    inst->noiseEstCounter[s]++;
+
+  } // end loop over simultaneous estimates
+
+  // Sequentially update the noise during startup
+  if (inst->blockIndex < END_STARTUP_LONG) {
+    WebRtcNsx_UpdateNoiseEstimate(inst, offset);
+  }
+
+  // noise[i] = (uint32_t)(inst->noiseEstQuantile[i]); // Q(qNoise)
+  for (i = 0; i + 8 <= inst->magnLen; i += 8) {
+    const __m128i quantile =
+        _mm_loadu_si128((__m128i*)&inst->noiseEstQuantile[i]);
+    const __m128i sign = _mm_srai_epi16(quantile, 15);
+    _mm_storeu_si128((__m128i*)&noise[i], _mm_unpacklo_epi16(quantile, sign));
+    _mm_storeu_si128((__m128i*)&noise[i + 4],
+                     _mm_unpackhi_epi16(quantile, sign));
+  }
+  for (; i < inst->magnLen; i++) {
+    noise[i] = (uint32_t)(inst->noiseEstQuantile[i]); // Q(qNoise)
+  }
+  (*q_noise) = (int16_t)inst->qNoise;
+}
+
+// Filter the data in the frequency domain, and create spectrum.
+static void PrepareSpectrumSse2(NsxInst_t* inst, int16_t* freq_buf) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i shift_14 = _mm_cvtsi32_si128(14);
+  int i = 0, j = 0;
+  int16_t tmp16 = 0;
+
+  // inst->real[i] = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(inst->real[i],
+  //     (int16_t)(inst->noiseSupFilter[i]), 14); // Q(normData-stages)
+  // and the same for inst->imag[i].
+  for (i = 0; i + 8 <= inst->magnLen; i += 8) {
+    const __m128i filter =
+        _mm_loadu_si128((__m128i*)&inst->noiseSupFilter[i]);
+    __m128i lo, hi;
+    MulShift32(_mm_loadu_si128((__m128i*)&inst->real[i]), filter, zero,
+               shift_14, &lo, &hi);
+    _mm_storeu_si128((__m128i*)&inst->real[i], PackTruncate(lo, hi));
+    MulShift32(_mm_loadu_si128((__m128i*)&inst->imag[i]), filter, zero,
+               shift_14, &lo, &hi);
+    _mm_storeu_si128((__m128i*)&inst->imag[i], PackTruncate(lo, hi));
+  }
+  for (; i < inst->magnLen; i++) {
+    inst->real[i] = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(inst->real[i],
+        (int16_t)(inst->noiseSupFilter[i]), 14); // Q(normData-stages)
+    inst->imag[i] = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(inst->imag[i],
+        (int16_t)(inst->noiseSupFilter[i]), 14); // Q(normData-stages)
+  }
+
+  freq_buf[0] = inst->real[0];
+  freq_buf[1] = -inst->imag[0];
+  // Four bins at a time. The conjugated bins are written from the end of
+  // the buffer, so their (real, imag) pairs are stored in reverse order.
+  for (i = 1, j = 2; i + 4 <= inst->anaLen2; i += 4, j += 8) {
+    const __m128i real = _mm_loadl_epi64((__m128i*)&inst->real[i]);
+    const __m128i imag = _mm_loadl_epi64((__m128i*)&inst->imag[i]);
+    const __m128i pairs = _mm_unpacklo_epi16(real, imag);
+    tmp16 = (inst->anaLen << 1) - j;
+    _mm_storeu_si128((__m128i*)&freq_buf[j],
+                     _mm_unpacklo_epi16(real, _mm_sub_epi16(zero, imag)));
+    _mm_storeu_si128((__m128i*)&freq_buf[tmp16 - 6],
+                     _mm_shuffle_epi32(pairs, _MM_SHUFFLE(0, 1, 2, 3)));
+  }
+  for (; i < inst->anaLen2; i += 1, j += 2) {
+    tmp16 = (inst->anaLen << 1) - j;
+    freq_buf[j] = inst->real[i];
+    freq_buf[j + 1] = -inst->imag[i];
+    freq_buf[tmp16] = inst->real[i];
+    freq_buf[tmp16 + 1] = inst->imag[i];
+  }
+  freq_buf[inst->anaLen] = inst->real[inst->anaLen2];
+  freq_buf[inst->anaLen + 1] = -inst->imag[inst->anaLen2];
+}
+
+// Denormalize the input buffer.
+static void DenormalizeSse2(NsxInst_t* inst, int16_t* in, int factor) {
+  const int shift = factor - inst->normData;
+  const __m128i count = _mm_cvtsi32_si128(shift >= 0 ? shift : -shift);
+  int i = 0, j = 0;
+  int32_t tmp32 = 0;
+  for (i = 0, j = 0; i + 8 <= inst->anaLen; i += 8, j += 16) {
+    // Sign extend the real parts, which are the even elements of |in|.
+    __m128i lo = _mm_loadu_si128((__m128i*)&in[j]);
+    __m128i hi = _mm_loadu_si128((__m128i*)&in[j + 8]);
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+    if (shift >= 0) {
+      lo = _mm_sll_epi32(lo, count);
+      hi = _mm_sll_epi32(hi, count);
+    } else {
+      lo = _mm_sra_epi32(lo, count);
+      hi = _mm_sra_epi32(hi, count);
+    }
+    // inst->real[i] = WebRtcSpl_SatW32ToW16(tmp32); // Q0
+    _mm_storeu_si128((__m128i*)&inst->real[i], _mm_packs_epi32(lo, hi));
+  }
+  for (; i < inst->anaLen; i += 1, j += 2) {
+    tmp32 = WEBRTC_SPL_SHIFT_W32((int32_t)in[j], shift);
+    inst->real[i] = WebRtcSpl_SatW32ToW16(tmp32); // Q0
+  }
+}
+
+// For the noise supression process, synthesis, read out fully processed
+// segment, and update synthesis buffer.
+static void SynthesisUpdateSse2(NsxInst_t* inst,
+                                int16_t* out_frame,
+                                int16_t gain_factor) {
+  const __m128i gain = _mm_set1_epi16(gain_factor);
+  const __m128i round_13 = _mm_set1_epi32(1 << 12);
+  const __m128i round_14 = _mm_set1_epi32(1 << 13);
+  const __m128i shift_13 = _mm_cvtsi32_si128(13);
+  const __m128i shift_14 = _mm_cvtsi32_si128(14);
+  int i = 0;
+  int16_t tmp16a = 0;
+  int16_t tmp16b = 0;
+  int32_t tmp32 = 0;
+
+  // synthesis
+  for (i = 0; i + 8 <= inst->anaLen; i += 8) {
+    __m128i lo, hi, tmp16;
+    // tmp16a = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(
+    //              inst->window[i], inst->real[i], 14); // Q0, window in Q14
+    MulShift32(_mm_loadu_si128((__m128i*)&inst->window[i]),
+               _mm_loadu_si128((__m128i*)&inst->real[i]),
+               round_14, shift_14, &lo, &hi);
+    tmp16 = PackTruncate(lo, hi);
+    // tmp32 = WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(tmp16a, gain_factor, 13);
+    // tmp16b = WebRtcSpl_SatW32ToW16(tmp32); // Q0
+    MulShift32(tmp16, gain, round_13, shift_13, &lo, &hi);
+    tmp16 = _mm_packs_epi32(lo, hi);
+    _mm_storeu_si128((__m128i*)&inst->synthesisBuffer[i], _mm_adds_epi16(
+        _mm_loadu_si128((__m128i*)&inst->synthesisBuffer[i]), tmp16));
+  }
+  for (; i < inst->anaLen; i++) {
+    tmp16a = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(
+                 inst->window[i], inst->real[i], 14); // Q0, window in Q14
+    tmp32 = WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(tmp16a, gain_factor, 13); // Q0
+    // Down shift with rounding
+    tmp16b = WebRtcSpl_SatW32ToW16(tmp32); // Q0
+    inst->synthesisBuffer[i] = WEBRTC_SPL_ADD_SAT_W16(inst->synthesisBuffer[i],
+                                                      tmp16b); // Q0
+  }
+
+  // read out fully processed segment
+  WEBRTC_SPL_MEMCPY_W16(out_frame, inst->synthesisBuffer, inst->blockLen10ms);
+
+  // update synthesis buffer
+  WEBRTC_SPL_MEMCPY_W16(inst->synthesisBuffer,
+                        inst->synthesisBuffer + inst->blockLen10ms,
+                        inst->anaLen - inst->blockLen10ms);
+  WebRtcSpl_ZerosArrayW16(inst->synthesisBuffer
+      + inst->anaLen - inst->blockLen10ms, inst->blockLen10ms);
+}
+
+// Update analysis buffer for lower band, and window data before FFT.
+static void AnalysisUpdateSse2(NsxInst_t* inst,
+                               int16_t* out,
+                               int16_t* new_speech) {
+  const __m128i round_14 = _mm_set1_epi32(1 << 13);
+  const __m128i shift_14 = _mm_cvtsi32_si128(14);
+  int i = 0;
+
+  // For lower band update analysis buffer.
+  WEBRTC_SPL_MEMCPY_W16(inst->analysisBuffer,
+                        inst->analysisBuffer + inst->blockLen10ms,
+                        inst->anaLen - inst->blockLen10ms);
+  WEBRTC_SPL_MEMCPY_W16(inst->analysisBuffer
+      + inst->anaLen - inst->blockLen10ms, new_speech, inst->blockLen10ms);
+
+  // Window data before FFT.
+  for (i = 0; i + 8 <= inst->anaLen; i += 8) {
+    __m128i lo, hi;
+    MulShift32(_mm_loadu_si128((__m128i*)&inst->window[i]),
+               _mm_loadu_si128((__m128i*)&inst->analysisBuffer[i]),
+               round_14, shift_14, &lo, &hi);
+    _mm_storeu_si128((__m128i*)&out[i], PackTruncate(lo, hi));
+  }
+  for (; i < inst->anaLen; i++) {
+    out[i] = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(
+               inst->window[i], inst->analysisBuffer[i], 14); // Q0
+  }
+}
+
+// Create a complex number buffer (out[]) as the intput (in[]) interleaved with
+// zeros, and normalize it.
+static void CreateComplexBufferSse2(NsxInst_t* inst,
+                                    int16_t* in,
+                                    int16_t* out) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i count = _mm_cvtsi32_si128(inst->normData);
+  int i = 0, j = 0;
+  for (i = 0, j = 0; i + 8 <= inst->anaLen; i += 8, j += 16) {
+    // out[j] = WEBRTC_SPL_LSHIFT_W16(in[i], inst->normData); // Q(normData)
+    // out[j + 1] = 0; // Insert zeros in imaginary part
+    const __m128i real =
+        _mm_sll_epi16(_mm_loadu_si128((__m128i*)&in[i]), count);
+    _mm_storeu_si128((__m128i*)&out[j], _mm_unpacklo_epi16(real, zero));
+    _mm_storeu_si128((__m128i*)&out[j + 8], _mm_unpackhi_epi16(real, zero));
+  }
+  for (; i < inst->anaLen; i += 1, j += 2) {
+    out[j] = WEBRTC_SPL_LSHIFT_W16(in[i], inst->normData); // Q(normData)
+    out[j + 1] = 0; // Insert zeros in imaginary part
+  }
+}
+
+void WebRtcNsx_InitSse2(void) {
+  WebRtcNsx_NoiseEstimation = NoiseEstimationSse2;
+  WebRtcNsx_PrepareSpectrum = PrepareSpectrumSse2;
+  WebRtcNsx_SynthesisUpdate = SynthesisUpdateSse2;
+  WebRtcNsx_AnalysisUpdate = AnalysisUpdateSse2;
+  WebRtcNsx_Denormalize = DenormalizeSse2;
+  WebRtcNsx_CreateComplexBuffer = CreateComplexBufferSse2;
+}
@@ -0,0 +1,255 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/audio_processing/ns/include/noise_suppression_x.h"
+#include "webrtc/modules/audio_processing/ns/nsx_core.h"
+#include "webrtc/modules/audio_processing/test/cpu_features_test_helper.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+
+namespace webrtc {
+namespace {
+
+const int kSampleRates[] = { 8000, 16000, 32000 };
+const int kNumTrials = 20;
+
+// The functions WebRtcNsx_InitCore() selects.
+struct NsxFunctions {
+  NoiseEstimation noise_estimation;
+  PrepareSpectrum prepare_spectrum;
+  SynthesisUpdate synthesis_update;
+  AnalysisUpdate analysis_update;
+  Denormalize denormalize;
+  CreateComplexBuffer create_complex_buffer;
+};
+
+class NsxCoreTest : public ::testing::Test {
+ protected:
+  NsxCoreTest() : handle_(NULL), inst_(NULL) {}
+
+  virtual void SetUp() {
+    srand(42);
+    ASSERT_EQ(0, WebRtcNsx_Create(&handle_));
+    inst_ = reinterpret_cast<NsxInst_t*>(handle_);
+    c_ = SelectFunctions(WebRtc_GetCPUInfoNoASM);
+  }
+
+  virtual void TearDown() {
+    EXPECT_EQ(0, WebRtcNsx_Free(handle_));
+  }
+
+  // Initializes |inst_| as if the CPU had the features reported by
+  // |cpu_info|, and returns the functions selected for it.
+  NsxFunctions SelectFunctions(WebRtc_CPUInfo cpu_info) {
+    ScopedCPUInfo scoped_cpu_info(cpu_info);
+    EXPECT_EQ(0, WebRtcNsx_Init(handle_, 16000));
+    NsxFunctions functions;
+    functions.noise_estimation = WebRtcNsx_NoiseEstimation;
+    functions.prepare_spectrum = WebRtcNsx_PrepareSpectrum;
+    functions.synthesis_update = WebRtcNsx_SynthesisUpdate;
+    functions.analysis_update = WebRtcNsx_AnalysisUpdate;
+    functions.denormalize = WebRtcNsx_Denormalize;
+    functions.create_complex_buffer = WebRtcNsx_CreateComplexBuffer;
+    return functions;
+  }
+
+  // Sets up |inst_| for |sample_rate_hz| with random signal and estimator
+  // state.
+  void RandomizeInstance(int sample_rate_hz) {
+    ASSERT_EQ(0, WebRtcNsx_Init(handle_, sample_rate_hz));
+    inst_->normData = RandomInRange(0, 15);
+    inst_->blockIndex = RandomInRange(END_STARTUP_LONG - 5,
+                                      END_STARTUP_LONG + 5);
+    FillRandom(inst_->analysisBuffer, ANAL_BLOCKL_MAX);
+    FillRandom(inst_->synthesisBuffer, ANAL_BLOCKL_MAX);
+    FillRandom(inst_->real, ANAL_BLOCKL_MAX);
+    FillRandom(inst_->imag, ANAL_BLOCKL_MAX);
+    FillRandom(reinterpret_cast<int16_t*>(inst_->noiseSupFilter),
+               HALF_ANAL_BLOCKL);
+    FillRandom(inst_->noiseEstDensity, SIMULT * HALF_ANAL_BLOCKL);
+    for (int i = 0; i < SIMULT * HALF_ANAL_BLOCKL; ++i) {
+      inst_->noiseEstLogQuantile[i] =
+          static_cast<int16_t>(RandomInRange(-2000, 8000));
+    }
+    for (int s = 0; s < SIMULT; ++s) {
+      inst_->noiseEstCounter[s] = static_cast<int16_t>(
+          RandomInRange(END_STARTUP_LONG - 2, END_STARTUP_LONG));
+    }
+  }
+
+  // Returns true if the parts of |a| and |b| the functions write are equal.
+  static bool InstancesEqual(const NsxInst_t& a, const NsxInst_t& b) {
+    return a.qNoise == b.qNoise &&
+        memcmp(a.analysisBuffer, b.analysisBuffer,
+               sizeof(a.analysisBuffer)) == 0 &&
+        memcmp(a.synthesisBuffer, b.synthesisBuffer,
+               sizeof(a.synthesisBuffer)) == 0 &&
+        memcmp(a.noiseEstLogQuantile, b.noiseEstLogQuantile,
+               sizeof(a.noiseEstLogQuantile)) == 0 &&
+        memcmp(a.noiseEstDensity, b.noiseEstDensity,
+               sizeof(a.noiseEstDensity)) == 0 &&
+        memcmp(a.noiseEstCounter, b.noiseEstCounter,
+               sizeof(a.noiseEstCounter)) == 0 &&
+        memcmp(a.noiseEstQuantile, b.noiseEstQuantile,
+               sizeof(a.noiseEstQuantile)) == 0 &&
+        memcmp(a.real, b.real, sizeof(a.real)) == 0 &&
+        memcmp(a.imag, b.imag, sizeof(a.imag)) == 0;
+  }
+
+  // Runs each function of |optimized| and of the C versions on the same
+  // random input, and expects identical results.
+  void VerifyBitExact(const NsxFunctions& optimized) {
+    const int kBufferLength = ANAL_BLOCKL_MAX * 2 + 16;
+    for (size_t r = 0; r < sizeof(kSampleRates) / sizeof(*kSampleRates);
+         ++r) {
+      for (int trial = 0; trial < kNumTrials; ++trial) {
+        SCOPED_TRACE(testing::Message() << "sample rate " << kSampleRates[r]
+                                        << ", trial " << trial);
+        RandomizeInstance(kSampleRates[r]);
+        NsxInst_t expected = *inst_;
+        NsxInst_t actual = *inst_;
+        int16_t input[kBufferLength];
+        int16_t expected_output[kBufferLength];
+        int16_t actual_output[kBufferLength];
+        FillRandom(input, kBufferLength);
+        FillRandom(expected_output, kBufferLength);
+        memcpy(actual_output, expected_output, sizeof(actual_output));
+
+        uint16_t magn[HALF_ANAL_BLOCKL];
+        uint32_t expected_noise[HALF_ANAL_BLOCKL];
+        uint32_t actual_noise[HALF_ANAL_BLOCKL];
+        int16_t expected_q_noise = 0;
+        int16_t actual_q_noise = 0;
+        FillRandom(reinterpret_cast<int16_t*>(magn), HALF_ANAL_BLOCKL);
+        c_.noise_estimation(&expected, magn, expected_noise,
+                            &expected_q_noise);
+        optimized.noise_estimation(&actual, magn, actual_noise,
+                                   &actual_q_noise);
+        EXPECT_TRUE(InstancesEqual(expected, actual));
+        EXPECT_EQ(0, memcmp(expected_noise, actual_noise,
+                            inst_->magnLen * sizeof(*expected_noise)));
+        EXPECT_EQ(expected_q_noise, actual_q_noise);
+
+        c_.prepare_spectrum(&expected, expected_output);
+        optimized.prepare_spectrum(&actual, actual_output);
+        EXPECT_TRUE(InstancesEqual(expected, actual));
+        EXPECT_EQ(0, memcmp(expected_output, actual_output,
+                            sizeof(expected_output)));
+
+        const int factor = RandomInRange(0, 15);
+        c_.denormalize(&expected, input, factor);
+        optimized.denormalize(&actual, input, factor);
+        EXPECT_TRUE(InstancesEqual(expected, actual));
+
+        const int16_t gain_factor = RandomW16();
+        c_.synthesis_update(&expected, expected_output, gain_factor);
+        optimized.synthesis_update(&actual, actual_output, gain_factor);
+        EXPECT_TRUE(InstancesEqual(expected, actual));
+        EXPECT_EQ(0, memcmp(expected_output, actual_output,
+                            sizeof(expected_output)));
+
+        c_.analysis_update(&expected, expected_output, input);
+        optimized.analysis_update(&actual, actual_output, input);
+        EXPECT_TRUE(InstancesEqual(expected, actual));
+        EXPECT_EQ(0, memcmp(expected_output, actual_output,
+                            sizeof(expected_output)));
+
+        c_.create_complex_buffer(&expected, input, expected_output);
+        optimized.create_complex_buffer(&actual, input, actual_output);
+        EXPECT_EQ(0, memcmp(expected_output, actual_output,
+                            sizeof(expected_output)));
+      }
+    }
+  }
+
+  // Runs noise suppression on a noisy tone with the functions selected for
+  // |cpu_info|, and returns the output.
+  std::vector<int16_t> Suppress(WebRtc_CPUInfo cpu_info,
+                                int sample_rate_hz,
+                                int policy) {
+    const int kNumFrames = 300;
+    const int samples_per_frame = sample_rate_hz == 8000 ? 80 : 160;
+    {
+      ScopedCPUInfo scoped_cpu_info(cpu_info);
+      EXPECT_EQ(0, WebRtcNsx_Init(handle_, sample_rate_hz));
+    }
+    EXPECT_EQ(0, WebRtcNsx_set_policy(handle_, policy));
+    srand(17);
+    std::vector<int16_t> output;
+    for (int n = 0; n < kNumFrames; ++n) {
+      short low[160];
+      short high[160];
+      short out_low[160];
+      short out_high[160];
+      for (int i = 0; i < samples_per_frame; ++i) {
+        // A square wave which pauses every other second, in noise.
+        const int t = n * samples_per_frame + i;
+        const int tone = (n / 100) % 2 == 0 && (t / 20) % 2 == 0 ? 4000 : 0;
+        low[i] = static_cast<short>(tone + RandomInRange(-1000, 1000));
+        high[i] = static_cast<short>(RandomInRange(-500, 500));
+      }
+      EXPECT_EQ(0, WebRtcNsx_Process(handle_, low,
+                                     sample_rate_hz == 32000 ? high : NULL,
+                                     out_low, out_high));
+      output.insert(output.end(), out_low, out_low + samples_per_frame);
+      if (sample_rate_hz == 32000) {
+        output.insert(output.end(), out_high, out_high + samples_per_frame);
+      }
+    }
+    return output;
+  }
+
+  void VerifyProcessingBitExact(WebRtc_CPUInfo cpu_info) {
+    for (size_t r = 0; r < sizeof(kSampleRates) / sizeof(*kSampleRates);
+         ++r) {
+      for (int policy = 0; policy < 3; ++policy) {
+        SCOPED_TRACE(testing::Message() << "sample rate " << kSampleRates[r]
+                                        << ", policy " << policy);
+        EXPECT_TRUE(Suppress(WebRtc_GetCPUInfoNoASM, kSampleRates[r],
+                             policy) ==
+                    Suppress(cpu_info, kSampleRates[r], policy));
+      }
+    }
+  }
+
+  NsxHandle* handle_;
+  NsxInst_t* inst_;
+  NsxFunctions c_;
+};
+
+TEST_F(NsxCoreTest, Sse2FunctionsAreBitExact) {
+  if (!WebRtc_GetCPUInfo(kSSE2)) {
+    printf("Skipping test, the CPU does not support SSE2.\n");
+    return;
+  }
+  const NsxFunctions sse2 = SelectFunctions(GetCPUInfoSse2Only);
+  EXPECT_NE(c_.noise_estimation, sse2.noise_estimation);
+  VerifyBitExact(sse2);
+  VerifyProcessingBitExact(GetCPUInfoSse2Only);
+}
+
+TEST_F(NsxCoreTest, Avx2FunctionsAreBitExact) {
+  if (!WebRtc_GetCPUInfo(kAVX2)) {
+    printf("Skipping test, the CPU does not support AVX2.\n");
+    return;
+  }
+  const NsxFunctions avx2 = SelectFunctions(WebRtc_GetCPUInfo);
+  VerifyBitExact(avx2);
+  VerifyProcessingBitExact(WebRtc_GetCPUInfo);
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/render_queue.h"
+
+#include <assert.h>
+
+namespace webrtc {
+
+RenderQueue::RenderQueue(int capacity)
+    : capacity_(capacity),
+      frames_(new RenderFrame[capacity]),
+      write_index_(0),
+      read_index_(0),
+      size_(0) {
+  assert(capacity > 0);
+}
+
+RenderQueue::~RenderQueue() {}
+
+RenderFrame* RenderQueue::back() {
+  if (size_.AcquireLoad() == capacity_) {
+    return NULL;
+  }
+  return &frames_[write_index_];
+}
+
+void RenderQueue::PushBack() {
+  write_index_ = (write_index_ + 1) % capacity_;
+  // The increment is a full barrier, so the frame is written before the
+  // consumer can see it.
+  ++size_;
+}
+
+const RenderFrame* RenderQueue::front() {
+  if (size_.AcquireLoad() == 0) {
+    return NULL;
+  }
+  return &frames_[read_index_];
+}
+
+void RenderQueue::PopFront() {
+  read_index_ = (read_index_ + 1) % capacity_;
+  // The frame is read before the producer can reuse it.
+  --size_;
+}
+
+void RenderQueue::Clear() {
+  while (front() != NULL) {
+    PopFront();
+  }
+}
+}  // namespace webrtc
@@ -0,0 +1,84 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_RENDER_QUEUE_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_RENDER_QUEUE_H_
+
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// The split band far-end audio of one 10 ms frame, as used by the AEC, AECM
+// and AGC.
+struct RenderFrame {
+  enum {
+    kMaxChannels = 2,
+    kMaxSamplesPerSplitChannel = 160
+  };
+
+  // Returns the mono mix of the channels.
+  const int16_t* mixed_low_pass_data() const {
+    return num_channels > 1 ? mixed_low_pass : low_pass[0];
+  }
+
+  int num_channels;
+  int samples_per_split_channel;
+  // Whether |low_pass_f| holds the bands of a frame copied in as float, for
+  // the components with a float implementation. The int16 bands are always
+  // filled.
+  bool is_float;
+  int16_t low_pass[kMaxChannels][kMaxSamplesPerSplitChannel];
+  float low_pass_f[kMaxChannels][kMaxSamplesPerSplitChannel];
+  // Only filled when there is more than one channel.
+  int16_t mixed_low_pass[kMaxSamplesPerSplitChannel];
+};
+
+// Passes RenderFrames from the render thread to the capture thread without
+// locking. There may be at most one producer and one consumer at a time.
+// Frames are filled and read in place in a fixed ring, so nothing is
+// allocated after construction.
+class RenderQueue {
+ public:
+  explicit RenderQueue(int capacity);
+  ~RenderQueue();
+
+  // Producer side. Returns the frame to fill, or NULL if the queue is full.
+  // The frame is made visible to the consumer by PushBack(), which may only
+  // follow a non-NULL back().
+  RenderFrame* back();
+  void PushBack();
+
+  // Consumer side. Returns the oldest frame, or NULL if the queue is empty.
+  // The frame stays valid until PopFront(), which may only follow a non-NULL
+  // front().
+  const RenderFrame* front();
+  void PopFront();
+
+  // Drops all frames. Neither side may be used concurrently.
+  void Clear();
+
+ private:
+  const int capacity_;
+  scoped_array<RenderFrame> frames_;
+  // Only accessed by the producer.
+  int write_index_;
+  // Only accessed by the consumer.
+  int read_index_;
+  // Number of pushed frames not yet popped.
+  Atomic32 size_;
+
+  DISALLOW_COPY_AND_ASSIGN(RenderQueue);
+};
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_RENDER_QUEUE_H_
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/render_queue.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+
+namespace webrtc {
+namespace {
+
+const int kCapacity = 4;
+
+void FillFrame(int value, RenderFrame* frame) {
+  frame->num_channels = 1;
+  frame->is_float = false;
+  frame->samples_per_split_channel = RenderFrame::kMaxSamplesPerSplitChannel;
+  for (int i = 0; i < RenderFrame::kMaxSamplesPerSplitChannel; ++i) {
+    frame->low_pass[0][i] = static_cast<int16_t>(value);
+  }
+}
+
+bool FrameHasValue(const RenderFrame& frame, int value) {
+  for (int i = 0; i < frame.samples_per_split_channel; ++i) {
+    if (frame.low_pass[0][i] != static_cast<int16_t>(value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Push(RenderQueue* queue, int value) {
+  RenderFrame* frame = queue->back();
+  if (frame == NULL) {
+    return false;
+  }
+  FillFrame(value, frame);
+  queue->PushBack();
+  return true;
+}
+
+struct ConsumerState {
+  ConsumerState() : queue(NULL), next_value(0), bad_frames(0) {}
+  RenderQueue* queue;
+  int next_value;
+  Atomic32 bad_frames;
+};
+
+void PopAll(ConsumerState* state) {
+  const RenderFrame* frame = state->queue->front();
+  while (frame != NULL) {
+    if (!FrameHasValue(*frame, state->next_value)) {
+      ++state->bad_frames;
+    }
+    ++state->next_value;
+    state->queue->PopFront();
+    frame = state->queue->front();
+  }
+}
+
+// Wakes up every 10 ms like a capture thread.
+bool Consume(void* obj) {
+  PopAll(static_cast<ConsumerState*>(obj));
+  SleepMs(10);
+  return true;
+}
+
+TEST(RenderQueueTest, EmptyQueueHasNoFront) {
+  RenderQueue queue(kCapacity);
+  EXPECT_TRUE(queue.front() == NULL);
+  // A frame being filled is not visible until pushed.
+  ASSERT_TRUE(queue.back() != NULL);
+  EXPECT_TRUE(queue.front() == NULL);
+}
+
+TEST(RenderQueueTest, FramesComeOutInOrder) {
+  RenderQueue queue(kCapacity);
+  int next_value = 0;
+  for (int i = 0; i < 3 * kCapacity; ++i) {
+    ASSERT_TRUE(Push(&queue, i));
+    if (i % 2 == 1) {
+      // Drain every other frame so the indices wrap around.
+      while (queue.front() != NULL) {
+        EXPECT_TRUE(FrameHasValue(*queue.front(), next_value));
+        ++next_value;
+        queue.PopFront();
+      }
+    }
+  }
+  EXPECT_EQ(3 * kCapacity, next_value);
+}
+
+TEST(RenderQueueTest, FullQueueHasNoBack) {
+  RenderQueue queue(kCapacity);
+  for (int i = 0; i < kCapacity; ++i) {
+    ASSERT_TRUE(Push(&queue, i));
+  }
+  EXPECT_TRUE(queue.back() == NULL);
+  queue.PopFront();
+  EXPECT_TRUE(Push(&queue, kCapacity));
+  EXPECT_TRUE(FrameHasValue(*queue.front(), 1));
+}
+
+TEST(RenderQueueTest, ClearDropsFrames) {
+  RenderQueue queue(kCapacity);
+  ASSERT_TRUE(Push(&queue, 1));
+  ASSERT_TRUE(Push(&queue, 2));
+  queue.Clear();
+  EXPECT_TRUE(queue.front() == NULL);
+  ASSERT_TRUE(Push(&queue, 3));
+  EXPECT_TRUE(FrameHasValue(*queue.front(), 3));
+}
+
+TEST(RenderQueueTest, ConsumerThreadSeesCompleteFrames) {
+  const int kQueueCapacity = 10;
+  const int kNumFrames = 500;
+  RenderQueue queue(kQueueCapacity);
+  ConsumerState state;
+  state.queue = &queue;
+  scoped_ptr<ThreadWrapper> thread(
+      ThreadWrapper::CreateThread(&Consume, &state));
+  unsigned int id = 0;
+  ASSERT_TRUE(thread->Start(id));
+  for (int i = 0; i < kNumFrames; ++i) {
+    while (!Push(&queue, i)) {
+      SleepMs(1);
+    }
+  }
+  EXPECT_TRUE(thread->Stop());
+  // This thread is now the only consumer; take what is left.
+  PopAll(&state);
+  EXPECT_EQ(kNumFrames, state.next_value);
+  EXPECT_EQ(0, state.bad_frames.Value());
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -30,4 +30,89 @@ void SplittingFilterSynthesis(const int16_t* low_band,
 {
     WebRtcSpl_SynthesisQMF(low_band, high_band, out_data, filt_state1, filt_state2);
 }
+
+namespace {
+
+// Number of samples in a low/high-band frame.
+const int kBandFrameLength = 160;
+
+// The all-pass coefficients of WebRtcSpl_AnalysisQMF() and
+// WebRtcSpl_SynthesisQMF(), converted from Q16.
+const float kAllPassFilter1[3] = {
+    6418.f / 65536, 36982.f / 65536, 57261.f / 65536};
+const float kAllPassFilter2[3] = {
+    21333.f / 65536, 49062.f / 65536, 63010.f / 65536};
+
+// Filters |data| in place with three cascaded first order all-pass filters,
+// as WebRtcSpl_AllPassQMF(). |filter_state| holds the last input and output
+// of each filter.
+void AllPassQMF(float* data, int data_length, const float* coefficients,
+                float* filter_state) {
+  for (int j = 0; j < 3; ++j) {
+    float* state = &filter_state[2 * j];
+    float last_in = state[0];
+    float last_out = state[1];
+    for (int k = 0; k < data_length; ++k) {
+      // y[n] = x[n-1] + a * (x[n] - y[n-1])
+      const float in = data[k];
+      last_out = last_in + coefficients[j] * (in - last_out);
+      last_in = in;
+      data[k] = last_out;
+    }
+    state[0] = last_in;
+    state[1] = last_out;
+  }
+}
+
+}  // namespace
+
+void SplittingFilterAnalysis(const float* in_data,
+                             float* low_band,
+                             float* high_band,
+                             float* filter_state1,
+                             float* filter_state2) {
+  float half_in1[kBandFrameLength];
+  float half_in2[kBandFrameLength];
+
+  // Split even and odd samples.
+  for (int i = 0, k = 0; i < kBandFrameLength; ++i, k += 2) {
+    half_in2[i] = in_data[k];
+    half_in1[i] = in_data[k + 1];
+  }
+
+  // All pass filter even and odd samples, independently.
+  AllPassQMF(half_in1, kBandFrameLength, kAllPassFilter1, filter_state1);
+  AllPassQMF(half_in2, kBandFrameLength, kAllPassFilter2, filter_state2);
+
+  // Take the sum and difference of the filtered odd and even branches to get
+  // the lower and upper band.
+  for (int i = 0; i < kBandFrameLength; ++i) {
+    low_band[i] = 0.5f * (half_in1[i] + half_in2[i]);
+    high_band[i] = 0.5f * (half_in1[i] - half_in2[i]);
+  }
+}
+
+void SplittingFilterSynthesis(const float* low_band,
+                              const float* high_band,
+                              float* out_data,
+                              float* filter_state1,
+                              float* filter_state2) {
+  float half_in1[kBandFrameLength];
+  float half_in2[kBandFrameLength];
+
+  // Obtain the sum and difference channels from the lower and upper bands.
+  for (int i = 0; i < kBandFrameLength; ++i) {
+    half_in1[i] = low_band[i] + high_band[i];
+    half_in2[i] = low_band[i] - high_band[i];
+  }
+
+  AllPassQMF(half_in1, kBandFrameLength, kAllPassFilter2, filter_state1);
+  AllPassQMF(half_in2, kBandFrameLength, kAllPassFilter1, filter_state2);
+
+  // The filtered signals are the even and odd samples of the output.
+  for (int i = 0, k = 0; i < kBandFrameLength; ++i) {
+    out_data[k++] = half_in2[i];
+    out_data[k++] = half_in1[i];
+  }
+}
 }  // namespace webrtc
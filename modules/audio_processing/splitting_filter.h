@@ -58,6 +58,23 @@ void SplittingFilterSynthesis(const int16_t* low_band,
                               int16_t* out_data,
                               int32_t* filt_state1,
                               int32_t* filt_state2);
+
+// Float versions of the functions above, for samples in the int16 range. The
+// filter states are float arrays of length kSplittingFilterStateLength, and
+// are not compatible with the states of the int16 versions.
+enum { kSplittingFilterStateLength = 6 };
+
+void SplittingFilterAnalysis(const float* in_data,
+                             float* low_band,
+                             float* high_band,
+                             float* filt_state1,
+                             float* filt_state2);
+
+void SplittingFilterSynthesis(const float* low_band,
+                              const float* high_band,
+                              float* out_data,
+                              float* filt_state1,
+                              float* filt_state2);
 }  // namespace webrtc
 
 #endif  // WEBRTC_MODULES_AUDIO_PROCESSING_MAIN_SOURCE_SPLITTING_FILTER_H_
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/audio_processing/splitting_filter.h"
+
+namespace webrtc {
+namespace {
+
+const int kSamplesPer32kHzChannel = 320;
+const int kSamplesPerBand = 160;
+const int kNumFrames = 20;
+const double kPi = 3.14159265358979323846;
+
+// A 1 kHz and a 12 kHz tone, one in each band.
+void GenerateFrame(int frame, int16_t* data_int, float* data_float) {
+  for (int i = 0; i < kSamplesPer32kHzChannel; ++i) {
+    const double t = (frame * kSamplesPer32kHzChannel + i) / 32000.0;
+    data_int[i] = static_cast<int16_t>(8000 * sin(2 * kPi * 1000 * t) +
+                                       4000 * sin(2 * kPi * 12000 * t));
+    data_float[i] = data_int[i];
+  }
+}
+
+}  // namespace
+
+TEST(SplittingFilterTest, FloatMatchesInt16) {
+  int32_t analysis_state_int[2][6];
+  int32_t synthesis_state_int[2][6];
+  float analysis_state_float[2][kSplittingFilterStateLength];
+  float synthesis_state_float[2][kSplittingFilterStateLength];
+  memset(analysis_state_int, 0, sizeof(analysis_state_int));
+  memset(synthesis_state_int, 0, sizeof(synthesis_state_int));
+  memset(analysis_state_float, 0, sizeof(analysis_state_float));
+  memset(synthesis_state_float, 0, sizeof(synthesis_state_float));
+
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    int16_t data_int[kSamplesPer32kHzChannel];
+    float data_float[kSamplesPer32kHzChannel];
+    GenerateFrame(frame, data_int, data_float);
+
+    int16_t low_int[kSamplesPerBand];
+    int16_t high_int[kSamplesPerBand];
+    float low_float[kSamplesPerBand];
+    float high_float[kSamplesPerBand];
+    SplittingFilterAnalysis(data_int, low_int, high_int,
+                            analysis_state_int[0], analysis_state_int[1]);
+    SplittingFilterAnalysis(data_float, low_float, high_float,
+                            analysis_state_float[0], analysis_state_float[1]);
+    for (int i = 0; i < kSamplesPerBand; ++i) {
+      // The int16 version rounds each band.
+      EXPECT_NEAR(low_int[i], low_float[i], 1.f);
+      EXPECT_NEAR(high_int[i], high_float[i], 1.f);
+    }
+
+    SplittingFilterSynthesis(low_int, high_int, data_int,
+                             synthesis_state_int[0], synthesis_state_int[1]);
+    SplittingFilterSynthesis(low_float, high_float, data_float,
+                             synthesis_state_float[0],
+                             synthesis_state_float[1]);
+    for (int i = 0; i < kSamplesPer32kHzChannel; ++i) {
+      EXPECT_NEAR(data_int[i], data_float[i], 2.f);
+    }
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/test/cpu_features_test_helper.h"
+
+#include <stdlib.h>
+
+namespace webrtc {
+
+int GetCPUInfoSse2Only(CPUFeature feature) {
+  return feature == kSSE2;
+}
+
+ScopedCPUInfo::ScopedCPUInfo(WebRtc_CPUInfo cpu_info)
+    : saved_cpu_info_(WebRtc_GetCPUInfo) {
+  WebRtc_GetCPUInfo = cpu_info;
+}
+
+ScopedCPUInfo::~ScopedCPUInfo() {
+  WebRtc_GetCPUInfo = saved_cpu_info_;
+}
+
+int16_t RandomW16() {
+  return static_cast<int16_t>(rand() & 0xffff);
+}
+
+int RandomInRange(int min_value, int max_value) {
+  return min_value + rand() % (max_value - min_value + 1);
+}
+
+float RandomFloat(float min_value, float max_value) {
+  return min_value + (max_value - min_value) * rand() / RAND_MAX;
+}
+
+void FillRandom(int16_t* buffer, int length) {
+  for (int i = 0; i < length; ++i) {
+    buffer[i] = RandomW16();
+  }
+}
+
+void FillRandom(float* buffer, int length, float min_value, float max_value) {
+  for (int i = 0; i < length; ++i) {
+    buffer[i] = RandomFloat(min_value, max_value);
+  }
+}
+
+}  // namespace webrtc
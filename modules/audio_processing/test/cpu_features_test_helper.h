@@ -0,0 +1,49 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Helpers for the tests which compare the functions the audio processing
+// components select for different CPUs.
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_TEST_CPU_FEATURES_TEST_HELPER_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_TEST_CPU_FEATURES_TEST_HELPER_H_
+
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// Reports SSE2 as the only CPU feature. Only use it on CPUs with SSE2.
+int GetCPUInfoSse2Only(CPUFeature feature);
+
+// Makes the components select their functions for a CPU with the features
+// reported by |cpu_info| when initialized within its scope. The original
+// WebRtc_GetCPUInfo is restored on destruction.
+class ScopedCPUInfo {
+ public:
+  explicit ScopedCPUInfo(WebRtc_CPUInfo cpu_info);
+  ~ScopedCPUInfo();
+
+ private:
+  const WebRtc_CPUInfo saved_cpu_info_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedCPUInfo);
+};
+
+// Random values from rand(); seed with srand() for reproducible input.
+int16_t RandomW16();
+int RandomInRange(int min_value, int max_value);
+float RandomFloat(float min_value, float max_value);
+void FillRandom(int16_t* buffer, int length);
+void FillRandom(float* buffer, int length, float min_value, float max_value);
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_TEST_CPU_FEATURES_TEST_HELPER_H_
@@ -17,6 +17,7 @@
 
 #include <algorithm>
 
+#include "webrtc/common_audio/include/audio_util.h"
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
 #include "webrtc/modules/interface/module_common_types.h"
 #include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
@@ -37,6 +38,8 @@ using webrtc::AudioProcessing;
 using webrtc::EchoCancellation;
 using webrtc::GainControl;
 using webrtc::NoiseSuppression;
+using webrtc::ScaleAndRoundToInt16;
+using webrtc::ScaleToFloat;
 using webrtc::scoped_array;
 using webrtc::TickInterval;
 using webrtc::TickTime;
@@ -48,6 +51,10 @@ using webrtc::audioproc::ReverseStream;
 using webrtc::audioproc::Stream;
 
 namespace {
+// Limits of the planar buffers used with --float.
+const int kMaxFloatChannels = 2;
+const int kMaxFloatSamplesPerChannel = 320;
+
 // Returns true on success, false on error or end-of-file.
 bool ReadMessageFromFile(FILE* file,
                         ::google::protobuf::MessageLite* msg) {
@@ -77,6 +84,29 @@ void PrintStat(const AudioProcessing::Statistic& stat) {
                          stat.minimum);
 }
 
+// Converts interleaved int16 audio to the deinterleaved float format of the
+// float interface.
+void DeinterleaveToFloat(const int16_t* interleaved, int samples_per_channel,
+                         int num_channels, float* const* deinterleaved) {
+  for (int i = 0; i < num_channels; i++) {
+    for (int j = 0; j < samples_per_channel; j++) {
+      deinterleaved[i][j] = ScaleToFloat(interleaved[j * num_channels + i]);
+    }
+  }
+}
+
+// The inverse of DeinterleaveToFloat().
+void InterleaveToInt16(const float* const* deinterleaved,
+                       int samples_per_channel, int num_channels,
+                       int16_t* interleaved) {
+  for (int i = 0; i < num_channels; i++) {
+    for (int j = 0; j < samples_per_channel; j++) {
+      interleaved[j * num_channels + i] =
+          ScaleAndRoundToInt16(deinterleaved[i][j]);
+    }
+  }
+}
+
 void usage() {
   printf(
   "Usage: process_test [options] [-pb PROTOBUF_FILE]\n"
@@ -134,6 +164,7 @@ void usage() {
   printf("  --noasm            Disable SSE optimization.\n");
   printf("  --delay DELAY      Add DELAY ms to input value.\n");
   printf("  --perf             Measure performance.\n");
+  printf("  --float            Use the float interface. With -pb only.\n");
   printf("  --quiet            Suppress text output.\n");
   printf("  --no_progress      Suppress progress.\n");
   printf("  --debug_file FILE  Dump a debug recording.\n");
@@ -190,6 +221,7 @@ void void_main(int argc, char* argv[]) {
 
   bool simulating = false;
   bool perf_testing = false;
+  bool float_interface = false;
   bool verbose = true;
   bool progress = true;
   int extra_delay_ms = 0;
@@ -436,6 +468,9 @@ void void_main(int argc, char* argv[]) {
     } else if (strcmp(argv[i], "--perf") == 0) {
       perf_testing = true;
 
+    } else if (strcmp(argv[i], "--float") == 0) {
+      float_interface = true;
+
     } else if (strcmp(argv[i], "--quiet") == 0) {
       verbose = false;
       progress = false;
@@ -454,6 +489,8 @@ void void_main(int argc, char* argv[]) {
   // If we're reading a protobuf file, ensure a simulation hasn't also
   // been requested (which makes no sense...)
   ASSERT_FALSE(pb_filename && simulating);
+  // The float interface is only supported with protobuf input.
+  ASSERT_TRUE(pb_filename || !float_interface);
 
   if (verbose) {
     printf("Sample rate: %d Hz\n", sample_rate_hz);
@@ -593,6 +630,12 @@ void void_main(int argc, char* argv[]) {
   AudioFrame far_frame;
   AudioFrame near_frame;
 
+  // Deinterleaved audio for the float interface.
+  float far_data[kMaxFloatChannels][kMaxFloatSamplesPerChannel];
+  float near_data[kMaxFloatChannels][kMaxFloatSamplesPerChannel];
+  float* far_channels[kMaxFloatChannels] = {far_data[0], far_data[1]};
+  float* near_channels[kMaxFloatChannels] = {near_data[0], near_data[1]};
+
   int delay_ms = 0;
   int drift_samples = 0;
   int capture_level = 127;
@@ -640,6 +683,11 @@ void void_main(int argc, char* argv[]) {
             apm->set_num_reverse_channels(msg.num_reverse_channels()));
 
         samples_per_channel = msg.sample_rate() / 100;
+        if (float_interface) {
+          ASSERT_LE(samples_per_channel, kMaxFloatSamplesPerChannel);
+          ASSERT_LE(msg.num_input_channels(), kMaxFloatChannels);
+          ASSERT_LE(msg.num_reverse_channels(), kMaxFloatChannels);
+        }
         far_frame.sample_rate_hz_ = msg.sample_rate();
         far_frame.samples_per_channel_ = samples_per_channel;
         far_frame.num_channels_ = msg.num_reverse_channels();
@@ -666,13 +714,24 @@ void void_main(int argc, char* argv[]) {
         ASSERT_EQ(sizeof(int16_t) * samples_per_channel *
             far_frame.num_channels_, msg.data().size());
         memcpy(far_frame.data_, msg.data().data(), msg.data().size());
+        if (float_interface) {
+          DeinterleaveToFloat(far_frame.data_, samples_per_channel,
+                              far_frame.num_channels_, far_channels);
+        }
 
         if (perf_testing) {
           t0 = TickTime::Now();
         }
 
-        ASSERT_EQ(apm->kNoError,
-                  apm->AnalyzeReverseStream(&far_frame));
+        if (float_interface) {
+          ASSERT_EQ(apm->kNoError,
+                    apm->AnalyzeReverseStream(far_channels,
+                                              samples_per_channel,
+                                              far_frame.sample_rate_hz_));
+        } else {
+          ASSERT_EQ(apm->kNoError,
+                    apm->AnalyzeReverseStream(&far_frame));
+        }
 
         if (perf_testing) {
           t1 = TickTime::Now();
@@ -700,6 +759,10 @@ void void_main(int argc, char* argv[]) {
         memcpy(near_frame.data_,
                msg.input_data().data(),
                msg.input_data().size());
+        if (float_interface) {
+          DeinterleaveToFloat(near_frame.data_, samples_per_channel,
+                              near_frame.num_channels_, near_channels);
+        }
 
         near_read_bytes += msg.input_data().size();
         if (progress && primary_count % 100 == 0) {
@@ -718,7 +781,14 @@ void void_main(int argc, char* argv[]) {
                   apm->set_stream_delay_ms(msg.delay() + extra_delay_ms));
         apm->echo_cancellation()->set_stream_drift_samples(msg.drift());
 
-        int err = apm->ProcessStream(&near_frame);
+        int err = apm->kNoError;
+        if (float_interface) {
+          err = apm->ProcessStream(near_channels, samples_per_channel,
+                                   near_frame.sample_rate_hz_, near_channels);
+          near_frame.num_channels_ = apm->num_output_channels();
+        } else {
+          err = apm->ProcessStream(&near_frame);
+        }
         if (err == apm->kBadStreamParameterWarning) {
           printf("Bad parameter warning. %s\n", trace_stream.str().c_str());
         }
@@ -755,6 +825,10 @@ void void_main(int argc, char* argv[]) {
           }
         }
 
+        if (float_interface) {
+          InterleaveToInt16(near_channels, samples_per_channel,
+                            near_frame.num_channels_, near_frame.data_);
+        }
         size_t size = samples_per_channel * near_frame.num_channels_;
         ASSERT_EQ(size, fwrite(near_frame.data_,
                                sizeof(int16_t),
@@ -1051,8 +1125,10 @@ void void_main(int argc, char* argv[]) {
           (max_time_us + max_time_reverse_us) / 1000.0,
           (min_time_us + min_time_reverse_us) / 1000.0);
       // Record the results with Perf test tools.
-      webrtc::test::PrintResult("audioproc", "", "time_per_10ms_frame",
-          (exec_time * 1000) / primary_count, "us", false);
+      webrtc::test::PrintResult("audioproc", float_interface ? "_float" : "",
+                                "time_per_10ms_frame",
+                                (exec_time * 1000) / primary_count, "us",
+                                false);
     } else {
       printf("Warning: no capture frames\n");
     }
@@ -8,16 +8,19 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <math.h>
 #include <stdio.h>
 
 #include <algorithm>
 #include <queue>
 
+#include "webrtc/common_audio/include/audio_util.h"
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
 #include "webrtc/modules/interface/module_common_types.h"
 #include "webrtc/system_wrappers/interface/event_wrapper.h"
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
 #include "webrtc/system_wrappers/interface/thread_wrapper.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 #include "webrtc/test/testsupport/fileutils.h"
@@ -41,6 +44,10 @@ using webrtc::NoiseSuppression;
 using webrtc::EchoCancellation;
 using webrtc::EventWrapper;
 using webrtc::scoped_array;
+using webrtc::scoped_ptr;
+using webrtc::ScaleAndRoundToInt16;
+using webrtc::ScaleToFloat;
+using webrtc::ThreadWrapper;
 using webrtc::Trace;
 using webrtc::LevelEstimator;
 using webrtc::EchoCancellation;
@@ -203,6 +210,58 @@ struct ThreadData {
   AudioProcessing* ap;
 };
 
+// Passes a reverse stream frame to |ap| about every millisecond.
+bool RenderThreadProcess(void* obj) {
+  ThreadData* data = static_cast<ThreadData*>(obj);
+  AudioFrame frame;
+  frame.sample_rate_hz_ = data->ap->sample_rate_hz();
+  frame.samples_per_channel_ = frame.sample_rate_hz_ / 100;
+  frame.num_channels_ = data->ap->num_reverse_channels();
+  SetFrameTo(&frame, 1000);
+  if (data->ap->AnalyzeReverseStream(&frame) != data->ap->kNoError) {
+    data->error = true;
+  }
+  webrtc::SleepMs(1);
+  return true;
+}
+
+void EnableAllAPComponents(AudioProcessing* ap) {
+#if defined(WEBRTC_AUDIOPROC_FIXED_PROFILE)
+  EXPECT_EQ(ap->kNoError, ap->set_sample_rate_hz(16000));
+  EXPECT_EQ(ap->kNoError, ap->echo_control_mobile()->Enable(true));
+
+  EXPECT_EQ(ap->kNoError,
+            ap->gain_control()->set_mode(GainControl::kAdaptiveDigital));
+  EXPECT_EQ(ap->kNoError, ap->gain_control()->Enable(true));
+#elif defined(WEBRTC_AUDIOPROC_FLOAT_PROFILE)
+  EXPECT_EQ(ap->kNoError,
+            ap->echo_cancellation()->enable_drift_compensation(true));
+  EXPECT_EQ(ap->kNoError,
+            ap->echo_cancellation()->enable_metrics(true));
+  EXPECT_EQ(ap->kNoError,
+            ap->echo_cancellation()->enable_delay_logging(true));
+  EXPECT_EQ(ap->kNoError, ap->echo_cancellation()->Enable(true));
+
+  EXPECT_EQ(ap->kNoError,
+            ap->gain_control()->set_mode(GainControl::kAdaptiveAnalog));
+  EXPECT_EQ(ap->kNoError,
+            ap->gain_control()->set_analog_level_limits(0, 255));
+  EXPECT_EQ(ap->kNoError, ap->gain_control()->Enable(true));
+#endif
+
+  EXPECT_EQ(ap->kNoError,
+            ap->high_pass_filter()->Enable(true));
+
+  EXPECT_EQ(ap->kNoError,
+            ap->level_estimator()->Enable(true));
+
+  EXPECT_EQ(ap->kNoError,
+            ap->noise_suppression()->Enable(true));
+
+  EXPECT_EQ(ap->kNoError,
+            ap->voice_detection()->Enable(true));
+}
+
 class ApmTest : public ::testing::Test {
  protected:
   ApmTest();
@@ -385,40 +444,7 @@ void ApmTest::Init(int sample_rate_hz, int num_reverse_channels,
 }
 
 void ApmTest::EnableAllComponents() {
-#if defined(WEBRTC_AUDIOPROC_FIXED_PROFILE)
-  EXPECT_EQ(apm_->kNoError, apm_->set_sample_rate_hz(16000));
-  EXPECT_EQ(apm_->kNoError, apm_->echo_control_mobile()->Enable(true));
-
-  EXPECT_EQ(apm_->kNoError,
-            apm_->gain_control()->set_mode(GainControl::kAdaptiveDigital));
-  EXPECT_EQ(apm_->kNoError, apm_->gain_control()->Enable(true));
-#elif defined(WEBRTC_AUDIOPROC_FLOAT_PROFILE)
-  EXPECT_EQ(apm_->kNoError,
-            apm_->echo_cancellation()->enable_drift_compensation(true));
-  EXPECT_EQ(apm_->kNoError,
-            apm_->echo_cancellation()->enable_metrics(true));
-  EXPECT_EQ(apm_->kNoError,
-            apm_->echo_cancellation()->enable_delay_logging(true));
-  EXPECT_EQ(apm_->kNoError, apm_->echo_cancellation()->Enable(true));
-
-  EXPECT_EQ(apm_->kNoError,
-            apm_->gain_control()->set_mode(GainControl::kAdaptiveAnalog));
-  EXPECT_EQ(apm_->kNoError,
-            apm_->gain_control()->set_analog_level_limits(0, 255));
-  EXPECT_EQ(apm_->kNoError, apm_->gain_control()->Enable(true));
-#endif
-
-  EXPECT_EQ(apm_->kNoError,
-            apm_->high_pass_filter()->Enable(true));
-
-  EXPECT_EQ(apm_->kNoError,
-            apm_->level_estimator()->Enable(true));
-
-  EXPECT_EQ(apm_->kNoError,
-            apm_->noise_suppression()->Enable(true));
-
-  EXPECT_EQ(apm_->kNoError,
-            apm_->voice_detection()->Enable(true));
+  EnableAllAPComponents(apm_);
 }
 
 bool ApmTest::ReadFrame(FILE* file, AudioFrame* frame) {
@@ -1222,6 +1248,26 @@ TEST_F(ApmTest, VoiceDetection) {
   // TODO(bjornv): Add tests for streamed voice; stream_has_voice()
 }
 
+TEST_F(ApmTest, RenderAndCaptureRunConcurrently) {
+  EnableAllComponents();
+  Init(16000, 2, 2, 2, false);
+  ThreadData data(0, apm_);
+  scoped_ptr<ThreadWrapper> thread(
+      ThreadWrapper::CreateThread(&RenderThreadProcess, &data));
+  unsigned int id = 0;
+  ASSERT_TRUE(thread->Start(id));
+  for (int i = 0; i < 200; i++) {
+    // Settings may change while the render thread runs.
+    EXPECT_EQ(apm_->kNoError,
+              apm_->noise_suppression()->Enable(i % 2 == 0));
+    SetFrameTo(frame_, 1000);
+    ProcessWithDefaultStreamParameters(frame_);
+    webrtc::SleepMs(1);
+  }
+  EXPECT_TRUE(thread->Stop());
+  EXPECT_FALSE(data.error);
+}
+
 TEST_F(ApmTest, VerifyDownMixing) {
   for (size_t i = 0; i < kSampleRatesSize; i++) {
     Init(kSampleRates[i], 2, 2, 1, false);
@@ -1290,6 +1336,135 @@ TEST_F(ApmTest, IdenticalInputChannelsResultInIdenticalOutputChannels) {
   }
 }
 
+// The float interface keeps the audio in float through the AEC and NS, so its
+// output only approximates that of the int16 interface. The nonlinear
+// processing of the AEC amplifies the sub-LSB differences, which calls for a
+// looser bound with the AEC enabled. Voice decisions near the threshold may
+// flip as well.
+TEST_F(ApmTest, FloatAndIntInterfacesGiveSimilarResults) {
+  const int kChannels[][3] = {{2, 2, 2}, {2, 2, 1}, {1, 1, 1}};
+  const size_t kChannelsSize = sizeof(kChannels) / sizeof(*kChannels);
+  const struct {
+    bool enable_aec;
+    double min_snr_db;
+  } kComponentConfigs[] = {{false, 50}, {true, 10}};
+  const size_t kComponentConfigsSize =
+      sizeof(kComponentConfigs) / sizeof(*kComponentConfigs);
+  const int kMaxSamplesPerChannel = 320;
+  float src[2][kMaxSamplesPerChannel];
+  float dest[2][kMaxSamplesPerChannel];
+  float* src_channels[2] = {src[0], src[1]};
+  float* dest_channels[2] = {dest[0], dest[1]};
+
+  for (size_t c = 0; c < kComponentConfigsSize; c++) {
+    for (size_t i = 0; i < kProcessSampleRatesSize; i++) {
+      for (size_t j = 0; j < kChannelsSize; j++) {
+        const bool enable_aec = kComponentConfigs[c].enable_aec;
+        const int sample_rate_hz = kProcessSampleRates[i];
+        const int num_reverse_channels = kChannels[j][0];
+        const int num_input_channels = kChannels[j][1];
+        const int num_output_channels = kChannels[j][2];
+        EnableAllComponents();
+        Init(sample_rate_hz, num_reverse_channels, num_input_channels,
+             num_output_channels, false);
+        if (!enable_aec) {
+          EXPECT_EQ(apm_->kNoError, apm_->echo_cancellation()->Enable(false));
+        }
+
+        // A second instance with the same configuration uses the float API.
+        scoped_ptr<AudioProcessing> fapm(AudioProcessing::Create(0));
+        ASSERT_TRUE(fapm.get() != NULL);
+        EnableAllAPComponents(fapm.get());
+        if (!enable_aec) {
+          EXPECT_EQ(fapm->kNoError, fapm->echo_cancellation()->Enable(false));
+        }
+        ASSERT_EQ(fapm->kNoError, fapm->set_sample_rate_hz(sample_rate_hz));
+        ASSERT_EQ(fapm->kNoError, fapm->set_num_channels(num_input_channels,
+                                                         num_output_channels));
+        ASSERT_EQ(fapm->kNoError,
+                  fapm->set_num_reverse_channels(num_reverse_channels));
+
+        const int samples_per_channel = frame_->samples_per_channel_;
+        int analog_level = 127;
+        int fanalog_level = 127;
+        double signal_energy = 0;
+        double error_energy = 0;
+        int num_frames = 0;
+        int vad_mismatches = 0;
+        while (1) {
+          if (!ReadFrame(far_file_, revframe_)) break;
+          for (int ch = 0; ch < num_reverse_channels; ch++) {
+            for (int k = 0; k < samples_per_channel; k++) {
+              src[ch][k] = ScaleToFloat(
+                  revframe_->data_[k * num_reverse_channels + ch]);
+            }
+          }
+          EXPECT_EQ(apm_->kNoError, apm_->AnalyzeReverseStream(revframe_));
+          EXPECT_EQ(fapm->kNoError,
+                    fapm->AnalyzeReverseStream(src_channels,
+                                               samples_per_channel,
+                                               sample_rate_hz));
+
+          if (!ReadFrame(near_file_, frame_)) break;
+          frame_->vad_activity_ = AudioFrame::kVadUnknown;
+          for (int ch = 0; ch < num_input_channels; ch++) {
+            for (int k = 0; k < samples_per_channel; k++) {
+              src[ch][k] = ScaleToFloat(
+                  frame_->data_[k * num_input_channels + ch]);
+            }
+          }
+
+          EXPECT_EQ(apm_->kNoError, apm_->set_stream_delay_ms(0));
+          EXPECT_EQ(fapm->kNoError, fapm->set_stream_delay_ms(0));
+          apm_->echo_cancellation()->set_stream_drift_samples(0);
+          fapm->echo_cancellation()->set_stream_drift_samples(0);
+          EXPECT_EQ(apm_->kNoError,
+              apm_->gain_control()->set_stream_analog_level(analog_level));
+          EXPECT_EQ(fapm->kNoError,
+              fapm->gain_control()->set_stream_analog_level(fanalog_level));
+
+          EXPECT_EQ(apm_->kNoError, apm_->ProcessStream(frame_));
+          EXPECT_EQ(fapm->kNoError,
+                    fapm->ProcessStream(src_channels, samples_per_channel,
+                                        sample_rate_hz, dest_channels));
+          analog_level = apm_->gain_control()->stream_analog_level();
+          fanalog_level = fapm->gain_control()->stream_analog_level();
+          EXPECT_EQ(analog_level, fanalog_level);
+          if (apm_->voice_detection()->stream_has_voice() !=
+              fapm->voice_detection()->stream_has_voice()) {
+            vad_mismatches++;
+          }
+          num_frames++;
+
+          for (int ch = 0; ch < num_output_channels; ch++) {
+            for (int k = 0; k < samples_per_channel; k++) {
+              const double reference =
+                  frame_->data_[k * num_output_channels + ch];
+              const double error =
+                  reference - ScaleAndRoundToInt16(dest[ch][k]);
+              signal_energy += reference * reference;
+              error_energy += error * error;
+            }
+          }
+
+          // Reset in case of downmixing.
+          frame_->num_channels_ = num_input_channels;
+        }
+        if (!enable_aec) {
+          EXPECT_LE(100 * vad_mismatches, num_frames);
+        }
+        EXPECT_GE(signal_energy, error_energy *
+                  pow(10.0, kComponentConfigs[c].min_snr_db / 10))
+            << "enable_aec: " << enable_aec
+            << ", sample_rate_hz: " << sample_rate_hz
+            << ", channel configuration: " << j;
+        rewind(far_file_);
+        rewind(near_file_);
+      }
+    }
+  }
+}
+
 TEST_F(ApmTest, SplittingFilter) {
   // Verify the filter is not active through undistorted audio when:
   // 1. No components are enabled...
@@ -61,7 +61,11 @@ int VoiceDetectionImpl::ProcessCaptureAudio(AudioBuffer* audio) {
   }
   assert(audio->samples_per_split_channel() <= 160);
 
-  int16_t* mixed_data = audio->low_pass_split_data(0);
+  // WebRtcVad_Process() only reads the audio. Reading it through the const
+  // accessor keeps the float data of float frames valid.
+  const AudioBuffer* const_audio = audio;
+  int16_t* mixed_data =
+      const_cast<int16_t*>(const_audio->low_pass_split_data(0));
   if (audio->num_channels() > 1) {
     audio->CopyAndMixLowPass(1);
     mixed_data = audio->mixed_low_pass_data(0);
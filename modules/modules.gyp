@@ -44,6 +44,7 @@
         'audio_coding/codecs/isac/isac_test.gypi',
         'audio_coding/codecs/isac/isacfix_test.gypi',
         'audio_processing/audio_processing_tests.gypi',
+        'remote_bitrate_estimator/remote_bitrate_estimator_tools.gypi',
         'rtp_rtcp/test/testFec/test_fec.gypi',
         'video_coding/main/source/video_coding_test.gypi',
         'video_coding/codecs/test/video_codecs_test_framework.gypi',
@@ -66,6 +67,7 @@
           'type': 'executable',
           'dependencies': [
             'audio_coding_module',
+            'audio_conference_mixer',
             'audio_processing',
             'audioproc_unittest_proto',
             'bitrate_controller',
@@ -141,8 +143,17 @@
             'audio_coding/neteq4/mock/mock_external_decoder_pcm16b.h',
             'audio_coding/neteq4/mock/mock_packet_buffer.h',
             'audio_coding/neteq4/mock/mock_payload_splitter.h',
+            'audio_conference_mixer/source/audio_conference_mixer_unittest.cc',
+            'audio_conference_mixer/source/mix_accumulator_unittest.cc',
+            'audio_processing/aec/aec_core_unittest.cc',
             'audio_processing/aec/system_delay_unittest.cc',
             'audio_processing/aec/echo_cancellation_unittest.cc',
+            'audio_processing/aecm/aecm_core_unittest.cc',
+            'audio_processing/audio_processing_impl_unittest.cc',
+            'audio_processing/render_queue_unittest.cc',
+            'audio_processing/splitting_filter_unittest.cc',
+            'audio_processing/test/cpu_features_test_helper.cc',
+            'audio_processing/test/cpu_features_test_helper.h',
             'audio_processing/test/unit_test.cc',
             'audio_processing/utility/delay_estimator_unittest.cc',
             'audio_processing/utility/ring_buffer_unittest.cc',
@@ -168,16 +179,26 @@
             'remote_bitrate_estimator/remote_bitrate_estimator_unittest_helper.cc',
             'remote_bitrate_estimator/remote_bitrate_estimator_unittest_helper.h',
             'remote_bitrate_estimator/rtp_to_ntp_unittest.cc',
+            'remote_bitrate_estimator/test/bwe_simulator.cc',
+            'remote_bitrate_estimator/test/bwe_simulator.h',
+            'remote_bitrate_estimator/test/bwe_simulator_unittest.cc',
+            'remote_bitrate_estimator/test/bwe_test_framework.cc',
+            'remote_bitrate_estimator/test/bwe_test_framework.h',
+            'remote_bitrate_estimator/test/bwe_test_framework_unittest.cc',
             'rtp_rtcp/source/mock/mock_rtp_payload_strategy.h',
             'rtp_rtcp/source/mock/mock_rtp_receiver_video.h',
             'rtp_rtcp/source/fec_test_helper.cc',
             'rtp_rtcp/source/fec_test_helper.h',
+            'rtp_rtcp/source/fec_xor_unittest.cc',
             'rtp_rtcp/source/nack_rtx_unittest.cc',
             'rtp_rtcp/source/producer_fec_unittest.cc',
+            'rtp_rtcp/source/receive_statistician_unittest.cc',
             'rtp_rtcp/source/receiver_fec_unittest.cc',
             'rtp_rtcp/source/rtcp_format_remb_unittest.cc',
+            'rtp_rtcp/source/rtcp_packet_aggregator_unittest.cc',
             'rtp_rtcp/source/rtcp_sender_unittest.cc',
             'rtp_rtcp/source/rtcp_receiver_unittest.cc',
+            'rtp_rtcp/source/rtcp_utility_unittest.cc',
             'rtp_rtcp/source/rtp_fec_unittest.cc',
             'rtp_rtcp/source/rtp_format_vp8_unittest.cc',
             'rtp_rtcp/source/rtp_format_vp8_test_helper.cc',
@@ -194,6 +215,8 @@
             'rtp_rtcp/test/testAPI/test_api_rtcp.cc',
             'rtp_rtcp/test/testAPI/test_api_video.cc',
             'utility/source/audio_frame_operations_unittest.cc',
+            'utility/source/process_thread_impl_unittest.cc',
+            'utility/source/process_thread_pool_impl_unittest.cc',
             'video_coding/codecs/test/packet_manipulator_unittest.cc',
             'video_coding/codecs/test/stats_unittest.cc',
             'video_coding/codecs/test/videoprocessor_unittest.cc',
@@ -203,6 +226,7 @@
             'video_coding/main/source/decoding_state_unittest.cc',
             'video_coding/main/source/jitter_buffer_unittest.cc',
             'video_coding/main/source/receiver_unittest.cc',
+            'video_coding/main/source/sequence_number_bitset_unittest.cc',
             'video_coding/main/source/session_info_unittest.cc',
             'video_coding/main/source/stream_generator.cc',
             'video_coding/main/source/stream_generator.h',
@@ -236,6 +260,9 @@
             }],
             ['prefer_fixed_point==1', {
               'defines': [ 'WEBRTC_AUDIOPROC_FIXED_PROFILE' ],
+              'sources': [
+                'audio_processing/ns/nsx_core_unittest.cc',
+              ],
             }, {
               'defines': [ 'WEBRTC_AUDIOPROC_FLOAT_PROFILE' ],
             }],
@@ -11,8 +11,8 @@
 #ifndef WEBRTC_MODULES_PACED_SENDER_H_
 #define WEBRTC_MODULES_PACED_SENDER_H_
 
-#include <list>
-#include <set>
+#include <map>
+#include <vector>
 
 #include "webrtc/modules/interface/module.h"
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
@@ -20,13 +20,19 @@
 #include "webrtc/typedefs.h"
 
 namespace webrtc {
+class ConditionVariableWrapper;
 class CriticalSectionWrapper;
 namespace paced_sender {
 class IntervalBudget;
 struct Packet;
-class PacketList;
+class PacketQueue;
 }  // namespace paced_sender
 
+// Paces the packets of one or more RTP streams out at the target bitrate.
+// Within a priority level the streams share the budget in proportion to their
+// weights, using weighted fair queuing, so a single PacedSender can pace all
+// streams of a call without bursts from one stream starving the others.
+
 class PacedSender : public Module {
  public:
   enum Priority {
@@ -49,6 +55,23 @@ class PacedSender : public Module {
    protected:
     virtual ~Callback() {}
   };
+
+  // Histogram of the time packets spent in the queue before Process() sent
+  // them. Bucket 0 counts delays below 1 ms and bucket i > 0 counts delays in
+  // [2^(i-1), 2^i) ms. The last bucket also counts all longer delays.
+  struct QueueDelayHistogram {
+    enum { kNumBuckets = 12 };
+    QueueDelayHistogram();
+
+    uint32_t counts[kNumBuckets];
+    uint32_t num_packets;
+    int max_delay_ms;
+  };
+
+  static const int kDefaultMaxPacketsPerProcess = 100;
+
+  // |callback| is used for padding and for the packets of all SSRCs which
+  // aren't registered with RegisterStream().
   PacedSender(Callback* callback, int target_bitrate_kbps,
               float pace_multiplier);
 
@@ -71,6 +94,22 @@ class PacedSender : public Module {
   // |pad_up_to_bitrate_kbps| no padding will be sent.
   void UpdateBitrate(int target_bitrate_kbps, int pad_up_to_bitrate_kbps);
 
+  // Hands the queued packets of |ssrc| to |callback| and gives the stream
+  // |weight| shares of the budget. Unregistered streams have one share.
+  void RegisterStream(uint32_t ssrc, Callback* callback, int weight);
+
+  // Drops the queued packets of |ssrc|. Its callback won't be called after
+  // this method has returned, except when called from within that callback.
+  // Only waits for a callback of |ssrc| which is running on another thread.
+  void DeregisterStream(uint32_t ssrc);
+
+  // Sets the maximum number of packets sent by one call to Process(). If the
+  // limit is hit, the next Process() call is due immediately.
+  void SetMaxPacketsPerProcess(int max_packets);
+
+  // Returns the queue delay histogram of all packets sent so far.
+  void GetQueueDelayHistogram(QueueDelayHistogram* histogram) const;
+
   // Returns true if we send the packet now, else it will add the packet
   // information to the queue and call TimeToSendPacket when it's time to send.
   virtual bool SendPacket(Priority priority,
@@ -82,6 +121,9 @@ class PacedSender : public Module {
   // Returns the time since the oldest queued packet was captured.
   virtual int QueueInMs() const;
 
+  // Returns the number of queued packets.
+  virtual int QueueInPackets() const;
+
   // Returns the number of milliseconds until the module want a worker thread
   // to call Process.
   virtual int32_t TimeUntilNextProcess();
@@ -90,15 +132,36 @@ class PacedSender : public Module {
   virtual int32_t Process();
 
  private:
+  struct Stream {
+    Callback* callback;
+    int weight;
+    // Distinguishes a registration from an earlier one of the same SSRC.
+    uint32_t generation;
+  };
+  typedef std::map<uint32_t, Stream> StreamMap;
+
+  struct PendingSend {
+    Callback* callback;
+    // Generation of the registered stream, or 0 for |callback_|.
+    uint32_t generation;
+    uint32_t ssrc;
+    uint16_t sequence_number;
+    int64_t capture_time_ms;
+  };
+
   // Checks if next packet in line can be transmitted. Returns true on success.
-  bool GetNextPacket(uint32_t* ssrc, uint16_t* sequence_number,
-                     int64_t* capture_time_ms, Priority* priority,
+  bool GetNextPacket(paced_sender::Packet* packet, Priority* priority,
                      bool* last_packet);
 
   // Local helper function to GetNextPacket.
-  void GetNextPacketFromList(paced_sender::PacketList* packets,
-      uint32_t* ssrc, uint16_t* sequence_number, int64_t* capture_time_ms,
-      bool* last_packet);
+  void GetNextPacketFromQueue(paced_sender::PacketQueue* packets,
+                              paced_sender::Packet* packet, bool* last_packet);
+
+  // Returns the number of packets in all queues.
+  int NumQueuedPackets() const;
+
+  // Adds the queue delay of a packet sent now to the histogram.
+  void UpdateQueueDelayHistogram(int64_t now_ms, int64_t enqueue_time_ms);
 
   // Updates the number of bytes that can be sent for the next time interval.
   void UpdateBytesPerInterval(uint32_t delta_time_in_ms);
@@ -111,6 +174,15 @@ class PacedSender : public Module {
   bool enabled_;
   bool paused_;
   scoped_ptr<CriticalSectionWrapper> critsect_;
+  // Signaled when Process() returns from the callback of a registered stream,
+  // for DeregisterStream() to wait on.
+  scoped_ptr<ConditionVariableWrapper> callback_done_;
+  // Set while Process() calls the callback of |sending_ssrc_|, on the thread
+  // |sending_thread_id_|.
+  bool sending_;
+  uint32_t sending_ssrc_;
+  uint32_t sending_thread_id_;
+  uint32_t next_stream_generation_;
   // This is the media budget, keeping track of how many bits of media
   // we can pace out during the current interval.
   scoped_ptr<paced_sender::IntervalBudget> media_budget_;
@@ -127,9 +199,18 @@ class PacedSender : public Module {
   int64_t capture_time_ms_last_queued_;
   int64_t capture_time_ms_last_sent_;
 
-  scoped_ptr<paced_sender::PacketList> high_priority_packets_;
-  scoped_ptr<paced_sender::PacketList> normal_priority_packets_;
-  scoped_ptr<paced_sender::PacketList> low_priority_packets_;
+  scoped_ptr<paced_sender::PacketQueue> high_priority_packets_;
+  scoped_ptr<paced_sender::PacketQueue> normal_priority_packets_;
+  scoped_ptr<paced_sender::PacketQueue> low_priority_packets_;
+
+  StreamMap streams_;
+  int max_packets_per_process_;
+  // True if the last Process() call stopped at |max_packets_per_process_|.
+  bool packet_limit_reached_;
+  // Packets which Process() hands to the callbacks once |critsect_| is
+  // released.
+  std::vector<PendingSend> pending_sends_;
+  QueueDelayHistogram queue_delay_histogram_;
 };
 }  // namespace webrtc
 #endif  // WEBRTC_MODULES_PACED_SENDER_H_
@@ -11,9 +11,15 @@
 #include "webrtc/modules/pacing/include/paced_sender.h"
 
 #include <assert.h>
+#include <string.h>
+
+#include <list>
+#include <set>
 
 #include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/system_wrappers/interface/condition_variable_wrapper.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
 #include "webrtc/system_wrappers/interface/trace_event.h"
 
 namespace {
@@ -32,57 +38,160 @@ const int kMaxQueueTimeWithoutSendingMs = 30;
 // Max padding bytes per second.
 const int kMaxPaddingKbps = 800;
 
+// Returns the bucket of |delay_ms| in a PacedSender::QueueDelayHistogram.
+int QueueDelayBucket(int64_t delay_ms) {
+  int bucket = 0;
+  while (delay_ms > 0 &&
+         bucket < webrtc::PacedSender::QueueDelayHistogram::kNumBuckets - 1) {
+    delay_ms >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
 }  // namespace
 
 namespace webrtc {
 
 namespace paced_sender {
 struct Packet {
+  Packet()
+      : ssrc_(0),
+        sequence_number_(0),
+        capture_time_ms_(0),
+        enqueue_time_ms_(0),
+        bytes_(0),
+        finish_tag_(0) {
+  }
   Packet(uint32_t ssrc, uint16_t seq_number, int64_t capture_time_ms,
-         int length_in_bytes)
+         int64_t enqueue_time_ms, int length_in_bytes)
       : ssrc_(ssrc),
         sequence_number_(seq_number),
         capture_time_ms_(capture_time_ms),
-        bytes_(length_in_bytes) {
+        enqueue_time_ms_(enqueue_time_ms),
+        bytes_(length_in_bytes),
+        finish_tag_(0) {
   }
   uint32_t ssrc_;
   uint16_t sequence_number_;
   int64_t capture_time_ms_;
+  int64_t enqueue_time_ms_;
   int bytes_;
+  // Virtual time at which the packet is done in a fair queue, see PacketQueue.
+  uint64_t finish_tag_;
 };
 
-// STL list style class which prevents duplicates in the list.
-class PacketList {
+// Weighted fair queue of the packets of several streams, which prevents
+// duplicate sequence numbers within a stream. Each packet is stamped with a
+// virtual finish time when queued: the finish time of the previous packet of
+// the stream, or the current virtual time if the stream was idle, plus its
+// size divided by the stream weight. The packet with the earliest finish time
+// is sent first and moves the virtual time to its finish time (self-clocked
+// fair queuing). The packets of one stream are sent in the order they came.
+class PacketQueue {
  public:
-  PacketList() {};
+  PacketQueue() : virtual_time_(0), size_(0) {}
 
   bool empty() const {
-    return packet_list_.empty();
+    return size_ == 0;
+  }
+
+  int size() const {
+    return size_;
   }
 
-  Packet front() const {
-    return packet_list_.front();
+  const Packet& front() const {
+    assert(!empty());
+    return streams_.find(heads_.begin()->second)->second.packets.front();
   }
 
-  void pop_front() {
-    Packet& packet = packet_list_.front();
-    uint16_t sequence_number = packet.sequence_number_;
-    packet_list_.pop_front();
-    sequence_number_set_.erase(sequence_number);
+  // Removes front(). |last_packet| tells if it was the last queued packet of
+  // its stream with its capture time.
+  void pop_front(bool* last_packet) {
+    assert(!empty());
+    StreamMap::iterator stream_it = streams_.find(heads_.begin()->second);
+    heads_.erase(heads_.begin());
+    Stream& stream = stream_it->second;
+    const Packet& packet = stream.packets.front();
+    const int64_t capture_time_ms = packet.capture_time_ms_;
+    virtual_time_ = packet.finish_tag_;
+    stream.sequence_numbers.erase(packet.sequence_number_);
+    stream.packets.pop_front();
+    --size_;
+    if (stream.packets.empty()) {
+      // The virtual time has caught up with the stream, so nothing is lost by
+      // forgetting it.
+      *last_packet = true;
+      streams_.erase(stream_it);
+      return;
+    }
+    const Packet& next_packet = stream.packets.front();
+    *last_packet = next_packet.capture_time_ms_ > capture_time_ms;
+    heads_.insert(HeadKey(next_packet.finish_tag_, stream_it->first));
   }
 
-  void push_back(const Packet& packet) {
-    if (sequence_number_set_.find(packet.sequence_number_) ==
-        sequence_number_set_.end()) {
+  void push_back(const Packet& packet, int weight) {
+    Stream& stream = streams_[packet.ssrc_];
+    if (!stream.sequence_numbers.insert(packet.sequence_number_).second) {
       // Don't insert duplicates.
-      packet_list_.push_back(packet);
-      sequence_number_set_.insert(packet.sequence_number_);
+      return;
     }
+    const bool was_idle = stream.packets.empty();
+    const uint64_t start_tag =
+        was_idle ? virtual_time_ : stream.packets.back().finish_tag_;
+    stream.packets.push_back(packet);
+    Packet& queued_packet = stream.packets.back();
+    queued_packet.finish_tag_ = start_tag +
+        static_cast<uint64_t>(packet.bytes_) * kWeightScale / weight;
+    if (was_idle) {
+      heads_.insert(HeadKey(queued_packet.finish_tag_, packet.ssrc_));
+    }
+    ++size_;
+  }
+
+  // Drops all queued packets of |ssrc|.
+  void RemoveStream(uint32_t ssrc) {
+    StreamMap::iterator stream_it = streams_.find(ssrc);
+    if (stream_it == streams_.end()) {
+      return;
+    }
+    Stream& stream = stream_it->second;
+    heads_.erase(HeadKey(stream.packets.front().finish_tag_, ssrc));
+    size_ -= stream.packets.size();
+    streams_.erase(stream_it);
+  }
+
+  // Returns the oldest capture time at the head of a stream, or |now_ms| if
+  // no packet is older.
+  int64_t OldestCaptureTimeMs(int64_t now_ms) const {
+    int64_t oldest_capture_time_ms = now_ms;
+    for (StreamMap::const_iterator it = streams_.begin(); it != streams_.end();
+         ++it) {
+      oldest_capture_time_ms = std::min(
+          oldest_capture_time_ms, it->second.packets.front().capture_time_ms_);
+    }
+    return oldest_capture_time_ms;
   }
 
  private:
-  std::list<Packet> packet_list_;
-  std::set<uint16_t> sequence_number_set_;
+  // Fixed point scale of the finish tags, so that dividing the packet size by
+  // the weight keeps its precision.
+  static const uint64_t kWeightScale = 1 << 10;
+
+  struct Stream {
+    std::list<Packet> packets;
+    std::set<uint16_t> sequence_numbers;
+  };
+  typedef std::map<uint32_t, Stream> StreamMap;
+  // Finish tag of the first packet of a stream, and the stream SSRC which
+  // breaks ties.
+  typedef std::pair<uint64_t, uint32_t> HeadKey;
+
+  uint64_t virtual_time_;
+  int size_;
+  // Only holds streams with queued packets.
+  StreamMap streams_;
+  std::set<HeadKey> heads_;
 };
 
 class IntervalBudget {
@@ -119,6 +228,12 @@ class IntervalBudget {
 };
 }  // namespace paced_sender
 
+PacedSender::QueueDelayHistogram::QueueDelayHistogram()
+    : num_packets(0),
+      max_delay_ms(0) {
+  memset(counts, 0, sizeof(counts));
+}
+
 PacedSender::PacedSender(Callback* callback, int target_bitrate_kbps,
                          float pace_multiplier)
     : callback_(callback),
@@ -126,6 +241,11 @@ PacedSender::PacedSender(Callback* callback, int target_bitrate_kbps,
       enabled_(false),
       paused_(false),
       critsect_(CriticalSectionWrapper::CreateCriticalSection()),
+      callback_done_(ConditionVariableWrapper::CreateConditionVariable()),
+      sending_(false),
+      sending_ssrc_(0),
+      sending_thread_id_(0),
+      next_stream_generation_(1),
       media_budget_(new paced_sender::IntervalBudget(
           pace_multiplier_ * target_bitrate_kbps)),
       padding_budget_(new paced_sender::IntervalBudget(kMaxPaddingKbps)),
@@ -134,9 +254,11 @@ PacedSender::PacedSender(Callback* callback, int target_bitrate_kbps,
       time_last_update_(TickTime::Now()),
       capture_time_ms_last_queued_(0),
       capture_time_ms_last_sent_(0),
-      high_priority_packets_(new paced_sender::PacketList),
-      normal_priority_packets_(new paced_sender::PacketList),
-      low_priority_packets_(new paced_sender::PacketList) {
+      high_priority_packets_(new paced_sender::PacketQueue),
+      normal_priority_packets_(new paced_sender::PacketQueue),
+      low_priority_packets_(new paced_sender::PacketQueue),
+      max_packets_per_process_(kDefaultMaxPacketsPerProcess),
+      packet_limit_reached_(false) {
   UpdateBytesPerInterval(kMinPacketLimitMs);
 }
 
@@ -170,6 +292,45 @@ void PacedSender::UpdateBitrate(int target_bitrate_kbps,
   pad_up_to_bitrate_budget_->set_target_rate_kbps(pad_up_to_bitrate_kbps);
 }
 
+void PacedSender::RegisterStream(uint32_t ssrc, Callback* callback,
+                                 int weight) {
+  assert(callback);
+  assert(weight > 0);
+  CriticalSectionScoped cs(critsect_.get());
+  Stream& stream = streams_[ssrc];
+  stream.callback = callback;
+  stream.weight = weight;
+  stream.generation = next_stream_generation_++;
+}
+
+void PacedSender::DeregisterStream(uint32_t ssrc) {
+  CriticalSectionScoped cs(critsect_.get());
+  streams_.erase(ssrc);
+  high_priority_packets_->RemoveStream(ssrc);
+  normal_priority_packets_->RemoveStream(ssrc);
+  low_priority_packets_->RemoveStream(ssrc);
+  // Process() skips the rest of a batch taken before the stream was removed,
+  // so only a callback already running has to finish. Don't wait for it when
+  // called from within it.
+  const uint32_t thread_id = ThreadWrapper::GetThreadId();
+  while (sending_ && sending_ssrc_ == ssrc &&
+         sending_thread_id_ != thread_id) {
+    callback_done_->SleepCS(*critsect_);
+  }
+}
+
+void PacedSender::SetMaxPacketsPerProcess(int max_packets) {
+  assert(max_packets > 0);
+  CriticalSectionScoped cs(critsect_.get());
+  max_packets_per_process_ = max_packets;
+}
+
+void PacedSender::GetQueueDelayHistogram(
+    QueueDelayHistogram* histogram) const {
+  CriticalSectionScoped cs(critsect_.get());
+  *histogram = queue_delay_histogram_;
+}
+
 bool PacedSender::SendPacket(Priority priority, uint32_t ssrc,
     uint16_t sequence_number, int64_t capture_time_ms, int bytes) {
   CriticalSectionScoped cs(critsect_.get());
@@ -178,17 +339,19 @@ bool PacedSender::SendPacket(Priority priority, uint32_t ssrc,
     UpdateMediaBytesSent(bytes);
     return true;  // We can send now.
   }
+  const int64_t now_ms = TickTime::MillisecondTimestamp();
   if (capture_time_ms < 0) {
-    capture_time_ms = TickTime::MillisecondTimestamp();
+    capture_time_ms = now_ms;
   }
+  StreamMap::const_iterator stream_it = streams_.find(ssrc);
+  const int weight = stream_it != streams_.end() ? stream_it->second.weight : 1;
+  const paced_sender::Packet packet(ssrc, sequence_number, capture_time_ms,
+                                    now_ms, bytes);
   if (paused_) {
     // Queue all packets when we are paused.
     switch (priority) {
       case kHighPriority:
-        high_priority_packets_->push_back(paced_sender::Packet(ssrc,
-                                                               sequence_number,
-                                                               capture_time_ms,
-                                                               bytes));
+        high_priority_packets_->push_back(packet, weight);
         break;
       case kNormalPriority:
         if (capture_time_ms > capture_time_ms_last_queued_) {
@@ -199,31 +362,29 @@ bool PacedSender::SendPacket(Priority priority, uint32_t ssrc,
       case kLowPriority:
         // Queue the low priority packets in the normal priority queue when we
         // are paused to avoid starvation.
-        normal_priority_packets_->push_back(paced_sender::Packet(
-            ssrc, sequence_number, capture_time_ms, bytes));
+        normal_priority_packets_->push_back(packet, weight);
         break;
     }
     return false;
   }
-  paced_sender::PacketList* packet_list = NULL;
+  paced_sender::PacketQueue* packet_queue = NULL;
   switch (priority) {
     case kHighPriority:
-      packet_list = high_priority_packets_.get();
+      packet_queue = high_priority_packets_.get();
       break;
     case kNormalPriority:
-      packet_list = normal_priority_packets_.get();
+      packet_queue = normal_priority_packets_.get();
       break;
     case kLowPriority:
-      packet_list = low_priority_packets_.get();
+      packet_queue = low_priority_packets_.get();
       break;
   }
-  if (packet_list->empty() &&
+  if (packet_queue->empty() &&
       media_budget_->bytes_remaining() > 0) {
     UpdateMediaBytesSent(bytes);
     return true;  // We can send now.
   }
-  packet_list->push_back(paced_sender::Packet(ssrc, sequence_number,
-                                              capture_time_ms, bytes));
+  packet_queue->push_back(packet, weight);
   return false;
 }
 
@@ -231,26 +392,25 @@ int PacedSender::QueueInMs() const {
   CriticalSectionScoped cs(critsect_.get());
   int64_t now_ms = TickTime::MillisecondTimestamp();
   int64_t oldest_packet_capture_time = now_ms;
-  if (!high_priority_packets_->empty()) {
-    oldest_packet_capture_time = std::min(
-        oldest_packet_capture_time,
-        high_priority_packets_->front().capture_time_ms_);
-  }
-  if (!normal_priority_packets_->empty()) {
-    oldest_packet_capture_time = std::min(
-        oldest_packet_capture_time,
-        normal_priority_packets_->front().capture_time_ms_);
-  }
-  if (!low_priority_packets_->empty()) {
-    oldest_packet_capture_time = std::min(
-        oldest_packet_capture_time,
-        low_priority_packets_->front().capture_time_ms_);
-  }
+  oldest_packet_capture_time =
+      high_priority_packets_->OldestCaptureTimeMs(oldest_packet_capture_time);
+  oldest_packet_capture_time =
+      normal_priority_packets_->OldestCaptureTimeMs(oldest_packet_capture_time);
+  oldest_packet_capture_time =
+      low_priority_packets_->OldestCaptureTimeMs(oldest_packet_capture_time);
   return now_ms - oldest_packet_capture_time;
 }
 
+int PacedSender::QueueInPackets() const {
+  CriticalSectionScoped cs(critsect_.get());
+  return NumQueuedPackets();
+}
+
 int32_t PacedSender::TimeUntilNextProcess() {
   CriticalSectionScoped cs(critsect_.get());
+  if (packet_limit_reached_) {
+    return 0;
+  }
   int64_t elapsed_time_ms =
       (TickTime::Now() - time_last_update_).Milliseconds();
   if (elapsed_time_ms <= 0) {
@@ -267,44 +427,98 @@ int32_t PacedSender::Process() {
   CriticalSectionScoped cs(critsect_.get());
   int elapsed_time_ms = (now - time_last_update_).Milliseconds();
   time_last_update_ = now;
-  if (!paused_ && elapsed_time_ms > 0) {
+  // A call right after hitting the packet limit continues on the budget that
+  // is left.
+  const bool continue_batch = packet_limit_reached_;
+  packet_limit_reached_ = false;
+  if (paused_ || (elapsed_time_ms <= 0 && !continue_batch)) {
+    return 0;
+  }
+  if (elapsed_time_ms > 0) {
     uint32_t delta_time_ms = std::min(kMaxIntervalTimeMs, elapsed_time_ms);
     UpdateBytesPerInterval(delta_time_ms);
-    uint32_t ssrc;
-    uint16_t sequence_number;
-    int64_t capture_time_ms;
-    Priority priority;
-    bool last_packet;
-    while (GetNextPacket(&ssrc, &sequence_number, &capture_time_ms,
-                         &priority, &last_packet)) {
-      if (priority == kNormalPriority) {
-        if (capture_time_ms > capture_time_ms_last_sent_) {
-          capture_time_ms_last_sent_ = capture_time_ms;
-        } else if (capture_time_ms == capture_time_ms_last_sent_ &&
-                   last_packet) {
-          TRACE_EVENT_ASYNC_END0("webrtc_rtp", "PacedSend", capture_time_ms);
-        }
+  }
+  const int64_t now_ms = TickTime::MillisecondTimestamp();
+  pending_sends_.clear();
+  paced_sender::Packet packet;
+  Priority priority;
+  bool last_packet;
+  while (static_cast<int>(pending_sends_.size()) < max_packets_per_process_ &&
+         GetNextPacket(&packet, &priority, &last_packet)) {
+    if (priority == kNormalPriority) {
+      if (packet.capture_time_ms_ > capture_time_ms_last_sent_) {
+        capture_time_ms_last_sent_ = packet.capture_time_ms_;
+      } else if (packet.capture_time_ms_ == capture_time_ms_last_sent_ &&
+                 last_packet) {
+        TRACE_EVENT_ASYNC_END0("webrtc_rtp", "PacedSend",
+                               packet.capture_time_ms_);
+      }
+    }
+    UpdateQueueDelayHistogram(now_ms, packet.enqueue_time_ms_);
+    StreamMap::const_iterator stream_it = streams_.find(packet.ssrc_);
+    PendingSend pending_send;
+    if (stream_it != streams_.end()) {
+      pending_send.callback = stream_it->second.callback;
+      pending_send.generation = stream_it->second.generation;
+    } else {
+      pending_send.callback = callback_;
+      pending_send.generation = 0;
+    }
+    pending_send.ssrc = packet.ssrc_;
+    pending_send.sequence_number = packet.sequence_number_;
+    pending_send.capture_time_ms = packet.capture_time_ms_;
+    pending_sends_.push_back(pending_send);
+  }
+  const int queued_packets = NumQueuedPackets();
+  packet_limit_reached_ =
+      static_cast<int>(pending_sends_.size()) == max_packets_per_process_ &&
+      queued_packets > 0;
+  int padding_needed = 0;
+  if (queued_packets == 0 &&
+      padding_budget_->bytes_remaining() > 0 &&
+      pad_up_to_bitrate_budget_->bytes_remaining() > 0) {
+    padding_needed = std::min(padding_budget_->bytes_remaining(),
+                              pad_up_to_bitrate_budget_->bytes_remaining());
+  }
+  if (pending_sends_.empty() && padding_needed == 0) {
+    return 0;
+  }
+  // Call the callbacks for the whole batch without holding |critsect_|, so
+  // that the streams can queue new packets meanwhile. The callback of a
+  // registered stream is only called if the stream is still registered.
+  const uint32_t thread_id = ThreadWrapper::GetThreadId();
+  for (std::vector<PendingSend>::const_iterator it = pending_sends_.begin();
+       it != pending_sends_.end(); ++it) {
+    if (it->generation != 0) {
+      StreamMap::const_iterator stream_it = streams_.find(it->ssrc);
+      if (stream_it == streams_.end() ||
+          stream_it->second.generation != it->generation) {
+        continue;
       }
-      critsect_->Leave();
-      callback_->TimeToSendPacket(ssrc, sequence_number, capture_time_ms);
-      critsect_->Enter();
+      sending_ = true;
+      sending_ssrc_ = it->ssrc;
+      sending_thread_id_ = thread_id;
     }
-    if (high_priority_packets_->empty() &&
-        normal_priority_packets_->empty() &&
-        low_priority_packets_->empty() &&
-        padding_budget_->bytes_remaining() > 0 &&
-        pad_up_to_bitrate_budget_->bytes_remaining() > 0) {
-      int padding_needed = std::min(
-          padding_budget_->bytes_remaining(),
-          pad_up_to_bitrate_budget_->bytes_remaining());
-      critsect_->Leave();
-      int bytes_sent = callback_->TimeToSendPadding(padding_needed);
-      critsect_->Enter();
-      media_budget_->UseBudget(bytes_sent);
-      padding_budget_->UseBudget(bytes_sent);
-      pad_up_to_bitrate_budget_->UseBudget(bytes_sent);
+    critsect_->Leave();
+    it->callback->TimeToSendPacket(it->ssrc, it->sequence_number,
+                                   it->capture_time_ms);
+    critsect_->Enter();
+    if (it->generation != 0) {
+      sending_ = false;
+      callback_done_->WakeAll();
     }
   }
+  int bytes_sent = 0;
+  if (padding_needed > 0) {
+    critsect_->Leave();
+    bytes_sent = callback_->TimeToSendPadding(padding_needed);
+    critsect_->Enter();
+  }
+  if (padding_needed > 0) {
+    media_budget_->UseBudget(bytes_sent);
+    padding_budget_->UseBudget(bytes_sent);
+    pad_up_to_bitrate_budget_->UseBudget(bytes_sent);
+  }
   return 0;
 }
 
@@ -316,9 +530,8 @@ void PacedSender::UpdateBytesPerInterval(uint32_t delta_time_ms) {
 }
 
 // MUST have critsect_ when calling.
-bool PacedSender::GetNextPacket(uint32_t* ssrc, uint16_t* sequence_number,
-                                int64_t* capture_time_ms, Priority* priority,
-                                bool* last_packet) {
+bool PacedSender::GetNextPacket(paced_sender::Packet* packet,
+                                Priority* priority, bool* last_packet) {
   if (media_budget_->bytes_remaining() <= 0) {
     // All bytes consumed for this interval.
     // Check if we have not sent in a too long time.
@@ -326,14 +539,14 @@ bool PacedSender::GetNextPacket(uint32_t* ssrc, uint16_t* sequence_number,
         kMaxQueueTimeWithoutSendingMs) {
       if (!high_priority_packets_->empty()) {
         *priority = kHighPriority;
-        GetNextPacketFromList(high_priority_packets_.get(), ssrc,
-                              sequence_number, capture_time_ms, last_packet);
+        GetNextPacketFromQueue(high_priority_packets_.get(), packet,
+                               last_packet);
         return true;
       }
       if (!normal_priority_packets_->empty()) {
         *priority = kNormalPriority;
-        GetNextPacketFromList(normal_priority_packets_.get(), ssrc,
-                              sequence_number, capture_time_ms, last_packet);
+        GetNextPacketFromQueue(normal_priority_packets_.get(), packet,
+                               last_packet);
         return true;
       }
     }
@@ -341,36 +554,46 @@ bool PacedSender::GetNextPacket(uint32_t* ssrc, uint16_t* sequence_number,
   }
   if (!high_priority_packets_->empty()) {
     *priority = kHighPriority;
-    GetNextPacketFromList(high_priority_packets_.get(), ssrc, sequence_number,
-                          capture_time_ms, last_packet);
+    GetNextPacketFromQueue(high_priority_packets_.get(), packet, last_packet);
     return true;
   }
   if (!normal_priority_packets_->empty()) {
     *priority = kNormalPriority;
-    GetNextPacketFromList(normal_priority_packets_.get(), ssrc,
-                          sequence_number, capture_time_ms, last_packet);
+    GetNextPacketFromQueue(normal_priority_packets_.get(), packet,
+                           last_packet);
     return true;
   }
   if (!low_priority_packets_->empty()) {
     *priority = kLowPriority;
-    GetNextPacketFromList(low_priority_packets_.get(), ssrc, sequence_number,
-                          capture_time_ms, last_packet);
+    GetNextPacketFromQueue(low_priority_packets_.get(), packet, last_packet);
     return true;
   }
   return false;
 }
 
-void PacedSender::GetNextPacketFromList(paced_sender::PacketList* packets,
-    uint32_t* ssrc, uint16_t* sequence_number, int64_t* capture_time_ms,
-    bool* last_packet) {
-  paced_sender::Packet packet = packets->front();
-  UpdateMediaBytesSent(packet.bytes_);
-  *sequence_number = packet.sequence_number_;
-  *ssrc = packet.ssrc_;
-  *capture_time_ms = packet.capture_time_ms_;
-  packets->pop_front();
-  *last_packet = packets->empty() ||
-      packets->front().capture_time_ms_ > *capture_time_ms;
+void PacedSender::GetNextPacketFromQueue(paced_sender::PacketQueue* packets,
+                                         paced_sender::Packet* packet,
+                                         bool* last_packet) {
+  *packet = packets->front();
+  UpdateMediaBytesSent(packet->bytes_);
+  packets->pop_front(last_packet);
+}
+
+// MUST have critsect_ when calling.
+int PacedSender::NumQueuedPackets() const {
+  return high_priority_packets_->size() + normal_priority_packets_->size() +
+      low_priority_packets_->size();
+}
+
+// MUST have critsect_ when calling.
+void PacedSender::UpdateQueueDelayHistogram(int64_t now_ms,
+                                            int64_t enqueue_time_ms) {
+  const int64_t delay_ms = std::max(now_ms - enqueue_time_ms,
+                                    static_cast<int64_t>(0));
+  ++queue_delay_histogram_.counts[QueueDelayBucket(delay_ms)];
+  ++queue_delay_histogram_.num_packets;
+  queue_delay_histogram_.max_delay_ms = std::max(
+      queue_delay_histogram_.max_delay_ms, static_cast<int>(delay_ms));
 }
 
 // MUST have critsect_ when calling.
@@ -11,7 +11,12 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <map>
+
 #include "webrtc/modules/pacing/include/paced_sender.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
 
 using testing::_;
 using testing::Return;
@@ -21,6 +26,7 @@ namespace test {
 
 static const int kTargetBitrate = 800;
 static const float kPaceMultiplier = 1.5f;
+static const unsigned long kEventTimeoutMs = 1000;
 
 class MockPacedSenderCallback : public PacedSender::Callback {
  public:
@@ -51,6 +57,79 @@ class PacedSenderPadding : public PacedSender::Callback {
   int padding_sent_;
 };
 
+// Counts the packets sent per SSRC.
+class PacedSenderCounter : public PacedSender::Callback {
+ public:
+  void TimeToSendPacket(uint32_t ssrc, uint16_t sequence_number,
+                        int64_t capture_time_ms) {
+    ++packets_sent_[ssrc];
+  }
+
+  int TimeToSendPadding(int bytes) {
+    return 0;
+  }
+
+  int packets_sent(uint32_t ssrc) { return packets_sent_[ssrc]; }
+
+ private:
+  std::map<uint32_t, int> packets_sent_;
+};
+
+// Deregisters its own stream and |other_ssrc| from within the callback.
+class DeregisteringCallback : public PacedSender::Callback {
+ public:
+  explicit DeregisteringCallback(uint32_t other_ssrc)
+      : paced_sender_(NULL), other_ssrc_(other_ssrc) {}
+
+  void set_paced_sender(PacedSender* paced_sender) {
+    paced_sender_ = paced_sender;
+  }
+
+  void TimeToSendPacket(uint32_t ssrc, uint16_t sequence_number,
+                        int64_t capture_time_ms) {
+    paced_sender_->DeregisterStream(ssrc);
+    paced_sender_->DeregisterStream(other_ssrc_);
+  }
+
+  int TimeToSendPadding(int bytes) {
+    return 0;
+  }
+
+ private:
+  PacedSender* paced_sender_;
+  const uint32_t other_ssrc_;
+};
+
+// Signals when it is called and then waits for |lock| to be free.
+class BlockingCallback : public PacedSender::Callback {
+ public:
+  explicit BlockingCallback(CriticalSectionWrapper* lock)
+      : lock_(lock), entered_(EventWrapper::Create()) {}
+
+  void TimeToSendPacket(uint32_t ssrc, uint16_t sequence_number,
+                        int64_t capture_time_ms) {
+    entered_->Set();
+    CriticalSectionScoped cs(lock_);
+  }
+
+  int TimeToSendPadding(int bytes) {
+    return 0;
+  }
+
+  bool WaitUntilEntered() {
+    return entered_->Wait(kEventTimeoutMs) == kEventSignaled;
+  }
+
+ private:
+  CriticalSectionWrapper* lock_;
+  scoped_ptr<EventWrapper> entered_;
+};
+
+bool ProcessOnce(void* obj) {
+  static_cast<PacedSender*>(obj)->Process();
+  return false;
+}
+
 class PacedSenderTest : public ::testing::Test {
  protected:
   PacedSenderTest() {
@@ -384,5 +463,196 @@ TEST_F(PacedSenderTest, Pause) {
   EXPECT_EQ(0, send_bucket_->QueueInMs());
 }
 
+TEST_F(PacedSenderTest, WeightedFairQueuing) {
+  const uint32_t kSsrc1 = 12345;
+  const uint32_t kSsrc2 = 12346;
+  uint16_t sequence_number = 1234;
+  int64_t capture_time_ms = 56789;
+  PacedSenderCounter counter;
+  send_bucket_->RegisterStream(kSsrc1, &counter, 1);
+  send_bucket_->RegisterStream(kSsrc2, &counter, 3);
+
+  // Due to the multiplicative factor we can send 3 packets not 2 packets.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(send_bucket_->SendPacket(PacedSender::kNormalPriority, kSsrc1,
+        sequence_number++, capture_time_ms, 250));
+  }
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority,
+        kSsrc1, sequence_number, capture_time_ms, 250));
+    EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority,
+        kSsrc2, sequence_number++, capture_time_ms, 250));
+  }
+  EXPECT_EQ(40, send_bucket_->QueueInPackets());
+  // Registered streams don't use the default callback.
+  EXPECT_CALL(callback_, TimeToSendPacket(_, _, _)).Times(0);
+  for (int k = 0; k < 4; ++k) {
+    TickTime::AdvanceFakeClock(5);
+    EXPECT_EQ(0, send_bucket_->Process());
+  }
+  // 3 packets per interval, shared 1:3.
+  EXPECT_EQ(3, counter.packets_sent(kSsrc1));
+  EXPECT_EQ(9, counter.packets_sent(kSsrc2));
+  EXPECT_EQ(28, send_bucket_->QueueInPackets());
+}
+
+TEST_F(PacedSenderTest, DeregisterStreamDropsQueuedPackets) {
+  const uint32_t kSsrc1 = 12345;
+  const uint32_t kSsrc2 = 12346;
+  uint16_t sequence_number = 1234;
+  int64_t capture_time_ms = 56789;
+  PacedSenderCounter counter;
+  send_bucket_->RegisterStream(kSsrc2, &counter, 1);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(send_bucket_->SendPacket(PacedSender::kNormalPriority, kSsrc1,
+        sequence_number++, capture_time_ms, 250));
+  }
+  EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, kSsrc2,
+      sequence_number++, capture_time_ms, 250));
+  EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kLowPriority, kSsrc2,
+      sequence_number++, capture_time_ms, 250));
+  EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, kSsrc1,
+      sequence_number, capture_time_ms, 250));
+  EXPECT_EQ(3, send_bucket_->QueueInPackets());
+
+  send_bucket_->DeregisterStream(kSsrc2);
+  EXPECT_EQ(1, send_bucket_->QueueInPackets());
+  EXPECT_CALL(callback_,
+      TimeToSendPacket(kSsrc1, sequence_number, capture_time_ms)).Times(1);
+  TickTime::AdvanceFakeClock(5);
+  EXPECT_EQ(0, send_bucket_->Process());
+  EXPECT_EQ(0, counter.packets_sent(kSsrc2));
+  EXPECT_EQ(0, send_bucket_->QueueInPackets());
+}
+
+TEST_F(PacedSenderTest, DeregisterStreamFromCallbackSkipsRestOfBatch) {
+  const uint32_t kSsrc1 = 12345;
+  const uint32_t kSsrc2 = 12346;
+  const uint32_t kSsrc3 = 12347;
+  uint16_t sequence_number = 1234;
+  int64_t capture_time_ms = 56789;
+  DeregisteringCallback deregistering_callback(kSsrc2);
+  deregistering_callback.set_paced_sender(send_bucket_.get());
+  PacedSenderCounter counter;
+  send_bucket_->RegisterStream(kSsrc1, &deregistering_callback, 1);
+  send_bucket_->RegisterStream(kSsrc2, &counter, 1);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(send_bucket_->SendPacket(PacedSender::kNormalPriority, kSsrc3,
+        sequence_number++, capture_time_ms, 250));
+  }
+  EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kHighPriority, kSsrc1,
+      sequence_number++, capture_time_ms, 250));
+  EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, kSsrc2,
+      sequence_number++, capture_time_ms, 250));
+
+  // Both packets are in the batch, but the callback of |kSsrc1| deregisters
+  // both streams before the packet of |kSsrc2| is handed out.
+  TickTime::AdvanceFakeClock(5);
+  EXPECT_EQ(0, send_bucket_->Process());
+  EXPECT_EQ(0, counter.packets_sent(kSsrc2));
+  EXPECT_EQ(0, send_bucket_->QueueInPackets());
+}
+
+TEST_F(PacedSenderTest, DeregisterStreamDoesNotWaitForOtherStreams) {
+  const uint32_t kSsrc1 = 12345;
+  const uint32_t kSsrc2 = 12346;
+  const uint32_t kSsrc3 = 12347;
+  uint16_t sequence_number = 1234;
+  int64_t capture_time_ms = 56789;
+  scoped_ptr<CriticalSectionWrapper> lock(
+      CriticalSectionWrapper::CreateCriticalSection());
+  BlockingCallback blocking_callback(lock.get());
+  PacedSenderCounter counter;
+  send_bucket_->RegisterStream(kSsrc1, &blocking_callback, 1);
+  send_bucket_->RegisterStream(kSsrc2, &counter, 1);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(send_bucket_->SendPacket(PacedSender::kNormalPriority, kSsrc3,
+        sequence_number++, capture_time_ms, 250));
+  }
+  EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, kSsrc1,
+      sequence_number++, capture_time_ms, 250));
+  TickTime::AdvanceFakeClock(5);
+
+  lock->Enter();
+  scoped_ptr<ThreadWrapper> thread(
+      ThreadWrapper::CreateThread(&ProcessOnce, send_bucket_.get()));
+  unsigned int id = 0;
+  ASSERT_TRUE(thread->Start(id));
+  ASSERT_TRUE(blocking_callback.WaitUntilEntered());
+
+  // The callback of |kSsrc1| waits for |lock|, which doesn't keep |kSsrc2|
+  // from being deregistered.
+  send_bucket_->DeregisterStream(kSsrc2);
+  lock->Leave();
+  EXPECT_TRUE(thread->Stop());
+  EXPECT_EQ(0, send_bucket_->QueueInPackets());
+}
+
+TEST_F(PacedSenderTest, MaxPacketsPerProcess) {
+  uint32_t ssrc = 12345;
+  uint16_t sequence_number = 1234;
+  int64_t capture_time_ms = 56789;
+  send_bucket_->SetMaxPacketsPerProcess(2);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc,
+        sequence_number++, capture_time_ms, 250));
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc,
+        sequence_number++, capture_time_ms, 250));
+  }
+  EXPECT_CALL(callback_, TimeToSendPadding(_)).Times(0);
+  EXPECT_CALL(callback_, TimeToSendPacket(ssrc, _, capture_time_ms)).Times(2);
+  TickTime::AdvanceFakeClock(5);
+  EXPECT_EQ(0, send_bucket_->Process());
+  EXPECT_EQ(3, send_bucket_->QueueInPackets());
+
+  // The limit was hit with budget left, so the next batch is due right away.
+  EXPECT_EQ(0, send_bucket_->TimeUntilNextProcess());
+  EXPECT_CALL(callback_, TimeToSendPacket(ssrc, _, capture_time_ms)).Times(1);
+  EXPECT_EQ(0, send_bucket_->Process());
+  EXPECT_EQ(2, send_bucket_->QueueInPackets());
+  EXPECT_EQ(5, send_bucket_->TimeUntilNextProcess());
+}
+
+TEST_F(PacedSenderTest, QueueDelayHistogram) {
+  uint32_t ssrc = 12345;
+  uint16_t sequence_number = 1234;
+  int64_t capture_time_ms = 56789;
+
+  PacedSender::QueueDelayHistogram histogram;
+  send_bucket_->GetQueueDelayHistogram(&histogram);
+  EXPECT_EQ(0u, histogram.num_packets);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc,
+        sequence_number++, capture_time_ms, 250));
+  }
+  // Queue 3 packets at once and 3 more after 5 ms.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc,
+        sequence_number++, capture_time_ms, 250));
+  }
+  TickTime::AdvanceFakeClock(5);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc,
+        sequence_number++, capture_time_ms, 250));
+  }
+  EXPECT_CALL(callback_, TimeToSendPacket(ssrc, _, capture_time_ms)).Times(6);
+  EXPECT_EQ(0, send_bucket_->Process());
+  TickTime::AdvanceFakeClock(5);
+  EXPECT_EQ(0, send_bucket_->Process());
+
+  send_bucket_->GetQueueDelayHistogram(&histogram);
+  EXPECT_EQ(6u, histogram.num_packets);
+  // Both sets of packets waited 5 ms, which falls in [4, 8) ms.
+  EXPECT_EQ(6u, histogram.counts[3]);
+  EXPECT_EQ(5, histogram.max_delay_ms);
+}
+
 }  // namespace test
 }  // namespace webrtc
@@ -37,6 +37,13 @@ class RemoteBitrateObserver {
   virtual ~RemoteBitrateObserver() {}
 };
 
+// An incoming RTP packet, as given to RemoteBitrateEstimator::IncomingPackets.
+struct PacketArrival {
+  int64_t arrival_time_ms;
+  int payload_size;
+  RTPHeader header;
+};
+
 class RemoteBitrateEstimator : public CallStatsObserver, public Module {
  public:
   virtual ~RemoteBitrateEstimator() {}
@@ -57,6 +64,17 @@ class RemoteBitrateEstimator : public CallStatsObserver, public Module {
                               int payload_size,
                               const RTPHeader& header) = 0;
 
+  // Same as IncomingPacket() for each of the |num_packets| packets, which
+  // must be in arrival order. Estimators may process the packets of a batch
+  // together.
+  virtual void IncomingPackets(const PacketArrival* packets,
+                               int num_packets) {
+    for (int i = 0; i < num_packets; ++i) {
+      IncomingPacket(packets[i].arrival_time_ms, packets[i].payload_size,
+                     packets[i].header);
+    }
+  }
+
   // Removes all data for |ssrc|.
   virtual void RemoveStream(unsigned int ssrc) = 0;
 
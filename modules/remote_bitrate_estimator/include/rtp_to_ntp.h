@@ -34,6 +34,12 @@ typedef std::list<RtcpMeasurement> RtcpList;
 bool RtpToNtpMs(int64_t rtp_timestamp, const RtcpList& rtcp,
                 int64_t* timestamp_in_ms);
 
+// Same as above, with the two pairs given by value rather than in a list.
+bool RtpToNtpMs(int64_t rtp_timestamp,
+                const RtcpMeasurement& newest,
+                const RtcpMeasurement& oldest,
+                int64_t* timestamp_in_ms);
+
 // Returns 1 there has been a forward wrap around, 0 if there has been no wrap
 // around and -1 if there has been a backwards wrap around (i.e. reordering).
 int CheckForWrapArounds(uint32_t rtp_timestamp, uint32_t rtcp_rtp_timestamp);
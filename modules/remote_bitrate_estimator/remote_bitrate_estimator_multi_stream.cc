@@ -8,7 +8,8 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
-#include <map>
+#include <algorithm>
+#include <vector>
 
 #include "webrtc/modules/remote_bitrate_estimator/bitrate_estimator.h"
 #include "webrtc/modules/remote_bitrate_estimator/include/remote_bitrate_estimator.h"
@@ -24,6 +25,80 @@
 
 namespace webrtc {
 namespace {
+
+// The two latest unique RTCP SR measurements of a stream, in a fixed ring.
+class RtcpHistory {
+ public:
+  RtcpHistory() : size_(0), newest_(0) {}
+
+  // Stores |measurement|, replacing the oldest one if the history is full.
+  // Returns false without storing if |measurement| has the NTP time or the
+  // RTP timestamp of a stored measurement, as two unique data points are
+  // needed to calculate the RTP timestamp frequency.
+  bool Insert(const synchronization::RtcpMeasurement& measurement) {
+    for (int i = 0; i < size_; ++i) {
+      const synchronization::RtcpMeasurement& stored = measurements_[i];
+      if ((measurement.ntp_secs == stored.ntp_secs &&
+          measurement.ntp_frac == stored.ntp_frac) ||
+          measurement.rtp_timestamp == stored.rtp_timestamp) {
+        return false;
+      }
+    }
+    newest_ = (newest_ + 1) % kCapacity;
+    measurements_[newest_] = measurement;
+    if (size_ < kCapacity)
+      ++size_;
+    return true;
+  }
+
+  bool full() const { return size_ == kCapacity; }
+
+  // Converts |rtp_timestamp| to NTP time in milliseconds. The history must
+  // be full.
+  bool RtpToNtpMs(int64_t rtp_timestamp, int64_t* timestamp_in_ms) const {
+    assert(full());
+    return synchronization::RtpToNtpMs(
+        rtp_timestamp, measurements_[newest_],
+        measurements_[(newest_ + 1) % kCapacity], timestamp_in_ms);
+  }
+
+ private:
+  static const int kCapacity = 2;
+
+  synchronization::RtcpMeasurement measurements_[kCapacity];
+  int size_;
+  int newest_;
+};
+
+struct Stream {
+  explicit Stream(unsigned int ssrc) : ssrc(ssrc) {}
+
+  bool operator<(const Stream& other) const { return ssrc < other.ssrc; }
+
+  unsigned int ssrc;
+  RtcpHistory rtcp;
+};
+
+// Consecutive packets of a stream with the same timestamp, given to the
+// over-use detector as one update.
+struct PacketGroup {
+  PacketGroup()
+      : size(0),
+        rtp_timestamp(0),
+        timestamp_ms(-1),
+        ssrc(0),
+        last_arrival_time_ms(-1) {}
+
+  // The detector takes the size as a uint16_t.
+  static const int kMaxSize = 0xffff;
+
+  int size;
+  uint32_t rtp_timestamp;
+  int64_t timestamp_ms;
+  unsigned int ssrc;
+  int64_t last_arrival_time_ms;
+};
+
 class RemoteBitrateEstimatorMultiStream : public RemoteBitrateEstimator {
  public:
   RemoteBitrateEstimatorMultiStream(RemoteBitrateObserver* observer,
@@ -46,6 +121,11 @@ class RemoteBitrateEstimatorMultiStream : public RemoteBitrateEstimator {
                               int payload_size,
                               const RTPHeader& header);
 
+  // Takes the lock once for the batch, and updates the over-use detector
+  // once per group of consecutive packets with the same SSRC and timestamp
+  // rather than once per packet. Over-use is checked for once per group.
+  virtual void IncomingPackets(const PacketArrival* packets, int num_packets);
+
   // Triggers a new estimate calculation.
   // Implements the Module interface.
   virtual int32_t Process();
@@ -64,7 +144,21 @@ class RemoteBitrateEstimatorMultiStream : public RemoteBitrateEstimator {
                               unsigned int* bitrate_bps) const;
 
  private:
-  typedef std::map<unsigned int, synchronization::RtcpList> StreamMap;
+  // Sorted by SSRC.
+  typedef std::vector<Stream> StreamList;
+
+  // Returns the stream with |ssrc|, adding it if it doesn't exist.
+  Stream* FindOrAddStream(unsigned int ssrc);
+
+  // Adds a packet to |group|. The group is given to the over-use detector
+  // first if the packet doesn't belong to it.
+  void AddPacketToGroup(int64_t arrival_time_ms,
+                        int payload_size,
+                        const RTPHeader& header,
+                        PacketGroup* group);
+
+  // Updates the over-use detector with the packets of |group| and empties it.
+  void UpdateDetector(PacketGroup* group);
 
   // Triggers a new estimate calculation.
   void UpdateEstimate(int64_t time_now);
@@ -76,7 +170,7 @@ class RemoteBitrateEstimatorMultiStream : public RemoteBitrateEstimator {
   OveruseDetector overuse_detector_;
   BitRateStats incoming_bitrate_;
   RemoteBitrateObserver* observer_;
-  StreamMap streams_;
+  StreamList streams_;
   scoped_ptr<CriticalSectionWrapper> crit_sect_;
   unsigned int initial_ssrc_;
   bool multi_stream_;
@@ -109,46 +203,59 @@ void RemoteBitrateEstimatorMultiStream::IncomingRtcp(unsigned int ssrc,
   if (ntp_secs == 0 && ntp_frac == 0) {
     return;
   }
-  // Insert a new RTCP list mapped to this SSRC if one doesn't already exist.
-  std::pair<StreamMap::iterator, bool> stream_insert_result =
-      streams_.insert(std::make_pair(ssrc, synchronization::RtcpList()));
-  StreamMap::iterator stream_it = stream_insert_result.first;
-  synchronization::RtcpList* rtcp_list = &stream_it->second;
-  synchronization::RtcpMeasurement measurement(ntp_secs, ntp_frac, timestamp);
-  // Make sure this RTCP is unique as we need two unique data points to
-  // calculate the RTP timestamp frequency.
-  for (synchronization::RtcpList::iterator it = rtcp_list->begin();
-      it != rtcp_list->end(); ++it) {
-    if ((measurement.ntp_secs == (*it).ntp_secs &&
-        measurement.ntp_frac == (*it).ntp_frac) ||
-        measurement.rtp_timestamp == (*it).rtp_timestamp) {
-      return;
-    }
+  RtcpHistory* rtcp = &FindOrAddStream(ssrc)->rtcp;
+  if (!rtcp->Insert(
+      synchronization::RtcpMeasurement(ntp_secs, ntp_frac, timestamp))) {
+    return;
   }
-  // If this stream will get two RTCPs when the new one is added we can switch
-  // to multi-stream mode.
-  if (!multi_stream_ && rtcp_list->size() >= 1) {
+  // As soon as a stream has two RTCPs we can switch to multi-stream mode.
+  if (rtcp->full()) {
     multi_stream_ = true;
   }
-  if (rtcp_list->size() >= 2) {
-    rtcp_list->pop_back();
-  }
-  rtcp_list->push_front(measurement);
 }
 
 void RemoteBitrateEstimatorMultiStream::IncomingPacket(
     int64_t arrival_time_ms,
     int payload_size,
     const RTPHeader& header) {
+  CriticalSectionScoped cs(crit_sect_.get());
+  PacketGroup group;
+  AddPacketToGroup(arrival_time_ms, payload_size, header, &group);
+  UpdateDetector(&group);
+}
+
+void RemoteBitrateEstimatorMultiStream::IncomingPackets(
+    const PacketArrival* packets,
+    int num_packets) {
+  CriticalSectionScoped cs(crit_sect_.get());
+  PacketGroup group;
+  for (int i = 0; i < num_packets; ++i) {
+    AddPacketToGroup(packets[i].arrival_time_ms, packets[i].payload_size,
+                     packets[i].header, &group);
+  }
+  UpdateDetector(&group);
+}
+
+Stream* RemoteBitrateEstimatorMultiStream::FindOrAddStream(
+    unsigned int ssrc) {
+  const Stream key(ssrc);
+  StreamList::iterator it = std::lower_bound(streams_.begin(), streams_.end(),
+                                             key);
+  if (it == streams_.end() || it->ssrc != ssrc)
+    it = streams_.insert(it, key);
+  return &*it;
+}
+
+void RemoteBitrateEstimatorMultiStream::AddPacketToGroup(
+    int64_t arrival_time_ms,
+    int payload_size,
+    const RTPHeader& header,
+    PacketGroup* group) {
   uint32_t ssrc = header.ssrc;
   uint32_t rtp_timestamp = header.timestamp +
       header.extension.transmissionTimeOffset;
-  CriticalSectionScoped cs(crit_sect_.get());
   incoming_bitrate_.Update(payload_size, arrival_time_ms);
-  // Add this stream to the map of streams if it doesn't already exist.
-  std::pair<StreamMap::iterator, bool> stream_insert_result =
-      streams_.insert(std::make_pair(ssrc, synchronization::RtcpList()));
-  synchronization::RtcpList* rtcp_list = &stream_insert_result.first->second;
+  const RtcpHistory& rtcp = FindOrAddStream(ssrc)->rtcp;
   if (initial_ssrc_ == 0) {
     initial_ssrc_ = ssrc;
   }
@@ -158,17 +265,37 @@ void RemoteBitrateEstimatorMultiStream::IncomingPacket(
       // mode.
       return;
     }
-  } else if (rtcp_list->size() < 2) {
+  } else if (!rtcp.full()) {
     // We can't use this stream until we have received two RTCP SR reports.
     return;
   }
-  const BandwidthUsage prior_state = overuse_detector_.State();
   int64_t timestamp_in_ms = -1;
   if (multi_stream_) {
-    synchronization::RtpToNtpMs(rtp_timestamp, *rtcp_list, &timestamp_in_ms);
+    rtcp.RtpToNtpMs(rtp_timestamp, &timestamp_in_ms);
   }
-  overuse_detector_.Update(payload_size, timestamp_in_ms, rtp_timestamp,
-                           arrival_time_ms);
+  if (group->size > 0 &&
+      (ssrc != group->ssrc ||
+       rtp_timestamp != group->rtp_timestamp ||
+       timestamp_in_ms != group->timestamp_ms ||
+       group->size + payload_size > PacketGroup::kMaxSize)) {
+    UpdateDetector(group);
+  }
+  group->size += payload_size;
+  group->rtp_timestamp = rtp_timestamp;
+  group->timestamp_ms = timestamp_in_ms;
+  group->ssrc = ssrc;
+  group->last_arrival_time_ms = arrival_time_ms;
+}
+
+void RemoteBitrateEstimatorMultiStream::UpdateDetector(PacketGroup* group) {
+  if (group->size == 0) {
+    return;
+  }
+  const int64_t arrival_time_ms = group->last_arrival_time_ms;
+  const BandwidthUsage prior_state = overuse_detector_.State();
+  overuse_detector_.Update(group->size, group->timestamp_ms,
+                           group->rtp_timestamp, arrival_time_ms);
+  group->size = 0;
   if (overuse_detector_.State() == kBwOverusing) {
     unsigned int incoming_bitrate = incoming_bitrate_.BitRate(arrival_time_ms);
     if (prior_state != kBwOverusing ||
@@ -230,7 +357,10 @@ void RemoteBitrateEstimatorMultiStream::OnRttUpdate(uint32_t rtt) {
 
 void RemoteBitrateEstimatorMultiStream::RemoveStream(unsigned int ssrc) {
   CriticalSectionScoped cs(crit_sect_.get());
-  streams_.erase(ssrc);
+  StreamList::iterator it = std::lower_bound(streams_.begin(), streams_.end(),
+                                             Stream(ssrc));
+  if (it != streams_.end() && it->ssrc == ssrc)
+    streams_.erase(it);
 }
 
 bool RemoteBitrateEstimatorMultiStream::LatestEstimate(
@@ -254,9 +384,9 @@ void RemoteBitrateEstimatorMultiStream::GetSsrcs(
   assert(ssrcs);
   ssrcs->resize(streams_.size());
   int i = 0;
-  for (StreamMap::const_iterator it = streams_.begin(); it != streams_.end();
+  for (StreamList::const_iterator it = streams_.begin(); it != streams_.end();
       ++it, ++i) {
-    (*ssrcs)[i] = it->first;
+    (*ssrcs)[i] = it->ssrc;
   }
 }
 }  // namespace
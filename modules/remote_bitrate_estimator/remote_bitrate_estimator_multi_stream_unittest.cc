@@ -73,4 +73,47 @@ TEST_F(RemoteBitrateEstimatorMultiTest, CapacityDropNineteenStreamsWrap) {
 TEST_F(RemoteBitrateEstimatorMultiTest, CapacityDropThirtyStreamsWrap) {
   CapacityDropTestHelper(30, true, 918724, 433);
 }
+
+// The batched estimator checks for over-use once per frame rather than once
+// per packet, so the estimates may differ slightly.
+TEST_F(RemoteBitrateEstimatorMultiTest, BatchedPacketsGiveSimilarEstimate) {
+  const int kPacketsPerFrame = 3;
+  const int kFrameIntervalMs = 33;
+  testing::TestBitrateObserver batched_observer;
+  scoped_ptr<RemoteBitrateEstimator> batched_estimator(
+      MultiStreamRemoteBitrateEstimatorFactory().Create(&batched_observer,
+                                                        &clock_));
+  PacketArrival frame[kPacketsPerFrame];
+  memset(frame, 0, sizeof(frame));
+  int64_t queue_delay_ms = 0;
+  for (int i = 0; i < 300; ++i) {
+    // The link gets congested after 100 frames.
+    if (i >= 100)
+      queue_delay_ms += 3;
+    for (int j = 0; j < kPacketsPerFrame; ++j) {
+      frame[j].arrival_time_ms =
+          clock_.TimeInMilliseconds() + queue_delay_ms + 2 * j;
+      frame[j].payload_size = 1200;
+      frame[j].header.ssrc = kDefaultSsrc;
+      frame[j].header.timestamp = 90 * kFrameIntervalMs * i;
+      bitrate_estimator_->IncomingPacket(frame[j].arrival_time_ms,
+                                         frame[j].payload_size,
+                                         frame[j].header);
+    }
+    batched_estimator->IncomingPackets(frame, kPacketsPerFrame);
+    clock_.AdvanceTimeMilliseconds(kFrameIntervalMs);
+    bitrate_estimator_->Process();
+    batched_estimator->Process();
+  }
+  std::vector<unsigned int> ssrcs;
+  unsigned int bitrate_bps = 0;
+  unsigned int batched_bitrate_bps = 0;
+  ASSERT_TRUE(bitrate_estimator_->LatestEstimate(&ssrcs, &bitrate_bps));
+  ASSERT_TRUE(batched_estimator->LatestEstimate(&ssrcs,
+                                                &batched_bitrate_bps));
+  // Both have reacted to the congestion.
+  EXPECT_LT(bitrate_bps, 1000000u);
+  EXPECT_NEAR(bitrate_bps, batched_bitrate_bps, bitrate_bps / 20);
+  EXPECT_TRUE(batched_observer.updated());
+}
 }  // namespace webrtc
@@ -67,12 +67,18 @@ bool RtpToNtpMs(int64_t rtp_timestamp,
                 const synchronization::RtcpList& rtcp,
                 int64_t* rtp_timestamp_in_ms) {
   assert(rtcp.size() == 2);
-  int64_t rtcp_ntp_ms_new = Clock::NtpToMs(rtcp.front().ntp_secs,
-                                           rtcp.front().ntp_frac);
-  int64_t rtcp_ntp_ms_old = Clock::NtpToMs(rtcp.back().ntp_secs,
-                                           rtcp.back().ntp_frac);
-  int64_t rtcp_timestamp_new = rtcp.front().rtp_timestamp;
-  int64_t rtcp_timestamp_old = rtcp.back().rtp_timestamp;
+  return RtpToNtpMs(rtp_timestamp, rtcp.front(), rtcp.back(),
+                    rtp_timestamp_in_ms);
+}
+
+bool RtpToNtpMs(int64_t rtp_timestamp,
+                const RtcpMeasurement& newest,
+                const RtcpMeasurement& oldest,
+                int64_t* rtp_timestamp_in_ms) {
+  int64_t rtcp_ntp_ms_new = Clock::NtpToMs(newest.ntp_secs, newest.ntp_frac);
+  int64_t rtcp_ntp_ms_old = Clock::NtpToMs(oldest.ntp_secs, oldest.ntp_frac);
+  int64_t rtcp_timestamp_new = newest.rtp_timestamp;
+  int64_t rtcp_timestamp_old = oldest.rtp_timestamp;
   if (!CompensateForWrapAround(rtcp_timestamp_new,
                                rtcp_timestamp_old,
                                &rtcp_timestamp_new)) {
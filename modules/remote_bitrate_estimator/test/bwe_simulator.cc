@@ -0,0 +1,346 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/remote_bitrate_estimator/test/bwe_simulator.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace testing {
+namespace bwe {
+
+namespace {
+
+const float kPaceMultiplier = 2.5f;
+const int kCrossTrafficPayloadSize = 1000;
+const int kDefaultCapacityKbps = 1000;
+
+// Converts |time_us| to the 6.18 fixed point seconds of the absolute send
+// time header extension.
+uint32_t AbsSendTime(int64_t time_us) {
+  return static_cast<uint32_t>(((time_us << 18) + 500000) / 1000000) &
+      0x00ffffff;
+}
+
+}  // namespace
+
+const int VideoSender::kMaxPayloadSize;
+
+VideoSender::VideoSender(uint32_t ssrc, int fps, int start_bitrate_kbps,
+                         int64_t start_time_ms)
+    : ssrc_(ssrc),
+      frame_interval_ms_(1000 / fps),
+      start_time_ms_(start_time_ms),
+      target_bitrate_kbps_(start_bitrate_kbps),
+      now_ms_(0),
+      next_frame_ms_(0),
+      sequence_number_(0),
+      pacer_(this, start_bitrate_kbps, kPaceMultiplier),
+      sent_(NULL) {
+  assert(fps > 0 && fps <= 1000);
+  pacer_.SetStatus(true);
+}
+
+void VideoSender::RunFor(int64_t time_ms, Packets* packets) {
+  assert(packets);
+  sent_ = packets;
+  if (now_ms_ >= next_frame_ms_) {
+    EncodeFrame();
+    next_frame_ms_ += frame_interval_ms_;
+  }
+  if (pacer_.TimeUntilNextProcess() <= 0)
+    pacer_.Process();
+  sent_ = NULL;
+  now_ms_ += time_ms;
+}
+
+void VideoSender::OnNetworkChanged(const uint32_t target_bitrate,
+                                   const uint8_t fraction_loss,
+                                   const uint32_t rtt) {
+  target_bitrate_kbps_ = target_bitrate / 1000;
+  pacer_.UpdateBitrate(target_bitrate_kbps_, 0);
+}
+
+void VideoSender::TimeToSendPacket(uint32_t ssrc, uint16_t sequence_number,
+                                   int64_t capture_time_ms) {
+  assert(sent_);
+  assert(!queued_.empty());
+  assert(queued_.front().header.sequenceNumber == sequence_number);
+  Send(queued_.begin());
+}
+
+int VideoSender::TimeToSendPadding(int bytes) {
+  return 0;
+}
+
+void VideoSender::Send(Packets::iterator packet) {
+  packet->send_time_us = now_ms_ * 1000;
+  packet->header.extension.absoluteSendTime =
+      AbsSendTime(packet->send_time_us);
+  sent_->splice(sent_->end(), queued_, packet);
+}
+
+void VideoSender::EncodeFrame() {
+  int frame_size = target_bitrate_kbps_ * frame_interval_ms_ / 8;
+  const int num_packets = (frame_size + kMaxPayloadSize - 1) / kMaxPayloadSize;
+  RTPHeader header;
+  memset(&header, 0, sizeof(header));
+  header.ssrc = ssrc_;
+  header.timestamp = static_cast<uint32_t>(90 * now_ms_);
+  header.headerLength = 12;
+  const int64_t capture_time_ms = start_time_ms_ + now_ms_;
+  for (int i = 0; i < num_packets; ++i) {
+    const int payload_size = std::min(frame_size, kMaxPayloadSize);
+    frame_size -= payload_size;
+    header.sequenceNumber = sequence_number_++;
+    header.markerBit = (i == num_packets - 1);
+    queued_.push_back(Packet(now_ms_ * 1000, payload_size, header));
+    if (pacer_.SendPacket(PacedSender::kNormalPriority, ssrc_,
+                          header.sequenceNumber, capture_time_ms,
+                          payload_size)) {
+      Send(--queued_.end());
+    }
+  }
+}
+
+BweSimulator::Config::Config()
+    : estimator(kMultiStream),
+      fps(30),
+      start_bitrate_kbps(300),
+      min_bitrate_kbps(30),
+      max_bitrate_kbps(2000),
+      capacity_trace(),
+      max_queue_delay_ms(1000),
+      one_way_delay_ms(50),
+      loss_percent(0.0f),
+      mean_loss_burst_length(1.0f),
+      cross_traffic_kbps(0),
+      seed(1) {
+}
+
+BweSimulator::Stats::Stats()
+    : duration_ms(0),
+      video_kbps(0),
+      cross_traffic_kbps(0),
+      utilization(0.0f),
+      mean_delay_ms(0),
+      max_delay_ms(0),
+      video_loss_percent(0.0f),
+      target_bitrate_kbps(0),
+      estimate_kbps(0) {
+}
+
+BweSimulator::BweSimulator(const Config& config)
+    : config_(config),
+      now_ms_(0),
+      clock_(StartFakeTickTime()),
+      next_capacity_step_(0),
+      bitrate_controller_(BitrateController::CreateBitrateController()),
+      bandwidth_observer_(bitrate_controller_->CreateRtcpBandwidthObserver()),
+      sender_(kVideoSsrc, config.fps, config.start_bitrate_kbps,
+              kStartTimeMs),
+      cross_traffic_(kCrossTrafficSsrc, config.cross_traffic_kbps,
+                     kCrossTrafficPayloadSize),
+      link_(kDefaultCapacityKbps, config.max_queue_delay_ms),
+      loss_(config.loss_percent, config.mean_loss_burst_length, config.seed),
+      delay_(config.one_way_delay_ms),
+      network_(),
+      estimator_(),
+      feedback_(),
+      next_rtcp_ms_(kRtcpIntervalMs),
+      latest_estimate_bps_(0),
+      capacity_bits_(0),
+      video_bytes_(0),
+      cross_traffic_bytes_(0),
+      num_video_packets_(0),
+      sum_delay_ms_(0),
+      max_delay_ms_(0),
+      received_video_(false),
+      first_sequence_number_(0),
+      extended_max_sequence_number_(0),
+      num_received_since_report_(0),
+      extended_max_at_last_report_(0) {
+  network_.push_back(&cross_traffic_);
+  network_.push_back(&link_);
+  network_.push_back(&loss_);
+  network_.push_back(&delay_);
+  switch (config.estimator) {
+    case kSingleStream:
+      estimator_.reset(RemoteBitrateEstimatorFactory().Create(this, &clock_));
+      break;
+    case kAbsoluteSendTime:
+      estimator_.reset(AbsoluteSendTimeRemoteBitrateEstimatorFactory().Create(
+          this, &clock_));
+      break;
+    case kMultiStream:
+      estimator_.reset(MultiStreamRemoteBitrateEstimatorFactory().Create(
+          this, &clock_));
+      break;
+  }
+  bitrate_controller_->SetBitrateObserver(&sender_,
+                                          config.start_bitrate_kbps * 1000,
+                                          config.min_bitrate_kbps * 1000,
+                                          config.max_bitrate_kbps * 1000);
+}
+
+BweSimulator::~BweSimulator() {
+  bitrate_controller_->RemoveBitrateObserver(&sender_);
+}
+
+int64_t BweSimulator::StartFakeTickTime() {
+  // The pacer reads TickTime when it is created.
+  TickTime::UseFakeClock(kStartTimeMs);
+  return kStartTimeMs;
+}
+
+void BweSimulator::RunFor(int64_t time_ms) {
+  const int64_t end_ms = now_ms_ + time_ms;
+  while (now_ms_ < end_ms) {
+    while (next_capacity_step_ < config_.capacity_trace.size() &&
+           config_.capacity_trace[next_capacity_step_].time_ms <= now_ms_) {
+      link_.set_capacity_kbps(
+          config_.capacity_trace[next_capacity_step_].capacity_kbps);
+      ++next_capacity_step_;
+    }
+    capacity_bits_ += link_.capacity_kbps() * kStepMs;
+
+    Packets packets;
+    sender_.RunFor(kStepMs, &packets);
+    for (size_t i = 0; i < network_.size(); ++i)
+      network_[i]->RunFor(kStepMs, &packets);
+
+    now_ms_ += kStepMs;
+    clock_.AdvanceTimeMilliseconds(kStepMs);
+    TickTime::AdvanceFakeClock(kStepMs);
+
+    ReceivePackets(packets);
+    if (estimator_->TimeUntilNextProcess() <= 0)
+      estimator_->Process();
+    if (now_ms_ >= next_rtcp_ms_) {
+      SendReceiverReport();
+      next_rtcp_ms_ += kRtcpIntervalMs;
+    }
+    DeliverFeedback();
+  }
+}
+
+void BweSimulator::GetStats(Stats* stats) const {
+  assert(stats);
+  stats->duration_ms = now_ms_;
+  if (now_ms_ > 0) {
+    stats->video_kbps = static_cast<int>(video_bytes_ * 8 / now_ms_);
+    stats->cross_traffic_kbps =
+        static_cast<int>(cross_traffic_bytes_ * 8 / now_ms_);
+  }
+  if (capacity_bits_ > 0) {
+    stats->utilization = static_cast<float>(
+        (video_bytes_ + cross_traffic_bytes_) * 8) / capacity_bits_;
+  }
+  if (num_video_packets_ > 0) {
+    stats->mean_delay_ms =
+        static_cast<int>(sum_delay_ms_ / num_video_packets_);
+    const int64_t expected = static_cast<int64_t>(
+        extended_max_sequence_number_ - first_sequence_number_) + 1;
+    stats->video_loss_percent =
+        100.0f * (expected - num_video_packets_) / expected;
+  }
+  stats->max_delay_ms = max_delay_ms_;
+  stats->target_bitrate_kbps = sender_.target_bitrate_kbps();
+  stats->estimate_kbps = latest_estimate_bps_ / 1000;
+}
+
+void BweSimulator::OnReceiveBitrateChanged(
+    const std::vector<unsigned int>& ssrcs,
+    unsigned int bitrate) {
+  latest_estimate_bps_ = bitrate;
+  Feedback feedback;
+  memset(&feedback, 0, sizeof(feedback));
+  feedback.time_ms = now_ms_ + config_.one_way_delay_ms;
+  feedback.remb = true;
+  feedback.remb_bps = bitrate;
+  feedback_.push_back(feedback);
+}
+
+void BweSimulator::ReceivePackets(const Packets& packets) {
+  for (Packets::const_iterator it = packets.begin(); it != packets.end();
+       ++it) {
+    if (it->header.ssrc == kCrossTrafficSsrc) {
+      cross_traffic_bytes_ += it->payload_size;
+      continue;
+    }
+    const int64_t arrival_time_ms = it->send_time_us / 1000;
+    const int delay_ms =
+        static_cast<int>((it->send_time_us - it->creation_time_us) / 1000);
+    video_bytes_ += it->payload_size;
+    ++num_video_packets_;
+    ++num_received_since_report_;
+    sum_delay_ms_ += delay_ms;
+    if (delay_ms > max_delay_ms_)
+      max_delay_ms_ = delay_ms;
+
+    const uint16_t sequence_number = it->header.sequenceNumber;
+    if (!received_video_) {
+      received_video_ = true;
+      first_sequence_number_ = sequence_number;
+      extended_max_sequence_number_ = sequence_number;
+      extended_max_at_last_report_ = sequence_number - 1;
+    } else if (IsNewerSequenceNumber(
+        sequence_number,
+        static_cast<uint16_t>(extended_max_sequence_number_))) {
+      extended_max_sequence_number_ +=
+          static_cast<uint16_t>(sequence_number -
+                                extended_max_sequence_number_);
+    }
+    estimator_->IncomingPacket(kStartTimeMs + arrival_time_ms,
+                               it->payload_size, it->header);
+  }
+}
+
+void BweSimulator::SendReceiverReport() {
+  if (!received_video_)
+    return;
+  Feedback feedback;
+  memset(&feedback, 0, sizeof(feedback));
+  feedback.time_ms = now_ms_ + config_.one_way_delay_ms;
+  const int64_t expected =
+      extended_max_sequence_number_ - extended_max_at_last_report_;
+  const int64_t lost = expected - num_received_since_report_;
+  if (expected > 0 && lost > 0)
+    feedback.fraction_loss = static_cast<uint8_t>(255 * lost / expected);
+  feedback.extended_max_sequence_number = extended_max_sequence_number_;
+  feedback_.push_back(feedback);
+  extended_max_at_last_report_ = extended_max_sequence_number_;
+  num_received_since_report_ = 0;
+}
+
+void BweSimulator::DeliverFeedback() {
+  const uint32_t rtt_ms = 2 * config_.one_way_delay_ms;
+  while (!feedback_.empty() && feedback_.front().time_ms <= now_ms_) {
+    const Feedback& feedback = feedback_.front();
+    if (feedback.remb) {
+      bandwidth_observer_->OnReceivedEstimatedBitrate(feedback.remb_bps);
+    } else {
+      bandwidth_observer_->OnReceivedRtcpReceiverReport(
+          kVideoSsrc, feedback.fraction_loss, rtt_ms,
+          feedback.extended_max_sequence_number,
+          static_cast<uint32_t>(kStartTimeMs + now_ms_));
+    }
+    feedback_.pop_front();
+  }
+}
+
+}  // namespace bwe
+}  // namespace testing
+}  // namespace webrtc
@@ -0,0 +1,214 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_REMOTE_BITRATE_ESTIMATOR_TEST_BWE_SIMULATOR_H_
+#define WEBRTC_MODULES_REMOTE_BITRATE_ESTIMATOR_TEST_BWE_SIMULATOR_H_
+
+#include <list>
+#include <vector>
+
+#include "webrtc/modules/bitrate_controller/include/bitrate_controller.h"
+#include "webrtc/modules/pacing/include/paced_sender.h"
+#include "webrtc/modules/remote_bitrate_estimator/include/remote_bitrate_estimator.h"
+#include "webrtc/modules/remote_bitrate_estimator/test/bwe_test_framework.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+
+namespace webrtc {
+namespace testing {
+namespace bwe {
+
+// A synthetic encoder which produces frames of the target bitrate given by
+// the send-side bitrate controller, and sends them through a PacedSender.
+class VideoSender : public BitrateObserver, public PacedSender::Callback {
+ public:
+  VideoSender(uint32_t ssrc, int fps, int start_bitrate_kbps,
+              int64_t start_time_ms);
+  virtual ~VideoSender() {}
+
+  // Encodes the frames due in the next |time_ms| and appends the packets the
+  // pacer sends in that time to |packets|. TickTime must be set to the start
+  // of the interval.
+  void RunFor(int64_t time_ms, Packets* packets);
+
+  int target_bitrate_kbps() const { return target_bitrate_kbps_; }
+
+  // Implements BitrateObserver.
+  virtual void OnNetworkChanged(const uint32_t target_bitrate,
+                                const uint8_t fraction_loss,
+                                const uint32_t rtt);
+
+  // Implements PacedSender::Callback.
+  virtual void TimeToSendPacket(uint32_t ssrc, uint16_t sequence_number,
+                                int64_t capture_time_ms);
+  virtual int TimeToSendPadding(int bytes);
+
+ private:
+  static const int kMaxPayloadSize = 1200;
+
+  void EncodeFrame();
+  // Moves |packet| from the pacer queue to the sent packets.
+  void Send(Packets::iterator packet);
+
+  const uint32_t ssrc_;
+  const int frame_interval_ms_;
+  const int64_t start_time_ms_;
+  int target_bitrate_kbps_;
+  int64_t now_ms_;
+  int64_t next_frame_ms_;
+  uint16_t sequence_number_;
+  PacedSender pacer_;
+  // Packets queued in the pacer.
+  Packets queued_;
+  // Where TimeToSendPacket() puts the sent packets.
+  Packets* sent_;
+
+  DISALLOW_COPY_AND_ASSIGN(VideoSender);
+};
+
+// Runs a VideoSender, the real send-side bitrate controller, a simulated
+// network and a real remote bitrate estimator on a simulated clock. The
+// estimator's REMB and the receiver reports are fed back to the bitrate
+// controller after the network delay. A simulation runs much faster than
+// real time, and is deterministic.
+//
+// The simulator sets TickTime to use its fake clock, so only one simulator
+// may run at a time.
+class BweSimulator : public RemoteBitrateObserver {
+ public:
+  enum EstimatorType {
+    kSingleStream,
+    kAbsoluteSendTime,
+    kMultiStream
+  };
+
+  struct CapacityStep {
+    int64_t time_ms;
+    int capacity_kbps;
+  };
+
+  struct Config {
+    Config();
+
+    EstimatorType estimator;
+    int fps;
+    int start_bitrate_kbps;
+    int min_bitrate_kbps;
+    int max_bitrate_kbps;
+    // The link capacity. Each step sets it from its time on. The capacity is
+    // 1000 kbps until the first step.
+    std::vector<CapacityStep> capacity_trace;
+    // Packets which would be queued longer than this at the link are dropped.
+    int max_queue_delay_ms;
+    // Added to all packets after the link, and to the feedback.
+    int one_way_delay_ms;
+    float loss_percent;
+    float mean_loss_burst_length;
+    // Constant bitrate traffic sharing the link.
+    int cross_traffic_kbps;
+    uint32_t seed;
+  };
+
+  struct Stats {
+    Stats();
+
+    int64_t duration_ms;
+    // Average payload bitrates received.
+    int video_kbps;
+    int cross_traffic_kbps;
+    // Share of the link capacity used by the received packets.
+    float utilization;
+    // Time from send to receive of the video packets, including the pacer.
+    int mean_delay_ms;
+    int max_delay_ms;
+    float video_loss_percent;
+    // Bitrates at the end of the simulation.
+    int target_bitrate_kbps;
+    int estimate_kbps;
+  };
+
+  explicit BweSimulator(const Config& config);
+  virtual ~BweSimulator();
+
+  // Runs the simulation for |time_ms| more.
+  void RunFor(int64_t time_ms);
+
+  // Returns the statistics of the simulation so far.
+  void GetStats(Stats* stats) const;
+
+  // Implements RemoteBitrateObserver.
+  virtual void OnReceiveBitrateChanged(const std::vector<unsigned int>& ssrcs,
+                                       unsigned int bitrate);
+
+ private:
+  struct Feedback {
+    int64_t time_ms;
+    bool remb;
+    uint32_t remb_bps;
+    uint8_t fraction_loss;
+    uint32_t extended_max_sequence_number;
+  };
+
+  static const int64_t kStartTimeMs = 100000;
+  static const int kStepMs = 1;
+  static const int kRtcpIntervalMs = 1000;
+  static const uint32_t kVideoSsrc = 0x1234;
+  static const uint32_t kCrossTrafficSsrc = 0x5678;
+
+  // Makes TickTime use a fake clock. Returns the start time.
+  static int64_t StartFakeTickTime();
+
+  void ReceivePackets(const Packets& packets);
+  void SendReceiverReport();
+  void DeliverFeedback();
+
+  const Config config_;
+  // Simulation time, from 0.
+  int64_t now_ms_;
+  SimulatedClock clock_;
+  size_t next_capacity_step_;
+
+  scoped_ptr<BitrateController> bitrate_controller_;
+  scoped_ptr<RtcpBandwidthObserver> bandwidth_observer_;
+  VideoSender sender_;
+
+  CrossTrafficSource cross_traffic_;
+  ChokeFilter link_;
+  LossFilter loss_;
+  DelayFilter delay_;
+  std::vector<PacketProcessor*> network_;
+
+  scoped_ptr<RemoteBitrateEstimator> estimator_;
+  std::list<Feedback> feedback_;
+  int64_t next_rtcp_ms_;
+  unsigned int latest_estimate_bps_;
+
+  // Receive statistics.
+  int64_t capacity_bits_;
+  int64_t video_bytes_;
+  int64_t cross_traffic_bytes_;
+  int64_t num_video_packets_;
+  int64_t sum_delay_ms_;
+  int max_delay_ms_;
+  bool received_video_;
+  uint16_t first_sequence_number_;
+  uint32_t extended_max_sequence_number_;
+  int64_t num_received_since_report_;
+  uint32_t extended_max_at_last_report_;
+
+  DISALLOW_COPY_AND_ASSIGN(BweSimulator);
+};
+
+}  // namespace bwe
+}  // namespace testing
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_REMOTE_BITRATE_ESTIMATOR_TEST_BWE_SIMULATOR_H_
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/remote_bitrate_estimator/test/bwe_simulator.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace webrtc {
+namespace testing {
+namespace bwe {
+
+class BweSimulatorTest : public ::testing::Test {
+ protected:
+  void AddCapacityStep(int64_t time_ms, int capacity_kbps) {
+    BweSimulator::CapacityStep step = { time_ms, capacity_kbps };
+    config_.capacity_trace.push_back(step);
+  }
+
+  void Run(int64_t time_ms, BweSimulator::Stats* stats) {
+    BweSimulator simulator(config_);
+    simulator.RunFor(time_ms);
+    simulator.GetStats(stats);
+  }
+
+  BweSimulator::Config config_;
+};
+
+TEST_F(BweSimulatorTest, RampsUpToCapacity) {
+  AddCapacityStep(0, 1000);
+  BweSimulator::Stats stats;
+  Run(60000, &stats);
+  EXPECT_EQ(60000, stats.duration_ms);
+  EXPECT_GT(stats.target_bitrate_kbps, 700);
+  EXPECT_GT(stats.utilization, 0.5f);
+  EXPECT_LE(stats.utilization, 1.0f);
+  EXPECT_LT(stats.max_delay_ms, 150);
+  EXPECT_EQ(0, stats.cross_traffic_kbps);
+}
+
+TEST_F(BweSimulatorTest, FollowsCapacityDrop) {
+  AddCapacityStep(0, 1000);
+  AddCapacityStep(30000, 300);
+  BweSimulator::Stats stats;
+  Run(60000, &stats);
+  EXPECT_LT(stats.target_bitrate_kbps, 400);
+  EXPECT_GT(stats.target_bitrate_kbps, 100);
+}
+
+TEST_F(BweSimulatorTest, SharesLinkWithCrossTraffic) {
+  AddCapacityStep(0, 1000);
+  config_.cross_traffic_kbps = 500;
+  BweSimulator::Stats stats;
+  Run(60000, &stats);
+  EXPECT_NEAR(500, stats.cross_traffic_kbps, 50);
+  EXPECT_LT(stats.target_bitrate_kbps, 600);
+  EXPECT_GT(stats.utilization, 0.9f);
+  EXPECT_LT(stats.max_delay_ms, 150);
+}
+
+TEST_F(BweSimulatorTest, IsDeterministic) {
+  AddCapacityStep(0, 800);
+  config_.loss_percent = 2.0f;
+  config_.mean_loss_burst_length = 3.0f;
+  BweSimulator::Stats stats1;
+  Run(20000, &stats1);
+  BweSimulator::Stats stats2;
+  Run(20000, &stats2);
+  EXPECT_GT(stats1.video_loss_percent, 0.0f);
+  EXPECT_EQ(stats1.video_kbps, stats2.video_kbps);
+  EXPECT_EQ(stats1.mean_delay_ms, stats2.mean_delay_ms);
+  EXPECT_EQ(stats1.max_delay_ms, stats2.max_delay_ms);
+  EXPECT_EQ(stats1.video_loss_percent, stats2.video_loss_percent);
+  EXPECT_EQ(stats1.target_bitrate_kbps, stats2.target_bitrate_kbps);
+}
+
+}  // namespace bwe
+}  // namespace testing
+}  // namespace webrtc
@@ -0,0 +1,158 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/remote_bitrate_estimator/test/bwe_test_framework.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace webrtc {
+namespace testing {
+namespace bwe {
+
+Random::Random(uint32_t seed) : state_(seed) {}
+
+float Random::Rand() {
+  // Linear congruential generator from Numerical Recipes. The low bits are
+  // the least random, so the result is made of the top 24 bits.
+  state_ = 1664525 * state_ + 1013904223;
+  return (state_ >> 8) * (1.0f / (1 << 24));
+}
+
+Packet::Packet()
+    : creation_time_us(-1),
+      send_time_us(-1),
+      payload_size(0) {
+  memset(&header, 0, sizeof(header));
+}
+
+Packet::Packet(int64_t send_time_us, int payload_size,
+               const RTPHeader& header)
+    : creation_time_us(send_time_us),
+      send_time_us(send_time_us),
+      payload_size(payload_size),
+      header(header) {
+}
+
+bool Packet::operator<(const Packet& other) const {
+  return send_time_us < other.send_time_us;
+}
+
+QueueingProcessor::QueueingProcessor() : now_ms_(0) {}
+
+void QueueingProcessor::RunFor(int64_t time_ms, Packets* in_out) {
+  assert(in_out);
+  now_ms_ += time_ms;
+  Packets entering;
+  for (Packets::iterator it = in_out->begin(); it != in_out->end(); ++it) {
+    if (Process(&*it))
+      entering.push_back(*it);
+  }
+  in_out->clear();
+  queue_.merge(entering);
+  const int64_t end_us = now_ms_ * 1000;
+  Packets::iterator it = queue_.begin();
+  while (it != queue_.end() && it->send_time_us < end_us)
+    ++it;
+  in_out->splice(in_out->end(), queue_, queue_.begin(), it);
+}
+
+LossFilter::LossFilter(float loss_percent, float mean_burst_length,
+                       uint32_t seed)
+    : random_(seed),
+      good_to_bad_(0.0f),
+      bad_to_good_(1.0f),
+      bad_(false) {
+  assert(loss_percent >= 0.0f && loss_percent < 100.0f);
+  assert(mean_burst_length >= 1.0f);
+  const float loss = loss_percent / 100.0f;
+  bad_to_good_ = 1.0f / mean_burst_length;
+  // The share of time in the bad state is
+  // good_to_bad / (good_to_bad + bad_to_good), which should be |loss|.
+  good_to_bad_ = bad_to_good_ * loss / (1.0f - loss);
+}
+
+void LossFilter::RunFor(int64_t /*time_ms*/, Packets* in_out) {
+  assert(in_out);
+  Packets::iterator it = in_out->begin();
+  while (it != in_out->end()) {
+    bad_ = bad_ ? random_.Rand() >= bad_to_good_
+                : random_.Rand() < good_to_bad_;
+    if (bad_)
+      it = in_out->erase(it);
+    else
+      ++it;
+  }
+}
+
+DelayFilter::DelayFilter(int delay_ms) : delay_us_(delay_ms * 1000) {
+  assert(delay_ms >= 0);
+}
+
+bool DelayFilter::Process(Packet* packet) {
+  packet->send_time_us += delay_us_;
+  return true;
+}
+
+ChokeFilter::ChokeFilter(int capacity_kbps, int max_delay_ms)
+    : capacity_kbps_(capacity_kbps),
+      max_delay_us_(max_delay_ms * 1000),
+      busy_until_us_(0) {
+}
+
+bool ChokeFilter::Process(Packet* packet) {
+  if (capacity_kbps_ <= 0)
+    return false;
+  const int64_t start_us = std::max(packet->send_time_us, busy_until_us_);
+  if (start_us - packet->send_time_us > max_delay_us_)
+    return false;
+  // Bits per kbps are milliseconds.
+  busy_until_us_ = start_us +
+      static_cast<int64_t>(packet->payload_size) * 8 * 1000 / capacity_kbps_;
+  packet->send_time_us = busy_until_us_;
+  return true;
+}
+
+CrossTrafficSource::CrossTrafficSource(uint32_t ssrc, int bitrate_kbps,
+                                       int payload_size)
+    : ssrc_(ssrc),
+      bitrate_kbps_(bitrate_kbps),
+      payload_size_(payload_size),
+      now_us_(0),
+      next_send_time_us_(0),
+      sequence_number_(0) {
+  assert(payload_size > 0);
+}
+
+void CrossTrafficSource::RunFor(int64_t time_ms, Packets* in_out) {
+  assert(in_out);
+  now_us_ += time_ms * 1000;
+  if (bitrate_kbps_ <= 0) {
+    next_send_time_us_ = now_us_;
+    return;
+  }
+  RTPHeader header;
+  memset(&header, 0, sizeof(header));
+  header.ssrc = ssrc_;
+  Packets packets;
+  while (next_send_time_us_ < now_us_) {
+    header.sequenceNumber = sequence_number_++;
+    packets.push_back(Packet(next_send_time_us_, payload_size_, header));
+    next_send_time_us_ +=
+        static_cast<int64_t>(payload_size_) * 8 * 1000 / bitrate_kbps_;
+  }
+  in_out->merge(packets);
+}
+
+}  // namespace bwe
+}  // namespace testing
+}  // namespace webrtc
@@ -0,0 +1,172 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_REMOTE_BITRATE_ESTIMATOR_TEST_BWE_TEST_FRAMEWORK_H_
+#define WEBRTC_MODULES_REMOTE_BITRATE_ESTIMATOR_TEST_BWE_TEST_FRAMEWORK_H_
+
+#include <list>
+
+#include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+namespace testing {
+namespace bwe {
+
+// Deterministic pseudo random numbers, so simulations can be repeated.
+class Random {
+ public:
+  explicit Random(uint32_t seed);
+
+  // Returns a uniformly distributed value in [0, 1).
+  float Rand();
+
+ private:
+  uint32_t state_;
+
+  DISALLOW_COPY_AND_ASSIGN(Random);
+};
+
+// An RTP packet on its way through the simulated network.
+struct Packet {
+  Packet();
+  Packet(int64_t send_time_us, int payload_size, const RTPHeader& header);
+
+  // Orders packets by |send_time_us|.
+  bool operator<(const Packet& other) const;
+
+  // Time the packet left the sender.
+  int64_t creation_time_us;
+  // Time the packet leaves the current network element. Updated as the
+  // packet passes through them.
+  int64_t send_time_us;
+  int payload_size;
+  RTPHeader header;
+};
+
+typedef std::list<Packet> Packets;
+
+// A network element. The packets of |in_out| are sorted by |send_time_us|,
+// and so must the packets handed on be.
+class PacketProcessor {
+ public:
+  virtual ~PacketProcessor() {}
+
+  // Processes the packets entering the element during the next |time_ms|,
+  // and replaces them with the packets leaving it in that time.
+  virtual void RunFor(int64_t time_ms, Packets* in_out) = 0;
+};
+
+// Base of the elements which hold packets until their send time.
+class QueueingProcessor : public PacketProcessor {
+ public:
+  QueueingProcessor();
+  virtual ~QueueingProcessor() {}
+
+  virtual void RunFor(int64_t time_ms, Packets* in_out);
+
+ protected:
+  // Called with each entering packet, in order. The packet may be modified
+  // and is dropped if false is returned.
+  virtual bool Process(Packet* packet) = 0;
+
+  int64_t now_ms() const { return now_ms_; }
+
+ private:
+  int64_t now_ms_;
+  Packets queue_;
+
+  DISALLOW_COPY_AND_ASSIGN(QueueingProcessor);
+};
+
+// Drops packets in bursts, using a two state Markov model. On average
+// |loss_percent| of the packets are lost in bursts of |mean_burst_length|.
+class LossFilter : public PacketProcessor {
+ public:
+  LossFilter(float loss_percent, float mean_burst_length, uint32_t seed);
+  virtual ~LossFilter() {}
+
+  virtual void RunFor(int64_t time_ms, Packets* in_out);
+
+ private:
+  Random random_;
+  float good_to_bad_;
+  float bad_to_good_;
+  bool bad_;
+
+  DISALLOW_COPY_AND_ASSIGN(LossFilter);
+};
+
+// Delays all packets by a fixed time.
+class DelayFilter : public QueueingProcessor {
+ public:
+  explicit DelayFilter(int delay_ms);
+  virtual ~DelayFilter() {}
+
+ protected:
+  virtual bool Process(Packet* packet);
+
+ private:
+  int64_t delay_us_;
+
+  DISALLOW_COPY_AND_ASSIGN(DelayFilter);
+};
+
+// A bottleneck link: sends packets one at a time at its capacity, and drops
+// the packets which would wait longer than |max_delay_ms| in its queue.
+class ChokeFilter : public QueueingProcessor {
+ public:
+  ChokeFilter(int capacity_kbps, int max_delay_ms);
+  virtual ~ChokeFilter() {}
+
+  // Takes effect for the packets entering the link after the call.
+  void set_capacity_kbps(int capacity_kbps) { capacity_kbps_ = capacity_kbps; }
+  int capacity_kbps() const { return capacity_kbps_; }
+
+ protected:
+  virtual bool Process(Packet* packet);
+
+ private:
+  int capacity_kbps_;
+  int64_t max_delay_us_;
+  // Time the link is done sending the packets queued so far.
+  int64_t busy_until_us_;
+
+  DISALLOW_COPY_AND_ASSIGN(ChokeFilter);
+};
+
+// Adds packets of |ssrc| at a constant bitrate, competing with the other
+// packets on the links after it.
+class CrossTrafficSource : public PacketProcessor {
+ public:
+  CrossTrafficSource(uint32_t ssrc, int bitrate_kbps, int payload_size);
+  virtual ~CrossTrafficSource() {}
+
+  void set_bitrate_kbps(int bitrate_kbps) { bitrate_kbps_ = bitrate_kbps; }
+
+  virtual void RunFor(int64_t time_ms, Packets* in_out);
+
+ private:
+  uint32_t ssrc_;
+  int bitrate_kbps_;
+  int payload_size_;
+  int64_t now_us_;
+  int64_t next_send_time_us_;
+  uint16_t sequence_number_;
+
+  DISALLOW_COPY_AND_ASSIGN(CrossTrafficSource);
+};
+
+}  // namespace bwe
+}  // namespace testing
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_REMOTE_BITRATE_ESTIMATOR_TEST_BWE_TEST_FRAMEWORK_H_
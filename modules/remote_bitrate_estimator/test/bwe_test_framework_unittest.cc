@@ -0,0 +1,117 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/remote_bitrate_estimator/test/bwe_test_framework.h"
+
+#include <string.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace webrtc {
+namespace testing {
+namespace bwe {
+
+// Adds |num_packets| packets of |payload_size| bytes, sent at |send_time_us|.
+static void AddPackets(int num_packets, int64_t send_time_us,
+                       int payload_size, Packets* packets) {
+  RTPHeader header;
+  memset(&header, 0, sizeof(header));
+  for (int i = 0; i < num_packets; ++i) {
+    header.sequenceNumber = static_cast<uint16_t>(packets->size());
+    packets->push_back(Packet(send_time_us, payload_size, header));
+  }
+}
+
+TEST(BweTestFrameworkTest, RandomIsDeterministicAndInRange) {
+  Random random1(17);
+  Random random2(17);
+  for (int i = 0; i < 1000; ++i) {
+    const float value = random1.Rand();
+    EXPECT_EQ(value, random2.Rand());
+    EXPECT_LE(0.0f, value);
+    EXPECT_GT(1.0f, value);
+  }
+}
+
+TEST(BweTestFrameworkTest, LossFilterLosesInBursts) {
+  const int kNumPackets = 100000;
+  LossFilter filter(10.0f, 4.0f, 1);
+  Packets packets;
+  AddPackets(kNumPackets, 0, 100, &packets);
+  filter.RunFor(1, &packets);
+  const int num_lost = kNumPackets - static_cast<int>(packets.size());
+  EXPECT_NEAR(kNumPackets / 10, num_lost, kNumPackets / 100);
+
+  int num_bursts = 0;
+  uint16_t expected_sequence_number = 0;
+  for (Packets::iterator it = packets.begin(); it != packets.end(); ++it) {
+    if (it->header.sequenceNumber != expected_sequence_number)
+      ++num_bursts;
+    expected_sequence_number = it->header.sequenceNumber + 1;
+  }
+  ASSERT_GT(num_bursts, 0);
+  EXPECT_NEAR(4.0f, static_cast<float>(num_lost) / num_bursts, 0.5f);
+}
+
+TEST(BweTestFrameworkTest, DelayFilterHoldsPackets) {
+  DelayFilter filter(10);
+  Packets packets;
+  AddPackets(2, 0, 100, &packets);
+  filter.RunFor(10, &packets);
+  EXPECT_TRUE(packets.empty());
+  filter.RunFor(1, &packets);
+  ASSERT_EQ(2u, packets.size());
+  EXPECT_EQ(10000, packets.front().send_time_us);
+  EXPECT_EQ(0, packets.front().creation_time_us);
+}
+
+TEST(BweTestFrameworkTest, ChokeFilterSendsAtCapacityAndDropsTail) {
+  // 100 bytes take 8 ms at 100 kbps.
+  ChokeFilter filter(100, 20);
+  Packets packets;
+  AddPackets(5, 0, 100, &packets);
+  filter.RunFor(100, &packets);
+  // The fourth packet would wait 24 ms.
+  ASSERT_EQ(3u, packets.size());
+  int64_t expected_send_time_us = 0;
+  for (Packets::iterator it = packets.begin(); it != packets.end(); ++it) {
+    expected_send_time_us += 8000;
+    EXPECT_EQ(expected_send_time_us, it->send_time_us);
+  }
+
+  filter.set_capacity_kbps(200);
+  packets.clear();
+  AddPackets(1, 100000, 100, &packets);
+  filter.RunFor(10, &packets);
+  ASSERT_EQ(1u, packets.size());
+  EXPECT_EQ(104000, packets.front().send_time_us);
+}
+
+TEST(BweTestFrameworkTest, CrossTrafficIsMergedInOrder) {
+  // One 100 byte packet every 8 ms.
+  CrossTrafficSource source(17, 100, 100);
+  Packets packets;
+  AddPackets(1, 5000, 100, &packets);
+  source.RunFor(20, &packets);
+  ASSERT_EQ(4u, packets.size());
+  int64_t previous_send_time_us = -1;
+  int num_cross_traffic = 0;
+  for (Packets::iterator it = packets.begin(); it != packets.end(); ++it) {
+    EXPECT_LE(previous_send_time_us, it->send_time_us);
+    previous_send_time_us = it->send_time_us;
+    if (it->header.ssrc == 17)
+      ++num_cross_traffic;
+  }
+  EXPECT_EQ(3, num_cross_traffic);
+}
+
+}  // namespace bwe
+}  // namespace testing
+}  // namespace webrtc
@@ -0,0 +1,237 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Replays a log of RTP packet arrivals through a remote bitrate estimator on
+// a simulated clock, as fast as possible. Used to tune the estimator and to
+// check that changes to it don't change its estimates.
+//
+// The log is a text file with one event per line:
+//   rtp <arrival ms> <ssrc> <seq no> <rtp timestamp> <toffset> <abs send time>
+//       <payload size>
+//   sr <arrival ms> <ssrc> <ntp secs> <ntp frac> <rtp timestamp>
+// where "sr" is an RTCP sender report. Lines starting with # are ignored.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "google/gflags.h"
+#include "webrtc/modules/remote_bitrate_estimator/include/remote_bitrate_estimator.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+DEFINE_string(estimator, "multi",
+              "The estimator to use: single, abs_send_time or multi");
+DEFINE_int32(repeat, 1, "Number of times to replay the log");
+DEFINE_int32(batch_ms, 0, "Give the estimator the packets arriving within "
+             "this many milliseconds at once. 0 gives them one at a time");
+DEFINE_bool(print_estimates, false,
+            "Print the time and value of each estimate of the first replay");
+
+namespace webrtc {
+namespace {
+
+struct LogEvent {
+  bool sender_report;
+  PacketArrival packet;
+  uint32_t ntp_secs;
+  uint32_t ntp_frac;
+};
+
+bool ReadLog(const char* file_name, std::vector<LogEvent>* events) {
+  FILE* file = fopen(file_name, "r");
+  if (!file) {
+    fprintf(stderr, "Cannot open %s\n", file_name);
+    return false;
+  }
+  char line[256];
+  int line_number = 0;
+  bool ok = true;
+  while (ok && fgets(line, sizeof(line), file)) {
+    ++line_number;
+    if (line[0] == '#' || line[0] == '\n')
+      continue;
+    LogEvent event;
+    memset(&event, 0, sizeof(event));
+    RTPHeader& header = event.packet.header;
+    long long arrival_time_ms = 0;
+    unsigned int sequence_number = 0;
+    if (strncmp(line, "rtp ", 4) == 0) {
+      ok = sscanf(line + 4, "%lld %u %u %u %d %u %d", &arrival_time_ms,
+                  &header.ssrc, &sequence_number, &header.timestamp,
+                  &header.extension.transmissionTimeOffset,
+                  &header.extension.absoluteSendTime,
+                  &event.packet.payload_size) == 7;
+      header.sequenceNumber = static_cast<uint16_t>(sequence_number);
+    } else if (strncmp(line, "sr ", 3) == 0) {
+      event.sender_report = true;
+      ok = sscanf(line + 3, "%lld %u %u %u %u", &arrival_time_ms,
+                  &header.ssrc, &event.ntp_secs, &event.ntp_frac,
+                  &header.timestamp) == 5;
+    } else {
+      ok = false;
+    }
+    event.packet.arrival_time_ms = arrival_time_ms;
+    if (ok && !events->empty() &&
+        arrival_time_ms < events->back().packet.arrival_time_ms) {
+      fprintf(stderr, "Events out of order ");
+      ok = false;
+    }
+    if (ok)
+      events->push_back(event);
+    else
+      fprintf(stderr, "at %s:%d\n", file_name, line_number);
+  }
+  fclose(file);
+  if (ok && events->empty()) {
+    fprintf(stderr, "No events in %s\n", file_name);
+    ok = false;
+  }
+  return ok;
+}
+
+class ReplayObserver : public RemoteBitrateObserver {
+ public:
+  ReplayObserver(Clock* clock, bool print)
+      : clock_(clock), print_(print), num_estimates_(0), latest_bitrate_(0) {}
+
+  virtual void OnReceiveBitrateChanged(const std::vector<unsigned int>& ssrcs,
+                                       unsigned int bitrate) {
+    if (print_) {
+      printf("%lld %u\n", static_cast<long long>(clock_->TimeInMilliseconds()),
+             bitrate);
+    }
+    ++num_estimates_;
+    latest_bitrate_ = bitrate;
+  }
+
+  int num_estimates() const { return num_estimates_; }
+  unsigned int latest_bitrate() const { return latest_bitrate_; }
+
+ private:
+  Clock* clock_;
+  bool print_;
+  int num_estimates_;
+  unsigned int latest_bitrate_;
+};
+
+RemoteBitrateEstimator* CreateEstimator(const std::string& name,
+                                        RemoteBitrateObserver* observer,
+                                        Clock* clock) {
+  if (name == "single")
+    return RemoteBitrateEstimatorFactory().Create(observer, clock);
+  if (name == "abs_send_time")
+    return AbsoluteSendTimeRemoteBitrateEstimatorFactory().Create(observer,
+                                                                  clock);
+  if (name == "multi")
+    return MultiStreamRemoteBitrateEstimatorFactory().Create(observer, clock);
+  return NULL;
+}
+
+void Deliver(RemoteBitrateEstimator* estimator,
+             std::vector<PacketArrival>* batch) {
+  if (batch->empty())
+    return;
+  estimator->IncomingPackets(&(*batch)[0], static_cast<int>(batch->size()));
+  batch->clear();
+}
+
+// Runs |events| through a new estimator. Returns the number of estimates.
+int Replay(const std::vector<LogEvent>& events, bool print,
+           unsigned int* latest_bitrate) {
+  SimulatedClock clock(events.front().packet.arrival_time_ms);
+  ReplayObserver observer(&clock, print);
+  scoped_ptr<RemoteBitrateEstimator> estimator(
+      CreateEstimator(FLAGS_estimator, &observer, &clock));
+  std::vector<PacketArrival> batch;
+  for (size_t i = 0; i < events.size(); ++i) {
+    const LogEvent& event = events[i];
+    const int64_t time_ms = event.packet.arrival_time_ms;
+    if (!batch.empty() &&
+        time_ms >= batch.front().arrival_time_ms + FLAGS_batch_ms) {
+      Deliver(estimator.get(), &batch);
+    }
+    clock.AdvanceTimeMilliseconds(time_ms - clock.TimeInMilliseconds());
+    if (estimator->TimeUntilNextProcess() <= 0)
+      estimator->Process();
+    if (event.sender_report) {
+      Deliver(estimator.get(), &batch);
+      estimator->IncomingRtcp(event.packet.header.ssrc, event.ntp_secs,
+                              event.ntp_frac, event.packet.header.timestamp);
+    } else if (FLAGS_batch_ms == 0) {
+      estimator->IncomingPacket(time_ms, event.packet.payload_size,
+                                event.packet.header);
+    } else {
+      batch.push_back(event.packet);
+    }
+  }
+  Deliver(estimator.get(), &batch);
+  *latest_bitrate = observer.latest_bitrate();
+  return observer.num_estimates();
+}
+
+}  // namespace
+}  // namespace webrtc
+
+int main(int argc, char* argv[]) {
+  std::string program_name = argv[0];
+  std::string usage = "Replays a log of RTP arrivals through a remote bitrate "
+      "estimator.\nRun " + program_name + " --helpshort for usage.\n"
+      "Example usage:\n" + program_name + " --repeat=100 arrivals.log\n";
+  google::SetUsageMessage(usage);
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  if (argc != 2) {
+    printf("%s", google::ProgramUsage());
+    return 0;
+  }
+  if (FLAGS_repeat < 1 || FLAGS_batch_ms < 0) {
+    fprintf(stderr, "--repeat must be positive and --batch_ms not negative\n");
+    return 1;
+  }
+  webrtc::SimulatedClock clock(0);
+  webrtc::ReplayObserver observer(&clock, false);
+  webrtc::scoped_ptr<webrtc::RemoteBitrateEstimator> estimator(
+      webrtc::CreateEstimator(FLAGS_estimator, &observer, &clock));
+  if (!estimator.get()) {
+    fprintf(stderr, "Unknown estimator %s\n", FLAGS_estimator.c_str());
+    return 1;
+  }
+
+  std::vector<webrtc::LogEvent> events;
+  if (!webrtc::ReadLog(argv[1], &events))
+    return 1;
+
+  unsigned int latest_bitrate = 0;
+  int num_estimates = 0;
+  const int64_t start_ms = webrtc::TickTime::MillisecondTimestamp();
+  for (int i = 0; i < FLAGS_repeat; ++i) {
+    num_estimates = webrtc::Replay(events, FLAGS_print_estimates && i == 0,
+                                   &latest_bitrate);
+  }
+  const int64_t elapsed_ms = webrtc::TickTime::MillisecondTimestamp() -
+      start_ms;
+
+  const int64_t log_ms = events.back().packet.arrival_time_ms -
+      events.front().packet.arrival_time_ms;
+  fprintf(stderr, "%d events, %lld ms, %d estimates, last %u bps\n",
+          static_cast<int>(events.size()), static_cast<long long>(log_ms),
+          num_estimates, latest_bitrate);
+  fprintf(stderr, "%d replays in %lld ms", FLAGS_repeat,
+          static_cast<long long>(elapsed_ms));
+  if (elapsed_ms > 0) {
+    fprintf(stderr, ", %.0f times real time",
+            static_cast<double>(log_ms) * FLAGS_repeat / elapsed_ms);
+  }
+  fprintf(stderr, "\n");
+  return 0;
+}
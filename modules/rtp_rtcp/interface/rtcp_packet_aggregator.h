@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_RTP_RTCP_INTERFACE_RTCP_PACKET_AGGREGATOR_H_
+#define WEBRTC_MODULES_RTP_RTCP_INTERFACE_RTCP_PACKET_AGGREGATOR_H_
+
+#include "webrtc/common_types.h"
+#include "webrtc/modules/interface/module.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class Clock;
+
+// Coalesces the RTCP packets of all RTP/RTCP modules sending on the same
+// transport into as few compound packets as possible. Set the aggregator as
+// the outgoing transport of each module and register it with a process
+// thread.
+//
+// RTP packets are forwarded right away. Report packets, i.e. RR, SDES and
+// REMB, are held until they no longer fit in one packet or the oldest one is
+// |max_delay_ms| old. The time a RR was held is added to the delay since last
+// SR of its report blocks, so the round trip time the remote end computes
+// isn't biased by the aggregation. A packet with a SR, whose NTP time can't
+// be updated, with feedback which asks for a quick reaction, e.g. NACK, PLI
+// or FIR, or with a BYE is sent right away, together with the held packets.
+// Aggregated packets are sent on the channel of the first packet in them, so
+// the remote end must hand the RTCP of the transport to all its modules.
+class RtcpPacketAggregator : public Transport, public Module {
+ public:
+  // |transport| and |clock| must outlive the aggregator. Aggregated packets
+  // are at most |max_packet_size| bytes, larger packets are sent on their
+  // own.
+  static RtcpPacketAggregator* Create(Transport* transport,
+                                      Clock* clock,
+                                      int max_packet_size,
+                                      int max_delay_ms);
+  // Sends the held packets.
+  virtual ~RtcpPacketAggregator() {}
+
+  // Sends the held packets now.
+  virtual void Flush() = 0;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_RTP_RTCP_INTERFACE_RTCP_PACKET_AGGREGATOR_H_
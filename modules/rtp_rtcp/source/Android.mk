@@ -19,8 +19,10 @@ LOCAL_CPP_EXTENSION := .cc
 LOCAL_GENERATED_SOURCES :=
 LOCAL_SRC_FILES := \
     bitrate.cc \
+    receive_statistician.cc \
 	rtp_header_parser.cc \
     rtp_rtcp_impl.cc \
+    rtcp_packet_aggregator.cc \
     rtcp_receiver.cc \
     rtcp_receiver_help.cc \
     rtcp_sender.cc \
@@ -35,6 +37,7 @@ LOCAL_SRC_FILES := \
     dtmf_queue.cc \
     rtp_receiver_audio.cc \
     rtp_sender_audio.cc \
+    fec_xor.cc \
     forward_error_correction.cc \
     forward_error_correction_internal.cc \
     ../../remote_bitrate_estimator/bitrate_estimator.cc \
@@ -44,6 +47,7 @@ LOCAL_SRC_FILES := \
     ../../remote_bitrate_estimator/remote_rate_control.cc \
     ../../remote_bitrate_estimator/rtp_to_ntp.cc \
     ../../../video_engine/stream_synchronization.cc \
+    rtp_packet_buffer.cc \
     rtp_packet_history.cc \
     receiver_fec.cc \
     producer_fec.cc \
@@ -17,15 +17,23 @@
 
 #include "webrtc/common_types.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_rtcp_config.h"
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/rate_counter.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
 #include "webrtc/typedefs.h"
 
 namespace webrtc {
 
 class Clock;
+class CriticalSectionWrapper;
 
+// Counts the bytes and packets of a stream. The rates are over a sliding
+// window of one second. PacketRate() and BitrateLast() don't block, so they
+// can be polled from any thread.
 class Bitrate {
  public:
   explicit Bitrate(Clock* clock);
+  ~Bitrate();
 
   // Calculates rates.
   void Process();
@@ -46,15 +54,13 @@ class Bitrate {
   Clock* clock_;
 
  private:
-  uint32_t packet_rate_;
-  uint32_t bitrate_;
-  uint8_t bitrate_next_idx_;
-  int64_t packet_rate_array_[10];
-  int64_t bitrate_array_[10];
-  int64_t bitrate_diff_ms_[10];
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  RateCounter bytes_;
+  RateCounter packets_;
   int64_t time_last_rate_update_;
-  uint32_t bytes_count_;
-  uint32_t packet_count_;
+  // Written by Process().
+  Atomic32 packet_rate_;
+  Atomic32 bitrate_;
 };
 
 }  // namespace webrtc
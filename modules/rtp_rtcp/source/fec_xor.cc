@@ -0,0 +1,73 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/rtp_rtcp/source/fec_xor.h"
+
+#include <string.h>
+
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/system_wrappers/interface/once.h"
+
+namespace webrtc {
+namespace internal {
+namespace {
+
+typedef void (*XorBytesFunction)(uint8_t*, const uint8_t*, int);
+
+XorBytesFunction xor_bytes = NULL;
+
+void InitFunctions() {
+#if defined(WEBRTC_FEC_XOR_SIMD)
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    xor_bytes = &XorBytes_AVX2;
+    return;
+  }
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    xor_bytes = &XorBytes_SSE2;
+    return;
+  }
+#endif
+  xor_bytes = &XorBytes_C;
+}
+
+// Calls InitFunctions() once, whichever thread protects or recovers a packet
+// first.
+void InitFunctionsOnce() {
+  static WebRtc_OnceState once_state = WEBRTC_ONCE_INIT;
+  WebRtc_Once(&once_state, &InitFunctions);
+}
+
+}  // namespace
+
+void XorBytes_C(uint8_t* dst, const uint8_t* src, int length) {
+  int i = 0;
+  // memcpy() keeps the word accesses free of alignment requirements; it is
+  // compiled into plain loads and stores.
+  for (; i + static_cast<int>(sizeof(uintptr_t)) <= length;
+       i += sizeof(uintptr_t)) {
+    uintptr_t dst_word;
+    uintptr_t src_word;
+    memcpy(&dst_word, dst + i, sizeof(dst_word));
+    memcpy(&src_word, src + i, sizeof(src_word));
+    dst_word ^= src_word;
+    memcpy(dst + i, &dst_word, sizeof(dst_word));
+  }
+  for (; i < length; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+
+void XorBytes(uint8_t* dst, const uint8_t* src, int length) {
+  InitFunctionsOnce();
+  xor_bytes(dst, src, length);
+}
+
+}  // namespace internal
+}  // namespace webrtc
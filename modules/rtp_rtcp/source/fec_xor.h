@@ -0,0 +1,38 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
+#define WEBRTC_MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+namespace internal {
+
+// Computes dst[i] ^= src[i] for all i in [0, length). The buffers may have any
+// alignment but must not overlap. Uses the widest vector unit supported by the
+// CPU.
+void XorBytes(uint8_t* dst, const uint8_t* src, int length);
+
+// The individual implementations, exposed for testing and benchmarking.
+// XorBytes_C() works on one machine word at a time. The x86 versions are built
+// in separate targets with their own compiler flags, which define
+// WEBRTC_FEC_XOR_SIMD for the dependent code. Each one handles the whole
+// buffer, so those targets don't depend on each other or on rtp_rtcp.
+void XorBytes_C(uint8_t* dst, const uint8_t* src, int length);
+#if defined(WEBRTC_FEC_XOR_SIMD)
+void XorBytes_SSE2(uint8_t* dst, const uint8_t* src, int length);
+void XorBytes_AVX2(uint8_t* dst, const uint8_t* src, int length);
+#endif
+
+}  // namespace internal
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
@@ -0,0 +1,57 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/rtp_rtcp/source/fec_xor.h"
+
+#include <immintrin.h>
+
+namespace webrtc {
+namespace internal {
+
+void XorBytes_AVX2(uint8_t* dst, const uint8_t* src, int length) {
+  int i = 0;
+  for (; i + 64 <= length; i += 64) {
+    __m256i d0 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    __m256i d1 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i + 32));
+    d0 = _mm256_xor_si256(
+        d0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+    d1 = _mm256_xor_si256(
+        d1,
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), d0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32), d1);
+  }
+  if (i + 32 <= length) {
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    d = _mm256_xor_si256(
+        d, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), d);
+    i += 32;
+  }
+  // Compiled with AVX2 enabled, these are VEX encoded and don't pay the AVX
+  // to SSE transition penalty.
+  if (i + 16 <= length) {
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    d = _mm_xor_si128(
+        d, _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), d);
+    i += 16;
+  }
+  // Avoid the AVX to SSE transition penalty in the code that follows.
+  _mm256_zeroupper();
+  for (; i < length; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+
+}  // namespace internal
+}  // namespace webrtc
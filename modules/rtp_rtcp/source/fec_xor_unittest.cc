@@ -0,0 +1,260 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/rtp_rtcp/source/fec_xor.h"
+#include "webrtc/modules/rtp_rtcp/source/forward_error_correction.h"
+#include "webrtc/modules/rtp_rtcp/source/forward_error_correction_internal.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace internal {
+
+namespace {
+
+typedef void (*XorBytesFunction)(uint8_t*, const uint8_t*, int);
+
+const int kBufferSize = 1500;
+
+// Lengths around the word and vector widths, including the empty buffer.
+const int kTestLengths[] = {
+  0, 1, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 127, 128, 129,
+  1000, 1200, 1487
+};
+
+void FillRandom(uint8_t* buffer, int length) {
+  for (int i = 0; i < length; ++i) {
+    buffer[i] = static_cast<uint8_t>(rand() & 0xff);
+  }
+}
+
+// Runs |xor_bytes| on all test lengths and at all offsets within a vector,
+// and compares the result with a byte by byte XOR.
+void VerifyXorBytes(XorBytesFunction xor_bytes) {
+  uint8_t src[kBufferSize + 32];
+  uint8_t dst[kBufferSize + 32];
+  uint8_t expected[kBufferSize + 32];
+  for (size_t l = 0; l < sizeof(kTestLengths) / sizeof(kTestLengths[0]); ++l) {
+    const int length = kTestLengths[l];
+    for (int dst_offset = 0; dst_offset < 32; dst_offset += 3) {
+      const int src_offset = (dst_offset * 5) % 32;
+      FillRandom(src, sizeof(src));
+      FillRandom(dst, sizeof(dst));
+      memcpy(expected, dst, sizeof(dst));
+      for (int i = 0; i < length; ++i) {
+        expected[dst_offset + i] ^= src[src_offset + i];
+      }
+      xor_bytes(&dst[dst_offset], &src[src_offset], length);
+      // Also checks that nothing outside the range was written.
+      ASSERT_EQ(0, memcmp(expected, dst, sizeof(dst)))
+          << "length " << length << ", dst offset " << dst_offset
+          << ", src offset " << src_offset;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(FecXorTest, XorBytes_C) {
+  VerifyXorBytes(&XorBytes_C);
+}
+
+TEST(FecXorTest, XorBytes) {
+  VerifyXorBytes(&XorBytes);
+}
+
+#if defined(WEBRTC_FEC_XOR_SIMD)
+TEST(FecXorTest, XorBytes_SSE2) {
+  if (!WebRtc_GetCPUInfo(kSSE2)) {
+    printf("Skipping XorBytes_SSE2 test, SSE2 is not supported.\n");
+    return;
+  }
+  VerifyXorBytes(&XorBytes_SSE2);
+}
+
+TEST(FecXorTest, XorBytes_AVX2) {
+  if (!WebRtc_GetCPUInfo(kAVX2)) {
+    printf("Skipping XorBytes_AVX2 test, AVX2 is not supported.\n");
+    return;
+  }
+  VerifyXorBytes(&XorBytes_AVX2);
+}
+#endif
+
+namespace {
+
+typedef ForwardErrorCorrection::Packet Packet;
+typedef ForwardErrorCorrection::PacketList PacketList;
+
+const int kRtpHeaderSize = 12;
+const int kFecHeaderSize = 10;
+const int kPayloadLength = 1200;
+
+// Fills |media_packets| with |num_packets| RTP packets of random payload and
+// consecutive sequence numbers.
+void CreateMediaPackets(int num_packets, PacketList* media_packets) {
+  for (int i = 0; i < num_packets; ++i) {
+    Packet* packet = new Packet;
+    packet->length = kRtpHeaderSize + kPayloadLength;
+    FillRandom(packet->data, packet->length);
+    packet->data[0] = 0x80;
+    packet->data[1] = 0x60;
+    ModuleRTPUtility::AssignUWord16ToBuffer(&packet->data[2],
+                                            static_cast<uint16_t>(i));
+    media_packets->push_back(packet);
+  }
+}
+
+void DeleteMediaPackets(PacketList* media_packets) {
+  while (!media_packets->empty()) {
+    delete media_packets->front();
+    media_packets->pop_front();
+  }
+}
+
+// The payload generation of GenerateFEC() before XorBytes() and the word-wide
+// packet masks: a byte/bit cursor over |packet_mask| and a byte loop per
+// protected packet. Writes the payload of the FEC packet which protects the
+// packets in |packet_mask| to |fec_packet|.
+void GenerateFecPayloadPerByte(const PacketList& media_packets,
+                               const uint8_t* packet_mask,
+                               int ulp_header_size,
+                               Packet* fec_packet) {
+  const int fec_rtp_offset = kFecHeaderSize + ulp_header_size - kRtpHeaderSize;
+  memset(fec_packet->data, 0, IP_PACKET_SIZE);
+  fec_packet->length = 0;
+  PacketList::const_iterator media_list_it = media_packets.begin();
+  int pkt_mask_idx = 0;
+  int media_pkt_idx = 0;
+  uint16_t prev_seq_num =
+      ModuleRTPUtility::BufferToUWord16((*media_list_it)->data + 2);
+  while (media_list_it != media_packets.end()) {
+    if (packet_mask[pkt_mask_idx] & (1 << (7 - media_pkt_idx))) {
+      const Packet* media_packet = *media_list_it;
+      const int fec_packet_length = media_packet->length + fec_rtp_offset;
+      for (int j = kFecHeaderSize + ulp_header_size; j < fec_packet_length;
+           ++j) {
+        fec_packet->data[j] ^= media_packet->data[j - fec_rtp_offset];
+      }
+      if (fec_packet_length > fec_packet->length) {
+        fec_packet->length = fec_packet_length;
+      }
+    }
+    ++media_list_it;
+    if (media_list_it != media_packets.end()) {
+      const uint16_t seq_num =
+          ModuleRTPUtility::BufferToUWord16((*media_list_it)->data + 2);
+      media_pkt_idx += static_cast<uint16_t>(seq_num - prev_seq_num);
+      prev_seq_num = seq_num;
+    }
+    if (media_pkt_idx == 8) {
+      // Switch to the next mask byte.
+      media_pkt_idx = 0;
+      ++pkt_mask_idx;
+    }
+  }
+}
+
+}  // namespace
+
+// The payloads of GenerateFEC() must match those of the byte loop it replaced.
+TEST(FecXorTest, GenerateFecMatchesPerByteEncoder) {
+  const int kNumMediaPackets[] = { 1, 2, 15, 16, 17,
+                                   ForwardErrorCorrection::kMaxMediaPackets };
+  ForwardErrorCorrection fec(0);
+  for (size_t n = 0; n < sizeof(kNumMediaPackets) / sizeof(kNumMediaPackets[0]);
+       ++n) {
+    PacketList media_packets;
+    CreateMediaPackets(kNumMediaPackets[n], &media_packets);
+    PacketList fec_packets;
+    ASSERT_EQ(0, fec.GenerateFEC(media_packets, 255, 0, false, kFecMaskRandom,
+                                 &fec_packets));
+    ASSERT_FALSE(fec_packets.empty());
+    for (PacketList::iterator it = fec_packets.begin();
+         it != fec_packets.end(); ++it) {
+      const Packet* fec_packet = *it;
+      const bool l_bit = (fec_packet->data[0] & 0x40) != 0;
+      const int ulp_header_size =
+          2 + (l_bit ? kMaskSizeLBitSet : kMaskSizeLBitClear);
+      // The packet mask follows the protection length in the ULP header.
+      const uint8_t* packet_mask = &fec_packet->data[kFecHeaderSize + 2];
+      Packet expected;
+      GenerateFecPayloadPerByte(media_packets, packet_mask, ulp_header_size,
+                                &expected);
+      ASSERT_EQ(expected.length, fec_packet->length);
+      const int payload_offset = kFecHeaderSize + ulp_header_size;
+      EXPECT_EQ(0, memcmp(&expected.data[payload_offset],
+                          &fec_packet->data[payload_offset],
+                          expected.length - payload_offset));
+    }
+    DeleteMediaPackets(&media_packets);
+  }
+}
+
+// Benchmark of GenerateFEC() against the byte loop encoder it replaced, on a
+// full frame of media packets at maximum protection. The old path generates
+// the packet masks as GenerateFEC() does, but leaves out the ULP headers,
+// which didn't change.
+TEST(FecXorTest, DISABLED_GenerateFecBenchmark) {
+  const int kNumPackets = ForwardErrorCorrection::kMaxMediaPackets;
+  const int kIterations = 1000;
+  const int kProtectionFactor = 255;
+  ForwardErrorCorrection fec(0);
+  PacketList media_packets;
+  CreateMediaPackets(kNumPackets, &media_packets);
+  const int num_fec_packets =
+      fec.GetNumberOfFecPackets(kNumPackets, kProtectionFactor);
+  const PacketMaskTable mask_table(kFecMaskRandom, kNumPackets);
+  scoped_array<Packet> old_fec_packets(new Packet[num_fec_packets]);
+
+  TickTime start = TickTime::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    uint8_t packet_mask[ForwardErrorCorrection::kMaxMediaPackets *
+                        kMaskSizeLBitSet];
+    memset(packet_mask, 0, sizeof(packet_mask));
+    GeneratePacketMasks(kNumPackets, num_fec_packets, 0, false, mask_table,
+                        packet_mask);
+    for (int j = 0; j < num_fec_packets; ++j) {
+      GenerateFecPayloadPerByte(media_packets,
+                                &packet_mask[j * kMaskSizeLBitSet],
+                                2 + kMaskSizeLBitSet, &old_fec_packets[j]);
+    }
+  }
+  const double old_time_us =
+      static_cast<double>((TickTime::Now() - start).Microseconds());
+
+  start = TickTime::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    PacketList fec_packets;
+    ASSERT_EQ(0, fec.GenerateFEC(media_packets, kProtectionFactor, 0, false,
+                                 kFecMaskRandom, &fec_packets));
+    ASSERT_EQ(static_cast<size_t>(num_fec_packets), fec_packets.size());
+  }
+  const double new_time_us =
+      static_cast<double>((TickTime::Now() - start).Microseconds());
+
+  printf("%d media and %d FEC packets of %d bytes:\n", kNumPackets,
+         num_fec_packets, kPayloadLength);
+  printf("Byte loop encoder took %.2fus per frame.\n",
+         old_time_us / kIterations);
+  printf("GenerateFEC() took %.2fus per frame; which is %.2fx faster.\n",
+         new_time_us / kIterations, old_time_us / new_time_us);
+  DeleteMediaPackets(&media_packets);
+}
+
+}  // namespace internal
+}  // namespace webrtc
@@ -15,6 +15,7 @@
 #include <cstring>
 #include <iterator>
 
+#include "webrtc/modules/rtp_rtcp/source/fec_xor.h"
 #include "webrtc/modules/rtp_rtcp/source/forward_error_correction_internal.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
 #include "webrtc/system_wrappers/interface/trace.h"
@@ -40,6 +41,24 @@ enum {
   kMaxFecPackets = ForwardErrorCorrection::kMaxMediaPackets
 };
 
+// Reads the |num_mask_bytes| bytes of a packet mask into a word, with the bit
+// for the first packet at bit (8 * kMaskSizeLBitSet - 1).
+uint64_t PacketMaskToWord(const uint8_t* packet_mask, int num_mask_bytes) {
+  uint64_t mask_word = 0;
+  for (int i = 0; i < kMaskSizeLBitSet; ++i) {
+    mask_word <<= 8;
+    if (i < num_mask_bytes) {
+      mask_word |= packet_mask[i];
+    }
+  }
+  return mask_word;
+}
+
+// Returns true if the packet at |position| is set in |mask_word|.
+bool IsPacketInMask(uint64_t mask_word, int position) {
+  return (mask_word >> (8 * kMaskSizeLBitSet - 1 - position)) & 1;
+}
+
 // Used to link media packets to their protecting FEC packets.
 //
 // TODO(holmer): Refactor into a proper class.
@@ -175,8 +194,8 @@ int32_t ForwardErrorCorrection::GenerateFEC(const PacketList& media_packet_list,
   const internal::PacketMaskTable mask_table(fec_mask_type, num_media_packets);
 
   // -- Generate packet masks --
-  // Always allocate space for a large mask.
-  uint8_t* packet_mask = new uint8_t[num_fec_packets * kMaskSizeLBitSet];
+  // Always reserve space for a large mask.
+  uint8_t packet_mask[kMaxFecPackets * kMaskSizeLBitSet];
   memset(packet_mask, 0, num_fec_packets * num_maskBytes);
   internal::GeneratePacketMasks(num_media_packets, num_fec_packets,
                                 num_important_packets, use_unequal_protection,
@@ -188,7 +207,6 @@ int32_t ForwardErrorCorrection::GenerateFEC(const PacketList& media_packet_list,
   l_bit = (num_maskBits > 8 * kMaskSizeLBitClear);
 
   if (num_maskBits < 0) {
-    delete[] packet_mask;
     return -1;
   }
   if (l_bit) {
@@ -198,7 +216,6 @@ int32_t ForwardErrorCorrection::GenerateFEC(const PacketList& media_packet_list,
   GenerateFecBitStrings(media_packet_list, packet_mask, num_fec_packets, l_bit);
   GenerateFecUlpHeaders(media_packet_list, packet_mask, l_bit, num_fec_packets);
 
-  delete[] packet_mask;
   return 0;
 }
 
@@ -227,74 +244,78 @@ void ForwardErrorCorrection::GenerateFecBitStrings(
   const uint16_t fec_rtp_offset =
       kFecHeaderSize + ulp_header_size - kRtpHeaderSize;
 
+  // Position of each media packet in the packet masks, which have a column
+  // for every sequence number from the first media packet.
+  const Packet* media_packets[kMaxMediaPackets];
+  int media_positions[kMaxMediaPackets];
+  int num_media_packets = 0;
+  const uint16_t first_seq_num =
+      ParseSequenceNumber(media_packet_list.front()->data);
+  for (PacketList::const_iterator it = media_packet_list.begin();
+       it != media_packet_list.end(); ++it) {
+    const int position = static_cast<uint16_t>(
+        ParseSequenceNumber((*it)->data) - first_seq_num);
+    if (position >= 8 * num_maskBytes) {
+      // Can't be covered by the packet masks.
+      break;
+    }
+    media_packets[num_media_packets] = *it;
+    media_positions[num_media_packets] = position;
+    ++num_media_packets;
+  }
+
   for (int i = 0; i < num_fec_packets; ++i) {
-    PacketList::const_iterator media_list_it = media_packet_list.begin();
-    uint32_t pkt_mask_idx = i * num_maskBytes;
-    uint32_t media_pkt_idx = 0;
-    uint16_t fec_packet_length = 0;
-    uint16_t prev_seq_num = ParseSequenceNumber((*media_list_it)->data);
-    while (media_list_it != media_packet_list.end()) {
-      // Each FEC packet has a multiple byte mask.
-      if (packet_mask[pkt_mask_idx] & (1 << (7 - media_pkt_idx))) {
-        Packet* media_packet = *media_list_it;
-
-        // Assign network-ordered media payload length.
-        ModuleRTPUtility::AssignUWord16ToBuffer(
-            media_payload_length, media_packet->length - kRtpHeaderSize);
-
-        fec_packet_length = media_packet->length + fec_rtp_offset;
-        // On the first protected packet, we don't need to XOR.
-        if (generated_fec_packets_[i].length == 0) {
-          // Copy the first 2 bytes of the RTP header.
-          memcpy(generated_fec_packets_[i].data, media_packet->data, 2);
-          // Copy the 5th to 8th bytes of the RTP header.
-          memcpy(&generated_fec_packets_[i].data[4], &media_packet->data[4], 4);
-          // Copy network-ordered payload size.
-          memcpy(&generated_fec_packets_[i].data[8], media_payload_length, 2);
-
-          // Copy RTP payload, leaving room for the ULP header.
-          memcpy(
-              &generated_fec_packets_[i].data[kFecHeaderSize + ulp_header_size],
-              &media_packet->data[kRtpHeaderSize],
-              media_packet->length - kRtpHeaderSize);
-        } else {
-          // XOR with the first 2 bytes of the RTP header.
-          generated_fec_packets_[i].data[0] ^= media_packet->data[0];
-          generated_fec_packets_[i].data[1] ^= media_packet->data[1];
-
-          // XOR with the 5th to 8th bytes of the RTP header.
-          for (uint32_t j = 4; j < 8; ++j) {
-            generated_fec_packets_[i].data[j] ^= media_packet->data[j];
-          }
-
-          // XOR with the network-ordered payload size.
-          generated_fec_packets_[i].data[8] ^= media_payload_length[0];
-          generated_fec_packets_[i].data[9] ^= media_payload_length[1];
-
-          // XOR with RTP payload, leaving room for the ULP header.
-          for (int32_t j = kFecHeaderSize + ulp_header_size;
-               j < fec_packet_length; j++) {
-            generated_fec_packets_[i].data[j] ^=
-                media_packet->data[j - fec_rtp_offset];
-          }
-        }
-        if (fec_packet_length > generated_fec_packets_[i].length) {
-          generated_fec_packets_[i].length = fec_packet_length;
-        }
+    Packet* fec_packet = &generated_fec_packets_[i];
+    const uint64_t mask_word =
+        PacketMaskToWord(&packet_mask[i * num_maskBytes], num_maskBytes);
+    for (int k = 0; k < num_media_packets; ++k) {
+      if (!IsPacketInMask(mask_word, media_positions[k])) {
+        continue;
       }
-      media_list_it++;
-      if (media_list_it != media_packet_list.end()) {
-        uint16_t seq_num = ParseSequenceNumber((*media_list_it)->data);
-        media_pkt_idx += static_cast<uint16_t>(seq_num - prev_seq_num);
-        prev_seq_num = seq_num;
+      const Packet* media_packet = media_packets[k];
+      const uint16_t payload_length = media_packet->length - kRtpHeaderSize;
+
+      // Assign network-ordered media payload length.
+      ModuleRTPUtility::AssignUWord16ToBuffer(media_payload_length,
+                                              payload_length);
+
+      const uint16_t fec_packet_length = media_packet->length + fec_rtp_offset;
+      // On the first protected packet, we don't need to XOR.
+      if (fec_packet->length == 0) {
+        // Copy the first 2 bytes of the RTP header.
+        memcpy(fec_packet->data, media_packet->data, 2);
+        // Copy the 5th to 8th bytes of the RTP header.
+        memcpy(&fec_packet->data[4], &media_packet->data[4], 4);
+        // Copy network-ordered payload size.
+        memcpy(&fec_packet->data[8], media_payload_length, 2);
+
+        // Copy RTP payload, leaving room for the ULP header.
+        memcpy(&fec_packet->data[kFecHeaderSize + ulp_header_size],
+               &media_packet->data[kRtpHeaderSize], payload_length);
+      } else {
+        // XOR with the first 2 bytes of the RTP header.
+        fec_packet->data[0] ^= media_packet->data[0];
+        fec_packet->data[1] ^= media_packet->data[1];
+
+        // XOR with the 5th to 8th bytes of the RTP header.
+        for (uint32_t j = 4; j < 8; ++j) {
+          fec_packet->data[j] ^= media_packet->data[j];
+        }
+
+        // XOR with the network-ordered payload size.
+        fec_packet->data[8] ^= media_payload_length[0];
+        fec_packet->data[9] ^= media_payload_length[1];
+
+        // XOR with RTP payload, leaving room for the ULP header.
+        internal::XorBytes(&fec_packet->data[kFecHeaderSize + ulp_header_size],
+                           &media_packet->data[kRtpHeaderSize],
+                           payload_length);
       }
-      if (media_pkt_idx == 8) {
-        // Switch to the next mask byte.
-        media_pkt_idx = 0;
-        pkt_mask_idx++;
+      if (fec_packet_length > fec_packet->length) {
+        fec_packet->length = fec_packet_length;
       }
     }
-    assert(generated_fec_packets_[i].length);
+    assert(fec_packet->length);
     //Note: This shouldn't happen: means packet mask is wrong or poorly designed
   }
 }
@@ -302,7 +323,6 @@ void ForwardErrorCorrection::GenerateFecBitStrings(
 int ForwardErrorCorrection::InsertZerosInBitMasks(
     const PacketList& media_packets, uint8_t* packet_mask, int num_mask_bytes,
     int num_fec_packets) {
-  uint8_t* new_mask = NULL;
   if (media_packets.size() <= 1) {
     return media_packets.size();
   }
@@ -316,12 +336,12 @@ int ForwardErrorCorrection::InsertZerosInBitMasks(
     // required.
     return media_packets.size();
   }
-  // Allocate the new mask.
+  // Prepare the new mask.
   int new_mask_bytes = kMaskSizeLBitClear;
   if (media_packets.size() + total_missing_seq_nums > 8 * kMaskSizeLBitClear) {
     new_mask_bytes = kMaskSizeLBitSet;
   }
-  new_mask = new uint8_t[num_fec_packets * kMaskSizeLBitSet];
+  uint8_t new_mask[kMaxFecPackets * kMaskSizeLBitSet];
   memset(new_mask, 0, num_fec_packets * kMaskSizeLBitSet);
 
   PacketList::const_iterator it = media_packets.begin();
@@ -362,7 +382,6 @@ int ForwardErrorCorrection::InsertZerosInBitMasks(
   }
   // Replace the old mask with the new.
   memcpy(packet_mask, new_mask, kMaskSizeLBitSet * num_fec_packets);
-  delete[] new_mask;
   return new_bit_index;
 }
 
@@ -551,17 +570,16 @@ void ForwardErrorCorrection::InsertFECPacket(
       (fec_packet->pkt->data[0] & 0x40) ? kMaskSizeLBitSet
                                         : kMaskSizeLBitClear;  // L bit set?
 
-  for (uint16_t byte_idx = 0; byte_idx < maskSizeBytes; ++byte_idx) {
-    uint8_t packet_mask = fec_packet->pkt->data[12 + byte_idx];
-    for (uint16_t bit_idx = 0; bit_idx < 8; ++bit_idx) {
-      if (packet_mask & (1 << (7 - bit_idx))) {
-        ProtectedPacket* protected_packet = new ProtectedPacket;
-        fec_packet->protected_pkt_list.push_back(protected_packet);
-        // This wraps naturally with the sequence number.
-        protected_packet->seq_num =
-            static_cast<uint16_t>(seq_num_base + (byte_idx << 3) + bit_idx);
-        protected_packet->pkt = NULL;
-      }
+  const uint64_t mask_word =
+      PacketMaskToWord(&fec_packet->pkt->data[12], maskSizeBytes);
+  for (int position = 0; position < 8 * maskSizeBytes; ++position) {
+    if (IsPacketInMask(mask_word, position)) {
+      ProtectedPacket* protected_packet = new ProtectedPacket;
+      fec_packet->protected_pkt_list.push_back(protected_packet);
+      // This wraps naturally with the sequence number.
+      protected_packet->seq_num =
+          static_cast<uint16_t>(seq_num_base + position);
+      protected_packet->pkt = NULL;
     }
   }
   if (fec_packet->protected_pkt_list.empty()) {
@@ -688,10 +706,9 @@ void ForwardErrorCorrection::XorPackets(const Packet* src_packet,
   dst_packet->length_recovery[1] ^= media_payload_length[1];
 
   // XOR with RTP payload.
-  // TODO(marpan/ajm): Are we doing more XORs than required here?
-  for (int32_t i = kRtpHeaderSize; i < src_packet->length; ++i) {
-    dst_packet->pkt->data[i] ^= src_packet->data[i];
-  }
+  internal::XorBytes(&dst_packet->pkt->data[kRtpHeaderSize],
+                     &src_packet->data[kRtpHeaderSize],
+                     src_packet->length - kRtpHeaderSize);
 }
 
 void ForwardErrorCorrection::RecoverPacket(
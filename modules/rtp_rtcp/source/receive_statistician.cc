@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/rtp_rtcp/source/receive_statistician.h"
+
+#include <stdlib.h>
+
+namespace webrtc {
+
+ReceiveStatistician::Counters::Counters()
+    : seq_first(0),
+      seq_max(0),
+      seq_wraps(0),
+      jitter_q4(0),
+      jitter_q4_transmission_time_offset(0),
+      packet_oh(12),  // RTP header.
+      byte_count(0),
+      old_packet_count(0),
+      inorder_packet_count(0) {
+}
+
+ReceiveStatistician::ReceiveStatistician()
+    : last_packet_rtp_time_(0),
+      last_timestamp_(0),
+      last_transmission_time_offset_(0),
+      sequence_(0) {
+}
+
+void ReceiveStatistician::IncomingPacket(const RTPHeader& header,
+                                         uint16_t bytes,
+                                         bool old_packet,
+                                         uint32_t rtp_now,
+                                         int max_reordering_threshold) {
+  counters_.byte_count += bytes;
+
+  if (counters_.seq_max == 0 && counters_.seq_wraps == 0) {
+    // This is the first received report.
+    counters_.seq_first = header.sequenceNumber;
+    counters_.seq_max = header.sequenceNumber;
+    counters_.inorder_packet_count = 1;
+    last_packet_rtp_time_ = rtp_now;
+  } else {
+    // Count only the new packets received.
+    if (InOrderPacket(header.sequenceNumber, max_reordering_threshold)) {
+      counters_.inorder_packet_count++;
+
+      // Wrong if we use RetransmitOfOldPacket.
+      int32_t seq_diff = header.sequenceNumber - counters_.seq_max;
+      if (seq_diff < 0) {
+        // Wrap around detected.
+        counters_.seq_wraps++;
+      }
+      // new max
+      counters_.seq_max = header.sequenceNumber;
+
+      if (header.timestamp != last_timestamp_ &&
+          counters_.inorder_packet_count > 1) {
+        int32_t time_diff_samples =
+            (rtp_now - last_packet_rtp_time_) -
+            (header.timestamp - last_timestamp_);
+
+        time_diff_samples = abs(time_diff_samples);
+
+        // lib_jingle sometimes deliver crazy jumps in TS for the same stream.
+        // If this happens, don't update jitter value. Use 5 secs video
+        // frequency as the treshold.
+        if (time_diff_samples < 450000) {
+          // Note we calculate in Q4 to avoid using float.
+          int32_t jitter_diff_q4 =
+              (time_diff_samples << 4) - counters_.jitter_q4;
+          counters_.jitter_q4 += ((jitter_diff_q4 + 8) >> 4);
+        }
+
+        // Extended jitter report, RFC 5450.
+        // Actual network jitter, excluding the source-introduced jitter.
+        int32_t time_diff_samples_ext =
+            (rtp_now - last_packet_rtp_time_) -
+            ((header.timestamp + header.extension.transmissionTimeOffset) -
+             (last_timestamp_ + last_transmission_time_offset_));
+
+        time_diff_samples_ext = abs(time_diff_samples_ext);
+
+        if (time_diff_samples_ext < 450000) {
+          int32_t jitter_diff_q4_transmission_time_offset =
+              (time_diff_samples_ext << 4) -
+              counters_.jitter_q4_transmission_time_offset;
+          counters_.jitter_q4_transmission_time_offset +=
+              ((jitter_diff_q4_transmission_time_offset + 8) >> 4);
+        }
+      }
+      last_packet_rtp_time_ = rtp_now;
+    } else if (old_packet) {
+      counters_.old_packet_count++;
+    } else {
+      counters_.inorder_packet_count++;
+    }
+
+    uint16_t packet_oh = header.headerLength + header.paddingLength;
+
+    // Our measured overhead. Filter from RFC 5104 4.2.1.2:
+    // avg_OH (new) = 15/16*avg_OH (old) + 1/16*pckt_OH,
+    counters_.packet_oh = (15 * counters_.packet_oh + packet_oh) >> 4;
+  }
+
+  if (!old_packet) {
+    last_timestamp_ = header.timestamp;
+    last_transmission_time_offset_ = header.extension.transmissionTimeOffset;
+  }
+  Publish();
+}
+
+bool ReceiveStatistician::InOrderPacket(uint16_t sequence_number,
+                                        int max_reordering_threshold) const {
+  if (IsNewerSequenceNumber(sequence_number, counters_.seq_max)) {
+    return true;
+  }
+  // If we have a restart of the remote side this packet is still in order.
+  return !IsNewerSequenceNumber(sequence_number, counters_.seq_max -
+                                max_reordering_threshold);
+}
+
+void ReceiveStatistician::Reset() {
+  const uint16_t packet_oh = counters_.packet_oh;
+  counters_ = Counters();
+  counters_.packet_oh = packet_oh;
+  Publish();
+}
+
+void ReceiveStatistician::ResetDataCounters() {
+  counters_.byte_count = 0;
+  counters_.old_packet_count = 0;
+  counters_.inorder_packet_count = 0;
+  Publish();
+}
+
+void ReceiveStatistician::GetCounters(Counters* counters) const {
+  while (true) {
+    const int32_t sequence = sequence_.AcquireLoad();
+    if (sequence & 1) {
+      // The writer is publishing.
+      continue;
+    }
+    *counters = published_;
+    // Unlike a load, the exchange has a barrier ahead of it too, which keeps
+    // the copy before the check.
+    if (sequence_.CompareExchange(sequence, sequence)) {
+      return;
+    }
+  }
+}
+
+void ReceiveStatistician::Publish() {
+  ++sequence_;
+  published_ = counters_;
+  ++sequence_;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_RTP_RTCP_SOURCE_RECEIVE_STATISTICIAN_H_
+#define WEBRTC_MODULES_RTP_RTCP_SOURCE_RECEIVE_STATISTICIAN_H_
+
+#include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// Jitter, sequence number and byte counters of one received RTP stream.
+//
+// The writer functions are called on the receive path and must be serialized
+// by the caller. They never wait for readers: the counters are owned by the
+// writer, which publishes a copy of them after each update through a sequence
+// counter. GetCounters() may be called on any thread without locking; it
+// copies the latest published counters and retries if a new copy was
+// published while reading.
+class ReceiveStatistician {
+ public:
+  struct Counters {
+    Counters();
+
+    uint16_t seq_first;
+    uint16_t seq_max;
+    uint16_t seq_wraps;
+    // Interarrival jitter in Q4, RFC 3550 and RFC 5450.
+    uint32_t jitter_q4;
+    uint32_t jitter_q4_transmission_time_offset;
+    // Filtered header and padding overhead per packet.
+    uint16_t packet_oh;
+    uint32_t byte_count;
+    uint32_t old_packet_count;
+    uint32_t inorder_packet_count;
+  };
+
+  ReceiveStatistician();
+
+  // Writer functions.
+
+  // Updates the counters with a received packet of |bytes| payload bytes.
+  // |rtp_now| is the local time in samples of the stream.
+  void IncomingPacket(const RTPHeader& header,
+                      uint16_t bytes,
+                      bool old_packet,
+                      uint32_t rtp_now,
+                      int max_reordering_threshold);
+
+  // Returns true if |sequence_number| is newer than the highest received,
+  // or so much older that the remote side must have restarted.
+  bool InOrderPacket(uint16_t sequence_number,
+                     int max_reordering_threshold) const;
+
+  // The writer's view of the counters.
+  const Counters& counters() const { return counters_; }
+
+  // Local time in samples when the last in order packet was received.
+  uint32_t last_packet_rtp_time() const { return last_packet_rtp_time_; }
+
+  // Clears all counters but the packet overhead.
+  void Reset();
+  // Clears the byte and packet counters.
+  void ResetDataCounters();
+
+  // Reader functions.
+
+  void GetCounters(Counters* counters) const;
+
+ private:
+  void Publish();
+
+  Counters counters_;
+  uint32_t last_packet_rtp_time_;
+  uint32_t last_timestamp_;
+  int32_t last_transmission_time_offset_;
+
+  // Odd while |published_| is being written.
+  mutable Atomic32 sequence_;
+  Counters published_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReceiveStatistician);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_RTP_RTCP_SOURCE_RECEIVE_STATISTICIAN_H_
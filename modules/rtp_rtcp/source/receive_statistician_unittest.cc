@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/rtp_rtcp/source/receive_statistician.h"
+
+#include <string.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+
+namespace webrtc {
+namespace {
+
+const int kMaxReorderingThreshold = 50;
+const uint16_t kPacketBytes = 100;
+// 90 kHz video, one packet per 30 fps frame.
+const uint32_t kSamplesPerPacket = 3000;
+
+class ReceiveStatisticianTest : public ::testing::Test {
+ protected:
+  ReceiveStatisticianTest() {
+    memset(&header_, 0, sizeof(header_));
+    header_.headerLength = 12;
+  }
+
+  void Receive(uint16_t sequence_number, uint32_t timestamp,
+               uint32_t rtp_now) {
+    header_.sequenceNumber = sequence_number;
+    header_.timestamp = timestamp;
+    statistician_.IncomingPacket(header_, kPacketBytes, false, rtp_now,
+                                 kMaxReorderingThreshold);
+  }
+
+  RTPHeader header_;
+  ReceiveStatistician statistician_;
+};
+
+TEST_F(ReceiveStatisticianTest, CountsPackets) {
+  for (uint16_t i = 0; i < 10; ++i)
+    Receive(1000 + i, i * kSamplesPerPacket, i * kSamplesPerPacket);
+
+  ReceiveStatistician::Counters counters;
+  statistician_.GetCounters(&counters);
+  EXPECT_EQ(1000, counters.seq_first);
+  EXPECT_EQ(1009, counters.seq_max);
+  EXPECT_EQ(0, counters.seq_wraps);
+  EXPECT_EQ(10u, counters.inorder_packet_count);
+  EXPECT_EQ(0u, counters.old_packet_count);
+  EXPECT_EQ(10u * kPacketBytes, counters.byte_count);
+  // Arrival in step with the timestamps.
+  EXPECT_EQ(0u, counters.jitter_q4);
+}
+
+TEST_F(ReceiveStatisticianTest, CountsWrapsAndOldPackets) {
+  Receive(0xfffe, 0, 0);
+  Receive(0xffff, kSamplesPerPacket, kSamplesPerPacket);
+  Receive(0, 2 * kSamplesPerPacket, 2 * kSamplesPerPacket);
+  header_.sequenceNumber = 0xffff;
+  statistician_.IncomingPacket(header_, kPacketBytes, true,
+                               3 * kSamplesPerPacket,
+                               kMaxReorderingThreshold);
+
+  ReceiveStatistician::Counters counters;
+  statistician_.GetCounters(&counters);
+  EXPECT_EQ(0, counters.seq_max);
+  EXPECT_EQ(1, counters.seq_wraps);
+  EXPECT_EQ(3u, counters.inorder_packet_count);
+  EXPECT_EQ(1u, counters.old_packet_count);
+}
+
+TEST_F(ReceiveStatisticianTest, EstimatesJitter) {
+  // Every other packet arrives 1000 samples late.
+  for (uint16_t i = 0; i < 100; ++i) {
+    Receive(i, i * kSamplesPerPacket,
+            i * kSamplesPerPacket + (i % 2) * 1000);
+  }
+  ReceiveStatistician::Counters counters;
+  statistician_.GetCounters(&counters);
+  // The filter converges to the mean difference of 1000 samples.
+  EXPECT_NEAR(1000, counters.jitter_q4 >> 4, 10);
+  EXPECT_EQ(counters.jitter_q4, counters.jitter_q4_transmission_time_offset);
+  EXPECT_EQ(counters.jitter_q4, statistician_.counters().jitter_q4);
+}
+
+TEST_F(ReceiveStatisticianTest, ResetKeepsOverhead) {
+  header_.paddingLength = 20;
+  for (uint16_t i = 0; i < 10; ++i)
+    Receive(i, i * kSamplesPerPacket, i * kSamplesPerPacket);
+  ReceiveStatistician::Counters counters;
+  statistician_.GetCounters(&counters);
+  const uint16_t packet_oh = counters.packet_oh;
+  EXPECT_GT(packet_oh, 12);
+
+  statistician_.ResetDataCounters();
+  statistician_.GetCounters(&counters);
+  EXPECT_EQ(0u, counters.byte_count);
+  EXPECT_EQ(0u, counters.inorder_packet_count);
+  EXPECT_EQ(9, counters.seq_max);
+
+  statistician_.Reset();
+  statistician_.GetCounters(&counters);
+  EXPECT_EQ(0, counters.seq_max);
+  EXPECT_EQ(0u, counters.jitter_q4);
+  EXPECT_EQ(packet_oh, counters.packet_oh);
+}
+
+struct ReaderState {
+  ReceiveStatistician* statistician;
+  Atomic32 reads;
+  Atomic32 torn_reads;
+};
+
+bool ReadCounters(void* obj) {
+  ReaderState* state = static_cast<ReaderState*>(obj);
+  ReceiveStatistician::Counters counters;
+  state->statistician->GetCounters(&counters);
+  // All packets are in order and of the same size, so a consistent copy
+  // has matching counts.
+  if (counters.byte_count != counters.inorder_packet_count * kPacketBytes ||
+      counters.seq_max != static_cast<uint16_t>(
+          counters.seq_first + counters.inorder_packet_count - 1)) {
+    ++state->torn_reads;
+  }
+  ++state->reads;
+  return true;
+}
+
+TEST_F(ReceiveStatisticianTest, ReadersSeeConsistentCounters) {
+  Receive(1, 0, 0);
+  ReaderState state;
+  state.statistician = &statistician_;
+  scoped_ptr<ThreadWrapper> thread(
+      ThreadWrapper::CreateThread(&ReadCounters, &state));
+  unsigned int id = 0;
+  ASSERT_TRUE(thread->Start(id));
+  for (uint32_t i = 1; i < 200000; ++i) {
+    Receive(static_cast<uint16_t>(1 + i), i * kSamplesPerPacket,
+            i * kSamplesPerPacket);
+  }
+  EXPECT_TRUE(thread->Stop());
+  EXPECT_GT(state.reads.Value(), 0);
+  EXPECT_EQ(0, state.torn_reads.Value());
+}
+
+}  // namespace
+}  // namespace webrtc
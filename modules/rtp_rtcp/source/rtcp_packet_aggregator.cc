@@ -0,0 +1,239 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/rtp_rtcp/interface/rtcp_packet_aggregator.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include <vector>
+
+#include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
+#include "webrtc/modules/rtp_rtcp/source/rtcp_utility.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/trace.h"
+
+namespace webrtc {
+
+namespace {
+
+// The PSFB message type of application layer feedback, e.g. REMB.
+const uint8_t kPsfbApplicationLayerFeedback = 15;
+
+// Size of the report block of a SR or RR, and the offsets of its last SR and
+// delay since last SR fields.
+const int kReportBlockLength = 24;
+const int kLastSrOffset = 16;
+const int kDelaySinceLastSrOffset = 20;
+// Offset of the first report block in a RR.
+const int kRrReportBlocksOffset = 8;
+
+// Returns true if |packet| has a message which shouldn't wait for the next
+// aggregated packet: any transport layer feedback, payload specific feedback
+// other than REMB, and BYE. A SR is sent right away too, as its NTP time is
+// paired with an RTP timestamp of unknown rate and can't be moved to the
+// time the packet is sent.
+bool IsUrgent(const uint8_t* packet, int length) {
+  const uint8_t* const end = packet + length;
+  RTCPUtility::RTCPCommonHeader header;
+  while (RTCPUtility::RTCPParseCommonHeader(packet, end, header)) {
+    switch (header.PT) {
+      case RTCPUtility::PT_SR:
+      case RTCPUtility::PT_RTPFB:
+      case RTCPUtility::PT_BYE:
+        return true;
+      case RTCPUtility::PT_PSFB:
+        if (header.IC != kPsfbApplicationLayerFeedback)
+          return true;
+        break;
+      default:
+        break;
+    }
+    if (header.LengthInOctets >= end - packet)
+      break;
+    packet += header.LengthInOctets;
+  }
+  return false;
+}
+
+// Adds |held_ms| to the delay since last SR of the report blocks of the RRs
+// in |packet|. The remote end subtracts the delay from the round trip time,
+// so the time the packet was held by the aggregator doesn't count as network
+// delay. Blocks without a last SR have no delay to update.
+void AddHoldTimeToReportBlocks(uint8_t* packet, int length, int64_t held_ms) {
+  const uint8_t* const end = packet + length;
+  // The delay is in units of 1/65536 seconds.
+  const uint32_t held_time = static_cast<uint32_t>(held_ms * 65536 / 1000);
+  RTCPUtility::RTCPCommonHeader header;
+  while (RTCPUtility::RTCPParseCommonHeader(packet, end, header)) {
+    if (header.LengthInOctets > end - packet)
+      break;
+    if (header.PT == RTCPUtility::PT_RR &&
+        kRrReportBlocksOffset + header.IC * kReportBlockLength <=
+            static_cast<int>(header.LengthInOctets)) {
+      for (int i = 0; i < header.IC; ++i) {
+        uint8_t* block =
+            packet + kRrReportBlocksOffset + i * kReportBlockLength;
+        if (ModuleRTPUtility::BufferToUWord32(block + kLastSrOffset) == 0)
+          continue;
+        ModuleRTPUtility::AssignUWord32ToBuffer(
+            block + kDelaySinceLastSrOffset,
+            ModuleRTPUtility::BufferToUWord32(block + kDelaySinceLastSrOffset) +
+                held_time);
+      }
+    }
+    packet += header.LengthInOctets;
+  }
+}
+
+}  // namespace
+
+class RtcpPacketAggregatorImpl : public RtcpPacketAggregator {
+ public:
+  RtcpPacketAggregatorImpl(Transport* transport,
+                           Clock* clock,
+                           int max_packet_size,
+                           int max_delay_ms);
+  virtual ~RtcpPacketAggregatorImpl();
+
+  virtual int SendPacket(int channel, const void* data, int len);
+  virtual int SendRTCPPacket(int channel, const void* data, int len);
+
+  virtual int32_t TimeUntilNextProcess();
+  virtual int32_t Process();
+
+  virtual void Flush();
+
+ private:
+  void FlushLocked();
+
+  struct HeldPacket {
+    int offset;
+    int length;
+    int64_t received_ms;
+  };
+
+  Transport* const transport_;
+  Clock* const clock_;
+  const int max_packet_size_;
+  const int max_delay_ms_;
+
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  uint8_t buffer_[IP_PACKET_SIZE];
+  int length_;
+  // Channel of the first held packet.
+  int channel_;
+  // The packets in |buffer_|, oldest first.
+  std::vector<HeldPacket> held_packets_;
+};
+
+RtcpPacketAggregator* RtcpPacketAggregator::Create(Transport* transport,
+                                                   Clock* clock,
+                                                   int max_packet_size,
+                                                   int max_delay_ms) {
+  return new RtcpPacketAggregatorImpl(transport, clock, max_packet_size,
+                                      max_delay_ms);
+}
+
+RtcpPacketAggregatorImpl::RtcpPacketAggregatorImpl(Transport* transport,
+                                                   Clock* clock,
+                                                   int max_packet_size,
+                                                   int max_delay_ms)
+    : transport_(transport),
+      clock_(clock),
+      max_packet_size_(max_packet_size < IP_PACKET_SIZE ? max_packet_size
+                                                        : IP_PACKET_SIZE),
+      max_delay_ms_(max_delay_ms),
+      crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      length_(0),
+      channel_(0) {
+  assert(transport);
+  assert(clock);
+  assert(max_delay_ms >= 0);
+}
+
+RtcpPacketAggregatorImpl::~RtcpPacketAggregatorImpl() {
+  Flush();
+}
+
+int RtcpPacketAggregatorImpl::SendPacket(int channel, const void* data,
+                                         int len) {
+  return transport_->SendPacket(channel, data, len);
+}
+
+int RtcpPacketAggregatorImpl::SendRTCPPacket(int channel, const void* data,
+                                             int len) {
+  const uint8_t* packet = static_cast<const uint8_t*>(data);
+  CriticalSectionScoped lock(crit_.get());
+  if (len > max_packet_size_) {
+    // Keep the order of the packets.
+    FlushLocked();
+    return transport_->SendRTCPPacket(channel, data, len);
+  }
+  if (length_ + len > max_packet_size_)
+    FlushLocked();
+  if (length_ == 0)
+    channel_ = channel;
+  HeldPacket held = { length_, len, clock_->TimeInMilliseconds() };
+  held_packets_.push_back(held);
+  memcpy(&buffer_[length_], packet, len);
+  length_ += len;
+  if (IsUrgent(packet, len) || max_delay_ms_ == 0)
+    FlushLocked();
+  // The packet is accepted, even if the send of an aggregate fails later.
+  return len;
+}
+
+int32_t RtcpPacketAggregatorImpl::TimeUntilNextProcess() {
+  CriticalSectionScoped lock(crit_.get());
+  if (length_ == 0)
+    return max_delay_ms_;
+  const int64_t time_left = held_packets_.front().received_ms +
+      max_delay_ms_ - clock_->TimeInMilliseconds();
+  return time_left > 0 ? static_cast<int32_t>(time_left) : 0;
+}
+
+int32_t RtcpPacketAggregatorImpl::Process() {
+  CriticalSectionScoped lock(crit_.get());
+  if (length_ > 0 && clock_->TimeInMilliseconds() >=
+      held_packets_.front().received_ms + max_delay_ms_) {
+    FlushLocked();
+  }
+  return 0;
+}
+
+void RtcpPacketAggregatorImpl::Flush() {
+  CriticalSectionScoped lock(crit_.get());
+  FlushLocked();
+}
+
+void RtcpPacketAggregatorImpl::FlushLocked() {
+  if (length_ == 0)
+    return;
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+  for (std::vector<HeldPacket>::const_iterator it = held_packets_.begin();
+       it != held_packets_.end(); ++it) {
+    if (now_ms > it->received_ms) {
+      AddHoldTimeToReportBlocks(&buffer_[it->offset], it->length,
+                                now_ms - it->received_ms);
+    }
+  }
+  if (transport_->SendRTCPPacket(channel_, buffer_, length_) <= 0) {
+    WEBRTC_TRACE(kTraceWarning, kTraceRtpRtcp, channel_,
+                 "Failed to send %d bytes of aggregated RTCP", length_);
+  }
+  length_ = 0;
+  held_packets_.clear();
+}
+
+}  // namespace webrtc
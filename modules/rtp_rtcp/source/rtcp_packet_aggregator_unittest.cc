@@ -0,0 +1,265 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/rtp_rtcp/interface/rtcp_packet_aggregator.h"
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/rtp_rtcp/source/rtcp_utility.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+
+namespace webrtc {
+namespace {
+
+const int kMaxPacketSize = 100;
+const int kMaxDelayMs = 50;
+
+void WriteUWord32(uint32_t value, std::vector<uint8_t>* packet) {
+  packet->push_back(static_cast<uint8_t>(value >> 24));
+  packet->push_back(static_cast<uint8_t>(value >> 16));
+  packet->push_back(static_cast<uint8_t>(value >> 8));
+  packet->push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t ReadUWord32(const uint8_t* data) {
+  return (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+// RR without report blocks, 8 bytes.
+void WriteReceiverReport(uint32_t ssrc, std::vector<uint8_t>* packet) {
+  const uint8_t rr[] = { 0x80, 0xc9, 0x00, 0x01,
+                         static_cast<uint8_t>(ssrc >> 24),
+                         static_cast<uint8_t>(ssrc >> 16),
+                         static_cast<uint8_t>(ssrc >> 8),
+                         static_cast<uint8_t>(ssrc) };
+  packet->insert(packet->end(), rr, rr + sizeof(rr));
+}
+
+// RR with one report block with |last_sr| and |delay_since_last_sr|, 32
+// bytes.
+void WriteReceiverReportWithBlock(uint32_t last_sr,
+                                  uint32_t delay_since_last_sr,
+                                  std::vector<uint8_t>* packet) {
+  const uint8_t rr[] = { 0x81, 0xc9, 0x00, 0x07, 0x00, 0x00, 0x00, 0x01,
+                         0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00,
+                         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+  packet->insert(packet->end(), rr, rr + sizeof(rr));
+  WriteUWord32(last_sr, packet);
+  WriteUWord32(delay_since_last_sr, packet);
+}
+
+// SR without report blocks, 28 bytes.
+void WriteSenderReport(std::vector<uint8_t>* packet) {
+  const uint8_t sr[] = { 0x80, 0xc8, 0x00, 0x06, 0x00, 0x00, 0x00, 0x01,
+                         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                         0x00, 0x00, 0x00, 0x00 };
+  packet->insert(packet->end(), sr, sr + sizeof(sr));
+}
+
+// Generic NACK with one item, 16 bytes.
+void WriteNack(std::vector<uint8_t>* packet) {
+  const uint8_t nack[] = { 0x81, 0xcd, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01,
+                           0x00, 0x00, 0x00, 0x02, 0x00, 0x10, 0x00, 0x00 };
+  packet->insert(packet->end(), nack, nack + sizeof(nack));
+}
+
+// REMB for one SSRC, 24 bytes.
+void WriteRemb(std::vector<uint8_t>* packet) {
+  const uint8_t remb[] = { 0x8f, 0xce, 0x00, 0x05, 0x00, 0x00, 0x00, 0x01,
+                           0x00, 0x00, 0x00, 0x00, 'R', 'E', 'M', 'B',
+                           0x01, 0x0b, 0xd0, 0x90, 0x00, 0x00, 0x00, 0x02 };
+  packet->insert(packet->end(), remb, remb + sizeof(remb));
+}
+
+class RecordingTransport : public Transport {
+ public:
+  struct Sent {
+    int channel;
+    std::vector<uint8_t> data;
+  };
+
+  RecordingTransport() : num_rtp_packets_(0) {}
+
+  virtual int SendPacket(int channel, const void* data, int len) {
+    ++num_rtp_packets_;
+    return len;
+  }
+  virtual int SendRTCPPacket(int channel, const void* data, int len) {
+    Sent sent;
+    sent.channel = channel;
+    sent.data.assign(static_cast<const uint8_t*>(data),
+                     static_cast<const uint8_t*>(data) + len);
+    rtcp_packets_.push_back(sent);
+    return len;
+  }
+
+  int num_rtp_packets_;
+  std::vector<Sent> rtcp_packets_;
+};
+
+// Counts the receiver reports in |packet|, checking that it is a valid
+// compound packet.
+int CountReceiverReports(const std::vector<uint8_t>& packet) {
+  RTCPUtility::RTCPParserV2 parser(&packet[0], packet.size(), false);
+  EXPECT_TRUE(parser.IsValid());
+  int count = 0;
+  for (RTCPUtility::RTCPPacketTypes type = parser.Begin();
+       type != RTCPUtility::kRtcpNotValidCode; type = parser.Iterate()) {
+    if (type == RTCPUtility::kRtcpRrCode)
+      ++count;
+  }
+  return count;
+}
+
+class RtcpPacketAggregatorTest : public ::testing::Test {
+ protected:
+  RtcpPacketAggregatorTest()
+      : clock_(1000),
+        aggregator_(RtcpPacketAggregator::Create(&transport_, &clock_,
+                                                 kMaxPacketSize,
+                                                 kMaxDelayMs)) {}
+
+  int Send(int channel, const std::vector<uint8_t>& packet) {
+    return aggregator_->SendRTCPPacket(channel, &packet[0],
+                                       static_cast<int>(packet.size()));
+  }
+
+  void SendReport(int channel, uint32_t ssrc) {
+    std::vector<uint8_t> packet;
+    WriteReceiverReport(ssrc, &packet);
+    EXPECT_EQ(static_cast<int>(packet.size()), Send(channel, packet));
+  }
+
+  SimulatedClock clock_;
+  RecordingTransport transport_;
+  scoped_ptr<RtcpPacketAggregator> aggregator_;
+};
+
+TEST_F(RtcpPacketAggregatorTest, ForwardsRtp) {
+  const uint8_t rtp[12] = { 0x80 };
+  EXPECT_EQ(12, aggregator_->SendPacket(0, rtp, sizeof(rtp)));
+  EXPECT_EQ(1, transport_.num_rtp_packets_);
+  EXPECT_TRUE(transport_.rtcp_packets_.empty());
+}
+
+TEST_F(RtcpPacketAggregatorTest, CoalescesReportsUntilMaxDelay) {
+  EXPECT_EQ(kMaxDelayMs, aggregator_->TimeUntilNextProcess());
+  SendReport(1, 0x1111);
+  clock_.AdvanceTimeMilliseconds(20);
+  SendReport(2, 0x2222);
+  std::vector<uint8_t> report_with_remb;
+  WriteReceiverReport(0x3333, &report_with_remb);
+  WriteRemb(&report_with_remb);
+  Send(3, report_with_remb);
+
+  EXPECT_EQ(kMaxDelayMs - 20, aggregator_->TimeUntilNextProcess());
+  aggregator_->Process();
+  EXPECT_TRUE(transport_.rtcp_packets_.empty());
+
+  clock_.AdvanceTimeMilliseconds(kMaxDelayMs - 20);
+  EXPECT_EQ(0, aggregator_->TimeUntilNextProcess());
+  aggregator_->Process();
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  EXPECT_EQ(1, transport_.rtcp_packets_[0].channel);
+  EXPECT_EQ(3, CountReceiverReports(transport_.rtcp_packets_[0].data));
+  EXPECT_EQ(kMaxDelayMs, aggregator_->TimeUntilNextProcess());
+}
+
+TEST_F(RtcpPacketAggregatorTest, SplitsAtMaxPacketSize) {
+  const int kReportsPerPacket = kMaxPacketSize / 8;
+  for (int i = 0; i < kReportsPerPacket + 1; ++i)
+    SendReport(i, i);
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  EXPECT_EQ(kReportsPerPacket,
+            CountReceiverReports(transport_.rtcp_packets_[0].data));
+  EXPECT_EQ(0, transport_.rtcp_packets_[0].channel);
+
+  aggregator_->Flush();
+  ASSERT_EQ(2u, transport_.rtcp_packets_.size());
+  EXPECT_EQ(1, CountReceiverReports(transport_.rtcp_packets_[1].data));
+  EXPECT_EQ(kReportsPerPacket, transport_.rtcp_packets_[1].channel);
+}
+
+TEST_F(RtcpPacketAggregatorTest, SendsFeedbackRightAway) {
+  SendReport(1, 0x1111);
+  std::vector<uint8_t> nack;
+  WriteReceiverReport(0x2222, &nack);
+  WriteNack(&nack);
+  Send(2, nack);
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  EXPECT_EQ(2, CountReceiverReports(transport_.rtcp_packets_[0].data));
+  EXPECT_EQ(8 + nack.size(), transport_.rtcp_packets_[0].data.size());
+}
+
+TEST_F(RtcpPacketAggregatorTest, SendsSenderReportRightAway) {
+  SendReport(1, 0x1111);
+  std::vector<uint8_t> sr;
+  WriteSenderReport(&sr);
+  Send(2, sr);
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  EXPECT_EQ(8 + sr.size(), transport_.rtcp_packets_[0].data.size());
+}
+
+TEST_F(RtcpPacketAggregatorTest, AddsHoldTimeToDelaySinceLastSr) {
+  // Delays are in units of 1/65536 seconds.
+  const uint32_t kLastSr = 0x12345678;
+  const uint32_t kDelaySinceLastSr = 0x10000;
+  const int kHoldTimeMs = 30;
+  std::vector<uint8_t> packet;
+  WriteReceiverReportWithBlock(kLastSr, kDelaySinceLastSr, &packet);
+  // A block without a last SR has no delay to update.
+  WriteReceiverReportWithBlock(0, 0, &packet);
+  Send(1, packet);
+  clock_.AdvanceTimeMilliseconds(kHoldTimeMs);
+  aggregator_->Flush();
+
+  ASSERT_EQ(1u, transport_.rtcp_packets_.size());
+  const std::vector<uint8_t>& sent = transport_.rtcp_packets_[0].data;
+  ASSERT_EQ(packet.size(), sent.size());
+  EXPECT_EQ(2, CountReceiverReports(sent));
+  EXPECT_EQ(kLastSr, ReadUWord32(&sent[24]));
+  EXPECT_EQ(kDelaySinceLastSr + kHoldTimeMs * 65536 / 1000,
+            ReadUWord32(&sent[28]));
+  EXPECT_EQ(0u, ReadUWord32(&sent[32 + 24]));
+  EXPECT_EQ(0u, ReadUWord32(&sent[32 + 28]));
+
+  // The round trip time the remote end computes when the packet arrives
+  // doesn't include the hold time.
+  const uint32_t kRttMs = 100;
+  const uint32_t arrival = kLastSr + kDelaySinceLastSr +
+      (kHoldTimeMs + kRttMs) * 65536 / 1000;
+  const uint32_t rtt = arrival - ReadUWord32(&sent[24]) -
+      ReadUWord32(&sent[28]);
+  EXPECT_NEAR(kRttMs, rtt * 1000 / 65536, 1u);
+}
+
+TEST_F(RtcpPacketAggregatorTest, SendsLargePacketsOnTheirOwn) {
+  SendReport(1, 0x1111);
+  std::vector<uint8_t> large;
+  for (int i = 0; i < kMaxPacketSize / 8 + 1; ++i)
+    WriteReceiverReport(i, &large);
+  Send(2, large);
+  ASSERT_EQ(2u, transport_.rtcp_packets_.size());
+  EXPECT_EQ(8u, transport_.rtcp_packets_[0].data.size());
+  EXPECT_TRUE(large == transport_.rtcp_packets_[1].data);
+  EXPECT_EQ(2, transport_.rtcp_packets_[1].channel);
+}
+
+TEST_F(RtcpPacketAggregatorTest, FlushesWhenDeleted) {
+  SendReport(1, 0x1111);
+  aggregator_.reset();
+  EXPECT_EQ(1u, transport_.rtcp_packets_.size());
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -64,24 +64,12 @@ RTCPReceiver::~RTCPReceiver() {
   delete _criticalSectionRTCPReceiver;
   delete _criticalSectionFeedbacks;
 
-  while (!_receivedReportBlockMap.empty()) {
-    std::map<uint32_t, RTCPReportBlockInformation*>::iterator first =
-        _receivedReportBlockMap.begin();
-    delete first->second;
-    _receivedReportBlockMap.erase(first);
-  }
   while (!_receivedInfoMap.empty()) {
     std::map<uint32_t, RTCPReceiveInformation*>::iterator first =
         _receivedInfoMap.begin();
     delete first->second;
     _receivedInfoMap.erase(first);
   }
-  while (!_receivedCnameMap.empty()) {
-    std::map<uint32_t, RTCPCnameInformation*>::iterator first =
-        _receivedCnameMap.begin();
-    delete first->second;
-    _receivedCnameMap.erase(first);
-  }
   WEBRTC_TRACE(kTraceMemory, kTraceRtpRtcp, _id,
                "%s deleted", __FUNCTION__);
 }
@@ -190,7 +178,7 @@ int32_t RTCPReceiver::RTT(const uint32_t remoteSSRC,
                           uint16_t* maxRTT) const {
   CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
 
-  RTCPReportBlockInformation* reportBlock =
+  const RTCPReportBlockInformation* reportBlock =
       GetReportBlockInformation(remoteSSRC);
 
   if (reportBlock == NULL) {
@@ -283,11 +271,11 @@ int32_t RTCPReceiver::StatisticsReceived(
   assert(receiveBlocks);
   CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
 
-  std::map<uint32_t, RTCPReportBlockInformation*>::const_iterator it =
+  SSRCMap<RTCPReportBlockInformation>::const_iterator it =
       _receivedReportBlockMap.begin();
 
   while (it != _receivedReportBlockMap.end()) {
-    receiveBlocks->push_back(it->second->remoteReceiveBlock);
+    receiveBlocks->push_back(it->second.remoteReceiveBlock);
     it++;
   }
   return 0;
@@ -574,59 +562,33 @@ RTCPReportBlockInformation*
 RTCPReceiver::CreateReportBlockInformation(uint32_t remoteSSRC) {
   CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
 
-  std::map<uint32_t, RTCPReportBlockInformation*>::iterator it =
-      _receivedReportBlockMap.find(remoteSSRC);
-
-  RTCPReportBlockInformation* ptrReportBlockInfo = NULL;
-  if (it != _receivedReportBlockMap.end()) {
-    ptrReportBlockInfo = it->second;
-  } else {
-    ptrReportBlockInfo = new RTCPReportBlockInformation;
-    _receivedReportBlockMap[remoteSSRC] = ptrReportBlockInfo;
-  }
-  return ptrReportBlockInfo;
+  return _receivedReportBlockMap.FindOrInsert(remoteSSRC);
 }
 
 RTCPReportBlockInformation*
-RTCPReceiver::GetReportBlockInformation(uint32_t remoteSSRC) const {
+RTCPReceiver::GetReportBlockInformation(uint32_t remoteSSRC) {
   CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
+  return _receivedReportBlockMap.Find(remoteSSRC);
+}
 
-  std::map<uint32_t, RTCPReportBlockInformation*>::const_iterator it =
-      _receivedReportBlockMap.find(remoteSSRC);
-
-  if (it == _receivedReportBlockMap.end()) {
-    return NULL;
-  }
-  return it->second;
+const RTCPReportBlockInformation*
+RTCPReceiver::GetReportBlockInformation(uint32_t remoteSSRC) const {
+  CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
+  return _receivedReportBlockMap.Find(remoteSSRC);
 }
 
 RTCPCnameInformation*
 RTCPReceiver::CreateCnameInformation(uint32_t remoteSSRC) {
   CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
 
-  std::map<uint32_t, RTCPCnameInformation*>::iterator it =
-      _receivedCnameMap.find(remoteSSRC);
-
-  if (it != _receivedCnameMap.end()) {
-    return it->second;
-  }
-  RTCPCnameInformation* cnameInfo = new RTCPCnameInformation;
-  memset(cnameInfo->name, 0, RTCP_CNAME_SIZE);
-  _receivedCnameMap[remoteSSRC] = cnameInfo;
-  return cnameInfo;
+  // A new entry is value initialized, i.e. has an empty name.
+  return _receivedCnameMap.FindOrInsert(remoteSSRC);
 }
 
-RTCPCnameInformation*
+const RTCPCnameInformation*
 RTCPReceiver::GetCnameInformation(uint32_t remoteSSRC) const {
   CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
-
-  std::map<uint32_t, RTCPCnameInformation*>::const_iterator it =
-      _receivedCnameMap.find(remoteSSRC);
-
-  if (it == _receivedCnameMap.end()) {
-    return NULL;
-  }
-  return it->second;
+  return _receivedCnameMap.Find(remoteSSRC);
 }
 
 RTCPReceiveInformation*
@@ -843,14 +805,7 @@ void RTCPReceiver::HandleBYE(RTCPUtility::RTCPParserV2& rtcpParser) {
 
   // clear our lists
   CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
-  std::map<uint32_t, RTCPReportBlockInformation*>::iterator
-      reportBlockInfoIt = _receivedReportBlockMap.find(
-          rtcpPacket.BYE.SenderSSRC);
-
-  if (reportBlockInfoIt != _receivedReportBlockMap.end()) {
-    delete reportBlockInfoIt->second;
-    _receivedReportBlockMap.erase(reportBlockInfoIt);
-  }
+  _receivedReportBlockMap.Erase(rtcpPacket.BYE.SenderSSRC);
   //  we can't delete it due to TMMBR
   std::map<uint32_t, RTCPReceiveInformation*>::iterator receiveInfoIt =
       _receivedInfoMap.find(rtcpPacket.BYE.SenderSSRC);
@@ -859,13 +814,7 @@ void RTCPReceiver::HandleBYE(RTCPUtility::RTCPParserV2& rtcpParser) {
     receiveInfoIt->second->readyForDelete = true;
   }
 
-  std::map<uint32_t, RTCPCnameInformation*>::iterator cnameInfoIt =
-      _receivedCnameMap.find(rtcpPacket.BYE.SenderSSRC);
-
-  if (cnameInfoIt != _receivedCnameMap.end()) {
-    delete cnameInfoIt->second;
-    _receivedCnameMap.erase(cnameInfoIt);
-  }
+  _receivedCnameMap.Erase(rtcpPacket.BYE.SenderSSRC);
   rtcpParser.Iterate();
 }
 
@@ -1074,7 +1023,8 @@ RTCPReceiver::HandleRPSI(RTCPUtility::RTCPParserV2& rtcpParser,
     if(pktType == RTCPUtility::kRtcpPsfbRpsiCode)
     {
         rtcpPacketInformation.rtcpPacketTypeFlags |= kRtcpRpsi; // received signal that we have a confirmed reference picture
-        if(rtcpPacket.RPSI.NumberOfValidBits%8 != 0)
+        uint8_t numberOfBytes = rtcpPacket.RPSI.NumberOfValidBits /8;
+        if(rtcpPacket.RPSI.NumberOfValidBits%8 != 0 || numberOfBytes == 0)
         {
             // to us unknown
             // continue
@@ -1084,13 +1034,13 @@ RTCPReceiver::HandleRPSI(RTCPUtility::RTCPParserV2& rtcpParser,
         rtcpPacketInformation.rpsiPictureId = 0;
 
         // convert NativeBitString to rpsiPictureId
-        uint8_t numberOfBytes = rtcpPacket.RPSI.NumberOfValidBits /8;
         for(uint8_t n = 0; n < (numberOfBytes-1); n++)
         {
             rtcpPacketInformation.rpsiPictureId += (rtcpPacket.RPSI.NativeBitString[n] & 0x7f);
             rtcpPacketInformation.rpsiPictureId <<= 7; // prepare next
         }
         rtcpPacketInformation.rpsiPictureId += (rtcpPacket.RPSI.NativeBitString[numberOfBytes-1] & 0x7f);
+        rtcpParser.Iterate();
     }
 }
 
@@ -1364,7 +1314,7 @@ int32_t RTCPReceiver::CNAME(const uint32_t remoteSSRC,
   assert(cName);
 
   CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
-  RTCPCnameInformation* cnameInfo = GetCnameInformation(remoteSSRC);
+  const RTCPCnameInformation* cnameInfo = GetCnameInformation(remoteSSRC);
   if (cnameInfo == NULL) {
     return -1;
   }
@@ -11,7 +11,10 @@
 #ifndef WEBRTC_MODULES_RTP_RTCP_SOURCE_RTCP_RECEIVER_HELP_H_
 #define WEBRTC_MODULES_RTP_RTCP_SOURCE_RTCP_RECEIVER_HELP_H_
 
+#include <algorithm>
 #include <list>
+#include <utility>
+#include <vector>
 
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"  // RTCPReportBlock
 #include "webrtc/modules/rtp_rtcp/source/rtcp_utility.h"
@@ -130,6 +133,68 @@ private:
     std::vector<int64_t> _tmmbrSetTimeouts;
 };
 
+// Map from SSRC to a |T| held by value in a vector sorted by SSRC, so a
+// lookup doesn't chase one heap node per remote SSRC. The pointers returned
+// by Find() and FindOrInsert() are invalidated by FindOrInsert() and Erase().
+template <typename T>
+class SSRCMap
+{
+public:
+    typedef std::pair<uint32_t, T> Entry;
+    typedef typename std::vector<Entry>::const_iterator const_iterator;
+
+    T* Find(const uint32_t ssrc)
+    {
+        typename std::vector<Entry>::iterator it = LowerBound(ssrc);
+        return (it != _entries.end() && it->first == ssrc) ? &it->second
+                                                            : NULL;
+    }
+    const T* Find(const uint32_t ssrc) const
+    {
+        return const_cast<SSRCMap*>(this)->Find(ssrc);
+    }
+
+    // Inserts a value initialized |T| if |ssrc| isn't in the map.
+    T* FindOrInsert(const uint32_t ssrc)
+    {
+        typename std::vector<Entry>::iterator it = LowerBound(ssrc);
+        if (it == _entries.end() || it->first != ssrc)
+        {
+            it = _entries.insert(it, Entry(ssrc, T()));
+        }
+        return &it->second;
+    }
+
+    bool Erase(const uint32_t ssrc)
+    {
+        typename std::vector<Entry>::iterator it = LowerBound(ssrc);
+        if (it == _entries.end() || it->first != ssrc)
+        {
+            return false;
+        }
+        _entries.erase(it);
+        return true;
+    }
+
+    bool empty() const { return _entries.empty(); }
+    const_iterator begin() const { return _entries.begin(); }
+    const_iterator end() const { return _entries.end(); }
+
+private:
+    static bool SSRCLess(const Entry& entry, const uint32_t ssrc)
+    {
+        return entry.first < ssrc;
+    }
+
+    typename std::vector<Entry>::iterator LowerBound(const uint32_t ssrc)
+    {
+        return std::lower_bound(_entries.begin(), _entries.end(), ssrc,
+                                SSRCLess);
+    }
+
+    std::vector<Entry> _entries;
+};
+
 } // end namespace RTCPHelp
 } // namespace webrtc
 
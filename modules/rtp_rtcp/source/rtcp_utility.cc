@@ -15,6 +15,29 @@
 #include <cstring> // memcpy
 
 namespace webrtc {
+namespace {
+
+// Returns |mantissa| * 2^|exponent| / |divisor|, saturated to 32 bits. The
+// exponent of a received bitrate can be up to 63.
+uint32_t SaturatedBitrate(uint32_t mantissa, uint8_t exponent,
+                          uint32_t divisor)
+{
+    if (mantissa == 0)
+    {
+        return 0;
+    }
+    // The mantissa has at most 18 bits.
+    if (exponent > 45)
+    {
+        return 0xFFFFFFFF;
+    }
+    const uint64_t bitrate = (static_cast<uint64_t>(mantissa) << exponent) /
+        divisor;
+    return (bitrate > 0xFFFFFFFF) ? 0xFFFFFFFF : static_cast<uint32_t>(bitrate);
+}
+
+}  // namespace
+
 // RTCPParserV2 : currently read only
 
 RTCPUtility::RTCPParserV2::RTCPParserV2(const uint8_t* rtcpData,
@@ -1147,14 +1170,25 @@ RTCPUtility::RTCPParserV2::ParseRPSIItem()
         return false;
     }
 
+    uint8_t paddingBits = *_ptrRTCPData++;
+    if (paddingBits > (length-2)*8)
+    {
+        _state = State_TopLevel;
+
+        EndCurrentBlock();
+        return false;
+    }
     _packetType = kRtcpPsfbRpsiCode;
 
-    uint8_t paddingBits = *_ptrRTCPData++;
     _packet.RPSI.PayloadType = *_ptrRTCPData++;
 
     memcpy(_packet.RPSI.NativeBitString, _ptrRTCPData, length-2);
+    _ptrRTCPData += length-2;
 
     _packet.RPSI.NumberOfValidBits = uint16_t(length-2)*8 - paddingBits;
+
+    // One RPSI per message.
+    _state = State_TopLevel;
     return true;
 }
 
@@ -1250,7 +1284,7 @@ RTCPUtility::RTCPParserV2::ParsePsfbREMBItem()
     brMantissa += (_ptrRTCPData[2]);
 
     _ptrRTCPData += 3; // Fwd read data
-    _packet.REMBItem.BitRate = (brMantissa << brExp);
+    _packet.REMBItem.BitRate = SaturatedBitrate(brMantissa, brExp, 1);
 
     const ptrdiff_t length_ssrcs = _ptrRTCPBlockEnd - _ptrRTCPData;
     if (length_ssrcs < 4 * _packet.REMBItem.NumberOfSSRCs)
@@ -1306,7 +1340,8 @@ RTCPUtility::RTCPParserV2::ParseTMMBRItem()
 
     _ptrRTCPData += 4; // Fwd read data
 
-    _packet.TMMBRItem.MaxTotalMediaBitRate = ((mxtbrMantissa << mxtbrExp) / 1000);
+    _packet.TMMBRItem.MaxTotalMediaBitRate = SaturatedBitrate(mxtbrMantissa,
+                                                         mxtbrExp, 1000);
     _packet.TMMBRItem.MeasuredOverhead     = measuredOH;
 
     return true;
@@ -1345,7 +1380,8 @@ RTCPUtility::RTCPParserV2::ParseTMMBNItem()
 
     _ptrRTCPData += 4; // Fwd read data
 
-    _packet.TMMBNItem.MaxTotalMediaBitRate = ((mxtbrMantissa << mxtbrExp) / 1000);
+    _packet.TMMBNItem.MaxTotalMediaBitRate = SaturatedBitrate(mxtbrMantissa,
+                                                         mxtbrExp, 1000);
     _packet.TMMBNItem.MeasuredOverhead     = measuredOH;
 
     return true;
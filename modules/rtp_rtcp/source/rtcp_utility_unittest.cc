@@ -0,0 +1,279 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/rtp_rtcp/source/rtcp_utility.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+
+using RTCPUtility::RTCPPacket;
+using RTCPUtility::RTCPPacketTypes;
+using RTCPUtility::RTCPParserV2;
+
+namespace {
+
+const uint32_t kSenderSsrc = 0x11223344;
+const uint32_t kReceiverSsrc = 0x55667788;
+
+// Compound packets recorded from a video call.
+// SR with one report block, SDES CNAME and REMB.
+const uint8_t kSenderReportPacket[] = {
+  0x81, 0xc8, 0x00, 0x0c, 0x11, 0x22, 0x33, 0x44,
+  0xd5, 0xa0, 0xb1, 0xc2, 0x12, 0x34, 0x56, 0x78,
+  0x00, 0x01, 0xe2, 0x40, 0x00, 0x00, 0x00, 0x64,
+  0x00, 0x00, 0xc3, 0x50,
+  0x55, 0x66, 0x77, 0x88, 0x05, 0x00, 0x00, 0x03,
+  0x00, 0x01, 0x12, 0x34, 0x00, 0x00, 0x00, 0x20,
+  0xa0, 0xb1, 0xc2, 0x12, 0x00, 0x01, 0x00, 0x00,
+  0x81, 0xca, 0x00, 0x04, 0x11, 0x22, 0x33, 0x44,
+  0x01, 0x08, 'a', 'b', 'c', 'd', 'e', 'f',
+  'g', 'h', 0x00, 0x00,
+  0x8f, 0xce, 0x00, 0x05, 0x11, 0x22, 0x33, 0x44,
+  0x00, 0x00, 0x00, 0x00, 'R', 'E', 'M', 'B',
+  0x01, 0x0b, 0xd0, 0x90, 0x55, 0x66, 0x77, 0x88
+};
+// RR without report blocks, NACK with two items and PLI.
+const uint8_t kReceiverReportPacket[] = {
+  0x80, 0xc9, 0x00, 0x01, 0x55, 0x66, 0x77, 0x88,
+  0x81, 0xcd, 0x00, 0x04, 0x55, 0x66, 0x77, 0x88,
+  0x11, 0x22, 0x33, 0x44, 0x01, 0x02, 0x00, 0x03,
+  0x02, 0x00, 0x00, 0x00,
+  0x81, 0xce, 0x00, 0x02, 0x55, 0x66, 0x77, 0x88,
+  0x11, 0x22, 0x33, 0x44
+};
+
+struct RecordedPacket {
+  const uint8_t* data;
+  size_t length;
+};
+
+const RecordedPacket kRecordedPackets[] = {
+  { kSenderReportPacket, sizeof(kSenderReportPacket) },
+  { kReceiverReportPacket, sizeof(kReceiverReportPacket) }
+};
+
+struct ParsedItem {
+  RTCPPacketTypes type;
+  RTCPPacket packet;
+};
+
+// Iterates an RTCPParserV2 over |data| and returns the parsed items. Returns
+// nothing if the packet is not valid.
+std::vector<ParsedItem> Parse(const uint8_t* data, size_t length,
+                              bool reduced_size) {
+  std::vector<ParsedItem> items;
+  RTCPParserV2 parser(data, length, reduced_size);
+  if (!parser.IsValid()) {
+    return items;
+  }
+  for (RTCPPacketTypes type = parser.Begin();
+       type != RTCPUtility::kRtcpNotValidCode; type = parser.Iterate()) {
+    ParsedItem item;
+    item.type = type;
+    item.packet = parser.Packet();
+    items.push_back(item);
+    // Each item takes at least one byte of the packet.
+    if (items.size() > length) {
+      ADD_FAILURE() << "The parser does not advance.";
+      break;
+    }
+  }
+  return items;
+}
+
+// Checks the invariants that RTCPReceiver relies on.
+void VerifyItems(const std::vector<ParsedItem>& items) {
+  for (size_t i = 0; i < items.size(); ++i) {
+    const RTCPPacket& packet = items[i].packet;
+    switch (items[i].type) {
+      case RTCPUtility::kRtcpSdesChunkCode:
+        EXPECT_LT(strlen(packet.CName.CName),
+                  static_cast<size_t>(RTCP_CNAME_SIZE));
+        break;
+      case RTCPUtility::kRtcpPsfbRembItemCode:
+        EXPECT_LE(packet.REMBItem.NumberOfSSRCs,
+                  MAX_NUMBER_OF_REMB_FEEDBACK_SSRCS);
+        break;
+      case RTCPUtility::kRtcpPsfbRpsiCode:
+        // The first RPSI code of a message is its header, without a bit
+        // string.
+        if (i > 0 && items[i - 1].type == RTCPUtility::kRtcpPsfbRpsiCode) {
+          EXPECT_LE(packet.RPSI.NumberOfValidBits,
+                    sizeof(packet.RPSI.NativeBitString) * 8);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+TEST(RtcpParserTest, ParsesSenderReport) {
+  std::vector<ParsedItem> items = Parse(kSenderReportPacket,
+                                        sizeof(kSenderReportPacket), false);
+  ASSERT_EQ(7u, items.size());
+
+  ASSERT_EQ(RTCPUtility::kRtcpSrCode, items[0].type);
+  const RTCPUtility::RTCPPacketSR& sr = items[0].packet.SR;
+  EXPECT_EQ(kSenderSsrc, sr.SenderSSRC);
+  EXPECT_EQ(1, sr.NumberOfReportBlocks);
+  EXPECT_EQ(0xd5a0b1c2u, sr.NTPMostSignificant);
+  EXPECT_EQ(0x12345678u, sr.NTPLeastSignificant);
+  EXPECT_EQ(123456u, sr.RTPTimestamp);
+  EXPECT_EQ(100u, sr.SenderPacketCount);
+  EXPECT_EQ(50000u, sr.SenderOctetCount);
+
+  ASSERT_EQ(RTCPUtility::kRtcpReportBlockItemCode, items[1].type);
+  const RTCPUtility::RTCPPacketReportBlockItem& block =
+      items[1].packet.ReportBlockItem;
+  EXPECT_EQ(kReceiverSsrc, block.SSRC);
+  EXPECT_EQ(5, block.FractionLost);
+  EXPECT_EQ(3u, block.CumulativeNumOfPacketsLost);
+  EXPECT_EQ(0x11234u, block.ExtendedHighestSequenceNumber);
+  EXPECT_EQ(0x20u, block.Jitter);
+  EXPECT_EQ(0xa0b1c212u, block.LastSR);
+  EXPECT_EQ(0x10000u, block.DelayLastSR);
+
+  EXPECT_EQ(RTCPUtility::kRtcpSdesCode, items[2].type);
+  ASSERT_EQ(RTCPUtility::kRtcpSdesChunkCode, items[3].type);
+  EXPECT_EQ(kSenderSsrc, items[3].packet.CName.SenderSSRC);
+  EXPECT_STREQ("abcdefgh", items[3].packet.CName.CName);
+
+  ASSERT_EQ(RTCPUtility::kRtcpPsfbAppCode, items[4].type);
+  EXPECT_EQ(kSenderSsrc, items[4].packet.PSFBAPP.SenderSSRC);
+  EXPECT_EQ(RTCPUtility::kRtcpPsfbRembCode, items[5].type);
+  ASSERT_EQ(RTCPUtility::kRtcpPsfbRembItemCode, items[6].type);
+  EXPECT_EQ(1000000u, items[6].packet.REMBItem.BitRate);
+  ASSERT_EQ(1, items[6].packet.REMBItem.NumberOfSSRCs);
+  EXPECT_EQ(kReceiverSsrc, items[6].packet.REMBItem.SSRCs[0]);
+}
+
+TEST(RtcpParserTest, ParsesReceiverReport) {
+  std::vector<ParsedItem> items = Parse(kReceiverReportPacket,
+                                        sizeof(kReceiverReportPacket), false);
+  ASSERT_EQ(5u, items.size());
+
+  ASSERT_EQ(RTCPUtility::kRtcpRrCode, items[0].type);
+  EXPECT_EQ(kReceiverSsrc, items[0].packet.RR.SenderSSRC);
+  EXPECT_EQ(0, items[0].packet.RR.NumberOfReportBlocks);
+
+  ASSERT_EQ(RTCPUtility::kRtcpRtpfbNackCode, items[1].type);
+  EXPECT_EQ(kReceiverSsrc, items[1].packet.NACK.SenderSSRC);
+  EXPECT_EQ(kSenderSsrc, items[1].packet.NACK.MediaSSRC);
+  ASSERT_EQ(RTCPUtility::kRtcpRtpfbNackItemCode, items[2].type);
+  EXPECT_EQ(0x0102, items[2].packet.NACKItem.PacketID);
+  EXPECT_EQ(0x0003, items[2].packet.NACKItem.BitMask);
+  ASSERT_EQ(RTCPUtility::kRtcpRtpfbNackItemCode, items[3].type);
+  EXPECT_EQ(0x0200, items[3].packet.NACKItem.PacketID);
+  EXPECT_EQ(0x0000, items[3].packet.NACKItem.BitMask);
+
+  ASSERT_EQ(RTCPUtility::kRtcpPsfbPliCode, items[4].type);
+  EXPECT_EQ(kSenderSsrc, items[4].packet.PLI.MediaSSRC);
+}
+
+TEST(RtcpParserTest, RequiresReportFirstUnlessReducedSize) {
+  // The PLI of kReceiverReportPacket on its own.
+  const uint8_t* pli = kReceiverReportPacket + 28;
+  const size_t pli_length = sizeof(kReceiverReportPacket) - 28;
+  EXPECT_TRUE(Parse(pli, pli_length, false).empty());
+  std::vector<ParsedItem> items = Parse(pli, pli_length, true);
+  ASSERT_EQ(1u, items.size());
+  EXPECT_EQ(RTCPUtility::kRtcpPsfbPliCode, items[0].type);
+}
+
+TEST(RtcpParserTest, ParsesMessageAfterRpsi) {
+  const uint8_t kRpsiPacket[] = {
+    0x80, 0xc9, 0x00, 0x01, 0x55, 0x66, 0x77, 0x88,
+    0x83, 0xce, 0x00, 0x03, 0x55, 0x66, 0x77, 0x88,
+    0x11, 0x22, 0x33, 0x44, 0x00, 0x64, 0x12, 0x34,
+    0x81, 0xce, 0x00, 0x02, 0x55, 0x66, 0x77, 0x88,
+    0x11, 0x22, 0x33, 0x44
+  };
+  std::vector<ParsedItem> items = Parse(kRpsiPacket, sizeof(kRpsiPacket),
+                                        false);
+  ASSERT_EQ(4u, items.size());
+  // The header of the message, then its bit string.
+  ASSERT_EQ(RTCPUtility::kRtcpPsfbRpsiCode, items[1].type);
+  EXPECT_EQ(kSenderSsrc, items[1].packet.RPSI.MediaSSRC);
+  ASSERT_EQ(RTCPUtility::kRtcpPsfbRpsiCode, items[2].type);
+  const RTCPUtility::RTCPPacketPSFBRPSI& rpsi = items[2].packet.RPSI;
+  EXPECT_EQ(0x64, rpsi.PayloadType);
+  EXPECT_EQ(16, rpsi.NumberOfValidBits);
+  EXPECT_EQ(0x12, rpsi.NativeBitString[0]);
+  EXPECT_EQ(0x34, rpsi.NativeBitString[1]);
+  EXPECT_EQ(RTCPUtility::kRtcpPsfbPliCode, items[3].type);
+}
+
+TEST(RtcpParserTest, SurvivesCorruptedPackets) {
+  srand(1234);
+  const int kIterations = 20000;
+  uint8_t buffer[256];
+  for (int i = 0; i < kIterations; ++i) {
+    const RecordedPacket& recorded = kRecordedPackets[i % 2];
+    memcpy(buffer, recorded.data, recorded.length);
+    // Flip a few bits and cut the packet short.
+    const int num_flips = 1 + rand() % 4;
+    for (int j = 0; j < num_flips; ++j) {
+      buffer[rand() % recorded.length] ^= 1 << (rand() % 8);
+    }
+    const size_t length = (i % 3 == 0) ? rand() % (recorded.length + 1)
+                                       : recorded.length;
+    VerifyItems(Parse(buffer, length, i % 2 == 0));
+  }
+}
+
+TEST(RtcpParserTest, SurvivesRandomPackets) {
+  srand(5678);
+  const int kIterations = 20000;
+  uint8_t buffer[256];
+  for (int i = 0; i < kIterations; ++i) {
+    const size_t length = rand() % sizeof(buffer);
+    for (size_t j = 0; j < length; ++j) {
+      buffer[j] = static_cast<uint8_t>(rand());
+    }
+    // Make most headers valid so the parser gets past the first one.
+    if (length > 0 && i % 4 != 0) {
+      buffer[0] = (buffer[0] & 0x3f) | 0x80;
+    }
+    VerifyItems(Parse(buffer, length, true));
+  }
+}
+
+// Benchmark of iterating RTCPParserV2 over recorded packets, the way
+// RTCPReceiver::IncomingRTCPPacket() does.
+TEST(RtcpParserTest, DISABLED_ParsingThroughput) {
+  const int kIterations = 200000;
+  int num_items = 0;
+  TickTime start = TickTime::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    const RecordedPacket& recorded = kRecordedPackets[i % 2];
+    RTCPParserV2 parser(recorded.data, recorded.length, false);
+    for (RTCPPacketTypes type = parser.Begin();
+         type != RTCPUtility::kRtcpNotValidCode; type = parser.Iterate()) {
+      ++num_items;
+    }
+  }
+  const double elapsed_us =
+      static_cast<double>((TickTime::Now() - start).Microseconds());
+  EXPECT_EQ(kIterations / 2 * 12, num_items);
+
+  printf("Iterating RTCPParserV2 took %.3fus per packet, %.0f packets/s.\n",
+         elapsed_us / kIterations, kIterations * 1e6 / elapsed_us);
+}
+
+}  // namespace
+}  // namespace webrtc
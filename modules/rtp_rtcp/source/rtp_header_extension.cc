@@ -9,13 +9,35 @@
  */
 
 #include <cassert>
+#include <string.h>
 
 #include "webrtc/common_types.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_header_extension.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
 
 namespace webrtc {
 
-RtpHeaderExtensionMap::RtpHeaderExtensionMap() {
+namespace {
+
+const RtpExtensionInfo kRtpExtensionInfo[] = {
+  { kRtpExtensionTransmissionTimeOffset, kTransmissionTimeOffsetLength - 1 },
+  { kRtpExtensionAudioLevel, 0 },
+  { kRtpExtensionAbsoluteSendTime, kAbsoluteSendTimeLength - 1 },
+};
+
+}  // namespace
+
+const RtpExtensionInfo* GetRtpExtensionInfo(RTPExtensionType type) {
+  for (size_t i = 0; i < sizeof(kRtpExtensionInfo) /
+                             sizeof(kRtpExtensionInfo[0]); ++i) {
+    if (kRtpExtensionInfo[i].type == type) {
+      return &kRtpExtensionInfo[i];
+    }
+  }
+  return NULL;
+}
+
+RtpHeaderExtensionMap::RtpHeaderExtensionMap() : total_length_(0) {
 }
 
 RtpHeaderExtensionMap::~RtpHeaderExtensionMap() {
@@ -29,11 +51,12 @@ void RtpHeaderExtensionMap::Erase() {
     delete it->second;
     extensionMap_.erase(it);
   }
+  total_length_ = 0;
 }
 
 int32_t RtpHeaderExtensionMap::Register(const RTPExtensionType type,
                                         const uint8_t id) {
-  if (id < 1 || id > 14) {
+  if (id < 1 || id > 14 || GetRtpExtensionInfo(type) == NULL) {
     return -1;
   }
   std::map<uint8_t, HeaderExtension*>::iterator it =
@@ -49,6 +72,7 @@ int32_t RtpHeaderExtensionMap::Register(const RTPExtensionType type,
     return 0;
   }
   extensionMap_[id] = new HeaderExtension(type);
+  UpdateLayout();
   return 0;
 }
 
@@ -62,6 +86,7 @@ int32_t RtpHeaderExtensionMap::Deregister(const RTPExtensionType type) {
   assert(it != extensionMap_.end());
   delete it->second;
   extensionMap_.erase(it);
+  UpdateLayout();
   return 0;
 }
 
@@ -95,45 +120,90 @@ int32_t RtpHeaderExtensionMap::GetId(const RTPExtensionType type,
   return -1;
 }
 
-uint16_t RtpHeaderExtensionMap::GetTotalLengthInBytes() const {
-  // Get length for each extension block.
-  uint16_t length = 0;
-  std::map<uint8_t, HeaderExtension*>::const_iterator it =
-      extensionMap_.begin();
-  while (it != extensionMap_.end()) {
+void RtpHeaderExtensionMap::UpdateLayout() {
+  // Extensions are written in order of their ids.
+  uint16_t length = kRtpOneByteHeaderLength;
+  std::map<uint8_t, HeaderExtension*>::iterator it = extensionMap_.begin();
+  for (; it != extensionMap_.end(); ++it) {
     HeaderExtension* extension = it->second;
+    assert(extension->length <= 1 + kRtpOneByteHeaderMaxDataLength);
+    extension->offset = length;
     length += extension->length;
-    it++;
   }
-  // Add RTP extension header length.
-  if (length > 0) {
-    length += kRtpOneByteHeaderLength;
+  if (length == kRtpOneByteHeaderLength) {
+    // Nothing to write.
+    total_length_ = 0;
+    return;
   }
-  return length;
+  // Pad to a whole number of 32-bit words.
+  total_length_ = (length + 3) & ~3;
+}
+
+uint16_t RtpHeaderExtensionMap::GetTotalLengthInBytes() const {
+  return total_length_;
 }
 
 int32_t RtpHeaderExtensionMap::GetLengthUntilBlockStartInBytes(
     const RTPExtensionType type) const {
-  uint8_t id;
-  if (GetId(type, &id) != 0) {
-    // Not registered.
-    return -1;
+  std::map<uint8_t, HeaderExtension*>::const_iterator it =
+      extensionMap_.begin();
+  for (; it != extensionMap_.end(); ++it) {
+    if (it->second->type == type) {
+      return it->second->offset;
+    }
   }
-  // Get length until start of extension block type.
-  uint16_t length = kRtpOneByteHeaderLength;
+  // Not registered.
+  return -1;
+}
 
+int32_t RtpHeaderExtensionMap::GetDataOffset(
+    const RTPExtensionType type) const {
   std::map<uint8_t, HeaderExtension*>::const_iterator it =
       extensionMap_.begin();
-  while (it != extensionMap_.end()) {
-    HeaderExtension* extension = it->second;
-    if (extension->type == type) {
-      break;
-    } else {
-      length += extension->length;
+  for (; it != extensionMap_.end(); ++it) {
+    if (it->second->type == type) {
+      return it->second->length > 0 ? it->second->offset + 1 : -1;
+    }
+  }
+  return -1;
+}
+
+uint16_t RtpHeaderExtensionMap::WriteExtensionBlock(
+    uint8_t* data_buffer) const {
+  if (total_length_ == 0) {
+    return 0;
+  }
+  // RTP header extension, RFC 3550.
+  //   0                   1                   2                   3
+  //   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+  //  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  //  |      defined by profile       |           length              |
+  //  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  //  |                        header extension                       |
+  //  |                             ....                              |
+  //
+  ModuleRTPUtility::AssignUWord16ToBuffer(data_buffer,
+                                          kRtpOneByteHeaderExtensionId);
+  // Length in number of Word32, header excluded.
+  ModuleRTPUtility::AssignUWord16ToBuffer(
+      data_buffer + 2, (total_length_ - kRtpOneByteHeaderLength) / 4);
+  memset(data_buffer + kRtpOneByteHeaderLength, 0,
+         total_length_ - kRtpOneByteHeaderLength);
+  std::map<uint8_t, HeaderExtension*>::const_iterator it =
+      extensionMap_.begin();
+  for (; it != extensionMap_.end(); ++it) {
+    const HeaderExtension* extension = it->second;
+    if (extension->length > 0) {
+      //  0
+      //  0 1 2 3 4 5 6 7
+      // +-+-+-+-+-+-+-+-+
+      // |  ID   |  len  |
+      // +-+-+-+-+-+-+-+-+
+      data_buffer[extension->offset] = (it->first << 4) +
+                                       (extension->length - 2);
     }
-    it++;
   }
-  return length;
+  return total_length_;
 }
 
 int32_t RtpHeaderExtensionMap::Size() const {
@@ -11,6 +11,8 @@
 #ifndef WEBRTC_MODULES_RTP_RTCP_RTP_HEADER_EXTENSION_H_
 #define WEBRTC_MODULES_RTP_RTCP_RTP_HEADER_EXTENSION_H_
 
+#include <assert.h>
+
 #include <map>
 
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
@@ -25,34 +27,44 @@ const size_t kTransmissionTimeOffsetLength = 4;
 const size_t kAudioLevelLength = 2;
 const size_t kAbsoluteSendTimeLength = 4;
 
+// The one-byte header form limits the data of an element to 16 bytes.
+const uint8_t kRtpOneByteHeaderMaxDataLength = 16;
+
+// Describes how the RTP sender writes an extension. Adding an extension to
+// the send path is a matter of adding a row to the table in
+// rtp_header_extension.cc and writing its value at GetDataOffset().
+struct RtpExtensionInfo {
+  RTPExtensionType type;
+  // Bytes of data after the ID/len byte. Zero for extensions which are not
+  // written in the common extension block.
+  uint8_t data_length;
+};
+
+// Returns the table entry of |type|, or NULL if |type| isn't known.
+const RtpExtensionInfo* GetRtpExtensionInfo(RTPExtensionType type);
+
 struct HeaderExtension {
-  HeaderExtension(RTPExtensionType extension_type)
+  explicit HeaderExtension(RTPExtensionType extension_type)
     : type(extension_type),
-      length(0) {
-    // TODO(solenberg): Create handler classes for header extensions so we can
-    // get rid of switches like these as well as handling code spread out all
-    // over.
-    switch (type) {
-      case kRtpExtensionTransmissionTimeOffset:
-        length = kTransmissionTimeOffsetLength;
-        break;
-      case kRtpExtensionAudioLevel:
-        // TODO(solenberg): Because of how the audio level extension is handled
-        // in RTPSenderAudio::SendAudio(), we cannot set the actual length here
-        // but must leave it at zero. The consequence is that any other header
-        // extensions registered for an audio channel are effectively ignored.
-        // length = kAudioLevelLength;
-        break;
-      case kRtpExtensionAbsoluteSendTime:
-        length = kAbsoluteSendTimeLength;
-        break;
-      default:
-        assert(false);
+      length(0),
+      offset(0) {
+    const RtpExtensionInfo* info = GetRtpExtensionInfo(type);
+    assert(info);
+    // TODO(solenberg): Because of how the audio level extension is handled
+    // in RTPSenderAudio::SendAudio(), its data length in the table is zero.
+    // The consequence is that any other header extensions registered for an
+    // audio channel are effectively ignored.
+    if (info && info->data_length > 0) {
+      length = 1 + info->data_length;
     }
   }
 
    const RTPExtensionType type;
+   // Bytes taken in the extension block, including the ID/len byte.
    uint8_t length;
+   // Position of the ID/len byte from the start of the extension header,
+   // updated on each registration.
+   uint16_t offset;
 };
 
 class RtpHeaderExtensionMap {
@@ -74,6 +86,15 @@ class RtpHeaderExtensionMap {
 
   int32_t GetLengthUntilBlockStartInBytes(const RTPExtensionType type) const;
 
+  // Returns the position of the data of |type| from the start of the
+  // extension header, or -1 if |type| isn't written in the block.
+  int32_t GetDataOffset(const RTPExtensionType type) const;
+
+  // Writes the extension header and the ID/len byte of each extension to
+  // |data_buffer|, with zeroed data and padding. Returns the number of bytes
+  // written, i.e. GetTotalLengthInBytes().
+  uint16_t WriteExtensionBlock(uint8_t* data_buffer) const;
+
   void GetCopy(RtpHeaderExtensionMap* map) const;
 
   int32_t Size() const;
@@ -83,7 +104,12 @@ class RtpHeaderExtensionMap {
   RTPExtensionType Next(RTPExtensionType type) const;
 
  private:
+  // Recomputes the offsets and the total length after a change of the
+  // registered extensions, so the send path doesn't have to.
+  void UpdateLayout();
+
   std::map<uint8_t, HeaderExtension*> extensionMap_;
+  uint16_t total_length_;
 };
 }
 
@@ -13,6 +13,8 @@
  * This file includes unit tests for the RtpHeaderExtensionMap.
  */
 
+#include <string.h>
+
 #include "testing/gtest/include/gtest/gtest.h"
 
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
@@ -74,6 +76,42 @@ TEST_F(RtpHeaderExtensionTest, GetLengthUntilBlockStart) {
                 kRtpExtensionTransmissionTimeOffset));
 }
 
+TEST_F(RtpHeaderExtensionTest, LayoutFollowsIdOrder) {
+  EXPECT_EQ(0, map_.Register(kRtpExtensionAbsoluteSendTime, kId + 1));
+  EXPECT_EQ(4, map_.GetLengthUntilBlockStartInBytes(
+      kRtpExtensionAbsoluteSendTime));
+  EXPECT_EQ(0, map_.Register(kRtpExtensionTransmissionTimeOffset, kId));
+  EXPECT_EQ(4, map_.GetLengthUntilBlockStartInBytes(
+      kRtpExtensionTransmissionTimeOffset));
+  EXPECT_EQ(8, map_.GetLengthUntilBlockStartInBytes(
+      kRtpExtensionAbsoluteSendTime));
+  EXPECT_EQ(9, map_.GetDataOffset(kRtpExtensionAbsoluteSendTime));
+  EXPECT_EQ(12, map_.GetTotalLengthInBytes());
+
+  // The audio level extension is written by the audio sender.
+  EXPECT_EQ(0, map_.Register(kRtpExtensionAudioLevel, kId + 2));
+  EXPECT_EQ(-1, map_.GetDataOffset(kRtpExtensionAudioLevel));
+  EXPECT_EQ(12, map_.GetTotalLengthInBytes());
+
+  EXPECT_EQ(0, map_.Deregister(kRtpExtensionTransmissionTimeOffset));
+  EXPECT_EQ(5, map_.GetDataOffset(kRtpExtensionAbsoluteSendTime));
+  EXPECT_EQ(8, map_.GetTotalLengthInBytes());
+}
+
+TEST_F(RtpHeaderExtensionTest, WriteExtensionBlock) {
+  uint8_t block[12];
+  memset(block, 0xff, sizeof(block));
+  EXPECT_EQ(0, map_.WriteExtensionBlock(block));
+
+  EXPECT_EQ(0, map_.Register(kRtpExtensionTransmissionTimeOffset, kId));
+  EXPECT_EQ(0, map_.Register(kRtpExtensionAbsoluteSendTime, kId + 1));
+  EXPECT_EQ(sizeof(block), map_.WriteExtensionBlock(block));
+  const uint8_t kExpected[] = { 0xBE, 0xDE, 0x00, 0x02,
+                                (kId << 4) + 2, 0x00, 0x00, 0x00,
+                                ((kId + 1) << 4) + 2, 0x00, 0x00, 0x00 };
+  EXPECT_EQ(0, memcmp(kExpected, block, sizeof(block)));
+}
+
 TEST_F(RtpHeaderExtensionTest, GetType) {
   RTPExtensionType typeOut;
   EXPECT_EQ(-1, map_.GetType(kId, &typeOut));
@@ -0,0 +1,49 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/rtp_rtcp/source/rtp_packet_buffer.h"
+
+#include <string.h>
+
+namespace webrtc {
+
+RtpPacketBuffer::RtpPacketBuffer(uint16_t capacity)
+    : ref_count_(0),
+      data_(new uint8_t[capacity]),
+      capacity_(capacity),
+      length_(0) {
+}
+
+RtpPacketBuffer::~RtpPacketBuffer() {}
+
+int32_t RtpPacketBuffer::AddRef() {
+  return ++ref_count_;
+}
+
+int32_t RtpPacketBuffer::Release() {
+  int32_t ref_count = --ref_count_;
+  if (ref_count == 0)
+    delete this;
+  return ref_count;
+}
+
+bool RtpPacketBuffer::HasOneRef() const {
+  return ref_count_.Value() == 1;
+}
+
+bool RtpPacketBuffer::SetData(const uint8_t* data, uint16_t length) {
+  if (length > capacity_)
+    return false;
+  memcpy(data_.get(), data, length);
+  length_ = length;
+  return true;
+}
+
+}  // namespace webrtc
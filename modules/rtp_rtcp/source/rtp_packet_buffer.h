@@ -0,0 +1,65 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_RTP_RTCP_SOURCE_RTP_PACKET_BUFFER_H_
+#define WEBRTC_MODULES_RTP_RTCP_SOURCE_RTP_PACKET_BUFFER_H_
+
+#include <assert.h>
+
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// Reference counted buffer holding one RTP packet, used to pass packets
+// between the send side components without copying them.
+// Use with scoped_refptr<RtpPacketBuffer>.
+class RtpPacketBuffer {
+ public:
+  explicit RtpPacketBuffer(uint16_t capacity);
+
+  int32_t AddRef();
+  int32_t Release();
+
+  // Returns true if the caller holds the only reference to the buffer, in
+  // which case it may safely be modified.
+  bool HasOneRef() const;
+
+  uint8_t* data() { return data_.get(); }
+  const uint8_t* data() const { return data_.get(); }
+  uint16_t length() const { return length_; }
+  uint16_t capacity() const { return capacity_; }
+
+  // Copies |length| bytes from |data| into the buffer. Returns false if the
+  // buffer is too small.
+  bool SetData(const uint8_t* data, uint16_t length);
+
+  // Sets the length of a packet written directly to data().
+  void set_length(uint16_t length) {
+    assert(length <= capacity_);
+    length_ = length;
+  }
+
+ private:
+  ~RtpPacketBuffer();
+
+  Atomic32 ref_count_;
+  scoped_array<uint8_t> data_;
+  const uint16_t capacity_;
+  uint16_t length_;
+
+  DISALLOW_COPY_AND_ASSIGN(RtpPacketBuffer);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_RTP_RTCP_SOURCE_RTP_PACKET_BUFFER_H_
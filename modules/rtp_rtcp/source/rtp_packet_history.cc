@@ -11,7 +11,7 @@
 #include "webrtc/modules/rtp_rtcp/source/rtp_packet_history.h"
 
 #include <assert.h>
-#include <cstring>   // memset
+#include <cstring>   // memcpy
 
 #include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
@@ -23,8 +23,8 @@ RTPPacketHistory::RTPPacketHistory(Clock* clock)
   : clock_(clock),
     critsect_(CriticalSectionWrapper::CreateCriticalSection()),
     store_(false),
-    prev_index_(0),
-    max_packet_length_(0) {
+    max_packet_length_(0),
+    index_mask_(0) {
 }
 
 RTPPacketHistory::~RTPPacketHistory() {
@@ -50,13 +50,13 @@ void RTPPacketHistory::Allocate(uint16_t number_to_store) {
     return;
   }
 
+  uint32_t size = 1;
+  while (size < number_to_store) {
+    size <<= 1;
+  }
   store_ = true;
-  stored_packets_.resize(number_to_store);
-  stored_seq_nums_.resize(number_to_store);
-  stored_lengths_.resize(number_to_store);
-  stored_times_.resize(number_to_store);
-  stored_resend_times_.resize(number_to_store);
-  stored_types_.resize(number_to_store);
+  index_mask_ = size - 1;
+  stored_packets_.resize(size);
 }
 
 void RTPPacketHistory::Free() {
@@ -65,20 +65,12 @@ void RTPPacketHistory::Free() {
     return;
   }
 
-  std::vector<std::vector<uint8_t> >::iterator it;
-  for (it = stored_packets_.begin(); it != stored_packets_.end(); ++it) {   
-    it->clear();
-  }
-
+  // Packets still referenced by the send path are released by their last
+  // user.
   stored_packets_.clear();
-  stored_seq_nums_.clear();
-  stored_lengths_.clear();
-  stored_times_.clear();
-  stored_resend_times_.clear();
-  stored_types_.clear();
 
   store_ = false;
-  prev_index_ = 0;
+  index_mask_ = 0;
   max_packet_length_ = 0;
 }
 
@@ -87,24 +79,6 @@ bool RTPPacketHistory::StorePackets() const {
   return store_;
 }
 
-// private, lock should already be taken
-void RTPPacketHistory::VerifyAndAllocatePacketLength(uint16_t packet_length) {
-  assert(packet_length > 0);
-  if (!store_) {
-    return;
-  }
-
-  if (packet_length <= max_packet_length_) {
-    return;
-  }
-
-  std::vector<std::vector<uint8_t> >::iterator it;
-  for (it = stored_packets_.begin(); it != stored_packets_.end(); ++it) {
-    it->resize(packet_length);
-  }
-  max_packet_length_ = packet_length;
-}
-
 int32_t RTPPacketHistory::PutRTPPacket(const uint8_t* packet,
                                        uint16_t packet_length,
                                        uint16_t max_packet_length,
@@ -122,7 +96,9 @@ int32_t RTPPacketHistory::PutRTPPacket(const uint8_t* packet,
   assert(packet);
   assert(packet_length > 3);
 
-  VerifyAndAllocatePacketLength(max_packet_length);
+  if (max_packet_length > max_packet_length_) {
+    max_packet_length_ = max_packet_length;
+  }
 
   if (packet_length > max_packet_length_) {
     WEBRTC_TRACE(kTraceError, kTraceRtpRtcp, -1,
@@ -131,26 +107,98 @@ int32_t RTPPacketHistory::PutRTPPacket(const uint8_t* packet,
   }
 
   const uint16_t seq_num = (packet[2] << 8) + packet[3];
+  const scoped_refptr<RtpPacketBuffer>& overwritten =
+      stored_packets_[seq_num & index_mask_].packet;
+  // Reuse the buffer of the packet being overwritten unless it is still
+  // referenced by the send path or too small.
+  scoped_refptr<RtpPacketBuffer> buffer;
+  if (overwritten && overwritten->HasOneRef() &&
+      overwritten->capacity() >= max_packet_length_) {
+    buffer = overwritten;
+  } else {
+    buffer = new RtpPacketBuffer(max_packet_length_);
+  }
+  buffer->SetData(packet, packet_length);
+  Store(buffer, capture_time_ms, type);
+  return 0;
+}
 
-  // Store packet
-  std::vector<std::vector<uint8_t> >::iterator it =
-      stored_packets_.begin() + prev_index_;
-  std::copy(packet, packet + packet_length, it->begin());
+int32_t RTPPacketHistory::PutRTPPacket(
+    const scoped_refptr<RtpPacketBuffer>& packet,
+    uint16_t max_packet_length,
+    int64_t capture_time_ms,
+    StorageType type) {
+  if (type == kDontStore) {
+    return 0;
+  }
 
-  stored_seq_nums_[prev_index_] = seq_num;
-  stored_lengths_[prev_index_] = packet_length;
-  stored_times_[prev_index_] =
-      (capture_time_ms > 0) ? capture_time_ms : clock_->TimeInMilliseconds();
-  stored_resend_times_[prev_index_] = 0;  // packet not resent
-  stored_types_[prev_index_] = type;
+  CriticalSectionScoped cs(critsect_);
+  if (!store_) {
+    return 0;
+  }
+
+  assert(packet);
+  assert(packet->length() > 3);
+
+  if (max_packet_length > max_packet_length_) {
+    max_packet_length_ = max_packet_length;
+  }
 
-  ++prev_index_;
-  if (prev_index_ >= stored_seq_nums_.size()) {
-    prev_index_ = 0;
+  if (packet->length() > max_packet_length_) {
+    WEBRTC_TRACE(kTraceError, kTraceRtpRtcp, -1,
+        "Failed to store RTP packet, length: %d", packet->length());
+    return -1;
   }
+
+  Store(packet, capture_time_ms, type);
   return 0;
 }
 
+void RTPPacketHistory::Store(const scoped_refptr<RtpPacketBuffer>& packet,
+                             int64_t capture_time_ms,
+                             StorageType type) {
+  const uint8_t* data = packet->data();
+  const uint16_t seq_num = (data[2] << 8) + data[3];
+  StoredPacket& stored = stored_packets_[seq_num & index_mask_];
+  if (stored.packet != packet) {
+    RecycleLocked(&stored.packet);
+    stored.packet = packet;
+  }
+  stored.sequence_number = seq_num;
+  stored.stored_time_ms =
+      (capture_time_ms > 0) ? capture_time_ms : clock_->TimeInMilliseconds();
+  stored.resend_time_ms = 0;  // packet not resent
+  stored.type = type;
+}
+
+scoped_refptr<RtpPacketBuffer> RTPPacketHistory::AllocatePacket(
+    uint16_t capacity) {
+  CriticalSectionScoped cs(critsect_);
+  while (!free_packets_.empty()) {
+    scoped_refptr<RtpPacketBuffer> packet = free_packets_.back();
+    free_packets_.pop_back();
+    if (packet->capacity() >= capacity) {
+      return packet;
+    }
+  }
+  return new RtpPacketBuffer(capacity);
+}
+
+void RTPPacketHistory::RecyclePacket(scoped_refptr<RtpPacketBuffer>* packet) {
+  CriticalSectionScoped cs(critsect_);
+  RecycleLocked(packet);
+}
+
+void RTPPacketHistory::RecycleLocked(scoped_refptr<RtpPacketBuffer>* packet) {
+  // A few buffers are enough for the packets being built at any one time.
+  const size_t kMaxFreePackets = 4;
+  if (*packet && (*packet)->HasOneRef() &&
+      free_packets_.size() < kMaxFreePackets) {
+    free_packets_.push_back(*packet);
+  }
+  *packet = NULL;
+}
+
 int32_t RTPPacketHistory::ReplaceRTPHeader(const uint8_t* packet,
                                            uint16_t sequence_number,
                                            uint16_t rtp_header_length) {
@@ -168,26 +216,31 @@ int32_t RTPPacketHistory::ReplaceRTPHeader(const uint8_t* packet,
     return -1;
   }
 
-  int32_t index = 0;
-  bool found = FindSeqNum(sequence_number, &index);
-  if (!found) {
+  StoredPacket* stored = FindSeqNum(sequence_number);
+  if (!stored) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
         "No match for getting seqNum %u", sequence_number);
     return -1;
   }
 
-  uint16_t length = stored_lengths_.at(index);
-  if (length == 0 || length > max_packet_length_) {
+  uint16_t length = stored->packet->length();
+  if (length == 0 || rtp_header_length > length) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
         "No match for getting seqNum %u, len %d", sequence_number, length);
     return -1;
   }
-  assert(stored_seq_nums_[index] == sequence_number);
+
+  if (!stored->packet->HasOneRef()) {
+    // The packet is referenced by the send path, which relies on it not
+    // changing. Give the history its own copy to update.
+    scoped_refptr<RtpPacketBuffer> copy(
+        new RtpPacketBuffer(stored->packet->capacity()));
+    copy->SetData(stored->packet->data(), length);
+    stored->packet = copy;
+  }
 
   // Update RTP header.
-  std::vector<std::vector<uint8_t> >::iterator it =
-      stored_packets_.begin() + index;
-  std::copy(packet, packet + rtp_header_length, it->begin());
+  memcpy(stored->packet->data(), packet, rtp_header_length);
   return 0;
 }
 
@@ -196,19 +249,7 @@ bool RTPPacketHistory::HasRTPPacket(uint16_t sequence_number) const {
   if (!store_) {
     return false;
   }
-
-  int32_t index = 0;
-  bool found = FindSeqNum(sequence_number, &index);
-  if (!found) {
-    return false;
-  }
- 
-  uint16_t length = stored_lengths_.at(index);
-  if (length == 0 || length > max_packet_length_) {
-    // Invalid length.
-    return false;
-  }
-  return true;
+  return FindSeqNum(sequence_number) != NULL;
 }
 
 bool RTPPacketHistory::GetRTPPacket(uint16_t sequence_number,
@@ -222,31 +263,24 @@ bool RTPPacketHistory::GetRTPPacket(uint16_t sequence_number,
     return false;
   }
 
-  int32_t index = 0;
-  bool found = FindSeqNum(sequence_number, &index);
-  if (!found) {
+  const StoredPacket* stored = FindSeqNum(sequence_number);
+  if (!stored) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
         "No match for getting seqNum %u", sequence_number);
     return false;
   }
 
-  uint16_t length = stored_lengths_.at(index);
-  if (length == 0 || length > max_packet_length_) {
-    WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
-        "No match for getting seqNum %u, len %d", sequence_number, length);
-    return false;
-  }
-
- if (length > *packet_length) {
+  uint16_t length = stored->packet->length();
+  if (length > *packet_length) {
     WEBRTC_TRACE(kTraceWarning, kTraceRtpRtcp, -1, 
         "Input buffer too short for packet %u", sequence_number);
     return false;
- }
+  }
 
   // Verify elapsed time since last retrieve. 
   int64_t now = clock_->TimeInMilliseconds();
   if (min_elapsed_time_ms > 0 &&
-      ((now - stored_resend_times_.at(index)) < min_elapsed_time_ms)) {
+      ((now - stored->resend_time_ms) < min_elapsed_time_ms)) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1, 
         "Skip getting packet %u, packet recently resent.", sequence_number);
     *packet_length = 0;
@@ -254,12 +288,43 @@ bool RTPPacketHistory::GetRTPPacket(uint16_t sequence_number,
   }
 
   // Get packet.
-  std::vector<std::vector<uint8_t> >::const_iterator it_found_packet =
-      stored_packets_.begin() + index;
-  std::copy(it_found_packet->begin(), it_found_packet->begin() + length, packet);
-  *packet_length = stored_lengths_.at(index);
-  *stored_time_ms = stored_times_.at(index);
-  *type = stored_types_.at(index);
+  memcpy(packet, stored->packet->data(), length);
+  *packet_length = length;
+  *stored_time_ms = stored->stored_time_ms;
+  *type = stored->type;
+  return true;
+}
+
+bool RTPPacketHistory::GetRTPPacket(uint16_t sequence_number,
+                                    uint32_t min_elapsed_time_ms,
+                                    scoped_refptr<RtpPacketBuffer>* packet,
+                                    int64_t* stored_time_ms,
+                                    StorageType* type) const {
+  CriticalSectionScoped cs(critsect_);
+  if (!store_) {
+    return false;
+  }
+
+  const StoredPacket* stored = FindSeqNum(sequence_number);
+  if (!stored) {
+    WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1,
+        "No match for getting seqNum %u", sequence_number);
+    return false;
+  }
+
+  // Verify elapsed time since last retrieve. 
+  int64_t now = clock_->TimeInMilliseconds();
+  if (min_elapsed_time_ms > 0 &&
+      ((now - stored->resend_time_ms) < min_elapsed_time_ms)) {
+    WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, -1, 
+        "Skip getting packet %u, packet recently resent.", sequence_number);
+    *packet = NULL;
+    return true;
+  }
+
+  *packet = stored->packet;
+  *stored_time_ms = stored->stored_time_ms;
+  *type = stored->type;
   return true;
 }
 
@@ -269,48 +334,29 @@ void RTPPacketHistory::UpdateResendTime(uint16_t sequence_number) {
     return;
   }
 
-  int32_t index = 0;
-  bool found = FindSeqNum(sequence_number, &index);
-  if (!found) {
+  StoredPacket* stored = FindSeqNum(sequence_number);
+  if (!stored) {
     WEBRTC_TRACE(kTraceWarning, kTraceRtpRtcp, -1,
         "Failed to update resend time, seq num: %u.", sequence_number);
     return;
   }
-  stored_resend_times_[index] = clock_->TimeInMilliseconds();
+  stored->resend_time_ms = clock_->TimeInMilliseconds();
 }
 
 // private, lock should already be taken
-bool RTPPacketHistory::FindSeqNum(uint16_t sequence_number,
-                                  int32_t* index) const {
-  uint16_t temp_sequence_number = 0;
-  if (prev_index_ > 0) {
-    *index = prev_index_ - 1;
-    temp_sequence_number = stored_seq_nums_[*index];
-  } else {
-    *index = stored_seq_nums_.size() - 1;
-    temp_sequence_number = stored_seq_nums_[*index];  // wrap
-  }
-
-  int32_t idx = (prev_index_ - 1) - (temp_sequence_number - sequence_number);
-  if (idx >= 0 && idx < static_cast<int>(stored_seq_nums_.size())) {
-    *index = idx;
-    temp_sequence_number = stored_seq_nums_[*index];
+RTPPacketHistory::StoredPacket* RTPPacketHistory::FindSeqNum(
+    uint16_t sequence_number) {
+  StoredPacket& stored = stored_packets_[sequence_number & index_mask_];
+  if (!stored.packet || stored.sequence_number != sequence_number ||
+      stored.packet->length() == 0) {
+    return NULL;
   }
+  return &stored;
+}
 
-  if (temp_sequence_number != sequence_number) {
-    // We did not found a match, search all.
-    for (uint16_t m = 0; m < stored_seq_nums_.size(); m++) {
-      if (stored_seq_nums_[m] == sequence_number) {
-        *index = m;
-        temp_sequence_number = stored_seq_nums_[*index];
-        break;
-      }
-    }
-  }
-  if (temp_sequence_number == sequence_number) {
-    // We found a match.
-    return true;
-  }
-  return false;
+// private, lock should already be taken
+const RTPPacketHistory::StoredPacket* RTPPacketHistory::FindSeqNum(
+    uint16_t sequence_number) const {
+  return const_cast<RTPPacketHistory*>(this)->FindSeqNum(sequence_number);
 }
 }  // namespace webrtc
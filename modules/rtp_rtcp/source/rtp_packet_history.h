@@ -17,6 +17,8 @@
 
 #include "webrtc/modules/interface/module_common_types.h"
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_packet_buffer.h"
+#include "webrtc/system_wrappers/interface/scoped_refptr.h"
 #include "webrtc/typedefs.h"
 
 namespace webrtc {
@@ -24,6 +26,11 @@ namespace webrtc {
 class Clock;
 class CriticalSectionWrapper;
 
+// Packets are stored in a ring indexed by the low bits of their sequence
+// number, so a lookup is a single array access. The ring is sized to the
+// smallest power of two holding |number_to_store| packets, which requires the
+// stored packets to have consecutive sequence numbers (as RTPSender assigns
+// them) for all of them to be kept.
 class RTPPacketHistory {
  public:
   RTPPacketHistory(Clock* clock);
@@ -40,6 +47,21 @@ class RTPPacketHistory {
                        int64_t capture_time_ms,
                        StorageType type);
 
+  // Same as PutRTPPacket() above, but stores a reference to |packet| instead
+  // of copying it. The packet must not be modified after this call.
+  int32_t PutRTPPacket(const scoped_refptr<RtpPacketBuffer>& packet,
+                       uint16_t max_packet_length,
+                       int64_t capture_time_ms,
+                       StorageType type);
+
+  // Returns a buffer of at least |capacity| bytes to write a packet to,
+  // reusing a buffer which is no longer referenced when possible.
+  scoped_refptr<RtpPacketBuffer> AllocatePacket(uint16_t capacity);
+
+  // Takes the reference in |packet| and keeps the buffer for
+  // AllocatePacket() if no one else references it.
+  void RecyclePacket(scoped_refptr<RtpPacketBuffer>* packet);
+
   // Replaces the stored RTP packet with matching sequence number with the
   // RTP header of the provided packet.
   // Note: Calling this function assumes that the RTP header length should not
@@ -66,29 +88,57 @@ class RTPPacketHistory {
                     int64_t* stored_time_ms,
                     StorageType* type) const;
 
+  // Same as GetRTPPacket(), but hands out a reference to the stored packet
+  // instead of copying it. |packet| is set to NULL if the packet is found but
+  // |min_elapsed_time_ms| has not elapsed. The referenced packet must not be
+  // modified.
+  bool GetRTPPacket(uint16_t sequence_number,
+                    uint32_t min_elapsed_time_ms,
+                    scoped_refptr<RtpPacketBuffer>* packet,
+                    int64_t* stored_time_ms,
+                    StorageType* type) const;
+
   bool HasRTPPacket(uint16_t sequence_number) const;
 
   void UpdateResendTime(uint16_t sequence_number);
 
  private:
+  struct StoredPacket {
+    StoredPacket()
+        : sequence_number(0),
+          stored_time_ms(0),
+          resend_time_ms(0),
+          type(kDontStore) {}
+
+    scoped_refptr<RtpPacketBuffer> packet;
+    uint16_t sequence_number;
+    int64_t stored_time_ms;
+    int64_t resend_time_ms;
+    StorageType type;
+  };
+
   void Allocate(uint16_t number_to_store);
   void Free();
-  void VerifyAndAllocatePacketLength(uint16_t packet_length);
-  bool FindSeqNum(uint16_t sequence_number, int32_t* index) const;
+  // Stores |packet| in the slot of its sequence number. Must be called with
+  // |critsect_| held.
+  void Store(const scoped_refptr<RtpPacketBuffer>& packet,
+             int64_t capture_time_ms,
+             StorageType type);
+  void RecycleLocked(scoped_refptr<RtpPacketBuffer>* packet);
+  // Returns the slot holding |sequence_number|, or NULL.
+  StoredPacket* FindSeqNum(uint16_t sequence_number);
+  const StoredPacket* FindSeqNum(uint16_t sequence_number) const;
 
  private:
   Clock* clock_;
   CriticalSectionWrapper* critsect_;
   bool store_;
-  uint32_t prev_index_;
   uint16_t max_packet_length_;
+  uint32_t index_mask_;
 
-  std::vector<std::vector<uint8_t> > stored_packets_;
-  std::vector<uint16_t> stored_seq_nums_;
-  std::vector<uint16_t> stored_lengths_;
-  std::vector<int64_t> stored_times_;
-  std::vector<int64_t> stored_resend_times_;
-  std::vector<StorageType> stored_types_;
+  std::vector<StoredPacket> stored_packets_;
+  // Unreferenced buffers kept for AllocatePacket().
+  std::vector<scoped_refptr<RtpPacketBuffer> > free_packets_;
 };
 }  // namespace webrtc
 #endif  // WEBRTC_MODULES_RTP_RTCP_RTP_PACKET_HISTORY_H_
@@ -10,6 +10,8 @@
  * This file includes unit tests for the RTPPacketHistory.
  */
 
+#include <string.h>
+
 #include "testing/gtest/include/gtest/gtest.h"
 
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
@@ -260,4 +262,132 @@ TEST_F(RtpPacketHistoryTest, MinResendTime) {
   EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 101, packet_, &len, &time, &type));
   EXPECT_EQ(0, len);
 }
+
+TEST_F(RtpPacketHistoryTest, GetRtpPacketByReference) {
+  hist_->SetStorePacketsStatus(true, 10);
+  uint16_t len = 0;
+  int64_t capture_time_ms = 1;
+  CreateRtpPacket(kSeqNum, kSsrc, kPayload, kTimestamp, packet_, &len);
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength,
+                                   capture_time_ms, kAllowRetransmission));
+
+  scoped_refptr<RtpPacketBuffer> packet;
+  int64_t time;
+  StorageType type;
+  EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 0, &packet, &time, &type));
+  ASSERT_TRUE(packet.get() != NULL);
+  EXPECT_EQ(len, packet->length());
+  EXPECT_EQ(0, memcmp(packet_, packet->data(), len));
+  EXPECT_EQ(kAllowRetransmission, type);
+  EXPECT_EQ(capture_time_ms, time);
+
+  // The same stored packet is handed out again, nothing is copied.
+  scoped_refptr<RtpPacketBuffer> packet2;
+  EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 0, &packet2, &time, &type));
+  EXPECT_EQ(packet.get(), packet2.get());
+
+  // Recently resent packets are found, but not handed out.
+  hist_->UpdateResendTime(kSeqNum);
+  EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 100, &packet2, &time, &type));
+  EXPECT_TRUE(packet2.get() == NULL);
+}
+
+TEST_F(RtpPacketHistoryTest, ReplaceRtpHeaderDoesNotModifyReferencedPacket) {
+  hist_->SetStorePacketsStatus(true, 10);
+  uint16_t len = 0;
+  CreateRtpPacket(kSeqNum, kSsrc, kPayload, kTimestamp, packet_, &len);
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength, 1,
+                                   kAllowRetransmission));
+  scoped_refptr<RtpPacketBuffer> packet;
+  int64_t time;
+  StorageType type;
+  EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 0, &packet, &time, &type));
+
+  uint16_t modified_len = 0;
+  uint8_t modified_packet[kMaxPacketLength];
+  CreateRtpPacket(kSeqNum, kSsrc + 1, kPayload, kTimestamp, modified_packet,
+                  &modified_len);
+  EXPECT_EQ(0, hist_->ReplaceRTPHeader(modified_packet, kSeqNum,
+                                       modified_len));
+  // The packet referenced before the update is left untouched.
+  EXPECT_EQ(0, memcmp(packet_, packet->data(), len));
+
+  scoped_refptr<RtpPacketBuffer> updated_packet;
+  EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 0, &updated_packet, &time, &type));
+  EXPECT_NE(packet.get(), updated_packet.get());
+  EXPECT_EQ(0, memcmp(modified_packet, updated_packet->data(), modified_len));
+}
+
+TEST_F(RtpPacketHistoryTest, OldPacketsAreOverwritten) {
+  // The history is rounded up to hold 16 packets.
+  hist_->SetStorePacketsStatus(true, 10);
+  for (uint16_t i = 0; i < 16; ++i) {
+    uint16_t len = 0;
+    CreateRtpPacket(kSeqNum + i, kSsrc, kPayload, kTimestamp, packet_, &len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength, 1,
+                                     kAllowRetransmission));
+  }
+  for (uint16_t i = 0; i < 16; ++i) {
+    EXPECT_TRUE(hist_->HasRTPPacket(kSeqNum + i));
+  }
+
+  uint16_t len = 0;
+  CreateRtpPacket(kSeqNum + 16, kSsrc, kPayload, kTimestamp, packet_, &len);
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength, 1,
+                                   kAllowRetransmission));
+  EXPECT_FALSE(hist_->HasRTPPacket(kSeqNum));
+  EXPECT_TRUE(hist_->HasRTPPacket(kSeqNum + 1));
+  EXPECT_TRUE(hist_->HasRTPPacket(kSeqNum + 16));
+}
+
+TEST_F(RtpPacketHistoryTest, SequenceNumberWrapAround) {
+  hist_->SetStorePacketsStatus(true, 10);
+  const uint16_t kFirstSeqNum = 0xfffe;
+  for (uint16_t i = 0; i < 4; ++i) {
+    uint16_t len = 0;
+    CreateRtpPacket(kFirstSeqNum + i, kSsrc, kPayload, kTimestamp, packet_,
+                    &len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength, 1,
+                                     kAllowRetransmission));
+  }
+  EXPECT_TRUE(hist_->HasRTPPacket(0xfffe));
+  EXPECT_TRUE(hist_->HasRTPPacket(0xffff));
+  EXPECT_TRUE(hist_->HasRTPPacket(0));
+  EXPECT_TRUE(hist_->HasRTPPacket(1));
+  EXPECT_FALSE(hist_->HasRTPPacket(2));
+}
+
+TEST_F(RtpPacketHistoryTest, PutRtpPacketByReference) {
+  hist_->SetStorePacketsStatus(true, 10);
+  scoped_refptr<RtpPacketBuffer> packet =
+      hist_->AllocatePacket(kMaxPacketLength);
+  uint16_t len = 0;
+  CreateRtpPacket(kSeqNum, kSsrc, kPayload, kTimestamp, packet->data(), &len);
+  packet->set_length(len);
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet, kMaxPacketLength, 1,
+                                   kAllowRetransmission));
+  const RtpPacketBuffer* stored_buffer = packet.get();
+
+  // The history keeps the buffer, so it isn't recycled.
+  hist_->RecyclePacket(&packet);
+  EXPECT_TRUE(packet.get() == NULL);
+  scoped_refptr<RtpPacketBuffer> stored;
+  int64_t time;
+  StorageType type;
+  EXPECT_TRUE(hist_->GetRTPPacket(kSeqNum, 0, &stored, &time, &type));
+  EXPECT_EQ(stored_buffer, stored.get());
+  stored = NULL;
+
+  // Overwriting the packet frees its buffer for the next packet.
+  packet = hist_->AllocatePacket(kMaxPacketLength);
+  EXPECT_NE(stored_buffer, packet.get());
+  len = 0;
+  CreateRtpPacket(kSeqNum + 16, kSsrc, kPayload, kTimestamp, packet->data(),
+                  &len);
+  packet->set_length(len);
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet, kMaxPacketLength, 1,
+                                   kAllowRetransmission));
+  EXPECT_FALSE(hist_->HasRTPPacket(kSeqNum));
+  EXPECT_EQ(stored_buffer, hist_->AllocatePacket(kMaxPacketLength).get());
+}
 }  // namespace webrtc
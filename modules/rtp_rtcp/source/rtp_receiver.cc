@@ -62,24 +62,14 @@ RTPReceiver::RTPReceiver(const int32_t id,
       use_ssrc_filter_(false),
       ssrc_filter_(0),
 
-      jitter_q4_(0),
-      jitter_max_q4_(0),
-      cumulative_loss_(0),
-      jitter_q4_transmission_time_offset_(0),
-      local_time_last_received_timestamp_(0),
       last_received_frame_time_ms_(0),
       last_received_timestamp_(0),
       last_received_sequence_number_(0),
-      last_received_transmission_time_offset_(0),
-
-      received_seq_first_(0),
-      received_seq_max_(0),
-      received_seq_wraps_(0),
 
-      received_packet_oh_(12),  // RTP header.
-      received_byte_count_(0),
-      received_old_packet_count_(0),
-      received_inorder_packet_count_(0),
+      critical_section_statistics_(
+          CriticalSectionWrapper::CreateCriticalSection()),
+      jitter_max_q4_(0),
+      cumulative_loss_(0),
 
       last_report_inorder_packets_(0),
       last_report_old_packets_(0),
@@ -192,18 +182,21 @@ void RTPReceiver::ProcessDeadOrAlive(const bool rtcp_alive,
 }
 
 uint16_t RTPReceiver::PacketOHReceived() const {
-  CriticalSectionScoped lock(critical_section_rtp_receiver_);
-  return received_packet_oh_;
+  ReceiveStatistician::Counters counters;
+  statistician_.GetCounters(&counters);
+  return counters.packet_oh;
 }
 
 uint32_t RTPReceiver::PacketCountReceived() const {
-  CriticalSectionScoped lock(critical_section_rtp_receiver_);
-  return received_inorder_packet_count_;
+  ReceiveStatistician::Counters counters;
+  statistician_.GetCounters(&counters);
+  return counters.inorder_packet_count;
 }
 
 uint32_t RTPReceiver::ByteCountReceived() const {
-  CriticalSectionScoped lock(critical_section_rtp_receiver_);
-  return received_byte_count_;
+  ReceiveStatistician::Counters counters;
+  statistician_.GetCounters(&counters);
+  return counters.byte_count;
 }
 
 int32_t RTPReceiver::RegisterReceivePayload(
@@ -434,8 +427,11 @@ int32_t RTPReceiver::IncomingRTPPacket(
   bool old_packet = RetransmitOfOldPacket(rtp_header->sequenceNumber,
                                           rtp_header->timestamp);
 
-  // This updates received_seq_max_ and other members.
-  UpdateStatistics(rtp_header, payload_data_length, old_packet);
+  Bitrate::Update(payload_data_length);
+  statistician_.IncomingPacket(
+      *rtp_header, payload_data_length, old_packet,
+      GetCurrentRTP(clock_, rtp_media_receiver_->GetFrequencyHz()),
+      max_reordering_threshold_);
 
   // Need to be updated after RetransmitOfOldPacket and
   // RetransmitOfOldPacketUpdateStatistics.
@@ -448,107 +444,17 @@ int32_t RTPReceiver::IncomingRTPPacket(
       last_received_frame_time_ms_ = clock_->TimeInMilliseconds();
     }
     last_received_sequence_number_ = rtp_header->sequenceNumber;
-    last_received_transmission_time_offset_ =
-      rtp_header->extension.transmissionTimeOffset;
   }
   return ret_val;
 }
 
-// Implementation note: we expect to have the critical_section_rtp_receiver_
-// critsect when we call this.
-void RTPReceiver::UpdateStatistics(const RTPHeader* rtp_header,
-                                   const uint16_t bytes,
-                                   const bool old_packet) {
-  uint32_t frequency_hz = rtp_media_receiver_->GetFrequencyHz();
-
-  Bitrate::Update(bytes);
-
-  received_byte_count_ += bytes;
-
-  if (received_seq_max_ == 0 && received_seq_wraps_ == 0) {
-    // This is the first received report.
-    received_seq_first_ = rtp_header->sequenceNumber;
-    received_seq_max_ = rtp_header->sequenceNumber;
-    received_inorder_packet_count_ = 1;
-    local_time_last_received_timestamp_ =
-      GetCurrentRTP(clock_, frequency_hz);  // Time in samples.
-    return;
-  }
-
-  // Count only the new packets received.
-  if (InOrderPacket(rtp_header->sequenceNumber)) {
-    const uint32_t RTPtime =
-      GetCurrentRTP(clock_, frequency_hz);  // Time in samples.
-    received_inorder_packet_count_++;
-
-    // Wrong if we use RetransmitOfOldPacket.
-    int32_t seq_diff =
-        rtp_header->sequenceNumber - received_seq_max_;
-    if (seq_diff < 0) {
-      // Wrap around detected.
-      received_seq_wraps_++;
-    }
-    // new max
-    received_seq_max_ = rtp_header->sequenceNumber;
-
-    if (rtp_header->timestamp != last_received_timestamp_ &&
-        received_inorder_packet_count_ > 1) {
-      int32_t time_diff_samples =
-          (RTPtime - local_time_last_received_timestamp_) -
-          (rtp_header->timestamp - last_received_timestamp_);
-
-      time_diff_samples = abs(time_diff_samples);
-
-      // lib_jingle sometimes deliver crazy jumps in TS for the same stream.
-      // If this happens, don't update jitter value. Use 5 secs video frequency
-      // as the treshold.
-      if (time_diff_samples < 450000) {
-        // Note we calculate in Q4 to avoid using float.
-        int32_t jitter_diff_q4 = (time_diff_samples << 4) - jitter_q4_;
-        jitter_q4_ += ((jitter_diff_q4 + 8) >> 4);
-      }
-
-      // Extended jitter report, RFC 5450.
-      // Actual network jitter, excluding the source-introduced jitter.
-      int32_t time_diff_samples_ext =
-        (RTPtime - local_time_last_received_timestamp_) -
-        ((rtp_header->timestamp +
-          rtp_header->extension.transmissionTimeOffset) -
-         (last_received_timestamp_ +
-          last_received_transmission_time_offset_));
-
-      time_diff_samples_ext = abs(time_diff_samples_ext);
-
-      if (time_diff_samples_ext < 450000) {
-        int32_t jitter_diffQ4TransmissionTimeOffset =
-          (time_diff_samples_ext << 4) - jitter_q4_transmission_time_offset_;
-        jitter_q4_transmission_time_offset_ +=
-          ((jitter_diffQ4TransmissionTimeOffset + 8) >> 4);
-      }
-    }
-    local_time_last_received_timestamp_ = RTPtime;
-  } else {
-    if (old_packet) {
-      received_old_packet_count_++;
-    } else {
-      received_inorder_packet_count_++;
-    }
-  }
-
-  uint16_t packet_oh =
-      rtp_header->headerLength + rtp_header->paddingLength;
-
-  // Our measured overhead. Filter from RFC 5104 4.2.1.2:
-  // avg_OH (new) = 15/16*avg_OH (old) + 1/16*pckt_OH,
-  received_packet_oh_ = (15 * received_packet_oh_ + packet_oh) >> 4;
-}
-
 // Implementation note: we expect to have the critical_section_rtp_receiver_
 // critsect when we call this.
 bool RTPReceiver::RetransmitOfOldPacket(
     const uint16_t sequence_number,
     const uint32_t rtp_time_stamp) const {
-  if (InOrderPacket(sequence_number)) {
+  if (statistician_.InOrderPacket(sequence_number,
+                                  max_reordering_threshold_)) {
     return false;
   }
 
@@ -566,7 +472,7 @@ bool RTPReceiver::RetransmitOfOldPacket(
   rtp_rtcp_.RTT(ssrc_, NULL, NULL, &min_rtt, NULL);
   if (min_rtt == 0) {
     // Jitter variance in samples.
-    float jitter = jitter_q4_ >> 4;
+    float jitter = statistician_.counters().jitter_q4 >> 4;
 
     // Jitter standard deviation in samples.
     float jitter_std = sqrt(jitter);
@@ -588,16 +494,6 @@ bool RTPReceiver::RetransmitOfOldPacket(
   return false;
 }
 
-bool RTPReceiver::InOrderPacket(const uint16_t sequence_number) const {
-  if (IsNewerSequenceNumber(sequence_number, received_seq_max_)) {
-    return true;
-  } else {
-    // If we have a restart of the remote side this packet is still in order.
-    return !IsNewerSequenceNumber(sequence_number, received_seq_max_ -
-                                  max_reordering_threshold_);
-  }
-}
-
 uint16_t RTPReceiver::SequenceNumber() const {
   CriticalSectionScoped lock(critical_section_rtp_receiver_);
   return last_received_sequence_number_;
@@ -620,14 +516,14 @@ int32_t RTPReceiver::EstimatedRemoteTimeStamp(
   CriticalSectionScoped lock(critical_section_rtp_receiver_);
   uint32_t frequency_hz = rtp_media_receiver_->GetFrequencyHz();
 
-  if (local_time_last_received_timestamp_ == 0) {
+  const uint32_t last_packet_rtp_time = statistician_.last_packet_rtp_time();
+  if (last_packet_rtp_time == 0) {
     WEBRTC_TRACE(kTraceWarning, kTraceRtpRtcp, id_,
                  "%s invalid state", __FUNCTION__);
     return -1;
   }
   // Time in samples.
-  uint32_t diff = GetCurrentRTP(clock_, frequency_hz) -
-                        local_time_last_received_timestamp_;
+  uint32_t diff = GetCurrentRTP(clock_, frequency_hz) - last_packet_rtp_time;
 
   timestamp = last_received_timestamp_ + diff;
   return 0;
@@ -682,7 +578,6 @@ void RTPReceiver::CheckSSRCChanged(const RTPHeader* rtp_header) {
 
       last_received_timestamp_      = 0;
       last_received_sequence_number_ = 0;
-      last_received_transmission_time_offset_ = 0;
       last_received_frame_time_ms_ = 0;
 
       // Do we have a SSRC? Then the stream is restarted.
@@ -924,8 +819,12 @@ void RTPReceiver::CheckCSRC(const WebRtcRTPHeader* rtp_header) {
 }
 
 int32_t RTPReceiver::ResetStatistics() {
-  CriticalSectionScoped lock(critical_section_rtp_receiver_);
-
+  {
+    // The statistician is written on the receive path.
+    CriticalSectionScoped lock(critical_section_rtp_receiver_);
+    statistician_.Reset();
+  }
+  CriticalSectionScoped lock(critical_section_statistics_.get());
   last_report_inorder_packets_ = 0;
   last_report_old_packets_ = 0;
   last_report_seq_max_ = 0;
@@ -934,25 +833,17 @@ int32_t RTPReceiver::ResetStatistics() {
   last_report_extended_high_seq_num_ = 0;
   last_report_jitter_ = 0;
   last_report_jitter_transmission_time_offset_ = 0;
-  jitter_q4_ = 0;
   jitter_max_q4_ = 0;
   cumulative_loss_ = 0;
-  jitter_q4_transmission_time_offset_ = 0;
-  received_seq_wraps_ = 0;
-  received_seq_max_ = 0;
-  received_seq_first_ = 0;
-  received_byte_count_ = 0;
-  received_old_packet_count_ = 0;
-  received_inorder_packet_count_ = 0;
   return 0;
 }
 
 int32_t RTPReceiver::ResetDataCounters() {
-  CriticalSectionScoped lock(critical_section_rtp_receiver_);
-
-  received_byte_count_ = 0;
-  received_old_packet_count_ = 0;
-  received_inorder_packet_count_ = 0;
+  {
+    CriticalSectionScoped lock(critical_section_rtp_receiver_);
+    statistician_.ResetDataCounters();
+  }
+  CriticalSectionScoped lock(critical_section_statistics_.get());
   last_report_inorder_packets_ = 0;
 
   return 0;
@@ -986,12 +877,14 @@ int32_t RTPReceiver::Statistics(
     uint32_t* jitter_transmission_time_offset,
     int32_t*  missing,
     bool reset) const {
-  CriticalSectionScoped lock(critical_section_rtp_receiver_);
-
   if (missing == NULL) {
     return -1;
   }
-  if (received_seq_first_ == 0 && received_byte_count_ == 0) {
+  ReceiveStatistician::Counters counters;
+  statistician_.GetCounters(&counters);
+
+  CriticalSectionScoped lock(critical_section_statistics_.get());
+  if (counters.seq_first == 0 && counters.byte_count == 0) {
     // We have not received anything. -1 required by RTCP sender.
     return -1;
   }
@@ -1026,12 +919,12 @@ int32_t RTPReceiver::Statistics(
 
   if (last_report_inorder_packets_ == 0) {
     // First time we send a report.
-    last_report_seq_max_ = received_seq_first_ - 1;
+    last_report_seq_max_ = counters.seq_first - 1;
   }
   // Calculate fraction lost.
-  uint16_t exp_since_last = (received_seq_max_ - last_report_seq_max_);
+  uint16_t exp_since_last = (counters.seq_max - last_report_seq_max_);
 
-  if (last_report_seq_max_ > received_seq_max_) {
+  if (last_report_seq_max_ > counters.seq_max) {
     // Can we assume that the seq_num can't go decrease over a full RTCP period?
     exp_since_last = 0;
   }
@@ -1039,12 +932,12 @@ int32_t RTPReceiver::Statistics(
   // Number of received RTP packets since last report, counts all packets but
   // not re-transmissions.
   uint32_t rec_since_last =
-      received_inorder_packet_count_ - last_report_inorder_packets_;
+      counters.inorder_packet_count - last_report_inorder_packets_;
 
   if (nack_method_ == kNackOff) {
     // This is needed for re-ordered packets.
     uint32_t old_packets =
-        received_old_packet_count_ - last_report_old_packets_;
+        counters.old_packet_count - last_report_old_packets_;
     rec_since_last += old_packets;
   } else {
     // With NACK we don't know the expected retransmitions during the last
@@ -1074,40 +967,40 @@ int32_t RTPReceiver::Statistics(
   // We need a counter for cumulative loss too.
   cumulative_loss_ += *missing;
 
-  if (jitter_q4_ > jitter_max_q4_) {
-    jitter_max_q4_ = jitter_q4_;
+  if (counters.jitter_q4 > jitter_max_q4_) {
+    jitter_max_q4_ = counters.jitter_q4;
   }
   if (cum_lost) {
     *cum_lost =  cumulative_loss_;
   }
   if (ext_max) {
-    *ext_max = (received_seq_wraps_ << 16) + received_seq_max_;
+    *ext_max = (counters.seq_wraps << 16) + counters.seq_max;
   }
   // Note: internal jitter value is in Q4 and needs to be scaled by 1/16.
   if (jitter) {
-    *jitter = (jitter_q4_ >> 4);
+    *jitter = (counters.jitter_q4 >> 4);
   }
   if (max_jitter) {
     *max_jitter = (jitter_max_q4_ >> 4);
   }
   if (jitter_transmission_time_offset) {
     *jitter_transmission_time_offset =
-      (jitter_q4_transmission_time_offset_ >> 4);
+      (counters.jitter_q4_transmission_time_offset >> 4);
   }
   if (reset) {
     // Store this report.
     last_report_fraction_lost_ = local_fraction_lost;
     last_report_cumulative_lost_ = cumulative_loss_;  // 24 bits valid.
     last_report_extended_high_seq_num_ =
-        (received_seq_wraps_ << 16) + received_seq_max_;
-    last_report_jitter_  = (jitter_q4_ >> 4);
+        (counters.seq_wraps << 16) + counters.seq_max;
+    last_report_jitter_  = (counters.jitter_q4 >> 4);
     last_report_jitter_transmission_time_offset_ =
-      (jitter_q4_transmission_time_offset_ >> 4);
+      (counters.jitter_q4_transmission_time_offset >> 4);
 
     // Only for report blocks in RTCP SR and RR.
-    last_report_inorder_packets_ = received_inorder_packet_count_;
-    last_report_old_packets_ = received_old_packet_count_;
-    last_report_seq_max_ = received_seq_max_;
+    last_report_inorder_packets_ = counters.inorder_packet_count;
+    last_report_old_packets_ = counters.old_packet_count;
+    last_report_seq_max_ = counters.seq_max;
   }
   return 0;
 }
@@ -1115,14 +1008,15 @@ int32_t RTPReceiver::Statistics(
 int32_t RTPReceiver::DataCounters(
     uint32_t* bytes_received,
     uint32_t* packets_received) const {
-  CriticalSectionScoped lock(critical_section_rtp_receiver_);
+  ReceiveStatistician::Counters counters;
+  statistician_.GetCounters(&counters);
 
   if (bytes_received) {
-    *bytes_received = received_byte_count_;
+    *bytes_received = counters.byte_count;
   }
   if (packets_received) {
     *packets_received =
-        received_old_packet_count_ + received_inorder_packet_count_;
+        counters.old_packet_count + counters.inorder_packet_count;
   }
   return 0;
 }
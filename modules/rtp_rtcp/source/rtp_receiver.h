@@ -16,6 +16,7 @@
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp.h"
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
 #include "webrtc/modules/rtp_rtcp/source/bitrate.h"
+#include "webrtc/modules/rtp_rtcp/source/receive_statistician.h"
 #include "webrtc/modules/rtp_rtcp/source/rtcp_receiver_help.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_header_extension.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_payload_registry.h"
@@ -154,16 +155,10 @@ class RTPReceiver : public Bitrate {
   virtual bool RetransmitOfOldPacket(const uint16_t sequence_number,
                                      const uint32_t rtp_time_stamp) const;
 
-  void UpdateStatistics(const RTPHeader* rtp_header,
-                        const uint16_t bytes,
-                        const bool old_packet);
-
  private:
   // Returns whether RED is configured with payload_type.
   bool REDPayloadType(const int8_t payload_type) const;
 
-  bool InOrderPacket(const uint16_t sequence_number) const;
-
   void CheckSSRCChanged(const RTPHeader* rtp_header);
   void CheckCSRC(const WebRtcRTPHeader* rtp_header);
   int32_t CheckPayloadChanged(const RTPHeader* rtp_header,
@@ -198,26 +193,19 @@ class RTPReceiver : public Bitrate {
   bool                      use_ssrc_filter_;
   uint32_t            ssrc_filter_;
 
-  // Stats on received RTP packets.
-  uint32_t            jitter_q4_;
-  mutable uint32_t    jitter_max_q4_;
-  mutable uint32_t    cumulative_loss_;
-  uint32_t            jitter_q4_transmission_time_offset_;
-
-  uint32_t            local_time_last_received_timestamp_;
   int64_t                   last_received_frame_time_ms_;
   uint32_t            last_received_timestamp_;
   uint16_t            last_received_sequence_number_;
-  int32_t             last_received_transmission_time_offset_;
-  uint16_t            received_seq_first_;
-  uint16_t            received_seq_max_;
-  uint16_t            received_seq_wraps_;
-
-  // Current counter values.
-  uint16_t            received_packet_oh_;
-  uint32_t            received_byte_count_;
-  uint32_t            received_old_packet_count_;
-  uint32_t            received_inorder_packet_count_;
+
+  // Stats on received RTP packets. Updated on the receive path with
+  // |critical_section_rtp_receiver_| held and read without it.
+  ReceiveStatistician statistician_;
+
+  // Protects the report state below, so statistics readers don't contend
+  // with the receive path.
+  scoped_ptr<CriticalSectionWrapper> critical_section_statistics_;
+  mutable uint32_t    jitter_max_q4_;
+  mutable uint32_t    cumulative_loss_;
 
   // Counter values when we sent the last report.
   mutable uint32_t    last_report_inorder_packets_;
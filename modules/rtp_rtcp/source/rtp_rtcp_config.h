@@ -18,7 +18,6 @@ enum { kRtpRtcpMaxIdleTimeProcess = 5,
        kRtpRtcpPacketTimeoutProcessTimeMs = 100,
        kRtpRtcpRttProcessTimeMs = 1000 };
 
-enum { NACK_BYTECOUNT_SIZE      = 60};   // size of our NACK history
 // A sanity for the NACK list parsing at the send-side.
 enum { kSendSideNackListSizeSanity = 20000 };
 enum { kDefaultMaxReorderingThreshold = 50 };  // In sequence numbers.
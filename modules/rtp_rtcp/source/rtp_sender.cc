@@ -26,6 +26,11 @@ const int kMaxPaddingLength = 224;
 
 namespace {
 
+// Retransmissions in response to NACKs are limited to the target send bitrate
+// over this window.
+const int kNackRateWindowMs = 1000;
+const int kNackRateBucketMs = 10;
+
 const char* FrameTypeToString(const FrameType frame_type) {
   switch (frame_type) {
     case kFrameEmpty: return "empty";
@@ -53,7 +58,8 @@ RTPSender::RTPSender(const int32_t id, const bool audio, Clock *clock,
       payload_type_map_(), rtp_header_extension_map_(),
       transmission_time_offset_(0), absolute_send_time_(0),
       // NACK.
-      nack_byte_count_times_(), nack_byte_count_(), nack_bitrate_(clock),
+      nack_byte_count_(kNackRateWindowMs, kNackRateBucketMs),
+      nack_bitrate_(clock),
       packet_history_(new RTPPacketHistory(clock)),
       // Statistics
       packets_sent_(0), payload_bytes_sent_(0), start_time_stamp_forced_(false),
@@ -61,8 +67,6 @@ RTPSender::RTPSender(const int32_t id, const bool audio, Clock *clock,
       remote_ssrc_(0), sequence_number_forced_(false), ssrc_forced_(false),
       timestamp_(0), num_csrcs_(0), csrcs_(), include_csrcs_(true),
       rtx_(kRtxOff), payload_type_rtx_(-1) {
-  memset(nack_byte_count_times_, 0, sizeof(nack_byte_count_times_));
-  memset(nack_byte_count_, 0, sizeof(nack_byte_count_));
   memset(csrcs_, 0, sizeof(csrcs_));
   // We need to seed the random generator.
   srand(static_cast<uint32_t>(clock_->TimeInMilliseconds()));
@@ -503,29 +507,31 @@ bool RTPSender::StorePackets() const {
 }
 
 int32_t RTPSender::ReSendPacket(uint16_t packet_id, uint32_t min_resend_time) {
-  uint16_t length = IP_PACKET_SIZE;
-  uint8_t data_buffer[IP_PACKET_SIZE];
-  uint8_t *buffer_to_send_ptr = data_buffer;
+  scoped_refptr<RtpPacketBuffer> packet;
   int64_t capture_time_ms;
   StorageType type;
-  if (!packet_history_->GetRTPPacket(packet_id, min_resend_time, data_buffer,
-                                     &length, &capture_time_ms, &type)) {
+  if (!packet_history_->GetRTPPacket(packet_id, min_resend_time, &packet,
+                                     &capture_time_ms, &type)) {
     // Packet not found.
     return 0;
   }
-  if (length == 0 || type == kDontRetransmit) {
-    // No bytes copied (packet recently resent, skip resending) or
-    // packet should not be retransmitted.
+  if (!packet || type == kDontRetransmit) {
+    // Packet recently resent, skip resending, or packet should not be
+    // retransmitted.
     return 0;
   }
+  // The stored packet is sent as is, without copying it out of the history.
+  const uint8_t* buffer_to_send_ptr = packet->data();
+  uint16_t length = packet->length();
 
   uint8_t data_buffer_rtx[IP_PACKET_SIZE];
   if (rtx_ != kRtxOff) {
-    BuildRtxPacket(data_buffer, &length, data_buffer_rtx);
+    BuildRtxPacket(packet->data(), &length, data_buffer_rtx);
     buffer_to_send_ptr = data_buffer_rtx;
   }
 
-  ModuleRTPUtility::RTPHeaderParser rtp_parser(data_buffer, length);
+  ModuleRTPUtility::RTPHeaderParser rtp_parser(packet->data(),
+                                               packet->length());
   RTPHeader header;
   rtp_parser.Parse(header);
 
@@ -640,98 +646,74 @@ void RTPSender::OnReceivedNACK(
   }
 }
 
-bool RTPSender::ProcessNACKBitRate(const uint32_t now) {
-  uint32_t num = 0;
-  int32_t byte_count = 0;
-  const uint32_t avg_interval = 1000;
-
+bool RTPSender::ProcessNACKBitRate(const int64_t now) {
   CriticalSectionScoped cs(send_critsect_);
 
   if (target_send_bitrate_ == 0) {
     return true;
   }
-  for (num = 0; num < NACK_BYTECOUNT_SIZE; ++num) {
-    if ((now - nack_byte_count_times_[num]) > avg_interval) {
-      // Don't use data older than 1sec.
-      break;
-    } else {
-      byte_count += nack_byte_count_[num];
-    }
-  }
-  int32_t time_interval = avg_interval;
-  if (num == NACK_BYTECOUNT_SIZE) {
-    // More than NACK_BYTECOUNT_SIZE nack messages has been received
-    // during the last msg_interval.
-    time_interval = now - nack_byte_count_times_[num - 1];
-    if (time_interval < 0) {
-      time_interval = avg_interval;
-    }
-  }
-  return (byte_count * 8) < (target_send_bitrate_ * time_interval);
+  // Don't use data older than 1 sec. kbit/s * ms = bits.
+  const uint32_t bits = 8 * nack_byte_count_.Count(kNackRateWindowMs, now);
+  return bits < static_cast<uint32_t>(target_send_bitrate_) *
+      kNackRateWindowMs;
 }
 
 void RTPSender::UpdateNACKBitRate(const uint32_t bytes,
-                                  const uint32_t now) {
+                                  const int64_t now) {
   CriticalSectionScoped cs(send_critsect_);
-
-  // Save bitrate statistics.
-  if (bytes > 0) {
-    if (now == 0) {
-      // Add padding length.
-      nack_byte_count_[0] += bytes;
-    } else {
-      if (nack_byte_count_times_[0] == 0) {
-        // First no shift.
-      } else {
-        // Shift.
-        for (int i = (NACK_BYTECOUNT_SIZE - 2); i >= 0; i--) {
-          nack_byte_count_[i + 1] = nack_byte_count_[i];
-          nack_byte_count_times_[i + 1] = nack_byte_count_times_[i];
-        }
-      }
-      nack_byte_count_[0] = bytes;
-      nack_byte_count_times_[0] = now;
-    }
-  }
+  nack_byte_count_.Update(bytes, now);
 }
 
 // Called from pacer when we can send the packet.
 void RTPSender::TimeToSendPacket(uint16_t sequence_number,
                                  int64_t capture_time_ms) {
   StorageType type;
-  uint16_t length = IP_PACKET_SIZE;
-  uint8_t data_buffer[IP_PACKET_SIZE];
   int64_t stored_time_ms;
+  scoped_refptr<RtpPacketBuffer> packet;
 
   if (packet_history_ == NULL) {
     return;
   }
-  if (!packet_history_->GetRTPPacket(sequence_number, 0, data_buffer, &length,
+  if (!packet_history_->GetRTPPacket(sequence_number, 0, &packet,
                                      &stored_time_ms, &type)) {
     return;
   }
-  assert(length > 0);
+  assert(packet && packet->length() > 0);
 
-  ModuleRTPUtility::RTPHeaderParser rtp_parser(data_buffer, length);
+  ModuleRTPUtility::RTPHeaderParser rtp_parser(packet->data(),
+                                               packet->length());
   RTPHeader rtp_header;
   rtp_parser.Parse(rtp_header);
   TRACE_EVENT_INSTANT2("webrtc_rtp", "RTPSender::TimeToSendPacket",
                        "timestamp", rtp_header.timestamp,
                        "seqnum", sequence_number);
 
+  // Only the header is copied and updated. The stored packet may be
+  // referenced by a concurrent retransmission and must not change under it.
+  uint8_t header_buffer[IP_PACKET_SIZE];
+  const uint16_t header_length = rtp_header.headerLength;
+  memcpy(header_buffer, packet->data(), header_length);
+
   int64_t now_ms = clock_->TimeInMilliseconds();
   int64_t diff_ms = now_ms - capture_time_ms;
-  bool updated_transmission_time_offset =
-      UpdateTransmissionTimeOffset(data_buffer, length, rtp_header, diff_ms);
+  bool updated_transmission_time_offset = UpdateTransmissionTimeOffset(
+      header_buffer, header_length, rtp_header, diff_ms);
   bool updated_abs_send_time =
-      UpdateAbsoluteSendTime(data_buffer, length, rtp_header, now_ms);
+      UpdateAbsoluteSendTime(header_buffer, header_length, rtp_header, now_ms);
   if (updated_transmission_time_offset || updated_abs_send_time) {
     // Update stored packet in case of receiving a re-transmission request.
-    packet_history_->ReplaceRTPHeader(data_buffer,
+    // Our reference is dropped first so that the history can update the
+    // packet in place.
+    packet = NULL;
+    packet_history_->ReplaceRTPHeader(header_buffer,
                                       rtp_header.sequenceNumber,
-                                      rtp_header.headerLength);
+                                      header_length);
+    if (!packet_history_->GetRTPPacket(sequence_number, 0, &packet,
+                                       &stored_time_ms, &type)) {
+      return;
+    }
   }
-  SendPacketToNetwork(data_buffer, length);
+  SendPacketToNetwork(packet->data(), packet->length());
 }
 
 int RTPSender::TimeToSendPadding(int bytes) {
@@ -752,10 +734,50 @@ int32_t RTPSender::SendToNetwork(
     uint8_t *buffer, int payload_length, int rtp_header_length,
     int64_t capture_time_ms, StorageType storage,
     PacedSender::Priority priority) {
-  ModuleRTPUtility::RTPHeaderParser rtp_parser(
-      buffer, payload_length + rtp_header_length);
   RTPHeader rtp_header;
-  rtp_parser.Parse(rtp_header);
+  PrepareToSend(buffer, payload_length + rtp_header_length, capture_time_ms,
+                &rtp_header);
+
+  // Used for NACK and to spread out the transmission of packets.
+  if (packet_history_->PutRTPPacket(buffer, rtp_header_length + payload_length,
+                                    max_payload_length_, capture_time_ms,
+                                    storage) != 0) {
+    return -1;
+  }
+  return SendStoredPacket(buffer, payload_length, rtp_header_length,
+                          capture_time_ms, storage, priority, rtp_header);
+}
+
+scoped_refptr<RtpPacketBuffer> RTPSender::AllocatePacket() {
+  return packet_history_->AllocatePacket(IP_PACKET_SIZE);
+}
+
+int32_t RTPSender::SendToNetwork(
+    scoped_refptr<RtpPacketBuffer>* packet, int payload_length,
+    int rtp_header_length, int64_t capture_time_ms, StorageType storage,
+    PacedSender::Priority priority) {
+  (*packet)->set_length(payload_length + rtp_header_length);
+  RTPHeader rtp_header;
+  PrepareToSend((*packet)->data(), (*packet)->length(), capture_time_ms,
+                &rtp_header);
+
+  int32_t ret = -1;
+  if (packet_history_->PutRTPPacket(*packet, max_payload_length_,
+                                    capture_time_ms, storage) == 0) {
+    ret = SendStoredPacket((*packet)->data(), payload_length,
+                           rtp_header_length, capture_time_ms, storage,
+                           priority, rtp_header);
+  }
+  // The buffer is reused for the next packet unless the history kept it.
+  packet_history_->RecyclePacket(packet);
+  return ret;
+}
+
+void RTPSender::PrepareToSend(uint8_t* buffer, uint16_t length,
+                              int64_t capture_time_ms,
+                              RTPHeader* rtp_header) {
+  ModuleRTPUtility::RTPHeaderParser rtp_parser(buffer, length);
+  rtp_parser.Parse(*rtp_header);
 
   int64_t now_ms = clock_->TimeInMilliseconds();
 
@@ -763,20 +785,19 @@ int32_t RTPSender::SendToNetwork(
   // TODO(holmer): This should be changed all over Video Engine so that negative
   // time is consider invalid, while 0 is considered a valid time.
   if (capture_time_ms > 0) {
-    UpdateTransmissionTimeOffset(buffer, payload_length + rtp_header_length,
-                                 rtp_header, now_ms - capture_time_ms);
+    UpdateTransmissionTimeOffset(buffer, length, *rtp_header,
+                                 now_ms - capture_time_ms);
   }
 
-  UpdateAbsoluteSendTime(buffer, payload_length + rtp_header_length,
-                         rtp_header, now_ms);
-
-  // Used for NACK and to spread out the transmission of packets.
-  if (packet_history_->PutRTPPacket(buffer, rtp_header_length + payload_length,
-                                    max_payload_length_, capture_time_ms,
-                                    storage) != 0) {
-    return -1;
-  }
+  UpdateAbsoluteSendTime(buffer, length, *rtp_header, now_ms);
+}
 
+int32_t RTPSender::SendStoredPacket(const uint8_t* buffer, int payload_length,
+                                    int rtp_header_length,
+                                    int64_t capture_time_ms,
+                                    StorageType storage,
+                                    PacedSender::Priority priority,
+                                    const RTPHeader& rtp_header) {
   // Create and send RTX Packet.
   // TODO(pwesin): This should be moved to its own code path triggered by pacer.
   bool rtx_sent = false;
@@ -919,65 +940,14 @@ int32_t RTPSender::BuildRTPheader(
 }
 
 uint16_t RTPSender::BuildRTPHeaderExtension(uint8_t* data_buffer) const {
-  if (rtp_header_extension_map_.Size() <= 0) {
-    return 0;
-  }
-  // RTP header extension, RFC 3550.
-  //   0                   1                   2                   3
-  //   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
-  //  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-  //  |      defined by profile       |           length              |
-  //  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-  //  |                        header extension                       |
-  //  |                             ....                              |
-  //
-  const uint32_t kPosLength = 2;
-  const uint32_t kHeaderLength = kRtpOneByteHeaderLength;
-
-  // Add extension ID (0xBEDE).
-  ModuleRTPUtility::AssignUWord16ToBuffer(data_buffer,
-                                          kRtpOneByteHeaderExtensionId);
-
-  // Add extensions.
-  uint16_t total_block_length = 0;
-
-  RTPExtensionType type = rtp_header_extension_map_.First();
-  while (type != kRtpExtensionNone) {
-    uint8_t block_length = 0;
-    switch (type) {
-      case kRtpExtensionTransmissionTimeOffset:
-        block_length = BuildTransmissionTimeOffsetExtension(
-            data_buffer + kHeaderLength + total_block_length);
-        break;
-      case kRtpExtensionAudioLevel:
-        // Because AudioLevel is handled specially by RTPSenderAudio, we pretend
-        // we don't have to care about it here, which is true until we wan't to
-        // use it together with any of the other extensions we support.
-        break;
-      case kRtpExtensionAbsoluteSendTime:
-        block_length = BuildAbsoluteSendTimeExtension(
-            data_buffer + kHeaderLength + total_block_length);
-        break;
-      default:
-        assert(false);
-    }
-    total_block_length += block_length;
-    type = rtp_header_extension_map_.Next(type);
-  }
-  if (total_block_length == 0) {
+  // The layout of the block is computed when the extensions are registered;
+  // only the values are written per packet.
+  const uint16_t length =
+      rtp_header_extension_map_.WriteExtensionBlock(data_buffer);
+  if (length == 0) {
     // No extension added.
     return 0;
   }
-  // Set header length (in number of Word32, header excluded).
-  assert(total_block_length % 4 == 0);
-  ModuleRTPUtility::AssignUWord16ToBuffer(data_buffer + kPosLength,
-                                          total_block_length / 4);
-  // Total added length.
-  return kHeaderLength + total_block_length;
-}
-
-uint8_t RTPSender::BuildTransmissionTimeOffsetExtension(
-    uint8_t* data_buffer) const {
   // From RFC 5450: Transmission Time Offsets in RTP Streams.
   //
   // The transmission time is signaled to the receiver in-band using the
@@ -987,33 +957,17 @@ uint8_t RTPSender::BuildTransmissionTimeOffsetExtension(
   // "effective" RTP transmission time of the packet, on the RTP
   // timescale.
   //
-  // The form of the transmission offset extension block:
-  //
   //    0                   1                   2                   3
   //    0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
   //   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   //   |  ID   | len=2 |              transmission offset              |
   //   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-
-  // Get id defined by user.
-  uint8_t id;
-  if (rtp_header_extension_map_.GetId(kRtpExtensionTransmissionTimeOffset,
-                                      &id) != 0) {
-    // Not registered.
-    return 0;
+  int32_t offset = rtp_header_extension_map_.GetDataOffset(
+      kRtpExtensionTransmissionTimeOffset);
+  if (offset >= 0) {
+    ModuleRTPUtility::AssignUWord24ToBuffer(data_buffer + offset,
+                                            transmission_time_offset_);
   }
-  size_t pos = 0;
-  const uint8_t len = 2;
-  data_buffer[pos++] = (id << 4) + len;
-  ModuleRTPUtility::AssignUWord24ToBuffer(data_buffer + pos,
-                                          transmission_time_offset_);
-  pos += 3;
-  assert(pos == kTransmissionTimeOffsetLength);
-  return kTransmissionTimeOffsetLength;
-}
-
-uint8_t RTPSender::BuildAbsoluteSendTimeExtension(
-    uint8_t* data_buffer) const {
   // Absolute send time in RTP streams.
   //
   // The absolute send time is signaled to the receiver in-band using the
@@ -1022,78 +976,71 @@ uint8_t RTPSender::BuildAbsoluteSendTimeExtension(
   // containing the sender's current time in seconds as a fixed point number
   // with 18 bits fractional part.
   //
-  // The form of the absolute send time extension block:
-  //
   //    0                   1                   2                   3
   //    0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
   //   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   //   |  ID   | len=2 |              absolute send time               |
   //   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-
-  // Get id defined by user.
-  uint8_t id;
-  if (rtp_header_extension_map_.GetId(kRtpExtensionAbsoluteSendTime,
-                                      &id) != 0) {
-    // Not registered.
-    return 0;
+  offset = rtp_header_extension_map_.GetDataOffset(
+      kRtpExtensionAbsoluteSendTime);
+  if (offset >= 0) {
+    ModuleRTPUtility::AssignUWord24ToBuffer(data_buffer + offset,
+                                            absolute_send_time_);
   }
-  size_t pos = 0;
-  const uint8_t len = 2;
-  data_buffer[pos++] = (id << 4) + len;
-  ModuleRTPUtility::AssignUWord24ToBuffer(data_buffer + pos,
-                                          absolute_send_time_);
-  pos += 3;
-  assert(pos == kAbsoluteSendTimeLength);
-  return kAbsoluteSendTimeLength;
+  return length;
 }
 
-bool RTPSender::UpdateTransmissionTimeOffset(
-    uint8_t *rtp_packet, const uint16_t rtp_packet_length,
-    const RTPHeader &rtp_header, const int64_t time_diff_ms) const {
-  CriticalSectionScoped cs(send_critsect_);
-
-  // Get length until start of header extension block.
-  int extension_block_pos =
-      rtp_header_extension_map_.GetLengthUntilBlockStartInBytes(
-          kRtpExtensionTransmissionTimeOffset);
-  if (extension_block_pos < 0) {
+int RTPSender::FindExtensionData(const RTPExtensionType type,
+                                 const uint8_t* rtp_packet,
+                                 const uint16_t rtp_packet_length,
+                                 const RTPHeader& rtp_header) const {
+  const int data_offset = rtp_header_extension_map_.GetDataOffset(type);
+  if (data_offset < 0) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, id_,
-                 "Failed to update transmission time offset, not registered.");
-    return false;
+                 "Failed to update extension %d, not registered.", type);
+    return -1;
   }
-  int block_pos = 12 + rtp_header.numCSRCs + extension_block_pos;
-  if (rtp_packet_length < block_pos + kTransmissionTimeOffsetLength ||
-      rtp_header.headerLength <
-          block_pos + kTransmissionTimeOffsetLength) {
+  const int extension_pos = 12 + 4 * rtp_header.numCSRCs;
+  const int data_length = GetRtpExtensionInfo(type)->data_length;
+  const int data_pos = extension_pos + data_offset;
+  if (rtp_packet_length < data_pos + data_length ||
+      rtp_header.headerLength < data_pos + data_length) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, id_,
-                 "Failed to update transmission time offset, invalid length.");
-    return false;
+                 "Failed to update extension %d, invalid length.", type);
+    return -1;
   }
   // Verify that header contains extension.
-  if (!((rtp_packet[12 + rtp_header.numCSRCs] == 0xBE) &&
-        (rtp_packet[12 + rtp_header.numCSRCs + 1] == 0xDE))) {
-    WEBRTC_TRACE(
-        kTraceStream, kTraceRtpRtcp, id_,
-        "Failed to update transmission time offset, hdr extension not found.");
-    return false;
+  if (!((rtp_packet[extension_pos] == 0xBE) &&
+        (rtp_packet[extension_pos + 1] == 0xDE))) {
+    WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, id_,
+                 "Failed to update extension %d, hdr extension not found.",
+                 type);
+    return -1;
   }
-  // Get id.
+  // Verify the ID/len byte, i.e. that the packet was built with the current
+  // registrations.
   uint8_t id = 0;
-  if (rtp_header_extension_map_.GetId(kRtpExtensionTransmissionTimeOffset,
-                                      &id) != 0) {
+  rtp_header_extension_map_.GetId(type, &id);
+  const uint8_t first_block_byte = (id << 4) + data_length - 1;
+  if (rtp_packet[data_pos - 1] != first_block_byte) {
     WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, id_,
-                 "Failed to update transmission time offset, no id.");
-    return false;
+                 "Failed to update extension %d.", type);
+    return -1;
   }
-  // Verify first byte in block.
-  const uint8_t first_block_byte = (id << 4) + 2;
-  if (rtp_packet[block_pos] != first_block_byte) {
-    WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, id_,
-                 "Failed to update transmission time offset.");
+  return data_pos;
+}
+
+bool RTPSender::UpdateTransmissionTimeOffset(
+    uint8_t *rtp_packet, const uint16_t rtp_packet_length,
+    const RTPHeader &rtp_header, const int64_t time_diff_ms) const {
+  CriticalSectionScoped cs(send_critsect_);
+  const int pos = FindExtensionData(kRtpExtensionTransmissionTimeOffset,
+                                    rtp_packet, rtp_packet_length, rtp_header);
+  if (pos < 0) {
     return false;
   }
   // Update transmission offset field (converting to a 90 kHz timestamp).
-  ModuleRTPUtility::AssignUWord24ToBuffer(rtp_packet + block_pos + 1,
+  ModuleRTPUtility::AssignUWord24ToBuffer(rtp_packet + pos,
                                           time_diff_ms * 90);  // RTP timestamp.
   return true;
 }
@@ -1102,49 +1049,14 @@ bool RTPSender::UpdateAbsoluteSendTime(
     uint8_t *rtp_packet, const uint16_t rtp_packet_length,
     const RTPHeader &rtp_header, const int64_t now_ms) const {
   CriticalSectionScoped cs(send_critsect_);
-
-  // Get length until start of header extension block.
-  int extension_block_pos =
-      rtp_header_extension_map_.GetLengthUntilBlockStartInBytes(
-          kRtpExtensionAbsoluteSendTime);
-  if (extension_block_pos < 0) {
-    WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, id_,
-                 "Failed to update absolute send time, not registered.");
-    return false;
-  }
-  int block_pos = 12 + rtp_header.numCSRCs + extension_block_pos;
-  if (rtp_packet_length < block_pos + kAbsoluteSendTimeLength ||
-      rtp_header.headerLength < block_pos + kAbsoluteSendTimeLength) {
-    WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, id_,
-                 "Failed to update absolute send time, invalid length.");
-    return false;
-  }
-  // Verify that header contains extension.
-  if (!((rtp_packet[12 + rtp_header.numCSRCs] == 0xBE) &&
-        (rtp_packet[12 + rtp_header.numCSRCs + 1] == 0xDE))) {
-    WEBRTC_TRACE(
-        kTraceStream, kTraceRtpRtcp, id_,
-        "Failed to update absolute send time, hdr extension not found.");
-    return false;
-  }
-  // Get id.
-  uint8_t id = 0;
-  if (rtp_header_extension_map_.GetId(kRtpExtensionAbsoluteSendTime,
-                                      &id) != 0) {
-    WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, id_,
-                 "Failed to update absolute send time, no id.");
-    return false;
-  }
-  // Verify first byte in block.
-  const uint8_t first_block_byte = (id << 4) + 2;
-  if (rtp_packet[block_pos] != first_block_byte) {
-    WEBRTC_TRACE(kTraceStream, kTraceRtpRtcp, id_,
-                 "Failed to update absolute send time.");
+  const int pos = FindExtensionData(kRtpExtensionAbsoluteSendTime,
+                                    rtp_packet, rtp_packet_length, rtp_header);
+  if (pos < 0) {
     return false;
   }
   // Update absolute send time field (convert ms to 24-bit unsigned with 18 bit
   // fractional part).
-  ModuleRTPUtility::AssignUWord24ToBuffer(rtp_packet + block_pos + 1,
+  ModuleRTPUtility::AssignUWord24ToBuffer(rtp_packet + pos,
                                           ((now_ms << 18) / 1000) & 0x00ffffff);
   return true;
 }
@@ -1402,13 +1314,13 @@ int32_t RTPSender::SetFecParameters(
   return video_->SetFecParameters(delta_params, key_params);
 }
 
-void RTPSender::BuildRtxPacket(uint8_t* buffer, uint16_t* length,
+void RTPSender::BuildRtxPacket(const uint8_t* buffer, uint16_t* length,
                                uint8_t* buffer_rtx) {
   CriticalSectionScoped cs(send_critsect_);
   uint8_t* data_buffer_rtx = buffer_rtx;
   // Add RTX header.
   ModuleRTPUtility::RTPHeaderParser rtp_parser(
-      reinterpret_cast<const uint8_t *>(buffer), *length);
+      buffer, *length);
 
   RTPHeader rtp_header;
   rtp_parser.Parse(rtp_header);
@@ -20,9 +20,12 @@
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
 #include "webrtc/modules/rtp_rtcp/source/bitrate.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_header_extension.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_packet_buffer.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_rtcp_config.h"
 #include "webrtc/modules/rtp_rtcp/source/ssrc_database.h"
 #include "webrtc/modules/rtp_rtcp/source/video_codec_information.h"
+#include "webrtc/system_wrappers/interface/rate_counter.h"
+#include "webrtc/system_wrappers/interface/scoped_refptr.h"
 
 #define MAX_INIT_RTP_SEQ_NUMBER 32767  // 2^15 -1.
 
@@ -59,6 +62,17 @@ class RTPSenderInterface {
       uint8_t *data_buffer, int payload_length, int rtp_header_length,
       int64_t capture_time_ms, StorageType storage,
       PacedSender::Priority priority) = 0;
+
+  // Returns a buffer to write a packet of up to IP_PACKET_SIZE bytes to.
+  virtual scoped_refptr<RtpPacketBuffer> AllocatePacket() = 0;
+
+  // Same as SendToNetwork() above for a packet written to a buffer from
+  // AllocatePacket(). The buffer is stored in the packet history by reference
+  // instead of being copied. Takes the reference in |packet|.
+  virtual int32_t SendToNetwork(
+      scoped_refptr<RtpPacketBuffer>* packet, int payload_length,
+      int rtp_header_length, int64_t capture_time_ms, StorageType storage,
+      PacedSender::Priority priority) = 0;
 };
 
 class RTPSender : public Bitrate, public RTPSenderInterface {
@@ -149,11 +163,6 @@ class RTPSender : public Bitrate, public RTPSenderInterface {
 
   uint16_t BuildRTPHeaderExtension(uint8_t* data_buffer) const;
 
-  uint8_t BuildTransmissionTimeOffsetExtension(
-      uint8_t *data_buffer) const;
-  uint8_t BuildAbsoluteSendTimeExtension(
-      uint8_t* data_buffer) const;
-
   bool UpdateTransmissionTimeOffset(uint8_t *rtp_packet,
                                     const uint16_t rtp_packet_length,
                                     const RTPHeader &rtp_header,
@@ -179,7 +188,7 @@ class RTPSender : public Bitrate, public RTPSenderInterface {
 
   int32_t ReSendPacket(uint16_t packet_id, uint32_t min_resend_time = 0);
 
-  bool ProcessNACKBitRate(const uint32_t now);
+  bool ProcessNACKBitRate(const int64_t now);
 
   // RTX.
   void SetRTXStatus(RtxMode mode, bool set_ssrc, uint32_t ssrc);
@@ -209,6 +218,13 @@ class RTPSender : public Bitrate, public RTPSenderInterface {
       int64_t capture_time_ms, StorageType storage,
       PacedSender::Priority priority);
 
+  virtual scoped_refptr<RtpPacketBuffer> AllocatePacket();
+
+  virtual int32_t SendToNetwork(
+      scoped_refptr<RtpPacketBuffer>* packet, int payload_length,
+      int rtp_header_length, int64_t capture_time_ms, StorageType storage,
+      PacedSender::Priority priority);
+
   // Audio.
 
   // Send a DTMF tone using RFC 2833 (4733).
@@ -268,17 +284,36 @@ class RTPSender : public Bitrate, public RTPSenderInterface {
                       uint32_t timestamp, uint16_t sequence_number,
                       const uint32_t* csrcs, uint8_t csrcs_length) const;
 
-  void UpdateNACKBitRate(const uint32_t bytes, const uint32_t now);
+  void UpdateNACKBitRate(const uint32_t bytes, const int64_t now);
 
   bool SendPaddingAccordingToBitrate(int8_t payload_type,
                                      uint32_t capture_timestamp,
                                      int64_t capture_time_ms);
 
-  void BuildRtxPacket(uint8_t* buffer, uint16_t* length,
+  void BuildRtxPacket(const uint8_t* buffer, uint16_t* length,
                       uint8_t* buffer_rtx);
 
   bool SendPacketToNetwork(const uint8_t *packet, uint32_t size);
 
+  // Updates the send time extensions of the packet in |buffer| and parses its
+  // header to |rtp_header|.
+  void PrepareToSend(uint8_t* buffer, uint16_t length,
+                     int64_t capture_time_ms, RTPHeader* rtp_header);
+  // Sends a packet prepared by PrepareToSend() and already handed to the
+  // packet history, or queues it in the pacer.
+  int32_t SendStoredPacket(const uint8_t* buffer, int payload_length,
+                           int rtp_header_length, int64_t capture_time_ms,
+                           StorageType storage,
+                           PacedSender::Priority priority,
+                           const RTPHeader& rtp_header);
+
+  // Returns the position of the data of extension |type| in |rtp_packet|, or
+  // -1 if the packet doesn't have it where the registrations put it.
+  int FindExtensionData(const RTPExtensionType type,
+                        const uint8_t* rtp_packet,
+                        const uint16_t rtp_packet_length,
+                        const RTPHeader& rtp_header) const;
+
   int32_t id_;
   const bool audio_configured_;
   RTPSenderAudio *audio_;
@@ -302,8 +337,7 @@ class RTPSender : public Bitrate, public RTPSenderInterface {
   uint32_t absolute_send_time_;
 
   // NACK
-  uint32_t nack_byte_count_times_[NACK_BYTECOUNT_SIZE];
-  int32_t nack_byte_count_[NACK_BYTECOUNT_SIZE];
+  RateCounter nack_byte_count_;
   Bitrate nack_bitrate_;
 
   RTPPacketHistory *packet_history_;
@@ -12,6 +12,8 @@
  * This file includes unit tests for the RTPSender.
  */
 
+#include <stdio.h>
+
 #include "testing/gtest/include/gtest/gtest.h"
 
 #include "webrtc/modules/pacing/include/mock/mock_paced_sender.h"
@@ -21,6 +23,7 @@
 #include "webrtc/modules/rtp_rtcp/source/rtp_sender.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/typedefs.h"
 
 namespace webrtc {
@@ -45,10 +48,12 @@ class LoopbackTransportTest : public webrtc::Transport {
  public:
   LoopbackTransportTest()
     : packets_sent_(0),
-      last_sent_packet_len_(0) {
+      last_sent_packet_len_(0),
+      last_sent_data_(NULL) {
   }
   virtual int SendPacket(int channel, const void *data, int len) {
     packets_sent_++;
+    last_sent_data_ = data;
     memcpy(last_sent_packet_, data, len);
     last_sent_packet_len_ = len;
     return len;
@@ -59,6 +64,8 @@ class LoopbackTransportTest : public webrtc::Transport {
   int packets_sent_;
   int last_sent_packet_len_;
   uint8_t last_sent_packet_[kMaxPacketLength];
+  // Where the last packet was sent from.
+  const void* last_sent_data_;
 };
 
 class RtpSenderTest : public ::testing::Test {
@@ -499,6 +506,84 @@ TEST_F(RtpSenderTest, SendGenericVideo) {
   EXPECT_EQ(0, memcmp(payload, payload_data, sizeof(payload)));
 }
 
+TEST_F(RtpSenderTest, SendsVideoFromStoredPacket) {
+  char payload_name[RTP_PAYLOAD_NAME_SIZE] = "GENERIC";
+  const uint8_t payload_type = 127;
+  ASSERT_EQ(0, rtp_sender_->RegisterPayload(payload_name, payload_type, 90000,
+                                            0, 1500));
+  rtp_sender_->SetStorePacketsStatus(true, 10);
+  uint8_t payload[] = {47, 11, 32, 93, 89};
+
+  ASSERT_EQ(0, rtp_sender_->SendOutgoingData(kVideoFrameKey, payload_type, 1234,
+                                             4321, payload, sizeof(payload),
+                                             NULL));
+  const void* sent_data = transport_.last_sent_data_;
+
+  // The packet is built in the buffer kept by the packet history, so a
+  // retransmission is sent from the same memory as the original.
+  EXPECT_LT(0, rtp_sender_->ReSendPacket(kSeqNum));
+  EXPECT_EQ(2, transport_.packets_sent_);
+  EXPECT_EQ(sent_data, transport_.last_sent_data_);
+}
+
+TEST_F(RtpSenderTest, DISABLED_SendToNetworkBenchmark) {
+  const int kNumPackets = 100000;
+  const int kPayloadLength = 1200;
+  const int kNumStored = 600;
+  rtp_sender_->SetStorePacketsStatus(true, kNumStored);
+  uint8_t payload[kPayloadLength];
+  for (int i = 0; i < kPayloadLength; ++i) {
+    payload[i] = static_cast<uint8_t>(i);
+  }
+
+  // The packet is written to a stack buffer, which the history copies.
+  TickTime start = TickTime::Now();
+  int header_length = 0;
+  for (int i = 0; i < kNumPackets; ++i) {
+    uint8_t buffer[IP_PACKET_SIZE];
+    header_length = rtp_sender_->BuildRTPheader(buffer, kPayload, kMarkerBit,
+                                                kTimestamp);
+    memcpy(buffer + header_length, payload, kPayloadLength);
+    ASSERT_EQ(0, rtp_sender_->SendToNetwork(buffer, kPayloadLength,
+                                            header_length, 0,
+                                            kAllowRetransmission,
+                                            PacedSender::kNormalPriority));
+  }
+  const double copy_time_us =
+      static_cast<double>((TickTime::Now() - start).Microseconds());
+
+  // The packet is written to a buffer the history stores by reference.
+  start = TickTime::Now();
+  for (int i = 0; i < kNumPackets; ++i) {
+    scoped_refptr<RtpPacketBuffer> packet = rtp_sender_->AllocatePacket();
+    header_length = rtp_sender_->BuildRTPheader(packet->data(), kPayload,
+                                                kMarkerBit, kTimestamp);
+    memcpy(packet->data() + header_length, payload, kPayloadLength);
+    ASSERT_EQ(0, rtp_sender_->SendToNetwork(&packet, kPayloadLength,
+                                            header_length, 0,
+                                            kAllowRetransmission,
+                                            PacedSender::kNormalPriority));
+  }
+  const double reference_time_us =
+      static_cast<double>((TickTime::Now() - start).Microseconds());
+  EXPECT_EQ(2 * kNumPackets, transport_.packets_sent_);
+
+  // Besides the copy to the transport, both copy the payload into the
+  // packet. The copying overload also copies the whole packet into the
+  // history.
+  const int packet_length = header_length + kPayloadLength;
+  printf("%d packets of %d bytes, %d stored:\n", kNumPackets, packet_length,
+         kNumStored);
+  printf("Copied to the history: %.2f bytes copied per sent byte, "
+         "%.3fus per packet.\n",
+         static_cast<double>(kPayloadLength + packet_length) / packet_length,
+         copy_time_us / kNumPackets);
+  printf("Stored by reference: %.2f bytes copied per sent byte, "
+         "%.3fus per packet.\n",
+         static_cast<double>(kPayloadLength) / packet_length,
+         reference_time_us / kNumPackets);
+}
+
 class RtpSenderAudioTest : public RtpSenderTest {
  protected:
   RtpSenderAudioTest() {}
@@ -107,7 +107,7 @@ int32_t RTPSenderVideo::RegisterVideoPayload(
 }
 
 int32_t
-RTPSenderVideo::SendVideoPacket(uint8_t* data_buffer,
+RTPSenderVideo::SendVideoPacket(scoped_refptr<RtpPacketBuffer>* packet,
                                 const uint16_t payload_length,
                                 const uint16_t rtp_header_length,
                                 const uint32_t capture_timestamp,
@@ -115,6 +115,9 @@ RTPSenderVideo::SendVideoPacket(uint8_t* data_buffer,
                                 StorageType storage,
                                 bool protect) {
   if(_fecEnabled) {
+    // The RED header goes between the RTP header and the payload, so the
+    // packet is copied into a RedPacket.
+    const uint8_t* data_buffer = (*packet)->data();
     int ret = 0;
     int fec_overhead_sent = 0;
     int video_sent = 0;
@@ -181,6 +184,7 @@ RTPSenderVideo::SendVideoPacket(uint8_t* data_buffer,
       delete red_packet;
       red_packet = NULL;
     }
+    *packet = NULL;
     _videoBitrate.Update(video_sent);
     _fecOverheadRate.Update(fec_overhead_sent);
     return ret;
@@ -188,7 +192,7 @@ RTPSenderVideo::SendVideoPacket(uint8_t* data_buffer,
   TRACE_EVENT_INSTANT2("webrtc_rtp", "Video::PacketNormal",
                        "timestamp", capture_timestamp,
                        "seqnum", _rtpSender.SequenceNumber());
-  int ret = _rtpSender.SendToNetwork(data_buffer,
+  int ret = _rtpSender.SendToNetwork(packet,
                                      payload_length,
                                      rtp_header_length,
                                      capture_time_ms,
@@ -345,9 +349,6 @@ int32_t RTPSenderVideo::SendGeneric(const FrameType frame_type,
   uint32_t payload_length = (size + num_packets - 1) / num_packets;
   assert(payload_length <= max_length);
 
-  // Fragment packet into packets of max MaxPayloadLength bytes payload.
-  uint8_t buffer[IP_PACKET_SIZE];
-
   uint8_t generic_header = RtpFormatVideoGeneric::kFirstPacketBit;
   if (frame_type == kVideoFrameKey) {
     generic_header |= RtpFormatVideoGeneric::kKeyFrameBit;
@@ -359,6 +360,10 @@ int32_t RTPSenderVideo::SendGeneric(const FrameType frame_type,
     }
     size -= payload_length;
 
+    // Fragment packet into packets of max MaxPayloadLength bytes payload.
+    scoped_refptr<RtpPacketBuffer> packet = _rtpSender.AllocatePacket();
+    uint8_t* buffer = packet->data();
+
     // MarkerBit is 1 on final packet (bytes_to_send == 0)
     if (_rtpSender.BuildRTPheader(buffer, payload_type, size == 0,
                                   capture_timestamp) != rtp_header_length) {
@@ -376,7 +381,7 @@ int32_t RTPSenderVideo::SendGeneric(const FrameType frame_type,
     memcpy(out_ptr, payload, payload_length);
     payload += payload_length;
 
-    if (SendVideoPacket(buffer, payload_length + 1, rtp_header_length,
+    if (SendVideoPacket(&packet, payload_length + 1, rtp_header_length,
                         capture_timestamp, capture_time_ms,
                         kAllowRetransmission, true)) {
       return -1;
@@ -443,8 +448,10 @@ RTPSenderVideo::SendVP8(const FrameType frameType,
     bool protect = (rtpTypeHdr->VP8.temporalIdx < 1);
     while (!last)
     {
-        // Write VP8 Payload Descriptor and VP8 payload.
-        uint8_t dataBuffer[IP_PACKET_SIZE] = {0};
+        // Write VP8 Payload Descriptor and VP8 payload straight to the
+        // buffer which is stored and sent.
+        scoped_refptr<RtpPacketBuffer> packet = _rtpSender.AllocatePacket();
+        uint8_t* dataBuffer = packet->data();
         int payloadBytesInPacket = 0;
         int packetStartPartition =
             packetizer.NextPacket(&dataBuffer[rtpHeaderLength],
@@ -466,7 +473,7 @@ RTPSenderVideo::SendVP8(const FrameType frameType,
         // Set marker bit true if this is the last packet in frame.
         _rtpSender.BuildRTPheader(dataBuffer, payloadType, last,
             captureTimeStamp);
-        if (-1 == SendVideoPacket(dataBuffer, payloadBytesInPacket,
+        if (-1 == SendVideoPacket(&packet, payloadBytesInPacket,
                                   rtpHeaderLength, captureTimeStamp,
                                   capture_time_ms, storage, protect))
         {
@@ -87,7 +87,8 @@ public:
     int SetSelectiveRetransmissions(uint8_t settings);
 
 protected:
-    virtual int32_t SendVideoPacket(uint8_t* dataBuffer,
+    // Takes the reference in |packet|.
+    virtual int32_t SendVideoPacket(scoped_refptr<RtpPacketBuffer>* packet,
                                     const uint16_t payloadLength,
                                     const uint16_t rtpHeaderLength,
                                     const uint32_t capture_timestamp,
@@ -11,11 +11,28 @@
 #ifndef WEBRTC_MODULES_UTILITY_INTERFACE_PROCESS_THREAD_H_
 #define WEBRTC_MODULES_UTILITY_INTERFACE_PROCESS_THREAD_H_
 
+#include <stddef.h>
+
 #include "typedefs.h"
 
 namespace webrtc {
 class Module;
 
+// Time spent in Module::Process() for one registered module.
+struct ModuleProcessStats
+{
+    ModuleProcessStats()
+        : module(NULL),
+          numProcessCalls(0),
+          totalProcessTimeUs(0),
+          maxProcessTimeUs(0) {}
+
+    const Module* module;
+    uint32_t numProcessCalls;
+    int64_t totalProcessTimeUs;
+    int64_t maxProcessTimeUs;
+};
+
 class ProcessThread
 {
 public:
@@ -27,6 +44,18 @@ public:
 
     virtual int32_t RegisterModule(const Module* module) = 0;
     virtual int32_t DeRegisterModule(const Module* module) = 0;
+
+    // Requests that the process thread polls |module| as soon as possible
+    // instead of waiting for the deadline previously reported through
+    // TimeUntilNextProcess(). Typically called by a module when new work has
+    // arrived. The module is processed if TimeUntilNextProcess() then reports
+    // it as due.
+    virtual void WakeUp(const Module* module) = 0;
+
+    // Same as WakeUp(), but polls |module| no later than |time_ms|, expressed
+    // in TickTime::MillisecondTimestamp() time. An earlier pending deadline
+    // for the module is kept.
+    virtual void WakeUpAt(const Module* module, int64_t time_ms) = 0;
 protected:
     virtual ~ProcessThread();
 };
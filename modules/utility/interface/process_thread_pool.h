@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_UTILITY_INTERFACE_PROCESS_THREAD_POOL_H_
+#define WEBRTC_MODULES_UTILITY_INTERFACE_PROCESS_THREAD_POOL_H_
+
+#include <vector>
+
+#include "process_thread.h"
+#include "typedefs.h"
+
+namespace webrtc {
+
+// ProcessThread which spreads its modules over a number of worker threads,
+// so that one slow Process() call only delays the modules sharing its
+// worker. Each module is processed by a single worker, and modules registered
+// with the same affinity key share a worker and are therefore never processed
+// concurrently or out of order with respect to each other.
+//
+// Destroy with ProcessThread::DestroyProcessThread().
+class ProcessThreadPool : public ProcessThread
+{
+public:
+    struct WorkerStats
+    {
+        WorkerStats()
+            : numProcessCalls(0),
+              totalProcessTimeUs(0) {}
+
+        uint32_t numProcessCalls;
+        int64_t totalProcessTimeUs;
+        std::vector<ModuleProcessStats> modules;
+    };
+
+    static ProcessThreadPool* CreateProcessThreadPool(int numThreads);
+
+    // Registers |module| on the worker least loaded with modules.
+    virtual int32_t RegisterModule(const Module* module) = 0;
+
+    // Registers |module| on the worker already serving |affinityKey|, or on
+    // the worker least loaded with modules if no other module registered
+    // with |affinityKey| remains. Typically the channel id is used as key.
+    virtual int32_t RegisterModule(const Module* module,
+                                   uint32_t affinityKey) = 0;
+
+    virtual int NumberOfThreads() const = 0;
+
+    // Fills |stats| with one entry per worker thread.
+    virtual void GetWorkerStats(std::vector<WorkerStats>* stats) const = 0;
+
+protected:
+    virtual ~ProcessThreadPool() {}
+};
+} // namespace webrtc
+#endif // WEBRTC_MODULES_UTILITY_INTERFACE_PROCESS_THREAD_POOL_H_
@@ -21,6 +21,7 @@ LOCAL_SRC_FILES := coder.cc \
     file_player_impl.cc \
     file_recorder_impl.cc \
     process_thread_impl.cc \
+    process_thread_pool_impl.cc \
     rtp_dump_impl.cc \
     frame_scaler.cc \
     video_coder.cc \
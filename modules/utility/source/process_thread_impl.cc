@@ -9,7 +9,11 @@
  */
 
 #include "process_thread_impl.h"
+
+#include <vector>
+
 #include "module.h"
+#include "tick_util.h"
 #include "trace.h"
 
 namespace webrtc {
@@ -30,7 +34,17 @@ void ProcessThread::DestroyProcessThread(ProcessThread* module)
 ProcessThreadImpl::ProcessThreadImpl()
     : _timeEvent(*EventWrapper::Create()),
       _critSectModules(CriticalSectionWrapper::CreateCriticalSection()),
-      _thread(NULL)
+      _thread(NULL),
+      _threadName("ProcessThread")
+{
+    WEBRTC_TRACE(kTraceMemory, kTraceUtility, -1, "%s created", __FUNCTION__);
+}
+
+ProcessThreadImpl::ProcessThreadImpl(const char* threadName)
+    : _timeEvent(*EventWrapper::Create()),
+      _critSectModules(CriticalSectionWrapper::CreateCriticalSection()),
+      _thread(NULL),
+      _threadName(threadName)
 {
     WEBRTC_TRACE(kTraceMemory, kTraceUtility, -1, "%s created", __FUNCTION__);
 }
@@ -50,7 +64,7 @@ int32_t ProcessThreadImpl::Start()
         return -1;
     }
     _thread = ThreadWrapper::CreateThread(Run, this, kNormalPriority,
-                                          "ProcessThread");
+                                          _threadName.c_str());
     unsigned int id;
     int32_t retVal = _thread->Start(id);
     if(retVal >= 0)
@@ -92,20 +106,18 @@ int32_t ProcessThreadImpl::RegisterModule(const Module* module)
     CriticalSectionScoped lock(_critSectModules);
 
     // Only allow module to be registered once.
-    ListItem* item = _modules.First();
-    for(uint32_t i = 0; i < _modules.GetSize() && item; i++)
+    if(_modules.find(module) != _modules.end())
     {
-        if(module == item->GetItem())
-        {
-            return -1;
-        }
-        item = _modules.Next(item);
+        return -1;
     }
 
-    _modules.PushFront(module);
+    ModuleEntry& entry = _modules[module];
+    entry.scheduleEntry = _schedule.end();
+    entry.stats.module = module;
+    ScheduleLocked(module, TickTime::MillisecondTimestamp());
     WEBRTC_TRACE(kTraceInfo, kTraceUtility, -1,
                  "number of registered modules has increased to %d",
-                 _modules.GetSize());
+                 _modules.size());
     // Wake the thread calling ProcessThreadImpl::Process() to update the
     // waiting time. The waiting time for the just registered module may be
     // shorter than all other registered modules.
@@ -117,20 +129,75 @@ int32_t ProcessThreadImpl::DeRegisterModule(const Module* module)
 {
     CriticalSectionScoped lock(_critSectModules);
 
-    ListItem* item = _modules.First();
-    for(uint32_t i = 0; i < _modules.GetSize() && item; i++)
+    ModuleMap::iterator it = _modules.find(module);
+    if(it == _modules.end())
+    {
+        return -1;
+    }
+    if(it->second.scheduleEntry != _schedule.end())
+    {
+        _schedule.erase(it->second.scheduleEntry);
+    }
+    _modules.erase(it);
+    WEBRTC_TRACE(kTraceInfo, kTraceUtility, -1,
+                 "number of registered modules has decreased to %d",
+                 _modules.size());
+    return 0;
+}
+
+void ProcessThreadImpl::WakeUp(const Module* module)
+{
+    WakeUpAt(module, TickTime::MillisecondTimestamp());
+}
+
+void ProcessThreadImpl::WakeUpAt(const Module* module, int64_t time_ms)
+{
+    CriticalSectionScoped lock(_critSectModules);
+    const bool was_empty = _schedule.empty();
+    const int64_t first_deadline = was_empty ? 0 : _schedule.begin()->first;
+    ScheduleLocked(module, time_ms);
+    if(!_schedule.empty() &&
+       (was_empty || _schedule.begin()->first < first_deadline))
     {
-        if(module == item->GetItem())
+        // The earliest deadline has moved, the waiting time must be updated.
+        _timeEvent.Set();
+    }
+}
+
+uint32_t ProcessThreadImpl::NumberOfModules() const
+{
+    CriticalSectionScoped lock(_critSectModules);
+    return static_cast<uint32_t>(_modules.size());
+}
+
+void ProcessThreadImpl::GetModuleStats(
+    std::vector<ModuleProcessStats>* stats) const
+{
+    CriticalSectionScoped lock(_critSectModules);
+    for(ModuleMap::const_iterator it = _modules.begin(); it != _modules.end();
+        ++it)
+    {
+        stats->push_back(it->second.stats);
+    }
+}
+
+void ProcessThreadImpl::ScheduleLocked(const Module* module, int64_t time_ms)
+{
+    ModuleMap::iterator it = _modules.find(module);
+    if(it == _modules.end())
+    {
+        return;
+    }
+    Schedule::iterator& scheduleEntry = it->second.scheduleEntry;
+    if(scheduleEntry != _schedule.end())
+    {
+        if(scheduleEntry->first <= time_ms)
         {
-            int res = _modules.Erase(item);
-            WEBRTC_TRACE(kTraceInfo, kTraceUtility, -1,
-                         "number of registered modules has decreased to %d",
-                         _modules.GetSize());
-            return res;
+            return;
         }
-        item = _modules.Next(item);
+        _schedule.erase(scheduleEntry);
     }
-    return -1;
+    scheduleEntry = _schedule.insert(std::make_pair(time_ms, module));
 }
 
 bool ProcessThreadImpl::Run(void* obj)
@@ -141,26 +208,25 @@ bool ProcessThreadImpl::Run(void* obj)
 bool ProcessThreadImpl::Process()
 {
     // Wait for the module that should be called next, but don't block thread
-    // longer than 100 ms.
-    int32_t minTimeToNext = 100;
+    // longer than kMaxPollIntervalMs.
+    int64_t timeToNext = kMaxPollIntervalMs;
     {
         CriticalSectionScoped lock(_critSectModules);
-        ListItem* item = _modules.First();
-        for(uint32_t i = 0; i < _modules.GetSize() && item; i++)
+        if(!_schedule.empty())
         {
-            int32_t timeToNext =
-                static_cast<Module*>(item->GetItem())->TimeUntilNextProcess();
-            if(minTimeToNext > timeToNext)
+            timeToNext = _schedule.begin()->first -
+                TickTime::MillisecondTimestamp();
+            if(timeToNext > kMaxPollIntervalMs)
             {
-                minTimeToNext = timeToNext;
+                timeToNext = kMaxPollIntervalMs;
             }
-            item = _modules.Next(item);
         }
     }
 
-    if(minTimeToNext > 0)
+    if(timeToNext > 0)
     {
-        if(kEventError == _timeEvent.Wait(minTimeToNext))
+        if(kEventError ==
+           _timeEvent.Wait(static_cast<unsigned long>(timeToNext)))
         {
             return true;
         }
@@ -172,16 +238,59 @@ bool ProcessThreadImpl::Process()
     }
     {
         CriticalSectionScoped lock(_critSectModules);
-        ListItem* item = _modules.First();
-        for(uint32_t i = 0; i < _modules.GetSize() && item; i++)
+        const int64_t now = TickTime::MillisecondTimestamp();
+
+        // Take every due module out of the schedule before calling any of
+        // them, so that modules which are due again immediately are not
+        // processed twice in one wakeup.
+        std::vector<const Module*> dueModules;
+        while(!_schedule.empty() && _schedule.begin()->first <= now)
+        {
+            const Module* module = _schedule.begin()->second;
+            _modules[module].scheduleEntry = _schedule.end();
+            _schedule.erase(_schedule.begin());
+            dueModules.push_back(module);
+        }
+
+        for(size_t i = 0; i < dueModules.size(); ++i)
         {
-            int32_t timeToNext =
-                static_cast<Module*>(item->GetItem())->TimeUntilNextProcess();
-            if(timeToNext < 1)
+            // A module may have been deregistered from within the Process()
+            // call of a module preceding it.
+            if(_modules.find(dueModules[i]) == _modules.end())
+            {
+                continue;
+            }
+            Module* module = const_cast<Module*>(dueModules[i]);
+            if(module->TimeUntilNextProcess() < 1)
+            {
+                const int64_t startUs = TickTime::MicrosecondTimestamp();
+                module->Process();
+                const int64_t elapsedUs =
+                    TickTime::MicrosecondTimestamp() - startUs;
+                // The module may have deregistered itself.
+                ModuleMap::iterator it = _modules.find(module);
+                if(it == _modules.end())
+                {
+                    continue;
+                }
+                ModuleProcessStats& stats = it->second.stats;
+                ++stats.numProcessCalls;
+                stats.totalProcessTimeUs += elapsedUs;
+                if(elapsedUs > stats.maxProcessTimeUs)
+                {
+                    stats.maxProcessTimeUs = elapsedUs;
+                }
+            }
+            int32_t delayMs = module->TimeUntilNextProcess();
+            if(delayMs < 0)
+            {
+                delayMs = 0;
+            }
+            else if(delayMs > kMaxPollIntervalMs)
             {
-                static_cast<Module*>(item->GetItem())->Process();
+                delayMs = kMaxPollIntervalMs;
             }
-            item = _modules.Next(item);
+            ScheduleLocked(module, now + delayMs);
         }
     }
     return true;
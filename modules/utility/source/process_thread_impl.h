@@ -11,18 +11,27 @@
 #ifndef WEBRTC_MODULES_UTILITY_SOURCE_PROCESS_THREAD_IMPL_H_
 #define WEBRTC_MODULES_UTILITY_SOURCE_PROCESS_THREAD_IMPL_H_
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "critical_section_wrapper.h"
 #include "event_wrapper.h"
-#include "list_wrapper.h"
 #include "process_thread.h"
 #include "thread_wrapper.h"
 #include "typedefs.h"
 
 namespace webrtc {
+// Modules are kept in a schedule ordered on their next deadline, so a wakeup
+// only touches the modules that are due instead of polling every registered
+// module. A module's deadline is refreshed from TimeUntilNextProcess() each
+// time it has been processed, and at least every |kMaxPollIntervalMs| to
+// catch modules whose deadline moves without a call to WakeUp().
 class ProcessThreadImpl : public ProcessThread
 {
 public:
     ProcessThreadImpl();
+    explicit ProcessThreadImpl(const char* threadName);
     virtual ~ProcessThreadImpl();
 
     virtual int32_t Start();
@@ -31,16 +40,44 @@ public:
     virtual int32_t RegisterModule(const Module* module);
     virtual int32_t DeRegisterModule(const Module* module);
 
+    virtual void WakeUp(const Module* module);
+    virtual void WakeUpAt(const Module* module, int64_t time_ms);
+
+    // Returns the number of registered modules.
+    uint32_t NumberOfModules() const;
+
+    // Appends the time spent in Process() by each registered module to
+    // |stats|. Statistics are reset when a module is deregistered.
+    void GetModuleStats(std::vector<ModuleProcessStats>* stats) const;
+
 protected:
+    static const int32_t kMaxPollIntervalMs = 100;
+
     static bool Run(void* obj);
 
     bool Process();
 
 private:
+    typedef std::multimap<int64_t, const Module*> Schedule;
+    struct ModuleEntry
+    {
+        // Entry in |_schedule|, or _schedule.end() while the module is being
+        // processed.
+        Schedule::iterator scheduleEntry;
+        ModuleProcessStats stats;
+    };
+    typedef std::map<const Module*, ModuleEntry> ModuleMap;
+
+    // Moves the deadline of |module| to |time_ms| if that is earlier than the
+    // pending one. Must be called with |_critSectModules| held.
+    void ScheduleLocked(const Module* module, int64_t time_ms);
+
     EventWrapper&           _timeEvent;
     CriticalSectionWrapper* _critSectModules;
-    ListWrapper             _modules;
+    Schedule                _schedule;
+    ModuleMap               _modules;
     ThreadWrapper*          _thread;
+    const std::string       _threadName;
 };
 } // namespace webrtc
 
@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/interface/module.h"
+#include "webrtc/modules/utility/source/process_thread_impl.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace {
+
+const int64_t kStartTimeMs = 12345;
+
+// Module which wants to be processed every |interval_ms| milliseconds.
+class FakeModule : public Module {
+ public:
+  explicit FakeModule(int32_t interval_ms)
+      : interval_ms_(interval_ms),
+        next_process_time_ms_(TickTime::MillisecondTimestamp()),
+        num_polls_(0),
+        num_processed_(0) {}
+  virtual ~FakeModule() {}
+
+  virtual int32_t TimeUntilNextProcess() {
+    ++num_polls_;
+    return static_cast<int32_t>(next_process_time_ms_ -
+                                TickTime::MillisecondTimestamp());
+  }
+
+  virtual int32_t Process() {
+    ++num_processed_;
+    next_process_time_ms_ = TickTime::MillisecondTimestamp() + interval_ms_;
+    return 0;
+  }
+
+  void set_next_process_time_ms(int64_t time_ms) {
+    next_process_time_ms_ = time_ms;
+  }
+  int num_polls() const { return num_polls_; }
+  int num_processed() const { return num_processed_; }
+
+ private:
+  int32_t interval_ms_;
+  int64_t next_process_time_ms_;
+  int num_polls_;
+  int num_processed_;
+};
+
+// Exposes Process() so that the schedule can be driven without a thread.
+class TestProcessThread : public ProcessThreadImpl {
+ public:
+  bool ProcessOnce() { return Process(); }
+};
+
+class ProcessThreadImplTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    TickTime::UseFakeClock(kStartTimeMs);
+  }
+
+  TestProcessThread process_thread_;
+};
+
+TEST_F(ProcessThreadImplTest, RegisterModuleOnlyOnce) {
+  FakeModule module(10);
+  EXPECT_EQ(0, process_thread_.RegisterModule(&module));
+  EXPECT_EQ(-1, process_thread_.RegisterModule(&module));
+  EXPECT_EQ(1u, process_thread_.NumberOfModules());
+  EXPECT_EQ(0, process_thread_.DeRegisterModule(&module));
+  EXPECT_EQ(-1, process_thread_.DeRegisterModule(&module));
+  EXPECT_EQ(0u, process_thread_.NumberOfModules());
+}
+
+TEST_F(ProcessThreadImplTest, RegisteredModuleIsProcessedWhenDue) {
+  FakeModule module(10);
+  EXPECT_EQ(0, process_thread_.RegisterModule(&module));
+  EXPECT_TRUE(process_thread_.ProcessOnce());
+  EXPECT_EQ(1, module.num_processed());
+
+  TickTime::AdvanceFakeClock(10);
+  EXPECT_TRUE(process_thread_.ProcessOnce());
+  EXPECT_EQ(2, module.num_processed());
+  EXPECT_EQ(0, process_thread_.DeRegisterModule(&module));
+}
+
+TEST_F(ProcessThreadImplTest, IdleModulesAreNotPolled) {
+  FakeModule fast_module(5);
+  FakeModule slow_module(50);
+  EXPECT_EQ(0, process_thread_.RegisterModule(&fast_module));
+  EXPECT_EQ(0, process_thread_.RegisterModule(&slow_module));
+  EXPECT_TRUE(process_thread_.ProcessOnce());
+  EXPECT_EQ(1, fast_module.num_processed());
+  EXPECT_EQ(1, slow_module.num_processed());
+  const int slow_module_polls = slow_module.num_polls();
+
+  for (int i = 0; i < 9; ++i) {
+    TickTime::AdvanceFakeClock(5);
+    EXPECT_TRUE(process_thread_.ProcessOnce());
+  }
+  EXPECT_EQ(10, fast_module.num_processed());
+  EXPECT_EQ(1, slow_module.num_processed());
+  EXPECT_EQ(slow_module_polls, slow_module.num_polls());
+
+  TickTime::AdvanceFakeClock(5);
+  EXPECT_TRUE(process_thread_.ProcessOnce());
+  EXPECT_EQ(11, fast_module.num_processed());
+  EXPECT_EQ(2, slow_module.num_processed());
+  EXPECT_EQ(0, process_thread_.DeRegisterModule(&fast_module));
+  EXPECT_EQ(0, process_thread_.DeRegisterModule(&slow_module));
+}
+
+TEST_F(ProcessThreadImplTest, WakeUpPollsModuleBeforeDeadline) {
+  FakeModule fast_module(5);
+  FakeModule slow_module(50);
+  EXPECT_EQ(0, process_thread_.RegisterModule(&fast_module));
+  EXPECT_EQ(0, process_thread_.RegisterModule(&slow_module));
+  EXPECT_TRUE(process_thread_.ProcessOnce());
+
+  // The slow module gets new work and asks to be woken up.
+  TickTime::AdvanceFakeClock(5);
+  slow_module.set_next_process_time_ms(TickTime::MillisecondTimestamp());
+  process_thread_.WakeUp(&slow_module);
+  EXPECT_TRUE(process_thread_.ProcessOnce());
+  EXPECT_EQ(2, fast_module.num_processed());
+  EXPECT_EQ(2, slow_module.num_processed());
+
+  // A later deadline does not postpone an earlier one.
+  TickTime::AdvanceFakeClock(5);
+  process_thread_.WakeUpAt(&fast_module, kStartTimeMs + 1000);
+  EXPECT_TRUE(process_thread_.ProcessOnce());
+  EXPECT_EQ(3, fast_module.num_processed());
+  EXPECT_EQ(0, process_thread_.DeRegisterModule(&fast_module));
+  EXPECT_EQ(0, process_thread_.DeRegisterModule(&slow_module));
+}
+
+TEST_F(ProcessThreadImplTest, DeRegisteredModuleIsNotProcessed) {
+  FakeModule module(10);
+  EXPECT_EQ(0, process_thread_.RegisterModule(&module));
+  EXPECT_EQ(0, process_thread_.DeRegisterModule(&module));
+  process_thread_.WakeUp(&module);
+  // Nothing is scheduled, so Process() waits and then returns since the
+  // thread is not running.
+  EXPECT_FALSE(process_thread_.ProcessOnce());
+  EXPECT_EQ(0, module.num_processed());
+}
+
+}  // namespace
+}  // namespace webrtc
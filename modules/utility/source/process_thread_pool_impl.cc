@@ -0,0 +1,270 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "process_thread_pool_impl.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "trace.h"
+
+namespace webrtc {
+ProcessThreadPool* ProcessThreadPool::CreateProcessThreadPool(int numThreads)
+{
+    if(numThreads < 1)
+    {
+        return NULL;
+    }
+    return new ProcessThreadPoolImpl(numThreads);
+}
+
+ProcessThreadPoolImpl::ProcessThreadPoolImpl(int numThreads)
+    : _critSect(CriticalSectionWrapper::CreateCriticalSection()),
+      _numModulesPerWorker(numThreads, 0)
+{
+    for(int i = 0; i < numThreads; ++i)
+    {
+        char threadName[32];
+        snprintf(threadName, sizeof(threadName), "ProcessThread%d", i);
+        _workers.push_back(new ProcessThreadImpl(threadName));
+    }
+    WEBRTC_TRACE(kTraceMemory, kTraceUtility, -1, "%s created", __FUNCTION__);
+}
+
+ProcessThreadPoolImpl::ProcessThreadPoolImpl(
+    const std::vector<ProcessThreadImpl*>& workers)
+    : _critSect(CriticalSectionWrapper::CreateCriticalSection()),
+      _workers(workers),
+      _numModulesPerWorker(workers.size(), 0)
+{
+    WEBRTC_TRACE(kTraceMemory, kTraceUtility, -1, "%s created", __FUNCTION__);
+}
+
+ProcessThreadPoolImpl::~ProcessThreadPoolImpl()
+{
+    for(size_t i = 0; i < _workers.size(); ++i)
+    {
+        delete _workers[i];
+    }
+    delete _critSect;
+    WEBRTC_TRACE(kTraceMemory, kTraceUtility, -1, "%s deleted", __FUNCTION__);
+}
+
+int32_t ProcessThreadPoolImpl::Start()
+{
+    for(size_t i = 0; i < _workers.size(); ++i)
+    {
+        if(_workers[i]->Start() != 0)
+        {
+            // Leave the pool either fully started or fully stopped.
+            for(size_t j = 0; j < i; ++j)
+            {
+                _workers[j]->Stop();
+            }
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int32_t ProcessThreadPoolImpl::Stop()
+{
+    int32_t retVal = 0;
+    for(size_t i = 0; i < _workers.size(); ++i)
+    {
+        if(_workers[i]->Stop() != 0)
+        {
+            retVal = -1;
+        }
+    }
+    return retVal;
+}
+
+int32_t ProcessThreadPoolImpl::RegisterModule(const Module* module)
+{
+    return RegisterModuleOnWorker(module, false, 0);
+}
+
+int32_t ProcessThreadPoolImpl::RegisterModule(const Module* module,
+                                              uint32_t affinityKey)
+{
+    return RegisterModuleOnWorker(module, true, affinityKey);
+}
+
+int32_t ProcessThreadPoolImpl::RegisterModuleOnWorker(const Module* module,
+                                                      bool hasAffinityKey,
+                                                      uint32_t affinityKey)
+{
+    ProcessThreadImpl* worker = NULL;
+    {
+        CriticalSectionScoped lock(_critSect);
+        // Only allow module to be registered once. This includes a module
+        // still being deregistered.
+        if(_modules.find(module) != _modules.end())
+        {
+            return -1;
+        }
+        ModuleInfo info;
+        info.worker = -1;
+        info.hasAffinityKey = hasAffinityKey;
+        info.affinityKey = affinityKey;
+        info.state = kRegistering;
+        if(hasAffinityKey)
+        {
+            AffinityMap::iterator it = _affinities.find(affinityKey);
+            if(it == _affinities.end())
+            {
+                AffinityInfo affinity;
+                affinity.worker = LeastLoadedWorkerLocked();
+                affinity.numModules = 0;
+                it = _affinities.insert(
+                    std::make_pair(affinityKey, affinity)).first;
+            }
+            ++it->second.numModules;
+            info.worker = it->second.worker;
+        }
+        else
+        {
+            info.worker = LeastLoadedWorkerLocked();
+        }
+        _modules[module] = info;
+        ++_numModulesPerWorker[info.worker];
+        worker = _workers[info.worker];
+    }
+    // The worker is called without |_critSect| held, since modules being
+    // processed by the worker may call back into the pool, e.g. WakeUp().
+    const int32_t error = worker->RegisterModule(module);
+    CriticalSectionScoped lock(_critSect);
+    // A module being registered can't be deregistered, so it is still here.
+    ModuleMap::iterator it = _modules.find(module);
+    assert(it != _modules.end() && it->second.state == kRegistering);
+    if(error != 0)
+    {
+        // Undo the bookkeeping, so the module isn't counted on the worker
+        // and can be registered again.
+        RemoveModuleLocked(it);
+    }
+    else
+    {
+        it->second.state = kRegistered;
+    }
+    return error;
+}
+
+int32_t ProcessThreadPoolImpl::DeRegisterModule(const Module* module)
+{
+    ProcessThreadImpl* worker = NULL;
+    {
+        CriticalSectionScoped lock(_critSect);
+        ModuleMap::iterator it = _modules.find(module);
+        // A module whose registration hasn't completed isn't registered yet.
+        // Waiting for it could deadlock, as this may be called from the
+        // Process() call of a module on the worker it is registered on.
+        if(it == _modules.end() || it->second.state != kRegistered)
+        {
+            return -1;
+        }
+        it->second.state = kDeRegistering;
+        worker = _workers[it->second.worker];
+    }
+    const int32_t error = worker->DeRegisterModule(module);
+    // The module is kept until now so that it can't be registered on another
+    // worker while it is still registered on this one.
+    CriticalSectionScoped lock(_critSect);
+    ModuleMap::iterator it = _modules.find(module);
+    assert(it != _modules.end() && it->second.state == kDeRegistering);
+    RemoveModuleLocked(it);
+    return error;
+}
+
+void ProcessThreadPoolImpl::WakeUp(const Module* module)
+{
+    ProcessThreadImpl* worker = WorkerForModule(module);
+    if(worker)
+    {
+        worker->WakeUp(module);
+    }
+}
+
+void ProcessThreadPoolImpl::WakeUpAt(const Module* module, int64_t time_ms)
+{
+    ProcessThreadImpl* worker = WorkerForModule(module);
+    if(worker)
+    {
+        worker->WakeUpAt(module, time_ms);
+    }
+}
+
+int ProcessThreadPoolImpl::NumberOfThreads() const
+{
+    return static_cast<int>(_workers.size());
+}
+
+void ProcessThreadPoolImpl::GetWorkerStats(
+    std::vector<WorkerStats>* stats) const
+{
+    stats->clear();
+    stats->resize(_workers.size());
+    for(size_t i = 0; i < _workers.size(); ++i)
+    {
+        WorkerStats& workerStats = (*stats)[i];
+        _workers[i]->GetModuleStats(&workerStats.modules);
+        for(size_t j = 0; j < workerStats.modules.size(); ++j)
+        {
+            workerStats.numProcessCalls +=
+                workerStats.modules[j].numProcessCalls;
+            workerStats.totalProcessTimeUs +=
+                workerStats.modules[j].totalProcessTimeUs;
+        }
+    }
+}
+
+ProcessThreadImpl* ProcessThreadPoolImpl::WorkerForModule(
+    const Module* module) const
+{
+    CriticalSectionScoped lock(_critSect);
+    ModuleMap::const_iterator it = _modules.find(module);
+    if(it == _modules.end())
+    {
+        return NULL;
+    }
+    return _workers[it->second.worker];
+}
+
+int ProcessThreadPoolImpl::LeastLoadedWorkerLocked() const
+{
+    int leastLoaded = 0;
+    for(size_t i = 1; i < _numModulesPerWorker.size(); ++i)
+    {
+        if(_numModulesPerWorker[i] < _numModulesPerWorker[leastLoaded])
+        {
+            leastLoaded = static_cast<int>(i);
+        }
+    }
+    return leastLoaded;
+}
+
+int ProcessThreadPoolImpl::RemoveModuleLocked(ModuleMap::iterator it)
+{
+    const ModuleInfo& info = it->second;
+    if(info.hasAffinityKey)
+    {
+        AffinityMap::iterator affinity = _affinities.find(info.affinityKey);
+        if(--affinity->second.numModules == 0)
+        {
+            _affinities.erase(affinity);
+        }
+    }
+    const int worker = info.worker;
+    --_numModulesPerWorker[worker];
+    _modules.erase(it);
+    return worker;
+}
+} // namespace webrtc
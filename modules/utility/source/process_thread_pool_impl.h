@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_UTILITY_SOURCE_PROCESS_THREAD_POOL_IMPL_H_
+#define WEBRTC_MODULES_UTILITY_SOURCE_PROCESS_THREAD_POOL_IMPL_H_
+
+#include <map>
+#include <vector>
+
+#include "critical_section_wrapper.h"
+#include "process_thread_impl.h"
+#include "process_thread_pool.h"
+#include "typedefs.h"
+
+namespace webrtc {
+class ProcessThreadPoolImpl : public ProcessThreadPool
+{
+public:
+    explicit ProcessThreadPoolImpl(int numThreads);
+    // Takes ownership of |workers|, which must not be empty. Lets tests use
+    // workers which fail.
+    explicit ProcessThreadPoolImpl(
+        const std::vector<ProcessThreadImpl*>& workers);
+    virtual ~ProcessThreadPoolImpl();
+
+    virtual int32_t Start();
+    virtual int32_t Stop();
+
+    virtual int32_t RegisterModule(const Module* module);
+    virtual int32_t RegisterModule(const Module* module, uint32_t affinityKey);
+    virtual int32_t DeRegisterModule(const Module* module);
+
+    virtual void WakeUp(const Module* module);
+    virtual void WakeUpAt(const Module* module, int64_t time_ms);
+
+    virtual int NumberOfThreads() const;
+    virtual void GetWorkerStats(std::vector<WorkerStats>* stats) const;
+
+private:
+    // The workers are called without |_critSect| held, so a module stays in
+    // the bookkeeping while it is being registered on or deregistered from
+    // its worker. Other registrations and deregistrations of the module fail
+    // meanwhile, which keeps the pool and the worker in agreement.
+    enum ModuleState
+    {
+        kRegistering,
+        kRegistered,
+        kDeRegistering
+    };
+    struct ModuleInfo
+    {
+        int worker;
+        bool hasAffinityKey;
+        uint32_t affinityKey;
+        ModuleState state;
+    };
+    struct AffinityInfo
+    {
+        int worker;
+        int numModules;
+    };
+    typedef std::map<const Module*, ModuleInfo> ModuleMap;
+    typedef std::map<uint32_t, AffinityInfo> AffinityMap;
+
+    // Returns the worker |module| is registered on, or NULL.
+    ProcessThreadImpl* WorkerForModule(const Module* module) const;
+
+    // Must be called with |_critSect| held.
+    int LeastLoadedWorkerLocked() const;
+    // Removes the module at |it| from the bookkeeping and returns the worker
+    // it was registered on. Must be called with |_critSect| held.
+    int RemoveModuleLocked(ModuleMap::iterator it);
+
+    int32_t RegisterModuleOnWorker(const Module* module,
+                                   bool hasAffinityKey,
+                                   uint32_t affinityKey);
+
+    CriticalSectionWrapper*         _critSect;
+    std::vector<ProcessThreadImpl*> _workers;
+    std::vector<int>                _numModulesPerWorker;
+    ModuleMap                       _modules;
+    AffinityMap                     _affinities;
+};
+} // namespace webrtc
+
+#endif // WEBRTC_MODULES_UTILITY_SOURCE_PROCESS_THREAD_POOL_IMPL_H_
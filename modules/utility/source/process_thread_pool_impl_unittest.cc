@@ -0,0 +1,257 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/interface/module.h"
+#include "webrtc/modules/utility/interface/process_thread_pool.h"
+#include "webrtc/modules/utility/source/process_thread_impl.h"
+#include "webrtc/modules/utility/source/process_thread_pool_impl.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+
+namespace webrtc {
+namespace {
+
+const unsigned long kEventTimeoutMs = 1000;
+
+// Module which wants to be processed once and signals when it has been.
+class SignalingModule : public Module {
+ public:
+  SignalingModule() : processed_(EventWrapper::Create()), done_(false) {}
+  virtual ~SignalingModule() {}
+
+  virtual int32_t TimeUntilNextProcess() { return done_ ? 1000 : 0; }
+
+  virtual int32_t Process() {
+    done_ = true;
+    processed_->Set();
+    return 0;
+  }
+
+  bool WaitForProcess() {
+    return processed_->Wait(kEventTimeoutMs) == kEventSignaled;
+  }
+
+ private:
+  scoped_ptr<EventWrapper> processed_;
+  bool done_;
+};
+
+// Worker which fails to register |rejected_module|.
+class RejectingWorker : public ProcessThreadImpl {
+ public:
+  RejectingWorker() : ProcessThreadImpl("RejectingWorker"),
+                      rejected_module_(NULL) {}
+  virtual ~RejectingWorker() {}
+
+  virtual int32_t RegisterModule(const Module* module) {
+    if (module == rejected_module_)
+      return -1;
+    return ProcessThreadImpl::RegisterModule(module);
+  }
+
+  void set_rejected_module(const Module* module) { rejected_module_ = module; }
+
+ private:
+  const Module* rejected_module_;
+};
+
+// Worker whose RegisterModule() waits until it is released.
+class BlockingWorker : public ProcessThreadImpl {
+ public:
+  BlockingWorker() : ProcessThreadImpl("BlockingWorker"),
+                     entered_(EventWrapper::Create()),
+                     released_(EventWrapper::Create()) {}
+  virtual ~BlockingWorker() {}
+
+  virtual int32_t RegisterModule(const Module* module) {
+    entered_->Set();
+    released_->Wait(kEventTimeoutMs);
+    return ProcessThreadImpl::RegisterModule(module);
+  }
+
+  bool WaitUntilEntered() {
+    return entered_->Wait(kEventTimeoutMs) == kEventSignaled;
+  }
+  void Release() { released_->Set(); }
+
+ private:
+  scoped_ptr<EventWrapper> entered_;
+  scoped_ptr<EventWrapper> released_;
+};
+
+struct Registration {
+  ProcessThreadPool* pool;
+  const Module* module;
+  int32_t result;
+};
+
+bool Register(void* obj) {
+  Registration* registration = static_cast<Registration*>(obj);
+  registration->result =
+      registration->pool->RegisterModule(registration->module);
+  return false;
+}
+
+// Returns the index of the worker |module| is registered on, or -1.
+int WorkerOf(const std::vector<ProcessThreadPool::WorkerStats>& stats,
+             const Module* module) {
+  for (size_t i = 0; i < stats.size(); ++i) {
+    for (size_t j = 0; j < stats[i].modules.size(); ++j) {
+      if (stats[i].modules[j].module == module)
+        return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+class ProcessThreadPoolTest : public ::testing::Test {
+ protected:
+  ProcessThreadPoolTest()
+      : pool_(ProcessThreadPool::CreateProcessThreadPool(2)) {}
+  virtual ~ProcessThreadPoolTest() {
+    ProcessThread::DestroyProcessThread(pool_);
+  }
+
+  ProcessThreadPool* pool_;
+};
+
+TEST_F(ProcessThreadPoolTest, InvalidNumberOfThreads) {
+  EXPECT_TRUE(ProcessThreadPool::CreateProcessThreadPool(0) == NULL);
+  EXPECT_EQ(2, pool_->NumberOfThreads());
+}
+
+TEST_F(ProcessThreadPoolTest, RegisterModuleOnlyOnce) {
+  SignalingModule module;
+  EXPECT_EQ(0, pool_->RegisterModule(&module, 1));
+  EXPECT_EQ(-1, pool_->RegisterModule(&module));
+  EXPECT_EQ(0, pool_->DeRegisterModule(&module));
+  EXPECT_EQ(-1, pool_->DeRegisterModule(&module));
+}
+
+TEST(ProcessThreadPoolImplTest, FailedRegistrationIsUndone) {
+  std::vector<ProcessThreadImpl*> workers;
+  RejectingWorker* rejecting_worker = new RejectingWorker();
+  workers.push_back(rejecting_worker);
+  workers.push_back(new ProcessThreadImpl("Worker"));
+  ProcessThreadPoolImpl pool(workers);
+  SignalingModule module1;
+  SignalingModule module2;
+  SignalingModule module3;
+  rejecting_worker->set_rejected_module(&module1);
+  // |module1| and its affinity are placed on the first, rejecting, worker.
+  EXPECT_EQ(-1, pool.RegisterModule(&module1, 1));
+
+  // The failure isn't counted as load on the first worker, so it gets the
+  // next module too, and affinity 1 is free to go elsewhere.
+  EXPECT_EQ(0, pool.RegisterModule(&module2));
+  EXPECT_EQ(0, pool.RegisterModule(&module3, 1));
+  std::vector<ProcessThreadPool::WorkerStats> stats;
+  pool.GetWorkerStats(&stats);
+  EXPECT_EQ(0, WorkerOf(stats, &module2));
+  EXPECT_EQ(1, WorkerOf(stats, &module3));
+
+  // Once the worker accepts it, |module1| can be registered.
+  rejecting_worker->set_rejected_module(NULL);
+  EXPECT_EQ(0, pool.RegisterModule(&module1));
+  EXPECT_EQ(0, pool.DeRegisterModule(&module1));
+  EXPECT_EQ(0, pool.DeRegisterModule(&module2));
+  EXPECT_EQ(0, pool.DeRegisterModule(&module3));
+}
+
+TEST(ProcessThreadPoolImplTest, ModuleIsNotDeRegisteredWhileRegistering) {
+  std::vector<ProcessThreadImpl*> workers;
+  BlockingWorker* blocking_worker = new BlockingWorker();
+  workers.push_back(blocking_worker);
+  ProcessThreadPoolImpl pool(workers);
+  SignalingModule module;
+  Registration registration = { &pool, &module, -1 };
+  scoped_ptr<ThreadWrapper> thread(
+      ThreadWrapper::CreateThread(&Register, &registration));
+  unsigned int id = 0;
+  ASSERT_TRUE(thread->Start(id));
+  ASSERT_TRUE(blocking_worker->WaitUntilEntered());
+
+  // The registration hasn't completed, so the module can neither be
+  // deregistered nor registered again.
+  EXPECT_EQ(-1, pool.DeRegisterModule(&module));
+  EXPECT_EQ(-1, pool.RegisterModule(&module));
+  blocking_worker->Release();
+  EXPECT_TRUE(thread->Stop());
+  EXPECT_EQ(0, registration.result);
+
+  // The pool and the worker agree that the module is registered.
+  std::vector<ProcessThreadPool::WorkerStats> stats;
+  pool.GetWorkerStats(&stats);
+  EXPECT_EQ(0, WorkerOf(stats, &module));
+  EXPECT_EQ(0, pool.DeRegisterModule(&module));
+  pool.GetWorkerStats(&stats);
+  EXPECT_EQ(-1, WorkerOf(stats, &module));
+}
+
+TEST_F(ProcessThreadPoolTest, ModulesAreSpreadOverWorkers) {
+  SignalingModule module1;
+  SignalingModule module2;
+  EXPECT_EQ(0, pool_->RegisterModule(&module1));
+  EXPECT_EQ(0, pool_->RegisterModule(&module2));
+  std::vector<ProcessThreadPool::WorkerStats> stats;
+  pool_->GetWorkerStats(&stats);
+  ASSERT_EQ(2u, stats.size());
+  EXPECT_EQ(1u, stats[0].modules.size());
+  EXPECT_EQ(1u, stats[1].modules.size());
+  EXPECT_EQ(0, pool_->DeRegisterModule(&module1));
+  EXPECT_EQ(0, pool_->DeRegisterModule(&module2));
+}
+
+TEST_F(ProcessThreadPoolTest, ModulesWithSameAffinityShareWorker) {
+  SignalingModule channel1_rtp;
+  SignalingModule channel2_rtp;
+  SignalingModule channel1_pacer;
+  SignalingModule channel2_pacer;
+  EXPECT_EQ(0, pool_->RegisterModule(&channel1_rtp, 1));
+  EXPECT_EQ(0, pool_->RegisterModule(&channel2_rtp, 2));
+  EXPECT_EQ(0, pool_->RegisterModule(&channel1_pacer, 1));
+  EXPECT_EQ(0, pool_->RegisterModule(&channel2_pacer, 2));
+  std::vector<ProcessThreadPool::WorkerStats> stats;
+  pool_->GetWorkerStats(&stats);
+  EXPECT_NE(-1, WorkerOf(stats, &channel1_rtp));
+  EXPECT_EQ(WorkerOf(stats, &channel1_rtp), WorkerOf(stats, &channel1_pacer));
+  EXPECT_EQ(WorkerOf(stats, &channel2_rtp), WorkerOf(stats, &channel2_pacer));
+  EXPECT_NE(WorkerOf(stats, &channel1_rtp), WorkerOf(stats, &channel2_rtp));
+  EXPECT_EQ(0, pool_->DeRegisterModule(&channel1_rtp));
+  EXPECT_EQ(0, pool_->DeRegisterModule(&channel2_rtp));
+  EXPECT_EQ(0, pool_->DeRegisterModule(&channel1_pacer));
+  EXPECT_EQ(0, pool_->DeRegisterModule(&channel2_pacer));
+}
+
+TEST_F(ProcessThreadPoolTest, ModulesAreProcessedAndAccounted) {
+  SignalingModule module1;
+  SignalingModule module2;
+  EXPECT_EQ(0, pool_->RegisterModule(&module1, 1));
+  EXPECT_EQ(0, pool_->RegisterModule(&module2, 2));
+  EXPECT_EQ(0, pool_->Start());
+  EXPECT_TRUE(module1.WaitForProcess());
+  EXPECT_TRUE(module2.WaitForProcess());
+  EXPECT_EQ(0, pool_->Stop());
+
+  std::vector<ProcessThreadPool::WorkerStats> stats;
+  pool_->GetWorkerStats(&stats);
+  ASSERT_EQ(2u, stats.size());
+  EXPECT_EQ(1u, stats[0].numProcessCalls);
+  EXPECT_EQ(1u, stats[1].numProcessCalls);
+  EXPECT_EQ(0, pool_->DeRegisterModule(&module1));
+  EXPECT_EQ(0, pool_->DeRegisterModule(&module2));
+}
+
+}  // namespace
+}  // namespace webrtc
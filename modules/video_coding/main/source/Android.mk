@@ -36,6 +36,7 @@ LOCAL_SRC_FILES := \
     qm_select.cc \
     receiver.cc \
     rtt_filter.cc \
+    sequence_number_bitset.cc \
     session_info.cc \
     timestamp_extrapolator.cc \
     timestamp_map.cc \
@@ -31,7 +31,9 @@ namespace webrtc {
 // Use this rtt if no value has been reported.
 static const uint32_t kDefaultRtt = 200;
 
-typedef std::pair<uint32_t, VCMFrameBuffer*> FrameListPair;
+// Incoming frame and bit rates are over this window.
+static const int kRateWindowMs = 1000;
+static const int kRateBucketMs = 10;
 
 bool IsKeyFrame(FrameListPair pair) {
   return pair.second->FrameType() == kVideoFrameKey;
@@ -41,39 +43,63 @@ bool HasNonEmptyState(FrameListPair pair) {
   return pair.second->GetState() != kStateEmpty;
 }
 
+bool FrameListPairLessThan(const FrameListPair& pair, uint32_t timestamp) {
+  return IsNewerTimestamp(timestamp, pair.first);
+}
+
+FrameList::FrameList() {
+  frames_.reserve(kMaxNumberOfFrames);
+}
+
+FrameList::iterator FrameList::LowerBound(uint32_t timestamp) {
+  return std::lower_bound(frames_.begin(), frames_.end(), timestamp,
+                          FrameListPairLessThan);
+}
+
+FrameList::const_iterator FrameList::LowerBound(uint32_t timestamp) const {
+  return std::lower_bound(frames_.begin(), frames_.end(), timestamp,
+                          FrameListPairLessThan);
+}
+
 void FrameList::InsertFrame(VCMFrameBuffer* frame) {
-  insert(rbegin().base(), FrameListPair(frame->TimeStamp(), frame));
+  const uint32_t timestamp = frame->TimeStamp();
+  if (frames_.empty() || IsNewerTimestamp(timestamp, frames_.back().first)) {
+    frames_.push_back(FrameListPair(timestamp, frame));
+    return;
+  }
+  iterator it = LowerBound(timestamp);
+  assert(it == frames_.end() || it->first != timestamp);
+  frames_.insert(it, FrameListPair(timestamp, frame));
 }
 
 VCMFrameBuffer* FrameList::FindFrame(uint32_t timestamp) const {
-  FrameList::const_iterator it = find(timestamp);
-  if (it == end())
+  FrameList::const_iterator it = LowerBound(timestamp);
+  if (it == end() || it->first != timestamp)
     return NULL;
   return it->second;
 }
 
 VCMFrameBuffer* FrameList::PopFrame(uint32_t timestamp) {
-  FrameList::iterator it = find(timestamp);
-  if (it == end())
+  FrameList::iterator it = LowerBound(timestamp);
+  if (it == end() || it->first != timestamp)
     return NULL;
   VCMFrameBuffer* frame = it->second;
-  erase(it);
+  frames_.erase(it);
   return frame;
 }
 
 VCMFrameBuffer* FrameList::Front() const {
-  return begin()->second;
+  return frames_.front().second;
 }
 
 VCMFrameBuffer* FrameList::Back() const {
-  return rbegin()->second;
+  return frames_.back().second;
 }
 
 int FrameList::RecycleFramesUntilKeyFrame(FrameList::iterator* key_frame_it) {
-  int drop_count = 0;
-  FrameList::iterator it = begin();
-  while (!empty()) {
-    // Throw at least one frame.
+  // Throw at least one frame, and all frames up to the next key frame.
+  iterator it = begin();
+  while (it != end()) {
     WEBRTC_TRACE(webrtc::kTraceWarning, webrtc::kTraceVideoCoding, -1,
                  "Recycling: type=%s, low seqnum=%u",
                  it->second->FrameType() == kVideoFrameKey ?
@@ -81,23 +107,23 @@ int FrameList::RecycleFramesUntilKeyFrame(FrameList::iterator* key_frame_it) {
     if (it->second->GetState() != kStateDecoding) {
       it->second->SetState(kStateFree);
     }
-    erase(it++);
-    ++drop_count;
+    ++it;
     if (it != end() && it->second->FrameType() == kVideoFrameKey) {
-      *key_frame_it = it;
-      return drop_count;
+      break;
     }
   }
-  *key_frame_it = end();
+  const int drop_count = static_cast<int>(it - begin());
+  // Drop the frames with a single move of the remaining ones.
+  *key_frame_it = frames_.erase(begin(), it);
   return drop_count;
 }
 
 int FrameList::CleanUpOldOrEmptyFrames(VCMDecodingState* decoding_state) {
-  int drop_count = 0;
-  while (!empty()) {
-    VCMFrameBuffer* oldest_frame = Front();
+  iterator it = begin();
+  for (; it != end(); ++it) {
+    VCMFrameBuffer* oldest_frame = it->second;
     bool remove_frame = false;
-    if (oldest_frame->GetState() == kStateEmpty && size() > 1) {
+    if (oldest_frame->GetState() == kStateEmpty && end() - it > 1) {
       // This frame is empty, try to update the last decoded state and drop it
       // if successful.
       remove_frame = decoding_state->UpdateEmptyFrame(oldest_frame);
@@ -110,11 +136,11 @@ int FrameList::CleanUpOldOrEmptyFrames(VCMDecodingState* decoding_state) {
     if (oldest_frame->GetState() != kStateDecoding) {
       oldest_frame->SetState(kStateFree);
     }
-    ++drop_count;
     TRACE_EVENT_INSTANT1("webrtc", "JB::OldOrEmptyFrameDropped", "timestamp",
                          oldest_frame->TimeStamp());
-    erase(begin());
   }
+  const int drop_count = static_cast<int>(it - begin());
+  frames_.erase(begin(), it);
   if (empty()) {
     TRACE_EVENT_INSTANT1("webrtc", "JB::FrameListEmptied",
                          "type", "CleanUpOldOrEmptyFrames");
@@ -143,11 +169,8 @@ VCMJitterBuffer::VCMJitterBuffer(Clock* clock,
       first_packet_since_reset_(true),
       num_not_decodable_packets_(0),
       receive_statistics_(),
-      incoming_frame_rate_(0),
-      incoming_frame_count_(0),
-      time_last_incoming_frame_count_(0),
-      incoming_bit_count_(0),
-      incoming_bit_rate_(0),
+      incoming_frames_(kRateWindowMs, kRateBucketMs),
+      incoming_bits_(kRateWindowMs, kRateBucketMs),
       drop_count_(0),
       num_consecutive_old_frames_(0),
       num_consecutive_old_packets_(0),
@@ -158,7 +181,7 @@ VCMJitterBuffer::VCMJitterBuffer(Clock* clock,
       nack_mode_(kNoNack),
       low_rtt_nack_threshold_ms_(-1),
       high_rtt_nack_threshold_ms_(-1),
-      missing_sequence_numbers_(SequenceNumberLessThan()),
+      missing_sequence_numbers_(),
       nack_seq_nums_(),
       max_nack_list_size_(0),
       max_packet_age_to_nack_(0),
@@ -191,11 +214,8 @@ void VCMJitterBuffer::CopyFrom(const VCMJitterBuffer& rhs) {
     running_ = rhs.running_;
     master_ = !rhs.master_;
     max_number_of_frames_ = rhs.max_number_of_frames_;
-    incoming_frame_rate_ = rhs.incoming_frame_rate_;
-    incoming_frame_count_ = rhs.incoming_frame_count_;
-    time_last_incoming_frame_count_ = rhs.time_last_incoming_frame_count_;
-    incoming_bit_count_ = rhs.incoming_bit_count_;
-    incoming_bit_rate_ = rhs.incoming_bit_rate_;
+    incoming_frames_ = rhs.incoming_frames_;
+    incoming_bits_ = rhs.incoming_bits_;
     drop_count_ = rhs.drop_count_;
     num_consecutive_old_frames_ = rhs.num_consecutive_old_frames_;
     num_consecutive_old_packets_ = rhs.num_consecutive_old_packets_;
@@ -227,15 +247,13 @@ void VCMJitterBuffer::CopyFrom(const VCMJitterBuffer& rhs) {
     for (FrameList::const_iterator it = rhs.decodable_frames_.begin();
          it != rhs.decodable_frames_.end(); ++it, ++i) {
       frame_buffers_[i] = new VCMFrameBuffer(*it->second);
-      decodable_frames_.insert(decodable_frames_.rbegin().base(),
-          FrameListPair(frame_buffers_[i]->TimeStamp(), frame_buffers_[i]));
+      decodable_frames_.InsertFrame(frame_buffers_[i]);
     }
     incomplete_frames_.clear();
     for (FrameList::const_iterator it = rhs.incomplete_frames_.begin();
          it != rhs.incomplete_frames_.end(); ++it, ++i) {
       frame_buffers_[i] = new VCMFrameBuffer(*it->second);
-      incomplete_frames_.insert(incomplete_frames_.rbegin().base(),
-          FrameListPair(frame_buffers_[i]->TimeStamp(), frame_buffers_[i]));
+      incomplete_frames_.InsertFrame(frame_buffers_[i]);
     }
     rhs.crit_sect_->Leave();
     crit_sect_->Leave();
@@ -245,11 +263,8 @@ void VCMJitterBuffer::CopyFrom(const VCMJitterBuffer& rhs) {
 void VCMJitterBuffer::Start() {
   CriticalSectionScoped cs(crit_sect_);
   running_ = true;
-  incoming_frame_count_ = 0;
-  incoming_frame_rate_ = 0;
-  incoming_bit_count_ = 0;
-  incoming_bit_rate_ = 0;
-  time_last_incoming_frame_count_ = clock_->TimeInMilliseconds();
+  incoming_frames_.Reset(clock_->TimeInMilliseconds());
+  incoming_bits_.Reset(clock_->TimeInMilliseconds());
   memset(receive_statistics_, 0, sizeof(receive_statistics_));
 
   num_consecutive_old_frames_ = 0;
@@ -322,7 +337,7 @@ void VCMJitterBuffer::Flush() {
   waiting_for_completion_.timestamp = 0;
   waiting_for_completion_.latest_packet_time = -1;
   first_packet_since_reset_ = true;
-  missing_sequence_numbers_.clear();
+  missing_sequence_numbers_.Clear();
   WEBRTC_TRACE(webrtc::kTraceDebug, webrtc::kTraceVideoCoding,
                VCMId(vcm_id_, receiver_id_), "JB(0x%x): Jitter buffer: flush",
                this);
@@ -355,58 +370,10 @@ void VCMJitterBuffer::IncomingRateStatistics(unsigned int* framerate,
   assert(bitrate);
   CriticalSectionScoped cs(crit_sect_);
   const int64_t now = clock_->TimeInMilliseconds();
-  int64_t diff = now - time_last_incoming_frame_count_;
-  if (diff < 1000 && incoming_frame_rate_ > 0 && incoming_bit_rate_ > 0) {
-    // Make sure we report something even though less than
-    // 1 second has passed since last update.
-    *framerate = incoming_frame_rate_;
-    *bitrate = incoming_bit_rate_;
-  } else if (incoming_frame_count_ != 0) {
-    // We have received frame(s) since last call to this function
-
-    // Prepare calculations
-    if (diff <= 0) {
-      diff = 1;
-    }
-    // we add 0.5f for rounding
-    float rate = 0.5f + ((incoming_frame_count_ * 1000.0f) / diff);
-    if (rate < 1.0f) {
-      rate = 1.0f;
-    }
-
-    // Calculate frame rate
-    // Let r be rate.
-    // r(0) = 1000*framecount/delta_time.
-    // (I.e. frames per second since last calculation.)
-    // frame_rate = r(0)/2 + r(-1)/2
-    // (I.e. fr/s average this and the previous calculation.)
-    *framerate = (incoming_frame_rate_ + static_cast<unsigned int>(rate)) / 2;
-    incoming_frame_rate_ = static_cast<unsigned int>(rate);
-
-    // Calculate bit rate
-    if (incoming_bit_count_ == 0) {
-      *bitrate = 0;
-    } else {
-      *bitrate = 10 * ((100 * incoming_bit_count_) /
-                       static_cast<unsigned int>(diff));
-    }
-    incoming_bit_rate_ = *bitrate;
-
-    // Reset count
-    incoming_frame_count_ = 0;
-    incoming_bit_count_ = 0;
-    time_last_incoming_frame_count_ = now;
-
-  } else {
-    // No frames since last call
-    time_last_incoming_frame_count_ = clock_->TimeInMilliseconds();
-    *framerate = 0;
-    *bitrate = 0;
-    incoming_frame_rate_ = 0;
-    incoming_bit_rate_ = 0;
-  }
-  TRACE_COUNTER1("webrtc", "JBIncomingFramerate", incoming_frame_rate_);
-  TRACE_COUNTER1("webrtc", "JBIncomingBitrate", incoming_bit_rate_);
+  *framerate = incoming_frames_.Rate(kRateWindowMs, now);
+  *bitrate = incoming_bits_.Rate(kRateWindowMs, now);
+  TRACE_COUNTER1("webrtc", "JBIncomingFramerate", *framerate);
+  TRACE_COUNTER1("webrtc", "JBIncomingBitrate", *bitrate);
 }
 
 // Answers the question:
@@ -706,7 +673,7 @@ VCMFrameBufferEnum VCMJitterBuffer::InsertPacket(const VCMPacket& packet,
                                       rtt_ms_);
   ret = buffer_return;
   if (buffer_return > 0) {
-    incoming_bit_count_ += packet.sizeBytes << 3;
+    incoming_bits_.Update(packet.sizeBytes << 3, now_ms);
     if (first_packet_since_reset_) {
       latest_received_sequence_number_ = packet.seqNum;
       first_packet_since_reset_ = false;
@@ -832,7 +799,7 @@ void VCMJitterBuffer::FindAndInsertContinuousFrames(
     }
     if (IsContinuousInState(*frame, decoding_state)) {
       decodable_frames_.InsertFrame(frame);
-      incomplete_frames_.erase(it++);
+      it = incomplete_frames_.erase(it);
       decoding_state.SetState(frame);
     } else if (frame->TemporalId() <= 0) {
       break;
@@ -873,7 +840,7 @@ void VCMJitterBuffer::SetNackMode(VCMNackMode mode,
   CriticalSectionScoped cs(crit_sect_);
   nack_mode_ = mode;
   if (mode == kNoNack) {
-    missing_sequence_numbers_.clear();
+    missing_sequence_numbers_.Clear();
   }
   assert(low_rtt_nack_threshold_ms >= -1 && high_rtt_nack_threshold_ms >= -1);
   assert(high_rtt_nack_threshold_ms == -1 ||
@@ -993,12 +960,8 @@ uint16_t* VCMJitterBuffer::GetNackList(uint16_t* nack_list_size,
       }
     }
   }
-  unsigned int i = 0;
-  SequenceNumberSet::iterator it = missing_sequence_numbers_.begin();
-  for (; it != missing_sequence_numbers_.end(); ++it, ++i) {
-    nack_seq_nums_[i] = *it;
-  }
-  *nack_list_size = i;
+  missing_sequence_numbers_.CopyTo(&nack_seq_nums_[0]);
+  *nack_list_size = missing_sequence_numbers_.size();
   return &nack_seq_nums_[0];
 }
 
@@ -1023,10 +986,11 @@ bool VCMJitterBuffer::UpdateNackList(uint16_t sequence_number) {
   if (IsNewerSequenceNumber(sequence_number,
                             latest_received_sequence_number_)) {
     // Push any missing sequence numbers to the NACK list.
-    for (uint16_t i = latest_received_sequence_number_ + 1;
-         IsNewerSequenceNumber(sequence_number, i); ++i) {
-      missing_sequence_numbers_.insert(missing_sequence_numbers_.end(), i);
-      TRACE_EVENT_INSTANT1("webrtc", "AddNack", "seqnum", i);
+    const uint16_t first_missing = latest_received_sequence_number_ + 1;
+    if (first_missing != sequence_number) {
+      missing_sequence_numbers_.InsertRange(first_missing, sequence_number);
+      TRACE_EVENT_INSTANT2("webrtc", "AddNack", "first_seqnum", first_missing,
+                           "last_seqnum", sequence_number - 1);
     }
     if (TooLargeNackList() && !HandleTooLargeNackList()) {
       return false;
@@ -1036,7 +1000,7 @@ bool VCMJitterBuffer::UpdateNackList(uint16_t sequence_number) {
       return false;
     }
   } else {
-    missing_sequence_numbers_.erase(sequence_number);
+    missing_sequence_numbers_.Erase(sequence_number);
     TRACE_EVENT_INSTANT1("webrtc", "RemoveNack", "seqnum", sequence_number);
   }
   return true;
@@ -1064,7 +1028,7 @@ bool VCMJitterBuffer::MissingTooOldPacket(
     return false;
   }
   const uint16_t age_of_oldest_missing_packet = latest_sequence_number -
-      *missing_sequence_numbers_.begin();
+      missing_sequence_numbers_.Front();
   // Recycle frames if the NACK list contains too old sequence numbers as
   // the packets may have already been dropped by the sender.
   return age_of_oldest_missing_packet > max_packet_age_to_nack_;
@@ -1073,7 +1037,7 @@ bool VCMJitterBuffer::MissingTooOldPacket(
 bool VCMJitterBuffer::HandleTooOldPackets(uint16_t latest_sequence_number) {
   bool key_frame_found = false;
   const uint16_t age_of_oldest_missing_packet = latest_sequence_number -
-      *missing_sequence_numbers_.begin();
+      missing_sequence_numbers_.Front();
   LOG_F(LS_INFO) << "NACK list contains too old sequence numbers: " <<
       age_of_oldest_missing_packet << " > " << max_packet_age_to_nack_;
   while (MissingTooOldPacket(latest_sequence_number)) {
@@ -1088,9 +1052,7 @@ void VCMJitterBuffer::DropPacketsFromNackList(
                       "seqnum", last_decoded_sequence_number);
   // Erase all sequence numbers from the NACK list which we won't need any
   // longer.
-  missing_sequence_numbers_.erase(missing_sequence_numbers_.begin(),
-                                  missing_sequence_numbers_.upper_bound(
-                                      last_decoded_sequence_number));
+  missing_sequence_numbers_.EraseUpTo(last_decoded_sequence_number);
 }
 
 int64_t VCMJitterBuffer::LastDecodedTimestamp() const {
@@ -1179,7 +1141,7 @@ bool VCMJitterBuffer::RecycleFramesUntilKeyFrame() {
     DropPacketsFromNackList(EstimatedLowSequenceNumber(*key_frame_it->second));
   } else if (decodable_frames_.empty()) {
     last_decoded_state_.Reset();  // TODO(mikhal): No sync.
-    missing_sequence_numbers_.clear();
+    missing_sequence_numbers_.Clear();
   }
   return key_frame_found;
 }
@@ -1199,7 +1161,7 @@ void VCMJitterBuffer::UpdateFrameState(VCMFrameBuffer* frame) {
   bool frame_counted = false;
   if (!frame->GetCountedFrame()) {
     // Ignore ACK frames.
-    incoming_frame_count_++;
+    incoming_frames_.Update(1, clock_->TimeInMilliseconds());
     frame->SetCountedFrame(true);
     frame_counted = true;
   }
@@ -1265,8 +1227,7 @@ void VCMJitterBuffer::VerifyAndSetPreviousFrameLost(VCMFrameBuffer* frame) {
 
 // Must be called from within |crit_sect_|.
 bool VCMJitterBuffer::IsPacketRetransmitted(const VCMPacket& packet) const {
-  return missing_sequence_numbers_.find(packet.seqNum) !=
-      missing_sequence_numbers_.end();
+  return missing_sequence_numbers_.Contains(packet.seqNum);
 }
 
 // Must be called under the critical section |crit_sect_|. Should never be
@@ -11,8 +11,7 @@
 #ifndef WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_JITTER_BUFFER_H_
 #define WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_JITTER_BUFFER_H_
 
-#include <map>
-#include <set>
+#include <utility>
 #include <vector>
 
 #include "webrtc/modules/interface/module_common_types.h"
@@ -21,8 +20,10 @@
 #include "webrtc/modules/video_coding/main/source/inter_frame_delay.h"
 #include "webrtc/modules/video_coding/main/source/jitter_buffer_common.h"
 #include "webrtc/modules/video_coding/main/source/jitter_estimator.h"
+#include "webrtc/modules/video_coding/main/source/sequence_number_bitset.h"
 #include "webrtc/system_wrappers/interface/constructor_magic.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/rate_counter.h"
 #include "webrtc/typedefs.h"
 
 namespace webrtc {
@@ -47,17 +48,35 @@ struct VCMJitterSample {
   int64_t latest_packet_time;
 };
 
-class TimestampLessThan {
- public:
-  bool operator() (const uint32_t& timestamp1,
-                   const uint32_t& timestamp2) const {
-    return IsNewerTimestamp(timestamp2, timestamp1);
-  }
-};
+typedef std::pair<uint32_t, VCMFrameBuffer*> FrameListPair;
 
-class FrameList :
-  public std::map<uint32_t, VCMFrameBuffer*, TimestampLessThan> {
+// Frames ordered by timestamp, stored in a flat array which is allocated once
+// for kMaxNumberOfFrames frames. New frames are usually the newest ones and
+// decoded frames the oldest, so inserts and pops are cheap moves at the ends.
+class FrameList {
  public:
+  typedef std::vector<FrameListPair>::iterator iterator;
+  typedef std::vector<FrameListPair>::const_iterator const_iterator;
+  typedef std::vector<FrameListPair>::reverse_iterator reverse_iterator;
+  typedef std::vector<FrameListPair>::const_reverse_iterator
+      const_reverse_iterator;
+
+  FrameList();
+
+  iterator begin() { return frames_.begin(); }
+  const_iterator begin() const { return frames_.begin(); }
+  iterator end() { return frames_.end(); }
+  const_iterator end() const { return frames_.end(); }
+  reverse_iterator rbegin() { return frames_.rbegin(); }
+  const_reverse_iterator rbegin() const { return frames_.rbegin(); }
+  reverse_iterator rend() { return frames_.rend(); }
+  const_reverse_iterator rend() const { return frames_.rend(); }
+  bool empty() const { return frames_.empty(); }
+  size_t size() const { return frames_.size(); }
+  void clear() { frames_.clear(); }
+  // Returns the iterator following the erased frame.
+  iterator erase(iterator it) { return frames_.erase(it); }
+
   void InsertFrame(VCMFrameBuffer* frame);
   VCMFrameBuffer* FindFrame(uint32_t timestamp) const;
   VCMFrameBuffer* PopFrame(uint32_t timestamp);
@@ -65,6 +84,13 @@ class FrameList :
   VCMFrameBuffer* Back() const;
   int RecycleFramesUntilKeyFrame(FrameList::iterator* key_frame_it);
   int CleanUpOldOrEmptyFrames(VCMDecodingState* decoding_state);
+
+ private:
+  // Returns the first frame which isn't older than |timestamp|.
+  iterator LowerBound(uint32_t timestamp);
+  const_iterator LowerBound(uint32_t timestamp) const;
+
+  std::vector<FrameListPair> frames_;
 };
 
 class VCMJitterBuffer {
@@ -103,7 +129,7 @@ class VCMJitterBuffer {
   // Gets number of packets discarded by the jitter buffer.
   int num_discarded_packets() const;
 
-  // Statistics, Calculate frame and bit rates.
+  // Statistics, frame and bit rates over the last second.
   void IncomingRateStatistics(unsigned int* framerate,
                               unsigned int* bitrate);
 
@@ -182,15 +208,6 @@ class VCMJitterBuffer {
   void RenderBufferSize(uint32_t* timestamp_start, uint32_t* timestamp_end);
 
  private:
-  class SequenceNumberLessThan {
-   public:
-    bool operator() (const uint16_t& sequence_number1,
-                     const uint16_t& sequence_number2) const {
-      return IsNewerSequenceNumber(sequence_number2, sequence_number1);
-    }
-  };
-  typedef std::set<uint16_t, SequenceNumberLessThan> SequenceNumberSet;
-
   // Gets the frame assigned to the timestamp of the packet. May recycle
   // existing frames if no free frames are available. Returns an error code if
   // failing, or kNoError on success.
@@ -293,12 +310,9 @@ class VCMJitterBuffer {
   int num_not_decodable_packets_;
   // Frame counter for each type (key, delta, golden, key-delta).
   unsigned int receive_statistics_[4];
-  // Latest calculated frame rates of incoming stream.
-  unsigned int incoming_frame_rate_;
-  unsigned int incoming_frame_count_;
-  int64_t time_last_incoming_frame_count_;
-  unsigned int incoming_bit_count_;
-  unsigned int incoming_bit_rate_;
+  // Complete frames and bits of the incoming stream.
+  RateCounter incoming_frames_;
+  RateCounter incoming_bits_;
   unsigned int drop_count_;  // Frame drop counter.
   // Number of frames in a row that have been too old.
   int num_consecutive_old_frames_;
@@ -320,7 +334,7 @@ class VCMJitterBuffer {
   int low_rtt_nack_threshold_ms_;
   int high_rtt_nack_threshold_ms_;
   // Holds the internal NACK list (the missing sequence numbers).
-  SequenceNumberSet missing_sequence_numbers_;
+  SequenceNumberBitset missing_sequence_numbers_;
   uint16_t latest_received_sequence_number_;
   std::vector<uint16_t> nack_seq_nums_;
   size_t max_nack_list_size_;
@@ -8,6 +8,7 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
 #include <string.h>
 
 #include <list>
@@ -20,6 +21,7 @@
 #include "webrtc/modules/video_coding/main/source/stream_generator.h"
 #include "webrtc/modules/video_coding/main/test/test_util.h"
 #include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 namespace webrtc {
 
@@ -1437,19 +1439,20 @@ TEST_F(TestRunningJitterBuffer, StatisticsTest) {
     InsertFrame(kVideoFrameDelta);
   }
   jitter_buffer_->IncomingRateStatistics(&framerate, &bitrate);
-  // TODO(holmer): The current implementation returns the average of the last
-  // two framerate calculations, which is why it takes two calls to reach the
-  // actual framerate. This should be fixed.
-  EXPECT_EQ(kDefaultFrameRate / 2u, framerate);
+  EXPECT_EQ(kDefaultFrameRate, framerate);
   EXPECT_EQ(kDefaultBitrateKbps, bitrate);
-  // Insert 25 more frames to get estimates of bitrate and framerate over
-  // 2 seconds.
+  // Insert 25 more frames. The estimates are over the last second.
   for (int i = 0; i < 25; ++i) {
     InsertFrame(kVideoFrameDelta);
   }
   jitter_buffer_->IncomingRateStatistics(&framerate, &bitrate);
   EXPECT_EQ(kDefaultFrameRate, framerate);
   EXPECT_EQ(kDefaultBitrateKbps, bitrate);
+  // No frames during the last second.
+  clock_->AdvanceTimeMilliseconds(1100);
+  jitter_buffer_->IncomingRateStatistics(&framerate, &bitrate);
+  EXPECT_EQ(0u, framerate);
+  EXPECT_EQ(0u, bitrate);
 }
 
 TEST_F(TestRunningJitterBuffer, SkipToKeyFrame) {
@@ -1809,4 +1812,45 @@ TEST_F(TestJitterBufferNack, NormalOperationWrap2) {
   EXPECT_EQ(65535, list[0]);
 }
 
+// Benchmark for inserting packets of a lossy stream and building the NACK
+// list after every frame.
+TEST_F(TestJitterBufferNack, DISABLED_InsertPacketAndNackListBenchmark) {
+  const int kNumFrames = 10000;
+  const int kPacketsPerFrame = 10;
+  // Frames kept in the jitter buffer before one is decoded.
+  const int kFramesInBuffer = 5;
+  jitter_buffer_->DecodeWithErrors(true);
+  EXPECT_GE(InsertFrame(kVideoFrameKey), kNoError);
+  EXPECT_TRUE(DecodeCompleteFrame());
+
+  int num_packets = 0;
+  int total_nack_list_size = 0;
+  TickTime start = TickTime::Now();
+  for (int i = 0; i < kNumFrames; ++i) {
+    stream_generator_->GenerateFrame(kVideoFrameDelta, kPacketsPerFrame, 0,
+                                     clock_->TimeInMilliseconds());
+    while (stream_generator_->PacketsRemaining() > 0) {
+      if (stream_generator_->NextSequenceNumber() % 23 == 0) {
+        stream_generator_->NextPacket(NULL);  // Drop packet
+      } else {
+        InsertPacketAndPop(0);
+        ++num_packets;
+      }
+    }
+    uint16_t nack_list_size = 0;
+    bool request_key_frame = false;
+    jitter_buffer_->GetNackList(&nack_list_size, &request_key_frame);
+    total_nack_list_size += nack_list_size;
+    clock_->AdvanceTimeMilliseconds(kDefaultFramePeriodMs);
+    if (i >= kFramesInBuffer) {
+      DecodeIncompleteFrame();
+    }
+  }
+  double total_time_us = (TickTime::Now() - start).Microseconds();
+  printf("Inserted %d packets in %.2fms, %.3fus per packet. The NACK list "
+         "held %.1f packets on average.\n", num_packets, total_time_us / 1000,
+         total_time_us / num_packets,
+         static_cast<double>(total_nack_list_size) / kNumFrames);
+}
+
 }  // namespace webrtc
@@ -0,0 +1,191 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_coding/main/source/sequence_number_bitset.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace webrtc {
+
+namespace {
+
+int CountBits(uint64_t word) {
+  word = word - ((word >> 1) & 0x5555555555555555ULL);
+  word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+  word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+}
+
+// |word| must not be zero.
+int CountTrailingZeros(uint64_t word) {
+  return CountBits((word & (~word + 1)) - 1);
+}
+
+// Returns the mask of |count| bits starting at |bit|.
+uint64_t BitMask(int bit, int count) {
+  const uint64_t ones = count == 64 ? ~0ULL : (1ULL << count) - 1;
+  return ones << bit;
+}
+
+}  // namespace
+
+SequenceNumberBitset::SequenceNumberBitset()
+    : first_(0),
+      span_(0),
+      size_(0) {
+  memset(bits_, 0, sizeof(bits_));
+}
+
+uint16_t SequenceNumberBitset::Front() const {
+  assert(!empty());
+  return first_;
+}
+
+bool SequenceNumberBitset::Contains(uint16_t sequence_number) const {
+  if (Offset(sequence_number) >= span_) {
+    return false;
+  }
+  const int index = sequence_number & (kWindowSize - 1);
+  return (bits_[index >> 6] >> (index & 63)) & 1;
+}
+
+void SequenceNumberBitset::InsertRange(uint16_t first, uint16_t last) {
+  int count = static_cast<uint16_t>(last - first);
+  if (count == 0) {
+    return;
+  }
+  if (count > kWindowSize) {
+    first = static_cast<uint16_t>(last - kWindowSize);
+    count = kWindowSize;
+  }
+  if (empty()) {
+    // All bits are already cleared.
+    first_ = first;
+    span_ = 0;
+  }
+  int offset = Offset(first);
+  const int overflow = offset + count - kWindowSize;
+  if (overflow > 0) {
+    // Make room by dropping the oldest sequence numbers.
+    size_ -= ClearBits(0, std::min(overflow, span_));
+    first_ = static_cast<uint16_t>(first_ + overflow);
+    span_ = std::max(span_ - overflow, 0);
+    offset -= overflow;
+  }
+
+  int index = (first_ + offset) & (kWindowSize - 1);
+  int remaining = count;
+  while (remaining > 0) {
+    const int bit = index & 63;
+    const int num_bits = std::min(64 - bit, remaining);
+    const uint64_t mask = BitMask(bit, num_bits);
+    uint64_t* word = &bits_[index >> 6];
+    size_ += CountBits(mask & ~*word);
+    *word |= mask;
+    remaining -= num_bits;
+    index = (index + num_bits) & (kWindowSize - 1);
+  }
+  span_ = std::max(span_, offset + count);
+  if (overflow > 0) {
+    AdvanceToFront();
+  }
+}
+
+void SequenceNumberBitset::Erase(uint16_t sequence_number) {
+  const int offset = Offset(sequence_number);
+  if (offset >= span_ || ClearBits(offset, 1) == 0) {
+    return;
+  }
+  --size_;
+  if (offset == 0) {
+    AdvanceToFront();
+  }
+}
+
+void SequenceNumberBitset::EraseUpTo(uint16_t sequence_number) {
+  if (empty()) {
+    return;
+  }
+  const int offset = Offset(sequence_number);
+  if (offset >= kWindowSize) {
+    // Older than all members.
+    return;
+  }
+  size_ -= ClearBits(0, std::min(offset + 1, span_));
+  AdvanceToFront();
+}
+
+void SequenceNumberBitset::Clear() {
+  ClearBits(0, span_);
+  span_ = 0;
+  size_ = 0;
+}
+
+void SequenceNumberBitset::CopyTo(uint16_t* sequence_numbers) const {
+  int index = first_ & (kWindowSize - 1);
+  int remaining = span_;
+  while (remaining > 0) {
+    const int bit = index & 63;
+    const int num_bits = std::min(64 - bit, remaining);
+    uint64_t word = bits_[index >> 6] & BitMask(bit, num_bits);
+    const uint16_t word_sequence_number =
+        static_cast<uint16_t>(first_ + (span_ - remaining) - bit);
+    while (word != 0) {
+      *sequence_numbers++ = static_cast<uint16_t>(
+          word_sequence_number + CountTrailingZeros(word));
+      word &= word - 1;
+    }
+    remaining -= num_bits;
+    index = (index + num_bits) & (kWindowSize - 1);
+  }
+}
+
+size_t SequenceNumberBitset::ClearBits(uint16_t offset, int count) {
+  size_t num_cleared = 0;
+  int index = (first_ + offset) & (kWindowSize - 1);
+  while (count > 0) {
+    const int bit = index & 63;
+    const int num_bits = std::min(64 - bit, count);
+    const uint64_t mask = BitMask(bit, num_bits);
+    uint64_t* word = &bits_[index >> 6];
+    num_cleared += CountBits(*word & mask);
+    *word &= ~mask;
+    count -= num_bits;
+    index = (index + num_bits) & (kWindowSize - 1);
+  }
+  return num_cleared;
+}
+
+void SequenceNumberBitset::AdvanceToFront() {
+  if (empty()) {
+    span_ = 0;
+    return;
+  }
+  int index = first_ & (kWindowSize - 1);
+  int offset = 0;
+  while (offset < span_) {
+    const int bit = index & 63;
+    const uint64_t word = bits_[index >> 6] & BitMask(bit, 64 - bit);
+    if (word != 0) {
+      offset += CountTrailingZeros(word) - bit;
+      break;
+    }
+    offset += 64 - bit;
+    index = (index + 64 - bit) & (kWindowSize - 1);
+  }
+  assert(offset < span_);
+  first_ = static_cast<uint16_t>(first_ + offset);
+  span_ -= offset;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_SEQUENCE_NUMBER_BITSET_H_
+#define WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_SEQUENCE_NUMBER_BITSET_H_
+
+#include <stddef.h>
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// A set of RTP sequence numbers, ordered with wrap-around, which is stored as
+// a bit per sequence number in a fixed window following the oldest member.
+// Members are added in increasing ranges at the new end and removed one by
+// one or up to a sequence number at the old end, which is how the jitter
+// buffer tracks missing packets. No operation allocates memory.
+class SequenceNumberBitset {
+ public:
+  // Sequence numbers which are further apart than this can't be ordered.
+  enum { kWindowSize = 1 << 15 };
+
+  SequenceNumberBitset();
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+  // Returns the oldest member. Must not be called on an empty set.
+  uint16_t Front() const;
+
+  bool Contains(uint16_t sequence_number) const;
+
+  // Adds the sequence numbers from |first| up to but not including |last|.
+  // |first| must not be older than the oldest member. Members which end up
+  // more than kWindowSize older than |last| are dropped.
+  void InsertRange(uint16_t first, uint16_t last);
+
+  void Erase(uint16_t sequence_number);
+
+  // Erases all members which aren't newer than |sequence_number|.
+  void EraseUpTo(uint16_t sequence_number);
+
+  void Clear();
+
+  // Writes the members, oldest first, to |sequence_numbers|, which must have
+  // room for size() elements.
+  void CopyTo(uint16_t* sequence_numbers) const;
+
+ private:
+  enum { kNumWords = kWindowSize / 64 };
+
+  // Returns the offset of |sequence_number| from the oldest member, which is
+  // >= |span_| for sequence numbers outside the window.
+  uint16_t Offset(uint16_t sequence_number) const {
+    return static_cast<uint16_t>(sequence_number - first_);
+  }
+  // Clears the bits of the |count| sequence numbers starting at |offset| from
+  // the oldest member, and returns how many of them were set.
+  size_t ClearBits(uint16_t offset, int count);
+  // Moves |first_| to the oldest member left, or resets an empty set.
+  void AdvanceToFront();
+
+  uint64_t bits_[kNumWords];
+  // The sequence number at the start of the window, which is the oldest
+  // member if the set isn't empty.
+  uint16_t first_;
+  // Number of sequence numbers from |first_| to the newest member, inclusive.
+  int span_;
+  size_t size_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_SEQUENCE_NUMBER_BITSET_H_
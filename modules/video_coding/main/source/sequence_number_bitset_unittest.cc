@@ -0,0 +1,161 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdlib.h>
+
+#include <set>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/modules/video_coding/main/source/sequence_number_bitset.h"
+
+namespace webrtc {
+
+namespace {
+
+class SequenceNumberLessThan {
+ public:
+  bool operator() (const uint16_t& sequence_number1,
+                   const uint16_t& sequence_number2) const {
+    return IsNewerSequenceNumber(sequence_number2, sequence_number1);
+  }
+};
+
+// The ordered set the jitter buffer used before the bitset.
+typedef std::set<uint16_t, SequenceNumberLessThan> SequenceNumberSet;
+
+void ExpectEqual(const SequenceNumberSet& expected,
+                 const SequenceNumberBitset& bitset) {
+  ASSERT_EQ(expected.size(), bitset.size());
+  if (expected.empty()) {
+    return;
+  }
+  EXPECT_EQ(*expected.begin(), bitset.Front());
+  std::vector<uint16_t> members(bitset.size());
+  bitset.CopyTo(&members[0]);
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), members.begin()));
+}
+
+}  // namespace
+
+TEST(SequenceNumberBitsetTest, Empty) {
+  SequenceNumberBitset bitset;
+  EXPECT_TRUE(bitset.empty());
+  EXPECT_EQ(0u, bitset.size());
+  EXPECT_FALSE(bitset.Contains(0));
+  bitset.Erase(0);
+  bitset.EraseUpTo(100);
+  EXPECT_TRUE(bitset.empty());
+}
+
+TEST(SequenceNumberBitsetTest, InsertAndErase) {
+  SequenceNumberBitset bitset;
+  bitset.InsertRange(10, 20);
+  EXPECT_EQ(10u, bitset.size());
+  EXPECT_EQ(10, bitset.Front());
+  EXPECT_TRUE(bitset.Contains(10));
+  EXPECT_TRUE(bitset.Contains(19));
+  EXPECT_FALSE(bitset.Contains(9));
+  EXPECT_FALSE(bitset.Contains(20));
+
+  bitset.Erase(10);
+  EXPECT_EQ(11, bitset.Front());
+  bitset.Erase(15);
+  bitset.Erase(15);
+  EXPECT_EQ(8u, bitset.size());
+  EXPECT_FALSE(bitset.Contains(15));
+
+  bitset.EraseUpTo(16);
+  EXPECT_EQ(17, bitset.Front());
+  EXPECT_EQ(3u, bitset.size());
+
+  // Older than all members.
+  bitset.EraseUpTo(5);
+  EXPECT_EQ(3u, bitset.size());
+
+  bitset.Clear();
+  EXPECT_TRUE(bitset.empty());
+  EXPECT_FALSE(bitset.Contains(17));
+}
+
+TEST(SequenceNumberBitsetTest, Wrap) {
+  SequenceNumberBitset bitset;
+  bitset.InsertRange(65530, 65535);
+  bitset.InsertRange(0, 4);
+  EXPECT_EQ(9u, bitset.size());
+  EXPECT_EQ(65530, bitset.Front());
+  EXPECT_FALSE(bitset.Contains(65535));
+
+  uint16_t members[9];
+  bitset.CopyTo(members);
+  const uint16_t kExpected[] = {
+    65530, 65531, 65532, 65533, 65534, 0, 1, 2, 3
+  };
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_EQ(kExpected[i], members[i]);
+  }
+
+  bitset.EraseUpTo(1);
+  EXPECT_EQ(2, bitset.Front());
+  EXPECT_EQ(2u, bitset.size());
+}
+
+TEST(SequenceNumberBitsetTest, InsertBeyondWindowDropsOldest) {
+  SequenceNumberBitset bitset;
+  bitset.InsertRange(0, 10);
+  bitset.InsertRange(SequenceNumberBitset::kWindowSize + 5,
+                     SequenceNumberBitset::kWindowSize + 7);
+  // 0 to 6 are more than a window older than the last sequence number.
+  EXPECT_EQ(5u, bitset.size());
+  EXPECT_EQ(7, bitset.Front());
+  EXPECT_FALSE(bitset.Contains(6));
+  EXPECT_TRUE(bitset.Contains(SequenceNumberBitset::kWindowSize + 6));
+}
+
+// Runs the operations of the jitter buffer NACK list on the bitset and on an
+// ordered set, and compares them.
+TEST(SequenceNumberBitsetTest, MatchesOrderedSet) {
+  srand(1234);
+  SequenceNumberBitset bitset;
+  SequenceNumberSet expected;
+  uint16_t latest = 65000;
+  for (int i = 0; i < 20000; ++i) {
+    switch (rand() % 4) {
+      case 0: {
+        // Lose up to 20 packets.
+        const uint16_t first = latest + 1;
+        latest = first + rand() % 20;
+        bitset.InsertRange(first, latest);
+        for (uint16_t j = first; j != latest; ++j) {
+          expected.insert(j);
+        }
+        break;
+      }
+      case 1:
+      case 2: {
+        // Receive a retransmission or a reordered packet.
+        const uint16_t sequence_number = latest - rand() % 100;
+        bitset.Erase(sequence_number);
+        expected.erase(sequence_number);
+        break;
+      }
+      case 3: {
+        const uint16_t sequence_number = latest - 50 - rand() % 200;
+        bitset.EraseUpTo(sequence_number);
+        expected.erase(expected.begin(), expected.upper_bound(sequence_number));
+        break;
+      }
+    }
+    ASSERT_NO_FATAL_FAILURE(ExpectEqual(expected, bitset));
+  }
+}
+
+}  // namespace webrtc
@@ -44,6 +44,11 @@ class Atomic32 {
   bool CompareExchange(int32_t new_value, int32_t compare_value);
   int32_t Value() const;
 
+  // Reads the value, followed by a barrier which keeps the memory accesses
+  // after it from being reordered before the read. Use it to read a counter
+  // which publishes other data.
+  int32_t AcquireLoad() const;
+
  private:
   // Disable the + and - operator since it's unclear what these operations
   // should do.
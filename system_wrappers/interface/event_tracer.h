@@ -22,6 +22,10 @@
 //   provided.
 //
 // Parameters for the above two functions are described in trace_event.h.
+//
+// Alternatively, SetupInternalEventTracer() installs a built-in recorder,
+// which keeps the events in memory and writes them on demand in the JSON
+// format of Chrome's about:tracing.
 
 #ifndef WEBRTC_SYSTEM_WRAPPERS_INTERFACE_EVENT_TRACER_H_
 #define WEBRTC_SYSTEM_WRAPPERS_INTERFACE_EVENT_TRACER_H_
@@ -30,6 +34,8 @@
 
 namespace webrtc {
 
+class Clock;
+
 typedef const unsigned char* (*GetCategoryEnabledPtr)(const char* name);
 typedef void (*AddTraceEventPtr)(char phase,
                                  const unsigned char* category_enabled,
@@ -49,6 +55,21 @@ WEBRTC_DLLEXPORT void SetupEventTracer(
     GetCategoryEnabledPtr get_category_enabled_ptr,
     AddTraceEventPtr add_trace_event_ptr);
 
+// Sets up the built-in event recorder in place of SetupEventTracer(), with the
+// same restrictions. Events are time stamped by |clock|, or by the real-time
+// clock if NULL. Calls after the first have no effect.
+WEBRTC_DLLEXPORT void SetupInternalEventTracer(Clock* clock);
+
+// Starts recording events with the built-in recorder, discarding the events
+// of a previous capture, and stops recording them.
+WEBRTC_DLLEXPORT void StartInternalEventCapture();
+WEBRTC_DLLEXPORT void StopInternalEventCapture();
+
+// Writes the events recorded by the built-in recorder to |file_name|, as a
+// trace for Chrome's about:tracing. Can be called while capturing. Returns
+// false if the recorder isn't set up or the file can't be written.
+WEBRTC_DLLEXPORT bool DumpInternalEventCapture(const char* file_name);
+
 // This class defines interface for the event tracing system to call
 // internally. Do not call these methods directly.
 class EventTracer {
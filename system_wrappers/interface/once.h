@@ -0,0 +1,47 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Thread safe one-time initialization, e.g. of the function pointers picked
+// at run time from the CPU features. Usable from C.
+
+#ifndef WEBRTC_SYSTEM_WRAPPERS_INTERFACE_ONCE_H_
+#define WEBRTC_SYSTEM_WRAPPERS_INTERFACE_ONCE_H_
+
+#include "webrtc/typedefs.h"
+
+#if defined(WEBRTC_POSIX)
+#include <pthread.h>
+#endif
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+// State of one initialization. Must have static storage duration and be
+// initialized with WEBRTC_ONCE_INIT.
+#if defined(WEBRTC_POSIX)
+typedef pthread_once_t WebRtc_OnceState;
+#define WEBRTC_ONCE_INIT PTHREAD_ONCE_INIT
+#elif defined(_WIN32)
+typedef int WebRtc_OnceState;
+#define WEBRTC_ONCE_INIT 0
+#endif
+// There's no fallback for other platforms, to ensure thread safety. The build
+// system should pick it up.
+
+// Calls |func| the first time it is called with |state|, from whichever
+// thread gets there first. Other callers return once |func| has returned.
+void WebRtc_Once(WebRtc_OnceState* state, void (*func)(void));
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}  // extern "C"
+#endif
+
+#endif  // WEBRTC_SYSTEM_WRAPPERS_INTERFACE_ONCE_H_
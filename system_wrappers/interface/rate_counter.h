@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Sliding window counter of events such as bytes or packets.
+
+#ifndef WEBRTC_SYSTEM_WRAPPERS_INTERFACE_RATE_COUNTER_H_
+#define WEBRTC_SYSTEM_WRAPPERS_INTERFACE_RATE_COUNTER_H_
+
+#include <vector>
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// Counts events in time buckets of |bucket_ms|. Each bucket holds the running
+// total at its end, so the count over any window of up to |max_window_ms|
+// is the difference of two buckets. Update(), Count() and Rate() take
+// constant time, and the memory is max_window_ms / bucket_ms + 2 words.
+//
+// Not thread safe, but copyable. Times are in milliseconds and must not be
+// negative.
+class RateCounter {
+ public:
+  RateCounter(int max_window_ms, int bucket_ms);
+
+  // Forgets all events. Rates are computed over the time since |now_ms|
+  // until a full window has passed.
+  void Reset(int64_t now_ms);
+
+  // Adds |count| events at |now_ms|. Events older than the newest are added
+  // to the newest bucket. The counter starts at the first update if Reset()
+  // has not been called.
+  void Update(uint32_t count, int64_t now_ms);
+
+  // Returns the number of events in the last |window_ms|. The window starts
+  // at the beginning of the bucket |window_ms| before |now_ms|, and
+  // |window_ms| is capped to |max_window_ms|.
+  uint32_t Count(int window_ms, int64_t now_ms) const;
+
+  // Returns the events per second in the last |window_ms|, or since the
+  // start of the counter if that is shorter.
+  uint32_t Rate(int window_ms, int64_t now_ms) const;
+
+ private:
+  // Returns the running total at the end of |bucket|.
+  uint32_t TotalAt(int64_t bucket) const;
+  // Returns the bucket before the first of the window ending at |now_ms|.
+  int64_t WindowStart(int window_ms, int64_t now_ms) const;
+
+  int bucket_ms_;
+  int max_window_buckets_;
+  std::vector<uint32_t> totals_;
+  int64_t start_ms_;
+  int64_t newest_bucket_;
+  // Running total of all events. Wraps around; only differences are used.
+  uint32_t total_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_SYSTEM_WRAPPERS_INTERFACE_RATE_COUNTER_H_
@@ -75,7 +75,9 @@ class Trace {
   // part of the code the message is coming.
   // id is an identifier that should be unique for that set of classes that
   // are associated (e.g. all instances owned by an engine).
-  // msg and the ellipsis are the same as e.g. sprintf.
+  // msg and the ellipsis are the same as e.g. sprintf. Only the arguments
+  // are captured and msg is formatted later on the trace thread, so msg must
+  // outlive the trace, e.g. be a string literal.
   // TODO(hellner) Why is TraceModule not defined in this file?
   static void Add(const TraceLevel level,
                   const TraceModule module,
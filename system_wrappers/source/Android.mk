@@ -20,6 +20,7 @@ LOCAL_SRC_FILES := \
     android/cpu-features.c \
     cpu_features_android.c \
     map.cc \
+    rate_counter.cc \
     sort.cc \
     aligned_malloc.cc \
     atomic32_posix.cc \
@@ -28,9 +29,11 @@ LOCAL_SRC_FILES := \
     cpu_info.cc \
     critical_section.cc \
     event.cc \
+    event_trace_recorder.cc \
     event_tracer.cc \
     file_impl.cc \
     list_no_stl.cc \
+    once.cc \
     rw_lock.cc \
     thread.cc \
     condition_variable_posix.cc \
@@ -46,7 +49,9 @@ LOCAL_SRC_FILES := \
 ifeq ($(ENABLE_WEBRTC_TRACE), 1)
   LOCAL_SRC_FILES += \
     trace_impl.cc \
-    trace_posix.cc
+    trace_posix.cc \
+    trace_record.cc \
+    trace_ring_buffer.cc
 else
   LOCAL_SRC_FILES += \
     trace_impl_no_op.cc
@@ -54,4 +54,10 @@ int32_t Atomic32::Value() const {
   return value_;
 }
 
+int32_t Atomic32::AcquireLoad() const {
+  const int32_t value = *static_cast<const volatile int32_t*>(&value_);
+  __sync_synchronize();
+  return value;
+}
+
 } // namespace webrtc
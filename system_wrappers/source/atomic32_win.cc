@@ -63,4 +63,10 @@ int32_t Atomic32::Value() const {
   return value_;
 }
 
+int32_t Atomic32::AcquireLoad() const {
+  const int32_t value = *reinterpret_cast<const volatile LONG*>(&value_);
+  MemoryBarrier();
+  return value;
+}
+
 }  // namespace webrtc
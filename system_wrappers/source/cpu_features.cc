@@ -44,10 +44,45 @@ static inline void __cpuid(int cpu_info[4], int info_type) {
     : "a"(info_type));
 }
 #endif
+
+// Intrinsic for "cpuid" with a sub-leaf, needed for the extended features.
+#if defined(__pic__) && defined(__i386__)
+static inline void __cpuidex(int cpu_info[4], int info_type, int sub_type) {
+  __asm__ volatile(
+    "mov %%ebx, %%edi\n"
+    "cpuid\n"
+    "xchg %%edi, %%ebx\n"
+    : "=a"(cpu_info[0]), "=D"(cpu_info[1]), "=c"(cpu_info[2]), "=d"(cpu_info[3])
+    : "a"(info_type), "c"(sub_type));
+}
+#else
+static inline void __cpuidex(int cpu_info[4], int info_type, int sub_type) {
+  __asm__ volatile(
+    "cpuid\n"
+    : "=a"(cpu_info[0]), "=b"(cpu_info[1]), "=c"(cpu_info[2]), "=d"(cpu_info[3])
+    : "a"(info_type), "c"(sub_type));
+}
+#endif
+
+// Intrinsic for "xgetbv", reading an extended control register.
+static inline uint64_t _xgetbv(uint32_t xcr) {
+  uint32_t eax, edx;
+  __asm__ volatile(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(xcr));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+}
 #endif  // _MSC_VER
 #endif  // WEBRTC_ARCH_X86_FAMILY
 
 #if defined(WEBRTC_ARCH_X86_FAMILY)
+// Returns true if the CPU supports AVX and the OS saves the YMM registers
+// (OSXSAVE and XCR0 bits 1 and 2). All features using the YMM registers
+// depend on it. |cpu_info| is the result of cpuid leaf 1.
+static bool AvxEnabled(const int cpu_info[4]) {
+  const int kOsxsaveAndAvx = 0x18000000;
+  return (cpu_info[2] & kOsxsaveAndAvx) == kOsxsaveAndAvx &&
+      (_xgetbv(0) & 0x6) == 0x6;
+}
+
 // Actual feature detection for x86.
 static int GetCPUInfo(CPUFeature feature) {
   int cpu_info[4];
@@ -58,6 +93,20 @@ static int GetCPUInfo(CPUFeature feature) {
   if (feature == kSSE3) {
     return 0 != (cpu_info[2] & 0x00000001);
   }
+  if (feature == kAVX) {
+    return AvxEnabled(cpu_info);
+  }
+  if (feature == kAVX2) {
+    if (!AvxEnabled(cpu_info)) {
+      return 0;
+    }
+    __cpuid(cpu_info, 0);
+    if (cpu_info[0] < 7) {
+      return 0;
+    }
+    __cpuidex(cpu_info, 7, 0);
+    return 0 != (cpu_info[1] & 0x00000020);
+  }
   return 0;
 }
 #else
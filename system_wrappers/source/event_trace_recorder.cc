@@ -0,0 +1,378 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/system_wrappers/source/event_trace_recorder.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+#include <assert.h>
+#include <float.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/trace_event.h"
+
+#ifdef _WIN32
+#define snprintf _snprintf
+#endif
+
+namespace webrtc {
+
+namespace {
+
+// The TRACE_EVENT macros pass at most two arguments.
+const int kMaxArgs = 2;
+
+// Returned for categories beyond kMaxCategories, which are never enabled.
+const unsigned char kCategoryDisabled = 0;
+
+void AppendJsonString(const char* string, std::string* json) {
+  json->push_back('"');
+  for (const char* p = string; *p != '\0'; ++p) {
+    const unsigned char c = static_cast<unsigned char>(*p);
+    if (c == '"' || c == '\\') {
+      json->push_back('\\');
+      json->push_back(c);
+    } else if (c < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      json->append(escaped);
+    } else {
+      json->push_back(c);
+    }
+  }
+  json->push_back('"');
+}
+
+}  // namespace
+
+struct EventTraceRecorder::Event {
+  // Strings recorded by pointer are assumed to be literals. The rest are
+  // copied: the name and argument names with TRACE_EVENT_FLAG_COPY, and the
+  // argument values of TRACE_VALUE_TYPE_COPY_STRING.
+  const char* Name() const {
+    return (flags & TRACE_EVENT_FLAG_COPY) ? copied_name.c_str() : name;
+  }
+  const char* ArgName(int i) const {
+    return (flags & TRACE_EVENT_FLAG_COPY) ? copied_arg_names[i].c_str()
+                                           : arg_names[i];
+  }
+
+  static bool Earlier(const Event& a, const Event& b) {
+    return a.time_us < b.time_us;
+  }
+
+  int64_t time_us;
+  uint32_t thread_id;
+  char phase;
+  unsigned char flags;
+  const char* category;
+  const char* name;
+  unsigned long long id;
+  int num_args;
+  const char* arg_names[kMaxArgs];
+  unsigned char arg_types[kMaxArgs];
+  unsigned long long arg_values[kMaxArgs];
+  std::string copied_name;
+  std::string copied_arg_names[kMaxArgs];
+  std::string copied_arg_values[kMaxArgs];
+};
+
+// The events of one thread, kept in a circular buffer. Only the owning thread
+// adds events; |crit_| makes the buffer safe to read from the dumping thread.
+class EventTraceRecorder::ThreadBuffer {
+ public:
+  explicit ThreadBuffer(uint32_t thread_id)
+      : crit_(CriticalSectionWrapper::CreateCriticalSection()),
+        thread_id_(thread_id),
+        oldest_(0) {}
+
+  CriticalSectionWrapper* crit() { return crit_.get(); }
+  uint32_t thread_id() const { return thread_id_; }
+
+  // Returns the slot for a new event, which overwrites the oldest one when
+  // the buffer is full. Must be called with crit() held.
+  Event* NextEvent() {
+    if (events_.size() < static_cast<size_t>(kEventsPerThread)) {
+      events_.push_back(Event());
+      return &events_.back();
+    }
+    Event* event = &events_[oldest_];
+    oldest_ = (oldest_ + 1) % kEventsPerThread;
+    return event;
+  }
+
+  void Clear() {
+    CriticalSectionScoped lock(crit_.get());
+    events_.clear();
+    oldest_ = 0;
+  }
+
+  // Appends the events, oldest first, to |events|.
+  void CopyTo(std::vector<Event>* events) {
+    CriticalSectionScoped lock(crit_.get());
+    events->insert(events->end(), events_.begin() + oldest_, events_.end());
+    events->insert(events->end(), events_.begin(), events_.begin() + oldest_);
+  }
+
+ private:
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  const uint32_t thread_id_;
+  std::vector<Event> events_;
+  int oldest_;
+};
+
+EventTraceRecorder::EventTraceRecorder(Clock* clock)
+    : clock_(clock),
+      crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      num_categories_(0),
+      capturing_(0) {
+#if defined(_WIN32)
+  thread_buffer_key_ = TlsAlloc();
+  assert(thread_buffer_key_ != TLS_OUT_OF_INDEXES);
+#else
+  const int result = pthread_key_create(&thread_buffer_key_, NULL);
+  assert(result == 0);
+  (void)result;
+#endif
+  memset(category_names_, 0, sizeof(category_names_));
+  memset(category_enabled_, 0, sizeof(category_enabled_));
+}
+
+EventTraceRecorder::~EventTraceRecorder() {
+#if defined(_WIN32)
+  TlsFree(thread_buffer_key_);
+#else
+  pthread_key_delete(thread_buffer_key_);
+#endif
+  for (size_t i = 0; i < thread_buffers_.size(); ++i) {
+    delete thread_buffers_[i];
+  }
+}
+
+const unsigned char* EventTraceRecorder::GetCategoryEnabled(const char* name) {
+  CriticalSectionScoped lock(crit_.get());
+  for (int i = 0; i < num_categories_; ++i) {
+    if (strcmp(category_names_[i], name) == 0) {
+      return &category_enabled_[i];
+    }
+  }
+  if (num_categories_ == kMaxCategories) {
+    return &kCategoryDisabled;
+  }
+  category_names_[num_categories_] = name;
+  category_enabled_[num_categories_] = capturing() ? 1 : 0;
+  return &category_enabled_[num_categories_++];
+}
+
+void EventTraceRecorder::AddTraceEvent(char phase,
+                                       const unsigned char* category_enabled,
+                                       const char* name,
+                                       unsigned long long id,
+                                       int num_args,
+                                       const char** arg_names,
+                                       const unsigned char* arg_types,
+                                       const unsigned long long* arg_values,
+                                       unsigned char flags) {
+  // The category flag may have been read before StopCapture().
+  if (!capturing()) {
+    return;
+  }
+  ThreadBuffer* buffer = GetThreadBuffer();
+  const int64_t time_us = clock_->TimeInMicroseconds();
+
+  CriticalSectionScoped lock(buffer->crit());
+  Event* event = buffer->NextEvent();
+  event->time_us = time_us;
+  event->thread_id = buffer->thread_id();
+  event->phase = phase;
+  event->flags = flags;
+  event->category = CategoryName(category_enabled);
+  event->name = name;
+  event->id = id;
+  event->num_args = std::min(num_args, kMaxArgs);
+  if (flags & TRACE_EVENT_FLAG_COPY) {
+    event->copied_name.assign(name);
+  }
+  for (int i = 0; i < event->num_args; ++i) {
+    event->arg_names[i] = arg_names[i];
+    event->arg_types[i] = arg_types[i];
+    event->arg_values[i] = arg_values[i];
+    if (flags & TRACE_EVENT_FLAG_COPY) {
+      event->copied_arg_names[i].assign(arg_names[i]);
+    }
+    if (arg_types[i] == TRACE_VALUE_TYPE_COPY_STRING) {
+      event->copied_arg_values[i].assign(
+          reinterpret_cast<const char*>(arg_values[i]));
+    }
+  }
+}
+
+void EventTraceRecorder::StartCapture() {
+  CriticalSectionScoped lock(crit_.get());
+  for (size_t i = 0; i < thread_buffers_.size(); ++i) {
+    thread_buffers_[i]->Clear();
+  }
+  capturing_.CompareExchange(1, 0);
+  SetCategoriesEnabled(1);
+}
+
+void EventTraceRecorder::StopCapture() {
+  CriticalSectionScoped lock(crit_.get());
+  capturing_.CompareExchange(0, 1);
+  SetCategoriesEnabled(0);
+}
+
+void EventTraceRecorder::DumpAsJson(std::string* json) {
+  std::vector<Event> events;
+  {
+    CriticalSectionScoped lock(crit_.get());
+    for (size_t i = 0; i < thread_buffers_.size(); ++i) {
+      thread_buffers_[i]->CopyTo(&events);
+    }
+  }
+  std::stable_sort(events.begin(), events.end(), &Event::Earlier);
+
+  json->assign("{\"traceEvents\":[");
+  char number[64];
+  for (size_t i = 0; i < events.size(); ++i) {
+    const Event& event = events[i];
+    if (i > 0) {
+      json->push_back(',');
+    }
+    json->append("\n{\"name\":");
+    AppendJsonString(event.Name(), json);
+    json->append(",\"cat\":");
+    AppendJsonString(event.category, json);
+    snprintf(number, sizeof(number),
+             ",\"ph\":\"%c\",\"ts\":%lld,\"pid\":0,\"tid\":%u",
+             event.phase, static_cast<long long>(event.time_us),
+             event.thread_id);
+    json->append(number);
+    if (event.flags & TRACE_EVENT_FLAG_HAS_ID) {
+      snprintf(number, sizeof(number), ",\"id\":\"0x%llx\"", event.id);
+      json->append(number);
+    }
+    json->append(",\"args\":{");
+    for (int j = 0; j < event.num_args; ++j) {
+      if (j > 0) {
+        json->push_back(',');
+      }
+      AppendJsonString(event.ArgName(j), json);
+      json->push_back(':');
+      const unsigned long long value = event.arg_values[j];
+      switch (event.arg_types[j]) {
+        case TRACE_VALUE_TYPE_BOOL:
+          json->append(value ? "true" : "false");
+          break;
+        case TRACE_VALUE_TYPE_UINT:
+          snprintf(number, sizeof(number), "%llu", value);
+          json->append(number);
+          break;
+        case TRACE_VALUE_TYPE_INT:
+          snprintf(number, sizeof(number), "%lld",
+                   static_cast<long long>(value));
+          json->append(number);
+          break;
+        case TRACE_VALUE_TYPE_DOUBLE: {
+          double double_value;
+          memcpy(&double_value, &value, sizeof(double_value));
+          // JSON has no NaN or infinity.
+          if (double_value != double_value || double_value > DBL_MAX ||
+              double_value < -DBL_MAX) {
+            json->append("null");
+          } else {
+            snprintf(number, sizeof(number), "%.17g", double_value);
+            json->append(number);
+          }
+          break;
+        }
+        case TRACE_VALUE_TYPE_POINTER:
+          snprintf(number, sizeof(number), "\"0x%llx\"", value);
+          json->append(number);
+          break;
+        case TRACE_VALUE_TYPE_STRING:
+          AppendJsonString(reinterpret_cast<const char*>(value), json);
+          break;
+        case TRACE_VALUE_TYPE_COPY_STRING:
+          AppendJsonString(event.copied_arg_values[j].c_str(), json);
+          break;
+        default:
+          json->append("null");
+          break;
+      }
+    }
+    json->append("}}");
+  }
+  json->append("\n]}\n");
+}
+
+bool EventTraceRecorder::DumpAsJson(const char* file_name) {
+  std::string json;
+  DumpAsJson(&json);
+  FILE* file = fopen(file_name, "w");
+  if (file == NULL) {
+    return false;
+  }
+  const bool written = fwrite(json.data(), 1, json.size(), file) ==
+      json.size();
+  return fclose(file) == 0 && written;
+}
+
+EventTraceRecorder::ThreadBuffer* EventTraceRecorder::GetThreadBuffer() {
+#if defined(_WIN32)
+  ThreadBuffer* buffer =
+      static_cast<ThreadBuffer*>(TlsGetValue(thread_buffer_key_));
+#else
+  ThreadBuffer* buffer =
+      static_cast<ThreadBuffer*>(pthread_getspecific(thread_buffer_key_));
+#endif
+  if (buffer != NULL) {
+    return buffer;
+  }
+  // The buffer is kept after the thread ends, for its events to be dumped.
+  buffer = new ThreadBuffer(ThreadWrapper::GetThreadId());
+  {
+    CriticalSectionScoped lock(crit_.get());
+    thread_buffers_.push_back(buffer);
+  }
+#if defined(_WIN32)
+  TlsSetValue(thread_buffer_key_, buffer);
+#else
+  pthread_setspecific(thread_buffer_key_, buffer);
+#endif
+  return buffer;
+}
+
+const char* EventTraceRecorder::CategoryName(
+    const unsigned char* category_enabled) const {
+  const ptrdiff_t index = category_enabled - category_enabled_;
+  if (index < 0 || index >= kMaxCategories) {
+    return "";
+  }
+  // Names are only ever added, before their flag is handed out.
+  return category_names_[index];
+}
+
+void EventTraceRecorder::SetCategoriesEnabled(unsigned char enabled) {
+  for (int i = 0; i < num_categories_; ++i) {
+    category_enabled_[i] = enabled;
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,100 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_SYSTEM_WRAPPERS_SOURCE_EVENT_TRACE_RECORDER_H_
+#define WEBRTC_SYSTEM_WRAPPERS_SOURCE_EVENT_TRACE_RECORDER_H_
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+#include <string>
+#include <vector>
+
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class Clock;
+class CriticalSectionWrapper;
+
+// In-process backend for the TRACE_EVENT macros of trace_event.h. Each thread
+// records into its own buffer, so tracing threads only take a lock which is
+// uncontended except while dumping. Each buffer keeps the latest
+// kEventsPerThread events. The events are dumped in the JSON format of
+// Chrome's about:tracing.
+class EventTraceRecorder {
+ public:
+  enum { kMaxCategories = 64 };
+  enum { kEventsPerThread = 4096 };
+
+  // |clock| must outlive the recorder.
+  explicit EventTraceRecorder(Clock* clock);
+  ~EventTraceRecorder();
+
+  // Returns the enabled flag of category |name|, which stays valid for the
+  // lifetime of the recorder. All categories are enabled while capturing.
+  const unsigned char* GetCategoryEnabled(const char* name);
+
+  // Records an event, with the arguments of EventTracer::AddTraceEvent().
+  void AddTraceEvent(char phase,
+                     const unsigned char* category_enabled,
+                     const char* name,
+                     unsigned long long id,
+                     int num_args,
+                     const char** arg_names,
+                     const unsigned char* arg_types,
+                     const unsigned long long* arg_values,
+                     unsigned char flags);
+
+  // Discards the recorded events and enables all categories.
+  void StartCapture();
+  // Disables all categories. The recorded events are kept for dumping.
+  void StopCapture();
+  bool capturing() const { return capturing_.Value() != 0; }
+
+  // Writes the recorded events, in time order, as a JSON trace.
+  void DumpAsJson(std::string* json);
+  // Returns false if |file_name| can't be written.
+  bool DumpAsJson(const char* file_name);
+
+ private:
+  struct Event;
+  class ThreadBuffer;
+
+  ThreadBuffer* GetThreadBuffer();
+  const char* CategoryName(const unsigned char* category_enabled) const;
+  void SetCategoriesEnabled(unsigned char enabled);
+
+  Clock* const clock_;
+  // Thread local storage key of the calling thread's buffer.
+#if defined(_WIN32)
+  unsigned long thread_buffer_key_;
+#else
+  pthread_key_t thread_buffer_key_;
+#endif
+
+  // Protects the category names and |thread_buffers_|.
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  const char* category_names_[kMaxCategories];
+  unsigned char category_enabled_[kMaxCategories];
+  int num_categories_;
+  Atomic32 capturing_;
+  std::vector<ThreadBuffer*> thread_buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(EventTraceRecorder);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_SYSTEM_WRAPPERS_SOURCE_EVENT_TRACE_RECORDER_H_
@@ -0,0 +1,194 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/system_wrappers/source/event_trace_recorder.h"
+
+#include <stdio.h>
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/trace_event.h"
+
+namespace webrtc {
+namespace {
+
+class EventTraceRecorderTest : public ::testing::Test {
+ protected:
+  EventTraceRecorderTest()
+      : clock_(1000),
+        recorder_(&clock_) {}
+
+  void AddEvent(char phase, const unsigned char* category, const char* name) {
+    recorder_.AddTraceEvent(phase, category, name, 0, 0, NULL, NULL, NULL,
+                            TRACE_EVENT_FLAG_NONE);
+  }
+
+  std::string Dump() {
+    std::string json;
+    recorder_.DumpAsJson(&json);
+    return json;
+  }
+
+  SimulatedClock clock_;
+  EventTraceRecorder recorder_;
+};
+
+// Counts the occurrences of |pattern| in |text|.
+int Count(const std::string& text, const std::string& pattern) {
+  int count = 0;
+  for (size_t pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+TEST_F(EventTraceRecorderTest, EnablesCategoriesWhileCapturing) {
+  const unsigned char* before = recorder_.GetCategoryEnabled("before");
+  EXPECT_EQ(0, *before);
+  EXPECT_EQ(before, recorder_.GetCategoryEnabled("before"));
+
+  recorder_.StartCapture();
+  EXPECT_TRUE(recorder_.capturing());
+  EXPECT_NE(0, *before);
+  EXPECT_NE(0, *recorder_.GetCategoryEnabled("during"));
+
+  recorder_.StopCapture();
+  EXPECT_FALSE(recorder_.capturing());
+  EXPECT_EQ(0, *before);
+  EXPECT_EQ(0, *recorder_.GetCategoryEnabled("during"));
+}
+
+TEST_F(EventTraceRecorderTest, DisablesCategoriesBeyondMax) {
+  // Category names are kept by pointer.
+  char names[EventTraceRecorder::kMaxCategories + 1][8];
+  recorder_.StartCapture();
+  for (int i = 0; i <= EventTraceRecorder::kMaxCategories; ++i) {
+    sprintf(names[i], "c%d", i);
+    const unsigned char* enabled = recorder_.GetCategoryEnabled(names[i]);
+    EXPECT_EQ(i < EventTraceRecorder::kMaxCategories, *enabled != 0);
+  }
+}
+
+TEST_F(EventTraceRecorderTest, DumpsChromeJson) {
+  recorder_.StartCapture();
+  const unsigned char* category = recorder_.GetCategoryEnabled("webrtc");
+  AddEvent(TRACE_EVENT_PHASE_BEGIN, category, "Encode");
+  clock_.AdvanceTimeMicroseconds(250);
+
+  const char* arg_names[] = { "frame", "note" };
+  const unsigned char arg_types[] = { TRACE_VALUE_TYPE_INT,
+                                      TRACE_VALUE_TYPE_STRING };
+  const unsigned long long arg_values[] = {
+    static_cast<unsigned long long>(-3),
+    reinterpret_cast<unsigned long long>("say \"hi\"")
+  };
+  recorder_.AddTraceEvent(TRACE_EVENT_PHASE_END, category, "Encode", 0x2a, 2,
+                          arg_names, arg_types, arg_values,
+                          TRACE_EVENT_FLAG_HAS_ID);
+
+  const uint32_t tid = ThreadWrapper::GetThreadId();
+  char expected[512];
+  sprintf(expected,
+          "{\"traceEvents\":["
+          "\n{\"name\":\"Encode\",\"cat\":\"webrtc\",\"ph\":\"B\","
+          "\"ts\":1000,\"pid\":0,\"tid\":%u,\"args\":{}},"
+          "\n{\"name\":\"Encode\",\"cat\":\"webrtc\",\"ph\":\"E\","
+          "\"ts\":1250,\"pid\":0,\"tid\":%u,\"id\":\"0x2a\","
+          "\"args\":{\"frame\":-3,\"note\":\"say \\\"hi\\\"\"}}"
+          "\n]}\n", tid, tid);
+  EXPECT_EQ(expected, Dump());
+}
+
+TEST_F(EventTraceRecorderTest, CopiesStrings) {
+  recorder_.StartCapture();
+  const unsigned char* category = recorder_.GetCategoryEnabled("webrtc");
+  char name[] = "name";
+  char arg_name[] = "arg";
+  char arg_value[] = "value";
+  const char* arg_names[] = { arg_name };
+  const unsigned char arg_types[] = { TRACE_VALUE_TYPE_COPY_STRING };
+  const unsigned long long arg_values[] = {
+    reinterpret_cast<unsigned long long>(arg_value)
+  };
+  recorder_.AddTraceEvent(TRACE_EVENT_PHASE_INSTANT, category, name, 0, 1,
+                          arg_names, arg_types, arg_values,
+                          TRACE_EVENT_FLAG_COPY);
+  name[0] = arg_name[0] = arg_value[0] = 'X';
+
+  const std::string json = Dump();
+  EXPECT_EQ(1, Count(json, "\"name\":\"name\""));
+  EXPECT_EQ(1, Count(json, "\"arg\":\"value\""));
+}
+
+TEST_F(EventTraceRecorderTest, IgnoresEventsWhenNotCapturing) {
+  const unsigned char* category = recorder_.GetCategoryEnabled("webrtc");
+  AddEvent(TRACE_EVENT_PHASE_INSTANT, category, "before");
+  recorder_.StartCapture();
+  AddEvent(TRACE_EVENT_PHASE_INSTANT, category, "during");
+  recorder_.StopCapture();
+  AddEvent(TRACE_EVENT_PHASE_INSTANT, category, "after");
+
+  const std::string json = Dump();
+  EXPECT_EQ(0, Count(json, "before"));
+  EXPECT_EQ(1, Count(json, "during"));
+  EXPECT_EQ(0, Count(json, "after"));
+
+  // A new capture starts empty.
+  recorder_.StartCapture();
+  EXPECT_EQ(0, Count(Dump(), "during"));
+}
+
+TEST_F(EventTraceRecorderTest, KeepsLatestEventsPerThread) {
+  recorder_.StartCapture();
+  const unsigned char* category = recorder_.GetCategoryEnabled("webrtc");
+  AddEvent(TRACE_EVENT_PHASE_INSTANT, category, "oldest");
+  for (int i = 0; i < EventTraceRecorder::kEventsPerThread; ++i) {
+    clock_.AdvanceTimeMicroseconds(1);
+    AddEvent(TRACE_EVENT_PHASE_INSTANT, category, "newer");
+  }
+  const std::string json = Dump();
+  EXPECT_EQ(0, Count(json, "oldest"));
+  EXPECT_EQ(EventTraceRecorder::kEventsPerThread, Count(json, "newer"));
+}
+
+struct ThreadEvents {
+  EventTraceRecorder* recorder;
+  const unsigned char* category;
+};
+
+bool AddThreadEvent(void* obj) {
+  ThreadEvents* events = static_cast<ThreadEvents*>(obj);
+  events->recorder->AddTraceEvent(TRACE_EVENT_PHASE_INSTANT, events->category,
+                                  "thread", 0, 0, NULL, NULL, NULL,
+                                  TRACE_EVENT_FLAG_NONE);
+  return false;
+}
+
+TEST_F(EventTraceRecorderTest, RecordsEachThread) {
+  recorder_.StartCapture();
+  ThreadEvents events = { &recorder_, recorder_.GetCategoryEnabled("webrtc") };
+  for (int i = 0; i < 2; ++i) {
+    ThreadWrapper* thread = ThreadWrapper::CreateThread(&AddThreadEvent,
+                                                        &events);
+    unsigned int id = 0;
+    ASSERT_TRUE(thread->Start(id));
+    EXPECT_TRUE(thread->Stop());
+    delete thread;
+  }
+  // The events of ended threads are kept.
+  EXPECT_EQ(2, Count(Dump(), "\"name\":\"thread\""));
+}
+
+}  // namespace
+}  // namespace webrtc
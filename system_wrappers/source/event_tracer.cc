@@ -10,6 +10,9 @@
 
 #include "webrtc/system_wrappers/interface/event_tracer.h"
 
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/source/event_trace_recorder.h"
+
 namespace webrtc {
 
 namespace {
@@ -17,6 +20,28 @@ namespace {
 GetCategoryEnabledPtr g_get_category_enabled_ptr = 0;
 AddTraceEventPtr g_add_trace_event_ptr = 0;
 
+// Never deleted, since the trace event macros keep pointers to its category
+// flags.
+EventTraceRecorder* g_event_trace_recorder = 0;
+
+const unsigned char* InternalGetCategoryEnabled(const char* name) {
+  return g_event_trace_recorder->GetCategoryEnabled(name);
+}
+
+void InternalAddTraceEvent(char phase,
+                           const unsigned char* category_enabled,
+                           const char* name,
+                           unsigned long long id,
+                           int num_args,
+                           const char** arg_names,
+                           const unsigned char* arg_types,
+                           const unsigned long long* arg_values,
+                           unsigned char flags) {
+  g_event_trace_recorder->AddTraceEvent(phase, category_enabled, name, id,
+                                        num_args, arg_names, arg_types,
+                                        arg_values, flags);
+}
+
 }  // namespace
 
 void SetupEventTracer(GetCategoryEnabledPtr get_category_enabled_ptr,
@@ -25,6 +50,31 @@ void SetupEventTracer(GetCategoryEnabledPtr get_category_enabled_ptr,
   g_add_trace_event_ptr = add_trace_event_ptr;
 }
 
+void SetupInternalEventTracer(Clock* clock) {
+  if (g_event_trace_recorder) {
+    return;
+  }
+  g_event_trace_recorder =
+      new EventTraceRecorder(clock ? clock : Clock::GetRealTimeClock());
+  SetupEventTracer(&InternalGetCategoryEnabled, &InternalAddTraceEvent);
+}
+
+void StartInternalEventCapture() {
+  if (g_event_trace_recorder)
+    g_event_trace_recorder->StartCapture();
+}
+
+void StopInternalEventCapture() {
+  if (g_event_trace_recorder)
+    g_event_trace_recorder->StopCapture();
+}
+
+bool DumpInternalEventCapture(const char* file_name) {
+  if (!g_event_trace_recorder)
+    return false;
+  return g_event_trace_recorder->DumpAsJson(file_name);
+}
+
 // static
 const unsigned char* EventTracer::GetCategoryEnabled(const char* name) {
   if (g_get_category_enabled_ptr)
@@ -50,7 +50,8 @@ LogMessage::LogMessage(const char* file, int line, LoggingSeverity sev)
 
 LogMessage::~LogMessage() {
   const std::string& str = print_stream_.str();
-  WEBRTC_TRACE(WebRtcSeverity(severity_), kTraceUndefined, 0, str.c_str());
+  WEBRTC_TRACE(WebRtcSeverity(severity_), kTraceUndefined, 0, "%s",
+               str.c_str());
 }
 
 }  // namespace webrtc
@@ -0,0 +1,40 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/system_wrappers/interface/once.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+#if defined(WEBRTC_POSIX)
+void WebRtc_Once(WebRtc_OnceState* state, void (*func)(void)) {
+  pthread_once(state, func);
+}
+#elif defined(_WIN32)
+void WebRtc_Once(WebRtc_OnceState* state, void (*func)(void)) {
+  // Didn't use InitializeCriticalSection() since there's no race-free context
+  // in which to execute it. The lock is shared by all states; it's only
+  // contended on the first calls. Being recursive, it lets |func| initialize
+  // something else with WebRtc_Once().
+  //
+  // TODO(kma): Change to different implementation (e.g.
+  // InterlockedCompareExchangePointer) to avoid issues similar to
+  // http://code.google.com/p/webm/issues/detail?id=467.
+  static CRITICAL_SECTION lock = {(void*)((size_t)-1), -1, 0, 0, 0, 0};
+
+  EnterCriticalSection(&lock);
+  if (!*state) {
+    func();
+    *state = 1;
+  }
+  LeaveCriticalSection(&lock);
+}
+#endif
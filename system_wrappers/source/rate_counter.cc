@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/system_wrappers/interface/rate_counter.h"
+
+#include <assert.h>
+
+#include <algorithm>
+
+namespace webrtc {
+
+RateCounter::RateCounter(int max_window_ms, int bucket_ms)
+    : bucket_ms_(bucket_ms),
+      max_window_buckets_(max_window_ms / bucket_ms),
+      // One bucket before the window and the partial current bucket.
+      totals_(max_window_ms / bucket_ms + 2, 0),
+      start_ms_(-1),
+      newest_bucket_(-1),
+      total_(0) {
+  assert(bucket_ms > 0);
+  assert(max_window_ms >= bucket_ms);
+}
+
+void RateCounter::Reset(int64_t now_ms) {
+  assert(now_ms >= 0);
+  start_ms_ = now_ms;
+  newest_bucket_ = now_ms / bucket_ms_;
+  total_ = 0;
+  totals_[newest_bucket_ % totals_.size()] = 0;
+}
+
+void RateCounter::Update(uint32_t count, int64_t now_ms) {
+  if (start_ms_ < 0)
+    Reset(now_ms);
+  const int64_t bucket = now_ms / bucket_ms_;
+  if (bucket > newest_bucket_) {
+    // Nothing happened in the skipped buckets. Only the last totals_.size()
+    // of them can be read.
+    const int64_t first_bucket = std::max(
+        newest_bucket_ + 1, bucket - static_cast<int64_t>(totals_.size()) + 1);
+    for (int64_t b = first_bucket; b < bucket; ++b)
+      totals_[b % totals_.size()] = total_;
+    newest_bucket_ = bucket;
+  }
+  total_ += count;
+  totals_[newest_bucket_ % totals_.size()] = total_;
+}
+
+uint32_t RateCounter::Count(int window_ms, int64_t now_ms) const {
+  if (start_ms_ < 0)
+    return 0;
+  return total_ - TotalAt(WindowStart(window_ms, now_ms));
+}
+
+uint32_t RateCounter::Rate(int window_ms, int64_t now_ms) const {
+  if (start_ms_ < 0)
+    return 0;
+  const int64_t window_start = WindowStart(window_ms, now_ms);
+  const int64_t from_ms = std::max((window_start + 1) * bucket_ms_,
+                                   start_ms_);
+  const int64_t duration_ms = std::max<int64_t>(now_ms - from_ms, 1);
+  const uint64_t count = total_ - TotalAt(window_start);
+  return static_cast<uint32_t>(count * 1000 / duration_ms);
+}
+
+uint32_t RateCounter::TotalAt(int64_t bucket) const {
+  if (bucket < start_ms_ / bucket_ms_)
+    return 0;
+  if (bucket >= newest_bucket_)
+    return total_;
+  return totals_[bucket % totals_.size()];
+}
+
+int64_t RateCounter::WindowStart(int window_ms, int64_t now_ms) const {
+  const int window_buckets = std::min(window_ms / bucket_ms_,
+                                      max_window_buckets_);
+  const int64_t now_bucket = std::max(now_ms / bucket_ms_, newest_bucket_);
+  return now_bucket - window_buckets - 1;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/system_wrappers/interface/rate_counter.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace webrtc {
+
+TEST(RateCounterTest, EmptyCounter) {
+  RateCounter counter(1000, 10);
+  EXPECT_EQ(0u, counter.Count(1000, 0));
+  EXPECT_EQ(0u, counter.Rate(1000, 0));
+  counter.Reset(100);
+  EXPECT_EQ(0u, counter.Count(1000, 5000));
+  EXPECT_EQ(0u, counter.Rate(1000, 5000));
+}
+
+TEST(RateCounterTest, ConstantRate) {
+  RateCounter counter(1000, 10);
+  counter.Reset(0);
+  // 100 events every 20 ms is 5000 events per second.
+  for (int64_t now_ms = 0; now_ms < 5000; now_ms += 20) {
+    counter.Update(100, now_ms);
+    if (now_ms >= 20) {
+      EXPECT_NEAR(5000u, counter.Rate(1000, now_ms + 20), 100u);
+      EXPECT_NEAR(500u, counter.Rate(100, now_ms + 20) / 10, 10u);
+    }
+  }
+  EXPECT_EQ(5000u, counter.Count(1000, 5000));
+  EXPECT_EQ(500u, counter.Count(100, 5000));
+}
+
+TEST(RateCounterTest, RateSinceStart) {
+  RateCounter counter(1000, 10);
+  counter.Reset(1000);
+  counter.Update(500, 1000);
+  // Half a window has passed.
+  EXPECT_EQ(1000u, counter.Rate(1000, 1500));
+  EXPECT_EQ(500u, counter.Rate(1000, 2000));
+}
+
+TEST(RateCounterTest, StartsAtFirstUpdate) {
+  RateCounter counter(1000, 10);
+  counter.Update(100, 3000);
+  EXPECT_EQ(100u, counter.Count(1000, 3500));
+  EXPECT_EQ(200u, counter.Rate(1000, 3500));
+}
+
+TEST(RateCounterTest, OldEventsLeaveWindow) {
+  RateCounter counter(1000, 10);
+  counter.Reset(0);
+  counter.Update(100, 0);
+  counter.Update(200, 600);
+  EXPECT_EQ(300u, counter.Count(1000, 990));
+  EXPECT_EQ(200u, counter.Count(1000, 1010));
+  EXPECT_EQ(200u, counter.Count(500, 1000));
+  EXPECT_EQ(0u, counter.Count(1000, 1610));
+  // Long gap without updates.
+  counter.Update(50, 100000);
+  EXPECT_EQ(50u, counter.Count(1000, 100000));
+  EXPECT_EQ(50u, counter.Rate(1000, 101000));
+}
+
+TEST(RateCounterTest, WindowIsCappedToMax) {
+  RateCounter counter(500, 10);
+  counter.Reset(0);
+  counter.Update(100, 0);
+  counter.Update(100, 700);
+  EXPECT_EQ(100u, counter.Count(2000, 700));
+}
+
+TEST(RateCounterTest, LateEventsGoToNewestBucket) {
+  RateCounter counter(1000, 10);
+  counter.Reset(0);
+  counter.Update(100, 500);
+  counter.Update(100, 400);
+  EXPECT_EQ(200u, counter.Count(1000, 500));
+  EXPECT_EQ(200u, counter.Count(100, 550));
+}
+
+TEST(RateCounterTest, TotalWrapsAround) {
+  RateCounter counter(1000, 10);
+  counter.Reset(0);
+  counter.Update(0xFFFFFF00u, 0);
+  counter.Update(0x200u, 2000);
+  EXPECT_EQ(0x200u, counter.Count(1000, 2000));
+}
+
+}  // namespace webrtc
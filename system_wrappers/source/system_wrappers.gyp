@@ -41,6 +41,8 @@
         '../interface/list_wrapper.h',
         '../interface/logging.h',
         '../interface/map_wrapper.h',
+        '../interface/once.h',
+        '../interface/rate_counter.h',
         '../interface/ref_count.h',
         '../interface/rw_lock_wrapper.h',
         '../interface/scoped_ptr.h',
@@ -78,6 +80,8 @@
         'event.cc',
         'event_posix.cc',
         'event_posix.h',
+        'event_trace_recorder.cc',
+        'event_trace_recorder.h',
         'event_tracer.cc',
         'event_win.cc',
         'event_win.h',
@@ -87,6 +91,8 @@
         'logging.cc',
         'logging_no_op.cc',
         'map.cc',
+        'once.cc',
+        'rate_counter.cc',
         'rw_lock.cc',
         'rw_lock_generic.cc',
         'rw_lock_generic.h',
@@ -108,6 +114,10 @@
         'trace_impl_no_op.cc',
         'trace_posix.cc',
         'trace_posix.h',
+        'trace_record.cc',
+        'trace_record.h',
+        'trace_ring_buffer.cc',
+        'trace_ring_buffer.h',
         'trace_win.cc',
         'trace_win.h',
         '<(DEPTH)/client/threadpriorityhandler.cc',
@@ -130,6 +140,10 @@
             'trace_impl.h',
             'trace_posix.cc',
             'trace_posix.h',
+            'trace_record.cc',
+            'trace_record.h',
+            'trace_ring_buffer.cc',
+            'trace_ring_buffer.h',
             'trace_win.cc',
             'trace_win.h',
           ],
@@ -23,10 +23,12 @@
         'clock_unittest.cc',
         'condition_variable_unittest.cc',
         'critical_section_unittest.cc',
+        'event_trace_recorder_unittest.cc',
         'event_tracer_unittest.cc',
         'list_unittest.cc',
         'logging_unittest.cc',
         'map_unittest.cc',
+        'rate_counter_unittest.cc',
         'data_log_unittest.cc',
         'data_log_unittest_disabled.cc',
         'data_log_helpers_unittest.cc',
@@ -35,6 +37,8 @@
         'stringize_macros_unittest.cc',
         'thread_unittest.cc',
         'thread_posix_unittest.cc',
+        'trace_record_unittest.cc',
+        'trace_ring_buffer_unittest.cc',
         'unittest_utilities_unittest.cc',
       ],
       'conditions': [
@@ -46,6 +50,12 @@
         ['os_posix==0', {
           'sources!': [ 'thread_posix_unittest.cc', ],
         }],
+        ['enable_tracing==0', {
+          'sources!': [
+            'trace_record_unittest.cc',
+            'trace_ring_buffer_unittest.cc',
+          ],
+        }],
       ],
       # Disable warnings to enable Win64 build, issue 1323.
       'msvs_disabled_warnings': [
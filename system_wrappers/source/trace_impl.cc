@@ -24,6 +24,7 @@
 #endif  // _WIN32
 
 #include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/source/trace_record.h"
 
 #define KEY_LEN_CHARS 31
 
@@ -43,6 +44,13 @@ const int Trace::kTimestampLength = 12;
 
 static uint32_t level_filter = kTraceDefault;
 
+// How often the trace thread writes the recorded messages, unless woken up
+// earlier by an error or a filling buffer.
+static const unsigned long kWriteIntervalMs = 100;
+// The tracing threads wake up the trace thread each time this many records
+// have been written, well before the buffer fills up.
+static const int32_t kWakeUpIntervalRecords = WEBRTC_TRACE_MAX_QUEUE / 8;
+
 // Construct On First Use idiom. Avoids "static initialization order fiasco".
 TraceImpl* TraceImpl::StaticInstance(CountOperation count_operation,
                                      const TraceLevel level) {
@@ -80,24 +88,10 @@ TraceImpl::TraceImpl()
       thread_(*ThreadWrapper::CreateThread(TraceImpl::Run, this,
                                            kHighestPriority, "Trace")),
       event_(*EventWrapper::Create()),
-      critsect_array_(CriticalSectionWrapper::CreateCriticalSection()),
-      next_free_idx_(),
-      level_(),
-      length_(),
-      message_queue_(),
-      active_queue_(0) {
-  next_free_idx_[0] = 0;
-  next_free_idx_[1] = 0;
-
+      records_(WEBRTC_TRACE_MAX_QUEUE),
+      dropped_messages_(0) {
   unsigned int tid = 0;
   thread_.Start(tid);
-
-  for (int m = 0; m < WEBRTC_TRACE_NUM_ARRAY; ++m) {
-    for (int n = 0; n < WEBRTC_TRACE_MAX_QUEUE; ++n) {
-      message_queue_[m][n] = new
-      char[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
-    }
-  }
 }
 
 bool TraceImpl::StopThread() {
@@ -128,17 +122,10 @@ TraceImpl::~TraceImpl() {
   delete &trace_file_;
   delete &thread_;
   delete critsect_interface_;
-  delete critsect_array_;
-
-  for (int m = 0; m < WEBRTC_TRACE_NUM_ARRAY; ++m) {
-    for (int n = 0; n < WEBRTC_TRACE_MAX_QUEUE; ++n) {
-      delete [] message_queue_[m][n];
-    }
-  }
 }
 
-int32_t TraceImpl::AddThreadId(char* trace_message) const {
-  uint32_t thread_id = ThreadWrapper::GetThreadId();
+int32_t TraceImpl::AddThreadId(char* trace_message,
+                               const uint32_t thread_id) const {
   // Messages is 12 characters.
   return sprintf(trace_message, "%10u; ", thread_id);
 }
@@ -385,92 +372,46 @@ int32_t TraceImpl::SetTraceCallbackImpl(TraceCallback* callback) {
   return 0;
 }
 
-int32_t TraceImpl::AddMessage(
-    char* trace_message,
-    const char msg[WEBRTC_TRACE_MAX_MESSAGE_SIZE],
-    const uint16_t written_so_far) const {
-  int length = 0;
-  if (written_so_far >= WEBRTC_TRACE_MAX_MESSAGE_SIZE) {
+int32_t TraceImpl::FormatRecord(
+    const TraceRecord& record,
+    char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE]) const {
+  char* message_ptr = trace_message;
+  int32_t ack_len = 0;
+
+  int32_t len = AddLevel(message_ptr, record.level);
+  if (len == -1) {
     return -1;
   }
-  // - 2 to leave room for newline and NULL termination.
-#ifdef _WIN32
-  length = _snprintf(trace_message,
-                     WEBRTC_TRACE_MAX_MESSAGE_SIZE - written_so_far - 2,
-                     "%s", msg);
-  if (length < 0) {
-    length = WEBRTC_TRACE_MAX_MESSAGE_SIZE - written_so_far - 2;
-    trace_message[length] = 0;
-  }
-#else
-  length = snprintf(trace_message,
-                    WEBRTC_TRACE_MAX_MESSAGE_SIZE - written_so_far - 2,
-                    "%s", msg);
-  if (length < 0 ||
-      length > WEBRTC_TRACE_MAX_MESSAGE_SIZE - written_so_far - 2) {
-    length = WEBRTC_TRACE_MAX_MESSAGE_SIZE - written_so_far - 2;
-    trace_message[length] = 0;
-  }
-#endif
-  // Length with NULL termination.
-  return length + 1;
-}
+  message_ptr += len;
+  ack_len += len;
 
-void TraceImpl::AddMessageToList(
-    const char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE],
-    const uint16_t length,
-    const TraceLevel level) {
-// NOTE(andresp): Enabled externally.
-#ifdef WEBRTC_DIRECT_TRACE
-  if (callback_) {
-    callback_->Print(level, trace_message, length);
+  len = AddTime(message_ptr, record.level, record.time_us);
+  if (len == -1) {
+    return -1;
   }
-  return;
-#endif
+  message_ptr += len;
+  ack_len += len;
 
-  CriticalSectionScoped lock(critsect_array_);
-
-  if (next_free_idx_[active_queue_] >= WEBRTC_TRACE_MAX_QUEUE) {
-    if (!trace_file_.Open() && !callback_) {
-      // Keep at least the last 1/4 of old messages when not logging.
-      // TODO(hellner): isn't this redundant. The user will make it known
-      //                when to start logging. Why keep messages before
-      //                that?
-      for (int n = 0; n < WEBRTC_TRACE_MAX_QUEUE / 4; ++n) {
-        const int last_quarter_offset = (3 * WEBRTC_TRACE_MAX_QUEUE / 4);
-        memcpy(message_queue_[active_queue_][n],
-               message_queue_[active_queue_][n + last_quarter_offset],
-               WEBRTC_TRACE_MAX_MESSAGE_SIZE);
-      }
-      next_free_idx_[active_queue_] = WEBRTC_TRACE_MAX_QUEUE / 4;
-    } else {
-      // More messages are being written than there is room for in the
-      // buffer. Drop any new messages.
-      // TODO(hellner): its probably better to drop old messages instead
-      //                of new ones. One step further: if this happens
-      //                it's due to writing faster than what can be
-      //                processed. Maybe modify the filter at this point.
-      //                E.g. turn of STREAM.
-      return;
-    }
+  len = AddModuleAndId(message_ptr, record.module, record.id);
+  if (len == -1) {
+    return -1;
   }
+  message_ptr += len;
+  ack_len += len;
 
-  uint16_t idx = next_free_idx_[active_queue_];
-  next_free_idx_[active_queue_]++;
-
-  level_[active_queue_][idx] = level;
-  length_[active_queue_][idx] = length;
-  memcpy(message_queue_[active_queue_][idx], trace_message, length);
-
-  if (next_free_idx_[active_queue_] == WEBRTC_TRACE_MAX_QUEUE - 1) {
-    // Logging more messages than can be worked off. Log a warning.
-    const char warning_msg[] = "WARNING MISSING TRACE MESSAGES\n";
-    level_[active_queue_][next_free_idx_[active_queue_]] = kTraceWarning;
-    length_[active_queue_][next_free_idx_[active_queue_]] = strlen(warning_msg);
-    memcpy(message_queue_[active_queue_][next_free_idx_[active_queue_]],
-           warning_msg, strlen(warning_msg));
-    next_free_idx_[active_queue_]++;
+  len = AddThreadId(message_ptr, record.thread_id);
+  if (len < 0) {
+    return -1;
   }
+  message_ptr += len;
+  ack_len += len;
+
+  // - 1 to leave room for the newline which replaces the NULL termination
+  // when writing to file.
+  len = FormatTraceMessage(record, message_ptr,
+                           WEBRTC_TRACE_MAX_MESSAGE_SIZE - ack_len - 1);
+  // Length with NULL termination.
+  return ack_len + len + 1;
 }
 
 bool TraceImpl::Run(void* obj) {
@@ -478,16 +419,22 @@ bool TraceImpl::Run(void* obj) {
 }
 
 bool TraceImpl::Process() {
-  if (event_.Wait(1000) == kEventSignaled) {
-    // This slightly odd construction is to avoid locking |critsect_interface_|
-    // while calling WriteToFile() since it's locked inside the function.
-    critsect_interface_->Enter();
-    bool write_to_file = trace_file_.Open() || callback_;
-    critsect_interface_->Leave();
-    if (write_to_file) {
-      WriteToFile();
-    }
+  const bool signaled = event_.Wait(kWriteIntervalMs) == kEventSignaled;
+  // This slightly odd construction is to avoid locking |critsect_interface_|
+  // while calling WriteToFile() since it's locked inside the function.
+  critsect_interface_->Enter();
+  bool write_to_file = trace_file_.Open() || callback_;
+  critsect_interface_->Leave();
+  if (write_to_file) {
+    WriteToFile();
   } else {
+    // Keep the last 3/4 of the messages until someone listens.
+    while (records_.Size() > 3 * records_.capacity() / 4 &&
+           records_.BeginRead() != NULL) {
+      records_.EndRead();
+    }
+  }
+  if (!signaled) {
     CriticalSectionScoped lock(critsect_interface_);
     trace_file_.Flush();
   }
@@ -495,93 +442,90 @@ bool TraceImpl::Process() {
 }
 
 void TraceImpl::WriteToFile() {
-  uint8_t local_queue_active = 0;
-  uint16_t local_next_free_idx = 0;
-
-  // There are two buffers. One for reading (for writing to file) and one for
-  // writing (for storing new messages). Let new messages be posted to the
-  // unused buffer so that the current buffer can be flushed safely.
-  {
-    CriticalSectionScoped lock(critsect_array_);
-    local_next_free_idx = next_free_idx_[active_queue_];
-    next_free_idx_[active_queue_] = 0;
-    local_queue_active = active_queue_;
-    if (active_queue_ == 0) {
-      active_queue_ = 1;
-    } else {
-      active_queue_ = 0;
-    }
-  }
-  if (local_next_free_idx == 0) {
-    return;
-  }
-
   CriticalSectionScoped lock(critsect_interface_);
 
-  for (uint16_t idx = 0; idx < local_next_free_idx; ++idx) {
-    TraceLevel local_level = level_[local_queue_active][idx];
-    if (callback_) {
-      callback_->Print(local_level, message_queue_[local_queue_active][idx],
-                       length_[local_queue_active][idx]);
+  const int32_t dropped = dropped_messages_.Value();
+  if (dropped > 0) {
+    dropped_messages_ -= dropped;
+    // More messages are being traced than can be worked off.
+    char warning_msg[] = "WARNING MISSING TRACE MESSAGES";
+    WriteMessage(warning_msg, sizeof(warning_msg), kTraceWarning);
+  }
+
+  char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
+  const TraceRecord* record;
+  while ((record = records_.BeginRead()) != NULL) {
+    const int32_t length = FormatRecord(*record, trace_message);
+    const TraceLevel level = record->level;
+    // Free the slot before the slow part.
+    records_.EndRead();
+    if (length > 0) {
+      WriteMessage(trace_message, length, level);
     }
-    if (trace_file_.Open()) {
-      if (row_count_text_ > WEBRTC_TRACE_MAX_FILE_SIZE) {
-        // wrap file
-        row_count_text_ = 0;
-        trace_file_.Flush();
-
-        if (file_count_text_ == 0) {
-          trace_file_.Rewind();
-        } else {
-          char old_file_name[FileWrapper::kMaxFileNameSize];
-          char new_file_name[FileWrapper::kMaxFileNameSize];
-
-          // get current name
-          trace_file_.FileName(old_file_name,
-                               FileWrapper::kMaxFileNameSize);
-          trace_file_.CloseFile();
-
-          file_count_text_++;
-
-          UpdateFileName(old_file_name, new_file_name, file_count_text_);
-
-          if (trace_file_.OpenFile(new_file_name, false, false,
-                                   true) == -1) {
-            return;
-          }
+  }
+}
+
+void TraceImpl::WriteMessage(const char* trace_message, const int32_t length,
+                             const TraceLevel level) {
+  if (callback_) {
+    callback_->Print(level, trace_message, length);
+  }
+  if (trace_file_.Open()) {
+    if (row_count_text_ > WEBRTC_TRACE_MAX_FILE_SIZE) {
+      // wrap file
+      row_count_text_ = 0;
+      trace_file_.Flush();
+
+      if (file_count_text_ == 0) {
+        trace_file_.Rewind();
+      } else {
+        char old_file_name[FileWrapper::kMaxFileNameSize];
+        char new_file_name[FileWrapper::kMaxFileNameSize];
+
+        // get current name
+        trace_file_.FileName(old_file_name,
+                             FileWrapper::kMaxFileNameSize);
+        trace_file_.CloseFile();
+
+        file_count_text_++;
+
+        UpdateFileName(old_file_name, new_file_name, file_count_text_);
+
+        if (trace_file_.OpenFile(new_file_name, false, false,
+                                 true) == -1) {
+          return;
         }
       }
-      if (row_count_text_ ==  0) {
-        char message[WEBRTC_TRACE_MAX_MESSAGE_SIZE + 1];
-        int32_t length = AddDateTimeInfo(message);
-        if (length != -1) {
-          message[length] = 0;
-          message[length - 1] = '\n';
-          trace_file_.Write(message, length);
-          row_count_text_++;
-        }
-        length = AddBuildInfo(message);
-        if (length != -1) {
-          message[length + 1] = 0;
-          message[length] = '\n';
-          message[length - 1] = '\n';
-          trace_file_.Write(message, length + 1);
-          row_count_text_++;
-          row_count_text_++;
-        }
+    }
+    if (row_count_text_ ==  0) {
+      char message[WEBRTC_TRACE_MAX_MESSAGE_SIZE + 1];
+      int32_t length = AddDateTimeInfo(message);
+      if (length != -1) {
+        message[length] = 0;
+        message[length - 1] = '\n';
+        trace_file_.Write(message, length);
+        row_count_text_++;
+      }
+      length = AddBuildInfo(message);
+      if (length != -1) {
+        message[length + 1] = 0;
+        message[length] = '\n';
+        message[length - 1] = '\n';
+        trace_file_.Write(message, length + 1);
+        row_count_text_++;
+        row_count_text_++;
       }
-      uint16_t length = length_[local_queue_active][idx];
-      message_queue_[local_queue_active][idx][length] = 0;
-      message_queue_[local_queue_active][idx][length - 1] = '\n';
-      trace_file_.Write(message_queue_[local_queue_active][idx], length);
-      row_count_text_++;
     }
+    char message[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
+    memcpy(message, trace_message, length);
+    message[length - 1] = '\n';
+    trace_file_.Write(message, length);
+    row_count_text_++;
   }
 }
 
 void TraceImpl::AddImpl(const TraceLevel level, const TraceModule module,
-                        const int32_t id,
-                        const char msg[WEBRTC_TRACE_MAX_MESSAGE_SIZE]) {
+                        const int32_t id, const char* msg, va_list args) {
   if (TraceCheck(level)) {
 #ifdef WEBRTC_ANDROID_DEBUG
           int prio;
@@ -757,52 +701,55 @@ void TraceImpl::AddImpl(const TraceLevel level, const TraceModule module,
                   }
               }
 
-            __android_log_print(prio, modulename, msg);
+            __android_log_vprint(prio, modulename, msg, args);
 
 #else
-    char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
-    char* message_ptr = trace_message;
-
-    int32_t len = 0;
-    int32_t ack_len = 0;
-
-    len = AddLevel(message_ptr, level);
-    if (len == -1) {
-      return;
-    }
-    message_ptr += len;
-    ack_len += len;
-
-    len = AddTime(message_ptr, level);
-    if (len == -1) {
-      return;
-    }
-    message_ptr += len;
-    ack_len += len;
-
-    len = AddModuleAndId(message_ptr, module, id);
-    if (len == -1) {
+#ifdef WEBRTC_DIRECT_TRACE
+    // NOTE(andresp): Enabled externally.
+    TraceRecord record;
+    TraceRecord* record_ptr = &record;
+#else
+    int32_t position = 0;
+    TraceRecord* record_ptr = records_.BeginWrite(&position);
+    if (record_ptr == NULL) {
+      // More messages are being written than there is room for in the
+      // buffer. Drop any new messages.
+      // TODO(hellner): its probably better to drop old messages instead
+      //                of new ones. One step further: if this happens
+      //                it's due to writing faster than what can be
+      //                processed. Maybe modify the filter at this point.
+      //                E.g. turn of STREAM.
+      ++dropped_messages_;
+      event_.Set();
       return;
     }
-    message_ptr += len;
-    ack_len += len;
-
-    len = AddThreadId(message_ptr);
-    if (len < 0) {
-      return;
+#endif
+    // Only capture the message here; the trace thread formats it.
+    record_ptr->time_us = TimeInMicroseconds();
+    record_ptr->format = msg;
+    record_ptr->id = id;
+    record_ptr->thread_id = ThreadWrapper::GetThreadId();
+    record_ptr->level = level;
+    record_ptr->module = module;
+    PackTraceArguments(args, record_ptr);
+#ifdef WEBRTC_DIRECT_TRACE
+    if (callback_) {
+      char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
+      const int32_t length = FormatRecord(record, trace_message);
+      if (length > 0) {
+        callback_->Print(level, trace_message, length);
+      }
     }
-    message_ptr += len;
-    ack_len += len;
+#else
+    records_.EndWrite(position);
 
-    len = AddMessage(message_ptr, msg, (uint16_t)ack_len);
-    if (len == -1) {
-      return;
+    // Errors are written as soon as possible, and other messages before the
+    // buffer fills up.
+    if ((level & (kTraceError | kTraceCritical)) ||
+        (position & (kWakeUpIntervalRecords - 1)) == 0) {
+      event_.Set();
     }
-    ack_len += len;
-    AddMessageToList(trace_message, (uint16_t)ack_len, level);
-
-    // Make sure that messages are written as soon as possible.
-    event_.Set();
+#endif
 #endif
   }
 }
@@ -929,20 +876,10 @@ void Trace::Add(const TraceLevel level, const TraceModule module,
   TraceImpl* trace = TraceImpl::GetTrace(level);
   if (trace) {
     if (trace->TraceCheck(level)) {
-      char temp_buff[WEBRTC_TRACE_MAX_MESSAGE_SIZE];
-      char* buff = 0;
-      if (msg) {
-        va_list args;
-        va_start(args, msg);
-#ifdef _WIN32
-        _vsnprintf(temp_buff, WEBRTC_TRACE_MAX_MESSAGE_SIZE - 1, msg, args);
-#else
-        vsnprintf(temp_buff, WEBRTC_TRACE_MAX_MESSAGE_SIZE - 1, msg, args);
-#endif
-        va_end(args);
-        buff = temp_buff;
-      }
-      trace->AddImpl(level, module, id, buff);
+      va_list args;
+      va_start(args, msg);
+      trace->AddImpl(level, module, id, msg, args);
+      va_end(args);
     }
     ReturnTrace();
   }
@@ -11,30 +11,30 @@
 #ifndef WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_IMPL_H_
 #define WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_IMPL_H_
 
+#include <stdarg.h>
+
+#include "webrtc/system_wrappers/interface/atomic32.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/event_wrapper.h"
 #include "webrtc/system_wrappers/interface/file_wrapper.h"
 #include "webrtc/system_wrappers/interface/static_instance.h"
 #include "webrtc/system_wrappers/interface/thread_wrapper.h"
 #include "webrtc/system_wrappers/interface/trace.h"
+#include "webrtc/system_wrappers/source/trace_ring_buffer.h"
 
 namespace webrtc {
 
-// TODO(pwestin) WEBRTC_TRACE_MAX_QUEUE needs to be tweaked
+// Number of binary trace records buffered for the trace thread, which must be
+// a power of two. Each record takes about 256 bytes.
 // TODO(hellner) the buffer should be close to how much the system can write to
 //               file. Increasing the buffer will not solve anything. Sooner or
 //               later the buffer is going to fill up anyways.
 #if defined(WEBRTC_IOS)
-#define WEBRTC_TRACE_MAX_QUEUE  2000
+#define WEBRTC_TRACE_MAX_QUEUE  2048
 #else
-#define WEBRTC_TRACE_MAX_QUEUE  8000
+#define WEBRTC_TRACE_MAX_QUEUE  8192
 #endif
-#define WEBRTC_TRACE_NUM_ARRAY 2
 #define WEBRTC_TRACE_MAX_MESSAGE_SIZE 256
-// Total buffer size is WEBRTC_TRACE_NUM_ARRAY (number of buffer partitions) *
-// WEBRTC_TRACE_MAX_QUEUE (number of lines per buffer partition) *
-// WEBRTC_TRACE_MAX_MESSAGE_SIZE (number of 1 byte charachters per line) =
-// 1 or 4 Mbyte.
 
 #define WEBRTC_TRACE_MAX_FILE_SIZE 100*1000
 // Number of rows that may be written to file. On average 110 bytes per row (max
@@ -53,8 +53,10 @@ class TraceImpl : public Trace {
 
   int32_t SetTraceCallbackImpl(TraceCallback* callback);
 
+  // Records the message for the trace thread to format and write. |msg| must
+  // outlive the trace, i.e. be a string literal.
   void AddImpl(const TraceLevel level, const TraceModule module,
-               const int32_t id, const char* msg);
+               const int32_t id, const char* msg, va_list args);
 
   bool StopThread();
 
@@ -66,11 +68,15 @@ class TraceImpl : public Trace {
   static TraceImpl* StaticInstance(CountOperation count_operation,
                                    const TraceLevel level = kTraceAll);
 
-  int32_t AddThreadId(char* trace_message) const;
+  int32_t AddThreadId(char* trace_message, const uint32_t thread_id) const;
 
   // OS specific implementations.
-  virtual int32_t AddTime(char* trace_message,
-                          const TraceLevel level) const = 0;
+  // Returns the wall clock time, in microseconds, for AddTime(). Called on the
+  // tracing threads.
+  virtual int64_t TimeInMicroseconds() const = 0;
+  // Only called on the trace thread.
+  virtual int32_t AddTime(char* trace_message, const TraceLevel level,
+                          const int64_t time_us) const = 0;
 
   virtual int32_t AddBuildInfo(char* trace_message) const = 0;
   virtual int32_t AddDateTimeInfo(char* trace_message) const = 0;
@@ -86,14 +92,13 @@ class TraceImpl : public Trace {
   int32_t AddModuleAndId(char* trace_message, const TraceModule module,
                          const int32_t id) const;
 
-  int32_t AddMessage(char* trace_message,
-                     const char msg[WEBRTC_TRACE_MAX_MESSAGE_SIZE],
-                     const uint16_t written_so_far) const;
+  // Formats |record| into a full trace line, and returns its length
+  // including the terminating null.
+  int32_t FormatRecord(const TraceRecord& record,
+                       char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE]) const;
 
-  void AddMessageToList(
-    const char trace_message[WEBRTC_TRACE_MAX_MESSAGE_SIZE],
-    const uint16_t length,
-    const TraceLevel level);
+  void WriteMessage(const char* trace_message, const int32_t length,
+                    const TraceLevel level);
 
   bool UpdateFileName(
     const char file_name_utf8[FileWrapper::kMaxFileNameSize],
@@ -116,13 +121,9 @@ class TraceImpl : public Trace {
   ThreadWrapper& thread_;
   EventWrapper& event_;
 
-  // critsect_array_ protects active_queue_.
-  CriticalSectionWrapper* critsect_array_;
-  uint16_t next_free_idx_[WEBRTC_TRACE_NUM_ARRAY];
-  TraceLevel level_[WEBRTC_TRACE_NUM_ARRAY][WEBRTC_TRACE_MAX_QUEUE];
-  uint16_t length_[WEBRTC_TRACE_NUM_ARRAY][WEBRTC_TRACE_MAX_QUEUE];
-  char* message_queue_[WEBRTC_TRACE_NUM_ARRAY][WEBRTC_TRACE_MAX_QUEUE];
-  uint8_t active_queue_;
+  TraceRingBuffer records_;
+  // Messages dropped since the trace thread last wrote, for a full buffer.
+  Atomic32 dropped_messages_;
 };
 
 }  // namespace webrtc
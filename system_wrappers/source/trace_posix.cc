@@ -46,22 +46,34 @@ TracePosix::TracePosix()
 }
 
 TracePosix::~TracePosix() {
-  delete &crit_sect_;
+  // The trace thread uses |crit_sect_| until it is stopped.
   StopThread();
+  delete &crit_sect_;
 }
 
-int32_t TracePosix::AddTime(char* trace_message, const TraceLevel level) const {
+int64_t TracePosix::TimeInMicroseconds() const {
   struct timeval system_time_high_res;
   if (gettimeofday(&system_time_high_res, 0) == -1) {
     return -1;
   }
+  return static_cast<int64_t>(system_time_high_res.tv_sec) * 1000000 +
+      system_time_high_res.tv_usec;
+}
+
+int32_t TracePosix::AddTime(char* trace_message, const TraceLevel level,
+                            const int64_t time_us) const {
+  if (time_us < 0) {
+    return -1;
+  }
+  const time_t seconds = static_cast<time_t>(time_us / 1000000);
   struct tm buffer;
-  const struct tm* system_time =
-    localtime_r(&system_time_high_res.tv_sec, &buffer);
+  const struct tm* system_time = localtime_r(&seconds, &buffer);
 
-  const uint32_t ms_time = system_time_high_res.tv_usec / 1000;
+  const uint32_t ms_time = static_cast<uint32_t>(time_us % 1000000) / 1000;
   uint32_t prev_tickCount = 0;
   {
+    // Only the trace thread formats buffered records, but with
+    // WEBRTC_DIRECT_TRACE every tracing thread does.
     CriticalSectionScoped lock(&crit_sect_);
     if (level == kTraceApiCall) {
       prev_tickCount = prev_tick_count_;
@@ -21,16 +21,16 @@ class TracePosix : public TraceImpl {
   TracePosix();
   virtual ~TracePosix();
 
-  // This method can be called on several different threads different from
-  // the creating thread.
-  virtual int32_t AddTime(char* trace_message, const TraceLevel level) const;
+  virtual int64_t TimeInMicroseconds() const;
+  virtual int32_t AddTime(char* trace_message, const TraceLevel level,
+                          const int64_t time_us) const;
 
   virtual int32_t AddBuildInfo(char* trace_message) const;
   virtual int32_t AddDateTimeInfo(char* trace_message) const;
 
  private:
-  volatile mutable uint32_t  prev_api_tick_count_;
-  volatile mutable uint32_t  prev_tick_count_;
+  mutable uint32_t prev_api_tick_count_;
+  mutable uint32_t prev_tick_count_;
 
   CriticalSectionWrapper& crit_sect_;
 };
@@ -0,0 +1,429 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/system_wrappers/source/trace_record.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define snprintf _snprintf
+#endif
+
+namespace webrtc {
+
+namespace {
+
+enum LengthModifier {
+  kLengthNone,
+  kLengthChar,
+  kLengthShort,
+  kLengthLong,
+  kLengthLongLong,
+  kLengthSize,
+  kLengthIntMax,
+  kLengthPtrDiff,
+  kLengthLongDouble
+};
+
+// A printf conversion specification, e.g. "%-*.3lu".
+struct Conversion {
+  const char* begin;  // The '%'.
+  const char* end;  // Just past the conversion character.
+  int num_stars;  // Width and precision passed as arguments.
+  LengthModifier length;
+  char type;
+};
+
+// Finds the first conversion in |format|, skipping over "%%". Returns false if
+// there is none.
+bool NextConversion(const char* format, Conversion* conversion) {
+  const char* p = format;
+  while ((p = strchr(p, '%')) != NULL) {
+    if (p[1] == '%') {
+      p += 2;
+      continue;
+    }
+    conversion->begin = p++;
+    conversion->num_stars = 0;
+    while (*p != '\0' && strchr("-+ #0123456789.*", *p) != NULL) {
+      if (*p == '*') {
+        ++conversion->num_stars;
+      }
+      ++p;
+    }
+    conversion->length = kLengthNone;
+    switch (*p) {
+      case 'h':
+        conversion->length = (p[1] == 'h') ? kLengthChar : kLengthShort;
+        p += (p[1] == 'h') ? 2 : 1;
+        break;
+      case 'l':
+        conversion->length = (p[1] == 'l') ? kLengthLongLong : kLengthLong;
+        p += (p[1] == 'l') ? 2 : 1;
+        break;
+      case 'q':
+        conversion->length = kLengthLongLong;
+        ++p;
+        break;
+      case 'L':
+        conversion->length = kLengthLongDouble;
+        ++p;
+        break;
+      case 'z':
+        conversion->length = kLengthSize;
+        ++p;
+        break;
+      case 'j':
+        conversion->length = kLengthIntMax;
+        ++p;
+        break;
+      case 't':
+        conversion->length = kLengthPtrDiff;
+        ++p;
+        break;
+      case 'I':
+        // Microsoft's I, I32 and I64.
+        if (p[1] == '6' && p[2] == '4') {
+          conversion->length = kLengthLongLong;
+          p += 3;
+        } else if (p[1] == '3' && p[2] == '2') {
+          p += 3;
+        } else {
+          conversion->length = kLengthSize;
+          ++p;
+        }
+        break;
+    }
+    if (*p == '\0') {
+      return false;
+    }
+    conversion->type = *p;
+    conversion->end = p + 1;
+    return true;
+  }
+  return false;
+}
+
+bool IsSigned(char type) {
+  return type == 'd' || type == 'i';
+}
+
+class ArgumentWriter {
+ public:
+  explicit ArgumentWriter(TraceRecord* record)
+      : record_(record),
+        size_(0) {}
+
+  template <typename T>
+  bool Write(T value) {
+    return WriteBytes(&value, sizeof(value));
+  }
+
+  // Copies |string| including the terminating null, as much as fits.
+  bool WriteString(const char* string) {
+    if (string == NULL) {
+      string = "(null)";
+    }
+    int length = 0;
+    while (length < TraceRecord::kMaxStringArgumentSize &&
+           string[length] != '\0') {
+      ++length;
+    }
+    const int available = TraceRecord::kMaxArgumentSize - size_ - 1;
+    if (available < 0) {
+      return false;
+    }
+    if (length > available) {
+      length = available;
+    }
+    memcpy(&record_->arguments[size_], string, length);
+    record_->arguments[size_ + length] = '\0';
+    size_ += length + 1;
+    return true;
+  }
+
+  int size() const { return size_; }
+
+ private:
+  bool WriteBytes(const void* data, int size) {
+    if (size_ + size > TraceRecord::kMaxArgumentSize) {
+      return false;
+    }
+    memcpy(&record_->arguments[size_], data, size);
+    size_ += size;
+    return true;
+  }
+
+  TraceRecord* const record_;
+  int size_;
+};
+
+class ArgumentReader {
+ public:
+  explicit ArgumentReader(const TraceRecord& record)
+      : record_(record),
+        position_(0) {}
+
+  template <typename T>
+  T Read() {
+    T value;
+    assert(position_ + static_cast<int>(sizeof(value)) <=
+           record_.argument_size);
+    memcpy(&value, &record_.arguments[position_], sizeof(value));
+    position_ += sizeof(value);
+    return value;
+  }
+
+  const char* ReadString() {
+    const char* string = &record_.arguments[position_];
+    position_ += static_cast<int>(strlen(string)) + 1;
+    return string;
+  }
+
+ private:
+  const TraceRecord& record_;
+  int position_;
+};
+
+template <typename T>
+int FormatArgument(char* buffer, int size, const char* spec,
+                   const int* stars, int num_stars, T value) {
+  switch (num_stars) {
+    case 0:
+      return snprintf(buffer, size, spec, value);
+    case 1:
+      return snprintf(buffer, size, spec, stars[0], value);
+    default:
+      return snprintf(buffer, size, spec, stars[0], stars[1], value);
+  }
+}
+
+// Formats an integer conversion with the argument type it was recorded with.
+int FormatInteger(char* buffer, int size, const char* spec,
+                  const Conversion& conversion, const int* stars,
+                  int64_t value) {
+  const bool is_signed = IsSigned(conversion.type);
+  switch (conversion.length) {
+    case kLengthLong:
+      if (is_signed) {
+        return FormatArgument(buffer, size, spec, stars, conversion.num_stars,
+                              static_cast<long>(value));
+      }
+      return FormatArgument(buffer, size, spec, stars, conversion.num_stars,
+                            static_cast<unsigned long>(value));
+    case kLengthLongLong:
+    case kLengthIntMax:
+      if (is_signed) {
+        return FormatArgument(buffer, size, spec, stars, conversion.num_stars,
+                              static_cast<long long>(value));
+      }
+      return FormatArgument(buffer, size, spec, stars, conversion.num_stars,
+                            static_cast<unsigned long long>(value));
+    case kLengthSize:
+    case kLengthPtrDiff:
+      if (is_signed) {
+        return FormatArgument(buffer, size, spec, stars, conversion.num_stars,
+                              static_cast<ptrdiff_t>(value));
+      }
+      return FormatArgument(buffer, size, spec, stars, conversion.num_stars,
+                            static_cast<size_t>(value));
+    default:
+      if (is_signed) {
+        return FormatArgument(buffer, size, spec, stars, conversion.num_stars,
+                              static_cast<int>(value));
+      }
+      return FormatArgument(buffer, size, spec, stars, conversion.num_stars,
+                            static_cast<unsigned int>(value));
+  }
+}
+
+}  // namespace
+
+void PackTraceArguments(va_list args, TraceRecord* record) {
+  record->num_arguments = 0;
+  record->argument_size = 0;
+  if (record->format == NULL) {
+    return;
+  }
+  ArgumentWriter writer(record);
+  const char* format = record->format;
+  Conversion conversion;
+  while (NextConversion(format, &conversion)) {
+    if (conversion.num_stars > 2) {
+      break;
+    }
+    bool written = true;
+    for (int i = 0; i < conversion.num_stars; ++i) {
+      written = writer.Write(va_arg(args, int)) && written;
+    }
+    const bool is_signed = IsSigned(conversion.type);
+    switch (conversion.type) {
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X': {
+        int64_t value = 0;
+        switch (conversion.length) {
+          case kLengthLong:
+            value = is_signed ? va_arg(args, long)
+                              : static_cast<int64_t>(
+                                    va_arg(args, unsigned long));
+            break;
+          case kLengthLongLong:
+          case kLengthIntMax:
+            value = is_signed ? va_arg(args, long long)
+                              : static_cast<int64_t>(
+                                    va_arg(args, unsigned long long));
+            break;
+          case kLengthSize:
+          case kLengthPtrDiff:
+            value = is_signed ? va_arg(args, ptrdiff_t)
+                              : static_cast<int64_t>(va_arg(args, size_t));
+            break;
+          default:
+            value = is_signed ? va_arg(args, int)
+                              : static_cast<int64_t>(
+                                    va_arg(args, unsigned int));
+            break;
+        }
+        written = writer.Write(value) && written;
+        break;
+      }
+      case 'c':
+        written = writer.Write(va_arg(args, int)) && written;
+        break;
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        if (conversion.length == kLengthLongDouble) {
+          written = writer.Write(va_arg(args, long double)) && written;
+        } else {
+          written = writer.Write(va_arg(args, double)) && written;
+        }
+        break;
+      case 'p':
+        written = writer.Write(va_arg(args, void*)) && written;
+        break;
+      case 's':
+        written = writer.WriteString(va_arg(args, const char*)) && written;
+        break;
+      case 'n':
+        va_arg(args, void*);
+        break;
+      default:
+        // Unknown conversion, of which the argument type is unknown too.
+        written = false;
+        break;
+    }
+    if (!written) {
+      break;
+    }
+    record->argument_size = static_cast<uint16_t>(writer.size());
+    ++record->num_arguments;
+    format = conversion.end;
+  }
+}
+
+int FormatTraceMessage(const TraceRecord& record, char* buffer, int size) {
+  assert(size > 0);
+  const char* format = record.format ? record.format : "";
+  ArgumentReader reader(record);
+  int length = 0;
+  int num_formatted = 0;
+  for (;;) {
+    Conversion conversion;
+    const bool found = NextConversion(format, &conversion);
+    const char* literal_end = found ? conversion.begin
+                                    : format + strlen(format);
+    // Copy the text up to the conversion, with "%%" printed as '%'.
+    while (format < literal_end && length < size - 1) {
+      buffer[length++] = *format;
+      format += (format[0] == '%' && format[1] == '%') ? 2 : 1;
+    }
+    if (!found || format < literal_end ||
+        num_formatted == record.num_arguments) {
+      break;
+    }
+
+    char spec[32];
+    const int spec_length = static_cast<int>(conversion.end - conversion.begin);
+    if (spec_length >= static_cast<int>(sizeof(spec))) {
+      break;
+    }
+    memcpy(spec, conversion.begin, spec_length);
+    spec[spec_length] = '\0';
+    int stars[2] = { 0, 0 };
+    for (int i = 0; i < conversion.num_stars; ++i) {
+      stars[i] = reader.Read<int>();
+    }
+
+    char* const out = &buffer[length];
+    const int available = size - length;
+    int written = 0;
+    switch (conversion.type) {
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+        written = FormatInteger(out, available, spec, conversion, stars,
+                                reader.Read<int64_t>());
+        break;
+      case 'c':
+        written = FormatArgument(out, available, spec, stars,
+                                 conversion.num_stars, reader.Read<int>());
+        break;
+      case 'p':
+        written = FormatArgument(out, available, spec, stars,
+                                 conversion.num_stars, reader.Read<void*>());
+        break;
+      case 's':
+        written = FormatArgument(out, available, spec, stars,
+                                 conversion.num_stars, reader.ReadString());
+        break;
+      case 'n':
+        break;
+      default:
+        if (conversion.length == kLengthLongDouble) {
+          written = FormatArgument(out, available, spec, stars,
+                                   conversion.num_stars,
+                                   reader.Read<long double>());
+        } else {
+          written = FormatArgument(out, available, spec, stars,
+                                   conversion.num_stars,
+                                   reader.Read<double>());
+        }
+        break;
+    }
+    if (written < 0 || written >= available) {
+      // Truncated.
+      length = size - 1;
+      break;
+    }
+    length += written;
+    format = conversion.end;
+    ++num_formatted;
+  }
+  buffer[length] = '\0';
+  return length;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_RECORD_H_
+#define WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_RECORD_H_
+
+#include <stdarg.h>
+
+#include "webrtc/common_types.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// A trace message in binary form, as recorded by the tracing thread: the
+// format string is kept by pointer and its arguments are packed as raw
+// values, which leaves the formatting to the thread writing the trace. The
+// format string must outlive the record, which holds for the string literals
+// passed to WEBRTC_TRACE.
+struct TraceRecord {
+  // Room for a string argument of the longest size along with a few more
+  // arguments.
+  enum { kMaxArgumentSize = 320 };
+  // Longer string arguments are cut short. A message is at most
+  // WEBRTC_TRACE_MAX_MESSAGE_SIZE long, so no more would be shown anyway.
+  enum { kMaxStringArgumentSize = 256 };
+
+  int64_t time_us;
+  const char* format;
+  int32_t id;
+  uint32_t thread_id;
+  TraceLevel level;
+  TraceModule module;
+  // The number of conversions in |format| with their arguments packed in
+  // |arguments|. Arguments which don't fit are dropped.
+  uint16_t num_arguments;
+  uint16_t argument_size;
+  char arguments[kMaxArgumentSize];
+};
+
+// Packs |args|, as described by the conversions in |record->format|, into
+// |record|. Strings are copied; %n conversions are ignored.
+void PackTraceArguments(va_list args, TraceRecord* record);
+
+// Writes the message of |record| to |buffer| of |size| bytes, as vsnprintf()
+// would have when the message was recorded. Formatting stops at the first
+// conversion whose argument was dropped. Returns the length of the message,
+// excluding the terminating null, after truncation to |size|.
+int FormatTraceMessage(const TraceRecord& record, char* buffer, int size);
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_RECORD_H_
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/system_wrappers/source/trace_record.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+#ifdef _WIN32
+#define vsnprintf _vsnprintf
+#endif
+
+namespace webrtc {
+namespace {
+
+// Records |format| and its arguments, and formats the record into a buffer of
+// |size| bytes.
+std::string Format(int size, const char* format, ...) {
+  TraceRecord record;
+  record.format = format;
+  va_list args;
+  va_start(args, format);
+  PackTraceArguments(args, &record);
+  va_end(args);
+  char buffer[512];
+  const int length = FormatTraceMessage(record, buffer, size);
+  EXPECT_EQ(strlen(buffer), static_cast<size_t>(length));
+  return std::string(buffer, length);
+}
+
+// Formats |format| and its arguments with vsnprintf.
+std::string Expected(const char* format, ...) {
+  char buffer[512];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  buffer[sizeof(buffer) - 1] = '\0';
+  return buffer;
+}
+
+#define EXPECT_FORMAT(format, ...) \
+  EXPECT_EQ(Expected(format, __VA_ARGS__), Format(512, format, __VA_ARGS__))
+
+TEST(TraceRecordTest, FormatsLikePrintf) {
+  EXPECT_EQ("no arguments", Format(512, "no arguments"));
+  EXPECT_EQ("100% sure", Format(512, "100%% sure"));
+  EXPECT_FORMAT("%d %i %u", -1, 42, 4000000000u);
+  EXPECT_FORMAT("%x %X %o %#x", 255u, 255u, 8u, 16u);
+  EXPECT_FORMAT("%-5d|%05d|%+d|% d", 12, 34, 56, 78);
+  EXPECT_FORMAT("%hd %hu %hhu", static_cast<short>(-2),
+                static_cast<unsigned short>(65535),
+                static_cast<unsigned char>(200));
+  EXPECT_FORMAT("%ld %lu", -1234567L, 1234567UL);
+  EXPECT_FORMAT("%lld %llu", -123456789012345LL, 18446744073709551615ULL);
+  EXPECT_FORMAT("%zu", static_cast<size_t>(123456));
+  EXPECT_FORMAT("%c%c%c", 'a', 'b', 'c');
+  EXPECT_FORMAT("%f %.2f %e %g", 1.5, 3.14159, 12345.678, 0.0001);
+  EXPECT_FORMAT("%Lf", static_cast<long double>(2.5));
+  EXPECT_FORMAT("%s and %s", "this", "that");
+  EXPECT_FORMAT("%10s|%-10s|%.3s", "right", "left", "truncated");
+  EXPECT_FORMAT("%*d|%-*d|%.*f|%*.*f", 6, 1, 6, 2, 3, 1.0, 8, 2, 2.0);
+  EXPECT_FORMAT("%p", reinterpret_cast<void*>(0x1234));
+}
+
+TEST(TraceRecordTest, TruncatesToBufferSize) {
+  EXPECT_EQ("abcd", Format(5, "abcdefgh"));
+  EXPECT_EQ("ab12", Format(5, "ab%d", 1234567));
+  EXPECT_EQ("xyzw", Format(5, "%s", "xyzwv"));
+  EXPECT_EQ("", Format(1, "%d", 1));
+}
+
+TEST(TraceRecordTest, CutsLongStrings) {
+  const std::string long_string(TraceRecord::kMaxStringArgumentSize + 50, 'a');
+  EXPECT_EQ(std::string(TraceRecord::kMaxStringArgumentSize, 'a') + "!",
+            Format(512, "%s!", long_string.c_str()));
+}
+
+TEST(TraceRecordTest, StopsAtDroppedArgument) {
+  // The arguments of the third string no longer fit in the record.
+  const std::string string(TraceRecord::kMaxStringArgumentSize / 2, 'b');
+  const std::string message = Format(512, "%s,%s,%s,%d", string.c_str(),
+                                     string.c_str(), string.c_str(), 1);
+  EXPECT_EQ(string + "," + string + ",", message.substr(0, 2 * string.size() +
+                                                        2));
+  EXPECT_LE(message.size(),
+            static_cast<size_t>(TraceRecord::kMaxArgumentSize + 3));
+}
+
+TEST(TraceRecordTest, HandlesNullString) {
+  EXPECT_EQ("(null)", Format(512, "%s", static_cast<const char*>(NULL)));
+}
+
+}  // namespace
+}  // namespace webrtc
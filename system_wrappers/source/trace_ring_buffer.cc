@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/system_wrappers/source/trace_ring_buffer.h"
+
+#include <assert.h>
+
+namespace webrtc {
+
+namespace {
+
+// Returns |to| - |from|, correct across wrap around of the positions.
+int32_t Distance(int32_t from, int32_t to) {
+  return static_cast<int32_t>(static_cast<uint32_t>(to) -
+                              static_cast<uint32_t>(from));
+}
+
+int32_t Next(int32_t position) {
+  return static_cast<int32_t>(static_cast<uint32_t>(position) + 1);
+}
+
+}  // namespace
+
+// A slot at index i is free for the writer at position p, with p & mask_ == i,
+// when its sequence number is p, and holds a record for the reader at p when
+// its sequence number is p + 1.
+TraceRingBuffer::TraceRingBuffer(int size)
+    : slots_(new Slot[size]),
+      mask_(size - 1),
+      write_position_(0),
+      read_position_(0) {
+  assert(size > 0 && (size & (size - 1)) == 0);
+  for (int i = 0; i < size; ++i) {
+    slots_[i].sequence += i;
+  }
+}
+
+TraceRingBuffer::~TraceRingBuffer() {
+  delete [] slots_;
+}
+
+TraceRecord* TraceRingBuffer::BeginWrite(int32_t* position) {
+  int32_t current = write_position_.Value();
+  for (;;) {
+    Slot& slot = slots_[current & mask_];
+    const int32_t distance = Distance(current, slot.sequence.AcquireLoad());
+    if (distance == 0) {
+      if (write_position_.CompareExchange(Next(current), current)) {
+        *position = current;
+        return &slot.record;
+      }
+    } else if (distance < 0) {
+      // The slot still holds a record from the previous lap.
+      return NULL;
+    }
+    // Another writer claimed the position first.
+    current = write_position_.Value();
+  }
+}
+
+void TraceRingBuffer::EndWrite(int32_t position) {
+  slots_[position & mask_].sequence += 1;
+}
+
+const TraceRecord* TraceRingBuffer::BeginRead() {
+  const int32_t current = read_position_.Value();
+  Slot& slot = slots_[current & mask_];
+  if (slot.sequence.AcquireLoad() != Next(current)) {
+    // Empty, or the record is still being written.
+    return NULL;
+  }
+  return &slot.record;
+}
+
+void TraceRingBuffer::EndRead() {
+  const int32_t current = read_position_.Value();
+  // Free the slot for the writer at the same index in the next lap.
+  slots_[current & mask_].sequence += mask_;
+  ++read_position_;
+}
+
+int TraceRingBuffer::Size() const {
+  return Distance(read_position_.Value(), write_position_.Value());
+}
+
+}  // namespace webrtc
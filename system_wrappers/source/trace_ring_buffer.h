@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_RING_BUFFER_H_
+#define WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_RING_BUFFER_H_
+
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/source/trace_record.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// A bounded queue of trace records, written by any number of threads without
+// locking and read by a single thread. Each slot carries a sequence number
+// which tells whether it is free for the writer claiming it or holds a record
+// for the reader, so writers only contend on claiming a position.
+class TraceRingBuffer {
+ public:
+  // |size| must be a power of two.
+  explicit TraceRingBuffer(int size);
+  ~TraceRingBuffer();
+
+  // Claims the next slot for writing and returns its record, or NULL if the
+  // buffer is full. The record is handed to the reader by EndWrite(), with the
+  // |position| returned here.
+  TraceRecord* BeginWrite(int32_t* position);
+  void EndWrite(int32_t position);
+
+  // Returns the oldest record, or NULL if there is none. The record stays
+  // valid until EndRead(). Only to be called by the reading thread.
+  const TraceRecord* BeginRead();
+  void EndRead();
+
+  // The number of records written or being written, but not yet read.
+  int Size() const;
+  int capacity() const { return mask_ + 1; }
+
+ private:
+  struct Slot {
+    Atomic32 sequence;
+    TraceRecord record;
+  };
+
+  Slot* const slots_;
+  const int32_t mask_;
+  Atomic32 write_position_;
+  // Only advanced by the reader.
+  Atomic32 read_position_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceRingBuffer);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_SYSTEM_WRAPPERS_SOURCE_TRACE_RING_BUFFER_H_
@@ -0,0 +1,141 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/system_wrappers/source/trace_ring_buffer.h"
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+
+namespace webrtc {
+namespace {
+
+const int kNumWriters = 4;
+const int kRecordsPerWriter = 2000;
+
+TEST(TraceRingBufferTest, ReadsInWriteOrder) {
+  TraceRingBuffer buffer(4);
+  EXPECT_EQ(4, buffer.capacity());
+  EXPECT_TRUE(buffer.BeginRead() == NULL);
+  for (int lap = 0; lap < 3; ++lap) {
+    for (int i = 0; i < 4; ++i) {
+      int32_t position = -1;
+      TraceRecord* record = buffer.BeginWrite(&position);
+      ASSERT_TRUE(record != NULL);
+      EXPECT_EQ(lap * 4 + i, position);
+      record->id = position;
+      buffer.EndWrite(position);
+    }
+    EXPECT_EQ(4, buffer.Size());
+    for (int i = 0; i < 4; ++i) {
+      const TraceRecord* record = buffer.BeginRead();
+      ASSERT_TRUE(record != NULL);
+      EXPECT_EQ(lap * 4 + i, record->id);
+      buffer.EndRead();
+    }
+    EXPECT_EQ(0, buffer.Size());
+    EXPECT_TRUE(buffer.BeginRead() == NULL);
+  }
+}
+
+TEST(TraceRingBufferTest, FailsWriteWhenFull) {
+  TraceRingBuffer buffer(2);
+  int32_t position = 0;
+  ASSERT_TRUE(buffer.BeginWrite(&position) != NULL);
+  buffer.EndWrite(position);
+  ASSERT_TRUE(buffer.BeginWrite(&position) != NULL);
+  buffer.EndWrite(position);
+  EXPECT_TRUE(buffer.BeginWrite(&position) == NULL);
+
+  ASSERT_TRUE(buffer.BeginRead() != NULL);
+  buffer.EndRead();
+  EXPECT_TRUE(buffer.BeginWrite(&position) != NULL);
+}
+
+TEST(TraceRingBufferTest, WaitsForRecordBeingWritten) {
+  TraceRingBuffer buffer(4);
+  int32_t first = 0;
+  int32_t second = 0;
+  ASSERT_TRUE(buffer.BeginWrite(&first) != NULL);
+  ASSERT_TRUE(buffer.BeginWrite(&second) != NULL);
+  buffer.EndWrite(second);
+  // The second record is complete, but is behind the first.
+  EXPECT_TRUE(buffer.BeginRead() == NULL);
+  buffer.EndWrite(first);
+  ASSERT_TRUE(buffer.BeginRead() != NULL);
+  buffer.EndRead();
+  ASSERT_TRUE(buffer.BeginRead() != NULL);
+  buffer.EndRead();
+}
+
+struct Writer {
+  TraceRingBuffer* buffer;
+  int id;
+  int num_written;
+};
+
+bool WriteRecord(void* obj) {
+  Writer* writer = static_cast<Writer*>(obj);
+  if (writer->num_written == kRecordsPerWriter) {
+    return false;
+  }
+  int32_t position = 0;
+  TraceRecord* record = writer->buffer->BeginWrite(&position);
+  if (record != NULL) {
+    record->id = writer->id;
+    record->thread_id = writer->num_written++;
+    writer->buffer->EndWrite(position);
+  } else {
+    // Full; let the reader catch up.
+    SleepMs(1);
+  }
+  return true;
+}
+
+TEST(TraceRingBufferTest, ConcurrentWriters) {
+  TraceRingBuffer buffer(64);
+  Writer writers[kNumWriters];
+  std::vector<ThreadWrapper*> threads;
+  for (int i = 0; i < kNumWriters; ++i) {
+    writers[i].buffer = &buffer;
+    writers[i].id = i;
+    writers[i].num_written = 0;
+    threads.push_back(ThreadWrapper::CreateThread(&WriteRecord, &writers[i]));
+    unsigned int id = 0;
+    ASSERT_TRUE(threads.back()->Start(id));
+  }
+
+  // Each writer's records must come out complete and in order.
+  std::vector<uint32_t> next(kNumWriters, 0);
+  int num_read = 0;
+  while (num_read < kNumWriters * kRecordsPerWriter) {
+    const TraceRecord* record = buffer.BeginRead();
+    if (record == NULL) {
+      SleepMs(1);
+      continue;
+    }
+    ASSERT_GE(record->id, 0);
+    ASSERT_LT(record->id, kNumWriters);
+    ASSERT_EQ(next[record->id], record->thread_id);
+    ++next[record->id];
+    buffer.EndRead();
+    ++num_read;
+  }
+  EXPECT_TRUE(buffer.BeginRead() == NULL);
+  for (int i = 0; i < kNumWriters; ++i) {
+    EXPECT_TRUE(threads[i]->Stop());
+    delete threads[i];
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -32,55 +32,66 @@
 namespace webrtc {
 TraceWindows::TraceWindows()
     : prev_api_tick_count_(0),
-      prev_tick_count_(0) {
+      prev_tick_count_(0),
+      crit_sect_(*CriticalSectionWrapper::CreateCriticalSection()) {
 }
 
 TraceWindows::~TraceWindows() {
+  // The trace thread uses |crit_sect_| until it is stopped.
   StopThread();
+  delete &crit_sect_;
 }
 
-int32_t TraceWindows::AddTime(char* trace_message,
-                              const TraceLevel level) const {
-  uint32_t dw_current_time = timeGetTime();
-  SYSTEMTIME system_time;
-  GetSystemTime(&system_time);
-
-  if (level == kTraceApiCall) {
-    uint32_t dw_delta_time = dw_current_time - prev_tick_count_;
-    prev_tick_count_ = dw_current_time;
+int64_t TraceWindows::TimeInMicroseconds() const {
+  FILETIME file_time;
+  GetSystemTimeAsFileTime(&file_time);
+  ULARGE_INTEGER time;
+  time.LowPart = file_time.dwLowDateTime;
+  time.HighPart = file_time.dwHighDateTime;
+  // In 100 ns intervals.
+  return static_cast<int64_t>(time.QuadPart / 10);
+}
 
-    if (prev_tick_count_ == 0) {
-      dw_delta_time = 0;
-    }
-    if (dw_delta_time > 0x0fffffff) {
-      // Either wrap-around or data race.
-      dw_delta_time = 0;
-    }
-    if (dw_delta_time > 99999) {
-      dw_delta_time = 99999;
+int32_t TraceWindows::AddTime(char* trace_message, const TraceLevel level,
+                              const int64_t time_us) const {
+  uint32_t dw_current_time = static_cast<uint32_t>(time_us / 1000);
+  ULARGE_INTEGER time;
+  time.QuadPart = static_cast<ULONGLONG>(time_us) * 10;
+  FILETIME file_time;
+  file_time.dwLowDateTime = time.LowPart;
+  file_time.dwHighDateTime = time.HighPart;
+  SYSTEMTIME system_time;
+  FileTimeToSystemTime(&file_time, &system_time);
+
+  uint32_t prev_tick_count = 0;
+  {
+    // Only the trace thread formats buffered records, but with
+    // WEBRTC_DIRECT_TRACE every tracing thread does.
+    CriticalSectionScoped lock(&crit_sect_);
+    if (level == kTraceApiCall) {
+      prev_tick_count = prev_tick_count_;
+      prev_tick_count_ = dw_current_time;
+    } else {
+      prev_tick_count = prev_api_tick_count_;
+      prev_api_tick_count_ = dw_current_time;
     }
+  }
 
-    sprintf(trace_message, "(%2u:%2u:%2u:%3u |%5lu) ", system_time.wHour,
-            system_time.wMinute, system_time.wSecond,
-            system_time.wMilliseconds, dw_delta_time);
-  } else {
-    uint32_t dw_delta_time = dw_current_time - prev_api_tick_count_;
-    prev_api_tick_count_ = dw_current_time;
-
-    if (prev_api_tick_count_ == 0) {
-      dw_delta_time = 0;
-    }
-    if (dw_delta_time > 0x0fffffff) {
-      // Either wraparound or data race.
-      dw_delta_time = 0;
-    }
-    if (dw_delta_time > 99999) {
-      dw_delta_time = 99999;
-    }
-    sprintf(trace_message, "(%2u:%2u:%2u:%3u |%5lu) ", system_time.wHour,
-            system_time.wMinute, system_time.wSecond,
-            system_time.wMilliseconds, dw_delta_time);
+  uint32_t dw_delta_time = dw_current_time - prev_tick_count;
+  if (prev_tick_count == 0) {
+    dw_delta_time = 0;
   }
+  if (dw_delta_time > 0x0fffffff) {
+    // Wrap-around.
+    dw_delta_time = 0;
+  }
+  if (dw_delta_time > 99999) {
+    dw_delta_time = 99999;
+  }
+  sprintf(trace_message, "(%2u:%2u:%2u:%3u |%5lu) ", system_time.wHour,
+          system_time.wMinute, system_time.wSecond,
+          system_time.wMilliseconds,
+          static_cast<unsigned long>(dw_delta_time));
   return 22;
 }
 
@@ -92,8 +103,11 @@ int32_t TraceWindows::AddBuildInfo(char* trace_message) const {
 }
 
 int32_t TraceWindows::AddDateTimeInfo(char* trace_message) const {
-  prev_api_tick_count_ = timeGetTime();
-  prev_tick_count_ = prev_api_tick_count_;
+  {
+    CriticalSectionScoped lock(&crit_sect_);
+    prev_api_tick_count_ = static_cast<uint32_t>(TimeInMicroseconds() / 1000);
+    prev_tick_count_ = prev_api_tick_count_;
+  }
 
   SYSTEMTIME sys_time;
   GetLocalTime(&sys_time);
@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include <windows.h>
 
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/source/trace_impl.h"
 
 namespace webrtc {
@@ -23,13 +24,17 @@ class TraceWindows : public TraceImpl {
   TraceWindows();
   virtual ~TraceWindows();
 
-  virtual int32_t AddTime(char* trace_message, const TraceLevel level) const;
+  virtual int64_t TimeInMicroseconds() const;
+  virtual int32_t AddTime(char* trace_message, const TraceLevel level,
+                          const int64_t time_us) const;
 
   virtual int32_t AddBuildInfo(char* trace_message) const;
   virtual int32_t AddDateTimeInfo(char* trace_message) const;
  private:
-  volatile mutable uint32_t prev_api_tick_count_;
-  volatile mutable uint32_t prev_tick_count_;
+  mutable uint32_t prev_api_tick_count_;
+  mutable uint32_t prev_tick_count_;
+
+  CriticalSectionWrapper& crit_sect_;
 };
 
 }  // namespace webrtc
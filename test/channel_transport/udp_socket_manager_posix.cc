@@ -10,6 +10,7 @@
 
 #include "webrtc/test/channel_transport/udp_socket_manager_posix.h"
 
+#include <errno.h>
 #include <stdio.h>
 #include <strings.h>
 #include <sys/time.h>
@@ -17,6 +18,10 @@
 #include <time.h>
 #include <unistd.h>
 
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+#include <sys/epoll.h>
+#endif
+
 #include "webrtc/system_wrappers/interface/sleep.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 #include "webrtc/test/channel_transport/udp_socket_posix.h"
@@ -24,6 +29,13 @@
 namespace webrtc {
 namespace test {
 
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+namespace {
+// Ready sockets handled per epoll_wait().
+const int kMaxEpollEvents = 64;
+}  // namespace
+#endif
+
 UdpSocketManagerPosix::UdpSocketManagerPosix()
     : UdpSocketManager(),
       _id(-1),
@@ -197,7 +209,17 @@ UdpSocketManagerPosixImpl::UdpSocketManagerPosixImpl()
     _thread = ThreadWrapper::CreateThread(UdpSocketManagerPosixImpl::Run, this,
                                           kRealtimePriority,
                                           "UdpSocketManagerPosixImplThread");
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd == -1)
+    {
+        WEBRTC_TRACE(kTraceError, kTraceTransport, -1,
+                     "UdpSocketManagerPosix failed to create epoll fd: %d",
+                     errno);
+    }
+#else
     FD_ZERO(&_readFds);
+#endif
     WEBRTC_TRACE(kTraceMemory,  kTraceTransport, -1,
                  "UdpSocketManagerPosix created");
 }
@@ -227,6 +249,12 @@ UdpSocketManagerPosixImpl::~UdpSocketManagerPosixImpl()
 
         delete _critSectList;
     }
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+    if (_epollFd != -1)
+    {
+        close(_epollFd);
+    }
+#endif
 
     WEBRTC_TRACE(kTraceMemory,  kTraceTransport, -1,
                  "UdpSocketManagerPosix deleted");
@@ -239,6 +267,12 @@ bool UdpSocketManagerPosixImpl::Start()
     {
         return false;
     }
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+    if (_epollFd == -1)
+    {
+        return false;
+    }
+#endif
 
     WEBRTC_TRACE(kTraceStateInfo,  kTraceTransport, -1,
                  "Start UdpSocketManagerPosix");
@@ -257,6 +291,32 @@ bool UdpSocketManagerPosixImpl::Stop()
     return _thread->Stop();
 }
 
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+bool UdpSocketManagerPosixImpl::Process()
+{
+    UpdateSocketMap();
+
+    // Timeout = 10 ms. Returns early when a socket becomes readable.
+    struct epoll_event events[kMaxEpollEvents];
+    const int num = epoll_wait(_epollFd, events, kMaxEpollEvents, 10);
+    if (num == SOCKET_ERROR)
+    {
+        if (errno != EINTR)
+        {
+            SleepMs(10);
+        }
+        return true;
+    }
+
+    // Sockets are only deleted in UpdateSocketMap() on this thread, after
+    // being removed from the epoll set, so the pointers are valid.
+    for (int i = 0; i < num; ++i)
+    {
+        static_cast<UdpSocketPosix*>(events[i].data.ptr)->HasIncoming();
+    }
+    return true;
+}
+#else
 bool UdpSocketManagerPosixImpl::Process()
 {
     bool doSelect = false;
@@ -308,6 +368,7 @@ bool UdpSocketManagerPosixImpl::Process()
     }
     return true;
 }
+#endif
 
 bool UdpSocketManagerPosixImpl::Run(ThreadObj obj)
 {
@@ -319,7 +380,11 @@ bool UdpSocketManagerPosixImpl::Run(ThreadObj obj)
 bool UdpSocketManagerPosixImpl::AddSocket(UdpSocketWrapper* s)
 {
     UdpSocketPosix* sl = static_cast<UdpSocketPosix*>(s);
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+    if(sl->GetFd() == INVALID_SOCKET)
+#else
     if(sl->GetFd() == INVALID_SOCKET || !(sl->GetFd() < FD_SETSIZE))
+#endif
     {
         return false;
     }
@@ -397,6 +462,10 @@ void UdpSocketManagerPosixImpl::UpdateSocketMap()
             {
                 deleteSocket = socket;
             }
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+            // Stop polling before the socket is closed and deleted.
+            epoll_ctl(_epollFd, EPOLL_CTL_DEL, removeFD, NULL);
+#endif
             _socketMap.Erase(it);
         }
         if(deleteSocket)
@@ -414,6 +483,17 @@ void UdpSocketManagerPosixImpl::UpdateSocketMap()
             static_cast<UdpSocketPosix*>(_addList.First()->GetItem());
         if(s)
         {
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+            struct epoll_event event;
+            event.events = EPOLLIN | EPOLLET;
+            event.data.ptr = s;
+            if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, s->GetFd(), &event) == -1)
+            {
+                WEBRTC_TRACE(kTraceError, kTraceTransport, -1,
+                             "UdpSocketManagerPosix failed to poll socket: %d",
+                             errno);
+            }
+#endif
             _socketMap.Insert(s->GetFd(), s);
         }
         _addList.PopFront();
@@ -19,6 +19,7 @@
 #include "webrtc/system_wrappers/interface/map_wrapper.h"
 #include "webrtc/system_wrappers/interface/thread_wrapper.h"
 #include "webrtc/test/channel_transport/udp_socket_manager_wrapper.h"
+#include "webrtc/test/channel_transport/udp_socket_posix.h"
 #include "webrtc/test/channel_transport/udp_socket_wrapper.h"
 
 namespace webrtc {
@@ -75,7 +76,11 @@ private:
     ThreadWrapper* _thread;
     CriticalSectionWrapper* _critSectList;
 
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+    int _epollFd;
+#else
     fd_set _readFds;
+#endif
 
     MapWrapper _socketMap;
     ListWrapper _addList;
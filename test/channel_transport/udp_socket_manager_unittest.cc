@@ -15,10 +15,22 @@
 // It also uses the static UdpSocketManager object.
 // The most important property of these tests is that they do not leak memory.
 
+#include <string.h>
+
+#include <sstream>
+#include <vector>
+
 #include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 #include "webrtc/test/channel_transport/udp_socket_manager_wrapper.h"
 #include "webrtc/test/channel_transport/udp_socket_wrapper.h"
+#include "webrtc/test/testsupport/perf_test.h"
+#if !defined(_WIN32)
+#include "webrtc/test/channel_transport/udp_socket_posix.h"
+#endif
 
 namespace webrtc {
 namespace test {
@@ -80,5 +92,103 @@ TEST(UdpSocketManager, UnremovedSocketsGetCollectedAtManagerDeletion) {
 #endif
 }
 
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+void CountPacket(CallbackObj obj, const int8_t* /*buf*/, int32_t /*len*/,
+                 const SocketAddress* /*from*/) {
+  ++*static_cast<Atomic32*>(obj);
+}
+
+// Measures the loopback receive throughput, in packets per second, of growing
+// numbers of sockets. The receiving sockets share one port with SO_REUSEPORT
+// and are spread over two manager threads; the kernel spreads the packets of
+// the senders over them. Disabled since it takes seconds and only checks that
+// packets arrive; run it with --gtest_also_run_disabled_tests.
+TEST(UdpSocketManager, DISABLED_LoopbackThroughputBenchmark) {
+  const int kNumSockets[] = { 1, 10, 100 };
+  const int kPacketsPerRun = 20000;
+  const int kPacketSize = 200;
+  const int kBatchSize = 32;
+
+  SocketAddress address;
+  memset(&address, 0, sizeof(address));
+  address._sockaddr_in.sin_family = AF_INET;
+  address._sockaddr_in.sin_addr = UdpTransport::InetAddrIPV4("127.0.0.1");
+
+  int8_t packet[kPacketSize];
+  memset(packet, 0, sizeof(packet));
+  const int8_t* packets[kBatchSize];
+  int32_t lengths[kBatchSize];
+  for (int i = 0; i < kBatchSize; ++i) {
+    packets[i] = packet;
+    lengths[i] = kPacketSize;
+  }
+
+  for (size_t run = 0; run < sizeof(kNumSockets) / sizeof(kNumSockets[0]);
+       ++run) {
+    const int num_sockets = kNumSockets[run];
+    uint8_t threads = 2;
+    UdpSocketManager* mgr = UdpSocketManager::Create(42, threads);
+    Atomic32 received(0);
+    std::vector<UdpSocketWrapper*> receivers;
+    std::vector<UdpSocketWrapper*> senders;
+    const int32_t reuse = 1;
+    // The first receiver binds an ephemeral port, the others share it.
+    address._sockaddr_in.sin_port = 0;
+    for (int i = 0; i < num_sockets; ++i) {
+      UdpSocketWrapper* receiver = UdpSocketWrapper::CreateSocket(
+          42, mgr, &received, &CountPacket, false, false);
+      ASSERT_TRUE(receiver != NULL);
+      ASSERT_TRUE(receiver->SetSockopt(
+          SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const int8_t*>(&reuse),
+          sizeof(reuse)));
+      ASSERT_TRUE(receiver->Bind(address));
+      if (i == 0) {
+        sockaddr_in bound;
+        socklen_t bound_length = sizeof(bound);
+        ASSERT_EQ(0, getsockname(
+            static_cast<UdpSocketPosix*>(receiver)->GetFd(),
+            reinterpret_cast<sockaddr*>(&bound), &bound_length));
+        address._sockaddr_in.sin_port = bound.sin_port;
+      }
+      receiver->StartReceiving();
+      receivers.push_back(receiver);
+      senders.push_back(UdpSocketWrapper::CreateSocket(42, mgr, NULL, NULL,
+                                                       false, false));
+      ASSERT_TRUE(senders.back() != NULL);
+    }
+
+    const TickTime start = TickTime::Now();
+    for (int sent = 0; sent < kPacketsPerRun; sent += kBatchSize) {
+      UdpSocketWrapper* sender = senders[(sent / kBatchSize) % num_sockets];
+      sender->SendToBatch(packets, lengths, kBatchSize, address);
+    }
+    // Wait for the receivers to go quiet; packets dropped by the kernel
+    // never arrive.
+    int32_t last_received = -1;
+    int64_t end_ms = 0;
+    while (received.Value() != last_received) {
+      last_received = received.Value();
+      end_ms = (TickTime::Now() - start).Milliseconds();
+      SleepMs(50);
+    }
+    std::ostringstream trace;
+    trace << num_sockets << "_sockets";
+    PrintResult("udp_loopback_received", "", trace.str(),
+                static_cast<size_t>(last_received), "packets", false);
+    PrintResult("udp_loopback_throughput", "", trace.str(),
+                static_cast<size_t>(1000 * static_cast<int64_t>(last_received) /
+                                    (end_ms > 0 ? end_ms : 1)),
+                "packets/s", false);
+    EXPECT_GT(last_received, 0);
+
+    for (int i = 0; i < num_sockets; ++i) {
+      receivers[i]->CloseBlocking();
+      senders[i]->CloseBlocking();
+    }
+    UdpSocketManager::Return();
+  }
+}
+#endif
+
 }  // namespace test
 }  // namespace webrtc
@@ -26,6 +26,17 @@
 
 namespace webrtc {
 namespace test {
+
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+namespace {
+// Packets read or written per system call.
+const int kReceiveBatchSize = 16;
+const int kSendBatchSize = 32;
+// As the receive buffer without epoll.
+const int kMaxPacketSize = 2048;
+}  // namespace
+#endif
+
 UdpSocketPosix::UdpSocketPosix(const int32_t id, UdpSocketManager* mgr,
                                bool ipV6Enable)
 {
@@ -173,6 +184,47 @@ int32_t UdpSocketPosix::SendTo(const int8_t* buf, int32_t len,
     return retVal;
 }
 
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+int32_t UdpSocketPosix::SendToBatch(const int8_t* const* bufs,
+                                    const int32_t* lens, int32_t count,
+                                    const SocketAddress& to)
+{
+    struct iovec iov[kSendBatchSize];
+    struct mmsghdr msgs[kSendBatchSize];
+    int32_t sent = 0;
+    while (sent < count)
+    {
+        const int batch = (count - sent < kSendBatchSize) ? count - sent
+                                                          : kSendBatchSize;
+        memset(msgs, 0, sizeof(msgs[0]) * batch);
+        for (int i = 0; i < batch; ++i)
+        {
+            iov[i].iov_base = const_cast<int8_t*>(bufs[sent + i]);
+            iov[i].iov_len = lens[sent + i];
+            msgs[i].msg_hdr.msg_name =
+                const_cast<SocketAddress*>(&to);
+            msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        const int retVal = sendmmsg(_socket, msgs, batch, 0);
+        if (retVal == SOCKET_ERROR)
+        {
+            _error = errno;
+            WEBRTC_TRACE(kTraceError, kTraceTransport, _id,
+                         "UdpSocketPosix::SendToBatch() error: %d", _error);
+            break;
+        }
+        sent += retVal;
+        if (retVal < batch)
+        {
+            break;
+        }
+    }
+    return (sent == 0 && count > 0) ? -1 : sent;
+}
+#endif
+
 bool UdpSocketPosix::ValidHandle()
 {
     return _socket != INVALID_SOCKET;
@@ -180,6 +232,41 @@ bool UdpSocketPosix::ValidHandle()
 
 void UdpSocketPosix::HasIncoming()
 {
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+    int8_t bufs[kReceiveBatchSize][kMaxPacketSize];
+    SocketAddress from[kReceiveBatchSize];
+    struct iovec iov[kReceiveBatchSize];
+    struct mmsghdr msgs[kReceiveBatchSize];
+    for (int i = 0; i < kReceiveBatchSize; ++i)
+    {
+        iov[i].iov_base = bufs[i];
+        iov[i].iov_len = sizeof(bufs[i]);
+    }
+
+    int num = kReceiveBatchSize;
+    // A short batch means the socket has been drained.
+    while (num == kReceiveBatchSize)
+    {
+        memset(msgs, 0, sizeof(msgs));
+        memset(from, 0, sizeof(from));
+        for (int i = 0; i < kReceiveBatchSize; ++i)
+        {
+            msgs[i].msg_hdr.msg_name = &from[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        num = recvmmsg(_socket, msgs, kReceiveBatchSize, 0, NULL);
+        for (int i = 0; i < num; ++i)
+        {
+            // Empty datagrams are dropped, as without epoll.
+            if (msgs[i].msg_len > 0 && _wantsIncoming && _incomingCb)
+            {
+                _incomingCb(_obj, bufs[i], msgs[i].msg_len, &from[i]);
+            }
+        }
+    }
+#else
     // replace 2048 with a mcro define and figure out
     // where 2048 comes from
     int8_t buf[2048];
@@ -219,6 +306,7 @@ void UdpSocketPosix::HasIncoming()
         }
         break;
     }
+#endif
 }
 
 void UdpSocketPosix::CloseBlocking()
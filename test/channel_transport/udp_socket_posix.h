@@ -25,6 +25,12 @@ namespace test {
 
 #define SOCKET_ERROR -1
 
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+// Sockets are polled with edge-triggered epoll, which has no FD_SETSIZE limit,
+// and packets are received and sent in batches with recvmmsg and sendmmsg.
+#define WEBRTC_UDP_SOCKET_EPOLL
+#endif
+
 class UdpSocketPosix : public UdpSocketWrapper
 {
 public:
@@ -47,6 +53,12 @@ public:
     virtual int32_t SendTo(const int8_t* buf, int32_t len,
                            const SocketAddress& to);
 
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+    virtual int32_t SendToBatch(const int8_t* const* bufs,
+                                const int32_t* lens, int32_t count,
+                                const SocketAddress& to);
+#endif
+
     // Deletes socket in addition to closing it.
     // TODO (hellner): make destructor protected.
     virtual void CloseBlocking();
@@ -66,6 +78,8 @@ public:
                         int32_t /*overrideDSCP*/) {return false;}
 
     bool CleanUp();
+    // Reads the incoming packets. With WEBRTC_UDP_SOCKET_EPOLL all queued
+    // packets are read, as readiness is only signaled again for new packets.
     void HasIncoming();
     bool WantsIncoming() {return _wantsIncoming;}
     void ReadyForDeletion();
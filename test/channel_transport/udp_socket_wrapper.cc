@@ -104,7 +104,11 @@ UdpSocketWrapper* UdpSocketWrapper::CreateSocket(const int32_t id,
     if (s)
     {
         UdpSocketPosix* sl = static_cast<UdpSocketPosix*>(s);
+#if defined(WEBRTC_UDP_SOCKET_EPOLL)
+        if (sl->GetFd() != INVALID_SOCKET)
+#else
         if (sl->GetFd() != INVALID_SOCKET && sl->GetFd() < FD_SETSIZE)
+#endif
         {
             // ok
         } else
@@ -135,6 +139,18 @@ UdpSocketWrapper* UdpSocketWrapper::CreateSocket(const int32_t id,
     return s;
 }
 
+int32_t UdpSocketWrapper::SendToBatch(const int8_t* const* bufs,
+                                      const int32_t* lens, int32_t count,
+                                      const SocketAddress& to)
+{
+    int32_t sent = 0;
+    while (sent < count && SendTo(bufs[sent], lens[sent], to) >= 0)
+    {
+        ++sent;
+    }
+    return (sent == 0 && count > 0) ? -1 : sent;
+}
+
 bool UdpSocketWrapper::StartReceiving()
 {
     _wantsIncoming = true;
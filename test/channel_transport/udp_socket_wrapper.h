@@ -83,6 +83,13 @@ public:
     virtual int32_t SendTo(const int8_t* buf, int32_t len,
                            const SocketAddress& to) = 0;
 
+    // Send count packets, of lengths lens, to the address specified by to.
+    // Returns the number of packets sent, which is less than count if sending
+    // failed, or -1 if none was sent.
+    virtual int32_t SendToBatch(const int8_t* const* bufs,
+                                const int32_t* lens, int32_t count,
+                                const SocketAddress& to);
+
     virtual void SetEventToNull();
 
     // Close socket and don't return until completed.
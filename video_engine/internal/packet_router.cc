@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/video_engine/internal/packet_router.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
+
+namespace webrtc {
+namespace internal {
+
+namespace {
+
+bool SsrcLess(const std::pair<uint32_t, PacketRouter::Receiver*>& entry,
+              uint32_t ssrc) {
+  return entry.first < ssrc;
+}
+
+// An RTP packet of a batch, referred to by its index.
+struct BatchedRtpPacket {
+  BatchedRtpPacket(uint32_t ssrc, size_t index) : ssrc(ssrc), index(index) {}
+
+  uint32_t ssrc;
+  size_t index;
+};
+
+bool BatchedSsrcLess(const BatchedRtpPacket& a, const BatchedRtpPacket& b) {
+  return a.ssrc < b.ssrc;
+}
+
+}  // namespace
+
+PacketRouter::PacketRouter()
+    : receive_lock_(RWLockWrapper::CreateRWLock()) {}
+
+PacketRouter::~PacketRouter() {}
+
+void PacketRouter::AddReceiver(uint32_t ssrc, Receiver* receiver) {
+  WriteLockScoped write_lock(*receive_lock_);
+  ReceiveSsrcs::iterator it = std::lower_bound(
+      receive_ssrcs_.begin(), receive_ssrcs_.end(), ssrc, SsrcLess);
+  assert(it == receive_ssrcs_.end() || it->first != ssrc);
+  receive_ssrcs_.insert(it, std::make_pair(ssrc, receiver));
+}
+
+PacketRouter::Receiver* PacketRouter::FindReceiver(uint32_t ssrc) const {
+  ReceiveSsrcs::const_iterator it = std::lower_bound(
+      receive_ssrcs_.begin(), receive_ssrcs_.end(), ssrc, SsrcLess);
+  if (it == receive_ssrcs_.end() || it->first != ssrc) {
+    return NULL;
+  }
+  return it->second;
+}
+
+bool PacketRouter::DeliverRtcp(const void* packet, size_t length) {
+  // TODO(pbos): Figure out what channel needs it actually.
+  //             Do NOT broadcast! Also make sure it's a valid packet.
+  bool rtcp_delivered = false;
+  ReadLockScoped read_lock(*receive_lock_);
+  for (ReceiveSsrcs::iterator it = receive_ssrcs_.begin();
+       it != receive_ssrcs_.end(); ++it) {
+    if (it->second->DeliverRtcp(packet, length)) {
+      rtcp_delivered = true;
+    }
+  }
+  return rtcp_delivered;
+}
+
+bool PacketRouter::DeliverPacket(const void* packet, size_t length) {
+  // TODO(pbos): Respect the constness of packet.
+  ModuleRTPUtility::RTPHeaderParser rtp_parser(
+      const_cast<uint8_t*>(static_cast<const uint8_t*>(packet)), length);
+
+  if (rtp_parser.RTCP()) {
+    return DeliverRtcp(packet, length);
+  }
+
+  RTPHeader rtp_header;
+  // TODO(pbos): ExtensionMap if there are extensions
+  if (!rtp_parser.Parse(rtp_header)) {
+    // TODO(pbos): Should this error be reported and trigger something?
+    return false;
+  }
+
+  ReadLockScoped read_lock(*receive_lock_);
+  Receiver* receiver = FindReceiver(rtp_header.ssrc);
+  if (receiver == NULL) {
+    // TODO(pbos): Log some warning, SSRC without receiver.
+    return false;
+  }
+  return receiver->DeliverRtp(packet, length);
+}
+
+size_t PacketRouter::DeliverPackets(
+    const newapi::PacketReceiver::Packet* packets, size_t num_packets) {
+  size_t num_delivered = 0;
+  std::vector<BatchedRtpPacket> rtp_packets;
+  rtp_packets.reserve(num_packets);
+  // Parse all headers before taking the lock.
+  for (size_t i = 0; i < num_packets; ++i) {
+    ModuleRTPUtility::RTPHeaderParser rtp_parser(
+        const_cast<uint8_t*>(static_cast<const uint8_t*>(packets[i].data)),
+        packets[i].length);
+    if (rtp_parser.RTCP()) {
+      if (DeliverRtcp(packets[i].data, packets[i].length))
+        ++num_delivered;
+      continue;
+    }
+    RTPHeader rtp_header;
+    // TODO(pbos): ExtensionMap if there are extensions
+    if (rtp_parser.Parse(rtp_header))
+      rtp_packets.push_back(BatchedRtpPacket(rtp_header.ssrc, i));
+  }
+
+  // Group the packets by SSRC, in arrival order within each group, to look
+  // up each receiver once.
+  std::stable_sort(rtp_packets.begin(), rtp_packets.end(), BatchedSsrcLess);
+  ReadLockScoped read_lock(*receive_lock_);
+  Receiver* receiver = NULL;
+  for (size_t i = 0; i < rtp_packets.size(); ++i) {
+    if (i == 0 || rtp_packets[i].ssrc != rtp_packets[i - 1].ssrc)
+      receiver = FindReceiver(rtp_packets[i].ssrc);
+    if (receiver == NULL)
+      continue;
+    const newapi::PacketReceiver::Packet& packet =
+        packets[rtp_packets[i].index];
+    if (receiver->DeliverRtp(packet.data, packet.length))
+      ++num_delivered;
+  }
+  return num_delivered;
+}
+
+}  // namespace internal
+}  // namespace webrtc
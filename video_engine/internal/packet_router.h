@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_VIDEO_ENGINE_INTERNAL_PACKET_ROUTER_H_
+#define WEBRTC_VIDEO_ENGINE_INTERNAL_PACKET_ROUTER_H_
+
+#include <utility>
+#include <vector>
+
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/interface/rw_lock_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/typedefs.h"
+#include "webrtc/video_engine/new_include/video_engine.h"
+
+namespace webrtc {
+namespace internal {
+
+// Routes received RTP packets to the receiver of their SSRC, and RTCP packets
+// to all receivers. Thread safe.
+class PacketRouter {
+ public:
+  class Receiver {
+   public:
+    // Return true if the packet was accepted.
+    virtual bool DeliverRtcp(const void* packet, size_t length) = 0;
+    virtual bool DeliverRtp(const void* packet, size_t length) = 0;
+
+   protected:
+    virtual ~Receiver() {}
+  };
+
+  PacketRouter();
+  ~PacketRouter();
+
+  // Adds |receiver| for the RTP packets with |ssrc|. |receiver| must outlive
+  // the router.
+  void AddReceiver(uint32_t ssrc, Receiver* receiver);
+
+  // Returns true if a receiver accepted the packet. RTP packets with an SSRC
+  // without a receiver are dropped.
+  bool DeliverPacket(const void* packet, size_t length);
+
+  // Delivers a batch of packets, as newapi::PacketReceiver::DeliverPackets().
+  // The RTCP packets are delivered first, in arrival order, ahead of RTP
+  // packets that arrived before them. The RTP packets are then delivered
+  // grouped by SSRC, in arrival order within each SSRC. Returns the number of
+  // packets accepted.
+  size_t DeliverPackets(const newapi::PacketReceiver::Packet* packets,
+                        size_t num_packets);
+
+ private:
+  typedef std::vector<std::pair<uint32_t, Receiver*> > ReceiveSsrcs;
+
+  // Must be called with |receive_lock_| held.
+  Receiver* FindReceiver(uint32_t ssrc) const;
+
+  bool DeliverRtcp(const void* packet, size_t length);
+
+  // Sorted by SSRC, for binary search in contiguous memory.
+  ReceiveSsrcs receive_ssrcs_;
+  scoped_ptr<RWLockWrapper> receive_lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(PacketRouter);
+};
+
+}  // namespace internal
+}  // namespace webrtc
+
+#endif  // WEBRTC_VIDEO_ENGINE_INTERNAL_PACKET_ROUTER_H_
@@ -0,0 +1,179 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/video_engine/internal/packet_router.h"
+
+namespace webrtc {
+namespace internal {
+namespace {
+
+const uint32_t kSsrc1 = 0x1111;
+const uint32_t kSsrc2 = 0x2222;
+const uint32_t kUnknownSsrc = 0x3333;
+const size_t kRtpHeaderLength = 12;
+const size_t kRtcpHeaderLength = 8;
+
+// A packet delivered to a receiver.
+struct Delivery {
+  Delivery(const PacketRouter::Receiver* receiver, const void* packet)
+      : receiver(receiver), packet(packet) {}
+
+  bool operator==(const Delivery& other) const {
+    return receiver == other.receiver && packet == other.packet;
+  }
+
+  const PacketRouter::Receiver* receiver;
+  const void* packet;
+};
+
+// Records the packets it gets in a log shared by all receivers.
+class FakeReceiver : public PacketRouter::Receiver {
+ public:
+  explicit FakeReceiver(std::vector<Delivery>* log) : log_(log) {}
+  virtual ~FakeReceiver() {}
+
+  virtual bool DeliverRtcp(const void* packet, size_t length) {
+    log_->push_back(Delivery(this, packet));
+    return true;
+  }
+
+  virtual bool DeliverRtp(const void* packet, size_t length) {
+    log_->push_back(Delivery(this, packet));
+    return true;
+  }
+
+ private:
+  std::vector<Delivery>* log_;
+};
+
+void WriteRtpHeader(uint32_t ssrc, uint16_t sequence_number,
+                    uint8_t* packet) {
+  memset(packet, 0, kRtpHeaderLength);
+  packet[0] = 0x80;
+  packet[1] = 100;
+  packet[2] = static_cast<uint8_t>(sequence_number >> 8);
+  packet[3] = static_cast<uint8_t>(sequence_number);
+  packet[8] = static_cast<uint8_t>(ssrc >> 24);
+  packet[9] = static_cast<uint8_t>(ssrc >> 16);
+  packet[10] = static_cast<uint8_t>(ssrc >> 8);
+  packet[11] = static_cast<uint8_t>(ssrc);
+}
+
+// Writes an empty receiver report.
+void WriteRtcpHeader(uint8_t* packet) {
+  memset(packet, 0, kRtcpHeaderLength);
+  packet[0] = 0x80;
+  packet[1] = 201;
+  packet[3] = 1;
+}
+
+class PacketRouterTest : public ::testing::Test {
+ protected:
+  PacketRouterTest() : receiver1_(&log_), receiver2_(&log_) {
+    router_.AddReceiver(kSsrc1, &receiver1_);
+    router_.AddReceiver(kSsrc2, &receiver2_);
+  }
+
+  void AddRtpPacket(uint32_t ssrc) {
+    ASSERT_LT(packets_.size(), sizeof(buffers_) / sizeof(buffers_[0]));
+    uint8_t* buffer = buffers_[packets_.size()];
+    WriteRtpHeader(ssrc, static_cast<uint16_t>(packets_.size()), buffer);
+    AddPacket(buffer, kRtpHeaderLength);
+  }
+
+  void AddRtcpPacket() {
+    ASSERT_LT(packets_.size(), sizeof(buffers_) / sizeof(buffers_[0]));
+    uint8_t* buffer = buffers_[packets_.size()];
+    WriteRtcpHeader(buffer);
+    AddPacket(buffer, kRtcpHeaderLength);
+  }
+
+  size_t DeliverPackets() {
+    return router_.DeliverPackets(&packets_[0], packets_.size());
+  }
+
+  const void* packet(size_t index) const { return packets_[index].data; }
+
+  PacketRouter router_;
+  std::vector<Delivery> log_;
+  FakeReceiver receiver1_;
+  FakeReceiver receiver2_;
+
+ private:
+  void AddPacket(const uint8_t* buffer, size_t length) {
+    newapi::PacketReceiver::Packet packet;
+    packet.data = buffer;
+    packet.length = length;
+    packets_.push_back(packet);
+  }
+
+  uint8_t buffers_[16][kRtpHeaderLength];
+  std::vector<newapi::PacketReceiver::Packet> packets_;
+};
+
+TEST_F(PacketRouterTest, DeliversRtpPacketsGroupedBySsrc) {
+  AddRtpPacket(kSsrc2);
+  AddRtpPacket(kSsrc1);
+  AddRtpPacket(kSsrc2);
+  AddRtpPacket(kSsrc1);
+  AddRtpPacket(kSsrc2);
+
+  EXPECT_EQ(5u, DeliverPackets());
+
+  std::vector<Delivery> expected;
+  expected.push_back(Delivery(&receiver1_, packet(1)));
+  expected.push_back(Delivery(&receiver1_, packet(3)));
+  expected.push_back(Delivery(&receiver2_, packet(0)));
+  expected.push_back(Delivery(&receiver2_, packet(2)));
+  expected.push_back(Delivery(&receiver2_, packet(4)));
+  EXPECT_TRUE(expected == log_);
+}
+
+TEST_F(PacketRouterTest, DropsRtpPacketsWithUnknownSsrc) {
+  AddRtpPacket(kUnknownSsrc);
+  AddRtpPacket(kSsrc1);
+  AddRtpPacket(kUnknownSsrc);
+
+  EXPECT_EQ(1u, DeliverPackets());
+
+  ASSERT_EQ(1u, log_.size());
+  EXPECT_TRUE(Delivery(&receiver1_, packet(1)) == log_[0]);
+
+  EXPECT_FALSE(router_.DeliverPacket(packet(0), kRtpHeaderLength));
+  EXPECT_EQ(1u, log_.size());
+}
+
+TEST_F(PacketRouterTest, DeliversRtcpAheadOfEarlierRtpPackets) {
+  AddRtpPacket(kSsrc1);
+  AddRtcpPacket();
+  AddRtpPacket(kSsrc2);
+  AddRtcpPacket();
+
+  // Each RTCP packet goes to all receivers, but counts once.
+  EXPECT_EQ(4u, DeliverPackets());
+
+  std::vector<Delivery> expected;
+  expected.push_back(Delivery(&receiver1_, packet(1)));
+  expected.push_back(Delivery(&receiver2_, packet(1)));
+  expected.push_back(Delivery(&receiver1_, packet(3)));
+  expected.push_back(Delivery(&receiver2_, packet(3)));
+  expected.push_back(Delivery(&receiver1_, packet(0)));
+  expected.push_back(Delivery(&receiver2_, packet(2)));
+  EXPECT_TRUE(expected == log_);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace webrtc
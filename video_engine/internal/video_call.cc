@@ -15,8 +15,6 @@
 #include <map>
 #include <vector>
 
-#include "webrtc/modules/rtp_rtcp/source/rtcp_utility.h"
-#include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
 #include "webrtc/video_engine/include/vie_base.h"
 #include "webrtc/video_engine/include/vie_codec.h"
 #include "webrtc/video_engine/include/vie_rtp_rtcp.h"
@@ -30,7 +28,6 @@ namespace internal {
 VideoCall::VideoCall(webrtc::VideoEngine* video_engine,
                      newapi::Transport* send_transport)
     : send_transport(send_transport),
-      receive_lock_(RWLockWrapper::CreateRWLock()),
       send_lock_(RWLockWrapper::CreateRWLock()),
       video_engine_(video_engine) {
   assert(video_engine != NULL);
@@ -106,9 +103,7 @@ newapi::VideoReceiveStream* VideoCall::CreateReceiveStream(
   VideoReceiveStream* receive_stream = new VideoReceiveStream(
       video_engine_, config, send_transport);
 
-  WriteLockScoped write_lock(*receive_lock_);
-  assert(receive_ssrcs_.find(config.rtp.ssrc) == receive_ssrcs_.end());
-  receive_ssrcs_[config.rtp.ssrc] = receive_stream;
+  packet_router_.AddReceiver(config.rtp.ssrc, receive_stream);
   return receive_stream;
 }
 
@@ -131,54 +126,12 @@ uint32_t VideoCall::ReceiveBitrateEstimate() {
   return 0;
 }
 
-bool VideoCall::DeliverRtcp(ModuleRTPUtility::RTPHeaderParser* rtp_parser,
-                            const void* packet, size_t length) {
-  // TODO(pbos): Figure out what channel needs it actually.
-  //             Do NOT broadcast! Also make sure it's a valid packet.
-  bool rtcp_delivered = false;
-  ReadLockScoped read_lock(*receive_lock_);
-  for (std::map<uint32_t, newapi::VideoReceiveStream*>::iterator it =
-           receive_ssrcs_.begin();
-       it != receive_ssrcs_.end(); ++it) {
-    if (static_cast<VideoReceiveStream*>(it->second)
-            ->DeliverRtcp(packet, length)) {
-      rtcp_delivered = true;
-    }
-  }
-  return rtcp_delivered;
-}
-
-bool VideoCall::DeliverRtp(ModuleRTPUtility::RTPHeaderParser* rtp_parser,
-                           const void* packet, size_t length) {
-  RTPHeader rtp_header;
-
-  // TODO(pbos): ExtensionMap if there are extensions
-  if (!rtp_parser->Parse(rtp_header)) {
-    // TODO(pbos): Should this error be reported and trigger something?
-    return false;
-  }
-
-  ReadLockScoped read_lock(*receive_lock_);
-  if (receive_ssrcs_.find(rtp_header.ssrc) == receive_ssrcs_.end()) {
-    // TODO(pbos): Log some warning, SSRC without receiver.
-    return false;
-  }
-
-  VideoReceiveStream* receiver =
-      static_cast<VideoReceiveStream*>(receive_ssrcs_[rtp_header.ssrc]);
-  return receiver->DeliverRtp(packet, length);
-}
-
 bool VideoCall::DeliverPacket(const void* packet, size_t length) {
-  // TODO(pbos): Respect the constness of packet.
-  ModuleRTPUtility::RTPHeaderParser rtp_parser(
-      const_cast<uint8_t*>(static_cast<const uint8_t*>(packet)), length);
-
-  if (rtp_parser.RTCP()) {
-    return DeliverRtcp(&rtp_parser, packet, length);
-  }
+  return packet_router_.DeliverPacket(packet, length);
+}
 
-  return DeliverRtp(&rtp_parser, packet, length);
+size_t VideoCall::DeliverPackets(const Packet* packets, size_t num_packets) {
+  return packet_router_.DeliverPackets(packets, num_packets);
 }
 
 }  // namespace internal
@@ -13,10 +13,9 @@
 #include <map>
 #include <vector>
 
-#include "webrtc/modules/rtp_rtcp/source/rtcp_utility.h"
-#include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
 #include "webrtc/system_wrappers/interface/rw_lock_wrapper.h"
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/video_engine/internal/packet_router.h"
 #include "webrtc/video_engine/internal/video_receive_stream.h"
 #include "webrtc/video_engine/internal/video_send_stream.h"
 #include "webrtc/video_engine/new_include/video_engine.h"
@@ -60,17 +59,13 @@ class VideoCall : public newapi::VideoCall, public newapi::PacketReceiver {
   virtual uint32_t ReceiveBitrateEstimate() OVERRIDE;
 
   virtual bool DeliverPacket(const void* packet, size_t length) OVERRIDE;
+  virtual size_t DeliverPackets(const Packet* packets,
+                                size_t num_packets) OVERRIDE;
 
  private:
-  bool DeliverRtp(ModuleRTPUtility::RTPHeaderParser* rtp_parser,
-                  const void* packet, size_t length);
-  bool DeliverRtcp(ModuleRTPUtility::RTPHeaderParser* rtp_parser,
-                   const void* packet, size_t length);
-
   newapi::Transport* send_transport;
 
-  std::map<uint32_t, newapi::VideoReceiveStream*> receive_ssrcs_;
-  scoped_ptr<RWLockWrapper> receive_lock_;
+  PacketRouter packet_router_;
   std::map<uint32_t, newapi::VideoSendStream*> send_ssrcs_;
   scoped_ptr<RWLockWrapper> send_lock_;
 
@@ -16,6 +16,7 @@
 #include "webrtc/common_video/libyuv/include/webrtc_libyuv.h"
 #include "webrtc/system_wrappers/interface/clock.h"
 #include "webrtc/video_engine/include/vie_render.h"
+#include "webrtc/video_engine/internal/packet_router.h"
 #include "webrtc/video_engine/new_include/video_receive_stream.h"
 
 namespace webrtc {
@@ -30,6 +31,7 @@ class ViERTP_RTCP;
 namespace internal {
 
 class VideoReceiveStream : public newapi::VideoReceiveStream,
+                           public PacketRouter::Receiver,
                            public webrtc::ExternalRenderer,
                            public webrtc::Transport {
  public:
@@ -43,8 +45,8 @@ class VideoReceiveStream : public newapi::VideoReceiveStream,
 
   virtual void GetCurrentReceiveCodec(VideoCodec* receive_codec) OVERRIDE;
 
-  virtual bool DeliverRtcp(const void* packet, size_t length);
-  virtual bool DeliverRtp(const void* packet, size_t length);
+  virtual bool DeliverRtcp(const void* packet, size_t length) OVERRIDE;
+  virtual bool DeliverRtp(const void* packet, size_t length) OVERRIDE;
 
   virtual int FrameSizeChange(unsigned int width, unsigned int height,
                               unsigned int /*number_of_streams*/) OVERRIDE;
@@ -27,8 +27,27 @@ const char* Version();
 
 class PacketReceiver {
  public:
+  struct Packet {
+    const void* data;
+    size_t length;
+  };
+
   virtual bool DeliverPacket(const void* packet, size_t length) = 0;
 
+  // Delivers |num_packets| packets at once, which lets the receiver share the
+  // per-packet work. RTP packets with the same SSRC are delivered in order,
+  // but not necessarily interleaved with other packets as they arrived: the
+  // video engine delivers the RTCP packets of a batch first, ahead of RTP
+  // packets that arrived before them. Returns the number of packets delivered.
+  virtual size_t DeliverPackets(const Packet* packets, size_t num_packets) {
+    size_t num_delivered = 0;
+    for (size_t i = 0; i < num_packets; ++i) {
+      if (DeliverPacket(packets[i].data, packets[i].length))
+        ++num_delivered;
+    }
+    return num_delivered;
+  }
+
  protected:
   virtual ~PacketReceiver() {}
 };
@@ -37,6 +37,8 @@ class TestProcessThread : public ProcessThread {
   virtual int32_t Stop() { return 0; }
   virtual int32_t RegisterModule(const Module* module) { return 0; }
   virtual int32_t DeRegisterModule(const Module* module) { return 0; }
+  virtual void WakeUp(const Module* module) {}
+  virtual void WakeUpAt(const Module* module, int64_t time_ms) {}
 };
 
 class ViERembTest : public ::testing::Test {
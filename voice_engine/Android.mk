@@ -22,6 +22,7 @@ LOCAL_SRC_FILES := \
     channel_manager_base.cc \
     dtmf_inband.cc \
     dtmf_inband_queue.cc \
+    encode_thread_pool.cc \
     level_indicator.cc \
     monitor_module.cc \
     output_mixer.cc \
@@ -0,0 +1,166 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/voice_engine/encode_thread_pool.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "webrtc/system_wrappers/interface/condition_variable_wrapper.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/system_wrappers/interface/trace.h"
+
+namespace webrtc {
+namespace voe {
+
+EncodeThreadPool::EncodeThreadPool(Encoder* encoder, int num_threads)
+    : encoder_(encoder),
+      crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      job_cond_(ConditionVariableWrapper::CreateConditionVariable()),
+      done_cond_(ConditionVariableWrapper::CreateConditionVariable()),
+      batch_(0),
+      batch_pending_(0),
+      stopping_(false) {
+  for (int i = 0; i < num_threads; ++i) {
+    char thread_name[32];
+    snprintf(thread_name, sizeof(thread_name), "VoiceEncodeThread%d", i);
+    ThreadWrapper* thread = ThreadWrapper::CreateThread(Run, this,
+                                                        kRealtimePriority,
+                                                        thread_name);
+    unsigned int thread_id = 0;
+    if (thread == NULL || !thread->Start(thread_id)) {
+      WEBRTC_TRACE(kTraceError, kTraceVoice, -1,
+                   "EncodeThreadPool unable to start %s", thread_name);
+      delete thread;
+      break;
+    }
+    threads_.push_back(thread);
+  }
+}
+
+EncodeThreadPool::~EncodeThreadPool() {
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i]->SetNotAlive();
+  }
+  {
+    CriticalSectionScoped cs(crit_.get());
+    stopping_ = true;
+    queue_.clear();
+    job_cond_->WakeAll();
+  }
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    if (threads_[i]->Stop()) {
+      delete threads_[i];
+    }
+  }
+}
+
+bool EncodeThreadPool::SkipIfBusy(int channel_id) {
+  CriticalSectionScoped cs(crit_.get());
+  std::map<int, int>::iterator it = busy_channels_.find(channel_id);
+  if (it == busy_channels_.end()) {
+    return false;
+  }
+  ++it->second;
+  return true;
+}
+
+int EncodeThreadPool::EncodeAndWait(const std::vector<int>& channel_ids,
+                                    int max_wait_ms) {
+  const int64_t deadline_ms = TickTime::MillisecondTimestamp() + max_wait_ms;
+  CriticalSectionScoped cs(crit_.get());
+  ++batch_;
+  batch_pending_ = 0;
+  for (size_t i = 0; i < channel_ids.size(); ++i) {
+    if (!busy_channels_.insert(std::make_pair(channel_ids[i], 0)).second) {
+      // Encoding an earlier frame; the caller should have skipped this one.
+      ++busy_channels_[channel_ids[i]];
+      continue;
+    }
+    Job job = { channel_ids[i], batch_ };
+    queue_.push_back(job);
+    ++batch_pending_;
+  }
+  job_cond_->WakeAll();
+
+  // Help out rather than sit idle. Without workers this encodes everything
+  // on the calling thread.
+  while (!queue_.empty() &&
+         (threads_.empty() || TickTime::MillisecondTimestamp() < deadline_ms)) {
+    const Job job = queue_.front();
+    queue_.pop_front();
+    crit_->Leave();
+    RunJob(job);
+    crit_->Enter();
+  }
+
+  while (batch_pending_ > 0) {
+    const int64_t wait_ms = deadline_ms - TickTime::MillisecondTimestamp();
+    if (wait_ms <= 0) {
+      break;
+    }
+    done_cond_->SleepCS(*crit_, static_cast<unsigned long>(wait_ms));
+  }
+  return batch_pending_;
+}
+
+bool EncodeThreadPool::Run(void* obj) {
+  return static_cast<EncodeThreadPool*>(obj)->Process();
+}
+
+bool EncodeThreadPool::Process() {
+  Job job;
+  {
+    CriticalSectionScoped cs(crit_.get());
+    while (queue_.empty() && !stopping_) {
+      job_cond_->SleepCS(*crit_);
+    }
+    if (stopping_) {
+      return false;
+    }
+    job = queue_.front();
+    queue_.pop_front();
+  }
+  RunJob(job);
+  return true;
+}
+
+void EncodeThreadPool::RunJob(const Job& job) {
+  encoder_->Encode(job.channel_id);
+  {
+    CriticalSectionScoped cs(crit_.get());
+    if (job.batch == batch_) {
+      assert(batch_pending_ > 0);
+      if (--batch_pending_ == 0) {
+        done_cond_->WakeAll();
+      }
+    }
+  }
+  for (;;) {
+    int num_skipped = 0;
+    {
+      CriticalSectionScoped cs(crit_.get());
+      std::map<int, int>::iterator it = busy_channels_.find(job.channel_id);
+      assert(it != busy_channels_.end());
+      num_skipped = it->second;
+      if (num_skipped == 0) {
+        busy_channels_.erase(it);
+        return;
+      }
+      it->second = 0;
+    }
+    encoder_->SkipFrames(job.channel_id, num_skipped);
+  }
+}
+
+}  // namespace voe
+}  // namespace webrtc
@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_VOICE_ENGINE_ENCODE_THREAD_POOL_H_
+#define WEBRTC_VOICE_ENGINE_ENCODE_THREAD_POOL_H_
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "webrtc/system_wrappers/interface/constructor_magic.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class ConditionVariableWrapper;
+class CriticalSectionWrapper;
+class ThreadWrapper;
+
+namespace voe {
+
+// Encodes the 10 ms frames of several sending channels in parallel. The
+// capture thread queues one encode per channel, helps encoding until the
+// queue is drained and then waits for the workers, but never beyond a
+// deadline. Encodes which miss the deadline finish in the background, and a
+// channel is never encoded by two threads at the same time: frames arriving
+// for a channel which is still busy are skipped and reported back through
+// Encoder::SkipFrames() once the channel is done.
+class EncodeThreadPool {
+ public:
+  class Encoder {
+   public:
+    // Encodes and sends the pending frame of |channel_id|.
+    virtual void Encode(int channel_id) = 0;
+    // Accounts for |num_frames| frames of |channel_id| which were dropped
+    // while it was busy encoding.
+    virtual void SkipFrames(int channel_id, int num_frames) = 0;
+
+   protected:
+    virtual ~Encoder() {}
+  };
+
+  // Starts |num_threads| worker threads which encode through |encoder|.
+  EncodeThreadPool(Encoder* encoder, int num_threads);
+  // Waits for the encodes in progress to finish. Queued encodes are dropped.
+  ~EncodeThreadPool();
+
+  int num_threads() const { return static_cast<int>(threads_.size()); }
+
+  // Returns true if |channel_id| is queued or being encoded, in which case its
+  // next frame is counted as skipped. The caller must then leave the frame of
+  // the channel alone.
+  bool SkipIfBusy(int channel_id);
+
+  // Encodes each channel of |channel_ids| once, on the workers and the calling
+  // thread. Returns when all of them are done or |max_wait_ms| has passed,
+  // whichever comes first, with the number of encodes still in progress.
+  int EncodeAndWait(const std::vector<int>& channel_ids, int max_wait_ms);
+
+ private:
+  struct Job {
+    int channel_id;
+    uint32_t batch;
+  };
+
+  static bool Run(void* obj);
+  bool Process();
+
+  // Runs |job| and then any frames skipped meanwhile. Must be called without
+  // |crit_| held.
+  void RunJob(const Job& job);
+
+  Encoder* const encoder_;
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  scoped_ptr<ConditionVariableWrapper> job_cond_;
+  scoped_ptr<ConditionVariableWrapper> done_cond_;
+  std::vector<ThreadWrapper*> threads_;
+
+  std::deque<Job> queue_;
+  // The channels queued or being encoded, with the number of frames skipped.
+  std::map<int, int> busy_channels_;
+  // Identifies the jobs of the current EncodeAndWait() call.
+  uint32_t batch_;
+  int batch_pending_;
+  bool stopping_;
+
+  DISALLOW_COPY_AND_ASSIGN(EncodeThreadPool);
+};
+
+}  // namespace voe
+}  // namespace webrtc
+
+#endif  // WEBRTC_VOICE_ENGINE_ENCODE_THREAD_POOL_H_
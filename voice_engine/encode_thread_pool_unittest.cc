@@ -0,0 +1,152 @@
+/*
+ *  Copyright (c) 2013 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/voice_engine/encode_thread_pool.h"
+
+#include <map>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+
+namespace webrtc {
+namespace voe {
+namespace {
+
+const int kBlockedChannel = 3;
+
+// Counts the encodes and skipped frames of each channel. Encodes of
+// |kBlockedChannel| block until Unblock() when blocking is enabled.
+class FakeEncoder : public EncodeThreadPool::Encoder {
+ public:
+  FakeEncoder()
+      : crit_(CriticalSectionWrapper::CreateCriticalSection()),
+        blocked_event_(EventWrapper::Create()),
+        unblock_event_(EventWrapper::Create()),
+        skipped_event_(EventWrapper::Create()),
+        block_(false) {}
+  virtual ~FakeEncoder() {}
+
+  virtual void Encode(int channel_id) {
+    {
+      CriticalSectionScoped cs(crit_.get());
+      ++num_encodes_[channel_id];
+    }
+    if (block_ && channel_id == kBlockedChannel) {
+      blocked_event_->Set();
+      unblock_event_->Wait(WEBRTC_EVENT_INFINITE);
+    }
+  }
+
+  virtual void SkipFrames(int channel_id, int num_frames) {
+    {
+      CriticalSectionScoped cs(crit_.get());
+      num_skipped_[channel_id] += num_frames;
+    }
+    skipped_event_->Set();
+  }
+
+  int NumEncodes(int channel_id) {
+    CriticalSectionScoped cs(crit_.get());
+    return num_encodes_[channel_id];
+  }
+
+  int NumSkipped(int channel_id) {
+    CriticalSectionScoped cs(crit_.get());
+    return num_skipped_[channel_id];
+  }
+
+  void set_block(bool block) { block_ = block; }
+  bool WaitForBlocked() {
+    return blocked_event_->Wait(10000) == kEventSignaled;
+  }
+  void Unblock() { unblock_event_->Set(); }
+  bool WaitForSkipped() {
+    return skipped_event_->Wait(10000) == kEventSignaled;
+  }
+
+ private:
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  scoped_ptr<EventWrapper> blocked_event_;
+  scoped_ptr<EventWrapper> unblock_event_;
+  scoped_ptr<EventWrapper> skipped_event_;
+  bool block_;
+  std::map<int, int> num_encodes_;
+  std::map<int, int> num_skipped_;
+};
+
+std::vector<int> ChannelIds(int num_channels) {
+  std::vector<int> channel_ids;
+  for (int i = 0; i < num_channels; ++i) {
+    channel_ids.push_back(i);
+  }
+  return channel_ids;
+}
+
+TEST(EncodeThreadPoolTest, EncodesOnCallingThreadWithoutWorkers) {
+  FakeEncoder encoder;
+  EncodeThreadPool pool(&encoder, 0);
+  EXPECT_EQ(0, pool.num_threads());
+  EXPECT_EQ(0, pool.EncodeAndWait(ChannelIds(5), 0));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(1, encoder.NumEncodes(i));
+  }
+  EXPECT_FALSE(pool.SkipIfBusy(0));
+}
+
+TEST(EncodeThreadPoolTest, EncodesEachChannelOnce) {
+  FakeEncoder encoder;
+  EncodeThreadPool pool(&encoder, 4);
+  EXPECT_EQ(4, pool.num_threads());
+  const int kNumFrames = 100;
+  const int kNumChannels = 20;
+  for (int i = 0; i < kNumFrames; ++i) {
+    EXPECT_EQ(0, pool.EncodeAndWait(ChannelIds(kNumChannels), 1000));
+  }
+  for (int i = 0; i < kNumChannels; ++i) {
+    EXPECT_EQ(kNumFrames, encoder.NumEncodes(i));
+    EXPECT_EQ(0, encoder.NumSkipped(i));
+    EXPECT_FALSE(pool.SkipIfBusy(i));
+  }
+}
+
+TEST(EncodeThreadPoolTest, SkipsFramesOfBusyChannel) {
+  FakeEncoder encoder;
+  encoder.set_block(true);
+  scoped_ptr<EncodeThreadPool> pool(new EncodeThreadPool(&encoder, 2));
+  // Without time to help, the calling thread leaves the blocked channel to a
+  // worker and returns right away.
+  std::vector<int> blocked_channel(1, kBlockedChannel);
+  EXPECT_EQ(1, pool->EncodeAndWait(blocked_channel, 0));
+  ASSERT_TRUE(encoder.WaitForBlocked());
+
+  // The other channels are encoded meanwhile, while the next two frames of the
+  // blocked channel are dropped.
+  EXPECT_TRUE(pool->SkipIfBusy(kBlockedChannel));
+  EXPECT_FALSE(pool->SkipIfBusy(0));
+  std::vector<int> channel_ids = ChannelIds(kBlockedChannel + 1);
+  EXPECT_EQ(0, pool->EncodeAndWait(channel_ids, 1000));
+  for (int i = 0; i < kBlockedChannel; ++i) {
+    EXPECT_EQ(1, encoder.NumEncodes(i));
+  }
+  EXPECT_EQ(1, encoder.NumEncodes(kBlockedChannel));
+  EXPECT_EQ(0, encoder.NumSkipped(kBlockedChannel));
+
+  encoder.Unblock();
+  ASSERT_TRUE(encoder.WaitForSkipped());
+  pool.reset();
+  EXPECT_EQ(2, encoder.NumSkipped(kBlockedChannel));
+}
+
+}  // namespace
+}  // namespace voe
+}  // namespace webrtc
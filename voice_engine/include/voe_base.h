@@ -40,9 +40,22 @@ namespace webrtc {
 
 class AudioDeviceModule;
 class AudioProcessing;
+class Config;
 
 const int kVoEDefault = -1;
 
+// Option for VoiceEngine::Create(const Config&). Sets the number of threads
+// which encode the sending channels in parallel, besides the audio device
+// thread. With several sending channels, the Transport of each channel may
+// then be called from different threads at the same time. The default, 0,
+// encodes all channels on the audio device thread.
+struct VoEEncoderThreads
+{
+    VoEEncoderThreads() : num_threads(0) {}
+    explicit VoEEncoderThreads(int numThreads) : num_threads(numThreads) {}
+    int num_threads;
+};
+
 // VoiceEngineObserver
 class WEBRTC_DLLEXPORT VoiceEngineObserver
 {
@@ -64,6 +77,10 @@ public:
     // sub-APIs. Returns NULL on failure.
     static VoiceEngine* Create();
 
+    // Creates a VoiceEngine object using the options in |config|, which need
+    // not outlive this call. Returns NULL on failure.
+    static VoiceEngine* Create(const Config& config);
+
     // Deletes a created VoiceEngine object and releases the utilized resources.
     // Note that if there are outstanding references held via other interfaces,
     // the voice engine instance will not actually be deleted until those
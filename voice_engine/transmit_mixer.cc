@@ -33,6 +33,11 @@ namespace voe {
 //            provide.
 static const int kMaxMonoDeviceDataSizeSamples = 960;  // 10 ms, 96 kHz, mono.
 
+// How long the audio device thread waits for the encoder threads. Encodes
+// which take longer finish in the background, and their channels skip frames
+// until they are done.
+static const int kEncodeDeadlineMs = 5;
+
 // TODO(ajm): The thread safety of this is dubious...
 void
 TransmitMixer::OnPeriodicProcess()
@@ -304,6 +309,29 @@ TransmitMixer::SetAudioProcessingModule(AudioProcessing* audioProcessingModule)
     return 0;
 }
 
+int32_t
+TransmitMixer::SetEncoderThreads(int numThreads)
+{
+    WEBRTC_TRACE(kTraceInfo, kTraceVoice, VoEId(_instanceId, -1),
+                 "TransmitMixer::SetEncoderThreads(numThreads=%d)",
+                 numThreads);
+    if (numThreads < 0)
+    {
+        return -1;
+    }
+    encode_pool_.reset();
+    if (numThreads > 0)
+    {
+        encode_pool_.reset(new EncodeThreadPool(this, numThreads));
+        if (encode_pool_->num_threads() != numThreads)
+        {
+            encode_pool_.reset();
+            return -1;
+        }
+    }
+    return 0;
+}
+
 void TransmitMixer::GetSendCodecInfo(int* max_sample_rate, int* max_channels) {
   ScopedChannel sc(*_channelManagerPtr);
   void* iterator = NULL;
@@ -424,31 +452,125 @@ TransmitMixer::DemuxAndMix()
     WEBRTC_TRACE(kTraceStream, kTraceVoice, VoEId(_instanceId, -1),
                  "TransmitMixer::DemuxAndMix()");
 
+    for (int i = 0; i < kMaxSendFrames; ++i)
+    {
+        _sendFrames[i].updated = false;
+    }
+    encode_channel_ids_.clear();
+
     ScopedChannel sc(*_channelManagerPtr);
     void* iterator(NULL);
     Channel* channelPtr = sc.GetFirstChannel(iterator);
     while (channelPtr != NULL)
     {
-        if (channelPtr->InputIsOnHold())
+        if (encode_pool_.get() &&
+            encode_pool_->SkipIfBusy(channelPtr->ChannelId()))
+        {
+            // Still encoding an earlier frame. The frame is dropped, and its
+            // time stamp accounted for by SkipFrames().
+        } else if (channelPtr->InputIsOnHold())
         {
             channelPtr->UpdateLocalTimeStamp();
         } else if (channelPtr->Sending())
         {
+            const AudioFrame& frame = SendFrameForChannel(*channelPtr);
             // Demultiplex makes a copy of its input.
-            channelPtr->Demultiplex(_audioFrame);
-            channelPtr->PrepareEncodeAndSend(_audioFrame.sample_rate_hz_);
+            channelPtr->Demultiplex(frame);
+            channelPtr->PrepareEncodeAndSend(frame.sample_rate_hz_);
+            encode_channel_ids_.push_back(channelPtr->ChannelId());
         }
         channelPtr = sc.GetNextChannel(iterator);
     }
     return 0;
 }
 
+const AudioFrame& TransmitMixer::SendFrameForChannel(Channel& channel) {
+  CodecInst codec;
+  if (channel.GetSendCodec(codec) != 0) {
+    return _audioFrame;
+  }
+  // Never upsample or upmix, like GenerateAudioFrame().
+  const int sample_rate_hz = std::min(codec.plfreq, _audioFrame.sample_rate_hz_);
+  const int num_channels = std::min(codec.channels, _audioFrame.num_channels_);
+  if (sample_rate_hz == _audioFrame.sample_rate_hz_ &&
+      num_channels == _audioFrame.num_channels_) {
+    return _audioFrame;
+  }
+
+  SendFrame* send_frame = NULL;
+  for (int i = 0; i < kMaxSendFrames; ++i) {
+    const AudioFrame& frame = _sendFrames[i].frame;
+    if (frame.sample_rate_hz_ == sample_rate_hz &&
+        frame.num_channels_ == num_channels) {
+      send_frame = &_sendFrames[i];
+      break;
+    }
+    if (send_frame == NULL && frame.sample_rate_hz_ == 0) {
+      send_frame = &_sendFrames[i];
+    }
+  }
+  if (send_frame == NULL) {
+    // Out of formats; leave the conversion to the audio coding module.
+    return _audioFrame;
+  }
+  if (send_frame->updated) {
+    return send_frame->frame;
+  }
+
+  const int16_t* audio = _audioFrame.data_;
+  int16_t mono_audio[kMaxMonoDeviceDataSizeSamples];
+  if (num_channels == 1 && _audioFrame.num_channels_ == 2) {
+    assert(_audioFrame.samples_per_channel_ <= kMaxMonoDeviceDataSizeSamples);
+    AudioFrameOperations::StereoToMono(_audioFrame.data_,
+                                       _audioFrame.samples_per_channel_,
+                                       mono_audio);
+    audio = mono_audio;
+  }
+  AudioFrame& frame = send_frame->frame;
+  int out_length = -1;
+  if (send_frame->resampler.InitializeIfNeeded(_audioFrame.sample_rate_hz_,
+                                               sample_rate_hz,
+                                               num_channels) == 0) {
+    out_length = send_frame->resampler.Resample(
+        audio, _audioFrame.samples_per_channel_ * num_channels, frame.data_,
+        AudioFrame::kMaxDataSizeSamples);
+  }
+  if (out_length == -1) {
+    WEBRTC_TRACE(kTraceWarning, kTraceVoice, VoEId(_instanceId, -1),
+                 "TransmitMixer::SendFrameForChannel() unable to convert to "
+                 "%d Hz, %d channels", sample_rate_hz, num_channels);
+    return _audioFrame;
+  }
+  frame.samples_per_channel_ = out_length / num_channels;
+  frame.id_ = _audioFrame.id_;
+  frame.timestamp_ = _audioFrame.timestamp_;
+  frame.sample_rate_hz_ = sample_rate_hz;
+  frame.speech_type_ = _audioFrame.speech_type_;
+  frame.vad_activity_ = _audioFrame.vad_activity_;
+  frame.num_channels_ = num_channels;
+  send_frame->updated = true;
+  return frame;
+}
+
 int32_t
 TransmitMixer::EncodeAndSend()
 {
     WEBRTC_TRACE(kTraceStream, kTraceVoice, VoEId(_instanceId, -1),
                  "TransmitMixer::EncodeAndSend()");
 
+    if (encode_pool_.get())
+    {
+        const int numLate = encode_pool_->EncodeAndWait(encode_channel_ids_,
+                                                        kEncodeDeadlineMs);
+        if (numLate > 0)
+        {
+            WEBRTC_TRACE(kTraceWarning, kTraceVoice, VoEId(_instanceId, -1),
+                         "TransmitMixer::EncodeAndSend() %d channels missed "
+                         "the encode deadline", numLate);
+        }
+        return 0;
+    }
+
     ScopedChannel sc(*_channelManagerPtr);
     void* iterator(NULL);
     Channel* channelPtr = sc.GetFirstChannel(iterator);
@@ -463,6 +585,31 @@ TransmitMixer::EncodeAndSend()
     return 0;
 }
 
+void TransmitMixer::Encode(int channel_id)
+{
+    ScopedChannel sc(*_channelManagerPtr, channel_id);
+    Channel* channelPtr = sc.ChannelPtr();
+    if (channelPtr != NULL && channelPtr->Sending() &&
+        !channelPtr->InputIsOnHold())
+    {
+        channelPtr->EncodeAndSend();
+    }
+}
+
+void TransmitMixer::SkipFrames(int channel_id, int num_frames)
+{
+    ScopedChannel sc(*_channelManagerPtr, channel_id);
+    Channel* channelPtr = sc.ChannelPtr();
+    if (channelPtr == NULL)
+    {
+        return;
+    }
+    for (int i = 0; i < num_frames; ++i)
+    {
+        channelPtr->UpdateLocalTimeStamp();
+    }
+}
+
 uint32_t TransmitMixer::CaptureLevel() const
 {
     CriticalSectionScoped cs(&_critSect);
@@ -16,6 +16,8 @@
 #include "webrtc/modules/interface/module_common_types.h"
 #include "webrtc/modules/utility/interface/file_player.h"
 #include "webrtc/modules/utility/interface/file_recorder.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/voice_engine/encode_thread_pool.h"
 #include "webrtc/voice_engine/include/voe_base.h"
 #include "webrtc/voice_engine/level_indicator.h"
 #include "webrtc/voice_engine/monitor_module.h"
@@ -30,12 +32,14 @@ class VoEMediaProcess;
 
 namespace voe {
 
+class Channel;
 class ChannelManager;
 class MixedAudio;
 class Statistics;
 
 class TransmitMixer : public MonitorObserver,
-                      public FileCallback
+                      public FileCallback,
+                      public EncodeThreadPool::Encoder
 
 {
 public:
@@ -50,6 +54,11 @@ public:
     int32_t SetAudioProcessingModule(
         AudioProcessing* audioProcessingModule);
 
+    // Encodes the sending channels on |numThreads| threads in addition to the
+    // audio device thread, or only on the latter if |numThreads| is 0. Must
+    // not be called while capturing.
+    int32_t SetEncoderThreads(int numThreads);
+
     int32_t PrepareDemux(const void* audioSamples,
                          uint32_t nSamples,
                          uint8_t  nChannels,
@@ -147,6 +156,11 @@ public:
 
     void RecordFileEnded(int32_t id);
 
+    // EncodeThreadPool::Encoder
+    virtual void Encode(int channel_id);
+
+    virtual void SkipFrames(int channel_id, int num_frames);
+
 #ifdef WEBRTC_VOICE_ENGINE_TYPING_DETECTION
     // Typing detection
     int TimeSinceLastTyping(int &seconds);
@@ -161,8 +175,25 @@ public:
   bool IsStereoChannelSwappingEnabled();
 
 private:
+    // A downmixed and/or downsampled copy of |_audioFrame|, shared by the
+    // channels whose send codec takes that format.
+    struct SendFrame
+    {
+        SendFrame() : updated(false) {}
+
+        bool updated;  // Holds the current |_audioFrame|.
+        PushResampler resampler;
+        AudioFrame frame;
+    };
+
     TransmitMixer(uint32_t instanceId);
 
+    // Returns the frame to demultiplex to |channel|, in the sample rate and
+    // number of channels of its send codec where possible, so the format
+    // conversion is done once for all channels with the same codec format
+    // instead of in the audio coding module of each channel.
+    const AudioFrame& SendFrameForChannel(Channel& channel);
+
     // Gets the maximum sample rate and number of channels over all currently
     // sending codecs.
     void GetSendCodecInfo(int* max_sample_rate, int* max_channels);
@@ -193,6 +224,12 @@ private:
     MonitorModule _monitorModule;
     AudioFrame _audioFrame;
     PushResampler resampler_;  // ADM sample rate -> mixing rate
+    // Mixing rate -> send codec rates below it. Besides 8 and 16 kHz, in mono
+    // and stereo, this leaves room for a few less common codec rates.
+    enum { kMaxSendFrames = 6 };
+    SendFrame _sendFrames[kMaxSendFrames];
+    scoped_ptr<EncodeThreadPool> encode_pool_;
+    std::vector<int> encode_channel_ids_;  // Demultiplexed in this tick.
     FilePlayer* _filePlayerPtr;
     FileRecorder* _fileRecorderPtr;
     FileRecorder* _fileCallRecorderPtr;
@@ -63,6 +63,8 @@
         'dtmf_inband.h',
         'dtmf_inband_queue.cc',
         'dtmf_inband_queue.h',
+        'encode_thread_pool.cc',
+        'encode_thread_pool.h',
         'level_indicator.cc',
         'level_indicator.h',
         'monitor_module.cc',
@@ -143,6 +145,7 @@
           ],
           'sources': [
             'channel_unittest.cc',
+            'encode_thread_pool_unittest.cc',
             'output_mixer_unittest.cc',
             'transmit_mixer_unittest.cc',
             'voe_audio_processing_unittest.cc',
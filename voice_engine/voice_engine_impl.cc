@@ -12,7 +12,9 @@
 #include "modules/audio_device/android/audio_device_jni_android.h"
 #endif
 
+#include "webrtc/common.h"
 #include "webrtc/system_wrappers/interface/trace.h"
+#include "webrtc/voice_engine/transmit_mixer.h"
 #include "webrtc/voice_engine/voice_engine_impl.h"
 
 namespace webrtc
@@ -80,6 +82,25 @@ VoiceEngine* VoiceEngine::Create()
     return GetVoiceEngine();
 }
 
+VoiceEngine* VoiceEngine::Create(const Config& config)
+{
+    VoiceEngineImpl* self = static_cast<VoiceEngineImpl*>(GetVoiceEngine());
+    if (self == NULL)
+    {
+        return NULL;
+    }
+    const int numEncoderThreads = config.Get<VoEEncoderThreads>().num_threads;
+    if (numEncoderThreads > 0 &&
+        self->transmit_mixer()->SetEncoderThreads(numEncoderThreads) != 0)
+    {
+        WEBRTC_TRACE(kTraceWarning, kTraceVoice, -1,
+                     "VoiceEngine::Create() unable to start %d encoder "
+                     "threads, encoding on the audio device thread",
+                     numEncoderThreads);
+    }
+    return self;
+}
+
 int VoiceEngine::SetTraceFilter(unsigned int filter)
 {
     WEBRTC_TRACE(kTraceApiCall, kTraceVoice,